@@ -109,7 +109,14 @@ int main(int argc, char* argv[])
 		if (success)
 			success = gApp->Init();
 		if (success)
-			success = gApp->Compile();
+		{
+			if (!gApp->mServerBenchPath.IsEmpty())
+				success = gApp->RunServerBench();
+			else if (!gApp->mServerPath.IsEmpty())
+				success = gApp->RunServer();
+			else
+				success = gApp->Compile();
+		}
 
 		if (success)
 			gApp->OutputLine("SUCCESS", OutputPri_Critical);
@@ -3,11 +3,14 @@
 //#define BFBUILD_MAIN_THREAD_COMPILE
 
 #include "BootApp.h"
+#include "BootState.h"
+#include "BootServer.h"
 #include <iostream>
 #include "BeefySysLib/util/String.h"
 #include "BeefySysLib/util/FileEnumerator.h"
 #include "BeefySysLib/util/WorkThread.h"
 #include "BeefySysLib/platform/PlatformHelper.h"
+#include "BeefySysLib/util/BeefPerf.h"
 #include "Compiler/BfSystem.h"
 
 #ifdef BF_PLATFORM_WINDOWS
@@ -40,6 +43,8 @@ BF_IMPORT void BF_CALLTYPE BfParser_SetCharIdData(void* bfParser, uint8* data, i
 BF_IMPORT bool BF_CALLTYPE BfParser_Parse(void* bfParser, void* bfPassInstance, bool compatMode);
 BF_IMPORT bool BF_CALLTYPE BfParser_Reduce(void* bfParser, void* bfPassInstance);
 BF_IMPORT bool BF_CALLTYPE BfParser_BuildDefs(void* bfParser, void* bfPassInstance, void* resolvePassData, bool fullRefresh);
+BF_IMPORT void BF_CALLTYPE BfParser_SetScanOnly(void* bfParser);
+BF_IMPORT int BF_CALLTYPE BfParser_TestLexReplay(void* bfSystem, const char* src, int length, int editStride, int* outReplayCount);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -57,7 +62,7 @@ BF_IMPORT void BF_CALLTYPE BfSystem_AddTypeOptions(void* bfSystem, const char* f
 
 BF_IMPORT void BF_CALLTYPE BfProject_SetDisabled(void* bfProject, bool disabled);
 BF_IMPORT void BF_CALLTYPE BfProject_SetOptions(void* bfProject, int targetType, const char* startupObject, const char* preprocessorMacros,
-	int optLevel, int ltoType, int relocType, int picLevel, int32 flags);
+	int optLevel, int ltoType, int relocType, int picLevel, int32 flags, int pgoKind, const char* pgoProfilePath);
 BF_IMPORT void BF_CALLTYPE BfProject_ClearDependencies(void* bfProject);
 BF_IMPORT void BF_CALLTYPE BfProject_AddDependency(void* bfProject, void* depProject);
 
@@ -72,6 +77,10 @@ BF_IMPORT const char* BF_CALLTYPE VSSupport_Find();
 
 //////////////////////////////////////////////////////////////////////////
 
+BF_IMPORT bool BF_CALLTYPE BpCapture_ConvertToChromeTrace(const char* capturePath, const char* outPath);
+
+//////////////////////////////////////////////////////////////////////////
+
 USING_NS_BF;
 
 BootApp* Beefy::gApp = NULL;
@@ -151,7 +160,15 @@ BootApp::BootApp()
 	mCompiler = NULL;
 	mProject = NULL;	
 	mCELibProject = NULL;
+	mPassInstance = NULL;
+	mServer = NULL;
+	mBenchEditCount = 1000;
 	mIsCERun = false;
+	mForceBuild = false;
+	mShortSymbols = false;
+	mCompactReflection = false;
+	mLTOType = BfLTOType_None;
+	mPGOKind = BfPGOKind_None;
 	mAsmKind = BfAsmKind_None;
 	mStartupObject = "Program";
 
@@ -188,6 +205,9 @@ void BootApp::OutputLine(const String& text, OutputPri outputPri)
 		mLogFile.WriteSNZ("\n");
 	}
 
+	if (mServer != NULL)
+		mServer->AddOutput(text, outputPri);
+
 	if (outputPri == OutputPri_Error)
 		mHadErrors = true;
 
@@ -230,6 +250,8 @@ void BootApp::Fail(const String& error)
 {
 	if (mLogFile.IsOpen())
 		mLogFile.WriteSNZ("FAIL: " + error + "\n");
+	if (mServer != NULL)
+		mServer->AddOutput("FAIL: " + error, OutputPri_Error);
 	std::cerr << "FAIL: " << error.c_str() << std::endl;
 	mHadErrors = true;
 }
@@ -337,6 +359,60 @@ bool BootApp::HandleCmdLine(const String &cmd, const String& param)
 	{
 		mEmitIR = true;
 	}	
+	else if (cmd == "-shortsymbols")
+	{
+		// Hashed symbol names, with a ShortSymbols.map written to the build directory
+		mShortSymbols = true;
+	}
+	else if (cmd == "-compactreflection")
+	{
+		// Reflection names are packed into one blob per type and interned on first use
+		mCompactReflection = true;
+	}
+	else if (cmd == "-thinlto")
+	{
+		// Summary-based cross-module inlining, with the backends cached in the build directory
+		mLTOType = BfLTOType_ThinInProcess;
+	}
+	else if (cmd == "-pgogen")
+	{
+		// Instrumented build. Raw profiles go to the given path, which can use LLVM's '%p' and '%m' patterns.
+		mPGOKind = BfPGOKind_Instrument;
+		mPGOProfilePath = param;
+		wantedParam = !param.IsEmpty();
+	}
+	else if (cmd == "-pgouse")
+	{
+		mPGOKind = BfPGOKind_Use;
+		mPGOProfilePath = param;
+		wantedParam = true;
+	}
+	else if (cmd == "-pgomerge")
+	{
+		DoPGOMerge(param);
+		mShowedHelp = true;
+		return !mHadErrors;
+	}
+	else if (cmd == "-force")
+	{
+		// Ignore the persisted build state and always compile, even when nothing has changed
+		mForceBuild = true;
+	}
+	else if (cmd == "-server")
+	{
+		mServerPath = param;
+		wantedParam = true;
+	}
+	else if (cmd == "-serverbench")
+	{
+		mServerBenchPath = param;
+		wantedParam = true;
+	}
+	else if (cmd == "-benchedits")
+	{
+		mBenchEditCount = atoi(param.c_str());
+		wantedParam = true;
+	}
 	else if (cmd == "-cedest")
 	{
 		mIsCERun = true;
@@ -347,6 +423,42 @@ bool BootApp::HandleCmdLine(const String &cmd, const String& param)
 	{
 		mIsCERun = true;
 	}
+	else if (cmd == "-perf")
+	{
+		// Captures BeefPerf zones to disk, the same as setting BEEFPERF_FILE
+		BpInitFile(param.c_str(), "BeefBoot");
+		BpSetThreadName("Main");
+		wantedParam = true;
+	}
+	else if (cmd == "-perfconvert")
+	{
+		String outPath = param;
+		int dotPos = (int)outPath.LastIndexOf('.');
+		if (dotPos > (int)GetFileDir(outPath).length())
+			outPath.RemoveToEnd(dotPos);
+		outPath += ".json";
+
+		if (!BpCapture_ConvertToChromeTrace(param.c_str(), outPath.c_str()))
+		{
+			Fail(StrFormat("Failed to convert BeefPerf capture '%s'", param.c_str()));
+			return false;
+		}
+		OutputLine(StrFormat("Wrote Chrome trace '%s'", outPath.c_str()));
+		mShowedHelp = true;
+		return true;
+	}
+	else if (cmd == "-lexbench")
+	{
+		DoLexBenchmark(param);
+		mShowedHelp = true;
+		return !mHadErrors;
+	}
+	else if (cmd == "-lexreplaytest")
+	{
+		DoLexReplayTest(param);
+		mShowedHelp = true;
+		return !mHadErrors;
+	}
 	else if (cmd == "-emitasm")
 	{
 		if (param.IsEmpty())
@@ -388,7 +500,7 @@ bool BootApp::Init()
 	mWorkingDir = cwdPtr;
 	free(cwdPtr);
 
-	if ((mTargetPath.IsEmpty()) && (mCESrc.IsEmpty()))
+	if ((mTargetPath.IsEmpty()) && (mCESrc.IsEmpty()) && (mServerBenchPath.IsEmpty()))
 	{
 		Fail("'Out' path not specified");
 	}
@@ -418,6 +530,7 @@ void BootApp::QueueFile(const StringImpl& path, void* project)
 		
 		bool worked = true;
 		void* bfParser = BfSystem_CreateParser(mSystem, project);
+		mParserMap[path] = bfParser;
 		BfParser_SetSource(bfParser, data, len, path.c_str());
 		//bfParser.SetCharIdData(charIdData);
 		worked &= BfParser_Parse(bfParser, mPassInstance, false);
@@ -460,17 +573,355 @@ void BootApp::QueuePath(const StringImpl& path)
 	}
 }
 
+// Finds the same files that QueuePath would queue
+void BootApp::FindQueuedFiles(const StringImpl& path, Array<String>& outPaths)
+{
+	if (!DirectoryExists(path))
+	{
+		outPaths.Add(path);
+		return;
+	}
+
+	for (auto& fileEntry : FileEnumerator(path, FileEnumerator::Flags_Files))
+	{
+		String filePath = fileEntry.GetFilePath();
+		String ext = GetFileExtension(filePath);
+		if ((ext.Equals(".bf", StringImpl::CompareKind_OrdinalIgnoreCase)) ||
+			(ext.Equals(".cs", StringImpl::CompareKind_OrdinalIgnoreCase)))
+			outPaths.Add(filePath);
+	}
+
+	for (auto& fileEntry : FileEnumerator(path, FileEnumerator::Flags_Directories))
+	{
+		String childPath = fileEntry.GetFilePath();
+		if (GetFileName(childPath) == "build")
+			continue;
+		FindQueuedFiles(childPath, outPaths);
+	}
+}
+
+// Finds the objects and libraries named in the link params, so a changed library invalidates the persisted build state.
+//  Libraries found through the linker's default search paths aren't tracked.
+void BootApp::FindLinkInputs(Array<String>& outPaths)
+{
+	Array<String> args;
+	String curArg;
+	bool inQuote = false;
+	for (int i = 0; i <= (int)mLinkParams.length(); i++)
+	{
+		char c = (i < (int)mLinkParams.length()) ? mLinkParams[i] : 0;
+		if (c == '"')
+			inQuote = !inQuote;
+		else if ((c == 0) || ((!inQuote) && ((c == ' ') || (c == '\t'))))
+		{
+			if (!curArg.IsEmpty())
+				args.Add(curArg);
+			curArg.Clear();
+		}
+		else
+			curArg.Append(c);
+	}
+
+	Array<String> libDirs;
+	libDirs.Add(mWorkingDir);
+	Array<String> libNames;
+	for (int argIdx = 0; argIdx < (int)args.size(); argIdx++)
+	{
+		auto& arg = args[argIdx];
+		if (arg.StartsWith("-L"))
+		{
+			if (arg.length() > 2)
+				libDirs.Add(GetAbsPath(arg.Substring(2), mWorkingDir));
+			else if (argIdx + 1 < (int)args.size())
+				libDirs.Add(GetAbsPath(args[++argIdx], mWorkingDir));
+		}
+		else if ((arg.StartsWith("-libpath:", StringImpl::CompareKind_OrdinalIgnoreCase)) || (arg.StartsWith("/libpath:", StringImpl::CompareKind_OrdinalIgnoreCase)))
+			libDirs.Add(GetAbsPath(arg.Substring(9), mWorkingDir));
+		else if ((arg.StartsWith("-l")) && (arg.length() > 2))
+		{
+			libNames.Add(StrFormat("lib%s.a", arg.c_str() + 2));
+			libNames.Add(StrFormat("lib%s.so", arg.c_str() + 2));
+		}
+		else if (arg.StartsWith("-"))
+			continue;
+		else
+		{
+			String absPath = GetAbsPath(arg, mWorkingDir);
+			if (FileExists(absPath))
+				outPaths.Add(absPath);
+			else if (!arg.StartsWith("/"))
+				libNames.Add(arg);
+		}
+	}
+
+	for (auto& libName : libNames)
+	{
+		for (auto& libDir : libDirs)
+		{
+			String libPath = GetAbsPath(libName, libDir);
+			if (FileExists(libPath))
+			{
+				outPaths.Add(libPath);
+				break;
+			}
+		}
+	}
+}
+
+// Everything besides the source text that affects the build output
+Val128 BootApp::GetConfigHash(const StringImpl& exePath)
+{
+	HashContext hashCtx;
+	hashCtx.MixinStr(mDefines);
+	hashCtx.MixinStr(mStartupObject);
+	hashCtx.MixinStr(mTargetPath);
+	hashCtx.MixinStr(mTargetTriple);
+	hashCtx.MixinStr(mLinkParams);
+	hashCtx.MixinStr(mCESrc);
+	hashCtx.MixinStr(mCEDest);
+	hashCtx.Mixin(mTargetType);
+	hashCtx.Mixin(mOptLevel);
+	hashCtx.Mixin(mToolset);
+	hashCtx.Mixin(mAsmKind);
+	hashCtx.Mixin(mEmitIR);
+	hashCtx.Mixin(mShortSymbols);
+	hashCtx.Mixin(mCompactReflection);
+	hashCtx.Mixin(mLTOType);
+	hashCtx.Mixin(mPGOKind);
+	hashCtx.MixinStr(mPGOProfilePath);
+	if (mPGOKind == BfPGOKind_Use)
+	{
+		int profileSize = 0;
+		uint8* profileData = LoadBinaryData(mPGOProfilePath, &profileSize);
+		if (profileData != NULL)
+		{
+			hashCtx.Mixin(Hash128(profileData, profileSize));
+			delete [] profileData;
+		}
+	}
+	hashCtx.Mixin(mIsCERun);
+	// A rebuilt BeefBoot may generate different code
+	hashCtx.Mixin(GetFileTimeWrite(exePath));
+	return hashCtx.Finish128();
+}
+
+static void FindSourceFiles(const StringImpl& path, Array<String>& outPaths)
+{
+	if (!DirectoryExists(path))
+	{
+		outPaths.Add(path);
+		return;
+	}
+
+	for (auto& fileEntry : FileEnumerator(path, FileEnumerator::Flags_Files))
+	{
+		String filePath = fileEntry.GetFilePath();
+		if (GetFileExtension(filePath).Equals(".bf", StringImpl::CompareKind_OrdinalIgnoreCase))
+			outPaths.Add(filePath);
+	}
+
+	for (auto& fileEntry : FileEnumerator(path, FileEnumerator::Flags_Directories))
+		FindSourceFiles(fileEntry.GetFilePath(), outPaths);
+}
+
+// Lexes every .bf file under 'path' with a scan-only parser and reports throughput
+void BootApp::DoLexBenchmark(const StringImpl& path)
+{
+	const int iterationCount = 5;
+
+	Array<String> filePaths;
+	FindSourceFiles(path, filePaths);
+
+	struct _SourceFile
+	{
+		String mPath;
+		const char* mData;
+		int mLength;
+	};
+
+	Array<_SourceFile> sourceFiles;
+	int64 totalBytes = 0;
+	for (auto& filePath : filePaths)
+	{
+		_SourceFile sourceFile;
+		sourceFile.mPath = filePath;
+		sourceFile.mData = LoadTextData(filePath, &sourceFile.mLength);
+		if (sourceFile.mData == NULL)
+		{
+			Fail(StrFormat("Unable to load file '%s'", filePath.c_str()));
+			continue;
+		}
+		totalBytes += sourceFile.mLength;
+		sourceFiles.Add(sourceFile);
+	}
+
+	if (sourceFiles.IsEmpty())
+	{
+		Fail(StrFormat("No .bf files found in '%s'", path.c_str()));
+		return;
+	}
+
+	void* system = BfSystem_Create();
+	void* passInstance = BfSystem_CreatePassInstance(system);
+
+	double bestSeconds = 0;
+	for (int iterationIdx = 0; iterationIdx < iterationCount; iterationIdx++)
+	{
+		int64 startTick = BfpSystem_GetCPUTick();
+		for (auto& sourceFile : sourceFiles)
+		{
+			void* bfParser = BfSystem_CreateParser(system, NULL);
+			BfParser_SetSource(bfParser, sourceFile.mData, sourceFile.mLength, sourceFile.mPath.c_str());
+			BfParser_SetScanOnly(bfParser);
+			BfParser_Parse(bfParser, passInstance, false);
+			BfParser_Delete(bfParser);
+		}
+		double seconds = (double)(BfpSystem_GetCPUTick() - startTick) / (double)BfpSystem_GetCPUTickFreq();
+		if ((iterationIdx == 0) || (seconds < bestSeconds))
+			bestSeconds = seconds;
+	}
+
+	BfPassInstance_Delete(passInstance);
+	BfSystem_Delete(system);
+	for (auto& sourceFile : sourceFiles)
+		delete [] sourceFile.mData;
+
+	double megabytes = totalBytes / (1024.0 * 1024.0);
+	OutputLine(StrFormat("Lexed %d files, %0.2f MB. Best of %d: %0.1f ms, %0.1f MB/s", (int)sourceFiles.size(), megabytes, iterationCount,
+		bestSeconds * 1000.0, (bestSeconds > 0) ? megabytes / bestSeconds : 0.0));
+}
+
+// Edited at every char, so every lexer state in it gets a replay boundary placed next to it
+static const char* gLexReplayTestSrc =
+	"#pragma warning disable 168\n"
+	"#if DEBUG && !TEST\n"
+	"#define LOCAL\n"
+	"#endif\n"
+	"namespace Test\n"
+	"{\n"
+	"\t/// Doc comment\n"
+	"\tclass Foo<T> : IFoo where T : struct\n"
+	"\t{\n"
+	"\t\tint mA = 0x1F + 1'000 - 3.5f * .25 / 2e-3;\n"
+	"\t\tString mB = \"str \\\" /* not a comment */ \\n\";\n"
+	"\t\tString mC = @\"C:\\path\"\"\";\n"
+	"\t\tchar8 mD = '\\'';\n"
+	"\t\t/* block /* nested */ comment */\n"
+	"\t\tString Get(int a) => scope $\"{a} and {{braces}} {mA + (a * 2):X4}\";\n"
+	"\t\t// line comment with \"quote\n"
+	"\t\tvoid Run() { mA <<= 2; mA >>= 1; if (mA >= 2 && mA != 3) mA++; }\n"
+	"\t}\n"
+	"}\n";
+
+// Checks that the classifier's token replay matches a full lex across edits, in a built-in source covering strings,
+//  comments, preprocessor lines and interpolated strings, and then in the .bf files under 'path', if given
+void BootApp::DoLexReplayTest(const StringImpl& path)
+{
+	struct _SourceFile
+	{
+		String mPath;
+		const char* mData;
+		int mLength;
+		int mEditStride;
+	};
+
+	Array<_SourceFile> sourceFiles;
+	_SourceFile builtinFile;
+	builtinFile.mPath = "<builtin>";
+	builtinFile.mData = gLexReplayTestSrc;
+	builtinFile.mLength = (int)strlen(gLexReplayTestSrc);
+	builtinFile.mEditStride = 1;
+	sourceFiles.Add(builtinFile);
+
+	if (!path.IsEmpty())
+	{
+		Array<String> filePaths;
+		FindSourceFiles(path, filePaths);
+		for (auto& filePath : filePaths)
+		{
+			_SourceFile sourceFile;
+			sourceFile.mPath = filePath;
+			sourceFile.mData = LoadTextData(filePath, &sourceFile.mLength);
+			if (sourceFile.mData == NULL)
+			{
+				Fail(StrFormat("Unable to load file '%s'", filePath.c_str()));
+				continue;
+			}
+			// Large files get a sample of edit positions, since every edit costs three parses
+			sourceFile.mEditStride = BF_MAX(sourceFile.mLength / 64, 1);
+			sourceFiles.Add(sourceFile);
+		}
+	}
+
+	void* system = BfSystem_Create();
+	int totalFailCount = 0;
+	int64 totalReplayCount = 0;
+	for (auto& sourceFile : sourceFiles)
+	{
+		int replayCount = 0;
+		int failCount = BfParser_TestLexReplay(system, sourceFile.mData, sourceFile.mLength, sourceFile.mEditStride, &replayCount);
+		if (failCount != 0)
+			Fail(StrFormat("Lex replay differed from a full lex for %d edits in '%s'", failCount, sourceFile.mPath.c_str()));
+		totalFailCount += failCount;
+		totalReplayCount += replayCount;
+	}
+	BfSystem_Delete(system);
+
+	for (int fileIdx = 1; fileIdx < (int)sourceFiles.size(); fileIdx++)
+		delete [] sourceFiles[fileIdx].mData;
+
+	OutputLine(StrFormat("Lex replay tested %d files, %lld tokens replayed, %d mismatches", (int)sourceFiles.size(), (long long)totalReplayCount, totalFailCount));
+}
+
 static void CompileThread(void* param)
 {
 	BfpThread_SetName(NULL, "CompileThread", NULL);
 
 	BootApp* app = (BootApp*)param;
-	BfCompiler_ClearBuildCache(app->mCompiler);
+	// A server keeps its build cache so unchanged modules aren't regenerated
+	if (app->mServer == NULL)
+		BfCompiler_ClearBuildCache(app->mCompiler);
 	
 	if (!BfCompiler_Compile(app->mCompiler, app->mPassInstance, app->mBuildDir.c_str()))
 		app->mHadErrors = true;
 }
 
+// Merges the raw profiles that sit next to outPath into the .profdata file that -pgouse expects
+void BootApp::DoPGOMerge(const StringImpl& outPath)
+{
+	String dirPath = GetFileDir(outPath);
+	if (dirPath.IsEmpty())
+		dirPath = ".";
+
+	String args = "merge -output=";
+	IDEUtils::AppendWithOptionalQuotes(args, outPath);
+	int rawCount = 0;
+	for (auto& fileEntry : FileEnumerator(dirPath, FileEnumerator::Flags_Files))
+	{
+		String filePath = fileEntry.GetFilePath();
+		if (!GetFileExtension(filePath).Equals(".profraw", StringImpl::CompareKind_OrdinalIgnoreCase))
+			continue;
+		args += " ";
+		IDEUtils::AppendWithOptionalQuotes(args, filePath);
+		rawCount++;
+	}
+
+	if (rawCount == 0)
+	{
+		Fail(StrFormat("No .profraw files found in '%s'. Run the -pgogen build first.", dirPath.c_str()));
+		return;
+	}
+
+#ifdef BF_PLATFORM_WINDOWS
+	if (!QueueRun("llvm-profdata.exe", args, mWorkingDir, BfpSpawnFlag_None))
+		return;
+#else
+	if (!QueueRun("/usr/bin/env", "llvm-profdata " + args, mWorkingDir, BfpSpawnFlag_None))
+		return;
+#endif
+	OutputLine(StrFormat("Merged %d raw profiles into '%s'", rawCount, outPath.c_str()));
+}
+
 void BootApp::DoCompile()
 {
 #ifdef BFBUILD_MAIN_THREAD_COMPILE
@@ -483,7 +934,7 @@ void BootApp::DoCompile()
 
 	int lastProgressTicks = 0;
 
-	bool showProgress = mVerbosity >= Verbosity_Normal;
+	bool showProgress = (mVerbosity >= Verbosity_Normal) && (mServer == NULL);
 
 	int progressSize = 30;
 	if (showProgress)
@@ -767,35 +1218,39 @@ void BootApp::DoLinkGNU()
 #ifdef BF_PLATFORM_LINUX
 	linkLine.Append("-no-pie ");
 #endif
+	if (mPGOKind == BfPGOKind_Instrument)
+	{
+		// The profile runtime comes with clang's driver
+		linkerPath = "/usr/bin/clang++";
+		linkLine.Append("-fprofile-instr-generate ");
+	}
 
     linkLine.Append(mLinkParams);
 
     auto runCmd = QueueRun(linkerPath, linkLine, mWorkingDir, BfpSpawnFlag_UseArgsFile);
 }
 
-bool BootApp::Compile()
+void BootApp::CreateSystem()
 {
-	DWORD startTick = BFTickCount();
-
 	mSystem = BfSystem_Create();
 
 	mCompiler = BfSystem_CreateCompiler(mSystem, false);
 
-	String projectName = GetFileName(mTargetPath);
-	int dotPos = (int)projectName.IndexOf('.');
+	mProjectName = GetFileName(mTargetPath);
+	int dotPos = (int)mProjectName.IndexOf('.');
 	if (dotPos != -1)
-		projectName.RemoveToEnd(dotPos);
-	if (projectName.IsEmpty())
-		projectName.Append("BeefProject");
+		mProjectName.RemoveToEnd(dotPos);
+	if (mProjectName.IsEmpty())
+		mProjectName.Append("BeefProject");
 
-	mProject = BfSystem_CreateProject(mSystem, projectName.c_str());
+	mProject = BfSystem_CreateProject(mSystem, mProjectName.c_str());
 	
 	if (mIsCERun)
 	{
 		mCELibProject = BfSystem_CreateProject(mSystem, "BeefLib");		
 
 		BfProjectFlags flags = BfProjectFlags_None;
-		BfProject_SetOptions(mCELibProject, BfTargetType_BeefLib, "", mDefines.c_str(), mOptLevel, 0, 0, 0, flags);		
+		BfProject_SetOptions(mCELibProject, BfTargetType_BeefLib, "", mDefines.c_str(), mOptLevel, 0, 0, 0, flags, BfPGOKind_None, NULL);
 	}
 
 	if (!mDefines.IsEmpty())
@@ -805,7 +1260,9 @@ bool BootApp::Compile()
 	mDefines.Append("\n");
 	mDefines.Append(BF_PLATFORM_NAME);
 
-	int ltoType = 0;
+	BfLTOType ltoType = mLTOType;
+	if ((mOptLevel == BfOptLevel_OgPlus) || (mIsCERun))
+		ltoType = BfLTOType_None;
 	BfProjectFlags flags = BfProjectFlags_None;
 	if (mIsCERun)
 	{
@@ -815,85 +1272,57 @@ bool BootApp::Compile()
 		else if (mAsmKind == BfAsmKind_Intel)
 			flags = (BfProjectFlags)(flags | BfProjectFlags_AsmOutput);
 	}
-    BfProject_SetOptions(mProject, mTargetType, mStartupObject.c_str(), mDefines.c_str(), mOptLevel, ltoType, 0, 0, flags);
+	if (mCompactReflection)
+		flags = (BfProjectFlags)(flags | BfProjectFlags_CompactReflection);
+	BfPGOKind pgoKind = mPGOKind;
+	if (mOptLevel == BfOptLevel_OgPlus)
+		pgoKind = BfPGOKind_None; // Og+ doesn't go through LLVM
+    BfProject_SetOptions(mProject, mTargetType, mStartupObject.c_str(), mDefines.c_str(), mOptLevel, ltoType, 0, 0, flags, pgoKind, mPGOProfilePath.c_str());
 
 	if (mCELibProject != NULL)
 		BfProject_AddDependency(mProject, mCELibProject);
 	
 	mPassInstance = BfSystem_CreatePassInstance(mSystem);
 	
-	Beefy::String exePath;
-	BfpGetStrHelper(exePath, [](char* outStr, int* inOutStrSize, BfpResult* result)
+	BfpGetStrHelper(mExePath, [](char* outStr, int* inOutStrSize, BfpResult* result)
 		{
 			BfpSystem_GetExecutablePath(outStr, inOutStrSize, (BfpSystemResult*)result);
 		});
-	mBuildDir = GetFileDir(exePath) + "/build";
+	mBuildDir = GetFileDir(mExePath) + "/build";
 	
-	RecursiveCreateDirectory(mBuildDir + "/" + projectName);
+	RecursiveCreateDirectory(mBuildDir + "/" + mProjectName);
 	if (mIsCERun)
 		RecursiveCreateDirectory(mBuildDir + "/BeefLib");
 
 	BfCompilerOptionFlags optionFlags = (BfCompilerOptionFlags)(BfCompilerOptionFlag_EmitDebugInfo | BfCompilerOptionFlag_EmitLineInfo | BfCompilerOptionFlag_GenerateOBJ | BfCompilerOptionFlag_OmitDebugHelpers);
 	if (mEmitIR)
 		optionFlags = (BfCompilerOptionFlags)(optionFlags | BfCompilerOptionFlag_WriteIR);
+	if (mShortSymbols)
+		optionFlags = (BfCompilerOptionFlags)(optionFlags | BfCompilerOptionFlag_ShortSymbols);
 
 	int maxWorkerThreads = BfpSystem_GetNumLogicalCPUs(NULL);
 	if (maxWorkerThreads <= 1)
 		maxWorkerThreads = 6;
 
     BfCompiler_SetOptions(mCompiler, NULL, 0, mTargetTriple.c_str(), mToolset, BfSIMDSetting_SSE2, 1, maxWorkerThreads, optionFlags, "malloc", "free");
-	    
-	if (mIsCERun)
-	{
-		QueueFile(mCESrc, mProject);
-	}
-	for (auto& srcName : mRequestedSrc)
-	{
-		String absPath = GetAbsPath(srcName, mWorkingDir);
-		QueuePath(absPath);
-	}
-
-	if (!mHadErrors)
-	{
-		DoCompile();
-		OutputLine(StrFormat("TIMING: Beef compiling: %0.1fs", (BFTickCount() - startTick) / 1000.0), OutputPri_Normal);
-
-		if (!mCEDest.IsEmpty())
-		{
-			String ext;
-			String srcResult = mBuildDir + "/BeefProject/BeefProject";
-			if (mAsmKind == BfAsmKind_None)			
-				srcResult += BF_OBJ_EXT;
-			else			
-				srcResult += ".s";			
-			
-			CopyFile(srcResult, mCEDest);			
-		}
+}
 
-		if ((mIsCERun) && (mEmitIR))
-		{
-			String ext;			
-			String srcResult = mBuildDir + "/BeefProject/BeefProject";			
-			String irDestPath = mCEDest;
-			int dotPos = (int)irDestPath.LastIndexOf('.');
-			if (dotPos != -1)
-				irDestPath.RemoveToEnd(dotPos);
+void BootApp::DeleteSystem()
+{
+	BfPassInstance_Delete(mPassInstance);
+	BfCompiler_Delete(mCompiler);
 
-			if (mOptLevel == BfOptLevel_OgPlus)
-			{
-				srcResult += ".beir";
-				irDestPath += ".ll";
-			}
-			else
-			{
-				srcResult += ".ll";			
-				irDestPath += ".ll";
-			}
-			
-			CopyFile(srcResult, irDestPath);			
-		}
-	}
+	BfSystem_Delete(mSystem);
+	mParserMap.Clear();
+	mSystem = NULL;
+	mCompiler = NULL;
+	mProject = NULL;
+	mCELibProject = NULL;
+	mPassInstance = NULL;
+}
 
+void BootApp::OutputPassMessages()
+{
 	while (true)
 	{
 		const char* msg = BfPassInstance_PopOutString(mPassInstance);
@@ -927,7 +1356,10 @@ bool BootApp::Compile()
 		else
 			OutputLine(msg);
 	}
-		
+}
+
+void BootApp::DoLink()
+{
 	if ((!mHadErrors) && (!mTargetPath.IsEmpty()))
     {
 		if (mVerbosity == Verbosity_Normal)
@@ -945,12 +1377,114 @@ bool BootApp::Compile()
 		if (mVerbosity == Verbosity_Normal)
 			std::cout << std::endl;
     }
+}
 
-	BfPassInstance_Delete(mPassInstance);
-	BfCompiler_Delete(mCompiler);
+bool BootApp::Compile()
+{
+	DWORD startTick = BFTickCount();
 
-	BfSystem_Delete(mSystem);
+	CreateSystem();
+
+	// Check the state persisted by the last successful build before doing any parsing. A match skips the entire build,
+	//  any difference means a full cold compile
+	String statePath = mBuildDir + "/" + mProjectName + "/BeefBoot.state";
+	BootState prevState;
+	BootState curState;
+	curState.mConfigHash = GetConfigHash(mExePath);
+	{
+		Array<String> srcPaths;
+		if (mIsCERun)
+			srcPaths.Add(mCESrc);
+		for (auto& srcName : mRequestedSrc)
+			FindQueuedFiles(GetAbsPath(srcName, mWorkingDir), srcPaths);
+		FindLinkInputs(srcPaths);
+		for (auto& srcPath : srcPaths)
+			curState.AddFile(srcPath);
+	}
+
+	if ((!mForceBuild) && (prevState.Read(statePath)) && (prevState.mConfigHash == curState.mConfigHash) && (curState.FilesMatch(prevState)) &&
+		((mTargetPath.IsEmpty()) || (FileExists(mTargetPath))) &&
+		((mCEDest.IsEmpty()) || (FileExists(mCEDest))))
+	{
+		OutputLine(StrFormat("Build is up to date (%d files unchanged)", (int)curState.mFiles.size()), OutputPri_Normal);
+		DeleteSystem();
+		return true;
+	}
+	// Don't leave the previous state around in case this build fails
+	BfpFile_Delete(statePath.c_str(), NULL);
+
+	if (mIsCERun)
+	{
+		QueueFile(mCESrc, mProject);
+	}
+	for (auto& srcName : mRequestedSrc)
+	{
+		String absPath = GetAbsPath(srcName, mWorkingDir);
+		QueuePath(absPath);
+	}
+
+	if (!mHadErrors)
+	{
+		DoCompile();
+		OutputLine(StrFormat("TIMING: Beef compiling: %0.1fs", (BFTickCount() - startTick) / 1000.0), OutputPri_Normal);
+
+		if (!mCEDest.IsEmpty())
+		{
+			String ext;
+			String srcResult = mBuildDir + "/BeefProject/BeefProject";
+			if (mAsmKind == BfAsmKind_None)			
+				srcResult += BF_OBJ_EXT;
+			else			
+				srcResult += ".s";			
+			
+			CopyFile(srcResult, mCEDest);			
+		}
+
+		if ((mIsCERun) && (mEmitIR))
+		{
+			String ext;			
+			String srcResult = mBuildDir + "/BeefProject/BeefProject";			
+			String irDestPath = mCEDest;
+			int dotPos = (int)irDestPath.LastIndexOf('.');
+			if (dotPos != -1)
+				irDestPath.RemoveToEnd(dotPos);
+
+			if (mOptLevel == BfOptLevel_OgPlus)
+			{
+				srcResult += ".beir";
+				irDestPath += ".ll";
+			}
+			else
+			{
+				srcResult += ".ll";			
+				irDestPath += ".ll";
+			}
+			
+			CopyFile(srcResult, irDestPath);			
+		}
+	}
+
+	OutputPassMessages();
+	DoLink();
+
+	if ((!mHadErrors) && (!curState.Write(statePath)))
+		OutputLine(StrFormat("Failed to write build state to '%s'", statePath.c_str()), OutputPri_Warning);
+
+	DeleteSystem();
 
 	return !mHadErrors;
 }
 
+bool BootApp::RunServer()
+{
+	mServer = new BootServer(this);
+	bool success = mServer->Run(mServerPath);
+	delete mServer;
+	mServer = NULL;
+	return success;
+}
+
+bool BootApp::RunServerBench()
+{
+	return BootServer::RunBench(this, mServerBenchPath, mBenchEditCount);
+}
@@ -5,10 +5,14 @@
 #include "BeefySysLib/util/CritSect.h"
 #include "BeefySysLib/util/String.h"
 #include "BeefySysLib/util/Array.h"
+#include "BeefySysLib/util/Dictionary.h"
+#include "BeefySysLib/util/Hash.h"
 #include "Compiler/BfSystem.h"
 
 NS_BF_BEGIN
 
+class BootServer;
+
 enum OutputPri
 {
 	OutputPri_Low,
@@ -43,8 +47,16 @@ public:
 	BfOptLevel mOptLevel;
 	BfToolsetType mToolset;		
 	bool mEmitIR;
+	bool mForceBuild;
+	bool mShortSymbols;
+	bool mCompactReflection;
+	BfLTOType mLTOType;
+	BfPGOKind mPGOKind;
+	String mPGOProfilePath;
 	String mBuildDir;
 	String mWorkingDir;
+	String mExePath;
+	String mProjectName;
 	String mDefines;
 	String mStartupObject;
 	String mTargetPath;
@@ -55,6 +67,12 @@ public:
 	void* mCompiler;		
 	void* mProject;	
 	void* mPassInstance;
+	Dictionary<String, void*> mParserMap;
+
+	BootServer* mServer;
+	String mServerPath;
+	String mServerBenchPath;
+	int mBenchEditCount;
 
 	bool mIsCERun;
 	void* mCELibProject;
@@ -67,9 +85,19 @@ public:
 	bool QueueRun(const String& fileName, const String& args, const String& workingDir, BfpSpawnFlags extraFlags);
 	bool CopyFile(const StringImpl& srcPath, const StringImpl& destPath);
 
+	void CreateSystem();
+	void DeleteSystem();
 	void QueueFile(const StringImpl& path, void* project);
 	void QueuePath(const StringImpl& path);
+	static void FindQueuedFiles(const StringImpl& path, Array<String>& outPaths);
+	void FindLinkInputs(Array<String>& outPaths);
+	Val128 GetConfigHash(const StringImpl& exePath);
+	void DoLexBenchmark(const StringImpl& path);
+	void DoLexReplayTest(const StringImpl& path);
+	void DoPGOMerge(const StringImpl& outPath);
 	void DoCompile();
+	void OutputPassMessages();
+	void DoLink();
     void DoLinkMS();
     void DoLinkGNU();
 
@@ -81,6 +109,8 @@ public:
 
 	bool Init();
 	bool Compile();
+	bool RunServer();
+	bool RunServerBench();
 };
 
 extern BootApp* gApp;
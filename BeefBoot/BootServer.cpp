@@ -0,0 +1,476 @@
+#pragma warning(disable:4996)
+
+#include "BootServer.h"
+#include <algorithm>
+#include "BeefySysLib/util/String.h"
+
+#ifndef BF_PLATFORM_WINDOWS
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+BF_IMPORT void* BF_CALLTYPE BfSystem_CreateParser(void* bfSystem, void* bfProject);
+BF_IMPORT void BF_CALLTYPE BfSystem_DeleteParser(void* bfSystem, void* bfParser);
+BF_IMPORT void BF_CALLTYPE BfSystem_RemoveOldParsers(void* bfSystem);
+BF_IMPORT void BF_CALLTYPE BfSystem_RemoveOldData(void* bfSystem);
+BF_IMPORT void* BF_CALLTYPE BfSystem_CreatePassInstance(void* bfSystem);
+BF_IMPORT void BF_CALLTYPE BfParser_SetSource(void* bfParser, const char* data, int length, const char* fileName);
+BF_IMPORT void BF_CALLTYPE BfParser_SetNextRevision(void* bfParser, void* nextRevision);
+BF_IMPORT bool BF_CALLTYPE BfParser_Parse(void* bfParser, void* bfPassInstance, bool compatMode);
+BF_IMPORT bool BF_CALLTYPE BfParser_Reduce(void* bfParser, void* bfPassInstance);
+BF_IMPORT bool BF_CALLTYPE BfParser_BuildDefs(void* bfParser, void* bfPassInstance, void* resolvePassData, bool fullRefresh);
+BF_IMPORT const char* BF_CALLTYPE BfCompiler_GetUsedOutputFileNames(void* bfCompiler, void* bfProject, bool flushQueuedHotFiles, bool* hadOutputChanges);
+BF_IMPORT void BF_CALLTYPE BfPassInstance_Delete(void* bfPassInstance);
+
+USING_NS_BF;
+
+#ifndef BF_PLATFORM_WINDOWS
+
+// Buffered reads and writes over a connected socket
+class BootServerConnection
+{
+public:
+	int mSocket;
+	String mBuffer;
+	int mBufferPos;
+
+public:
+	BootServerConnection(int socket)
+	{
+		mSocket = socket;
+		mBufferPos = 0;
+	}
+
+	bool Fill()
+	{
+		if (mBufferPos > 0)
+		{
+			mBuffer.Remove(0, mBufferPos);
+			mBufferPos = 0;
+		}
+
+		char data[4096];
+		int bytesRead = (int)recv(mSocket, data, sizeof(data), 0);
+		if (bytesRead <= 0)
+			return false;
+		mBuffer.Append(data, bytesRead);
+		return true;
+	}
+
+	bool ReadLine(String& outLine)
+	{
+		while (true)
+		{
+			int crPos = (int)mBuffer.IndexOf('\n', mBufferPos);
+			if (crPos != -1)
+			{
+				outLine.Clear();
+				outLine.Append(mBuffer.c_str() + mBufferPos, crPos - mBufferPos);
+				mBufferPos = crPos + 1;
+				return true;
+			}
+			if (!Fill())
+				return false;
+		}
+	}
+
+	bool ReadBytes(int length, String& outData)
+	{
+		while ((int)mBuffer.length() - mBufferPos < length)
+		{
+			if (!Fill())
+				return false;
+		}
+		outData.Clear();
+		outData.Append(mBuffer.c_str() + mBufferPos, length);
+		mBufferPos += length;
+		return true;
+	}
+
+	bool Write(const StringImpl& data)
+	{
+		int flags = 0;
+#ifdef MSG_NOSIGNAL
+		flags = MSG_NOSIGNAL; // A client that goes away shouldn't kill the server
+#endif
+		int pos = 0;
+		while (pos < (int)data.length())
+		{
+			int bytesWritten = (int)send(mSocket, data.c_str() + pos, data.length() - pos, flags);
+			if (bytesWritten <= 0)
+				return false;
+			pos += bytesWritten;
+		}
+		return true;
+	}
+};
+
+static bool InitSocketAddr(const StringImpl& socketPath, sockaddr_un& addr)
+{
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (socketPath.length() >= sizeof(addr.sun_path))
+		return false;
+	memcpy(addr.sun_path, socketPath.c_str(), socketPath.length());
+	return true;
+}
+
+#endif
+
+BootServer::BootServer(BootApp* app)
+{
+	mApp = app;
+	mCapturingOutput = false;
+	mWantsShutdown = false;
+	mBuildCount = 0;
+}
+
+BootServer::~BootServer()
+{
+}
+
+void BootServer::AddOutput(const StringImpl& text, OutputPri outputPri)
+{
+	if (!mCapturingOutput)
+		return;
+	OutputEntry entry;
+	entry.mPri = outputPri;
+	entry.mText = text;
+	mOutput.Add(entry);
+}
+
+void BootServer::SetFile(const StringImpl& path, const char* data, int length)
+{
+	void* prevParser = NULL;
+	mApp->mParserMap.TryGetValue(path, &prevParser);
+
+	// Chaining the revisions lets the def builder compare against the previous typeDefs so only real changes
+	//  cause types to be rebuilt
+	void* bfParser = BfSystem_CreateParser(mApp->mSystem, mApp->mProject);
+	if (prevParser != NULL)
+	{
+		BfParser_SetNextRevision(prevParser, bfParser);
+		BfSystem_DeleteParser(mApp->mSystem, prevParser);
+	}
+	BfParser_SetSource(bfParser, data, length, path.c_str());
+	BfParser_Parse(bfParser, mApp->mPassInstance, false);
+	BfParser_Reduce(bfParser, mApp->mPassInstance);
+	BfParser_BuildDefs(bfParser, mApp->mPassInstance, NULL, false);
+	mApp->mParserMap[path] = bfParser;
+}
+
+void BootServer::RemoveFile(const StringImpl& path)
+{
+	void* prevParser = NULL;
+	if (!mApp->mParserMap.Remove(path, &prevParser))
+		return;
+	BfSystem_DeleteParser(mApp->mSystem, prevParser);
+}
+
+bool BootServer::Build(Array<String>& outFileNames)
+{
+	mApp->mHadErrors = false;
+	mApp->DoCompile();
+	mApp->OutputPassMessages();
+
+	if (!mApp->mHadErrors)
+	{
+		bool hadOutputChanges = false;
+		String fileNamesStr = BfCompiler_GetUsedOutputFileNames(mApp->mCompiler, mApp->mProject, false, &hadOutputChanges);
+
+		// Only relink when an object file was rewritten since the target was last linked
+		bool needsLink = !FileExists(mApp->mTargetPath);
+		int64 targetTime = GetFileTimeWrite(mApp->mTargetPath);
+		for (auto fileName : fileNamesStr.Split('\n'))
+		{
+			if (fileName.IsEmpty())
+				continue;
+			outFileNames.Add(String(fileName));
+			if (GetFileTimeWrite(outFileNames.back()) > targetTime)
+				needsLink = true;
+		}
+		if (needsLink)
+			mApp->DoLink();
+	}
+
+	BfSystem_RemoveOldParsers(mApp->mSystem);
+	BfSystem_RemoveOldData(mApp->mSystem);
+
+	// Messages from parsing the next set of changes go into a fresh pass instance
+	BfPassInstance_Delete(mApp->mPassInstance);
+	mApp->mPassInstance = BfSystem_CreatePassInstance(mApp->mSystem);
+
+	mBuildCount++;
+	return !mApp->mHadErrors;
+}
+
+bool BootServer::HandleConnection(intptr socket)
+{
+#ifdef BF_PLATFORM_WINDOWS
+	return false;
+#else
+	BootServerConnection connection((int)socket);
+
+	String line;
+	String data;
+	while (connection.ReadLine(line))
+	{
+		if (line.StartsWith("FILE "))
+		{
+			int spacePos = (int)line.IndexOf(' ', 5);
+			if (spacePos == -1)
+				return false;
+			int length = atoi(line.Substring(5, spacePos - 5).c_str());
+			String path = line.Substring(spacePos + 1);
+			if ((length < 0) || (!connection.ReadBytes(length, data)))
+				return false;
+			SetFile(path, data.c_str(), length);
+		}
+		else if (line.StartsWith("RELOAD "))
+		{
+			String path = line.Substring(7);
+			int length = 0;
+			char* fileData = LoadTextData(path, &length);
+			if (fileData != NULL)
+			{
+				SetFile(path, fileData, length);
+				delete [] fileData;
+			}
+			else
+				RemoveFile(path);
+		}
+		else if (line.StartsWith("REMOVE "))
+		{
+			RemoveFile(line.Substring(7));
+		}
+		else if (line == "BUILD")
+		{
+			uint32 startTick = BFTickCount();
+			mOutput.Clear();
+			mCapturingOutput = true;
+			Array<String> fileNames;
+			bool success = Build(fileNames);
+			mCapturingOutput = false;
+			int elapsedMS = (int)(BFTickCount() - startTick);
+			mApp->OutputLine(StrFormat("Build %d %s in %d ms", mBuildCount, success ? "succeeded" : "failed", elapsedMS), OutputPri_Low);
+
+			String response;
+			for (auto& entry : mOutput)
+			{
+				response += StrFormat("MSG %d %d\n", (int)entry.mPri, (int)entry.mText.length());
+				response += entry.mText;
+			}
+			for (auto& fileName : fileNames)
+				response += StrFormat("OUTPUT %s\n", fileName.c_str());
+			response += StrFormat("DONE %d %d\n", success ? 1 : 0, elapsedMS);
+			mOutput.Clear();
+			if (!connection.Write(response))
+				return false;
+		}
+		else if (line == "SHUTDOWN")
+		{
+			mWantsShutdown = true;
+			return true;
+		}
+		else
+		{
+			mApp->OutputLine(StrFormat("Invalid server request: '%s'", line.c_str()), OutputPri_Warning);
+			return false;
+		}
+	}
+	return true;
+#endif
+}
+
+bool BootServer::Run(const StringImpl& socketPath)
+{
+#ifdef BF_PLATFORM_WINDOWS
+	mApp->Fail("Server mode requires Unix domain sockets and is not supported on this platform");
+	return false;
+#else
+	if (mApp->mIsCERun)
+	{
+		mApp->Fail("Server mode can't be used for CE builds");
+		return false;
+	}
+
+	sockaddr_un addr;
+	if (!InitSocketAddr(socketPath, addr))
+	{
+		mApp->Fail(StrFormat("Socket path too long: '%s'", socketPath.c_str()));
+		return false;
+	}
+
+	uint32 startTick = BFTickCount();
+	mApp->CreateSystem();
+	for (auto& srcName : mApp->mRequestedSrc)
+		mApp->QueuePath(GetAbsPath(srcName, mApp->mWorkingDir));
+
+	Array<String> fileNames;
+	Build(fileNames);
+	mApp->OutputLine(StrFormat("TIMING: Initial server build: %0.1fs", (BFTickCount() - startTick) / 1000.0), OutputPri_Normal);
+
+	int listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenSocket == -1)
+	{
+		mApp->Fail("Failed to create server socket");
+		mApp->DeleteSystem();
+		return false;
+	}
+
+	// Remove any socket left behind by a server that didn't shut down cleanly
+	unlink(socketPath.c_str());
+	if ((bind(listenSocket, (sockaddr*)&addr, sizeof(addr)) != 0) || (listen(listenSocket, 4) != 0))
+	{
+		mApp->Fail(StrFormat("Failed to listen on '%s'", socketPath.c_str()));
+		close(listenSocket);
+		mApp->DeleteSystem();
+		return false;
+	}
+
+	mApp->OutputLine(StrFormat("Listening on '%s'", socketPath.c_str()), OutputPri_Normal);
+
+	// Clients are served one at a time since builds can't overlap anyway
+	while (!mWantsShutdown)
+	{
+		int clientSocket = accept(listenSocket, NULL, NULL);
+		if (clientSocket == -1)
+			continue;
+		if (!HandleConnection(clientSocket))
+			mApp->OutputLine("Client connection ended with an error", OutputPri_Warning);
+		close(clientSocket);
+	}
+
+	close(listenSocket);
+	unlink(socketPath.c_str());
+	mApp->DeleteSystem();
+	return true;
+#endif
+}
+
+// Drives a running server with a series of small edits and reports the rebuild latency. Each edit appends a comment to
+//  one of the source files, cycling through them, and the original contents are restored from disk at the end.
+bool BootServer::RunBench(BootApp* app, const StringImpl& socketPath, int editCount)
+{
+#ifdef BF_PLATFORM_WINDOWS
+	app->Fail("Server mode requires Unix domain sockets and is not supported on this platform");
+	return false;
+#else
+	Array<String> filePaths;
+	for (auto& srcName : app->mRequestedSrc)
+		BootApp::FindQueuedFiles(GetAbsPath(srcName, app->mWorkingDir), filePaths);
+
+	Array<String> fileContents;
+	for (auto& filePath : filePaths)
+	{
+		int length = 0;
+		char* data = LoadTextData(filePath, &length);
+		if (data == NULL)
+		{
+			app->Fail(StrFormat("Unable to load file '%s'", filePath.c_str()));
+			return false;
+		}
+		fileContents.Add(String(data, length));
+		delete [] data;
+	}
+	if (filePaths.IsEmpty())
+	{
+		app->Fail("No source files to edit");
+		return false;
+	}
+
+	sockaddr_un addr;
+	if (!InitSocketAddr(socketPath, addr))
+	{
+		app->Fail(StrFormat("Socket path too long: '%s'", socketPath.c_str()));
+		return false;
+	}
+	int serverSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if ((serverSocket == -1) || (connect(serverSocket, (sockaddr*)&addr, sizeof(addr)) != 0))
+	{
+		app->Fail(StrFormat("Unable to connect to server at '%s'", socketPath.c_str()));
+		if (serverSocket != -1)
+			close(serverSocket);
+		return false;
+	}
+
+	BootServerConnection connection(serverSocket);
+
+	// Returns false if the connection was lost
+	auto _Build = [&](bool& outSuccess)
+	{
+		if (!connection.Write("BUILD\n"))
+			return false;
+		String line;
+		String data;
+		while (connection.ReadLine(line))
+		{
+			if (line.StartsWith("MSG "))
+			{
+				int spacePos = (int)line.IndexOf(' ', 4);
+				if ((spacePos == -1) || (!connection.ReadBytes(atoi(line.c_str() + spacePos + 1), data)))
+					return false;
+				if ((OutputPri)atoi(line.c_str() + 4) == OutputPri_Error)
+					app->OutputLine(data, OutputPri_Low);
+			}
+			else if (line.StartsWith("DONE "))
+			{
+				outSuccess = atoi(line.c_str() + 5) != 0;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	Array<double> latencies;
+	int failCount = 0;
+	bool connectionLost = false;
+	for (int editIdx = 0; editIdx < editCount; editIdx++)
+	{
+		int fileIdx = editIdx % (int)filePaths.size();
+		String content = fileContents[fileIdx];
+		// A comment-only edit would leave every typeDef unchanged, so each edit rewrites a method body and every other
+		//  edit of the same file also changes its signature, forcing the type to be rebuilt
+		bool changeSignature = ((editIdx / (int)filePaths.size()) % 2) != 0;
+		content += StrFormat("\n[AlwaysInclude]\nstatic class BeefBootBenchEdit%d\n{\n\t[AlwaysInclude]\n\tpublic static int Get(%s) { return %d; }\n}\n",
+			fileIdx, changeSignature ? "int arg" : "", editIdx);
+
+		int64 startTick = BfpSystem_GetCPUTick();
+		bool success = false;
+		if ((!connection.Write(StrFormat("FILE %d %s\n", (int)content.length(), filePaths[fileIdx].c_str()))) ||
+			(!connection.Write(content)) || (!_Build(success)))
+		{
+			connectionLost = true;
+			break;
+		}
+		latencies.Add((double)(BfpSystem_GetCPUTick() - startTick) * 1000.0 / (double)BfpSystem_GetCPUTickFreq());
+		if (!success)
+			failCount++;
+	}
+
+	if (!connectionLost)
+	{
+		for (int fileIdx = 0; fileIdx < BF_MIN(editCount, (int)filePaths.size()); fileIdx++)
+			connection.Write(StrFormat("RELOAD %s\n", filePaths[fileIdx].c_str()));
+		bool success = false;
+		_Build(success);
+	}
+	close(serverSocket);
+
+	if (connectionLost)
+		app->Fail(StrFormat("Lost connection to server after %d edits", (int)latencies.size()));
+	if (latencies.IsEmpty())
+		return false;
+
+	std::sort(latencies.begin(), latencies.end());
+	auto _GetPercentile = [&](int pct)
+	{
+		int idx = BF_MIN((int)latencies.size() * pct / 100, (int)latencies.size() - 1);
+		return latencies[idx];
+	};
+	app->OutputLine(StrFormat("Server bench: %d edits over %d files, %d failed. p50: %0.1f ms, p90: %0.1f ms, p99: %0.1f ms, max: %0.1f ms",
+		(int)latencies.size(), (int)filePaths.size(), failCount, _GetPercentile(50), _GetPercentile(90), _GetPercentile(99), latencies.back()));
+	return !connectionLost;
+#endif
+}
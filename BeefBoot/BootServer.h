@@ -0,0 +1,53 @@
+#pragma once
+
+#include "BootApp.h"
+
+NS_BF_BEGIN
+
+// Keeps the BfSystem, BfCompiler and their resolved types resident between builds so a build only pays for what
+//  changed since the last one. Clients talk to it over a Unix domain socket with a line-based protocol:
+//
+//  Requests
+//    FILE <length> <path>\n<length bytes>   Sets the content of a source file, adding it if it's new
+//    RELOAD <path>\n                        Re-reads a source file from disk, removing it if it no longer exists
+//    REMOVE <path>\n                        Removes a source file
+//    BUILD\n                                Builds with all the changes applied so far
+//    SHUTDOWN\n                             Stops the server
+//
+//  Responses to BUILD
+//    MSG <pri> <length>\n<length bytes>     A diagnostic or log line, pri is an OutputPri value
+//    OUTPUT <path>\n                        An object file used by the build
+//    DONE <success> <milliseconds>\n        Always the last line
+class BootServer
+{
+public:
+	struct OutputEntry
+	{
+		OutputPri mPri;
+		String mText;
+	};
+
+public:
+	BootApp* mApp;
+	Array<OutputEntry> mOutput;
+	bool mCapturingOutput;
+	bool mWantsShutdown;
+	int mBuildCount;
+
+protected:
+	bool HandleConnection(intptr socket);
+
+public:
+	BootServer(BootApp* app);
+	~BootServer();
+
+	void AddOutput(const StringImpl& text, OutputPri outputPri);
+	void SetFile(const StringImpl& path, const char* data, int length);
+	void RemoveFile(const StringImpl& path);
+	bool Build(Array<String>& outFileNames);
+	bool Run(const StringImpl& socketPath);
+
+	static bool RunBench(BootApp* app, const StringImpl& socketPath, int editCount);
+};
+
+NS_BF_END
@@ -0,0 +1,86 @@
+#include "BootState.h"
+#include "BeefySysLib/FileStream.h"
+
+USING_NS_BF;
+
+#define BOOTSTATE_FILE_ID 0xBEEF0B00
+#define BOOTSTATE_VERSION 2
+
+bool BootState::Read(const StringImpl& path)
+{
+	FileStream fileStream;
+	if (!fileStream.Open(path, "rb"))
+		return false;
+
+	if ((uint32)fileStream.ReadInt32() != BOOTSTATE_FILE_ID)
+		return false;
+	if (fileStream.ReadInt32() != BOOTSTATE_VERSION)
+		return false;
+
+	fileStream.ReadT(mConfigHash);
+
+	int numFiles = fileStream.ReadInt32();
+	for (int fileIdx = 0; fileIdx < numFiles; fileIdx++)
+	{
+		String fileName = fileStream.ReadAscii32SizedString();
+		FileEntry fileEntry;
+		fileStream.ReadT(fileEntry.mHash);
+		fileEntry.mSize = fileStream.ReadInt64();
+		mFiles[fileName] = fileEntry;
+	}
+
+	return !fileStream.mReadPastEnd;
+}
+
+bool BootState::Write(const StringImpl& path)
+{
+	FileStream fileStream;
+	if (!fileStream.Open(path, "wb"))
+		return false;
+
+	fileStream.Write((int)BOOTSTATE_FILE_ID);
+	fileStream.Write((int)BOOTSTATE_VERSION);
+	fileStream.WriteT(mConfigHash);
+
+	fileStream.Write((int)mFiles.size());
+	for (auto& pair : mFiles)
+	{
+		fileStream.Write(pair.mKey);
+		fileStream.WriteT(pair.mValue.mHash);
+		fileStream.Write(pair.mValue.mSize);
+	}
+
+	fileStream.Close();
+	return true;
+}
+
+bool BootState::AddFile(const StringImpl& path)
+{
+	int len = 0;
+	uint8* data = LoadBinaryData(path, &len);
+	if (data == NULL)
+		return false;
+
+	FileEntry fileEntry;
+	fileEntry.mHash = Hash128(data, len);
+	fileEntry.mSize = len;
+	mFiles[path] = fileEntry;
+	delete[] data;
+	return true;
+}
+
+bool BootState::FilesMatch(BootState& prevState)
+{
+	if (mFiles.size() != prevState.mFiles.size())
+		return false;
+
+	for (auto& pair : mFiles)
+	{
+		FileEntry* prevEntry = NULL;
+		if (!prevState.mFiles.TryGetValue(pair.mKey, &prevEntry))
+			return false;
+		if ((prevEntry->mSize != pair.mValue.mSize) || (prevEntry->mHash != pair.mValue.mHash))
+			return false;
+	}
+	return true;
+}
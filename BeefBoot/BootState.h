@@ -0,0 +1,35 @@
+#pragma once
+
+#include "BeefBoot.h"
+#include "BeefySysLib/util/String.h"
+#include "BeefySysLib/util/Dictionary.h"
+#include "BeefySysLib/util/Hash.h"
+
+NS_BF_BEGIN
+
+// What BeefBoot knew about the last successful build of a target. It's persisted in the build directory so the next
+//  run can skip the build when nothing has changed. This is all-or-nothing: if any source file, link input or build
+//  option differs, the whole workspace is compiled from scratch as before, with only the codegen build.dat cache
+//  reused. No type graph or dependency state is carried over between runs.
+class BootState
+{
+public:
+	struct FileEntry
+	{
+		Val128 mHash;
+		int64 mSize;
+	};
+
+public:
+	Val128 mConfigHash;
+	Dictionary<String, FileEntry> mFiles; // Source files and link inputs
+
+public:
+	bool Read(const StringImpl& path);
+	bool Write(const StringImpl& path);
+
+	bool AddFile(const StringImpl& path);
+	bool FilesMatch(BootState& prevState);
+};
+
+NS_BF_END
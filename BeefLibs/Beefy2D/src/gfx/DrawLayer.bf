@@ -28,6 +28,9 @@ namespace Beefy.gfx
         [StdCall, CLink]
         static extern void DrawLayer_DrawToRenderTarget(void* drawLayer, void* texture);
 
+        [StdCall, CLink]
+        static extern int32 DrawLayer_RecordStream(void* drawLayer, char8* fileName);
+
         public void* mNativeDrawLayer;
 
         public this(BFWindow window)
@@ -54,6 +57,12 @@ namespace Beefy.gfx
         {
             DrawLayer_DrawToRenderTarget(mNativeDrawLayer, texture.mNativeTextureSegment);
         }
+
+        /// Appends the queued draws to a stream that DrawLayer_RunMergeBenchmark can replay. Call before the layer is drawn.
+        public void RecordStream(StringView fileName)
+        {
+            DrawLayer_RecordStream(mNativeDrawLayer, fileName.ToScopeCStr!());
+        }
     }
 #else
     public class DrawLayer
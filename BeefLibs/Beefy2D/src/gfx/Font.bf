@@ -53,6 +53,18 @@ namespace Beefy.gfx
 		[StdCall, CLink]
 		static extern int32 FTFont_GetKerning(FTFont* font, int32 char8CodeA, int32 char8CodeB);
 
+		[StdCall, CLink]
+		static extern void FTFont_PrerasterizeRange(FTFont* ftFont, int32 firstCharCode, int32 lastCharCode);
+
+		[StdCall, CLink]
+		static extern bool FTFont_TouchGlyph(FTFont* ftFont, int32 char8Code, int32 atlasId);
+
+		[StdCall, CLink]
+		static extern int32* FTFont_GetAtlasFramePtr();
+
+		// Advanced every frame, cached CharData is touched once per frame so the native atlas won't evict it while in use
+		static int32* sAtlasFramePtr = FTFont_GetAtlasFramePtr();
+
 		static Dictionary<String, String> sFontNameMap ~ DeleteDictionaryAndKeysAndItems!(_);
 		static Monitor sMonitor = new .() ~ delete _;
 
@@ -75,6 +87,7 @@ namespace Beefy.gfx
 			public int32 mXOffset;
 			public int32 mYOffset;
 			public int32 mXAdvance;
+			public int32 mAtlasId;
 		}
 
         public class CharData
@@ -88,6 +101,9 @@ namespace Beefy.gfx
             public int32 mYOffset;
             public int32 mXAdvance;
 			public bool mIsCombiningMark;
+			public FTFont* mFTFont;
+			public int32 mAtlasId;
+			public int32 mAtlasFrame;
         }
 
         public class Page
@@ -460,6 +476,49 @@ namespace Beefy.gfx
 			return .OverC;
 		}
 
+		bool LoadCharData(char32 checkChar, CharData charData)
+		{
+			for (int fontIdx = -1; fontIdx < mAlternates.Count; fontIdx++)
+			{
+				FTFont* ftFont;
+				if (fontIdx == -1)
+					ftFont = mFTFont;
+				else
+					ftFont = mAlternates[fontIdx].mFont.mFTFont;
+				if (ftFont == null)
+					continue;
+
+				var ftGlyph = FTFont_AllocGlyph(ftFont, (int32)checkChar, fontIdx == mAlternates.Count - 1);
+				if (ftGlyph == null)
+					continue;
+
+				charData.mX = ftGlyph.mX;
+				charData.mY = ftGlyph.mY;
+				charData.mWidth = ftGlyph.mWidth;
+				charData.mHeight = ftGlyph.mHeight;
+				charData.mXAdvance = ftGlyph.mXAdvance;
+				charData.mXOffset = ftGlyph.mXOffset;
+				charData.mYOffset = ftGlyph.mYOffset;
+				charData.mFTFont = ftFont;
+				charData.mAtlasId = ftGlyph.mAtlasId;
+				charData.mAtlasFrame = *sAtlasFramePtr;
+				delete charData.mImageSegment;
+				charData.mImageSegment = new Image();
+				charData.mImageSegment.mNativeTextureSegment = ftGlyph.mTextureSegment;
+				charData.mImageSegment.mX = ftGlyph.mX;
+				charData.mImageSegment.mY = ftGlyph.mY;
+				charData.mImageSegment.mWidth = ftGlyph.mWidth;
+				charData.mImageSegment.mHeight = ftGlyph.mHeight;
+				charData.mImageSegment.mSrcWidth = ftGlyph.mWidth;
+				charData.mImageSegment.mSrcHeight = ftGlyph.mHeight;
+				charData.mIsCombiningMark = ((checkChar >= '\u{0300}') && (checkChar <= '\u{036F}')) || ((checkChar >= '\u{1DC0}') && (checkChar <= '\u{1DFF}'));
+				if (charData.mIsCombiningMark)
+					charData.mXAdvance = 0;
+				return true;
+			}
+			return false;
+		}
+
         CharData GetCharData(char32 checkChar)
         {
             CharData charData;
@@ -467,47 +526,25 @@ namespace Beefy.gfx
                 charData = mLowCharData[(int)checkChar];
             else
                 mCharData.TryGetValue(checkChar, out charData);
+			if ((charData != null) && (charData.mAtlasFrame != *sAtlasFramePtr))
+			{
+				charData.mAtlasFrame = *sAtlasFramePtr;
+				// The glyph may have been evicted since it was last used, in which case get its new placement
+				if (!FTFont_TouchGlyph(charData.mFTFont, (int32)checkChar, charData.mAtlasId))
+					LoadCharData(checkChar, charData);
+			}
             if (charData == null)
 			{
-				for (int fontIdx = -1; fontIdx < mAlternates.Count; fontIdx++)
+				charData = new CharData();
+				if (LoadCharData(checkChar, charData))
 				{
-					FTFont* ftFont;
-					if (fontIdx == -1)
-						ftFont = mFTFont;
-					else
-						ftFont = mAlternates[fontIdx].mFont.mFTFont;
-					if (ftFont == null)
-						continue;
-
-					var ftGlyph = FTFont_AllocGlyph(ftFont, (int32)checkChar, fontIdx == mAlternates.Count - 1);
-					if (ftGlyph == null)
-						continue;
-
-					charData = new CharData();
-					charData.mX = ftGlyph.mX;
-					charData.mY = ftGlyph.mY;
-					charData.mWidth = ftGlyph.mWidth;
-					charData.mHeight = ftGlyph.mHeight;
-					charData.mXAdvance = ftGlyph.mXAdvance;
-					charData.mXOffset = ftGlyph.mXOffset;
-					charData.mYOffset = ftGlyph.mYOffset;
-					charData.mImageSegment = new Image();
-					charData.mImageSegment.mNativeTextureSegment = ftGlyph.mTextureSegment;
-					charData.mImageSegment.mX = ftGlyph.mX;
-					charData.mImageSegment.mY = ftGlyph.mY;
-					charData.mImageSegment.mWidth = ftGlyph.mWidth;
-					charData.mImageSegment.mHeight = ftGlyph.mHeight;
-					charData.mImageSegment.mSrcWidth = ftGlyph.mWidth;
-					charData.mImageSegment.mSrcHeight = ftGlyph.mHeight;
-					charData.mIsCombiningMark = ((checkChar >= '\u{0300}') && (checkChar <= '\u{036F}')) || ((checkChar >= '\u{1DC0}') && (checkChar <= '\u{1DFF}'));
-					if (charData.mIsCombiningMark)
-						charData.mXAdvance = 0;
 					if ((checkChar >= (char32)0) && (checkChar < (char32)LOW_CHAR_COUNT))
 						mLowCharData[(int)checkChar] = charData;
 					else
 						mCharData[checkChar] = charData;
 	                return charData;
 				}
+				delete charData;
 				
 				if (checkChar == (char32)'?')
 					return null;
@@ -516,6 +553,13 @@ namespace Beefy.gfx
             return charData;
         }
 
+		/// Rasterizes a range of chars into the glyph atlas on a background thread, ie: ahead of showing CJK text
+		public void Prerasterize(char32 firstChar, char32 lastChar)
+		{
+			if (mFTFont != null)
+				FTFont_PrerasterizeRange(mFTFont, (int32)firstChar, (int32)lastChar);
+		}
+
 		MarkRefData GetMarkRefData()
 		{
 			if (mMarkRefData == null)
@@ -397,6 +397,19 @@ namespace Beefy.gfx
         }        
     }
 
+    /// Per-frame rendering statistics, laid out like the native DrawCounter enum
+    [CRepr]
+    public struct DrawCounters
+    {
+        public int64 mBatchesAllocated;
+        public int64 mBatchesMerged;
+        public int64 mBatchesDrawn;
+        public int64 mSetTextureCmds;
+        public int64 mVertices;
+        public int64 mIndices;
+        public int64 mFrameMicros;
+    }
+
 #if !STUDIO_CLIENT
     public class Graphics : GraphicsBase
     {               
@@ -432,6 +445,12 @@ namespace Beefy.gfx
 
         [StdCall, CLink]
         extern static void Gfx_SetTexture_TextureSegment(int32 textureIdx, void* textureSegment);
+
+        [StdCall, CLink]
+        extern static int32 Gfx_GetDrawCounters(int64* counters, int32 count);
+
+        [StdCall, CLink]
+        extern static void Gfx_SetMergeBatches(int32 mergeBatches);
         
         public this()
         {
@@ -487,6 +506,18 @@ namespace Beefy.gfx
         {
             Gfx_QueueRenderCmd(renderCmd.mNativeRenderCmd);
         }
+
+        /// Gets the counters of the last finished frame
+        public void GetDrawCounters(ref DrawCounters counters)
+        {
+            Gfx_GetDrawCounters((int64*)&counters, sizeof(DrawCounters) / sizeof(int64));
+        }
+
+        /// Batch merging lets draws with the same render state and textures share a draw call. It's on by default.
+        public void SetMergeBatches(bool mergeBatches)
+        {
+            Gfx_SetMergeBatches(mergeBatches ? 1 : 0);
+        }
         
         public void Draw(IDrawable drawable, float x = 0, float y = 0)
         {
@@ -18,7 +18,11 @@ namespace Beefy.gfx
 			None = 0,
 			Additive = 1,
 			NoPremult = 2,
-			AllowRead = 4
+			AllowRead = 4,
+			/// Loads through a block-compressed .bfi cache next to the file, building it when missing or stale
+			CompressBC1 = 8,
+			CompressBC3 = 0x10,
+			CompressBC7 = 0x20
 		}
 
         public Image mSrcTexture;
@@ -157,6 +157,9 @@ namespace Beefy.gfx
         [StdCall, CLink]
         extern static void ModelInstance_SetJointTranslation(void* nativeModelInstance, int32 jointIdx, ref ModelDef.JointTranslation jointTranslation);
 
+        [StdCall, CLink]
+        extern static void ModelInstance_SetAnimState(void* nativeModelInstance, void* nativeAnimation, float frame);
+
         [StdCall, CLink]
         extern static void ModelInstance_SetMeshVisibility(void* nativeModelInstance, int32 jointIdx, int32 visibility);
 
@@ -174,12 +177,7 @@ namespace Beefy.gfx
 
         public void RehupAnimState()
         {
-            for (int32 jointIdx = 0; jointIdx < mModelDef.mJointCount; jointIdx++)
-            {
-                ModelDef.JointTranslation jointTranslation;
-                mAnim.GetJointTranslation(jointIdx, mFrame, out jointTranslation);
-                SetJointTranslation(jointIdx, ref jointTranslation);
-            }
+            ModelInstance_SetAnimState(mNativeRenderCmd, mAnim.mNativeModelDefAnimation, mFrame);
         }
 
         public void Update()
@@ -18,6 +18,7 @@ namespace System.Reflection
 	    {
 	        mTypeInstance = typeInstance;
 	        mFieldData = fieldData;
+			typeInstance.[Friend]EnsureReflectNames();
 	    }
 
 	    public int32 MemberOffset
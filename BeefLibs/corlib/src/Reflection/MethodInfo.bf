@@ -62,6 +62,7 @@ namespace System.Reflection
 		{
 		    mTypeInstance = typeInstance;
 		    mMethodData = methodData;
+			typeInstance.[Friend]EnsureReflectNames();
 		}
 
 		public enum CallError
@@ -41,6 +41,7 @@ namespace System.Reflection
 	{
 		public override Result<FieldInfo> GetField(String fieldName)
 		{
+			EnsureReflectNames();
 		    for (int32 i = 0; i < mFieldDataCount; i++)
 		    {
 		        FieldData* fieldData = &mFieldDataPtr[i];
@@ -2,6 +2,7 @@ using System;
 using System.Reflection;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.Threading;
 
 namespace System
 {
@@ -578,7 +579,9 @@ namespace System.Reflection
         FieldData* mFieldDataPtr;
         void* mConstructorDataPtr;
         void** mCustomAttrDataPtr;
+        uint8* mReflectNamesPtr;
 
+		static Monitor sReflectNamesMonitor = new Monitor() ~ delete _;
 
         public override int32 InstanceSize
         {
@@ -684,8 +687,44 @@ namespace System.Reflection
             strBuffer.Append(mName);
         }
 
+		// Projects built with compact reflection leave the field, method and param mName values null. The names are
+		//  emitted together as null-terminated strings in field, method, param order, after a 'materialized' byte.
+		void EnsureReflectNames()
+		{
+			if ((mReflectNamesPtr == null) || (Interlocked.Load(ref *mReflectNamesPtr) != 0))
+				return;
+
+			using (sReflectNamesMonitor.Enter())
+			{
+				if (*mReflectNamesPtr != 0)
+					return;
+
+				char8* namePtr = (char8*)(mReflectNamesPtr + 1);
+				String NextName()
+				{
+					StringView name = .(namePtr);
+					namePtr += name.Length + 1;
+					// Interning keeps the identity comparisons in MethodInfo working
+					return scope String(name).Intern();
+				}
+
+				for (int fieldIdx < mFieldDataCount)
+					mFieldDataPtr[fieldIdx].mName = NextName();
+				for (int methodIdx < mMethodDataCount)
+				{
+					var methodData = ref mMethodDataPtr[methodIdx];
+					methodData.mName = NextName();
+					for (int paramIdx < methodData.mParamCount)
+						methodData.mParamData[paramIdx].mName = NextName();
+				}
+
+				Interlocked.Store(ref *mReflectNamesPtr, (uint8)1);
+			}
+		}
+
 		public override Result<FieldInfo> GetField(String fieldName)
 		{
+			EnsureReflectNames();
 		    for (int32 i = 0; i < mFieldDataCount; i++)
 		    {
 		        FieldData* fieldData = &mFieldDataPtr[i];
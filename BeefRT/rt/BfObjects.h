@@ -255,6 +255,7 @@ namespace bf
 				FieldData* mFieldDataPtr;
 				void* mConstructorDataPtr;
 				void** mCustomAttrDataPtr;
+				uint8* mReflectNamesPtr;
 			};
 		}
 
@@ -642,6 +642,21 @@ BF_EXPORT void BF_CALLTYPE Gfx_QueueRenderCmd(RenderCmd* renderCmd)
 	gBFApp->mRenderDevice->mCurDrawLayer->QueueRenderCmd(renderCmd);
 }
 
+// Fills in the DrawCounter values of the last finished frame
+BF_EXPORT int BF_CALLTYPE Gfx_GetDrawCounters(int64* counters, int count)
+{
+	RenderDevice* renderDevice = gBFApp->mRenderDevice;
+	count = BF_MIN(count, (int)DrawCounter_COUNT);
+	for (int counterIdx = 0; counterIdx < count; counterIdx++)
+		counters[counterIdx] = renderDevice->mPrevDrawCounters[counterIdx];
+	return count;
+}
+
+BF_EXPORT void BF_CALLTYPE Gfx_SetMergeBatches(int mergeBatches)
+{
+	gBFApp->mRenderDevice->mMergeBatches = mergeBatches != 0;
+}
+
 BF_EXPORT VertexDefinition* BF_CALLTYPE Gfx_CreateVertexDefinition(VertexDefData* elementData, int numElements)
 {
 	return gBFApp->mRenderDevice->CreateVertexDefinition(elementData, numElements);
@@ -1,8 +1,77 @@
 #include "HeadlessApp.h"
 #include "platform/PlatformHelper.h"
+#include "gfx/SoftRenderDevice.h"
 
 USING_NS_BF;
 
+HeadlessWindow::HeadlessWindow(BFWindow* parent, const StringImpl& title, int x, int y, int width, int height, int windowFlags)
+{
+	mParent = parent;
+	mFlags = windowFlags;
+	mX = x;
+	mY = y;
+	mWidth = width;
+	mHeight = height;
+	if (parent != NULL)
+		parent->mChildren.push_back(this);
+
+	mRenderWindow = new SoftRenderWindow((SoftRenderDevice*)gBFApp->mRenderDevice, this, width, height);
+	gBFApp->mRenderDevice->AddRenderWindow(mRenderWindow);
+}
+
+HeadlessWindow::~HeadlessWindow()
+{
+	if (mParent != NULL)
+		mParent->mChildren.Remove(this);
+}
+
+void HeadlessWindow::GetPosition(int* x, int* y, int* width, int* height, int* clientX, int* clientY, int* clientWidth, int* clientHeight)
+{
+	*x = mX;
+	*y = mY;
+	*width = mWidth;
+	*height = mHeight;
+	*clientX = mX;
+	*clientY = mY;
+	*clientWidth = mWidth;
+	*clientHeight = mHeight;
+}
+
+void HeadlessWindow::GetPlacement(int* normX, int* normY, int* normWidth, int* normHeight, int* showKind)
+{
+	*normX = mX;
+	*normY = mY;
+	*normWidth = mWidth;
+	*normHeight = mHeight;
+	*showKind = 0;
+}
+
+void HeadlessWindow::Resize(int x, int y, int width, int height, int showKind)
+{
+	mX = x;
+	mY = y;
+	mWidth = width;
+	mHeight = height;
+	((SoftRenderWindow*)mRenderWindow)->SetSize(width, height);
+	if (mMovedFunc != NULL)
+		mMovedFunc(this);
+}
+
+void HeadlessWindow::SetClientPosition(int x, int y)
+{
+	mX = x;
+	mY = y;
+	if (mMovedFunc != NULL)
+		mMovedFunc(this);
+}
+
+///
+
+HeadlessApp::~HeadlessApp()
+{
+	delete mRenderDevice;
+}
+
 void HeadlessApp::Init()
 {
     mRunning = true;
@@ -14,6 +83,9 @@ void HeadlessApp::Init()
 	});
 
 	mInstallDir = GetFileDir(exePath) + "/";
+
+	mRenderDevice = new SoftRenderDevice();
+	mRenderDevice->Init(this);
 }
 
 void HeadlessApp::Run()
@@ -24,3 +96,29 @@ void HeadlessApp::Run()
 		Process();
 	}
 }
+
+void HeadlessApp::Draw()
+{
+	mRenderDevice->FrameStart();
+	BFApp::Draw();
+	mRenderDevice->FrameEnd();
+}
+
+BFWindow* HeadlessApp::CreateNewWindow(BFWindow* parent, const StringImpl& title, int x, int y, int width, int height, int windowFlags)
+{
+	BFWindow* window = new HeadlessWindow(parent, title, x, y, width, height, windowFlags);
+	mWindowList.push_back(window);
+	return window;
+}
+
+DrawLayer* HeadlessApp::CreateDrawLayer(BFWindow* window)
+{
+	SoftDrawLayer* drawLayer = new SoftDrawLayer();
+	if (window != NULL)
+	{
+		drawLayer->mRenderWindow = window->mRenderWindow;
+		window->mRenderWindow->mDrawLayerList.push_back(drawLayer);
+	}
+	drawLayer->mRenderDevice = mRenderDevice;
+	return drawLayer;
+}
@@ -5,9 +5,48 @@
 
 NS_BF_BEGIN;
 
+class SoftRenderWindow;
+
+// A window that only exists as a software render target, so apps can draw and be measured without a display
+class HeadlessWindow : public BFWindow
+{
+public:
+	int						mX;
+	int						mY;
+	int						mWidth;
+	int						mHeight;
+
+public:
+	HeadlessWindow(BFWindow* parent, const StringImpl& title, int x, int y, int width, int height, int windowFlags);
+	~HeadlessWindow();
+
+	virtual void*			GetUnderlying() override { return NULL; }
+	virtual void			Destroy() override { }
+	virtual bool			TryClose() override { return true; }
+	virtual void			SetTitle(const char* title) override { }
+	virtual void			SetMinimumSize(int minWidth, int minHeight, bool clientSized) override { }
+	virtual void			GetPosition(int* x, int* y, int* width, int* height, int* clientX, int* clientY, int* clientWidth, int* clientHeight) override;
+	virtual void			GetPlacement(int* normX, int* normY, int* normWidth, int* normHeight, int* showKind) override;
+	virtual void			Resize(int x, int y, int width, int height, int showKind) override;
+	virtual void			SetClientPosition(int x, int y) override;
+	virtual void			SetMouseVisible(bool isMouseVisible) override { }
+	virtual void			SetAlpha(float alpha, uint32 destAlphaSrcMask, bool isMouseVisible) override { }
+	virtual void			SetForeground() override { }
+	virtual void			LostFocus(BFWindow* newFocus) override { }
+
+	virtual BFMenu*			AddMenuItem(BFMenu* parent, int insertIdx, const char* text, const char* hotKey, BFSysBitmap* bitmap, bool enabled, int checkState, bool radioCheck) override { return NULL; }
+	virtual void			ModifyMenuItem(BFMenu* item, const char* text, const char* hotKey, BFSysBitmap* bitmap, bool enabled, int checkState, bool radioCheck) override { }
+	virtual void			RemoveMenuItem(BFMenu* item) override { }
+};
+
 class HeadlessApp : public BFApp
 {
 public:
+	virtual void			Draw() override;
+
+public:
+	virtual ~HeadlessApp();
+
     virtual void			Init() override;
     virtual void			Run() override;
 
@@ -16,8 +55,8 @@ public:
 	virtual void			GetDesktopResolution(int& width, int& height) override { }
 	virtual void			GetWorkspaceRect(int& x, int& y, int& width, int& height) override {}
 
-	virtual BFWindow*		CreateNewWindow(BFWindow* parent, const StringImpl& title, int x, int y, int width, int height, int windowFlags) override { return NULL; }
-	virtual DrawLayer*		CreateDrawLayer(BFWindow* window) override { return NULL; }
+	virtual BFWindow*		CreateNewWindow(BFWindow* parent, const StringImpl& title, int x, int y, int width, int height, int windowFlags) override;
+	virtual DrawLayer*		CreateDrawLayer(BFWindow* window) override;
 
 	virtual void*			GetClipboardData(const StringImpl& format, int* size) override { return NULL; }
 	virtual void			ReleaseClipboardData(void* ptr) override { }
@@ -1,9 +1,16 @@
 #include "Common.h"
 #include "BFApp.h"
 #include "img/PSDReader.h"
+#include "img/ImageData.h"
+#include "img/ImageUtils.h"
+#include "img/PNGData.h"
+#include "img/BFIData.h"
+#include "img/BlockCompress.h"
+#include "util/Hash.h"
 #include "gfx/RenderDevice.h"
 #include "gfx/Texture.h"
 #include "util/PerfTimer.h"
+#include "util/FileEnumerator.h"
 
 USING_NS_BF;
 
@@ -56,6 +63,331 @@ BF_EXPORT TextureSegment* BF_CALLTYPE Res_PSD_GetMergedLayerTexture(PSDReader* p
 	return textureSegment;
 }
 
+// Merges the visible layers once with the scalar single-threaded blending and once with the SIMD and threaded paths,
+//  logging the timings. Returns the number of pixels that differ between the two, or -1 if the file can't be read.
+BF_EXPORT int BF_CALLTYPE Res_PSD_RunMergeBenchmark(const char* fileName, int passCount)
+{
+	int prevFlags = gImageProcessFlags;
+	PSDReader* psdReaders[2] = { NULL, NULL };
+	ImageData* mergedImages[2] = { NULL, NULL };
+	int elapsedMS[2] = { 0, 0 };
+
+	for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+	{
+		PSDReader* psdReader = new PSDReader();
+		psdReaders[modeIdx] = psdReader;
+		if (!psdReader->Init(fileName))
+			break;
+
+		std::vector<int> layerIndices;
+		for (int layerIdx = 0; layerIdx < (int)psdReader->mPSDLayerInfoVector.size(); layerIdx++)
+		{
+			if (psdReader->mPSDLayerInfoVector[layerIdx]->mVisible)
+				layerIndices.push_back(layerIdx);
+		}
+
+		gImageProcessFlags = (modeIdx == 0) ? (ImageProcessFlag_NoSimd | ImageProcessFlag_NoThreads) : prevFlags;
+		for (int passIdx = 0; passIdx <= passCount; passIdx++)
+		{
+			// Effect noise comes from rand()
+			srand(0);
+			uint32 startTick = BFTickCount();
+			ImageData* mergedImage = psdReader->CreateMergedImage(layerIndices);
+			// The first pass also loads the layer data, so it isn't counted
+			if (passIdx > 0)
+				elapsedMS[modeIdx] += (int)(BFTickCount() - startTick);
+			if ((passIdx == 0) && (mergedImage != NULL))
+			{
+				mergedImages[modeIdx] = mergedImage;
+				continue;
+			}
+			if (dynamic_cast<PSDLayerInfo*>(mergedImage) == NULL)
+				delete mergedImage;
+		}
+	}
+	gImageProcessFlags = prevFlags;
+
+	int numDiffPixels = -1;
+	ImageData* scalarImage = mergedImages[0];
+	ImageData* fastImage = mergedImages[1];
+	if ((scalarImage != NULL) && (fastImage != NULL))
+	{
+		if ((scalarImage->mX != fastImage->mX) || (scalarImage->mY != fastImage->mY) ||
+			(scalarImage->mWidth != fastImage->mWidth) || (scalarImage->mHeight != fastImage->mHeight))
+		{
+			numDiffPixels = scalarImage->mWidth * scalarImage->mHeight;
+		}
+		else
+		{
+			numDiffPixels = 0;
+			for (int i = 0; i < scalarImage->mWidth * scalarImage->mHeight; i++)
+			{
+				if (scalarImage->mBits[i] != fastImage->mBits[i])
+					numDiffPixels++;
+			}
+		}
+
+		OutputDebugStrF("PSD merge %s: %dx%d  Scalar: %dms  Fast: %dms  Passes: %d  DiffPixels: %d\n", fileName,
+			fastImage->mWidth, fastImage->mHeight, elapsedMS[0], elapsedMS[1], passCount, numDiffPixels);
+	}
+
+	for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+	{
+		if (dynamic_cast<PSDLayerInfo*>(mergedImages[modeIdx]) == NULL)
+			delete mergedImages[modeIdx];
+		delete psdReaders[modeIdx];
+	}
+	return numDiffPixels;
+}
+
+// Compares getting a single layer out of a PSD against the eager approach of reading every layer through a FileStream
+//  one after another. Logs the time to the first layer and the decoded pixel memory for both and returns the lazy time
+//  in microseconds, or -1 if the file can't be read.
+BF_EXPORT int BF_CALLTYPE Res_PSD_RunLoadBenchmark(const char* fileName, int layerIdx)
+{
+	int prevFlags = gImageProcessFlags;
+	int64 elapsedMicros[2] = { -1, -1 };
+	int64 decodedBytes[2] = { 0, 0 };
+	uint64 layerHashes[2] = { 0, 0 };
+	
+	for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+	{
+		bool isEager = modeIdx == 1;
+		gImageProcessFlags = isEager ? ImageProcessFlag_NoThreads : prevFlags;
+
+		uint64 startTick = BFGetTickCountMicro();
+		PSDReader* psdReader = new PSDReader();
+		psdReader->mUseMappedFile = !isEager;
+		if ((!psdReader->Init(fileName)) || (layerIdx < 0) || (layerIdx >= (int)psdReader->mPSDLayerInfoVector.size()))
+		{
+			delete psdReader;
+			break;
+		}
+
+		if (isEager)
+		{
+			for (auto layerInfo : psdReader->mPSDLayerInfoVector)
+				layerInfo->ReadData();
+		}
+		else
+		{
+			std::vector<int> layerIndices;
+			layerIndices.push_back(layerIdx);
+			psdReader->ReadLayerData(layerIndices);
+		}
+		elapsedMicros[modeIdx] = (int64)(BFGetTickCountMicro() - startTick);
+
+		for (auto layerInfo : psdReader->mPSDLayerInfoVector)
+		{
+			if (layerInfo->mBits != NULL)
+				decodedBytes[modeIdx] += (int64)layerInfo->mWidth * layerInfo->mHeight * sizeof(uint32);
+		}
+		PSDLayerInfo* layerInfo = psdReader->mPSDLayerInfoVector[layerIdx];
+		layerHashes[modeIdx] = Hash64(layerInfo->mBits, layerInfo->mWidth * layerInfo->mHeight * (int)sizeof(uint32));
+		delete psdReader;
+	}
+	gImageProcessFlags = prevFlags;
+
+	if ((elapsedMicros[0] < 0) || (elapsedMicros[1] < 0))
+		return -1;
+
+	OutputDebugStrF("PSD load %s layer %d  Lazy: %lldus %lldKB  Eager: %lldus %lldKB  Match: %s\n", fileName, layerIdx,
+		(long long)elapsedMicros[0], (long long)(decodedBytes[0] / 1024), (long long)elapsedMicros[1], (long long)(decodedBytes[1] / 1024),
+		(layerHashes[0] == layerHashes[1]) ? "yes" : "NO");
+	return (int)elapsedMicros[0];
+}
+
+static int CountDiffPixels(ImageData* imageA, ImageData* imageB)
+{
+	if ((imageA->mWidth != imageB->mWidth) || (imageA->mHeight != imageB->mHeight))
+		return BF_MAX(imageA->mWidth * imageA->mHeight, imageB->mWidth * imageB->mHeight);
+	int numDiffPixels = 0;
+	for (int i = 0; i < imageA->mWidth * imageA->mHeight; i++)
+	{
+		if (imageA->mBits[i] != imageB->mBits[i])
+			numDiffPixels++;
+	}
+	return numDiffPixels;
+}
+
+// Decodes and encodes every PNG in a directory with libpng and with the fast path, logging the timings and encoded sizes
+//  per file. Returns the number of pixels that differ between the two decoders plus any that don't survive a round trip
+//  through the fast encoder, or -1 if no files could be read.
+BF_EXPORT int BF_CALLTYPE Res_RunPNGBenchmark(const char* dirName, int passCount)
+{
+	int prevFlags = gImageProcessFlags;
+	int numFiles = 0;
+	int numDiffPixels = 0;
+	int64 totalMicros[2][2] = { { 0, 0 }, { 0, 0 } };
+	int64 totalSizes[2] = { 0, 0 };
+
+	for (auto& fileEntry : FileEnumerator(dirName, FileEnumerator::Flags_Files))
+	{
+		String filePath = fileEntry.GetFilePath();
+		if (!filePath.EndsWith(".png", String::CompareKind_OrdinalIgnoreCase))
+			continue;
+		int dataLen = 0;
+		uint8* data = LoadBinaryData(filePath, &dataLen);
+		if (data == NULL)
+			continue;
+
+		// Mode 0 is libpng, mode 1 is the fast path
+		PNGData* images[2] = { NULL, NULL };
+		int64 decodeMicros[2] = { 0, 0 };
+		int64 encodeMicros[2] = { 0, 0 };
+		int64 encodedSizes[2] = { 0, 0 };
+		String tempPath = filePath + ".bench.tmp";
+		for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+		{
+			gImageProcessFlags = (modeIdx == 0) ? ((prevFlags | ImageProcessFlag_LibPNG) & ~ImageProcessFlag_FastPNGDecode) :
+				((prevFlags & ~ImageProcessFlag_LibPNG) | ImageProcessFlag_FastPNGDecode);
+			for (int passIdx = 0; passIdx < BF_MAX(passCount, 1); passIdx++)
+			{
+				PNGData* image = new PNGData();
+				image->SetSrcData(data, dataLen);
+				uint64 startTick = BFGetTickCountMicro();
+				bool success = image->ReadData();
+				decodeMicros[modeIdx] += (int64)(BFGetTickCountMicro() - startTick);
+				image->mSrcData = NULL;
+				if ((!success) || (passIdx > 0))
+				{
+					delete image;
+					continue;
+				}
+				images[modeIdx] = image;
+			}
+			if (images[modeIdx] == NULL)
+				continue;
+
+			for (int passIdx = 0; passIdx < BF_MAX(passCount, 1); passIdx++)
+			{
+				uint64 startTick = BFGetTickCountMicro();
+				images[modeIdx]->WriteToFile(tempPath);
+				encodeMicros[modeIdx] += (int64)(BFGetTickCountMicro() - startTick);
+			}
+			FileStream encodedStream;
+			if (encodedStream.Open(tempPath, "rb"))
+				encodedSizes[modeIdx] = encodedStream.GetSize();
+		}
+		gImageProcessFlags = prevFlags;
+		delete [] data;
+
+		if ((images[0] != NULL) && (images[1] != NULL))
+		{
+			// The last file written came from the fast encoder, read it back with libpng to check it
+			PNGData roundTripImage;
+			gImageProcessFlags = prevFlags & ~ImageProcessFlag_FastPNGDecode;
+			bool roundTripped = roundTripImage.LoadFromFile(tempPath);
+			gImageProcessFlags = prevFlags;
+
+			int fileDiffPixels = CountDiffPixels(images[0], images[1]);
+			int roundTripDiffPixels = roundTripped ? CountDiffPixels(images[1], &roundTripImage) : images[1]->mWidth * images[1]->mHeight;
+			numDiffPixels += fileDiffPixels + roundTripDiffPixels;
+			numFiles++;
+			for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+			{
+				totalMicros[modeIdx][0] += decodeMicros[modeIdx];
+				totalMicros[modeIdx][1] += encodeMicros[modeIdx];
+				totalSizes[modeIdx] += encodedSizes[modeIdx];
+			}
+
+			OutputDebugStrF("PNG %s: %dx%d  Decode libpng: %lldus Fast: %lldus  Encode libpng: %lldus %lldKB Fast: %lldus %lldKB  DiffPixels: %d RoundTripDiffPixels: %d\n",
+				filePath.c_str(), images[1]->mWidth, images[1]->mHeight, (long long)decodeMicros[0], (long long)decodeMicros[1],
+				(long long)encodeMicros[0], (long long)(encodedSizes[0] / 1024), (long long)encodeMicros[1], (long long)(encodedSizes[1] / 1024),
+				fileDiffPixels, roundTripDiffPixels);
+		}
+		BfpFile_Delete(tempPath.c_str(), NULL);
+		delete images[0];
+		delete images[1];
+	}
+
+	if (numFiles == 0)
+		return -1;
+
+	OutputDebugStrF("PNG total %d files, %d passes  Decode libpng: %lldus Fast: %lldus  Encode libpng: %lldus %lldKB Fast: %lldus %lldKB  DiffPixels: %d\n",
+		numFiles, passCount, (long long)totalMicros[0][0], (long long)totalMicros[1][0], (long long)totalMicros[0][1], (long long)(totalSizes[0] / 1024),
+		(long long)totalMicros[1][1], (long long)(totalSizes[1] / 1024), numDiffPixels);
+	return numDiffPixels;
+}
+
+// Encodes an image as BC1, BC3 and BC7 with the scalar single-threaded search and with the SIMD and threaded one,
+//  logging the throughput and the PSNR of the decoded result. Returns the BC7 color PSNR in hundredths of a dB, or -1 if
+//  the file can't be read or the two searches produced different blocks.
+BF_EXPORT int BF_CALLTYPE Res_RunBlockCompressBenchmark(const char* fileName, int passCount)
+{
+	ImageData* source = BFIData::LoadSourceImage(fileName);
+	if (source == NULL)
+		return -1;
+
+	const int hwBitsTypes[3] = { HWBITS_BC1, HWBITS_BC3, HWBITS_BC7 };
+	const char* formatNames[3] = { "BC1", "BC3", "BC7" };
+	int prevFlags = gImageProcessFlags;
+	int numPasses = BF_MAX(passCount, 1);
+	int numPixels = source->mWidth * source->mHeight;
+	std::vector<uint32> decodedBits(numPixels);
+	bool matched = true;
+	int result = -1;
+
+	for (int formatIdx = 0; formatIdx < 3; formatIdx++)
+	{
+		int hwBitsType = hwBitsTypes[formatIdx];
+		int dataSize = BlockCompressedSize(hwBitsType, source->mWidth, source->mHeight);
+		std::vector<uint8> encodedData[2];
+		int64 encodeMicros[2] = { 0, 0 };
+		for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+		{
+			encodedData[modeIdx].resize(dataSize);
+			gImageProcessFlags = (modeIdx == 0) ? (prevFlags | ImageProcessFlag_NoSimd | ImageProcessFlag_NoThreads) : prevFlags;
+			for (int passIdx = 0; passIdx < numPasses; passIdx++)
+			{
+				uint64 startTick = BFGetTickCountMicro();
+				BlockCompress(hwBitsType, source->mBits, source->mWidth, source->mHeight, &encodedData[modeIdx][0]);
+				encodeMicros[modeIdx] += (int64)(BFGetTickCountMicro() - startTick);
+			}
+		}
+		gImageProcessFlags = prevFlags;
+		bool formatMatched = encodedData[0] == encodedData[1];
+		matched &= formatMatched;
+
+		uint64 startTick = BFGetTickCountMicro();
+		BlockDecompress(hwBitsType, &encodedData[1][0], source->mWidth, source->mHeight, &decodedBits[0]);
+		int64 decodeMicros = (int64)(BFGetTickCountMicro() - startTick);
+
+		// Color isn't counted where BC1 punched a pixel out to transparent black
+		double colorErr = 0;
+		double alphaErr = 0;
+		int numColorPixels = 0;
+		for (int pixelIdx = 0; pixelIdx < numPixels; pixelIdx++)
+		{
+			uint32 srcColor = source->mBits[pixelIdx];
+			uint32 decodedColor = decodedBits[pixelIdx];
+			bool countColor = (hwBitsType != HWBITS_BC1) || ((decodedColor >> 24) != 0);
+			if (countColor)
+				numColorPixels++;
+			for (int channelIdx = 0; channelIdx < 4; channelIdx++)
+			{
+				int diff = (int)((srcColor >> (channelIdx * 8)) & 0xFF) - (int)((decodedColor >> (channelIdx * 8)) & 0xFF);
+				if (channelIdx == 3)
+					alphaErr += diff * diff;
+				else if (countColor)
+					colorErr += diff * diff;
+			}
+		}
+		double colorPSNR = (colorErr > 0) ? 10.0 * log10(255.0 * 255.0 * numColorPixels * 3 / colorErr) : 99.0;
+		double alphaPSNR = (alphaErr > 0) ? 10.0 * log10(255.0 * 255.0 * numPixels / alphaErr) : 99.0;
+		if (hwBitsType == HWBITS_BC7)
+			result = (int)(colorPSNR * 100);
+
+		OutputDebugStrF("%s %s: %dx%d  %dKB of %dKB  Scalar: %.1f MPix/s  Fast: %.1f MPix/s  Decode: %.1f MPix/s  PSNR RGB: %.2fdB A: %.2fdB  Match: %s\n",
+			formatNames[formatIdx], fileName, source->mWidth, source->mHeight, dataSize / 1024, numPixels * 4 / 1024,
+			(double)numPixels * numPasses / BF_MAX(encodeMicros[0], (int64)1), (double)numPixels * numPasses / BF_MAX(encodeMicros[1], (int64)1),
+			(double)numPixels / BF_MAX(decodeMicros, (int64)1), colorPSNR, alphaPSNR, formatMatched ? "yes" : "NO");
+	}
+
+	delete source;
+	return matched ? result : -1;
+}
+
 BF_EXPORT int BF_CALLTYPE Res_PSD_GetLayerCount(PSDReader* pSDReader)
 {
 	return (int) pSDReader->mPSDLayerInfoVector.size();
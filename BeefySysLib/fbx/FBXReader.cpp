@@ -1522,139 +1522,12 @@ bool FBXReader::ReadFile(const StringImpl& fileName, bool loadAnims)
 
 bool Beefy::FBXReader::WriteBFFile(const StringImpl& fileName, const StringImpl& checkFile, const StringImpl& checkFile2)
 {
-	FILE* fp = fopen(fileName.c_str(), "wb");
-	if (fp == NULL)
-		return false;
-
-	FileStream fs;
-	fs.mFP = fp;
-
-	String fileDir = GetFileDir(checkFile);
-
-	fs.Write(BF_MODEL_VERSION);
-	fs.Write(GetFileName(checkFile));
-	fs.Write(GetFileTimeWrite(checkFile));
-	fs.Write(GetFileName(checkFile2));
-	fs.Write(GetFileTimeWrite(checkFile2));
-	
-	fs.Write(mModelDef->mFrameRate);
-
-	fs.Write((int)mModelDef->mMeshes.size());
-	for (int meshIdx = 0; meshIdx < (int)mModelDef->mMeshes.size(); meshIdx++)
-	{
-		ModelMesh* modelMesh = &mModelDef->mMeshes[meshIdx];
-		fs.Write(modelMesh->mName);
-
-		fs.Write((int)modelMesh->mIndices.size());
-		fs.Write((void*)&modelMesh->mIndices[0], modelMesh->mIndices.size() * sizeof(modelMesh->mIndices[0]));
-
-		fs.Write((int) modelMesh->mVertices.size());
-		fs.Write((void*)&modelMesh->mVertices[0], modelMesh->mVertices.size() * sizeof(modelMesh->mVertices[0]));
-
-		fs.Write(modelMesh->mTexFileName);
-		fs.Write(modelMesh->mBumpFileName);		
-	}
-
-	fs.Write((int)mModelDef->mJoints.size());
-	for (int jointIdx = 0; jointIdx < (int)mModelDef->mJoints.size(); jointIdx++)
-	{
-		ModelJoint* modelJoint = &mModelDef->mJoints[jointIdx];
-		fs.Write(modelJoint->mName);
-		fs.Write(modelJoint->mParentIdx);
-		fs.WriteT(modelJoint->mPoseInvMatrix);
-	}
-
-	fs.Write((int)mModelDef->mAnims.size());
-	for (int animIdx = 0; animIdx < (int)mModelDef->mAnims.size(); animIdx++)
-	{
-		ModelAnimation* modelAnim = &mModelDef->mAnims[animIdx];
-		fs.Write(modelAnim->mName);
-		
-		fs.Write((int)modelAnim->mFrames.size());
-		for (int frameIdx = 0; frameIdx < (int)modelAnim->mFrames.size(); frameIdx++)
-		{
-			ModelAnimationFrame* frame = &modelAnim->mFrames[frameIdx];
-			BF_ASSERT(mModelDef->mJoints.size() == frame->mJointTranslations.size());
-			fs.Write((void*)&frame->mJointTranslations[0], (int)frame->mJointTranslations.size() * sizeof(frame->mJointTranslations[0]));
-		}
-	}
-	
-	return true;
+	return mModelDef->WriteCache(fileName, checkFile, checkFile2);
 }
 
 bool Beefy::FBXReader::ReadBFFile(const StringImpl& fileName)
 {
-	FILE* fp = fopen(fileName.c_str(), "rb");
-	if (fp == NULL)
-		return false;
-
-	FileStream fs;
-	fs.mFP = fp;
-
-	int version = fs.ReadInt32();
-	if (version != BF_MODEL_VERSION)
-		return false;
-
-	String fileDir = GetFileDir(fileName);
-
-	String checkFileName = fs.ReadAscii32SizedString();
-	int64 storedTime = fs.ReadInt64();
-	int64 localTime = GetFileTimeWrite(fileDir + checkFileName);	
-	if (storedTime != localTime)
-		return false;
-
-	checkFileName = fs.ReadAscii32SizedString();	
-	storedTime = fs.ReadInt64();
-	if (checkFileName.length() != 0)
-	{
-		localTime = GetFileTimeWrite(fileDir + checkFileName);
-		if (storedTime != localTime)
-			return false;
-	}
-
-	mModelDef->mFrameRate = fs.ReadFloat();
-
-	mModelDef->mMeshes.resize(fs.ReadInt32());
-	for (int meshIdx = 0; meshIdx < (int) mModelDef->mMeshes.size(); meshIdx++)
-	{
-		ModelMesh* modelMesh = &mModelDef->mMeshes[meshIdx];
-		modelMesh->mName = fs.ReadAscii32SizedString();
-
-		modelMesh->mIndices.resize(fs.ReadInt32());
-		fs.Read((void*)&modelMesh->mIndices[0], modelMesh->mIndices.size() * sizeof(modelMesh->mIndices[0]));
-
-		modelMesh->mVertices.resize(fs.ReadInt32());
-		fs.Read((void*)&modelMesh->mVertices[0], modelMesh->mVertices.size() * sizeof(modelMesh->mVertices[0]));
-
-		modelMesh->mTexFileName = fs.ReadAscii32SizedString();
-		modelMesh->mBumpFileName = fs.ReadAscii32SizedString();
-	}
-
-	mModelDef->mJoints.resize(fs.ReadInt32());
-	for (int jointIdx = 0; jointIdx < (int)mModelDef->mJoints.size(); jointIdx++)
-	{
-		ModelJoint* modelJoint = &mModelDef->mJoints[jointIdx];
-		modelJoint->mName = fs.ReadAscii32SizedString();
-		modelJoint->mParentIdx = fs.ReadInt32();
-		fs.ReadT(modelJoint->mPoseInvMatrix);
-	}
-
-	mModelDef->mAnims.resize(fs.ReadInt32());
-	for (int animIdx = 0; animIdx < (int)mModelDef->mAnims.size(); animIdx++)
-	{
-		ModelAnimation* modelAnim = &mModelDef->mAnims[animIdx];
-		modelAnim->mName = fs.ReadAscii32SizedString();
-
-		modelAnim->mFrames.resize(fs.ReadInt32());
-		for (int frameIdx = 0; frameIdx < (int)modelAnim->mFrames.size(); frameIdx++)
-		{
-			ModelAnimationFrame* frame = &modelAnim->mFrames[frameIdx];
-			frame->mJointTranslations.resize(mModelDef->mJoints.size());
-			fs.Read((void*)&frame->mJointTranslations[0], (int)frame->mJointTranslations.size() * sizeof(frame->mJointTranslations[0]));
-		}
-	}
-
-	return true;
+	return mModelDef->ReadCache(fileName);
 }
 
 ////
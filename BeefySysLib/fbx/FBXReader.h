@@ -14,8 +14,6 @@ NS_BF_BEGIN;
 
 #define BF_MAX_NUM_BONES 256
 
-#define BF_MODEL_VERSION 1
-
 struct FBXBoneWeight
 {
 public:
@@ -3,8 +3,11 @@
 #include "gfx/Texture.h"
 #include "gfx/RenderDevice.h"
 #include "gfx/Shader.h"
+#include "gfx/FTFont.h"
 #include "util/PerfTimer.h"
 #include "util/BeefPerf.h"
+#include "util/Dictionary.h"
+#include <float.h>
 
 USING_NS_BF;
 
@@ -17,8 +20,6 @@ DrawBatch::DrawBatch()
 	mIdxIdx = 0;	
 	mAllocatedVertices = 0;
 	mAllocatedIndices = 0;	
-	mIsIndexBufferHead = false;
-	mIsVertexBufferHead = false;
 	mVertices = NULL;		
 	mIndices = NULL;
 	mRenderState = NULL;
@@ -36,6 +37,7 @@ void DrawBatch::Clear()
 {
 	mVtxIdx = 0;
 	mIdxIdx = 0;
+	mMergeNext = NULL;
 	for (int texIdx = 0; texIdx < MAX_TEXTURES; texIdx++)
 		mCurTextures[texIdx] = (Texture*)(intptr)-1;
 }
@@ -44,15 +46,8 @@ void DrawBatch::Free()
 {	
 	RenderDevice* renderDevice = mDrawLayer->mRenderDevice;
 
-	if (mIsVertexBufferHead)
-		renderDevice->mPooledVertexBuffers.FreeMemoryBlock(mVertices);
-	if (mIsIndexBufferHead)
-		renderDevice->mPooledIndexBuffers.FreeMemoryBlock(mIndices);
-
-	mIsVertexBufferHead = false;
-	mIsIndexBufferHead = false;
-
 	Clear();
+	mNext = NULL;
 	auto& pool = renderDevice->mDrawBatchPool;
 	pool.push_back(this);
 }
@@ -68,7 +63,7 @@ void* DrawBatch::AllocTris(int vtxCount)
 {
 	int idxCount = vtxCount;
 
-	if ((mRenderState != gBFApp->mRenderDevice->mCurRenderState) || (idxCount + mIdxIdx >= mAllocatedIndices))
+	if ((mRenderState != mDrawLayer->mRenderDevice->mCurRenderState) || (idxCount + mIdxIdx >= mAllocatedIndices))
 	{
 		if (mVtxIdx > 0)
 		{
@@ -76,7 +71,7 @@ void* DrawBatch::AllocTris(int vtxCount)
 			return nextBatch->AllocTris(vtxCount);
 		}
 		
-		mRenderState = gBFApp->mRenderDevice->mCurRenderState;		
+		mRenderState = mDrawLayer->mRenderDevice->mCurRenderState;		
 	}
 
 	uint16* idxPtr = mIndices + mIdxIdx;
@@ -95,7 +90,7 @@ void* DrawBatch::AllocStrip(int vtxCount)
 {
 	int idxCount = (vtxCount - 2) * 3;
 
-	if ((mRenderState != gBFApp->mRenderDevice->mCurRenderState) || (idxCount + mIdxIdx >= mAllocatedIndices))
+	if ((mRenderState != mDrawLayer->mRenderDevice->mCurRenderState) || (idxCount + mIdxIdx >= mAllocatedIndices))
 	{			
 		if (mVtxIdx > 0)
 		{			
@@ -103,7 +98,7 @@ void* DrawBatch::AllocStrip(int vtxCount)
 			return nextBatch->AllocStrip(vtxCount);
 		}
 					
-		mRenderState = gBFApp->mRenderDevice->mCurRenderState;		
+		mRenderState = mDrawLayer->mRenderDevice->mCurRenderState;		
 	}
 
 	uint16* idxPtr = mIndices + mIdxIdx;	
@@ -126,7 +121,7 @@ void* DrawBatch::AllocStrip(int vtxCount)
 
 void DrawBatch::AllocIndexed(int vtxCount, int idxCount, void** verticesOut, uint16** indicesOut, uint16* idxOfsOut)
 {	
-	if ((mRenderState != gBFApp->mRenderDevice->mCurRenderState) || (idxCount + mIdxIdx > mAllocatedIndices))
+	if ((mRenderState != mDrawLayer->mRenderDevice->mCurRenderState) || (idxCount + mIdxIdx > mAllocatedIndices))
 	{			
 		if (mVtxIdx > 0)
 		{			
@@ -134,7 +129,7 @@ void DrawBatch::AllocIndexed(int vtxCount, int idxCount, void** verticesOut, uin
 			return nextBatch->AllocIndexed(vtxCount, idxCount, verticesOut, indicesOut, idxOfsOut);
 		}
 				
-		mRenderState = gBFApp->mRenderDevice->mCurRenderState;		
+		mRenderState = mDrawLayer->mRenderDevice->mCurRenderState;		
 	}
 
 	*verticesOut = (uint8*)mVertices + (mVtxIdx * mVtxSize);
@@ -158,13 +153,52 @@ DrawLayer::DrawLayer()
 	mVtxByteIdx = 0;
 	mRenderCmdByteIdx = 0;
 	mCurDrawBatch = NULL;
+	mNumUsedVtxBlocks = 0;
+	mNumUsedIdxBlocks = 0;
+	mNumUsedRenderCmdBlocks = 0;
+	mNeedsMerge = false;
 	for (int textureIdx = 0; textureIdx < MAX_TEXTURES; textureIdx++)
 		mCurTextures[textureIdx] = NULL;
 }
 
 DrawLayer::~DrawLayer()
 {
-	NOP;
+	if (mRenderDevice == NULL)
+		return;
+	for (auto block : mVtxBlocks)
+		mRenderDevice->mPooledVertexBuffers.FreeMemoryBlock(block);
+	for (auto block : mIdxBlocks)
+		mRenderDevice->mPooledIndexBuffers.FreeMemoryBlock(block);
+	for (auto block : mRenderCmdBlocks)
+		mRenderDevice->mPooledRenderCmdBuffers.FreeMemoryBlock(block);
+}
+
+void* DrawLayer::AllocBlock(Array<void*>& blocks, int& numUsedBlocks, MemoryPool& pool)
+{
+	if (numUsedBlocks == (int)blocks.size())
+		blocks.Add(pool.AllocMemoryBlock());
+	return blocks[numUsedBlocks++];
+}
+
+void DrawLayer::AllocBuffers(int vtxBytes, int idxBytes, void** verticesOut, uint16** indicesOut)
+{
+	BF_ASSERT(mCurDrawBatch == NULL);
+
+	if (vtxBytes > DRAWBUFFER_VTXBUFFER_SIZE - mVtxByteIdx)
+	{
+		mVtxBuffer = AllocBlock(mVtxBlocks, mNumUsedVtxBlocks, mRenderDevice->mPooledVertexBuffers);
+		mVtxByteIdx = 0;
+	}
+	*verticesOut = (uint8*)mVtxBuffer + mVtxByteIdx;
+	mVtxByteIdx += vtxBytes;
+
+	if (idxBytes > DRAWBUFFER_IDXBUFFER_SIZE - mIdxByteIdx)
+	{
+		mIdxBuffer = AllocBlock(mIdxBlocks, mNumUsedIdxBlocks, mRenderDevice->mPooledIndexBuffers);
+		mIdxByteIdx = 0;
+	}
+	*indicesOut = (uint16*)((uint8*)mIdxBuffer + mIdxByteIdx);
+	mIdxByteIdx += idxBytes;
 }
 
 void DrawLayer::CloseDrawBatch()
@@ -182,6 +216,7 @@ void DrawLayer::QueueRenderCmd(RenderCmd* renderCmd)
 	CloseDrawBatch();
 	mRenderCmdList.PushBack(renderCmd);	
 	renderCmd->CommandQueued(this);
+	mNeedsMerge = true;
 }
 
 DrawBatch* DrawLayer::AllocateBatch(int minVtxCount, int minIdxCount)
@@ -213,6 +248,8 @@ DrawBatch* DrawLayer::AllocateBatch(int minVtxCount, int minIdxCount)
 		pool.pop_back();
 	}
 	drawBatch->mDrawLayer = this;	
+	for (int texIdx = 0; texIdx < MAX_TEXTURES; texIdx++)
+		drawBatch->mCurTextures[texIdx] = mCurTextures[texIdx];
 
 	int needIdxBytes = minIdxCount * sizeof(uint16);
 	int needVtxBytes = minVtxCount * vtxSize;
@@ -222,30 +259,26 @@ DrawBatch* DrawLayer::AllocateBatch(int minVtxCount, int minIdxCount)
 		//mVtxByteIdx = ((mVtxByteIdx + vtxSize - 1) / vtxSize) * vtxSize;
 		drawBatch->mVertices = (Vertex3D*)((uint8*) mVtxBuffer + mVtxByteIdx);
 		drawBatch->mAllocatedVertices = (int)((DRAWBUFFER_VTXBUFFER_SIZE - mVtxByteIdx) / vtxSize);
-		drawBatch->mIsVertexBufferHead = false;
 	}
 	else
 	{		
-		mVtxBuffer = mRenderDevice->mPooledVertexBuffers.AllocMemoryBlock();
+		mVtxBuffer = AllocBlock(mVtxBlocks, mNumUsedVtxBlocks, mRenderDevice->mPooledVertexBuffers);
 		mVtxByteIdx = 0;
 		drawBatch->mVertices = (Vertex3D*)mVtxBuffer;
 		drawBatch->mAllocatedVertices = DRAWBUFFER_VTXBUFFER_SIZE / vtxSize;
-		drawBatch->mIsVertexBufferHead = true;
 	}
 
 	if (needIdxBytes < DRAWBUFFER_IDXBUFFER_SIZE - mIdxByteIdx)
 	{
 		drawBatch->mIndices = (uint16*)((uint8*)mIdxBuffer + mIdxByteIdx);		
 		drawBatch->mAllocatedIndices = (DRAWBUFFER_IDXBUFFER_SIZE - mIdxByteIdx) / sizeof(uint16);
-		drawBatch->mIsIndexBufferHead = false;
 	}
 	else
 	{		
-		mIdxBuffer = mRenderDevice->mPooledIndexBuffers.AllocMemoryBlock();
+		mIdxBuffer = AllocBlock(mIdxBlocks, mNumUsedIdxBlocks, mRenderDevice->mPooledIndexBuffers);
 		mIdxByteIdx = 0;
 		drawBatch->mIndices = (uint16*)mIdxBuffer;
 		drawBatch->mAllocatedIndices = DRAWBUFFER_IDXBUFFER_SIZE / sizeof(uint16);
-		drawBatch->mIsIndexBufferHead = true;
 	}
 
 	drawBatch->mAllocatedIndices = std::min(drawBatch->mAllocatedVertices, drawBatch->mAllocatedIndices);
@@ -253,17 +286,239 @@ DrawBatch* DrawLayer::AllocateBatch(int minVtxCount, int minIdxCount)
 	
 	mRenderCmdList.PushBack(drawBatch);
 	mCurDrawBatch = drawBatch;
+	mNeedsMerge = true;
+	mRenderDevice->mDrawCounters[DrawCounter_BatchesAllocated]++;
 
 	return drawBatch;
 }
 
+// How far back a batch may move to join an earlier batch with the same state
+#define DRAWMERGE_MAX_LOOKBACK 64
+
+static bool IsTextureBound(Texture* texture)
+{
+	// NULL marks a slot that a model instance has bound behind the layer's back
+	return (texture != NULL) && (texture != (Texture*)(intptr)-1);
+}
+
+void DrawLayer::BindTextures(Texture** textures, Texture** boundTextures)
+{
+	for (int texIdx = 0; texIdx < MAX_TEXTURES; texIdx++)
+	{
+		Texture* texture = textures[texIdx];
+		if ((!IsTextureBound(texture)) || (boundTextures[texIdx] == texture))
+			continue;
+		mRenderCmdList.PushBack(CreateSetTextureCmd(texIdx, texture));
+		boundTextures[texIdx] = texture;
+	}
+}
+
+void DrawLayer::AddMergeBatch(DrawBatch* drawBatch)
+{
+	DrawMergeGroup newGroup;
+	newGroup.mHead = drawBatch;
+	newGroup.mTail = drawBatch;
+	newGroup.mVtxCount = drawBatch->mVtxIdx;
+	newGroup.mIdxCount = drawBatch->mIdxIdx;
+	newGroup.mMinX = FLT_MAX;
+	newGroup.mMinY = FLT_MAX;
+	newGroup.mMaxX = -FLT_MAX;
+	newGroup.mMaxY = -FLT_MAX;
+
+	// All vertex formats start with their position
+	uint8* vtxPtr = (uint8*)drawBatch->mVertices;
+	for (int vtxIdx = 0; vtxIdx < drawBatch->mVtxIdx; vtxIdx++)
+	{
+		float* pos = (float*)vtxPtr;
+		newGroup.mMinX = BF_MIN(newGroup.mMinX, pos[0]);
+		newGroup.mMinY = BF_MIN(newGroup.mMinY, pos[1]);
+		newGroup.mMaxX = BF_MAX(newGroup.mMaxX, pos[0]);
+		newGroup.mMaxY = BF_MAX(newGroup.mMaxY, pos[1]);
+		vtxPtr += drawBatch->mVtxSize;
+	}
+
+	// Join the latest group with the same state, as long as nothing drawn since that group overlaps this batch
+	int minGroupIdx = BF_MAX((int)mMergeGroups.size() - DRAWMERGE_MAX_LOOKBACK, 0);
+	for (int groupIdx = (int)mMergeGroups.size() - 1; groupIdx >= minGroupIdx; groupIdx--)
+	{
+		auto& group = mMergeGroups[groupIdx];
+		DrawBatch* headBatch = group.mHead;
+
+		bool sameState = (headBatch->mRenderState == drawBatch->mRenderState) && (headBatch->mVtxSize == drawBatch->mVtxSize) &&
+			(memcmp(headBatch->mCurTextures, drawBatch->mCurTextures, sizeof(drawBatch->mCurTextures)) == 0);
+		if ((sameState) &&
+			(group.mVtxCount + newGroup.mVtxCount <= 0x10000) &&
+			((group.mVtxCount + newGroup.mVtxCount) * drawBatch->mVtxSize <= DRAWBUFFER_VTXBUFFER_SIZE) &&
+			((group.mIdxCount + newGroup.mIdxCount) * (int)sizeof(uint16) <= DRAWBUFFER_IDXBUFFER_SIZE))
+		{
+			group.mTail->mMergeNext = drawBatch;
+			group.mTail = drawBatch;
+			group.mVtxCount += newGroup.mVtxCount;
+			group.mIdxCount += newGroup.mIdxCount;
+			group.mMinX = BF_MIN(group.mMinX, newGroup.mMinX);
+			group.mMinY = BF_MIN(group.mMinY, newGroup.mMinY);
+			group.mMaxX = BF_MAX(group.mMaxX, newGroup.mMaxX);
+			group.mMaxY = BF_MAX(group.mMaxY, newGroup.mMaxY);
+			return;
+		}
+
+		if ((group.mMinX < newGroup.mMaxX) && (newGroup.mMinX < group.mMaxX) &&
+			(group.mMinY < newGroup.mMaxY) && (newGroup.mMinY < group.mMaxY))
+			break;
+	}
+
+	mMergeGroups.Add(newGroup);
+}
+
+void DrawLayer::FlushMergeGroups(Texture** boundTextures)
+{
+	for (auto& group : mMergeGroups)
+	{
+		DrawBatch* headBatch = group.mHead;
+		BindTextures(headBatch->mCurTextures, boundTextures);
+
+		if (headBatch->mMergeNext != NULL)
+		{
+			int vtxSize = headBatch->mVtxSize;
+			void* vertices;
+			uint16* indices;
+			AllocBuffers(group.mVtxCount * vtxSize, group.mIdxCount * sizeof(uint16), &vertices, &indices);
+
+			int vtxCount = 0;
+			int idxCount = 0;
+			DrawBatch* checkBatch = headBatch;
+			while (checkBatch != NULL)
+			{
+				DrawBatch* nextBatch = checkBatch->mMergeNext;
+				memcpy((uint8*)vertices + vtxCount * vtxSize, checkBatch->mVertices, checkBatch->mVtxIdx * vtxSize);
+				for (int idxIdx = 0; idxIdx < checkBatch->mIdxIdx; idxIdx++)
+					indices[idxCount + idxIdx] = (uint16)(checkBatch->mIndices[idxIdx] + vtxCount);
+				vtxCount += checkBatch->mVtxIdx;
+				idxCount += checkBatch->mIdxIdx;
+				if (checkBatch != headBatch)
+				{
+					checkBatch->Free();
+					mRenderDevice->mDrawCounters[DrawCounter_BatchesMerged]++;
+				}
+				checkBatch = nextBatch;
+			}
+
+			headBatch->mVertices = vertices;
+			headBatch->mIndices = indices;
+			headBatch->mVtxIdx = vtxCount;
+			headBatch->mIdxIdx = idxCount;
+			headBatch->mAllocatedVertices = vtxCount;
+			headBatch->mAllocatedIndices = idxCount;
+			headBatch->mMergeNext = NULL;
+		}
+
+		headBatch->mNext = NULL;
+		mRenderCmdList.PushBack(headBatch);
+	}
+	mMergeGroups.Clear();
+}
+
+// Rebuilds the command list so batches that share a render state and textures are drawn together. A batch only moves
+//  earlier, and only past batches whose bounds it doesn't overlap, so the result looks the same as the original order.
+//  Commands other than batches and texture bindings are barriers that nothing moves across.
+void DrawLayer::MergeBatches()
+{
+	BP_ZONE("DrawLayer::MergeBatches");
+
+	CloseDrawBatch();
+	mNeedsMerge = false;
+
+	// streamTextures follows the bindings of the original list, boundTextures the bindings of the rebuilt one
+	Texture* streamTextures[MAX_TEXTURES];
+	Texture* boundTextures[MAX_TEXTURES];
+	for (int texIdx = 0; texIdx < MAX_TEXTURES; texIdx++)
+	{
+		streamTextures[texIdx] = (Texture*)(intptr)-1;
+		boundTextures[texIdx] = (Texture*)(intptr)-1;
+	}
+
+	RenderCmd* curRenderCmd = mRenderCmdList.mHead;
+	mRenderCmdList.ClearFast();
+	mMergeGroups.Clear();
+
+	while (true)
+	{
+		RenderCmd* nextRenderCmd = (curRenderCmd != NULL) ? curRenderCmd->mNext : NULL;
+
+		if (auto setTextureCmd = dynamic_cast<SetTextureCmd*>(curRenderCmd))
+		{
+			// Dropped here, it lives in the layer's command blocks so there's nothing to free
+			streamTextures[setTextureCmd->mTextureIdx] = setTextureCmd->mTexture;
+			curRenderCmd = nextRenderCmd;
+			continue;
+		}
+
+		auto drawBatch = dynamic_cast<DrawBatch*>(curRenderCmd);
+		if (drawBatch != NULL)
+		{
+			if (drawBatch->mVtxIdx == 0)
+			{
+				drawBatch->Free();
+				curRenderCmd = nextRenderCmd;
+				continue;
+			}
+
+			// Bounds are only meaningful for screen-space geometry, so anything using the depth buffer stays in place
+			RenderState* renderState = drawBatch->mRenderState;
+			if ((renderState != NULL) && (!renderState->mWriteDepthBuffer) && (renderState->mDepthFunc == DepthFunc_Always) &&
+				(drawBatch->mVtxSize >= (int)sizeof(float) * 2))
+			{
+				drawBatch->mMergeNext = NULL;
+				AddMergeBatch(drawBatch);
+				curRenderCmd = nextRenderCmd;
+				continue;
+			}
+		}
+
+		FlushMergeGroups(boundTextures);
+		// Leave the bindings the way the original list had them, both for this command and for anything added later
+		BindTextures(streamTextures, boundTextures);
+		if (curRenderCmd == NULL)
+			break;
+
+		curRenderCmd->mNext = NULL;
+		mRenderCmdList.PushBack(curRenderCmd);
+		if (drawBatch == NULL)
+		{
+			// We can't know what the command binds
+			for (int texIdx = 0; texIdx < MAX_TEXTURES; texIdx++)
+				boundTextures[texIdx] = (Texture*)(intptr)-1;
+		}
+		curRenderCmd = nextRenderCmd;
+	}
+}
+
 void DrawLayer::Draw()
 {
 	BP_ZONE("DrawLayer::Draw");
 
+	// Glyphs rasterized since the last draw are staged, so get them onto their textures first
+	FTFontManager::FlushUploads();
+
+	if ((mNeedsMerge) && (mRenderDevice->mMergeBatches))
+		MergeBatches();
+
+	int64* drawCounters = mRenderDevice->mDrawCounters;
 	RenderCmd* curRenderCmd = mRenderCmdList.mHead;
 	while (curRenderCmd != NULL)
 	{
+		if (auto drawBatch = dynamic_cast<DrawBatch*>(curRenderCmd))
+		{
+			if (drawBatch->mVtxIdx > 0)
+			{
+				drawCounters[DrawCounter_BatchesDrawn]++;
+				drawCounters[DrawCounter_Vertices] += drawBatch->mVtxIdx;
+				drawCounters[DrawCounter_Indices] += drawBatch->mIdxIdx;
+			}
+		}
+		else if (dynamic_cast<SetTextureCmd*>(curRenderCmd) != NULL)
+			drawCounters[DrawCounter_SetTextureCmds]++;
+
 		curRenderCmd->Render(mRenderDevice, mRenderWindow);
 		curRenderCmd = curRenderCmd->mNext;
 	}	
@@ -298,8 +553,12 @@ void DrawLayer::Clear()
 	mVtxByteIdx = 0;
 	mRenderCmdByteIdx = 0;*/
 
+	// Rewind the blocks rather than returning them, the next frame will need about as many
+	mNumUsedVtxBlocks = 0;
+	mNumUsedIdxBlocks = 0;
+	mNumUsedRenderCmdBlocks = 0;
 	mIdxBuffer = NULL;
-	mVtxByteIdx = 0;
+	mVtxBuffer = NULL;
 	mRenderCmdBuffer = NULL;
 	mIdxByteIdx = DRAWBUFFER_IDXBUFFER_SIZE;
 	mVtxByteIdx = DRAWBUFFER_VTXBUFFER_SIZE;
@@ -307,6 +566,7 @@ void DrawLayer::Clear()
 
 	mRenderCmdList.Clear();
 	mCurDrawBatch = NULL;
+	mNeedsMerge = false;
 }
 
 void* DrawLayer::AllocTris(int vtxCount)
@@ -392,3 +652,434 @@ BF_EXPORT void BF_CALLTYPE DrawLayer_DrawToRenderTarget(DrawLayer* drawLayer, Te
 	drawLayer->Draw();
 	renderDevice->mCurRenderTarget = prevTarget;
 }
+
+//
+
+static Dictionary<void*, int> gDrawStreamIds;
+
+static int GetDrawStreamId(void* ptr)
+{
+	int* idPtr = NULL;
+	if (gDrawStreamIds.TryAdd(ptr, NULL, &idPtr))
+		*idPtr = (int)gDrawStreamIds.GetCount();
+	return *idPtr;
+}
+
+// Appends the layer's queued commands to a text stream as one frame, before any merging, so DrawLayer_RunMergeBenchmark
+//  can replay real workloads without a device. One command per line:
+//    state <id> <vertexSize> <mergeable>
+//    tex <slot> <id>
+//    draw <vtxCount> <idxCount> <minX> <minY> <maxX> <maxY>
+//    cmd
+//    frame
+BF_EXPORT int BF_CALLTYPE DrawLayer_RecordStream(DrawLayer* drawLayer, const char* fileName)
+{
+	FILE* fp = fopen(fileName, "a");
+	if (fp == NULL)
+		return 0;
+
+	drawLayer->CloseDrawBatch();
+
+	RenderState* prevRenderState = NULL;
+	int numCmds = 0;
+	for (RenderCmd* renderCmd = drawLayer->mRenderCmdList.mHead; renderCmd != NULL; renderCmd = renderCmd->mNext)
+	{
+		numCmds++;
+		if (auto setTextureCmd = dynamic_cast<SetTextureCmd*>(renderCmd))
+		{
+			fprintf(fp, "tex %d %d\n", setTextureCmd->mTextureIdx, GetDrawStreamId(setTextureCmd->mTexture));
+			continue;
+		}
+
+		auto drawBatch = dynamic_cast<DrawBatch*>(renderCmd);
+		if (drawBatch == NULL)
+		{
+			fprintf(fp, "cmd\n");
+			prevRenderState = NULL;
+			continue;
+		}
+		if ((drawBatch->mVtxIdx == 0) || (drawBatch->mRenderState == NULL))
+			continue;
+
+		RenderState* renderState = drawBatch->mRenderState;
+		if (renderState != prevRenderState)
+		{
+			bool mergeable = (!renderState->mWriteDepthBuffer) && (renderState->mDepthFunc == DepthFunc_Always);
+			fprintf(fp, "state %d %d %d\n", GetDrawStreamId(renderState), drawBatch->mVtxSize, mergeable ? 1 : 0);
+			prevRenderState = renderState;
+		}
+
+		float minX = FLT_MAX;
+		float minY = FLT_MAX;
+		float maxX = -FLT_MAX;
+		float maxY = -FLT_MAX;
+		uint8* vtxPtr = (uint8*)drawBatch->mVertices;
+		for (int vtxIdx = 0; vtxIdx < drawBatch->mVtxIdx; vtxIdx++)
+		{
+			float* pos = (float*)vtxPtr;
+			minX = BF_MIN(minX, pos[0]);
+			minY = BF_MIN(minY, pos[1]);
+			maxX = BF_MAX(maxX, pos[0]);
+			maxY = BF_MAX(maxY, pos[1]);
+			vtxPtr += drawBatch->mVtxSize;
+		}
+		fprintf(fp, "draw %d %d %g %g %g %g\n", drawBatch->mVtxIdx, drawBatch->mIdxIdx, minX, minY, maxX, maxY);
+	}
+	fprintf(fp, "frame\n");
+	fclose(fp);
+	return numCmds;
+}
+
+//
+
+DrawStreamPlayer::DrawStreamPlayer()
+{
+	mNumFrames = 0;
+	mMinX = FLT_MAX;
+	mMinY = FLT_MAX;
+	mMaxX = -FLT_MAX;
+	mMaxY = -FLT_MAX;
+	mEntryIdx = 0;
+	mDrawIdx = 0;
+}
+
+DrawStreamPlayer::~DrawStreamPlayer()
+{
+	for (auto& kv : mRenderStates)
+		delete kv.mValue;
+	for (auto& kv : mShaders)
+		delete kv.mValue;
+}
+
+void DrawStreamPlayer::FillVertex(void* vertex, int vertexSize, int cornerIdx, int drawIdx)
+{
+	float* pos = (float*)vertex;
+	memset(pos + 2, 0, vertexSize - sizeof(float) * 2);
+	if (vertexSize >= (int)sizeof(float) * 3)
+		pos[2] = (float)(drawIdx & 0xFFFF);
+}
+
+bool DrawStreamPlayer::Load(const char* fileName)
+{
+	FILE* fp = fopen(fileName, "r");
+	if (fp == NULL)
+		return false;
+
+	char line[256];
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		DrawStreamEntry entry = { 0, { 0, 0, 0 }, { 0, 0, 0, 0 } };
+		char kind[16] = { 0 };
+		if (sscanf(line, "%15s", kind) != 1)
+			continue;
+		entry.mKind = kind[0];
+		if (strcmp(kind, "state") == 0)
+			sscanf(line, "%*s %d %d %d", &entry.mArgs[0], &entry.mArgs[1], &entry.mArgs[2]);
+		else if (strcmp(kind, "tex") == 0)
+			sscanf(line, "%*s %d %d", &entry.mArgs[0], &entry.mArgs[1]);
+		else if (strcmp(kind, "draw") == 0)
+		{
+			sscanf(line, "%*s %d %d %f %f %f %f", &entry.mArgs[0], &entry.mArgs[1], &entry.mBounds[0], &entry.mBounds[1], &entry.mBounds[2], &entry.mBounds[3]);
+			mMinX = BF_MIN(mMinX, entry.mBounds[0]);
+			mMinY = BF_MIN(mMinY, entry.mBounds[1]);
+			mMaxX = BF_MAX(mMaxX, entry.mBounds[2]);
+			mMaxY = BF_MAX(mMaxY, entry.mBounds[3]);
+		}
+		else if (strcmp(kind, "frame") == 0)
+			mNumFrames++;
+		else if (strcmp(kind, "cmd") != 0)
+			continue;
+		mEntries.Add(entry);
+	}
+	fclose(fp);
+	return true;
+}
+
+void DrawStreamPlayer::Rewind()
+{
+	mEntryIdx = 0;
+	mDrawIdx = 0;
+}
+
+bool DrawStreamPlayer::PlayFrame(DrawLayer* drawLayer)
+{
+	RenderDevice* renderDevice = drawLayer->mRenderDevice;
+	while (mEntryIdx < (int)mEntries.size())
+	{
+		DrawStreamEntry& entry = mEntries[mEntryIdx++];
+		if (entry.mKind == 's')
+		{
+			RenderState** renderStatePtr = NULL;
+			if (mRenderStates.TryAdd(entry.mArgs[0], NULL, &renderStatePtr))
+			{
+				Shader** shaderPtr = NULL;
+				if (mShaders.TryAdd(entry.mArgs[1], NULL, &shaderPtr))
+				{
+					*shaderPtr = CreateShader(entry.mArgs[1]);
+					(*shaderPtr)->mVertexSize = entry.mArgs[1];
+				}
+				*renderStatePtr = renderDevice->CreateRenderState(NULL);
+				(*renderStatePtr)->mShader = *shaderPtr;
+				(*renderStatePtr)->mWriteDepthBuffer = entry.mArgs[2] == 0;
+			}
+			renderDevice->SetRenderState(*renderStatePtr);
+		}
+		else if (entry.mKind == 't')
+		{
+			drawLayer->SetTexture(entry.mArgs[0], GetTexture(entry.mArgs[1]));
+		}
+		else if (entry.mKind == 'c')
+		{
+			drawLayer->SetShaderConstantData(0, NULL, 0);
+		}
+		else if (entry.mKind == 'd')
+		{
+			if (renderDevice->mCurRenderState == NULL)
+				continue;
+			int vtxSize = renderDevice->mCurRenderState->mShader->mVertexSize;
+			int numQuads = BF_MAX(entry.mArgs[1] / 6, 1);
+			for (int quadIdx = 0; quadIdx < numQuads; quadIdx++)
+			{
+				void* vertices;
+				uint16* indices;
+				uint16 idxOfs;
+				drawLayer->AllocIndexed(4, 6, &vertices, &indices, &idxOfs);
+				for (int cornerIdx = 0; cornerIdx < 4; cornerIdx++)
+				{
+					float* pos = (float*)((uint8*)vertices + cornerIdx * vtxSize);
+					pos[0] = entry.mBounds[(cornerIdx & 1) ? 2 : 0];
+					pos[1] = entry.mBounds[(cornerIdx & 2) ? 3 : 1];
+					FillVertex(pos, vtxSize, cornerIdx, mDrawIdx);
+				}
+				indices[0] = idxOfs;
+				indices[1] = idxOfs + 1;
+				indices[2] = idxOfs + 2;
+				indices[3] = idxOfs + 2;
+				indices[4] = idxOfs + 1;
+				indices[5] = idxOfs + 3;
+			}
+			mDrawIdx++;
+		}
+		else if (entry.mKind == 'f')
+			return true;
+	}
+	return false;
+}
+
+//
+
+namespace
+{
+	class HeadlessShader : public Shader
+	{
+	public:
+		virtual ShaderParam* GetShaderParam(const StringImpl& name) override { return NULL; }
+	};
+
+	class HeadlessRenderDevice : public RenderDevice
+	{
+	public:
+		// Stands in for the device's dynamic vertex and index buffers
+		Array<uint8> mUploadBuffer;
+		int mUploadByteIdx;
+		// When verifying, triangles are filled as their bounding boxes into a coarse image
+		Array<uint32> mImage;
+		int mImageSize;
+		float mImageX;
+		float mImageY;
+		float mImageScale;
+		Texture* mBoundTexture;
+
+	public:
+		HeadlessRenderDevice()
+		{
+			mUploadBuffer.Resize(1024 * 1024);
+			mUploadByteIdx = 0;
+			mImageSize = 64;
+			mImageX = 0;
+			mImageY = 0;
+			mImageScale = 1.0f;
+			mBoundTexture = NULL;
+		}
+
+		void FillRect(float minX, float minY, float maxX, float maxY, uint32 color)
+		{
+			// Cells are covered when their centers are, so rects that only share an edge don't touch
+			int x0 = BF_MAX((int)ceilf((minX - mImageX) * mImageScale - 0.5f), 0);
+			int y0 = BF_MAX((int)ceilf((minY - mImageY) * mImageScale - 0.5f), 0);
+			int x1 = BF_MIN((int)ceilf((maxX - mImageX) * mImageScale - 0.5f) - 1, mImageSize - 1);
+			int y1 = BF_MIN((int)ceilf((maxY - mImageY) * mImageScale - 0.5f) - 1, mImageSize - 1);
+			for (int y = y0; y <= y1; y++)
+				for (int x = x0; x <= x1; x++)
+					mImage[y * mImageSize + x] = color;
+		}
+
+		void Upload(const void* data, int size)
+		{
+			if (mUploadByteIdx + size > (int)mUploadBuffer.size())
+				mUploadByteIdx = 0;
+			memcpy(&mUploadBuffer[mUploadByteIdx], data, size);
+			mUploadByteIdx += size;
+		}
+
+		virtual void PhysSetRenderState(RenderState* renderState) override { mPhysRenderState = renderState; }
+		virtual void PhysSetRenderTarget(Texture* renderTarget) override {}
+		virtual bool Init(BFApp* app) override { return true; }
+		virtual void FrameStart() override {}
+		virtual Texture* LoadTexture(ImageData* imageData, int flags) override { return NULL; }
+		virtual Texture* CreateDynTexture(int width, int height) override { return NULL; }
+		virtual Texture* CreateRenderTarget(int width, int height, bool destAlpha) override { return NULL; }
+		virtual Shader* LoadShader(const StringImpl& fileName, VertexDefinition* vertexDefinition) override { return NULL; }
+		virtual void SetRenderState(RenderState* renderState) override { mCurRenderState = renderState; }
+	};
+
+	class HeadlessDrawBatch : public DrawBatch
+	{
+	public:
+		virtual void Render(RenderDevice* renderDevice, RenderWindow* renderWindow) override
+		{
+			if (mVtxIdx == 0)
+				return;
+			HeadlessRenderDevice* headlessDevice = (HeadlessRenderDevice*)renderDevice;
+			if (renderDevice->mPhysRenderState != mRenderState)
+				renderDevice->PhysSetRenderState(mRenderState);
+			headlessDevice->Upload(mVertices, mVtxIdx * mVtxSize);
+			headlessDevice->Upload(mIndices, mIdxIdx * sizeof(uint16));
+			if (headlessDevice->mImage.IsEmpty())
+				return;
+
+			// Each triangle is colored by the bound texture and the draw it came from, kept in its first vertex's z
+			for (int idxIdx = 0; idxIdx + 2 < mIdxIdx; idxIdx += 3)
+			{
+				float* pos[3];
+				for (int i = 0; i < 3; i++)
+					pos[i] = (float*)((uint8*)mVertices + mIndices[idxIdx + i] * mVtxSize);
+				uint32 color = (uint32)(intptr)headlessDevice->mBoundTexture * 31 + (uint32)pos[0][2];
+				headlessDevice->FillRect(BF_MIN(BF_MIN(pos[0][0], pos[1][0]), pos[2][0]), BF_MIN(BF_MIN(pos[0][1], pos[1][1]), pos[2][1]),
+					BF_MAX(BF_MAX(pos[0][0], pos[1][0]), pos[2][0]), BF_MAX(BF_MAX(pos[0][1], pos[1][1]), pos[2][1]), color);
+			}
+		}
+	};
+
+	class HeadlessSetTextureCmd : public SetTextureCmd
+	{
+	public:
+		virtual void Render(RenderDevice* renderDevice, RenderWindow* renderWindow) override
+		{
+			HeadlessRenderDevice* headlessDevice = (HeadlessRenderDevice*)renderDevice;
+			if (mTextureIdx == 0)
+				headlessDevice->mBoundTexture = mTexture;
+		}
+	};
+
+	class HeadlessCmd : public RenderCmd
+	{
+	public:
+		virtual void Render(RenderDevice* renderDevice, RenderWindow* renderWindow) override {}
+	};
+
+	class HeadlessDrawLayer : public DrawLayer
+	{
+	public:
+		virtual DrawBatch* CreateDrawBatch() override { return new HeadlessDrawBatch(); }
+
+		virtual RenderCmd* CreateSetTextureCmd(int textureIdx, Texture* texture) override
+		{
+			HeadlessSetTextureCmd* setTextureCmd = AllocRenderCmd<HeadlessSetTextureCmd>();
+			setTextureCmd->mTextureIdx = textureIdx;
+			setTextureCmd->mTexture = texture;
+			return setTextureCmd;
+		}
+
+		virtual void SetShaderConstantData(int slotIdx, void* constData, int size) override
+		{
+			QueueRenderCmd(AllocRenderCmd<HeadlessCmd>());
+		}
+	};
+
+	class MergeStreamPlayer : public DrawStreamPlayer
+	{
+	public:
+		virtual Shader* CreateShader(int vertexSize) override { return new HeadlessShader(); }
+	};
+}
+
+// Replays a stream written by DrawLayer_RecordStream through a headless device with and without batch merging. A first
+//  untimed pass fills every frame into a coarse image in both modes to check that merging doesn't change what ends up
+//  on screen. Textures are fake pointers.
+BF_EXPORT int BF_CALLTYPE DrawLayer_RunMergeBenchmark(const char* fileName, int passCount)
+{
+	MergeStreamPlayer player;
+	if (!player.Load(fileName))
+		return -1;
+	int numFrames = player.mNumFrames;
+
+	HeadlessRenderDevice* renderDevice = new HeadlessRenderDevice();
+	HeadlessDrawLayer* drawLayer = new HeadlessDrawLayer();
+	drawLayer->mRenderDevice = renderDevice;
+	drawLayer->Clear();
+	if (player.mMaxX > player.mMinX)
+	{
+		renderDevice->mImageX = player.mMinX;
+		renderDevice->mImageY = player.mMinY;
+		renderDevice->mImageScale = (renderDevice->mImageSize - 1) / BF_MAX(player.mMaxX - player.mMinX, player.mMaxY - player.mMinY);
+	}
+
+	int64 elapsedMicros[2] = { 0, 0 };
+	int64 batchesDrawn[2] = { 0, 0 };
+	int64 textureCmds[2] = { 0, 0 };
+	int mismatchedFrames = 0;
+	Array<uint32> frameImages;
+	for (int passIdx = -1; passIdx < BF_MAX(passCount, 1); passIdx++)
+	{
+		bool verify = passIdx < 0;
+		for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+		{
+			int frameIdx = 0;
+			renderDevice->mMergeBatches = modeIdx == 1;
+			renderDevice->mPhysRenderState = NULL;
+			renderDevice->mCurRenderState = NULL;
+			renderDevice->mBoundTexture = NULL;
+			renderDevice->mImage.Clear();
+			if (verify)
+				renderDevice->mImage.Resize(renderDevice->mImageSize * renderDevice->mImageSize);
+			drawLayer->Clear();
+			player.Rewind();
+
+			uint64 startTick = BFGetTickCountMicro();
+			while (player.PlayFrame(drawLayer))
+			{
+				drawLayer->Draw();
+				renderDevice->FrameEnd();
+				drawLayer->Clear();
+				if (verify)
+				{
+					int imageSize = (int)renderDevice->mImage.size();
+					if (modeIdx == 0)
+						frameImages.Insert(frameImages.size(), renderDevice->mImage.mVals, imageSize);
+					else if (memcmp(&frameImages[frameIdx * imageSize], renderDevice->mImage.mVals, imageSize * sizeof(uint32)) != 0)
+						mismatchedFrames++;
+					memset(renderDevice->mImage.mVals, 0, imageSize * sizeof(uint32));
+				}
+				else
+				{
+					batchesDrawn[modeIdx] += renderDevice->mPrevDrawCounters[DrawCounter_BatchesDrawn];
+					textureCmds[modeIdx] += renderDevice->mPrevDrawCounters[DrawCounter_SetTextureCmds];
+				}
+				frameIdx++;
+			}
+			if (!verify)
+				elapsedMicros[modeIdx] += (int64)(BFGetTickCountMicro() - startTick);
+		}
+	}
+
+	delete drawLayer;
+	delete renderDevice;
+
+	int64 frameCount = (int64)BF_MAX(numFrames, 1) * BF_MAX(passCount, 1);
+	OutputDebugStrF("Draw stream %d frames  Unmerged: %lld us/frame %lld batches/frame %lld textures/frame  Merged: %lld us/frame %lld batches/frame %lld textures/frame  Mismatched frames: %d\n",
+		numFrames, (long long)(elapsedMicros[0] / frameCount), (long long)(batchesDrawn[0] / frameCount), (long long)(textureCmds[0] / frameCount),
+		(long long)(elapsedMicros[1] / frameCount), (long long)(batchesDrawn[1] / frameCount), (long long)(textureCmds[1] / frameCount),
+		mismatchedFrames);
+	return (int)(batchesDrawn[1] / frameCount);
+}
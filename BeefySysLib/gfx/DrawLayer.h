@@ -2,6 +2,7 @@
 
 #include "Common.h"
 #include "util/SLIList.h"
+#include "util/Dictionary.h"
 #include "fbx/FBXReader.h"
 #include "gfx/RenderCmd.h"
 #include "gfx/RenderDevice.h"
@@ -25,9 +26,6 @@ public:
 	DrawLayer*				mDrawLayer;	
 	int						mId;
 
-	bool					mIsVertexBufferHead;
-	bool					mIsIndexBufferHead;
-
 	void*					mVertices;
 	int						mVtxSize;
 	int						mVtxIdx;
@@ -37,7 +35,10 @@ public:
 	int						mIdxIdx;
 	int						mAllocatedIndices;
 		
+	// The layer's texture bindings when the batch was started, -1 for slots not yet bound this frame
 	Texture*				mCurTextures[MAX_TEXTURES];
+	// Batches DrawLayer::MergeBatches has folded into this one, in draw order
+	DrawBatch*				mMergeNext;
 
 public:
 	DrawBatch();
@@ -54,6 +55,17 @@ public:
 
 #define DRAWBUFFER_CMDBUFFER_SIZE 64*1024
 
+struct DrawMergeGroup
+{
+	DrawBatch*				mHead;
+	DrawBatch*				mTail;
+	int						mVtxCount;
+	int						mIdxCount;
+	float					mMinX;
+	float					mMinY;
+	float					mMaxX;
+	float					mMaxY;
+};
 
 
 class DrawLayer
@@ -72,7 +84,18 @@ public:
 	int						mVtxByteIdx;	
 	int						mRenderCmdByteIdx;
 
+	// Vertex, index and command blocks are kept by the layer from frame to frame and only rewound by Clear, so
+	//  steady-state frames write into the same memory without going through the device's pools
+	Array<void*>			mVtxBlocks;
+	Array<void*>			mIdxBlocks;
+	Array<void*>			mRenderCmdBlocks;
+	int						mNumUsedVtxBlocks;
+	int						mNumUsedIdxBlocks;
+	int						mNumUsedRenderCmdBlocks;
+
 	Texture*				mCurTextures[MAX_TEXTURES];
+	bool					mNeedsMerge;
+	Array<DrawMergeGroup>	mMergeGroups;
 	
 public:
 	template <typename T>
@@ -80,11 +103,8 @@ public:
 	{ 
 		if (mRenderCmdByteIdx + sizeof(T) + extraBytes >= DRAWBUFFER_CMDBUFFER_SIZE)
 		{
-			mRenderCmdBuffer = mRenderDevice->mPooledRenderCmdBuffers.AllocMemoryBlock();
-			T* cmd = new(mRenderCmdBuffer) T();
-			cmd->mIsPoolHead = true;
-			mRenderCmdByteIdx = sizeof(T) + extraBytes;
-			return cmd;
+			mRenderCmdBuffer = AllocBlock(mRenderCmdBlocks, mNumUsedRenderCmdBlocks, mRenderDevice->mPooledRenderCmdBuffers);
+			mRenderCmdByteIdx = 0;
 		}
 
 		T* cmd = new((uint8*)mRenderCmdBuffer + mRenderCmdByteIdx) T();
@@ -93,8 +113,16 @@ public:
 		return cmd;
 	}
 
+protected:
+	void*					AllocBlock(Array<void*>& blocks, int& numUsedBlocks, MemoryPool& pool);
+	void					AllocBuffers(int vtxBytes, int idxBytes, void** verticesOut, uint16** indicesOut);
+	void					AddMergeBatch(DrawBatch* drawBatch);
+	void					FlushMergeGroups(Texture** boundTextures);
+	void					BindTextures(Texture** textures, Texture** boundTextures);
+
 public:		
 	void					CloseDrawBatch();
+	void					MergeBatches();
 	virtual DrawBatch*		CreateDrawBatch() = 0;	
 	virtual DrawBatch*		AllocateBatch(int minVtxCount, int minIdxCount);
 	void					QueueRenderCmd(RenderCmd* renderCmd);
@@ -115,4 +143,43 @@ public:
 	virtual void			SetTexture(int texIdx, Texture* texture);
 };
 
+struct DrawStreamEntry
+{
+	char					mKind;
+	int						mArgs[3];
+	float					mBounds[4];
+};
+
+// Plays back a stream written by DrawLayer_RecordStream one frame at a time. Draws are rebuilt as quads covering their
+//  recorded bounds, with shaders, textures and vertex contents supplied by the subclass for the device being measured
+class DrawStreamPlayer
+{
+public:
+	Array<DrawStreamEntry>	mEntries;
+	int						mNumFrames;
+	float					mMinX;
+	float					mMinY;
+	float					mMaxX;
+	float					mMaxY;
+
+	Dictionary<int, RenderState*> mRenderStates;
+	Dictionary<int, Shader*> mShaders;
+	int						mEntryIdx;
+	int						mDrawIdx;
+
+public:
+	DrawStreamPlayer();
+	virtual ~DrawStreamPlayer();
+
+	virtual Shader*			CreateShader(int vertexSize) = 0;
+	virtual Texture*		GetTexture(int textureId) { return (Texture*)(intptr)(textureId * 16); }
+	// Positions are already written, the default leaves the draw index in z and zeroes everything else
+	virtual void			FillVertex(void* vertex, int vertexSize, int cornerIdx, int drawIdx);
+
+	bool					Load(const char* fileName);
+	void					Rewind();
+	// Queues the next frame's commands into the layer, returning false once no complete frame is left
+	bool					PlayFrame(DrawLayer* drawLayer);
+};
+
 NS_BF_END;
@@ -3,6 +3,7 @@
 #include "gfx/RenderDevice.h"
 #include "img/ImageData.h"
 #include "BFApp.h"
+#include "util/ThreadPool.h"
 
 #include "freetype/ftsizes.h"
 
@@ -12,6 +13,9 @@ USING_NS_BF;
 
 const int FT_PAGE_WIDTH = 1024;
 const int FT_PAGE_HEIGHT = 1024;
+const int FT_GLYPH_PADDING = 1;
+const int FT_DEFAULT_MAX_PAGES = 4;
+const int FT_MAX_GLYPH_EVICTIONS = 32;
 
 //const int FT_PAGE_WIDTH = 128;
 //const int FT_PAGE_HEIGHT = 128;
@@ -19,6 +23,35 @@ const int FT_PAGE_HEIGHT = 1024;
 static FT_Library gFTLibrary = NULL;
 static FTFontManager gFTFontManager;
 
+// Used when there's no app or render device (ie: FTFont_RunAtlasBenchmark from a tool) so the atlas can still be exercised and measured
+class FTStubTexture : public Texture
+{
+public:
+	virtual void PhysSetAsTarget() override
+	{
+	}
+};
+
+class FTPrerasterizeJob : public ThreadPool::Job
+{
+public:
+	FTFontManager::FaceSize* mFaceSize;
+	int mFirstCharCode;
+	int mLastCharCode;
+
+public:
+	virtual void Perform() override
+	{
+		for (int charCode = mFirstCharCode; charCode <= mLastCharCode; charCode++)
+		{
+			// Lock per glyph so the main thread is never held up for more than one rasterization
+			AutoCrit autoCrit(gFTFontManager.mCritSect);
+			gFTFontManager.GetGlyph(mFaceSize, charCode, false, false);
+		}
+		gFTFontManager.ReleaseFaceSize(mFaceSize, true);
+	}
+};
+
 FTFont::FTFont()
 {
 	mFace = NULL;
@@ -38,24 +71,7 @@ void FTFont::Dispose(bool cacheRetain)
 {
 	if (mFaceSize != NULL)
 	{
-		BF_ASSERT((mFaceSize->mRefCount > 0) && (mFaceSize->mRefCount < 1000000));
-		mFaceSize->mRefCount--;
-
-		if (mFaceSize->mRefCount == 0)
-		{
-			mFace->mFaceSizes.Remove(mFaceSize->mPointSize);
-			delete mFaceSize;
-
-			if (!cacheRetain)
-			{
-				if (mFace->mFaceSizes.IsEmpty())
-				{
-					bool removed = gFTFontManager.mFaces.Remove(mFace->mFileName);
-					BF_ASSERT(removed);
-					delete mFace;
-				}
-			}
-		}
+		gFTFontManager.ReleaseFaceSize(mFaceSize, cacheRetain);
 		mFaceSize = NULL;		
 	}
 }
@@ -72,6 +88,200 @@ FTFontManager::Face::~Face()
 		FT_Done_Face(mFTFace);
 }
 
+FTFontManager::Page::Page(int width, int height)
+{
+	mTexture = NULL;
+	mNumGlyphs = 0;
+	mImage.CreateNew(width, height);
+	Reset();
+}
+
+FTFontManager::Page::~Page()
+{
+	if (mTexture != NULL)
+		mTexture->Release();
+	//delete mTexture;
+}
+
+void FTFontManager::Page::Reset()
+{
+	mSkyline.Clear();
+	SkylineNode node = { 0, 0, mImage.mWidth };
+	mSkyline.Add(node);
+	mFreeRects.Clear();
+	memset(mImage.mBits, 0, mImage.mWidth * mImage.mHeight * sizeof(uint32));
+}
+
+bool FTFontManager::Page::FitSkyline(int idx, int width, int height, int& outY)
+{
+	if (mSkyline[idx].mX + width > mImage.mWidth)
+		return false;
+
+	int y = 0;
+	int widthLeft = width;
+	for (int checkIdx = idx; widthLeft > 0; checkIdx++)
+	{
+		if (checkIdx >= mSkyline.mSize)
+			return false;
+		y = BF_MAX(y, mSkyline[checkIdx].mY);
+		if (y + height > mImage.mHeight)
+			return false;
+		widthLeft -= mSkyline[checkIdx].mWidth;
+	}
+	outY = y;
+	return true;
+}
+
+bool FTFontManager::Page::Alloc(int width, int height, int& outX, int& outY)
+{
+	// Slots left by evicted glyphs are reused first, tightest fit wins
+	int bestFreeIdx = -1;
+	int bestFreeArea = 0x7FFFFFFF;
+	for (int freeIdx = 0; freeIdx < mFreeRects.mSize; freeIdx++)
+	{
+		auto& freeRect = mFreeRects[freeIdx];
+		int area = freeRect.mWidth * freeRect.mHeight;
+		if ((freeRect.mWidth >= width) && (freeRect.mHeight >= height) && (area < bestFreeArea))
+		{
+			bestFreeIdx = freeIdx;
+			bestFreeArea = area;
+		}
+	}
+
+	if (bestFreeIdx != -1)
+	{
+		AtlasRect freeRect = mFreeRects[bestFreeIdx];
+		mFreeRects.RemoveAtFast(bestFreeIdx);
+		outX = freeRect.mX;
+		outY = freeRect.mY;
+
+		// Guillotine split of the remainder, cutting along the shorter leftover axis
+		int rightWidth = freeRect.mWidth - width;
+		int bottomHeight = freeRect.mHeight - height;
+		bool splitHorz = rightWidth < bottomHeight;
+		AtlasRect rightRect = { freeRect.mX + width, freeRect.mY, rightWidth, splitHorz ? height : freeRect.mHeight };
+		AtlasRect bottomRect = { freeRect.mX, freeRect.mY + height, splitHorz ? freeRect.mWidth : width, bottomHeight };
+		if ((rightRect.mWidth > 0) && (rightRect.mHeight > 0))
+			mFreeRects.Add(rightRect);
+		if ((bottomRect.mWidth > 0) && (bottomRect.mHeight > 0))
+			mFreeRects.Add(bottomRect);
+		return true;
+	}
+
+	// Bottom-left skyline placement
+	int bestIdx = -1;
+	int bestBottom = 0x7FFFFFFF;
+	int bestWidth = 0x7FFFFFFF;
+	for (int nodeIdx = 0; nodeIdx < mSkyline.mSize; nodeIdx++)
+	{
+		int y;
+		if (!FitSkyline(nodeIdx, width, height, y))
+			continue;
+		auto& node = mSkyline[nodeIdx];
+		if ((y + height < bestBottom) || ((y + height == bestBottom) && (node.mWidth < bestWidth)))
+		{
+			bestIdx = nodeIdx;
+			bestBottom = y + height;
+			bestWidth = node.mWidth;
+			outX = node.mX;
+			outY = y;
+		}
+	}
+
+	if (bestIdx == -1)
+		return false;
+
+	SkylineNode newNode = { outX, outY + height, width };
+	mSkyline.Insert(bestIdx, newNode);
+
+	// Trim the nodes now covered by the new one
+	for (int nodeIdx = bestIdx + 1; nodeIdx < mSkyline.mSize; nodeIdx++)
+	{
+		int prevEnd = mSkyline[nodeIdx - 1].mX + mSkyline[nodeIdx - 1].mWidth;
+		auto& node = mSkyline[nodeIdx];
+		if (node.mX >= prevEnd)
+			break;
+		int shrink = prevEnd - node.mX;
+		node.mX += shrink;
+		node.mWidth -= shrink;
+		if (node.mWidth > 0)
+			break;
+		mSkyline.RemoveAt(nodeIdx);
+		nodeIdx--;
+	}
+
+	for (int nodeIdx = 0; nodeIdx < mSkyline.mSize - 1; nodeIdx++)
+	{
+		if (mSkyline[nodeIdx].mY == mSkyline[nodeIdx + 1].mY)
+		{
+			mSkyline[nodeIdx].mWidth += mSkyline[nodeIdx + 1].mWidth;
+			mSkyline.RemoveAt(nodeIdx + 1);
+			nodeIdx--;
+		}
+	}
+
+	return true;
+}
+
+void FTFontManager::Page::Free(int x, int y, int width, int height)
+{
+	AtlasRect freeRect = { x, y, width, height };
+	mFreeRects.Add(freeRect);
+	for (int row = y; row < y + height; row++)
+		memset(mImage.mBits + row * mImage.mWidth + x, 0, width * sizeof(uint32));
+}
+
+void FTFontManager::Page::MarkDirty(int x, int y, int width, int height)
+{
+	int right = BF_MIN(x + width, mImage.mWidth);
+	int bottom = BF_MIN(y + height, mImage.mHeight);
+	x = BF_MAX(x, 0);
+	y = BF_MAX(y, 0);
+	AtlasRect rect = { x, y, right - x, bottom - y };
+
+	auto _Union = [](AtlasRect& dest, const AtlasRect& rect)
+	{
+		int right = BF_MAX(dest.mX + dest.mWidth, rect.mX + rect.mWidth);
+		int bottom = BF_MAX(dest.mY + dest.mHeight, rect.mY + rect.mHeight);
+		dest.mX = BF_MIN(dest.mX, rect.mX);
+		dest.mY = BF_MIN(dest.mY, rect.mY);
+		dest.mWidth = right - dest.mX;
+		dest.mHeight = bottom - dest.mY;
+	};
+
+	// Touching rects are merged, which is the common case since the skyline packs glyphs side by side
+	for (auto& dirtyRect : mDirtyRects)
+	{
+		if ((rect.mX <= dirtyRect.mX + dirtyRect.mWidth) && (dirtyRect.mX <= rect.mX + rect.mWidth) &&
+			(rect.mY <= dirtyRect.mY + dirtyRect.mHeight) && (dirtyRect.mY <= rect.mY + rect.mHeight))
+		{
+			_Union(dirtyRect, rect);
+			return;
+		}
+	}
+
+	if (mDirtyRects.mSize < MAX_DIRTY_RECTS)
+	{
+		mDirtyRects.Add(rect);
+		return;
+	}
+
+	int bestIdx = 0;
+	int64 bestGrowth = 0x7FFFFFFFFFFFFFFFLL;
+	for (int dirtyIdx = 0; dirtyIdx < mDirtyRects.mSize; dirtyIdx++)
+	{
+		AtlasRect merged = mDirtyRects[dirtyIdx];
+		_Union(merged, rect);
+		int64 growth = (int64)merged.mWidth * merged.mHeight - (int64)mDirtyRects[dirtyIdx].mWidth * mDirtyRects[dirtyIdx].mHeight;
+		if (growth < bestGrowth)
+		{
+			bestIdx = dirtyIdx;
+			bestGrowth = growth;
+		}
+	}
+	_Union(mDirtyRects[bestIdx], rect);
+}
+
 FTFontManager::FTFontManager()
 {
 	for (int i = 0; i < 256; i++)
@@ -82,20 +292,47 @@ FTFontManager::FTFontManager()
 		mWhiteTab[i] = whiteVal;
 		mBlackTab[i] = blackVal;
 	}
+
+	mMaxPages = FT_DEFAULT_MAX_PAGES;
+	mCurFrame = 0;
+	mNextAtlasId = 1;
+	mThreadPool = NULL;
+	memset(&mStats, 0, sizeof(mStats));
 }
 
 FTFontManager::~FTFontManager()
 {	
+	delete mThreadPool;
 	for (auto page : mPages)
 		delete page;
 	mPages.Clear();
 	for (auto faceKV : mFaces)
+	{
+		for (auto faceSizeKV : faceKV.mValue->mFaceSizes)
+		{
+			for (auto glyphKV : faceSizeKV.mValue->mGlyphs)
+				delete glyphKV.mValue;
+		}
 		delete faceKV.mValue;
+	}
 	mFaces.Clear();
 }
 
 void FTFontManager::DoClearCache()
 {
+	AutoCrit autoCrit(mCritSect);
+
+	for (auto faceKV : mFaces)
+	{
+		for (auto faceSizeKV : faceKV.mValue->mFaceSizes)
+		{
+			for (auto glyphKV : faceSizeKV.mValue->mGlyphs)
+				delete glyphKV.mValue;
+			faceSizeKV.mValue->mGlyphs.Clear();
+		}
+	}
+	mGlyphLRU.ClearFast();
+
 	for (auto page : mPages)
 		delete page;
 	mPages.Clear();
@@ -118,10 +355,288 @@ void FTFontManager::ClearCache()
 	gFTFontManager.DoClearCache();
 }
 
-FTFontManager::Page::~Page()
+void FTFontManager::ReleaseFaceSize(FaceSize* faceSize, bool cacheRetain)
 {
-	mTexture->Release();
-	//delete mTexture;
+	AutoCrit autoCrit(mCritSect);
+
+	BF_ASSERT((faceSize->mRefCount > 0) && (faceSize->mRefCount < 1000000));
+	faceSize->mRefCount--;
+	if (faceSize->mRefCount > 0)
+		return;
+
+	auto face = faceSize->mFace;
+	for (auto glyphKV : faceSize->mGlyphs)
+		RemoveGlyph(glyphKV.mValue);
+	faceSize->mGlyphs.Clear();
+
+	face->mFaceSizes.Remove(faceSize->mPointSize);
+	delete faceSize;
+
+	if (!cacheRetain)
+	{
+		if (face->mFaceSizes.IsEmpty())
+		{
+			bool removed = mFaces.Remove(face->mFileName);
+			BF_ASSERT(removed);
+			delete face;
+		}
+	}
+}
+
+void FTFontManager::RemoveGlyph(AtlasGlyph* atlasGlyph)
+{
+	mGlyphLRU.Remove(atlasGlyph);
+
+	auto page = atlasGlyph->mGlyph.mPage;
+	page->Free(atlasGlyph->mGlyph.mX, atlasGlyph->mGlyph.mY, atlasGlyph->mGlyph.mWidth + FT_GLYPH_PADDING, atlasGlyph->mGlyph.mHeight + FT_GLYPH_PADDING);
+	page->mNumGlyphs--;
+	if (page->mNumGlyphs == 0)
+		page->Reset();
+
+	delete atlasGlyph;
+}
+
+void FTFontManager::EvictGlyph(AtlasGlyph* atlasGlyph)
+{
+	atlasGlyph->mFaceSize->mGlyphs.Remove(atlasGlyph->mCharCode);
+	RemoveGlyph(atlasGlyph);
+	mStats.mNumEvicted++;
+}
+
+bool FTFontManager::AllocRect(int width, int height, Page*& outPage, int& outX, int& outY)
+{
+	for (auto page : mPages)
+	{
+		if (page->Alloc(width, height, outX, outY))
+		{
+			outPage = page;
+			return true;
+		}
+	}
+
+	auto _AddPage = [&]()
+	{
+		auto page = new Page(FT_PAGE_WIDTH, FT_PAGE_HEIGHT);
+		mPages.Add(page);
+		outPage = page;
+		return page->Alloc(width, height, outX, outY);
+	};
+
+	if (mPages.mSize < mMaxPages)
+		return _AddPage();
+
+	// Evict least recently used glyphs until one of their slots fits. Glyphs used in the current frame may still
+	//  be queued for drawing, so those are never evicted - we add a page instead.
+	for (int evictIdx = 0; evictIdx < FT_MAX_GLYPH_EVICTIONS; evictIdx++)
+	{
+		auto lruGlyph = mGlyphLRU.mHead;
+		if ((lruGlyph == NULL) || (lruGlyph->mLastUseFrame == mCurFrame))
+			break;
+		auto page = lruGlyph->mGlyph.mPage;
+		EvictGlyph(lruGlyph);
+		if (page->Alloc(width, height, outX, outY))
+		{
+			outPage = page;
+			return true;
+		}
+	}
+
+	// Too fragmented, so clear out the page holding the least recently used glyph
+	auto lruGlyph = mGlyphLRU.mHead;
+	if ((lruGlyph != NULL) && (lruGlyph->mLastUseFrame != mCurFrame))
+	{
+		auto page = lruGlyph->mGlyph.mPage;
+		bool pageInUse = false;
+		for (auto checkGlyph = mGlyphLRU.mHead; checkGlyph != NULL; checkGlyph = checkGlyph->mNext)
+		{
+			if ((checkGlyph->mGlyph.mPage == page) && (checkGlyph->mLastUseFrame == mCurFrame))
+				pageInUse = true;
+		}
+
+		if (!pageInUse)
+		{
+			for (auto checkGlyph = mGlyphLRU.mHead; checkGlyph != NULL; )
+			{
+				auto nextGlyph = checkGlyph->mNext;
+				if (checkGlyph->mGlyph.mPage == page)
+					EvictGlyph(checkGlyph);
+				checkGlyph = nextGlyph;
+			}
+			mStats.mNumPageResets++;
+			if (page->Alloc(width, height, outX, outY))
+			{
+				outPage = page;
+				return true;
+			}
+		}
+	}
+
+	return _AddPage();
+}
+
+FTFontManager::AtlasGlyph* FTFontManager::GetGlyph(FaceSize* faceSize, int charCode, bool allowDefault, bool isUse)
+{
+	AtlasGlyph** atlasGlyphPtr = NULL;
+	if (faceSize->mGlyphs.TryGetValue(charCode, &atlasGlyphPtr))
+	{
+		auto atlasGlyph = *atlasGlyphPtr;
+		if ((atlasGlyph->mGlyphIndex == 0) && (!allowDefault))
+			return NULL;
+		if (isUse)
+		{
+			mStats.mNumCacheHits++;
+			mGlyphLRU.Remove(atlasGlyph);
+			mGlyphLRU.PushBack(atlasGlyph);
+			atlasGlyph->mLastUseFrame = mCurFrame;
+		}
+		return atlasGlyph;
+	}
+
+	auto ftFace = faceSize->mFace->mFTFace;
+	FT_Activate_Size(faceSize->mFTSize);
+
+	int glyph_index = FT_Get_Char_Index(ftFace, charCode);
+	if ((glyph_index == 0) && (!allowDefault))
+		return NULL;
+
+	auto error = FT_Load_Glyph(ftFace, glyph_index, FT_LOAD_NO_BITMAP);
+	if (error != FT_Err_Ok)
+		return NULL;
+	
+	error = FT_Render_Glyph(ftFace->glyph, FT_RENDER_MODE_NORMAL);
+	if (error != FT_Err_Ok)
+		return NULL;
+		
+	auto& bitmap = ftFace->glyph->bitmap;
+	
+	if (((int)bitmap.rows + FT_GLYPH_PADDING > FT_PAGE_HEIGHT) || ((int)bitmap.width + FT_GLYPH_PADDING > FT_PAGE_WIDTH))
+	{
+		return NULL;
+	}
+
+	// The padding keeps bilinear sampling from picking up neighboring glyphs
+	Page* page = NULL;
+	int x = 0;
+	int y = 0;
+	if (!AllocRect((int)bitmap.width + FT_GLYPH_PADDING, (int)bitmap.rows + FT_GLYPH_PADDING, page, x, y))
+		return NULL;
+
+	auto atlasGlyph = new AtlasGlyph();
+	atlasGlyph->mFaceSize = faceSize;
+	atlasGlyph->mCharCode = charCode;
+	atlasGlyph->mGlyphIndex = glyph_index;
+	atlasGlyph->mLastUseFrame = isUse ? mCurFrame : -1;
+	atlasGlyph->mGlyph.mAtlasId = mNextAtlasId++;
+
+	auto glyph = &atlasGlyph->mGlyph;
+	glyph->mXAdvance = ftFace->glyph->advance.x / 64;
+	glyph->mXOffset = ftFace->glyph->bitmap_left;
+	glyph->mYOffset = ftFace->size->metrics.ascender / 64 - ftFace->glyph->bitmap_top;
+	glyph->mPage = page;
+	glyph->mX = x;
+	glyph->mY = y;
+	glyph->mWidth = bitmap.width;
+	glyph->mHeight = bitmap.rows;
+
+	if (bitmap.width > 0)
+	{
+		auto& img = page->mImage;
+		for (int row = 0; row < (int)bitmap.rows; row++)
+		{
+			uint8* srcPtr = bitmap.buffer + row * bitmap.pitch;
+			uint32* destPtr = img.mBits + (y + row) * img.mWidth + x;
+			for (int col = 0; col < (int)bitmap.width; col++)
+			{
+				uint8 val = srcPtr[col];
+
+				uint8 whiteVal = mWhiteTab[val];
+				uint8 blackVal = mBlackTab[val];
+
+				destPtr[col] = ((int32)whiteVal << 24) |
+					((int32)blackVal) | ((int32)0xFF << 8) | ((int32)0xFF << 16);
+			}
+		}
+
+		// Include the surrounding gutter so stale texels from evicted glyphs are cleared too
+		page->MarkDirty(x - FT_GLYPH_PADDING, y - FT_GLYPH_PADDING, glyph->mWidth + FT_GLYPH_PADDING * 2, glyph->mHeight + FT_GLYPH_PADDING * 2);
+	}
+
+	faceSize->mGlyphs[charCode] = atlasGlyph;
+	mGlyphLRU.PushBack(atlasGlyph);
+	page->mNumGlyphs++;
+	mStats.mNumRasterized++;
+	return atlasGlyph;
+}
+
+// Called for cached glyph placements each frame they're used in. Returns false if the placement is gone, in which
+//  case the caller has to get the glyph again.
+bool FTFontManager::TouchGlyph(FaceSize* faceSize, int charCode, int atlasId)
+{
+	AtlasGlyph** atlasGlyphPtr = NULL;
+	if (!faceSize->mGlyphs.TryGetValue(charCode, &atlasGlyphPtr))
+		return false;
+	auto atlasGlyph = *atlasGlyphPtr;
+	if (atlasGlyph->mGlyph.mAtlasId != atlasId)
+		return false;
+
+	mStats.mNumCacheHits++;
+	mGlyphLRU.Remove(atlasGlyph);
+	mGlyphLRU.PushBack(atlasGlyph);
+	atlasGlyph->mLastUseFrame = mCurFrame;
+	return true;
+}
+
+void FTFontManager::CreatePageTexture(Page* page)
+{
+	if ((gBFApp != NULL) && (gBFApp->mRenderDevice != NULL))
+	{
+		page->mTexture = gBFApp->mRenderDevice->LoadTexture(&page->mImage, TextureFlag_NoPremult);
+	}
+	else
+	{
+		auto texture = new FTStubTexture();
+		texture->mWidth = page->mImage.mWidth;
+		texture->mHeight = page->mImage.mHeight;
+		texture->AddRef();
+		page->mTexture = texture;
+	}
+
+	// The texture was created from the staged bits, so nothing is pending anymore
+	page->mDirtyRects.Clear();
+	mStats.mNumUploads++;
+	mStats.mUploadedPixels += page->mImage.mWidth * page->mImage.mHeight;
+}
+
+void FTFontManager::DoFlushUploads()
+{
+	AutoCrit autoCrit(mCritSect);
+
+	for (auto page : mPages)
+	{
+		// Pages only filled by prerasterizing get their texture when a glyph is first requested from them
+		if (page->mTexture == NULL)
+			continue;
+
+		for (auto& dirtyRect : page->mDirtyRects)
+		{
+			page->mTexture->SetBits(dirtyRect.mX, dirtyRect.mY, dirtyRect.mWidth, dirtyRect.mHeight, page->mImage.mWidth,
+				page->mImage.mBits + dirtyRect.mY * page->mImage.mWidth + dirtyRect.mX);
+			mStats.mNumUploads++;
+			mStats.mUploadedPixels += dirtyRect.mWidth * dirtyRect.mHeight;
+		}
+		page->mDirtyRects.Clear();
+	}
+}
+
+void FTFontManager::FlushUploads()
+{
+	gFTFontManager.DoFlushUploads();
+}
+
+void FTFontManager::EndFrame()
+{
+	AutoCrit autoCrit(gFTFontManager.mCritSect);
+	gFTFontManager.mCurFrame++;
 }
 
 /*FTFontManager::Glyph::~Glyph()
@@ -131,6 +646,8 @@ FTFontManager::Page::~Page()
 
 bool FTFont::Load(const StringImpl& fileName, float pointSize)
 {
+	AutoCrit autoCrit(gFTFontManager.mCritSect);
+
 	if (gFTLibrary == NULL)
 		FT_Init_FreeType(&gFTLibrary);
 	
@@ -191,107 +708,19 @@ TextureSegment* BF_CALLTYPE Gfx_CreateTextureSegment(TextureSegment* textureSegm
 
 FTFontManager::Glyph* FTFont::AllocGlyph(int charCode, bool allowDefault)
 {	
-	FT_Activate_Size(mFaceSize->mFTSize);
+	AutoCrit autoCrit(gFTFontManager.mCritSect);
 
-	int glyph_index = FT_Get_Char_Index(mFace->mFTFace, charCode);
-	if ((glyph_index == 0) && (!allowDefault))
+	auto atlasGlyph = gFTFontManager.GetGlyph(mFaceSize, charCode, allowDefault, true);
+	if (atlasGlyph == NULL)
 		return NULL;
 
-	auto error = FT_Load_Glyph(mFace->mFTFace, glyph_index, FT_LOAD_NO_BITMAP);
-	if (error != FT_Err_Ok)
-		return NULL;
-	
-	error = FT_Render_Glyph(mFace->mFTFace->glyph, FT_RENDER_MODE_NORMAL);
-	if (error != FT_Err_Ok)
-		return NULL;
-		
-	auto& bitmap = mFace->mFTFace->glyph->bitmap;
-	
-	if ((bitmap.rows > FT_PAGE_HEIGHT) || (bitmap.width > FT_PAGE_WIDTH))
-	{
-		return NULL;
-	}
-	
-	FTFontManager::Page* page = NULL;
-						
-	if (!gFTFontManager.mPages.empty())
-	{
-		page = gFTFontManager.mPages.back();
-		if (page->mCurX + (int)bitmap.width > page->mTexture->mWidth)
-		{
-			// Move down to next row
-			page->mCurX = 0;
-			page->mCurY += page->mMaxRowHeight;
-			page->mMaxRowHeight = 0;						
-		}
-
-		if (page->mCurY + (int)bitmap.rows > page->mTexture->mHeight)
-		{
-			// Doesn't fit
-			page = NULL;
-		}					
-	}
-
-	if (page == NULL)
-	{
-		page = new FTFontManager::Page();
-		gFTFontManager.mPages.push_back(page);
-	}
-
-	//auto glyph = new FTFontManager::Glyph();
+	auto page = atlasGlyph->mGlyph.mPage;
+	if (page->mTexture == NULL)
+		gFTFontManager.CreatePageTexture(page);
 
 	static FTFontManager::Glyph staticGlyph;
 	auto glyph = &staticGlyph;
-
-	auto ftFace = mFace->mFTFace;
-
-	glyph->mXAdvance = ftFace->glyph->advance.x / 64;
-	glyph->mXOffset = ftFace->glyph->bitmap_left;
-	glyph->mYOffset = ftFace->size->metrics.ascender / 64 - ftFace->glyph->bitmap_top;
-	glyph->mPage = page;
-	glyph->mX = page->mCurX;
-	glyph->mY = page->mCurY;
-	glyph->mWidth = bitmap.width;
-	glyph->mHeight = bitmap.rows;		
-
-	if (page->mTexture == NULL)
-	{
-		ImageData img;
-		img.CreateNew(FT_PAGE_WIDTH, FT_PAGE_HEIGHT);
-		for (int i = 0; i < FT_PAGE_HEIGHT * FT_PAGE_WIDTH; i++)
-		{
-			if (i % 3 == 0)
-				img.mBits[i] = 0xFFFF0000;
-			else if (i % 3 == 1)
-				img.mBits[i] = 0xFF00FF00;
-			else
-				img.mBits[i] = 0xFF0000FF;
-		}
-		page->mTexture = gBFApp->mRenderDevice->LoadTexture(&img, TextureFlag_NoPremult);		
-	}
-
-	if (bitmap.width > 0)
-	{
-		ImageData img;
-		img.CreateNew(bitmap.width, bitmap.rows);
-		for (int y = 0; y < (int)bitmap.rows; y++)
-		{
-			for (int x = 0; x < (int)bitmap.width; x++)
-			{
-				uint8 val = bitmap.buffer[y * bitmap.pitch + x];
-
-				uint8 whiteVal = gFTFontManager.mWhiteTab[val];
-				uint8 blackVal = gFTFontManager.mBlackTab[val];
-
-				img.mBits[y * img.mWidth + x] = ((int32)whiteVal << 24) |
-					((int32)blackVal) | ((int32)0xFF << 8) | ((int32)0xFF << 16);
-			}
-		}
-		page->mTexture->Blt(&img, page->mCurX, page->mCurY);
-	}
-
-	page->mCurX += bitmap.width;
-	page->mMaxRowHeight = std::max(page->mMaxRowHeight, (int)bitmap.rows);
+	*glyph = atlasGlyph->mGlyph;
 
 	auto texture = page->mTexture;	
 	texture->AddRef();
@@ -309,8 +738,31 @@ FTFontManager::Glyph* FTFont::AllocGlyph(int charCode, bool allowDefault)
 	return glyph;
 }
 
+bool FTFont::TouchGlyph(int charCode, int atlasId)
+{
+	AutoCrit autoCrit(gFTFontManager.mCritSect);
+	return gFTFontManager.TouchGlyph(mFaceSize, charCode, atlasId);
+}
+
+void FTFont::PrerasterizeRange(int firstCharCode, int lastCharCode)
+{
+	AutoCrit autoCrit(gFTFontManager.mCritSect);
+
+	if (gFTFontManager.mThreadPool == NULL)
+		gFTFontManager.mThreadPool = new ThreadPool(1);
+
+	// The job holds its own ref so the face size outlives it even if this font is deleted first
+	mFaceSize->mRefCount++;
+	auto job = new FTPrerasterizeJob();
+	job->mFaceSize = mFaceSize;
+	job->mFirstCharCode = firstCharCode;
+	job->mLastCharCode = lastCharCode;
+	gFTFontManager.mThreadPool->AddJob(job);
+}
+
 int FTFont::GetKerning(int charA, int charB)
 {
+	AutoCrit autoCrit(gFTFontManager.mCritSect);
 	FT_Activate_Size(mFaceSize->mFTSize);
 	FT_Vector kerning;
 	int glyph_indexA = FT_Get_Char_Index(mFace->mFTFace, charA);
@@ -355,8 +807,67 @@ BF_EXPORT FTFontManager::Glyph* BF_CALLTYPE FTFont_AllocGlyph(FTFont* ftFont, in
 	return ftFont->AllocGlyph(charCode, allowDefault);
 }
 
+BF_EXPORT bool BF_CALLTYPE FTFont_TouchGlyph(FTFont* ftFont, int charCode, int atlasId)
+{
+	return ftFont->TouchGlyph(charCode, atlasId);
+}
+
 BF_EXPORT int BF_CALLTYPE FTFont_GetKerning(FTFont* ftFont, int charCodeA, int charCodeB)
 {
 	auto kerning = ftFont->GetKerning(charCodeA, charCodeB);	
 	return kerning;
 }
+
+BF_EXPORT void BF_CALLTYPE FTFont_PrerasterizeRange(FTFont* ftFont, int firstCharCode, int lastCharCode)
+{
+	ftFont->PrerasterizeRange(firstCharCode, lastCharCode);
+}
+
+BF_EXPORT void BF_CALLTYPE FTFont_FlushUploads()
+{
+	FTFontManager::FlushUploads();
+}
+
+BF_EXPORT void BF_CALLTYPE FTFont_SetMaxPages(int maxPages)
+{
+	AutoCrit autoCrit(gFTFontManager.mCritSect);
+	gFTFontManager.mMaxPages = BF_MAX(maxPages, 1);
+}
+
+// Glyph placements cached by the caller need an FTFont_TouchGlyph whenever this changes, so they're kept for the frame
+BF_EXPORT int* BF_CALLTYPE FTFont_GetAtlasFramePtr()
+{
+	return &gFTFontManager.mCurFrame;
+}
+
+// Rasterizes a char range 'passCount' times through the atlas and returns the elapsed milliseconds. When called with no
+//  app or render device, pages get stub textures, so this measures packing, eviction and upload batching alone.
+BF_EXPORT int BF_CALLTYPE FTFont_RunAtlasBenchmark(const char* fileName, float pointSize, int firstCharCode, int lastCharCode, int passCount)
+{
+	FTFont ftFont;
+	if (!ftFont.Load(fileName, pointSize))
+		return -1;
+
+	memset(&gFTFontManager.mStats, 0, sizeof(gFTFontManager.mStats));
+	uint32 startTick = BFTickCount();
+	for (int passIdx = 0; passIdx < passCount; passIdx++)
+	{
+		for (int charCode = firstCharCode; charCode <= lastCharCode; charCode++)
+		{
+			auto glyph = ftFont.AllocGlyph(charCode, false);
+			if (glyph == NULL)
+				continue;
+			glyph->mTextureSegment->mTexture->Release();
+			delete glyph->mTextureSegment;
+		}
+		FTFontManager::FlushUploads();
+		FTFontManager::EndFrame();
+	}
+	int elapsedMS = (int)(BFTickCount() - startTick);
+
+	auto& stats = gFTFontManager.mStats;
+	OutputDebugStrF("FTFont atlas: %dms  Pages: %d  CacheHits: %d  Rasterized: %d  Evicted: %d  PageResets: %d  Uploads: %d  UploadedPixels: %lld\n",
+		elapsedMS, (int)gFTFontManager.mPages.size(), stats.mNumCacheHits, stats.mNumRasterized, stats.mNumEvicted, stats.mNumPageResets,
+		stats.mNumUploads, (long long)stats.mUploadedPixels);
+	return elapsedMS;
+}
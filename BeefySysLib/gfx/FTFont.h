@@ -4,6 +4,9 @@
 #include "../util/String.h"
 #include "../util/Dictionary.h"
 #include "../util/Array.h"
+#include "../util/DLIList.h"
+#include "../util/CritSect.h"
+#include "../img/ImageData.h"
 #include <unordered_map>
 #include <vector>
 
@@ -14,11 +17,13 @@ NS_BF_BEGIN
 
 class Texture;
 class TextureSegment;
+class ThreadPool;
 
 class FTFontManager
 {
 public:
 	class Face;
+	class AtlasGlyph;
 
 	class FaceSize
 	{
@@ -27,6 +32,7 @@ public:
 		FT_Size mFTSize;
 		int mRefCount;
 		float mPointSize;
+		Dictionary<int, AtlasGlyph*> mGlyphs; // Keyed by char code
 
 	public:
 		FaceSize()
@@ -54,24 +60,49 @@ public:
 		~Face();
 	};
 	
+	// Glyphs are packed with a skyline allocator. Slots freed by evicted glyphs are kept as free rects and
+	//  reused guillotine-style before the skyline grows. Rasterized glyphs are staged in mImage and uploaded
+	//  as a few merged dirty rects by FlushUploads rather than one Blt per glyph.
 	class Page
 	{
 	public:
-		Texture* mTexture;
-		int mCurX;
-		int mCurY;
-		int mMaxRowHeight;
+		enum
+		{
+			MAX_DIRTY_RECTS = 8
+		};
 
-	public:
-		Page()
+		struct SkylineNode
 		{
-			mTexture = NULL;
-			mCurX = 0;
-			mCurY = 0;
-			mMaxRowHeight = 0;
-		}
+			int mX;
+			int mY;
+			int mWidth;
+		};
 
+		struct AtlasRect
+		{
+			int mX;
+			int mY;
+			int mWidth;
+			int mHeight;
+		};
+
+	public:
+		Texture* mTexture;
+		ImageData mImage;
+		Array<SkylineNode> mSkyline;
+		Array<AtlasRect> mFreeRects;
+		Array<AtlasRect> mDirtyRects;
+		int mNumGlyphs;
+
+	public:
+		Page(int width, int height);
 		~Page();
+
+		bool FitSkyline(int idx, int width, int height, int& outY);
+		bool Alloc(int width, int height, int& outX, int& outY);
+		void Free(int x, int y, int width, int height);
+		void MarkDirty(int x, int y, int width, int height);
+		void Reset();
 	};
 
 	class Glyph
@@ -86,30 +117,84 @@ public:
 		int mXOffset;
 		int mYOffset;
 		int mXAdvance;
+		int mAtlasId; // Identifies this placement, see FTFont_TouchGlyph
 
 	public:
 		Glyph()
 		{
 			mPage = NULL;
 			mTextureSegment = NULL;
+			mAtlasId = 0;
 		}
 
 		//~Glyph();
 	};
 
+	class AtlasGlyph
+	{
+	public:
+		Glyph mGlyph;
+		FaceSize* mFaceSize;
+		int mCharCode;
+		int mGlyphIndex;
+		int mLastUseFrame;
+		AtlasGlyph* mPrev;
+		AtlasGlyph* mNext;
+
+	public:
+		AtlasGlyph()
+		{
+			mFaceSize = NULL;
+			mCharCode = 0;
+			mGlyphIndex = 0;
+			mLastUseFrame = 0;
+			mPrev = NULL;
+			mNext = NULL;
+		}
+	};
+
+	struct Stats
+	{
+		int mNumCacheHits;
+		int mNumRasterized;
+		int mNumEvicted;
+		int mNumPageResets;
+		int mNumUploads;
+		int64 mUploadedPixels;
+	};
+
 public:
 	Dictionary<String, Face*> mFaces;
 	Array<Page*> mPages;
+	int mMaxPages; // Soft limit, we only go over it rather than evict glyphs used in the current frame
+	DLIList<AtlasGlyph*> mGlyphLRU; // Least recently used first
+	int mCurFrame; // Advanced by RenderDevice::FrameEnd, glyphs used in the current frame are never evicted
+	int mNextAtlasId;
+	CritSect mCritSect; // Guards FreeType and the atlas, glyphs can be rasterized from the prerasterize thread
+	ThreadPool* mThreadPool;
+	Stats mStats;
 
 	uint8 mWhiteTab[256];
 	uint8 mBlackTab[256];
 	
 	void DoClearCache();
+	void RemoveGlyph(AtlasGlyph* atlasGlyph);
+	void EvictGlyph(AtlasGlyph* atlasGlyph);
+	bool AllocRect(int width, int height, Page*& outPage, int& outX, int& outY);
+	AtlasGlyph* GetGlyph(FaceSize* faceSize, int charCode, bool allowDefault, bool isUse);
+	bool TouchGlyph(FaceSize* faceSize, int charCode, int atlasId);
+	void CreatePageTexture(Page* page);
+	void DoFlushUploads();
+
 public:
 	FTFontManager();
 	~FTFontManager();
-		
+	
+	void ReleaseFaceSize(FaceSize* faceSize, bool cacheRetain);
+
 	static void ClearCache();
+	static void FlushUploads();
+	static void EndFrame();
 };
 
 class FTFont
@@ -132,6 +217,8 @@ public:
 	bool Load(const StringImpl& file, float pointSize);	
 
 	FTFontManager::Glyph* AllocGlyph(int charCode, bool allowDefault);
+	bool TouchGlyph(int charCode, int atlasId);
+	void PrerasterizeRange(int firstCharCode, int lastCharCode);
 	int GetKerning(int charA, int charB);
 
 	void Release(bool cacheRetain = false);
@@ -2,36 +2,525 @@
 #include "BFApp.h"
 #include "gfx/RenderDevice.h"
 #include "gfx/ModelInstance.h"
+#include "FileStream.h"
+#include "MemStream.h"
+#include "util/MappedFile.h"
+#include "util/FileEnumerator.h"
 
 USING_NS_BF;
 
-void Beefy::ModelAnimation::GetJointTranslation(int jointIdx, float frameNum, ModelJointTranslation* outJointTranslation)
+#define BF_MODEL_CACHE_ID 0xBEEF0DEF
+#define BF_MODEL_CACHE_VERSION 2
+
+// Everything in a model cache file is addressed by offsets from the start of the file, and vertex data and track
+//  tables are 16-byte aligned so a mapped file can be used in place
+struct ModelCacheHeader
+{
+	uint32 mId;
+	int32 mVersion;
+	int32 mFileSize;
+	float mFrameRate;
+	int64 mCheckFileTimes[2];
+	int32 mCheckFileNameOfs[2];
+	int32 mNumMeshes;
+	int32 mMeshesOfs;
+	int32 mNumJoints;
+	int32 mJointsOfs;
+	int32 mNumAnims;
+	int32 mAnimsOfs;
+};
+
+struct ModelCacheMesh
+{
+	int32 mNameOfs;
+	int32 mTexFileNameOfs;
+	int32 mBumpFileNameOfs;
+	int32 mNumVertices;
+	int32 mVerticesOfs;
+	int32 mNumIndices;
+	int32 mIndicesOfs;
+	int32 mPad;
+};
+
+struct ModelCacheJoint
+{
+	int32 mNameOfs;
+	int32 mParentIdx;
+	Matrix4 mPoseInvMatrix;
+};
+
+struct ModelCacheAnim
+{
+	int32 mNameOfs;
+	int32 mNumFrames;
+	int32 mTracksOfs;
+	int32 mPad;
+};
+
+static int16 QuantizeUnit(float val)
+{
+	return (int16)floorf(BF_MAX(-1.0f, BF_MIN(1.0f, val)) * 32767.0f + 0.5f);
+}
+
+static uint16 QuantizeRange(float val, float minVal, float step)
+{
+	if (step <= 0)
+		return 0;
+	return (uint16)BF_MAX(0, BF_MIN(65535, (int)((val - minVal) / step + 0.5f)));
+}
+
+void ModelAnimationTrack::GetKey(const uint8* data, int frameIdx, ModelJointTranslation* outJointTranslation) const
+{
+	const int16* rot = (const int16*)(data + mRotOfs) + (((mFlags & ModelAnimationTrackFlag_ConstRot) != 0) ? 0 : frameIdx * 4);
+	const uint16* trans = (const uint16*)(data + mTransOfs) + (((mFlags & ModelAnimationTrackFlag_ConstTrans) != 0) ? 0 : frameIdx * 3);
+	const uint16* scale = (const uint16*)(data + mScaleOfs) + (((mFlags & ModelAnimationTrackFlag_ConstScale) != 0) ? 0 : frameIdx * 3);
+
+	Quaternion quat(rot[0] / 32767.0f, rot[1] / 32767.0f, rot[2] / 32767.0f, rot[3] / 32767.0f);
+	outJointTranslation->mQuat = Quaternion::Normalise(quat);
+	outJointTranslation->mTrans = Vector3(mTransMin.mX + trans[0] * mTransStep.mX, mTransMin.mY + trans[1] * mTransStep.mY, mTransMin.mZ + trans[2] * mTransStep.mZ);
+	outJointTranslation->mScale = Vector3(mScaleMin.mX + scale[0] * mScaleStep.mX, mScaleMin.mY + scale[1] * mScaleStep.mY, mScaleMin.mZ + scale[2] * mScaleStep.mZ);
+}
+
+ModelAnimation::ModelAnimation()
+{
+	mTracks = NULL;
+	mTrackData = NULL;
+	mNumTracks = 0;
+	mFrameOffset = 0;
+	mNumFrames = 0;
+}
+
+int ModelAnimation::GetFrameCount()
 {
-	// Frame 35
-	BF_ASSERT((int)frameNum < (int)mFrames.size());
+	if (mTracks != NULL)
+		return mNumFrames;
+	return (int)mFrames.size();
+}
+
+void ModelAnimation::GetFrameKey(int jointIdx, int frameIdx, ModelJointTranslation* outJointTranslation)
+{
+	if (mTracks != NULL)
+		mTracks[jointIdx].GetKey(mTrackData, mFrameOffset + frameIdx, outJointTranslation);
+	else
+		*outJointTranslation = mFrames[frameIdx].mJointTranslations[jointIdx];
+}
+
+void ModelAnimation::GetJointTranslation(int jointIdx, float frameNum, ModelJointTranslation* outJointTranslation)
+{
+	int frameCount = GetFrameCount();
+	BF_ASSERT((int)frameNum < frameCount);
 	int frameNumStart = (int)frameNum;
-	int frameNumEnd = (frameNumStart + 1) % (int)mFrames.size();
+	int frameNumEnd = (frameNumStart + 1) % frameCount;
 
 	float endAlpha = frameNum - frameNumStart;
 	float startAlpha = 1.0f - endAlpha;
 
-	ModelJointTranslation* jointTransStart = &(mFrames[frameNumStart].mJointTranslations[jointIdx]);
-	ModelJointTranslation* jointTransEnd = &(mFrames[frameNumEnd].mJointTranslations[jointIdx]);
+	ModelJointTranslation jointTransStart;
+	ModelJointTranslation jointTransEnd;
+	GetFrameKey(jointIdx, frameNumStart, &jointTransStart);
+	GetFrameKey(jointIdx, frameNumEnd, &jointTransEnd);
+
+	outJointTranslation->mQuat = Quaternion::Slerp(endAlpha, jointTransStart.mQuat, jointTransEnd.mQuat, true);
+	outJointTranslation->mScale = (jointTransStart.mScale * startAlpha) + (jointTransEnd.mScale * endAlpha);
+	outJointTranslation->mTrans = (jointTransStart.mTrans * startAlpha) + (jointTransEnd.mTrans * endAlpha);
+}
 
-	//if (/*(jointIdx == 37) || (jointIdx == 36) || (jointIdx == 35) ||*/ (jointIdx == 34) /*|| (jointIdx == 12) || (jointIdx == 11) || (jointIdx == 10) || (jointIdx == 0)*/)
-	{		
-		outJointTranslation->mQuat = Quaternion::Slerp(endAlpha, jointTransStart->mQuat, jointTransEnd->mQuat, true);
-		outJointTranslation->mScale = (jointTransStart->mScale * startAlpha) + (jointTransEnd->mScale * endAlpha);
-		outJointTranslation->mTrans = (jointTransStart->mTrans * startAlpha) + (jointTransEnd->mTrans * endAlpha);
+void ModelAnimation::Clip(int startFrame, int numFrames)
+{
+	if (mTracks != NULL)
+	{
+		// The mapped keys are shared, so just narrow the window onto them
+		mFrameOffset += startFrame;
+		mNumFrames = numFrames;
+		return;
 	}
-	/*else
+
+	mFrames.erase(mFrames.begin(), mFrames.begin() + startFrame);
+	mFrames.erase(mFrames.begin() + numFrames, mFrames.end());
+}
+
+void ModelAnimation::Unpack()
+{
+	if (mTracks == NULL)
+		return;
+
+	mFrames.resize(mNumFrames);
+	for (int frameIdx = 0; frameIdx < mNumFrames; frameIdx++)
 	{
-		*outJointTranslation = *jointTransStart;
-	}*/
+		ModelAnimationFrame* frame = &mFrames[frameIdx];
+		frame->mJointTranslations.resize(mNumTracks);
+		for (int jointIdx = 0; jointIdx < mNumTracks; jointIdx++)
+			GetFrameKey(jointIdx, frameIdx, &frame->mJointTranslations[jointIdx]);
+	}
 
-	//*outJointTranslation = *jointTransStart;
+	mTracks = NULL;
+	mTrackData = NULL;
+	mNumTracks = 0;
+	mFrameOffset = 0;
+	mNumFrames = 0;
 }
 
+ModelMesh::ModelMesh()
+{
+	mMappedVertices = NULL;
+	mMappedIndices = NULL;
+	mNumMappedVertices = 0;
+	mNumMappedIndices = 0;
+}
+
+void ModelMesh::Unpack()
+{
+	if (mMappedVertices != NULL)
+		mVertices.assign(mMappedVertices, mMappedVertices + mNumMappedVertices);
+	if (mMappedIndices != NULL)
+		mIndices.assign(mMappedIndices, mMappedIndices + mNumMappedIndices);
+	mMappedVertices = NULL;
+	mMappedIndices = NULL;
+	mNumMappedVertices = 0;
+	mNumMappedIndices = 0;
+}
+
+ModelDef::ModelDef()
+{
+	mFrameRate = 0;
+	mMappedFile = NULL;
+}
+
+ModelDef::~ModelDef()
+{
+	delete mMappedFile;
+}
+
+bool ModelDef::WriteCache(const StringImpl& fileName, const StringImpl& checkFile, const StringImpl& checkFile2)
+{
+	DynMemStream ms;
+
+	ModelCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.mId = BF_MODEL_CACHE_ID;
+	header.mVersion = BF_MODEL_CACHE_VERSION;
+	header.mFrameRate = mFrameRate;
+	header.mCheckFileTimes[0] = GetFileTimeWrite(checkFile);
+	header.mCheckFileTimes[1] = GetFileTimeWrite(checkFile2);
+	header.mNumMeshes = (int)mMeshes.size();
+	header.mNumJoints = (int)mJoints.size();
+	header.mNumAnims = (int)mAnims.size();
+	ms.WriteT(header);
+
+	auto _WriteString = [&](const StringImpl& str)
+	{
+		int ofs = ms.GetPos();
+		ms.Write((void*)str.c_str(), (int)str.length() + 1);
+		return ofs;
+	};
+
+	header.mCheckFileNameOfs[0] = _WriteString(GetFileName(checkFile));
+	header.mCheckFileNameOfs[1] = _WriteString(GetFileName(checkFile2));
+
+	std::vector<ModelCacheMesh> cacheMeshes(mMeshes.size());
+	for (int meshIdx = 0; meshIdx < (int)mMeshes.size(); meshIdx++)
+	{
+		ModelMesh* modelMesh = &mMeshes[meshIdx];
+		ModelCacheMesh* cacheMesh = &cacheMeshes[meshIdx];
+		memset(cacheMesh, 0, sizeof(ModelCacheMesh));
+		cacheMesh->mNameOfs = _WriteString(modelMesh->mName);
+		cacheMesh->mTexFileNameOfs = _WriteString(modelMesh->mTexFileName);
+		cacheMesh->mBumpFileNameOfs = _WriteString(modelMesh->mBumpFileName);
+		cacheMesh->mNumVertices = modelMesh->GetVertexCount();
+		cacheMesh->mNumIndices = modelMesh->GetIndexCount();
+	}
+
+	std::vector<ModelCacheJoint> cacheJoints(mJoints.size());
+	for (int jointIdx = 0; jointIdx < (int)mJoints.size(); jointIdx++)
+	{
+		ModelJoint* modelJoint = &mJoints[jointIdx];
+		ModelCacheJoint* cacheJoint = &cacheJoints[jointIdx];
+		cacheJoint->mNameOfs = _WriteString(modelJoint->mName);
+		cacheJoint->mParentIdx = modelJoint->mParentIdx;
+		cacheJoint->mPoseInvMatrix = modelJoint->mPoseInvMatrix;
+	}
+
+	std::vector<ModelCacheAnim> cacheAnims(mAnims.size());
+	for (int animIdx = 0; animIdx < (int)mAnims.size(); animIdx++)
+	{
+		ModelAnimation* modelAnim = &mAnims[animIdx];
+		ModelCacheAnim* cacheAnim = &cacheAnims[animIdx];
+		memset(cacheAnim, 0, sizeof(ModelCacheAnim));
+		cacheAnim->mNameOfs = _WriteString(modelAnim->mName);
+		cacheAnim->mNumFrames = modelAnim->GetFrameCount();
+	}
+
+	// The tables are filled in at the end, once everything they point to has been placed
+	ms.Align(16);
+	header.mMeshesOfs = ms.GetPos();
+	ms.WriteZeros((int)(cacheMeshes.size() * sizeof(ModelCacheMesh)));
+	ms.Align(16);
+	header.mJointsOfs = ms.GetPos();
+	ms.WriteZeros((int)(cacheJoints.size() * sizeof(ModelCacheJoint)));
+	ms.Align(16);
+	header.mAnimsOfs = ms.GetPos();
+	ms.WriteZeros((int)(cacheAnims.size() * sizeof(ModelCacheAnim)));
+
+	for (int meshIdx = 0; meshIdx < (int)mMeshes.size(); meshIdx++)
+	{
+		ModelMesh* modelMesh = &mMeshes[meshIdx];
+		ModelCacheMesh* cacheMesh = &cacheMeshes[meshIdx];
+
+		ms.Align(16);
+		cacheMesh->mVerticesOfs = ms.GetPos();
+		if (cacheMesh->mNumVertices > 0)
+			ms.Write((void*)modelMesh->GetVertices(), cacheMesh->mNumVertices * (int)sizeof(ModelVertex));
+
+		ms.Align(16);
+		cacheMesh->mIndicesOfs = ms.GetPos();
+		if (cacheMesh->mNumIndices > 0)
+			ms.Write((void*)modelMesh->GetIndices(), cacheMesh->mNumIndices * (int)sizeof(uint16));
+	}
+
+	int numJoints = (int)mJoints.size();
+	std::vector<ModelJointTranslation> keys;
+	std::vector<ModelAnimationTrack> tracks(numJoints);
+	std::vector<int16> rotKeys;
+	std::vector<uint16> transKeys;
+	std::vector<uint16> scaleKeys;
+	for (int animIdx = 0; animIdx < (int)mAnims.size(); animIdx++)
+	{
+		ModelAnimation* modelAnim = &mAnims[animIdx];
+		ModelCacheAnim* cacheAnim = &cacheAnims[animIdx];
+		int numFrames = cacheAnim->mNumFrames;
+
+		ms.Align(16);
+		cacheAnim->mTracksOfs = ms.GetPos();
+		ms.WriteZeros(numJoints * (int)sizeof(ModelAnimationTrack));
+
+		keys.resize(numFrames);
+		rotKeys.resize(numFrames * 4);
+		transKeys.resize(numFrames * 3);
+		scaleKeys.resize(numFrames * 3);
+		for (int jointIdx = 0; jointIdx < numJoints; jointIdx++)
+		{
+			ModelAnimationTrack* track = &tracks[jointIdx];
+			*track = ModelAnimationTrack();
+			if (numFrames == 0)
+			{
+				track->mFlags = ModelAnimationTrackFlag_ConstRot | ModelAnimationTrackFlag_ConstTrans | ModelAnimationTrackFlag_ConstScale;
+				continue;
+			}
+
+			for (int frameIdx = 0; frameIdx < numFrames; frameIdx++)
+				modelAnim->GetFrameKey(jointIdx, frameIdx, &keys[frameIdx]);
+
+			Vector3 transMax = keys[0].mTrans;
+			Vector3 scaleMax = keys[0].mScale;
+			track->mTransMin = keys[0].mTrans;
+			track->mScaleMin = keys[0].mScale;
+			for (auto& key : keys)
+			{
+				track->mTransMin = Vector3(BF_MIN(track->mTransMin.mX, key.mTrans.mX), BF_MIN(track->mTransMin.mY, key.mTrans.mY), BF_MIN(track->mTransMin.mZ, key.mTrans.mZ));
+				transMax = Vector3(BF_MAX(transMax.mX, key.mTrans.mX), BF_MAX(transMax.mY, key.mTrans.mY), BF_MAX(transMax.mZ, key.mTrans.mZ));
+				track->mScaleMin = Vector3(BF_MIN(track->mScaleMin.mX, key.mScale.mX), BF_MIN(track->mScaleMin.mY, key.mScale.mY), BF_MIN(track->mScaleMin.mZ, key.mScale.mZ));
+				scaleMax = Vector3(BF_MAX(scaleMax.mX, key.mScale.mX), BF_MAX(scaleMax.mY, key.mScale.mY), BF_MAX(scaleMax.mZ, key.mScale.mZ));
+			}
+			track->mTransStep = Vector3((transMax.mX - track->mTransMin.mX) / 65535.0f, (transMax.mY - track->mTransMin.mY) / 65535.0f, (transMax.mZ - track->mTransMin.mZ) / 65535.0f);
+			track->mScaleStep = Vector3((scaleMax.mX - track->mScaleMin.mX) / 65535.0f, (scaleMax.mY - track->mScaleMin.mY) / 65535.0f, (scaleMax.mZ - track->mScaleMin.mZ) / 65535.0f);
+
+			for (int frameIdx = 0; frameIdx < numFrames; frameIdx++)
+			{
+				ModelJointTranslation* key = &keys[frameIdx];
+				Quaternion quat = Quaternion::Normalise(key->mQuat);
+				int16* rotKey = &rotKeys[frameIdx * 4];
+				rotKey[0] = QuantizeUnit(quat.mX);
+				rotKey[1] = QuantizeUnit(quat.mY);
+				rotKey[2] = QuantizeUnit(quat.mZ);
+				rotKey[3] = QuantizeUnit(quat.mW);
+				uint16* transKey = &transKeys[frameIdx * 3];
+				transKey[0] = QuantizeRange(key->mTrans.mX, track->mTransMin.mX, track->mTransStep.mX);
+				transKey[1] = QuantizeRange(key->mTrans.mY, track->mTransMin.mY, track->mTransStep.mY);
+				transKey[2] = QuantizeRange(key->mTrans.mZ, track->mTransMin.mZ, track->mTransStep.mZ);
+				uint16* scaleKey = &scaleKeys[frameIdx * 3];
+				scaleKey[0] = QuantizeRange(key->mScale.mX, track->mScaleMin.mX, track->mScaleStep.mX);
+				scaleKey[1] = QuantizeRange(key->mScale.mY, track->mScaleMin.mY, track->mScaleStep.mY);
+				scaleKey[2] = QuantizeRange(key->mScale.mZ, track->mScaleMin.mZ, track->mScaleStep.mZ);
+			}
+
+			// A channel whose keys all quantize to the same value only needs its first key
+			auto _WriteChannel = [&](void* data, int keySize, int flag)
+			{
+				bool isConst = true;
+				for (int frameIdx = 1; frameIdx < numFrames; frameIdx++)
+				{
+					if (memcmp((uint8*)data + frameIdx * keySize, data, keySize) != 0)
+					{
+						isConst = false;
+						break;
+					}
+				}
+				if (isConst)
+					track->mFlags |= flag;
+
+				ms.Align(4);
+				int ofs = ms.GetPos();
+				ms.Write(data, isConst ? keySize : numFrames * keySize);
+				return ofs;
+			};
+
+			track->mRotOfs = _WriteChannel(&rotKeys[0], 4 * sizeof(int16), ModelAnimationTrackFlag_ConstRot);
+			track->mTransOfs = _WriteChannel(&transKeys[0], 3 * sizeof(uint16), ModelAnimationTrackFlag_ConstTrans);
+			track->mScaleOfs = _WriteChannel(&scaleKeys[0], 3 * sizeof(uint16), ModelAnimationTrackFlag_ConstScale);
+		}
+
+		if (numJoints > 0)
+			memcpy(&ms.mData[cacheAnim->mTracksOfs], &tracks[0], numJoints * sizeof(ModelAnimationTrack));
+	}
+
+	ms.Align(16);
+	header.mFileSize = ms.GetPos();
+	memcpy(&ms.mData[0], &header, sizeof(header));
+	if (!cacheMeshes.empty())
+		memcpy(&ms.mData[header.mMeshesOfs], &cacheMeshes[0], cacheMeshes.size() * sizeof(ModelCacheMesh));
+	if (!cacheJoints.empty())
+		memcpy(&ms.mData[header.mJointsOfs], &cacheJoints[0], cacheJoints.size() * sizeof(ModelCacheJoint));
+	if (!cacheAnims.empty())
+		memcpy(&ms.mData[header.mAnimsOfs], &cacheAnims[0], cacheAnims.size() * sizeof(ModelCacheAnim));
+
+	FileStream fs;
+	if (!fs.Open(fileName, "wb"))
+		return false;
+	fs.Write(ms.GetPtr(), ms.GetSize());
+	fs.Close();
+	return true;
+}
+
+bool ModelDef::ReadCache(const StringImpl& fileName)
+{
+	MappedFile* mappedFile = new MappedFile();
+	if ((!mappedFile->Open(fileName)) || (mappedFile->mFileSize < (int)sizeof(ModelCacheHeader)))
+	{
+		delete mappedFile;
+		return false;
+	}
+
+	const uint8* data = (const uint8*)mappedFile->mData;
+	int fileSize = mappedFile->mFileSize;
+	const ModelCacheHeader* header = (const ModelCacheHeader*)data;
+
+	auto _InRange = [&](int ofs, int64 size)
+	{
+		return (ofs >= 0) && (size >= 0) && ((int64)ofs + size <= fileSize);
+	};
+
+	auto _IsString = [&](int ofs)
+	{
+		return (ofs >= 0) && (ofs < fileSize) && (memchr(data + ofs, 0, fileSize - ofs) != NULL);
+	};
+
+	bool isValid = (header->mId == BF_MODEL_CACHE_ID) && (header->mVersion == BF_MODEL_CACHE_VERSION) && (header->mFileSize == fileSize) &&
+		_InRange(header->mMeshesOfs, (int64)header->mNumMeshes * sizeof(ModelCacheMesh)) &&
+		_InRange(header->mJointsOfs, (int64)header->mNumJoints * sizeof(ModelCacheJoint)) &&
+		_InRange(header->mAnimsOfs, (int64)header->mNumAnims * sizeof(ModelCacheAnim));
+
+	String fileDir = GetFileDir(fileName);
+	for (int checkIdx = 0; (isValid) && (checkIdx < 2); checkIdx++)
+	{
+		int nameOfs = header->mCheckFileNameOfs[checkIdx];
+		if (!_IsString(nameOfs))
+			isValid = false;
+		else if ((data[nameOfs] != 0) && (GetFileTimeWrite(fileDir + (const char*)(data + nameOfs)) != header->mCheckFileTimes[checkIdx]))
+			isValid = false;
+	}
+
+	const ModelCacheMesh* cacheMeshes = (const ModelCacheMesh*)(data + header->mMeshesOfs);
+	for (int meshIdx = 0; (isValid) && (meshIdx < header->mNumMeshes); meshIdx++)
+	{
+		const ModelCacheMesh* cacheMesh = &cacheMeshes[meshIdx];
+		isValid = _IsString(cacheMesh->mNameOfs) && _IsString(cacheMesh->mTexFileNameOfs) && _IsString(cacheMesh->mBumpFileNameOfs) &&
+			((cacheMesh->mVerticesOfs % 16) == 0) && _InRange(cacheMesh->mVerticesOfs, (int64)cacheMesh->mNumVertices * sizeof(ModelVertex)) &&
+			((cacheMesh->mIndicesOfs % 16) == 0) && _InRange(cacheMesh->mIndicesOfs, (int64)cacheMesh->mNumIndices * sizeof(uint16));
+	}
+
+	const ModelCacheJoint* cacheJoints = (const ModelCacheJoint*)(data + header->mJointsOfs);
+	for (int jointIdx = 0; (isValid) && (jointIdx < header->mNumJoints); jointIdx++)
+		isValid = _IsString(cacheJoints[jointIdx].mNameOfs) && (cacheJoints[jointIdx].mParentIdx < jointIdx);
+
+	const ModelCacheAnim* cacheAnims = (const ModelCacheAnim*)(data + header->mAnimsOfs);
+	for (int animIdx = 0; (isValid) && (animIdx < header->mNumAnims); animIdx++)
+	{
+		const ModelCacheAnim* cacheAnim = &cacheAnims[animIdx];
+		isValid = _IsString(cacheAnim->mNameOfs) && (cacheAnim->mNumFrames >= 0) && ((cacheAnim->mTracksOfs % 16) == 0) &&
+			_InRange(cacheAnim->mTracksOfs, (int64)header->mNumJoints * sizeof(ModelAnimationTrack));
+
+		const ModelAnimationTrack* tracks = (const ModelAnimationTrack*)(data + cacheAnim->mTracksOfs);
+		for (int jointIdx = 0; (isValid) && (cacheAnim->mNumFrames > 0) && (jointIdx < header->mNumJoints); jointIdx++)
+		{
+			const ModelAnimationTrack* track = &tracks[jointIdx];
+			auto _KeyCount = [&](int flag) { return ((track->mFlags & flag) != 0) ? 1 : (int64)cacheAnim->mNumFrames; };
+			isValid = ((track->mRotOfs % 4) == 0) && _InRange(track->mRotOfs, _KeyCount(ModelAnimationTrackFlag_ConstRot) * 4 * sizeof(int16)) &&
+				((track->mTransOfs % 2) == 0) && _InRange(track->mTransOfs, _KeyCount(ModelAnimationTrackFlag_ConstTrans) * 3 * sizeof(uint16)) &&
+				((track->mScaleOfs % 2) == 0) && _InRange(track->mScaleOfs, _KeyCount(ModelAnimationTrackFlag_ConstScale) * 3 * sizeof(uint16));
+		}
+	}
+
+	if (!isValid)
+	{
+		delete mappedFile;
+		return false;
+	}
+
+	delete mMappedFile;
+	mMappedFile = mappedFile;
+	mFrameRate = header->mFrameRate;
+
+	mMeshes.clear();
+	mMeshes.resize(header->mNumMeshes);
+	for (int meshIdx = 0; meshIdx < header->mNumMeshes; meshIdx++)
+	{
+		const ModelCacheMesh* cacheMesh = &cacheMeshes[meshIdx];
+		ModelMesh* modelMesh = &mMeshes[meshIdx];
+		modelMesh->mName = (const char*)(data + cacheMesh->mNameOfs);
+		modelMesh->mTexFileName = (const char*)(data + cacheMesh->mTexFileNameOfs);
+		modelMesh->mBumpFileName = (const char*)(data + cacheMesh->mBumpFileNameOfs);
+		modelMesh->mMappedVertices = (const ModelVertex*)(data + cacheMesh->mVerticesOfs);
+		modelMesh->mNumMappedVertices = cacheMesh->mNumVertices;
+		modelMesh->mMappedIndices = (const uint16*)(data + cacheMesh->mIndicesOfs);
+		modelMesh->mNumMappedIndices = cacheMesh->mNumIndices;
+	}
+
+	mJoints.clear();
+	mJoints.resize(header->mNumJoints);
+	for (int jointIdx = 0; jointIdx < header->mNumJoints; jointIdx++)
+	{
+		const ModelCacheJoint* cacheJoint = &cacheJoints[jointIdx];
+		ModelJoint* modelJoint = &mJoints[jointIdx];
+		modelJoint->mName = (const char*)(data + cacheJoint->mNameOfs);
+		modelJoint->mParentIdx = cacheJoint->mParentIdx;
+		modelJoint->mPoseInvMatrix = cacheJoint->mPoseInvMatrix;
+	}
+
+	mAnims.clear();
+	mAnims.resize(header->mNumAnims);
+	for (int animIdx = 0; animIdx < header->mNumAnims; animIdx++)
+	{
+		const ModelCacheAnim* cacheAnim = &cacheAnims[animIdx];
+		ModelAnimation* modelAnim = &mAnims[animIdx];
+		modelAnim->mName = (const char*)(data + cacheAnim->mNameOfs);
+		modelAnim->mTracks = (const ModelAnimationTrack*)(data + cacheAnim->mTracksOfs);
+		modelAnim->mTrackData = data;
+		modelAnim->mNumTracks = header->mNumJoints;
+		modelAnim->mNumFrames = cacheAnim->mNumFrames;
+	}
+
+	return true;
+}
+
+void ModelDef::Unpack()
+{
+	for (auto& modelMesh : mMeshes)
+		modelMesh.Unpack();
+	for (auto& modelAnim : mAnims)
+		modelAnim.Unpack();
+	delete mMappedFile;
+	mMappedFile = NULL;
+}
 
 //
 
@@ -67,7 +556,7 @@ BF_EXPORT void BF_CALLTYPE ModelDefAnimation_GetJointTranslation(ModelAnimation*
 
 BF_EXPORT int BF_CALLTYPE ModelDefAnimation_GetFrameCount(ModelAnimation* modelAnimation)
 {
-	return (int)modelAnimation->mFrames.size();
+	return modelAnimation->GetFrameCount();
 }
 
 BF_EXPORT const char* BF_CALLTYPE ModelDefAnimation_GetName(ModelAnimation* modelAnimation)
@@ -77,9 +566,75 @@ BF_EXPORT const char* BF_CALLTYPE ModelDefAnimation_GetName(ModelAnimation* mode
 
 BF_EXPORT void BF_CALLTYPE ModelDefAnimation_Clip(ModelAnimation* modelAnimation, int startFrame, int numFrames)
 {	
-	modelAnimation->mFrames.erase(modelAnimation->mFrames.begin(), modelAnimation->mFrames.begin() + startFrame);
-	modelAnimation->mFrames.erase(modelAnimation->mFrames.begin() + numFrames, modelAnimation->mFrames.end());
+	modelAnimation->Clip(startFrame, numFrames);
 }
 
 
 
+// Loads every .bfmodel in a directory both mapped in place and unpacked into the legacy in-memory layout
+BF_EXPORT int BF_CALLTYPE ModelDef_RunCacheBenchmark(const char* dirName, int passCount)
+{
+	int64 elapsedMicros[2] = { 0, 0 };
+	int64 heapBytes[2] = { 0, 0 };
+	int64 cacheFileBytes = 0;
+	int64 legacyFileBytes = 0;
+	int numModels = 0;
+
+	for (auto& fileEntry : FileEnumerator(dirName, FileEnumerator::Flags_Files))
+	{
+		String filePath = fileEntry.GetFilePath();
+		if (!filePath.EndsWith(".bfmodel"))
+			continue;
+
+		for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+		{
+			bool isUnpacked = modeIdx == 1;
+			for (int passIdx = 0; passIdx < BF_MAX(passCount, 1); passIdx++)
+			{
+				uint64 startTick = BFGetTickCountMicro();
+				ModelDef* modelDef = new ModelDef();
+				if (!modelDef->ReadCache(filePath))
+				{
+					delete modelDef;
+					break;
+				}
+				if (isUnpacked)
+					modelDef->Unpack();
+				elapsedMicros[modeIdx] += (int64)(BFGetTickCountMicro() - startTick);
+
+				if (passIdx == 0)
+				{
+					for (auto& modelMesh : modelDef->mMeshes)
+					{
+						heapBytes[modeIdx] += sizeof(ModelMesh) + modelMesh.mVertices.size() * sizeof(ModelVertex) + modelMesh.mIndices.size() * sizeof(uint16);
+						if (modeIdx == 0)
+							legacyFileBytes += modelMesh.GetVertexCount() * sizeof(ModelVertex) + modelMesh.GetIndexCount() * sizeof(uint16);
+					}
+					heapBytes[modeIdx] += modelDef->mJoints.size() * sizeof(ModelJoint);
+					for (auto& modelAnim : modelDef->mAnims)
+					{
+						heapBytes[modeIdx] += sizeof(ModelAnimation) + modelAnim.mFrames.size() * (sizeof(ModelAnimationFrame) + modelDef->mJoints.size() * sizeof(ModelJointTranslation));
+						if (modeIdx == 0)
+							legacyFileBytes += modelAnim.GetFrameCount() * modelDef->mJoints.size() * sizeof(ModelJointTranslation);
+					}
+					if (modeIdx == 0)
+					{
+						cacheFileBytes += modelDef->mMappedFile->mFileSize;
+						legacyFileBytes += modelDef->mJoints.size() * (sizeof(int) + sizeof(Matrix4));
+						numModels++;
+					}
+				}
+				delete modelDef;
+			}
+		}
+	}
+
+	if (numModels == 0)
+		return -1;
+
+	int numPasses = BF_MAX(passCount, 1);
+	OutputDebugStrF("Model cache %s  %d models  Mapped: %lldus %lldKB heap  Unpacked: %lldus %lldKB heap  File: %lldKB (legacy %lldKB)\n", dirName, numModels,
+		(long long)(elapsedMicros[0] / numPasses), (long long)(heapBytes[0] / 1024), (long long)(elapsedMicros[1] / numPasses), (long long)(heapBytes[1] / 1024),
+		(long long)(cacheFileBytes / 1024), (long long)(legacyFileBytes / 1024));
+	return (int)(elapsedMicros[0] / numPasses);
+}
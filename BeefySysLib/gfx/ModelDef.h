@@ -3,10 +3,13 @@
 #include "Common.h"
 #include "util/Quaternion.h"
 #include "util/Vector.h"
+#include "util/Matrix4.h"
 #include <vector>
 
 NS_BF_BEGIN;
 
+class MappedFile;
+
 class ModelJointTranslation
 {
 public:
@@ -21,14 +24,52 @@ public:
 	std::vector<ModelJointTranslation> mJointTranslations;
 };
 
+enum ModelAnimationTrackFlags
+{
+	ModelAnimationTrackFlag_None = 0,
+	ModelAnimationTrackFlag_ConstRot = 1,
+	ModelAnimationTrackFlag_ConstTrans = 2,
+	ModelAnimationTrackFlag_ConstScale = 4
+};
+
+// One joint's keys in a model cache file. Rotations are stored as four int16s, translations and scales as three uint16s
+//  which are multiplied by the channel's step and added to its min. A constant channel only stores its first key.
+class ModelAnimationTrack
+{
+public:
+	Vector3 mTransMin;
+	Vector3 mTransStep;
+	Vector3 mScaleMin;
+	Vector3 mScaleStep;
+	int32 mRotOfs;
+	int32 mTransOfs;
+	int32 mScaleOfs;
+	int32 mFlags;
+
+public:
+	void GetKey(const uint8* data, int frameIdx, ModelJointTranslation* outJointTranslation) const;
+};
+
 class ModelAnimation
 {
 public:
 	String mName;
 	std::vector<ModelAnimationFrame> mFrames;
+	// Used instead of mFrames when loaded from a model cache, these point into the mapped file
+	const ModelAnimationTrack* mTracks;
+	const uint8* mTrackData;
+	int mNumTracks;
+	int mFrameOffset;
+	int mNumFrames;
 
 public:
+	ModelAnimation();
+
+	int GetFrameCount();
+	void GetFrameKey(int jointIdx, int frameIdx, ModelJointTranslation* outJointTranslation);
 	void GetJointTranslation(int jointIdx, float frameNum, ModelJointTranslation* outJointTranslation);
+	void Clip(int startFrame, int numFrames);
+	void Unpack();
 };
 
 #define MODEL_MAX_BONE_WEIGHTS 8
@@ -61,8 +102,22 @@ public:
 	String mName;
 	std::vector<ModelVertex> mVertices;
 	std::vector<uint16> mIndices;
+	// When loaded from a model cache these point into the mapped file and the vectors above are left empty
+	const ModelVertex* mMappedVertices;
+	const uint16* mMappedIndices;
+	int mNumMappedVertices;
+	int mNumMappedIndices;
 	String mTexFileName;
 	String mBumpFileName;
+
+public:
+	ModelMesh();
+
+	int GetVertexCount() const { return (mMappedVertices != NULL) ? mNumMappedVertices : (int)mVertices.size(); }
+	const ModelVertex* GetVertices() const { return (mMappedVertices != NULL) ? mMappedVertices : mVertices.data(); }
+	int GetIndexCount() const { return (mMappedIndices != NULL) ? mNumMappedIndices : (int)mIndices.size(); }
+	const uint16* GetIndices() const { return (mMappedIndices != NULL) ? mMappedIndices : mIndices.data(); }
+	void Unpack();
 };
 
 class ModelDef
@@ -73,6 +128,15 @@ public:
 	std::vector<ModelMesh> mMeshes;
 	std::vector<ModelJoint> mJoints;
 	std::vector<ModelAnimation> mAnims;
+	MappedFile* mMappedFile;
+
+public:
+	ModelDef();
+	~ModelDef();
+
+	bool WriteCache(const StringImpl& fileName, const StringImpl& checkFile, const StringImpl& checkFile2);
+	bool ReadCache(const StringImpl& fileName);
+	void Unpack();
 };
 
 NS_BF_END;
@@ -6,13 +6,59 @@ ModelInstance::ModelInstance(ModelDef* modelDef)
 {
 	mNext = NULL;
 	mModelDef = modelDef;
-	mJointTranslations.resize(mModelDef->mJoints.size());
+	mPose.Init((int)mModelDef->mJoints.size());
+	mJointMatrices.resize(mModelDef->mJoints.size());
+	mJointMatricesDirty = true;
 	mMeshesVisible.insert(mMeshesVisible.begin(), mModelDef->mMeshes.size(), true);
 }
 
 void Beefy::ModelInstance::SetJointPosition(int jointIdx, const ModelJointTranslation& jointTranslation)
 {
-	mJointTranslations[jointIdx] = jointTranslation;
+	mPose.SetJointTranslation(jointIdx, jointTranslation);
+	mJointMatricesDirty = true;
+}
+
+void ModelInstance::SetAnimState(ModelAnimation* animation, float frameNum)
+{
+	mPose.Sample(animation, frameNum);
+	mJointMatricesDirty = true;
+}
+
+void ModelInstance::UpdateJointMatrices()
+{
+	if (!mJointMatricesDirty)
+		return;
+	if (!mJointMatrices.empty())
+		mPose.BuildMatrices(mModelDef, &mJointMatrices[0]);
+	mJointMatricesDirty = false;
+}
+
+void ModelInstance::UpdateAnimStates(ModelInstance** instances, ModelAnimation** animations, const float* frameNums, int count)
+{
+	std::vector<ModelPose*> poses;
+	std::vector<Matrix4*> matrices;
+
+	// Batches are per ModelDef, so runs of instances sharing one are sampled together
+	int startIdx = 0;
+	while (startIdx < count)
+	{
+		ModelDef* modelDef = instances[startIdx]->mModelDef;
+		int endIdx = startIdx + 1;
+		while ((endIdx < count) && (instances[endIdx]->mModelDef == modelDef))
+			endIdx++;
+
+		poses.clear();
+		matrices.clear();
+		for (int idx = startIdx; idx < endIdx; idx++)
+		{
+			ModelInstance* instance = instances[idx];
+			poses.push_back(&instance->mPose);
+			matrices.push_back(instance->mJointMatrices.empty() ? NULL : &instance->mJointMatrices[0]);
+			instance->mJointMatricesDirty = false;
+		}
+		ModelPose::SampleBatch(modelDef, &poses[0], animations + startIdx, frameNums + startIdx, &matrices[0], endIdx - startIdx);
+		startIdx = endIdx;
+	}
 }
 
 ///
@@ -22,6 +68,16 @@ BF_EXPORT void BF_CALLTYPE ModelInstance_SetJointTranslation(ModelInstance* mode
 	modelInstance->SetJointPosition(jointIdx, jointTranslation);
 }
 
+BF_EXPORT void BF_CALLTYPE ModelInstance_SetAnimState(ModelInstance* modelInstance, ModelAnimation* animation, float frame)
+{
+	modelInstance->SetAnimState(animation, frame);
+}
+
+BF_EXPORT void BF_CALLTYPE ModelInstance_UpdateAnimStates(ModelInstance** modelInstances, ModelAnimation** animations, const float* frames, int count)
+{
+	ModelInstance::UpdateAnimStates(modelInstances, animations, frames, count);
+}
+
 BF_EXPORT void BF_CALLTYPE ModelInstance_SetMeshVisibility(ModelInstance* modelInstance, int meshIdx, int visible)
 {
 	modelInstance->mMeshesVisible[meshIdx] = visible != 0;
@@ -2,6 +2,7 @@
 
 #include "Common.h"
 #include "gfx/ModelDef.h"
+#include "gfx/ModelPose.h"
 #include "gfx/RenderCmd.h"
 #include "util/Matrix4.h"
 
@@ -11,7 +12,9 @@ class ModelInstance : public RenderCmd
 {
 public:
 	ModelDef* mModelDef;	
-	std::vector<ModelJointTranslation> mJointTranslations;
+	ModelPose mPose;
+	std::vector<Matrix4> mJointMatrices;
+	bool mJointMatricesDirty;
 	std::vector<bool> mMeshesVisible;
 
 public:
@@ -19,6 +22,10 @@ public:
 
 	virtual void Free() override {}	
 	virtual void SetJointPosition(int jointIdx, const ModelJointTranslation& jointTranslation);
+	virtual void SetAnimState(ModelAnimation* animation, float frameNum);
+	void UpdateJointMatrices();
+
+	static void UpdateAnimStates(ModelInstance** instances, ModelAnimation** animations, const float* frameNums, int count);
 };
 
 NS_BF_END;
\ No newline at end of file
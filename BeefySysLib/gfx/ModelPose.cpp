@@ -0,0 +1,417 @@
+#include "ModelPose.h"
+#include "util/ThreadPool.h"
+
+#if !defined BF_MODEL_NO_SIMD
+#if (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_MODEL_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+USING_NS_BF;
+
+int Beefy::gModelPoseFlags = ModelPoseFlag_None;
+
+#ifdef BF_MODEL_SSE2
+#define BF_MODEL_SIMD_ENABLED() ((gModelPoseFlags & ModelPoseFlag_NoSimd) == 0)
+
+// Same operation order as Matrix4::Multiply, so both paths give the same results. 'out' may alias either input.
+static inline void MultiplyMatrix(const Matrix4& m1, const Matrix4& m2, Matrix4* out)
+{
+	__m128 row0 = _mm_loadu_ps(m2.mMat[0]);
+	__m128 row1 = _mm_loadu_ps(m2.mMat[1]);
+	__m128 row2 = _mm_loadu_ps(m2.mMat[2]);
+	__m128 row3 = _mm_loadu_ps(m2.mMat[3]);
+	for (int rowIdx = 0; rowIdx < 4; rowIdx++)
+	{
+		const float* m1Row = m1.mMat[rowIdx];
+		__m128 result = _mm_mul_ps(_mm_set1_ps(m1Row[0]), row0);
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(m1Row[1]), row1));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(m1Row[2]), row2));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(m1Row[3]), row3));
+		_mm_storeu_ps(out->mMat[rowIdx], result);
+	}
+}
+#else
+#define BF_MODEL_SIMD_ENABLED() false
+
+static inline void MultiplyMatrix(const Matrix4& m1, const Matrix4& m2, Matrix4* out)
+{
+	*out = Matrix4::Multiply(m1, m2);
+}
+#endif
+
+static void StoreJointTranslation(float* data, int stride, int jointIdx, const ModelJointTranslation& jointTranslation)
+{
+	data[ModelPoseStream_RotX * stride + jointIdx] = jointTranslation.mQuat.mX;
+	data[ModelPoseStream_RotY * stride + jointIdx] = jointTranslation.mQuat.mY;
+	data[ModelPoseStream_RotZ * stride + jointIdx] = jointTranslation.mQuat.mZ;
+	data[ModelPoseStream_RotW * stride + jointIdx] = jointTranslation.mQuat.mW;
+	data[ModelPoseStream_TransX * stride + jointIdx] = jointTranslation.mTrans.mX;
+	data[ModelPoseStream_TransY * stride + jointIdx] = jointTranslation.mTrans.mY;
+	data[ModelPoseStream_TransZ * stride + jointIdx] = jointTranslation.mTrans.mZ;
+	data[ModelPoseStream_ScaleX * stride + jointIdx] = jointTranslation.mScale.mX;
+	data[ModelPoseStream_ScaleY * stride + jointIdx] = jointTranslation.mScale.mY;
+	data[ModelPoseStream_ScaleZ * stride + jointIdx] = jointTranslation.mScale.mZ;
+}
+
+static void LoadJointTranslation(const float* data, int stride, int jointIdx, ModelJointTranslation* outJointTranslation)
+{
+	outJointTranslation->mQuat.mX = data[ModelPoseStream_RotX * stride + jointIdx];
+	outJointTranslation->mQuat.mY = data[ModelPoseStream_RotY * stride + jointIdx];
+	outJointTranslation->mQuat.mZ = data[ModelPoseStream_RotZ * stride + jointIdx];
+	outJointTranslation->mQuat.mW = data[ModelPoseStream_RotW * stride + jointIdx];
+	outJointTranslation->mTrans = Vector3(data[ModelPoseStream_TransX * stride + jointIdx], data[ModelPoseStream_TransY * stride + jointIdx], data[ModelPoseStream_TransZ * stride + jointIdx]);
+	outJointTranslation->mScale = Vector3(data[ModelPoseStream_ScaleX * stride + jointIdx], data[ModelPoseStream_ScaleY * stride + jointIdx], data[ModelPoseStream_ScaleZ * stride + jointIdx]);
+}
+
+ModelPose::ModelPose()
+{
+	mNumJoints = 0;
+	mStride = 0;
+}
+
+void ModelPose::Init(int numJoints)
+{
+	mNumJoints = numJoints;
+	mStride = (numJoints + 3) & ~3;
+	mData.clear();
+	mData.resize(ModelPoseStream_COUNT * mStride, 0.0f);
+	for (int jointIdx = 0; jointIdx < mStride; jointIdx++)
+	{
+		mData[ModelPoseStream_RotW * mStride + jointIdx] = 1.0f;
+		mData[ModelPoseStream_ScaleX * mStride + jointIdx] = 1.0f;
+		mData[ModelPoseStream_ScaleY * mStride + jointIdx] = 1.0f;
+		mData[ModelPoseStream_ScaleZ * mStride + jointIdx] = 1.0f;
+	}
+	mEndData = mData;
+}
+
+void ModelPose::GetJointTranslation(int jointIdx, ModelJointTranslation* outJointTranslation)
+{
+	LoadJointTranslation(&mData[0], mStride, jointIdx, outJointTranslation);
+}
+
+void ModelPose::SetJointTranslation(int jointIdx, const ModelJointTranslation& jointTranslation)
+{
+	StoreJointTranslation(&mData[0], mStride, jointIdx, jointTranslation);
+}
+
+void ModelPose::Sample(ModelAnimation* animation, float frameNum)
+{
+	int frameCount = animation->GetFrameCount();
+	if ((mNumJoints == 0) || (frameCount == 0))
+		return;
+	BF_ASSERT((int)frameNum < frameCount);
+	int frameNumStart = (int)frameNum;
+	int frameNumEnd = (frameNumStart + 1) % frameCount;
+
+	float endAlpha = frameNum - frameNumStart;
+	float startAlpha = 1.0f - endAlpha;
+
+	// Keys are decoded into the streams one joint at a time, then blended four joints at a time
+	float* startData = &mData[0];
+	float* endData = &mEndData[0];
+	ModelJointTranslation key;
+	for (int jointIdx = 0; jointIdx < mNumJoints; jointIdx++)
+	{
+		animation->GetFrameKey(jointIdx, frameNumStart, &key);
+		StoreJointTranslation(startData, mStride, jointIdx, key);
+		animation->GetFrameKey(jointIdx, frameNumEnd, &key);
+		StoreJointTranslation(endData, mStride, jointIdx, key);
+	}
+
+	int jointIdx = 0;
+#ifdef BF_MODEL_SSE2
+	if (BF_MODEL_SIMD_ENABLED())
+	{
+		__m128 startAlpha4 = _mm_set1_ps(startAlpha);
+		__m128 endAlpha4 = _mm_set1_ps(endAlpha);
+		__m128 signMask = _mm_set1_ps(-0.0f);
+		__m128 one = _mm_set1_ps(1.0f);
+		int stride = mStride;
+		for (; jointIdx < mStride; jointIdx += 4)
+		{
+			__m128 startX = _mm_loadu_ps(startData + ModelPoseStream_RotX * stride + jointIdx);
+			__m128 startY = _mm_loadu_ps(startData + ModelPoseStream_RotY * stride + jointIdx);
+			__m128 startZ = _mm_loadu_ps(startData + ModelPoseStream_RotZ * stride + jointIdx);
+			__m128 startW = _mm_loadu_ps(startData + ModelPoseStream_RotW * stride + jointIdx);
+			__m128 endX = _mm_loadu_ps(endData + ModelPoseStream_RotX * stride + jointIdx);
+			__m128 endY = _mm_loadu_ps(endData + ModelPoseStream_RotY * stride + jointIdx);
+			__m128 endZ = _mm_loadu_ps(endData + ModelPoseStream_RotZ * stride + jointIdx);
+			__m128 endW = _mm_loadu_ps(endData + ModelPoseStream_RotW * stride + jointIdx);
+
+			// Shortest path, then the normalized lerp that Quaternion::Slerp falls back to
+			__m128 dot = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(startX, endX), _mm_mul_ps(startY, endY)), _mm_mul_ps(startZ, endZ)), _mm_mul_ps(startW, endW));
+			__m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), signMask);
+			__m128 quatX = _mm_add_ps(_mm_mul_ps(startX, startAlpha4), _mm_mul_ps(_mm_xor_ps(endX, flip), endAlpha4));
+			__m128 quatY = _mm_add_ps(_mm_mul_ps(startY, startAlpha4), _mm_mul_ps(_mm_xor_ps(endY, flip), endAlpha4));
+			__m128 quatZ = _mm_add_ps(_mm_mul_ps(startZ, startAlpha4), _mm_mul_ps(_mm_xor_ps(endZ, flip), endAlpha4));
+			__m128 quatW = _mm_add_ps(_mm_mul_ps(startW, startAlpha4), _mm_mul_ps(_mm_xor_ps(endW, flip), endAlpha4));
+			__m128 norm = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(quatX, quatX), _mm_mul_ps(quatY, quatY)), _mm_mul_ps(quatZ, quatZ)), _mm_mul_ps(quatW, quatW));
+			__m128 factor = _mm_div_ps(one, _mm_sqrt_ps(norm));
+			_mm_storeu_ps(startData + ModelPoseStream_RotX * stride + jointIdx, _mm_mul_ps(quatX, factor));
+			_mm_storeu_ps(startData + ModelPoseStream_RotY * stride + jointIdx, _mm_mul_ps(quatY, factor));
+			_mm_storeu_ps(startData + ModelPoseStream_RotZ * stride + jointIdx, _mm_mul_ps(quatZ, factor));
+			_mm_storeu_ps(startData + ModelPoseStream_RotW * stride + jointIdx, _mm_mul_ps(quatW, factor));
+
+			for (int streamIdx = ModelPoseStream_TransX; streamIdx < ModelPoseStream_COUNT; streamIdx++)
+			{
+				float* startPtr = startData + streamIdx * stride + jointIdx;
+				__m128 val = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(startPtr), startAlpha4), _mm_mul_ps(_mm_loadu_ps(endData + streamIdx * stride + jointIdx), endAlpha4));
+				_mm_storeu_ps(startPtr, val);
+			}
+		}
+	}
+#endif
+
+	for (; jointIdx < mNumJoints; jointIdx++)
+	{
+		ModelJointTranslation jointTransStart;
+		ModelJointTranslation jointTransEnd;
+		LoadJointTranslation(startData, mStride, jointIdx, &jointTransStart);
+		LoadJointTranslation(endData, mStride, jointIdx, &jointTransEnd);
+
+		ModelJointTranslation jointTrans;
+		jointTrans.mQuat = Quaternion::Slerp(endAlpha, jointTransStart.mQuat, jointTransEnd.mQuat, true);
+		jointTrans.mScale = (jointTransStart.mScale * startAlpha) + (jointTransEnd.mScale * endAlpha);
+		jointTrans.mTrans = (jointTransStart.mTrans * startAlpha) + (jointTransEnd.mTrans * endAlpha);
+		StoreJointTranslation(startData, mStride, jointIdx, jointTrans);
+	}
+}
+
+void ModelPose::BuildMatrices(ModelDef* modelDef, Matrix4* outMatrices)
+{
+	int numJoints = BF_MIN(mNumJoints, (int)modelDef->mJoints.size());
+	const float* data = mData.data();
+
+	int jointIdx = 0;
+#ifdef BF_MODEL_SSE2
+	if (BF_MODEL_SIMD_ENABLED())
+	{
+		// Matrix4::CreateTransform for four joints at once, transposed back into one matrix per joint
+		int stride = mStride;
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 lastRow = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		for (; jointIdx + 4 <= numJoints; jointIdx += 4)
+		{
+			__m128 quatX = _mm_loadu_ps(data + ModelPoseStream_RotX * stride + jointIdx);
+			__m128 quatY = _mm_loadu_ps(data + ModelPoseStream_RotY * stride + jointIdx);
+			__m128 quatZ = _mm_loadu_ps(data + ModelPoseStream_RotZ * stride + jointIdx);
+			__m128 quatW = _mm_loadu_ps(data + ModelPoseStream_RotW * stride + jointIdx);
+			__m128 scaleX = _mm_loadu_ps(data + ModelPoseStream_ScaleX * stride + jointIdx);
+			__m128 scaleY = _mm_loadu_ps(data + ModelPoseStream_ScaleY * stride + jointIdx);
+			__m128 scaleZ = _mm_loadu_ps(data + ModelPoseStream_ScaleZ * stride + jointIdx);
+
+			__m128 tx = _mm_add_ps(quatX, quatX);
+			__m128 ty = _mm_add_ps(quatY, quatY);
+			__m128 tz = _mm_add_ps(quatZ, quatZ);
+			__m128 twx = _mm_mul_ps(tx, quatW);
+			__m128 twy = _mm_mul_ps(ty, quatW);
+			__m128 twz = _mm_mul_ps(tz, quatW);
+			__m128 txx = _mm_mul_ps(tx, quatX);
+			__m128 txy = _mm_mul_ps(ty, quatX);
+			__m128 txz = _mm_mul_ps(tz, quatX);
+			__m128 tyy = _mm_mul_ps(ty, quatY);
+			__m128 tyz = _mm_mul_ps(tz, quatY);
+			__m128 tzz = _mm_mul_ps(tz, quatZ);
+
+			__m128 rows[3][4];
+			rows[0][0] = _mm_mul_ps(scaleX, _mm_sub_ps(one, _mm_add_ps(tyy, tzz)));
+			rows[0][1] = _mm_mul_ps(scaleY, _mm_sub_ps(txy, twz));
+			rows[0][2] = _mm_mul_ps(scaleZ, _mm_add_ps(txz, twy));
+			rows[0][3] = _mm_loadu_ps(data + ModelPoseStream_TransX * stride + jointIdx);
+			rows[1][0] = _mm_mul_ps(scaleX, _mm_add_ps(txy, twz));
+			rows[1][1] = _mm_mul_ps(scaleY, _mm_sub_ps(one, _mm_add_ps(txx, tzz)));
+			rows[1][2] = _mm_mul_ps(scaleZ, _mm_sub_ps(tyz, twx));
+			rows[1][3] = _mm_loadu_ps(data + ModelPoseStream_TransY * stride + jointIdx);
+			rows[2][0] = _mm_mul_ps(scaleX, _mm_sub_ps(txz, twy));
+			rows[2][1] = _mm_mul_ps(scaleY, _mm_add_ps(tyz, twx));
+			rows[2][2] = _mm_mul_ps(scaleZ, _mm_sub_ps(one, _mm_add_ps(txx, tyy)));
+			rows[2][3] = _mm_loadu_ps(data + ModelPoseStream_TransZ * stride + jointIdx);
+
+			for (int rowIdx = 0; rowIdx < 3; rowIdx++)
+			{
+				__m128* row = rows[rowIdx];
+				_MM_TRANSPOSE4_PS(row[0], row[1], row[2], row[3]);
+				for (int laneIdx = 0; laneIdx < 4; laneIdx++)
+					_mm_storeu_ps(outMatrices[jointIdx + laneIdx].mMat[rowIdx], row[laneIdx]);
+			}
+			for (int laneIdx = 0; laneIdx < 4; laneIdx++)
+				_mm_storeu_ps(outMatrices[jointIdx + laneIdx].mMat[3], lastRow);
+		}
+	}
+#endif
+
+	for (; jointIdx < numJoints; jointIdx++)
+	{
+		ModelJointTranslation jointTrans;
+		LoadJointTranslation(data, mStride, jointIdx, &jointTrans);
+		outMatrices[jointIdx] = Matrix4::CreateTransform(jointTrans.mTrans, jointTrans.mScale, jointTrans.mQuat);
+	}
+
+	bool useSimd = BF_MODEL_SIMD_ENABLED();
+	for (jointIdx = 0; jointIdx < numJoints; jointIdx++)
+	{
+		ModelJoint* joint = &modelDef->mJoints[jointIdx];
+		BF_ASSERT(joint->mParentIdx < jointIdx);
+		if (joint->mParentIdx < 0)
+			continue;
+		if (useSimd)
+			MultiplyMatrix(outMatrices[joint->mParentIdx], outMatrices[jointIdx], &outMatrices[jointIdx]);
+		else
+			outMatrices[jointIdx] = Matrix4::Multiply(outMatrices[joint->mParentIdx], outMatrices[jointIdx]);
+	}
+
+	// Children need their parent's world transform, so the inverse bind pose can only go on after the whole hierarchy
+	for (jointIdx = 0; jointIdx < numJoints; jointIdx++)
+	{
+		ModelJoint* joint = &modelDef->mJoints[jointIdx];
+		if (useSimd)
+			MultiplyMatrix(outMatrices[jointIdx], joint->mPoseInvMatrix, &outMatrices[jointIdx]);
+		else
+			outMatrices[jointIdx] = Matrix4::Multiply(outMatrices[jointIdx], joint->mPoseInvMatrix);
+	}
+}
+
+//
+
+#define BF_MODEL_BATCH_SIZE 4
+
+void ModelPose::SampleBatch(ModelDef* modelDef, ModelPose** poses, ModelAnimation** animations, const float* frameNums, Matrix4** outMatrices, int count)
+{
+	auto _SamplePoses = [&](int startIdx, int endIdx)
+	{
+		for (int idx = startIdx; idx < endIdx; idx++)
+		{
+			if (animations[idx] != NULL)
+				poses[idx]->Sample(animations[idx], frameNums[idx]);
+			poses[idx]->BuildMatrices(modelDef, outMatrices[idx]);
+		}
+	};
+
+	if ((gModelPoseFlags & ModelPoseFlag_NoThreads) != 0)
+	{
+		if (count > 0)
+			_SamplePoses(0, count);
+		return;
+	}
+	ThreadPool::ParallelFor(count, BF_MODEL_BATCH_SIZE, _SamplePoses);
+}
+
+//
+
+// Poses many instances of a synthetic skeleton, first one joint at a time the way the per-joint API does, then
+//  through the batched path with and without SIMD and threads
+BF_EXPORT int BF_CALLTYPE ModelPose_RunBenchmark(int numInstances, int numJoints, int passCount)
+{
+	if ((numInstances <= 0) || (numJoints <= 0))
+		return -1;
+
+	const int numFrames = 60;
+	ModelDef modelDef;
+	modelDef.mFrameRate = 30;
+	modelDef.mJoints.resize(numJoints);
+	srand(0);
+	auto _Rand = []() { return (rand() % 2001) / 1000.0f - 1.0f; };
+	for (int jointIdx = 0; jointIdx < numJoints; jointIdx++)
+	{
+		ModelJoint* joint = &modelDef.mJoints[jointIdx];
+		joint->mName = StrFormat("Joint%d", jointIdx);
+		joint->mParentIdx = (jointIdx == 0) ? -1 : (jointIdx - 1) / 2;
+		joint->mPoseInvMatrix = Matrix4::CreateTransform(Vector3(_Rand(), _Rand(), _Rand()), Vector3(1, 1, 1), Quaternion::Normalise(Quaternion(_Rand(), _Rand(), _Rand(), 2.0f)));
+	}
+
+	modelDef.mAnims.resize(1);
+	ModelAnimation* animation = &modelDef.mAnims[0];
+	animation->mName = "Bench";
+	animation->mFrames.resize(numFrames);
+	for (auto& frame : animation->mFrames)
+	{
+		frame.mJointTranslations.resize(numJoints);
+		for (auto& jointTrans : frame.mJointTranslations)
+		{
+			jointTrans.mQuat = Quaternion::Normalise(Quaternion(_Rand(), _Rand(), _Rand(), _Rand() + 2.0f));
+			jointTrans.mScale = Vector3(1.0f + _Rand() * 0.1f, 1.0f + _Rand() * 0.1f, 1.0f + _Rand() * 0.1f);
+			jointTrans.mTrans = Vector3(_Rand(), _Rand(), _Rand());
+		}
+	}
+
+	std::vector<ModelPose> poses(numInstances);
+	std::vector<ModelPose*> posePtrs(numInstances);
+	std::vector<ModelAnimation*> animations(numInstances, animation);
+	std::vector<float> frameNums(numInstances);
+	std::vector<std::vector<Matrix4> > matrices[2];
+	std::vector<Matrix4*> matrixPtrs(numInstances);
+	for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+	{
+		matrices[modeIdx].resize(numInstances);
+		for (auto& instanceMatrices : matrices[modeIdx])
+			instanceMatrices.resize(numJoints);
+	}
+	for (int instanceIdx = 0; instanceIdx < numInstances; instanceIdx++)
+	{
+		poses[instanceIdx].Init(numJoints);
+		posePtrs[instanceIdx] = &poses[instanceIdx];
+		matrixPtrs[instanceIdx] = &matrices[1][instanceIdx][0];
+	}
+
+	const char* modeNames[4] = { "PerJoint", "Scalar", "Simd", "SimdThreads" };
+	int modeFlags[4] = { 0, ModelPoseFlag_NoSimd | ModelPoseFlag_NoThreads, ModelPoseFlag_NoThreads, ModelPoseFlag_None };
+	int64 elapsedMicros[4] = { 0, 0, 0, 0 };
+	float maxError = 0;
+	int prevFlags = gModelPoseFlags;
+	for (int passIdx = 0; passIdx < BF_MAX(passCount, 1); passIdx++)
+	{
+		for (int instanceIdx = 0; instanceIdx < numInstances; instanceIdx++)
+			frameNums[instanceIdx] = fmodf(instanceIdx * 0.37f + passIdx * 0.5f, (float)(numFrames - 1));
+
+		uint64 startTick = BFGetTickCountMicro();
+		for (int instanceIdx = 0; instanceIdx < numInstances; instanceIdx++)
+		{
+			Matrix4* jointMatrices = &matrices[0][instanceIdx][0];
+			for (int jointIdx = 0; jointIdx < numJoints; jointIdx++)
+			{
+				ModelJointTranslation jointTrans;
+				animation->GetJointTranslation(jointIdx, frameNums[instanceIdx], &jointTrans);
+				jointMatrices[jointIdx] = Matrix4::CreateTransform(jointTrans.mTrans, jointTrans.mScale, jointTrans.mQuat);
+				int parentIdx = modelDef.mJoints[jointIdx].mParentIdx;
+				if (parentIdx >= 0)
+					jointMatrices[jointIdx] = Matrix4::Multiply(jointMatrices[parentIdx], jointMatrices[jointIdx]);
+			}
+			for (int jointIdx = 0; jointIdx < numJoints; jointIdx++)
+				jointMatrices[jointIdx] = Matrix4::Multiply(jointMatrices[jointIdx], modelDef.mJoints[jointIdx].mPoseInvMatrix);
+		}
+		elapsedMicros[0] += (int64)(BFGetTickCountMicro() - startTick);
+
+		for (int modeIdx = 1; modeIdx < 4; modeIdx++)
+		{
+			gModelPoseFlags = modeFlags[modeIdx];
+			startTick = BFGetTickCountMicro();
+			ModelPose::SampleBatch(&modelDef, &posePtrs[0], &animations[0], &frameNums[0], &matrixPtrs[0], numInstances);
+			elapsedMicros[modeIdx] += (int64)(BFGetTickCountMicro() - startTick);
+
+			for (int instanceIdx = 0; instanceIdx < numInstances; instanceIdx++)
+			{
+				for (int jointIdx = 0; jointIdx < numJoints; jointIdx++)
+				{
+					const float* refMat = matrices[0][instanceIdx][jointIdx].mMatFlat;
+					const float* mat = matrices[1][instanceIdx][jointIdx].mMatFlat;
+					for (int i = 0; i < 16; i++)
+						maxError = BF_MAX(maxError, fabsf(refMat[i] - mat[i]));
+				}
+			}
+		}
+	}
+	gModelPoseFlags = prevFlags;
+
+	String result = StrFormat("Model pose %d instances x %d joints ", numInstances, numJoints);
+	for (int modeIdx = 0; modeIdx < 4; modeIdx++)
+	{
+		int64 jointsPerSec = (int64)numInstances * numJoints * BF_MAX(passCount, 1) * 1000000 / BF_MAX(elapsedMicros[modeIdx], (int64)1);
+		result += StrFormat(" %s: %lldK joints/s", modeNames[modeIdx], (long long)(jointsPerSec / 1000));
+	}
+	result += StrFormat("  Max error: %g\n", maxError);
+	OutputDebugStrF("%s", result.c_str());
+	return (int)(elapsedMicros[3] / BF_MAX(passCount, 1));
+}
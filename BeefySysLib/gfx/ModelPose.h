@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Common.h"
+#include "gfx/ModelDef.h"
+#include "util/Matrix4.h"
+
+NS_BF_BEGIN;
+
+enum ModelPoseFlags
+{
+	ModelPoseFlag_None = 0,
+	ModelPoseFlag_NoSimd = 1,
+	ModelPoseFlag_NoThreads = 2
+};
+
+extern int gModelPoseFlags;
+
+enum ModelPoseStream
+{
+	ModelPoseStream_RotX,
+	ModelPoseStream_RotY,
+	ModelPoseStream_RotZ,
+	ModelPoseStream_RotW,
+	ModelPoseStream_TransX,
+	ModelPoseStream_TransY,
+	ModelPoseStream_TransZ,
+	ModelPoseStream_ScaleX,
+	ModelPoseStream_ScaleY,
+	ModelPoseStream_ScaleZ,
+
+	ModelPoseStream_COUNT
+};
+
+// The translations of a whole skeleton, stored as one stream per component so four joints can be sampled and
+//  converted to matrices at once. Streams are padded to a multiple of four joints with identity transforms.
+class ModelPose
+{
+public:
+	int mNumJoints;
+	int mStride;
+	std::vector<float> mData;
+	std::vector<float> mEndData;
+
+public:
+	ModelPose();
+
+	void Init(int numJoints);
+	float* GetStream(ModelPoseStream stream) { return &mData[stream * mStride]; }
+	void GetJointTranslation(int jointIdx, ModelJointTranslation* outJointTranslation);
+	void SetJointTranslation(int jointIdx, const ModelJointTranslation& jointTranslation);
+
+	void Sample(ModelAnimation* animation, float frameNum);
+	// Fills one skinning matrix per joint, which is the joint's world transform times its inverse bind pose
+	void BuildMatrices(ModelDef* modelDef, Matrix4* outMatrices);
+
+	// Samples and builds the matrices of many poses of the same model, split across worker threads
+	static void SampleBatch(ModelDef* modelDef, ModelPose** poses, ModelAnimation** animations, const float* frameNums, Matrix4** outMatrices, int count);
+};
+
+NS_BF_END;
@@ -8,6 +8,7 @@ class RenderState;
 class RenderDevice;
 class RenderWindow;
 class DrawLayer;
+class Texture;
 
 class RenderCmd
 {
@@ -32,4 +33,19 @@ public:
 	virtual void Free();
 };
 
+// Base of the device's texture binding command, so DrawLayer can track and rewrite bindings when it merges batches
+class SetTextureCmd : public RenderCmd
+{
+public:
+	int mTextureIdx;
+	Texture* mTexture;
+
+public:
+	SetTextureCmd()
+	{
+		mTextureIdx = 0;
+		mTexture = NULL;
+	}
+};
+
 NS_BF_END;
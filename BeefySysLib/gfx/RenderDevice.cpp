@@ -3,6 +3,7 @@
 #include "Shader.h"
 #include "Texture.h"
 #include "gfx/DrawLayer.h"
+#include "gfx/FTFont.h"
 #include "img/TGAData.h"
 #include "img/PNGData.h"
 #include "img/PVRData.h"
@@ -56,6 +57,10 @@ RenderDevice::RenderDevice() :
 	mDefaultRenderState = NULL;
 	mPhysRenderState = mDefaultRenderState;
 	mResizeCount = 0;
+	mMergeBatches = true;
+	memset(mDrawCounters, 0, sizeof(mDrawCounters));
+	memset(mPrevDrawCounters, 0, sizeof(mPrevDrawCounters));
+	mFrameEndTick = 0;
 	mCurRenderTarget = NULL;		
 	mCurDrawLayer = NULL;
 	mPhysRenderWindow = NULL;	
@@ -79,6 +84,15 @@ void RenderDevice::RemoveRenderWindow(RenderWindow* renderWindow)
 
 void RenderDevice::FrameEnd()
 {
+	uint64 tick = BFGetTickCountMicro();
+	if (mFrameEndTick != 0)
+		mDrawCounters[DrawCounter_FrameMicros] = (int64)(tick - mFrameEndTick);
+	mFrameEndTick = tick;
+
+	memcpy(mPrevDrawCounters, mDrawCounters, sizeof(mDrawCounters));
+	memset(mDrawCounters, 0, sizeof(mDrawCounters));
+	// Glyphs used in this frame have been drawn, so they can be evicted now
+	FTFontManager::EndFrame();
 }
 
 RenderState* RenderDevice::CreateRenderState(RenderState* srcRenderState)
@@ -109,6 +123,14 @@ Texture* RenderDevice::LoadTexture(const StringImpl& fileName, int flags)
 	bool handled = false;
 	bool failed = false;
 
+	int hwBitsType = HWBITS_UNKNOWN;
+	if ((flags & TextureFlag_CompressBC7) != 0)
+		hwBitsType = HWBITS_BC7;
+	else if ((flags & TextureFlag_CompressBC3) != 0)
+		hwBitsType = HWBITS_BC3;
+	else if ((flags & TextureFlag_CompressBC1) != 0)
+		hwBitsType = HWBITS_BC1;
+
 	if (fileName == "!white")
 	{
 		imageData = new ImageData();
@@ -116,6 +138,16 @@ Texture* RenderDevice::LoadTexture(const StringImpl& fileName, int flags)
 		imageData->mBits[0] = 0xFFFFFFFF;
 		handled = true;
 	}
+	else if ((hwBitsType != HWBITS_UNKNOWN) && (ext != ".bfi"))
+	{
+		imageData = BFIData::LoadCached(fileName, hwBitsType, (flags & TextureFlag_NoPremult) == 0, (flags & TextureFlag_Additive) != 0);
+		handled = true;
+		if (imageData == NULL)
+		{
+			BF_FATAL("Failed to load image");
+			return NULL;
+		}
+	}
 	else if (ext == ".tga")
 		imageData = new TGAData();	
 	else if (ext == ".png")
@@ -124,6 +156,8 @@ Texture* RenderDevice::LoadTexture(const StringImpl& fileName, int flags)
 		imageData = new JPEGData();
 	else if (ext == ".pvr")
 		imageData = new PVRData();
+	else if (ext == ".bfi")
+		imageData = new BFIData();
 	else
 	{
 		BF_FATAL("Unknown texture format");
@@ -148,6 +148,10 @@ enum TextureFlag : int8
 	TextureFlag_Additive = 1,
 	TextureFlag_NoPremult = 2,
 	TextureFlag_AllowRead = 4,
+	// Loads through a .bfi block-compressed cache next to the source file, building it if it's missing or stale
+	TextureFlag_CompressBC1 = 8,
+	TextureFlag_CompressBC3 = 0x10,
+	TextureFlag_CompressBC7 = 0x20
 };
 
 struct VertexDefData
@@ -239,10 +243,29 @@ public:
 	}
 };
 
+enum DrawCounter
+{
+	DrawCounter_BatchesAllocated,
+	DrawCounter_BatchesMerged,
+	DrawCounter_BatchesDrawn,
+	DrawCounter_SetTextureCmds,
+	DrawCounter_Vertices,
+	DrawCounter_Indices,
+	DrawCounter_FrameMicros,
+
+	DrawCounter_COUNT
+};
+
 class RenderDevice
 {
 public:	
 	Array<DrawBatch*>		mDrawBatchPool;	
+	bool					mMergeBatches;
+
+	// Counters accumulate in mDrawCounters over a frame, FrameEnd moves them to mPrevDrawCounters
+	int64					mDrawCounters[DrawCounter_COUNT];
+	int64					mPrevDrawCounters[DrawCounter_COUNT];
+	uint64					mFrameEndTick;
 	
 	RenderWindow*			mPhysRenderWindow;
 	RenderState*			mPhysRenderState;
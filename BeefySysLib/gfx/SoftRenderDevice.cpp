@@ -0,0 +1,990 @@
+#include "Common.h"
+#include "SoftRenderDevice.h"
+#include "BFApp.h"
+#include "BFWindow.h"
+#include "img/ImageUtils.h"
+#include "img/BlockCompress.h"
+#include "img/PNGData.h"
+#include "util/Hash.h"
+#include "util/PerfTimer.h"
+#include "util/BeefPerf.h"
+#include <float.h>
+
+#include "util/AllocDebug.h"
+
+USING_NS_BF;
+
+// Subpixel precision of triangle edges
+#define SOFT_SUBPIXEL_BITS 4
+#define SOFT_SUBPIXEL_SCALE (1 << SOFT_SUBPIXEL_BITS)
+// Triangles queued before they're rasterized early, to bound the setup memory
+#define SOFT_MAX_QUEUED_TRIANGLES (64 * 1024)
+// Vertices farther out than this are dropped rather than risking edge overflow
+#define SOFT_MAX_COORD 32768.0f
+
+static inline int SoftMul255(int a, int b)
+{
+	int t = a * b + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+static inline uint32 SoftMul255Packed(uint32 pair, int m)
+{
+	// Two 8-bit lanes held 16 bits apart
+	uint32 t = pair * m + 0x00800080;
+	return ((t + ((t >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+}
+
+static inline uint32 SoftLerpPacked(uint32 c0, uint32 c1, int f)
+{
+	uint32 rb = ((c0 & 0x00FF00FF) * (256 - f) + (c1 & 0x00FF00FF) * f) >> 8;
+	uint32 ag = (((c0 >> 8) & 0x00FF00FF) * (256 - f) + ((c1 >> 8) & 0x00FF00FF) * f) >> 8;
+	return (rb & 0x00FF00FF) | ((ag & 0x00FF00FF) << 8);
+}
+
+// Linear filtering with clamped addressing, as the linearSampler in Std.fx. s and t are in texels, already offset so
+//  texel centers land on whole numbers.
+static inline uint32 SoftSampleBilinear(const ImageData* texture, float s, float t)
+{
+	int width = texture->mWidth;
+	int height = texture->mHeight;
+	// Biased by a texel so truncation floors, with 8 bits of fraction for the weights
+	int fixedS = (int)((BF_CLAMP(s, -1.0f, (float)width) + 1.0f) * 256.0f);
+	int fixedT = (int)((BF_CLAMP(t, -1.0f, (float)height) + 1.0f) * 256.0f);
+	int x0 = (fixedS >> 8) - 1;
+	int y0 = (fixedT >> 8) - 1;
+	int fx = fixedS & 0xFF;
+	int fy = fixedT & 0xFF;
+	int x1 = BF_MIN(x0 + 1, width - 1);
+	int y1 = BF_MIN(y0 + 1, height - 1);
+	x0 = BF_CLAMP(x0, 0, width - 1);
+	y0 = BF_CLAMP(y0, 0, height - 1);
+	x1 = BF_MAX(x1, 0);
+	y1 = BF_MAX(y1, 0);
+
+	const uint32* row0 = texture->mBits + y0 * width;
+	if ((fx | fy) == 0)
+		return row0[x0];
+	const uint32* row1 = texture->mBits + y1 * width;
+	uint32 top = SoftLerpPacked(row0[x0], row0[x1], fx);
+	uint32 bottom = SoftLerpPacked(row1[x0], row1[x1], fx);
+	return SoftLerpPacked(top, bottom, fy);
+}
+
+static void SoftCopyRect(uint32* dest, int destPitch, const uint32* src, int srcPitch, int width, int height)
+{
+	for (int y = 0; y < height; y++)
+		memcpy(dest + y * destPitch, src + y * srcPitch, width * sizeof(uint32));
+}
+
+///
+
+SoftTexture::SoftTexture()
+{
+	mRenderDevice = NULL;
+}
+
+SoftTexture::~SoftTexture()
+{
+	// Queued triangles may still sample from or draw into this texture
+	if (mRenderDevice != NULL)
+	{
+		mRenderDevice->FlushTriangles();
+		if (mRenderDevice->mTargetImage == &mImageData)
+			mRenderDevice->mTargetImage = NULL;
+	}
+}
+
+void SoftTexture::PhysSetAsTarget()
+{
+	mRenderDevice->SetTargetImage(&mImageData, true);
+	mHasBeenDrawnTo = true;
+}
+
+void SoftTexture::Blt(ImageData* imageData, int x, int y)
+{
+	SetBits(x, y, imageData->mWidth, imageData->mHeight, imageData->mWidth, imageData->mBits);
+}
+
+void SoftTexture::SetBits(int destX, int destY, int destWidth, int destHeight, int srcPitch, uint32* bits)
+{
+	mRenderDevice->FlushTriangles();
+
+	int x0 = BF_MAX(destX, 0);
+	int y0 = BF_MAX(destY, 0);
+	int x1 = BF_MIN(destX + destWidth, mImageData.mWidth);
+	int y1 = BF_MIN(destY + destHeight, mImageData.mHeight);
+	if ((x1 <= x0) || (y1 <= y0))
+		return;
+	SoftCopyRect(mImageData.mBits + y0 * mImageData.mWidth + x0, mImageData.mWidth, bits + (y0 - destY) * srcPitch + (x0 - destX), srcPitch, x1 - x0, y1 - y0);
+}
+
+void SoftTexture::GetBits(int srcX, int srcY, int srcWidth, int srcHeight, int destPitch, uint32* bits)
+{
+	mRenderDevice->FlushTriangles();
+
+	int x0 = BF_MAX(srcX, 0);
+	int y0 = BF_MAX(srcY, 0);
+	int x1 = BF_MIN(srcX + srcWidth, mImageData.mWidth);
+	int y1 = BF_MIN(srcY + srcHeight, mImageData.mHeight);
+	if ((x1 <= x0) || (y1 <= y0))
+		return;
+	SoftCopyRect(bits + (y0 - srcY) * destPitch + (x0 - srcX), destPitch, mImageData.mBits + y0 * mImageData.mWidth + x0, mImageData.mWidth, x1 - x0, y1 - y0);
+}
+
+///
+
+SoftShaderParam::SoftShaderParam()
+{
+	mValue[0] = 0;
+	mValue[1] = 0;
+	mValue[2] = 0;
+	mValue[3] = 0;
+}
+
+void SoftShaderParam::SetFloat4(float x, float y, float z, float w)
+{
+	mValue[0] = x;
+	mValue[1] = y;
+	mValue[2] = z;
+	mValue[3] = w;
+}
+
+SoftShader::SoftShader()
+{
+	mShading = SoftShading_Textured;
+	mPosOffset = -1;
+	mTexCoordOffset = -1;
+	mColorOffset = -1;
+	mVertexSize = 0;
+	mTextureParam = NULL;
+}
+
+SoftShader::~SoftShader()
+{
+	for (auto& kv : mParams)
+		delete kv.mValue;
+}
+
+void SoftShader::InitLayout(VertexDefinition* vertexDefinition)
+{
+	if (vertexDefinition == NULL)
+	{
+		mPosOffset = offsetof(DefaultVertex3D, x);
+		mTexCoordOffset = offsetof(DefaultVertex3D, u);
+		mColorOffset = offsetof(DefaultVertex3D, color);
+		mVertexSize = sizeof(DefaultVertex3D);
+		return;
+	}
+
+	static const int formatSizes[] = {
+		4/*VertexElementFormat_Single*/,
+		8/*VertexElementFormat_Vector2*/,
+		12/*VertexElementFormat_Vector3*/,
+		16/*VertexElementFormat_Vector4*/,
+		4/*VertexElementFormat_Color*/,
+		4/*VertexElementFormat_Byte4*/,
+		4/*VertexElementFormat_Short2*/,
+		8/*VertexElementFormat_Short4*/,
+		4/*VertexElementFormat_NormalizedShort2*/,
+		8/*VertexElementFormat_NormalizedShort4*/,
+		4/*VertexElementFormat_HalfVector2*/,
+		8/*VertexElementFormat_HalfVector4*/
+	};
+
+	mVertexSize = 0;
+	for (int elementIdx = 0; elementIdx < vertexDefinition->mNumElements; elementIdx++)
+	{
+		VertexDefData* vertexDefData = &vertexDefinition->mElementData[elementIdx];
+		bool isFloat2 = (vertexDefData->mFormat >= VertexElementFormat_Vector2) && (vertexDefData->mFormat <= VertexElementFormat_Vector4);
+		if (((vertexDefData->mUsage == VertexElementUsage_Position2D) || (vertexDefData->mUsage == VertexElementUsage_Position3D)) && (isFloat2) && (mPosOffset == -1))
+			mPosOffset = mVertexSize;
+		else if ((vertexDefData->mUsage == VertexElementUsage_TextureCoordinate) && (isFloat2) && (mTexCoordOffset == -1))
+			mTexCoordOffset = mVertexSize;
+		else if ((vertexDefData->mUsage == VertexElementUsage_Color) && (vertexDefData->mFormat == VertexElementFormat_Color) && (mColorOffset == -1))
+			mColorOffset = mVertexSize;
+		mVertexSize += formatSizes[vertexDefData->mFormat];
+	}
+}
+
+ShaderParam* SoftShader::GetShaderParam(const StringImpl& name)
+{
+	SoftShaderParam** paramPtr = NULL;
+	if (mParams.TryAdd(name, NULL, &paramPtr))
+		*paramPtr = new SoftShaderParam();
+	return *paramPtr;
+}
+
+///
+
+void SoftDrawBatch::Render(RenderDevice* renderDevice, RenderWindow* renderWindow)
+{
+	if (mVtxIdx == 0)
+		return;
+
+	if ((mRenderState->mClipped) &&
+		((mRenderState->mClipRect.mWidth == 0) || (mRenderState->mClipRect.mHeight == 0)))
+		return;
+
+	if (mRenderState != renderDevice->mPhysRenderState)
+		renderDevice->PhysSetRenderState(mRenderState);
+	((SoftRenderDevice*)renderDevice)->AddTriangles(this);
+}
+
+void SoftSetTextureCmd::Render(RenderDevice* renderDevice, RenderWindow* renderWindow)
+{
+	if ((mTextureIdx >= 0) && (mTextureIdx < MAX_TEXTURES))
+		((SoftRenderDevice*)renderDevice)->mBoundTextures[mTextureIdx] = mTexture;
+}
+
+DrawBatch* SoftDrawLayer::CreateDrawBatch()
+{
+	return new SoftDrawBatch();
+}
+
+RenderCmd* SoftDrawLayer::CreateSetTextureCmd(int textureIdx, Texture* texture)
+{
+	SoftSetTextureCmd* setTextureCmd = AllocRenderCmd<SoftSetTextureCmd>();
+	setTextureCmd->mTextureIdx = textureIdx;
+	setTextureCmd->mTexture = texture;
+	return setTextureCmd;
+}
+
+void SoftDrawLayer::SetShaderConstantData(int slotIdx, void* constData, int size)
+{
+	SoftSetConstantData* setConstantData = AllocRenderCmd<SoftSetConstantData>();
+	setConstantData->mRenderState = mRenderDevice->mCurRenderState;
+	QueueRenderCmd(setConstantData);
+}
+
+///
+
+SoftRenderWindow::SoftRenderWindow(SoftRenderDevice* renderDevice, BFWindow* window, int width, int height)
+{
+	mRenderDevice = renderDevice;
+	mSoftRenderDevice = renderDevice;
+	mWindow = window;
+	mPresentCount = 0;
+	mWidth = 0;
+	mHeight = 0;
+	SetSize(width, height);
+}
+
+SoftRenderWindow::~SoftRenderWindow()
+{
+	if (mSoftRenderDevice->mTargetImage == &mImageData)
+	{
+		mSoftRenderDevice->FlushTriangles();
+		mSoftRenderDevice->mTargetImage = NULL;
+	}
+}
+
+void SoftRenderWindow::PhysSetAsTarget()
+{
+	mSoftRenderDevice->SetTargetImage(&mImageData, !mHasBeenDrawnTo);
+	mHasBeenDrawnTo = true;
+}
+
+void SoftRenderWindow::SetAsTarget()
+{
+	mHasBeenTargeted = true;
+	mRenderDevice->mCurRenderTarget = this;
+}
+
+void SoftRenderWindow::Resized()
+{
+	mRenderDevice->mResizeCount++;
+	mResizeNum = mRenderDevice->mResizeCount;
+}
+
+void SoftRenderWindow::Present()
+{
+	mSoftRenderDevice->FlushTriangles();
+	mPresentCount++;
+}
+
+void SoftRenderWindow::SetSize(int width, int height)
+{
+	width = BF_MAX(width, 1);
+	height = BF_MAX(height, 1);
+	if ((width == mWidth) && (height == mHeight))
+		return;
+
+	if (mSoftRenderDevice->mTargetImage == &mImageData)
+	{
+		mSoftRenderDevice->FlushTriangles();
+		mSoftRenderDevice->mTargetImage = NULL;
+	}
+	mWidth = width;
+	mHeight = height;
+	mImageData.CreateNew(width, height);
+	Resized();
+}
+
+///
+
+SoftRenderDevice::SoftRenderDevice()
+{
+	mTargetImage = NULL;
+	for (int texIdx = 0; texIdx < MAX_TEXTURES; texIdx++)
+		mBoundTextures[texIdx] = NULL;
+	mTilesX = 0;
+	mTilesY = 0;
+	memset(mStats, 0, sizeof(mStats));
+}
+
+SoftRenderDevice::~SoftRenderDevice()
+{
+	delete mDefaultRenderState;
+}
+
+bool SoftRenderDevice::Init(BFApp* app)
+{
+	if (mDefaultRenderState == NULL)
+	{
+		mDefaultRenderState = CreateRenderState(NULL);
+		mDefaultRenderState->mDepthFunc = DepthFunc_Less;
+		mDefaultRenderState->mWriteDepthBuffer = true;
+		mPhysRenderState = mDefaultRenderState;
+	}
+	return true;
+}
+
+void SoftRenderDevice::PhysSetRenderState(RenderState* renderState)
+{
+	mPhysRenderState = renderState;
+}
+
+void SoftRenderDevice::PhysSetRenderWindow(RenderWindow* renderWindow)
+{
+	mCurRenderTarget = renderWindow;
+	mPhysRenderWindow = renderWindow;
+	((SoftRenderWindow*)renderWindow)->PhysSetAsTarget();
+}
+
+void SoftRenderDevice::PhysSetRenderTarget(Texture* renderTarget)
+{
+	mCurRenderTarget = renderTarget;
+	renderTarget->PhysSetAsTarget();
+}
+
+void SoftRenderDevice::FrameStart()
+{
+	mCurRenderTarget = NULL;
+	mPhysRenderWindow = NULL;
+	for (auto renderWindow : mRenderWindowList)
+	{
+		renderWindow->mHasBeenDrawnTo = false;
+		renderWindow->mHasBeenTargeted = false;
+	}
+}
+
+void SoftRenderDevice::FrameEnd()
+{
+	for (auto renderWindow : mRenderWindowList)
+	{
+		if (renderWindow->mHasBeenTargeted)
+		{
+			PhysSetRenderState(mDefaultRenderState);
+			PhysSetRenderWindow(renderWindow);
+			for (auto drawLayer : renderWindow->mDrawLayerList)
+				drawLayer->Draw();
+			renderWindow->Present();
+		}
+	}
+
+	RenderDevice::FrameEnd();
+
+	for (auto renderWindow : mRenderWindowList)
+	{
+		if (renderWindow->mHasBeenTargeted)
+		{
+			for (auto drawLayer : renderWindow->mDrawLayerList)
+				drawLayer->Clear();
+		}
+	}
+}
+
+Texture* SoftRenderDevice::LoadTexture(ImageData* imageData, int flags)
+{
+	imageData->mIsAdditive = (flags & TextureFlag_Additive) != 0;
+
+	// There's no hardware to sample block-compressed data, so it's always decoded
+	if ((imageData->mHWBits != NULL) && (imageData->mBits == NULL) &&
+		(BlockCompressedSize(imageData->mHWBitsType, imageData->mWidth, imageData->mHeight) >= 0))
+	{
+		imageData->mBits = new uint32[imageData->mWidth * imageData->mHeight];
+		BlockDecompress(imageData->mHWBitsType, (uint8*)imageData->mHWBits, imageData->mWidth, imageData->mHeight, imageData->mBits);
+	}
+
+	if (((flags & TextureFlag_NoPremult) == 0) && (imageData->mBits != NULL))
+		imageData->PremultiplyAlpha();
+
+	SoftTexture* texture = (SoftTexture*)CreateDynTexture(imageData->mWidth, imageData->mHeight);
+	if (imageData->mBits != NULL)
+		memcpy(texture->mImageData.mBits, imageData->mBits, imageData->mWidth * imageData->mHeight * sizeof(uint32));
+	return texture;
+}
+
+Texture* SoftRenderDevice::CreateDynTexture(int width, int height)
+{
+	SoftTexture* texture = new SoftTexture();
+	texture->mRenderDevice = this;
+	texture->mWidth = width;
+	texture->mHeight = height;
+	texture->mImageData.CreateNew(width, height);
+	return texture;
+}
+
+Shader* SoftRenderDevice::LoadShader(const StringImpl& fileName, VertexDefinition* vertexDefinition)
+{
+	SoftShader* softShader = new SoftShader();
+	if (ToLower(fileName).IndexOf("font") != -1)
+		softShader->mShading = SoftShading_Font;
+	softShader->InitLayout(vertexDefinition);
+	softShader->Init();
+	return softShader;
+}
+
+Texture* SoftRenderDevice::CreateRenderTarget(int width, int height, bool destAlpha)
+{
+	return CreateDynTexture(width, height);
+}
+
+void SoftRenderDevice::SetRenderState(RenderState* renderState)
+{
+	mCurRenderState = renderState;
+}
+
+void SoftRenderDevice::SetTargetImage(ImageData* imageData, bool clear)
+{
+	if (imageData != mTargetImage)
+	{
+		FlushTriangles();
+		mTargetImage = imageData;
+		mTilesX = (imageData->mWidth + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+		mTilesY = (imageData->mHeight + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+		if ((int)mTileBins.size() < mTilesX * mTilesY)
+			mTileBins.Resize(mTilesX * mTilesY);
+	}
+
+	if (clear)
+	{
+		// Anything still queued would be drawn underneath the clear
+		mTriangles.Clear();
+		for (auto& tileBin : mTileBins)
+			tileBin.Clear();
+		memset(imageData->mBits, 0, imageData->mWidth * imageData->mHeight * sizeof(uint32));
+	}
+}
+
+void SoftRenderDevice::AddTriangles(DrawBatch* drawBatch)
+{
+	BP_ZONE("SoftRenderDevice::AddTriangles");
+
+	RenderState* renderState = drawBatch->mRenderState;
+	SoftShader* softShader = (SoftShader*)renderState->mShader;
+	if ((mTargetImage == NULL) || (softShader == NULL) || (softShader->mPosOffset == -1))
+		return;
+
+	int clipMinX = 0;
+	int clipMinY = 0;
+	int clipMaxX = mTargetImage->mWidth - 1;
+	int clipMaxY = mTargetImage->mHeight - 1;
+	if (renderState->mClipped)
+	{
+		// Truncated the same way as the hardware scissor rects
+		clipMinX = BF_MAX(clipMinX, (int)renderState->mClipRect.mX);
+		clipMinY = BF_MAX(clipMinY, (int)renderState->mClipRect.mY);
+		clipMaxX = BF_MIN(clipMaxX, (int)(renderState->mClipRect.mX + renderState->mClipRect.mWidth) - 1);
+		clipMaxY = BF_MIN(clipMaxY, (int)(renderState->mClipRect.mY + renderState->mClipRect.mHeight) - 1);
+	}
+	if ((clipMaxX < clipMinX) || (clipMaxY < clipMinY))
+		return;
+
+	SoftTexture* softTexture = (SoftTexture*)mBoundTextures[0];
+	ImageData* texture = NULL;
+	if ((softTexture != NULL) && (softTexture->mImageData.mBits != NULL) && (softTexture->mImageData.mWidth > 0) && (softTexture->mImageData.mHeight > 0))
+		texture = &softTexture->mImageData;
+	bool hasTexCoords = (texture != NULL) && (softShader->mTexCoordOffset != -1);
+
+	uint8* vertices = (uint8*)drawBatch->mVertices;
+	int vtxSize = drawBatch->mVtxSize;
+	for (int idxIdx = 0; idxIdx + 2 < drawBatch->mIdxIdx; idxIdx += 3)
+	{
+		if ((int)mTriangles.size() >= SOFT_MAX_QUEUED_TRIANGLES)
+			FlushTriangles();
+
+		float pos[3][2];
+		float attribs[3][6];
+		uint32 colors[3];
+		bool inRange = true;
+		for (int i = 0; i < 3; i++)
+		{
+			uint8* vtx = vertices + drawBatch->mIndices[idxIdx + i] * vtxSize;
+			float* vtxPos = (float*)(vtx + softShader->mPosOffset);
+			pos[i][0] = vtxPos[0];
+			pos[i][1] = vtxPos[1];
+			if (!((fabsf(pos[i][0]) < SOFT_MAX_COORD) && (fabsf(pos[i][1]) < SOFT_MAX_COORD)))
+				inRange = false;
+
+			attribs[i][0] = 0;
+			attribs[i][1] = 0;
+			if (hasTexCoords)
+			{
+				float* texCoords = (float*)(vtx + softShader->mTexCoordOffset);
+				attribs[i][0] = texCoords[0] * texture->mWidth - 0.5f;
+				attribs[i][1] = texCoords[1] * texture->mHeight - 0.5f;
+			}
+
+			// Vertex colors are 0xAARRGGBB, and premultiplied here like the Std.fx vertex shader does
+			colors[i] = (softShader->mColorOffset != -1) ? *(uint32*)(vtx + softShader->mColorOffset) : 0xFFFFFFFF;
+			float alpha = (float)(colors[i] >> 24);
+			attribs[i][2] = (float)((colors[i] >> 16) & 0xFF) * alpha / 255.0f;
+			attribs[i][3] = (float)((colors[i] >> 8) & 0xFF) * alpha / 255.0f;
+			attribs[i][4] = (float)(colors[i] & 0xFF) * alpha / 255.0f;
+			attribs[i][5] = alpha;
+		}
+		if (!inRange)
+			continue;
+
+		int64 fixedX[3];
+		int64 fixedY[3];
+		for (int i = 0; i < 3; i++)
+		{
+			fixedX[i] = (int64)floorf(pos[i][0] * SOFT_SUBPIXEL_SCALE + 0.5f);
+			fixedY[i] = (int64)floorf(pos[i][1] * SOFT_SUBPIXEL_SCALE + 0.5f);
+		}
+
+		// Nothing is culled, so triangles wound the other way are flipped to keep insides positive
+		int64 area = (fixedX[1] - fixedX[0]) * (fixedY[2] - fixedY[0]) - (fixedY[1] - fixedY[0]) * (fixedX[2] - fixedX[0]);
+		if (area == 0)
+			continue;
+		int order[3] = { 0, 1, 2 };
+		if (area < 0)
+		{
+			order[1] = 2;
+			order[2] = 1;
+			area = -area;
+		}
+
+		int64 minFixedX = BF_MIN(BF_MIN(fixedX[0], fixedX[1]), fixedX[2]);
+		int64 minFixedY = BF_MIN(BF_MIN(fixedY[0], fixedY[1]), fixedY[2]);
+		int64 maxFixedX = BF_MAX(BF_MAX(fixedX[0], fixedX[1]), fixedX[2]);
+		int64 maxFixedY = BF_MAX(BF_MAX(fixedY[0], fixedY[1]), fixedY[2]);
+		// Pixels whose centers fall inside the bounds
+		const int64 half = SOFT_SUBPIXEL_SCALE / 2;
+		int minX = (int)((minFixedX - half + SOFT_SUBPIXEL_SCALE * 65536 + SOFT_SUBPIXEL_SCALE - 1) / SOFT_SUBPIXEL_SCALE) - 65536;
+		int minY = (int)((minFixedY - half + SOFT_SUBPIXEL_SCALE * 65536 + SOFT_SUBPIXEL_SCALE - 1) / SOFT_SUBPIXEL_SCALE) - 65536;
+		int maxX = (int)((maxFixedX - half + SOFT_SUBPIXEL_SCALE * 65536) / SOFT_SUBPIXEL_SCALE) - 65536;
+		int maxY = (int)((maxFixedY - half + SOFT_SUBPIXEL_SCALE * 65536) / SOFT_SUBPIXEL_SCALE) - 65536;
+		minX = BF_MAX(minX, clipMinX);
+		minY = BF_MAX(minY, clipMinY);
+		maxX = BF_MIN(maxX, clipMaxX);
+		maxY = BF_MIN(maxY, clipMaxY);
+		if ((maxX < minX) || (maxY < minY))
+			continue;
+
+		mTriangles.Add(SoftTriangle());
+		SoftTriangle& tri = mTriangles.back();
+		tri.mMinX = minX;
+		tri.mMinY = minY;
+		tri.mMaxX = maxX;
+		tri.mMaxY = maxY;
+		tri.mTexture = texture;
+		tri.mShading = softShader->mShading;
+		tri.mFlatColor = (colors[0] == colors[1]) && (colors[1] == colors[2]);
+
+		for (int edgeIdx = 0; edgeIdx < 3; edgeIdx++)
+		{
+			int a = order[edgeIdx];
+			int b = order[(edgeIdx + 1) % 3];
+			int64 edgeA = fixedY[a] - fixedY[b];
+			int64 edgeB = fixedX[b] - fixedX[a];
+			tri.mEdgeA[edgeIdx] = edgeA;
+			tri.mEdgeB[edgeIdx] = edgeB;
+			tri.mEdgeC[edgeIdx] = -edgeA * fixedX[a] - edgeB * fixedY[a];
+			// Top-left fill rule: pixel centers exactly on any other edge belong to the neighboring triangle
+			bool isTopLeft = (edgeA > 0) || ((edgeA == 0) && (edgeB > 0));
+			if (!isTopLeft)
+				tri.mEdgeC[edgeIdx]--;
+		}
+
+		// Attribute planes over pixel coordinates, taken from the snapped positions
+		double x0 = (double)fixedX[0] / SOFT_SUBPIXEL_SCALE;
+		double y0 = (double)fixedY[0] / SOFT_SUBPIXEL_SCALE;
+		double dx1 = (double)fixedX[1] / SOFT_SUBPIXEL_SCALE - x0;
+		double dy1 = (double)fixedY[1] / SOFT_SUBPIXEL_SCALE - y0;
+		double dx2 = (double)fixedX[2] / SOFT_SUBPIXEL_SCALE - x0;
+		double dy2 = (double)fixedY[2] / SOFT_SUBPIXEL_SCALE - y0;
+		double signedArea = dx1 * dy2 - dy1 * dx2;
+		for (int attribIdx = 0; attribIdx < 6; attribIdx++)
+		{
+			double f0 = attribs[0][attribIdx];
+			double df1 = attribs[1][attribIdx] - f0;
+			double df2 = attribs[2][attribIdx] - f0;
+			double ddx = (df1 * dy2 - df2 * dy1) / signedArea;
+			double ddy = (df2 * dx1 - df1 * dx2) / signedArea;
+			tri.mAttribs[attribIdx][0] = (float)(f0 - ddx * x0 - ddy * y0);
+			tri.mAttribs[attribIdx][1] = (float)ddx;
+			tri.mAttribs[attribIdx][2] = (float)ddy;
+		}
+		if (tri.mFlatColor)
+		{
+			for (int attribIdx = 2; attribIdx < 6; attribIdx++)
+			{
+				tri.mAttribs[attribIdx][0] = attribs[0][attribIdx];
+				tri.mAttribs[attribIdx][1] = 0;
+				tri.mAttribs[attribIdx][2] = 0;
+			}
+		}
+
+		int triIdx = (int)mTriangles.size() - 1;
+		for (int tileY = minY / SOFT_TILE_SIZE; tileY <= maxY / SOFT_TILE_SIZE; tileY++)
+		{
+			for (int tileX = minX / SOFT_TILE_SIZE; tileX <= maxX / SOFT_TILE_SIZE; tileX++)
+			{
+				mTileBins[tileY * mTilesX + tileX].Add(triIdx);
+				mStats[SoftStat_TileBins]++;
+			}
+		}
+		mStats[SoftStat_Triangles]++;
+	}
+}
+
+static inline int64 SoftFloorDiv(int64 num, int64 denom)
+{
+	return (num >= 0) ? (num / denom) : -((-num + denom - 1) / denom);
+}
+
+static inline uint32 SoftBlend(uint32 dest, uint32 src)
+{
+	// Premultiplied blend, saturating for additive textures whose alpha was zeroed
+	int invAlpha = 255 - (int)(src >> 24);
+	uint32 rb = SoftMul255Packed(dest & 0x00FF00FF, invAlpha) + (src & 0x00FF00FF);
+	uint32 ag = SoftMul255Packed((dest >> 8) & 0x00FF00FF, invAlpha) + ((src >> 8) & 0x00FF00FF);
+	rb = (rb | (((rb >> 8) & 0x00010001) * 0xFF)) & 0x00FF00FF;
+	ag = (ag | (((ag >> 8) & 0x00010001) * 0xFF)) & 0x00FF00FF;
+	return rb | (ag << 8);
+}
+
+// Fills one row span of a triangle. Specialized on whether there's a texture, whether the vertex colors differ, and the
+//  shading, so the common cases don't carry the others' per-pixel work
+template <bool THasTexture, bool TFlatColor, bool TIsFont>
+static void SoftShadeSpan(const SoftTriangle& tri, ImageData* texture, uint32* dest, int count, float px, float py, uint32 flatColor)
+{
+	float s = tri.mAttribs[0][0] + tri.mAttribs[0][1] * px + tri.mAttribs[0][2] * py;
+	float t = tri.mAttribs[1][0] + tri.mAttribs[1][1] * px + tri.mAttribs[1][2] * py;
+	float colorAttribs[4];
+	if (!TFlatColor)
+	{
+		for (int attribIdx = 0; attribIdx < 4; attribIdx++)
+			colorAttribs[attribIdx] = tri.mAttribs[attribIdx + 2][0] + tri.mAttribs[attribIdx + 2][1] * px + tri.mAttribs[attribIdx + 2][2] * py;
+	}
+	bool isWhite = (TFlatColor) && (flatColor == 0xFFFFFFFF);
+	int r = flatColor & 0xFF;
+	int g = (flatColor >> 8) & 0xFF;
+	int b = (flatColor >> 16) & 0xFF;
+	int a = flatColor >> 24;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!TFlatColor)
+		{
+			r = BF_CLAMP((int)(colorAttribs[0] + 0.5f), 0, 255);
+			g = BF_CLAMP((int)(colorAttribs[1] + 0.5f), 0, 255);
+			b = BF_CLAMP((int)(colorAttribs[2] + 0.5f), 0, 255);
+			a = BF_CLAMP((int)(colorAttribs[3] + 0.5f), 0, 255);
+			for (int attribIdx = 0; attribIdx < 4; attribIdx++)
+				colorAttribs[attribIdx] += tri.mAttribs[attribIdx + 2][1];
+		}
+
+		uint32 src;
+		if (!THasTexture)
+			src = (uint32)r | ((uint32)g << 8) | ((uint32)b << 16) | ((uint32)a << 24);
+		else
+		{
+			uint32 texel = SoftSampleBilinear(texture, s, t);
+			s += tri.mAttribs[0][1];
+			t += tri.mAttribs[1][1];
+			if (TIsFont)
+			{
+				// Coverage comes from alpha for grayscale text and from red for colored text
+				int grey = (r * 77 + g * 150 + b * 29) >> 8;
+				int coverage = SoftMul255(texel >> 24, 255 - grey) + SoftMul255(texel & 0xFF, grey);
+				src = (uint32)SoftMul255(coverage, r) | ((uint32)SoftMul255(coverage, g) << 8) |
+					((uint32)SoftMul255(coverage, b) << 16) | ((uint32)SoftMul255(coverage, a) << 24);
+			}
+			else if (isWhite)
+				src = texel;
+			else
+			{
+				src = (uint32)SoftMul255(texel & 0xFF, r) | ((uint32)SoftMul255((texel >> 8) & 0xFF, g) << 8) |
+					((uint32)SoftMul255((texel >> 16) & 0xFF, b) << 16) | ((uint32)SoftMul255(texel >> 24, a) << 24);
+			}
+		}
+
+		if ((src >> 24) == 0xFF)
+			dest[i] = src;
+		else if (src != 0)
+			dest[i] = SoftBlend(dest[i], src);
+	}
+}
+
+void SoftRenderDevice::RasterTile(int tileIdx)
+{
+	Array<int>& tileBin = mTileBins[tileIdx];
+	if (tileBin.IsEmpty())
+		return;
+
+	int targetWidth = mTargetImage->mWidth;
+	int tileMinX = (tileIdx % mTilesX) * SOFT_TILE_SIZE;
+	int tileMinY = (tileIdx / mTilesX) * SOFT_TILE_SIZE;
+	int tileMaxX = BF_MIN(tileMinX + SOFT_TILE_SIZE, targetWidth) - 1;
+	int tileMaxY = BF_MIN(tileMinY + SOFT_TILE_SIZE, mTargetImage->mHeight) - 1;
+
+	for (int triIdx : tileBin)
+	{
+		SoftTriangle& tri = mTriangles[triIdx];
+		int minX = BF_MAX(tri.mMinX, tileMinX);
+		int minY = BF_MAX(tri.mMinY, tileMinY);
+		int maxX = BF_MIN(tri.mMaxX, tileMaxX);
+		int maxY = BF_MIN(tri.mMaxY, tileMaxY);
+
+		ImageData* texture = tri.mTexture;
+		uint32 flatColor = 0;
+		if (tri.mFlatColor)
+		{
+			flatColor = (uint32)(tri.mAttribs[2][0] + 0.5f) | ((uint32)(tri.mAttribs[3][0] + 0.5f) << 8) |
+				((uint32)(tri.mAttribs[4][0] + 0.5f) << 16) | ((uint32)(tri.mAttribs[5][0] + 0.5f) << 24);
+		}
+		auto shadeSpan = &SoftShadeSpan<false, false, false>;
+		if (texture == NULL)
+			shadeSpan = tri.mFlatColor ? &SoftShadeSpan<false, true, false> : &SoftShadeSpan<false, false, false>;
+		else if (tri.mShading == SoftShading_Font)
+			shadeSpan = tri.mFlatColor ? &SoftShadeSpan<true, true, true> : &SoftShadeSpan<true, false, true>;
+		else
+			shadeSpan = tri.mFlatColor ? &SoftShadeSpan<true, true, false> : &SoftShadeSpan<true, false, false>;
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			// Solve each edge for the pixels whose centers are on its inside, so spans need no per-pixel tests
+			int64 centerY = (int64)y * SOFT_SUBPIXEL_SCALE + SOFT_SUBPIXEL_SCALE / 2;
+			int spanMinX = minX;
+			int spanMaxX = maxX;
+			for (int edgeIdx = 0; edgeIdx < 3; edgeIdx++)
+			{
+				int64 edgeA = tri.mEdgeA[edgeIdx];
+				int64 rowValue = tri.mEdgeB[edgeIdx] * centerY + tri.mEdgeC[edgeIdx] + edgeA * (SOFT_SUBPIXEL_SCALE / 2);
+				if (edgeA > 0)
+					spanMinX = (int)BF_MAX((int64)spanMinX, -SoftFloorDiv(rowValue, edgeA * SOFT_SUBPIXEL_SCALE));
+				else if (edgeA < 0)
+					spanMaxX = (int)BF_MIN((int64)spanMaxX, SoftFloorDiv(rowValue, -edgeA * SOFT_SUBPIXEL_SCALE));
+				else if (rowValue < 0)
+					spanMaxX = spanMinX - 1;
+			}
+			if (spanMaxX < spanMinX)
+				continue;
+
+			uint32* dest = mTargetImage->mBits + y * targetWidth + spanMinX;
+			shadeSpan(tri, texture, dest, spanMaxX - spanMinX + 1, spanMinX + 0.5f, y + 0.5f, flatColor);
+		}
+	}
+	tileBin.Clear();
+}
+
+void SoftRenderDevice::FlushTriangles()
+{
+	if (mTriangles.IsEmpty())
+		return;
+
+	BP_ZONE("SoftRenderDevice::FlushTriangles");
+	uint64 startTick = BFGetTickCountMicro();
+	if (mTargetImage != NULL)
+	{
+		ImageParallelRows(mTilesX * mTilesY, SOFT_TILE_SIZE * SOFT_TILE_SIZE, [&](int startTile, int endTile)
+		{
+			for (int tileIdx = startTile; tileIdx < endTile; tileIdx++)
+				RasterTile(tileIdx);
+		});
+	}
+	mTriangles.Clear();
+	mStats[SoftStat_Flushes]++;
+	mStats[SoftStat_RasterMicros] += (int64)(BFGetTickCountMicro() - startTick);
+}
+
+//
+
+namespace
+{
+	// Textures stand in for the recorded ones, patterned and partly transparent so blending and filtering get exercised
+	class SoftStreamPlayer : public DrawStreamPlayer
+	{
+	public:
+		SoftRenderDevice* mRenderDevice;
+		Dictionary<int, Texture*> mTextures;
+
+	public:
+		virtual Shader* CreateShader(int vertexSize) override
+		{
+			SoftShader* softShader = new SoftShader();
+			if (vertexSize >= (int)sizeof(DefaultVertex3D))
+				softShader->InitLayout(NULL);
+			else
+				softShader->mPosOffset = 0;
+			return softShader;
+		}
+
+		virtual Texture* GetTexture(int textureId) override
+		{
+			Texture** texturePtr = NULL;
+			if (mTextures.TryAdd(textureId, NULL, &texturePtr))
+			{
+				ImageData imageData;
+				imageData.CreateNew(64, 64);
+				uint32 tint = (uint32)Hash64((uint64)textureId, 0x5EED);
+				for (int y = 0; y < 64; y++)
+				{
+					for (int x = 0; x < 64; x++)
+					{
+						uint32 alpha = (((x >> 3) ^ (y >> 3)) & 1) ? 0xFF : (uint32)(0x40 + x * 2);
+						imageData.mBits[y * 64 + x] = ((tint & 0x00FFFFFF) ^ (uint32)(x * 4 + (y * 4 << 8))) | (alpha << 24);
+					}
+				}
+				*texturePtr = mRenderDevice->LoadTexture(&imageData, 0);
+			}
+			return *texturePtr;
+		}
+
+		virtual void FillVertex(void* vertex, int vertexSize, int cornerIdx, int drawIdx) override
+		{
+			DrawStreamPlayer::FillVertex(vertex, vertexSize, cornerIdx, drawIdx);
+			if (vertexSize < (int)sizeof(DefaultVertex3D))
+				return;
+			DefaultVertex3D* defaultVertex = (DefaultVertex3D*)vertex;
+			defaultVertex->u = (cornerIdx & 1) ? 1.0f : 0.0f;
+			defaultVertex->v = (cornerIdx & 2) ? 1.0f : 0.0f;
+			defaultVertex->color = ((uint32)Hash64((uint64)drawIdx, cornerIdx) & 0x00FFFFFF) | 0xC0000000;
+		}
+	};
+}
+
+// Replays a stream written by DrawLayer_RecordStream through the software device into a window-sized image, once on
+//  the calling thread and once on the worker pool. The first untimed pass checks that both produce the same frames.
+//  Reports frame times along with draw and rasterizer counters, and optionally saves the last frame as a PNG.
+BF_EXPORT int BF_CALLTYPE SoftRenderDevice_RunStreamBenchmark(const char* fileName, int passCount, const char* outFileName)
+{
+	SoftStreamPlayer player;
+	if (!player.Load(fileName))
+		return -1;
+	int numFrames = player.mNumFrames;
+	if (numFrames == 0)
+		return -1;
+
+	SoftRenderDevice* renderDevice = new SoftRenderDevice();
+	renderDevice->Init(NULL);
+	player.mRenderDevice = renderDevice;
+
+	int width = (player.mMaxX > 0) ? BF_CLAMP((int)ceilf(player.mMaxX), 1, 8192) : 1;
+	int height = (player.mMaxY > 0) ? BF_CLAMP((int)ceilf(player.mMaxY), 1, 8192) : 1;
+	SoftRenderWindow* renderWindow = new SoftRenderWindow(renderDevice, NULL, width, height);
+	renderDevice->AddRenderWindow(renderWindow);
+	SoftDrawLayer* drawLayer = new SoftDrawLayer();
+	drawLayer->mRenderDevice = renderDevice;
+	drawLayer->mRenderWindow = renderWindow;
+	renderWindow->mDrawLayerList.Add(drawLayer);
+	drawLayer->Clear();
+
+	int prevImageProcessFlags = gImageProcessFlags;
+
+	const char* modeNames[2] = { "1 thread", "Threaded" };
+	int64 elapsedMicros[2] = { 0, 0 };
+	int64 maxFrameMicros[2] = { 0, 0 };
+	int64 rasterMicros[2] = { 0, 0 };
+	int64 counters[DrawCounter_COUNT] = { 0 };
+	int64 stats[SoftStat_COUNT] = { 0 };
+	Array<uint64> frameHashes;
+	int mismatchedFrames = 0;
+	for (int passIdx = -1; passIdx < BF_MAX(passCount, 1); passIdx++)
+	{
+		bool verify = passIdx < 0;
+		for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+		{
+			gImageProcessFlags = (prevImageProcessFlags & ~ImageProcessFlag_NoThreads) | ((modeIdx == 0) ? ImageProcessFlag_NoThreads : 0);
+			renderDevice->mCurRenderState = NULL;
+			renderDevice->mPhysRenderState = NULL;
+			for (int texIdx = 0; texIdx < MAX_TEXTURES; texIdx++)
+				renderDevice->mBoundTextures[texIdx] = NULL;
+			drawLayer->Clear();
+			player.Rewind();
+
+			int frameIdx = 0;
+			while (true)
+			{
+				int64 prevRasterMicros = renderDevice->mStats[SoftStat_RasterMicros];
+				int64 prevStats[SoftStat_COUNT];
+				memcpy(prevStats, renderDevice->mStats, sizeof(prevStats));
+
+				uint64 startTick = BFGetTickCountMicro();
+				renderDevice->FrameStart();
+				renderWindow->SetAsTarget();
+				if (!player.PlayFrame(drawLayer))
+					break;
+				renderDevice->FrameEnd();
+				int64 frameMicros = (int64)(BFGetTickCountMicro() - startTick);
+
+				if (verify)
+				{
+					uint64 hash = Hash64(renderWindow->mImageData.mBits, width * height * sizeof(uint32));
+					if (modeIdx == 0)
+						frameHashes.Add(hash);
+					else if (frameHashes[frameIdx] != hash)
+						mismatchedFrames++;
+				}
+				else
+				{
+					elapsedMicros[modeIdx] += frameMicros;
+					maxFrameMicros[modeIdx] = BF_MAX(maxFrameMicros[modeIdx], frameMicros);
+					rasterMicros[modeIdx] += renderDevice->mStats[SoftStat_RasterMicros] - prevRasterMicros;
+					if (modeIdx == 1)
+					{
+						for (int counterIdx = 0; counterIdx < DrawCounter_COUNT; counterIdx++)
+							counters[counterIdx] += renderDevice->mPrevDrawCounters[counterIdx];
+						for (int statIdx = 0; statIdx < SoftStat_COUNT; statIdx++)
+							stats[statIdx] += renderDevice->mStats[statIdx] - prevStats[statIdx];
+					}
+				}
+				frameIdx++;
+			}
+
+			if ((verify) && (modeIdx == 1) && (outFileName != NULL) && (outFileName[0] != 0))
+			{
+				PNGData pngData;
+				pngData.CreateNew(width, height);
+				memcpy(pngData.mBits, renderWindow->mImageData.mBits, width * height * sizeof(uint32));
+				pngData.WriteToFile(outFileName);
+			}
+		}
+	}
+
+	gImageProcessFlags = prevImageProcessFlags;
+
+	int64 frameCount = (int64)numFrames * BF_MAX(passCount, 1);
+	OutputDebugStrF("Soft render %dx%d %d frames  %lld batches/frame %lld textures/frame %lld vertices/frame %lld triangles/frame %lld tile bins/frame %lld flushes/frame\n",
+		width, height, numFrames, (long long)(counters[DrawCounter_BatchesDrawn] / frameCount), (long long)(counters[DrawCounter_SetTextureCmds] / frameCount),
+		(long long)(counters[DrawCounter_Vertices] / frameCount), (long long)(stats[SoftStat_Triangles] / frameCount),
+		(long long)(stats[SoftStat_TileBins] / frameCount), (long long)(stats[SoftStat_Flushes] / frameCount));
+	for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+	{
+		OutputDebugStrF("  %s: %lld us/frame (%lld us raster) %lld us worst\n", modeNames[modeIdx],
+			(long long)(elapsedMicros[modeIdx] / frameCount), (long long)(rasterMicros[modeIdx] / frameCount), (long long)maxFrameMicros[modeIdx]);
+	}
+	OutputDebugStrF("  Mismatched frames: %d\n", mismatchedFrames);
+
+	renderDevice->RemoveRenderWindow(renderWindow);
+	delete renderWindow;
+	for (auto& kv : player.mTextures)
+		delete kv.mValue;
+	delete renderDevice;
+	return (int)(elapsedMicros[1] / frameCount);
+}
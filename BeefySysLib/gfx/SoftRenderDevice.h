@@ -0,0 +1,196 @@
+#pragma once
+
+#include "Common.h"
+#include "gfx/Shader.h"
+#include "gfx/Texture.h"
+#include "gfx/RenderDevice.h"
+#include "gfx/DrawLayer.h"
+#include "img/ImageData.h"
+
+NS_BF_BEGIN;
+
+class BFApp;
+class SoftRenderDevice;
+
+// Software rendering for machines without a GPU. Draws are set up into screen-space triangles as the draw layers
+//  render, and rasterized when the target changes or is presented: the target is split into tiles, every triangle is
+//  binned to the tiles it touches, and tiles are filled in parallel on the shared worker pool, each one in submission
+//  order so the result never depends on the thread count. Pixels get the standard 2D shading, which is the bilinear
+//  texture sample times the vertex color, blended as premultiplied alpha. Depth is neither tested nor written.
+
+const int SOFT_TILE_SIZE = 64;
+
+class SoftTexture : public Texture
+{
+public:
+	SoftRenderDevice*		mRenderDevice;
+	// Premultiplied R, G, B, A pixels, the same layout as ImageData::mBits
+	ImageData				mImageData;
+
+public:
+	SoftTexture();
+	~SoftTexture();
+
+	virtual void			PhysSetAsTarget() override;
+	virtual void			Blt(ImageData* imageData, int x, int y) override;
+	virtual void			SetBits(int destX, int destY, int destWidth, int destHeight, int srcPitch, uint32* bits) override;
+	virtual void			GetBits(int srcX, int srcY, int srcWidth, int srcHeight, int destPitch, uint32* bits) override;
+};
+
+class SoftShaderParam : public ShaderParam
+{
+public:
+	float					mValue[4];
+
+public:
+	SoftShaderParam();
+
+	virtual void			SetTexture(Texture* texture) override {}
+	virtual void			SetFloat4(float x, float y, float z, float w) override;
+};
+
+enum SoftShading
+{
+	// Texture sample times vertex color, as Std.fx
+	SoftShading_Textured,
+	// Glyph coverage times vertex color, as Std_font.fx
+	SoftShading_Font
+};
+
+class SoftShader : public Shader
+{
+public:
+	SoftShading				mShading;
+	// Byte offsets of the window-space position, texture coordinates and color in a vertex, or -1 when not present
+	int						mPosOffset;
+	int						mTexCoordOffset;
+	int						mColorOffset;
+	Dictionary<String, SoftShaderParam*> mParams;
+
+public:
+	SoftShader();
+	~SoftShader();
+
+	void					InitLayout(VertexDefinition* vertexDefinition);
+	virtual ShaderParam*	GetShaderParam(const StringImpl& name) override;
+};
+
+class SoftDrawBatch : public DrawBatch
+{
+public:
+	virtual void			Render(RenderDevice* renderDevice, RenderWindow* renderWindow) override;
+};
+
+class SoftSetTextureCmd : public SetTextureCmd
+{
+public:
+	virtual void			Render(RenderDevice* renderDevice, RenderWindow* renderWindow) override;
+};
+
+// Constant data only feeds shader programs, which the rasterizer doesn't run, but it's still queued so batches break
+//  and merge around it the same way as on the hardware devices
+class SoftSetConstantData : public RenderCmd
+{
+public:
+	virtual void			Render(RenderDevice* renderDevice, RenderWindow* renderWindow) override {}
+};
+
+class SoftDrawLayer : public DrawLayer
+{
+public:
+	virtual DrawBatch*		CreateDrawBatch() override;
+	virtual RenderCmd*		CreateSetTextureCmd(int textureIdx, Texture* texture) override;
+	virtual void			SetShaderConstantData(int slotIdx, void* constData, int size) override;
+};
+
+class SoftRenderWindow : public RenderWindow
+{
+public:
+	SoftRenderDevice*		mSoftRenderDevice;
+	// The presented frame, in the same layout as SoftTexture::mImageData
+	ImageData				mImageData;
+	int						mPresentCount;
+
+public:
+	virtual void			PhysSetAsTarget();
+
+public:
+	SoftRenderWindow(SoftRenderDevice* renderDevice, BFWindow* window, int width, int height);
+	~SoftRenderWindow();
+
+	void					SetAsTarget() override;
+	void					Resized() override;
+	virtual void			Present() override;
+	void					SetSize(int width, int height);
+};
+
+// A triangle ready to rasterize. Edges are in 1/16 pixel fixed point, attributes are planes over pixel centers.
+struct SoftTriangle
+{
+	int64					mEdgeA[3];
+	int64					mEdgeB[3];
+	int64					mEdgeC[3];
+	// Pixel bounds, inclusive, already clipped to the target and clip rect
+	int						mMinX;
+	int						mMinY;
+	int						mMaxX;
+	int						mMaxY;
+	// u, v, r, g, b, a. Colors are premultiplied and scaled to 0..255
+	float					mAttribs[6][3];
+	ImageData*				mTexture;
+	SoftShading				mShading;
+	bool					mFlatColor;
+};
+
+enum SoftStat
+{
+	SoftStat_Triangles,
+	SoftStat_TileBins,
+	SoftStat_Flushes,
+	SoftStat_RasterMicros,
+
+	SoftStat_COUNT
+};
+
+class SoftRenderDevice : public RenderDevice
+{
+public:
+	ImageData*				mTargetImage;
+	Texture*				mBoundTextures[MAX_TEXTURES];
+
+	// Triangles set up since the last flush, and the indices of the ones touching each tile of the target
+	Array<SoftTriangle>		mTriangles;
+	Array<Array<int>>		mTileBins;
+	int						mTilesX;
+	int						mTilesY;
+
+	int64					mStats[SoftStat_COUNT];
+
+public:
+	virtual void			PhysSetRenderState(RenderState* renderState) override;
+	virtual void			PhysSetRenderWindow(RenderWindow* renderWindow);
+	virtual void			PhysSetRenderTarget(Texture* renderTarget) override;
+
+public:
+	SoftRenderDevice();
+	virtual ~SoftRenderDevice();
+	bool					Init(BFApp* app) override;
+
+	void					FrameStart() override;
+	void					FrameEnd() override;
+
+	Texture*				LoadTexture(ImageData* imageData, int flags) override;
+	Texture*				CreateDynTexture(int width, int height) override;
+	Shader*					LoadShader(const StringImpl& fileName, VertexDefinition* vertexDefinition) override;
+	Texture*				CreateRenderTarget(int width, int height, bool destAlpha) override;
+
+	void					SetRenderState(RenderState* renderState) override;
+
+	void					SetTargetImage(ImageData* imageData, bool clear);
+	void					AddTriangles(DrawBatch* drawBatch);
+	void					RasterTile(int tileIdx);
+	// Rasterizes everything queued for the current target
+	void					FlushTriangles();
+};
+
+NS_BF_END;
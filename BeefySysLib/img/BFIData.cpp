@@ -1,8 +1,174 @@
 #include "BFIData.h"
 #include "ImageUtils.h"
+#include "BlockCompress.h"
+#include "TGAData.h"
+#include "PNGData.h"
+#include "JPEGData.h"
 
 USING_NS_BF;
 
+#define BF_BFI_ID 0xBEEF0B1F
+#define BF_BFI_VERSION 1
+
+enum BFIFlags
+{
+	BFIFlag_None = 0,
+	BFIFlag_AlphaPremultiplied = 1,
+	BFIFlag_Additive = 2
+};
+
+struct BFIHeader
+{
+	uint32 mId;
+	int32 mVersion;
+	int32 mHWBitsType;
+	int32 mWidth;
+	int32 mHeight;
+	int32 mFlags;
+	int64 mCheckFileTime;
+	int32 mDataSize;
+	int32 mPad;
+};
+
+BFIData::BFIData()
+{
+	mCheckFileTime = 0;
+}
+
+bool BFIData::ReadData()
+{
+	if ((mSrcData == NULL) || (mSrcDataLen < (int)sizeof(BFIHeader)))
+		return false;
+	BFIHeader* header = (BFIHeader*)mSrcData;
+	if ((header->mId != BF_BFI_ID) || (header->mVersion != BF_BFI_VERSION) || (header->mWidth <= 0) || (header->mHeight <= 0) ||
+		(header->mDataSize != BlockCompressedSize(header->mHWBitsType, header->mWidth, header->mHeight)) ||
+		(header->mDataSize > mSrcDataLen - (int)sizeof(BFIHeader)))
+		return false;
+
+	mWidth = header->mWidth;
+	mHeight = header->mHeight;
+	mHWBitsType = header->mHWBitsType;
+	mHWBits = mSrcData + sizeof(BFIHeader);
+	mHWBitsLength = header->mDataSize;
+	mAlphaPremultiplied = (header->mFlags & BFIFlag_AlphaPremultiplied) != 0;
+	mIsAdditive = (header->mFlags & BFIFlag_Additive) != 0;
+	mCheckFileTime = header->mCheckFileTime;
+	mKeepSrcDataValid = true;
+	return true;
+}
+
+bool BFIData::Create(ImageData* source, int hwBitsType)
+{
+	int dataSize = BlockCompressedSize(hwBitsType, source->mWidth, source->mHeight);
+	if ((dataSize < 0) || (source->mBits == NULL))
+		return false;
+
+	delete [] mSrcData;
+	mSrcDataLen = (int)sizeof(BFIHeader) + dataSize;
+	mSrcData = new uint8[mSrcDataLen];
+	mOwnsSrcData = true;
+	mKeepSrcDataValid = true;
+
+	BFIHeader* header = (BFIHeader*)mSrcData;
+	memset(header, 0, sizeof(BFIHeader));
+	header->mId = BF_BFI_ID;
+	header->mVersion = BF_BFI_VERSION;
+	header->mHWBitsType = hwBitsType;
+	header->mWidth = source->mWidth;
+	header->mHeight = source->mHeight;
+	header->mFlags = source->mAlphaPremultiplied ? BFIFlag_AlphaPremultiplied : BFIFlag_None;
+	if (source->mIsAdditive)
+		header->mFlags |= BFIFlag_Additive;
+	header->mCheckFileTime = mCheckFileTime;
+	header->mDataSize = dataSize;
+	BlockCompress(hwBitsType, source->mBits, source->mWidth, source->mHeight, mSrcData + sizeof(BFIHeader));
+
+	return ReadData();
+}
+
+bool BFIData::WriteToFile(const StringImpl& path)
+{
+	if (mSrcData == NULL)
+		return false;
+	FILE* fp = fopen(path.c_str(), "wb");
+	if (fp == NULL)
+		return false;
+	bool success = fwrite(mSrcData, 1, mSrcDataLen, fp) == (size_t)mSrcDataLen;
+	fclose(fp);
+	return success;
+}
+
+bool BFIData::Decompress()
+{
+	if (mHWBits == NULL)
+		return false;
+	if (mBits == NULL)
+		mBits = new uint32[mWidth * mHeight];
+	return BlockDecompress(mHWBitsType, (uint8*)mHWBits, mWidth, mHeight, mBits);
+}
+
+ImageData* BFIData::LoadSourceImage(const StringImpl& path)
+{
+	int dotPos = (int)path.LastIndexOf('.');
+	String ext;
+	if (dotPos != -1)
+		ext = path.Substring(dotPos);
+
+	ImageData* imageData = NULL;
+	if (ext == ".tga")
+		imageData = new TGAData();
+	else if (ext == ".png")
+		imageData = new PNGData();
+	else if (ext == ".jpg")
+		imageData = new JPEGData();
+	else
+		return NULL;
+
+	// Premultiplication is left to the caller so it's done once, before encoding
+	imageData->mWantsAlphaPremultiplied = false;
+	if (!imageData->LoadFromFile(path))
+	{
+		delete imageData;
+		return NULL;
+	}
+	return imageData;
+}
+
+BFIData* BFIData::LoadCached(const StringImpl& srcPath, int hwBitsType, bool premultiply, bool additive)
+{
+	String cachePath = srcPath + ".bfi";
+	int64 srcFileTime = GetFileTimeWrite(srcPath);
+
+	BFIData* bfiData = new BFIData();
+	if ((bfiData->LoadFromFile(cachePath)) && (bfiData->mCheckFileTime == srcFileTime) && (bfiData->mHWBitsType == hwBitsType) &&
+		(bfiData->mAlphaPremultiplied == premultiply) && (bfiData->mIsAdditive == additive))
+		return bfiData;
+	delete bfiData;
+
+	ImageData* source = LoadSourceImage(srcPath);
+	if (source == NULL)
+		return NULL;
+	// Additive images keep their color when premultiplied, so that has to be known before encoding
+	source->mIsAdditive = additive;
+	if (premultiply)
+		source->PremultiplyAlpha();
+
+	bfiData = new BFIData();
+	bfiData->mCheckFileTime = srcFileTime;
+	bool created = bfiData->Create(source, hwBitsType);
+	delete source;
+	if (!created)
+	{
+		delete bfiData;
+		return NULL;
+	}
+	// A cache that can't be written only costs the next load an encode
+	bfiData->WriteToFile(cachePath);
+	return bfiData;
+}
+
+//
+
 #define IS_ZERO(v) ((fabs(v) < 0.000000001))
 
 #include <complex>
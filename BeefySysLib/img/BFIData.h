@@ -5,10 +5,27 @@
 
 NS_BF_BEGIN;
 
-class BFIData : ImageData
+// A block-compressed image as a small header followed by the blocks, which are used in place as mHWBits. Files are
+//  normally made by LoadCached from a source image and carry its write time, so a stale cache gets rebuilt.
+class BFIData : public ImageData
 {
 public:
+	int64					mCheckFileTime;
+
+public:
+	BFIData();
+
+	bool					ReadData() override;
+	bool					Create(ImageData* source, int hwBitsType);
+	bool					WriteToFile(const StringImpl& path);
+	// Fills mBits from the blocks, for devices that can't sample the format
+	bool					Decompress();
 	void					Compress(ImageData* source);
+
+	static ImageData*		LoadSourceImage(const StringImpl& path);
+	// Loads "<srcPath>.bfi" if it was made from the current source with the same format, premultiplication and
+	//  additive mode, otherwise encodes the source and writes the cache
+	static BFIData*			LoadCached(const StringImpl& srcPath, int hwBitsType, bool premultiply, bool additive);
 };
 
 NS_BF_END;
@@ -0,0 +1,906 @@
+#include "BlockCompress.h"
+#include "ImageData.h"
+#include "ImageUtils.h"
+#include <float.h>
+
+// Endpoints come from a line fitted through each block's colors and are then refined by least squares against the
+//  indices they produced, keeping whichever set had the least error. Define BF_IMG_NO_SIMD to compile out the SSE2
+//  palette search.
+
+#if !defined BF_IMG_NO_SIMD
+#if (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_BC_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+USING_NS_BF;
+
+// Every channel and palette value is a whole number from 0 to 255, so squared errors add up exactly in floats and the
+//  SIMD and scalar searches always pick the same indices. Pixels with a zero weight don't count towards the error.
+struct BCBlock
+{
+	float mChannels[4][16];
+	float mWeights[16];
+};
+
+static const int gBC7Weights2[4] = { 0, 21, 43, 64 };
+static const int gBC7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const int gBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BCBitWriter
+{
+	uint8* mData;
+	int mBitPos;
+
+	void Write(uint32 val, int numBits)
+	{
+		for (int bitIdx = 0; bitIdx < numBits; bitIdx++, mBitPos++)
+		{
+			if (((val >> bitIdx) & 1) != 0)
+				mData[mBitPos >> 3] |= (uint8)(1 << (mBitPos & 7));
+		}
+	}
+};
+
+struct BCBitReader
+{
+	const uint8* mData;
+	int mBitPos;
+
+	uint32 Read(int numBits)
+	{
+		uint32 val = 0;
+		for (int bitIdx = 0; bitIdx < numBits; bitIdx++, mBitPos++)
+			val |= (uint32)((mData[mBitPos >> 3] >> (mBitPos & 7)) & 1) << bitIdx;
+		return val;
+	}
+};
+
+static int BCBlockBytes(int hwBitsType)
+{
+	switch (hwBitsType)
+	{
+	case HWBITS_BC1: return 8;
+	case HWBITS_BC3: return 16;
+	case HWBITS_BC7: return 16;
+	}
+	return -1;
+}
+
+static void BCLoadBlock(const uint32* bits, int width, int height, int blockX, int blockY, BCBlock& block)
+{
+	for (int y = 0; y < 4; y++)
+	{
+		const uint32* row = bits + BF_MIN(blockY * 4 + y, height - 1) * width;
+		for (int x = 0; x < 4; x++)
+		{
+			uint32 color = row[BF_MIN(blockX * 4 + x, width - 1)];
+			int pixelIdx = y * 4 + x;
+			block.mChannels[0][pixelIdx] = (float)(color & 0xFF);
+			block.mChannels[1][pixelIdx] = (float)((color >> 8) & 0xFF);
+			block.mChannels[2][pixelIdx] = (float)((color >> 16) & 0xFF);
+			block.mChannels[3][pixelIdx] = (float)(color >> 24);
+			block.mWeights[pixelIdx] = 1.0f;
+		}
+	}
+}
+
+static void BCStoreBlock(const uint32* blockBits, int blockX, int blockY, int width, int height, uint32* bits)
+{
+	int copyWidth = BF_MIN(width - blockX * 4, 4);
+	for (int y = 0; (y < 4) && (blockY * 4 + y < height); y++)
+		memcpy(bits + (blockY * 4 + y) * width + blockX * 4, blockBits + y * 4, copyWidth * sizeof(uint32));
+}
+
+// Picks the closest of 'numColors' palette entries for each pixel, comparing 'numChannels' channels from 'firstChannel'
+//  on against the palette's first 'numChannels' values, and returns the weighted sum of the squared errors
+static float BCFindIndices_Scalar(const BCBlock& block, int firstChannel, int numChannels, const float (*palette)[4], int numColors, uint8* outIndices)
+{
+	float totalErr = 0;
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+	{
+		float bestErr = FLT_MAX;
+		int bestIdx = 0;
+		for (int colorIdx = 0; colorIdx < numColors; colorIdx++)
+		{
+			float err = 0;
+			for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+			{
+				float diff = block.mChannels[firstChannel + channelIdx][pixelIdx] - palette[colorIdx][channelIdx];
+				err += diff * diff;
+			}
+			if (err < bestErr)
+			{
+				bestErr = err;
+				bestIdx = colorIdx;
+			}
+		}
+		outIndices[pixelIdx] = (uint8)bestIdx;
+		totalErr += bestErr * block.mWeights[pixelIdx];
+	}
+	return totalErr;
+}
+
+#ifdef BF_BC_SSE2
+
+// Four pixels at a time, keeping the best error and index per lane
+static float BCFindIndices_Simd(const BCBlock& block, int firstChannel, int numChannels, const float (*palette)[4], int numColors, uint8* outIndices)
+{
+	__m128 totalErr = _mm_setzero_ps();
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx += 4)
+	{
+		__m128 pixels[4];
+		for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+			pixels[channelIdx] = _mm_loadu_ps(&block.mChannels[firstChannel + channelIdx][pixelIdx]);
+
+		__m128 bestErr = _mm_set1_ps(FLT_MAX);
+		__m128 bestIdx = _mm_setzero_ps();
+		for (int colorIdx = 0; colorIdx < numColors; colorIdx++)
+		{
+			__m128 err = _mm_setzero_ps();
+			for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+			{
+				__m128 diff = _mm_sub_ps(pixels[channelIdx], _mm_set1_ps(palette[colorIdx][channelIdx]));
+				err = _mm_add_ps(err, _mm_mul_ps(diff, diff));
+			}
+			__m128 closer = _mm_cmplt_ps(err, bestErr);
+			bestErr = _mm_min_ps(err, bestErr);
+			bestIdx = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps((float)colorIdx)), _mm_andnot_ps(closer, bestIdx));
+		}
+		totalErr = _mm_add_ps(totalErr, _mm_mul_ps(bestErr, _mm_loadu_ps(&block.mWeights[pixelIdx])));
+
+		int indices[4];
+		_mm_storeu_si128((__m128i*)indices, _mm_cvttps_epi32(bestIdx));
+		for (int laneIdx = 0; laneIdx < 4; laneIdx++)
+			outIndices[pixelIdx + laneIdx] = (uint8)indices[laneIdx];
+	}
+
+	float errs[4];
+	_mm_storeu_ps(errs, totalErr);
+	return errs[0] + errs[1] + errs[2] + errs[3];
+}
+
+#define BF_BC_SIMD_ENABLED() ((gImageProcessFlags & ImageProcessFlag_NoSimd) == 0)
+
+#else
+
+static float BCFindIndices_Simd(const BCBlock& block, int firstChannel, int numChannels, const float (*palette)[4], int numColors, uint8* outIndices) { return 0; }
+
+#define BF_BC_SIMD_ENABLED() false
+
+#endif
+
+static float BCFindIndices(const BCBlock& block, int firstChannel, int numChannels, const float (*palette)[4], int numColors, uint8* outIndices)
+{
+	if (BF_BC_SIMD_ENABLED())
+		return BCFindIndices_Simd(block, firstChannel, numChannels, palette, numColors, outIndices);
+	return BCFindIndices_Scalar(block, firstChannel, numChannels, palette, numColors, outIndices);
+}
+
+// Fits a line through the weighted pixels' first 'numChannels' channels and returns the ends of their spread along it
+static void BCFitLine(const BCBlock& block, int numChannels, float (*outEndpoints)[4])
+{
+	float mean[4] = { 0, 0, 0, 0 };
+	float minVals[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+	float maxVals[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	float totalWeight = 0;
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+	{
+		float weight = block.mWeights[pixelIdx];
+		if (weight == 0)
+			continue;
+		totalWeight += weight;
+		for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+		{
+			float val = block.mChannels[channelIdx][pixelIdx];
+			mean[channelIdx] += val * weight;
+			minVals[channelIdx] = BF_MIN(minVals[channelIdx], val);
+			maxVals[channelIdx] = BF_MAX(maxVals[channelIdx], val);
+		}
+	}
+	if (totalWeight == 0)
+	{
+		memset(outEndpoints, 0, sizeof(float) * 8);
+		return;
+	}
+
+	float cov[4][4] = { { 0 } };
+	for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+		mean[channelIdx] /= totalWeight;
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+	{
+		float weight = block.mWeights[pixelIdx];
+		float diff[4];
+		for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+			diff[channelIdx] = block.mChannels[channelIdx][pixelIdx] - mean[channelIdx];
+		for (int rowIdx = 0; rowIdx < numChannels; rowIdx++)
+			for (int colIdx = 0; colIdx < numChannels; colIdx++)
+				cov[rowIdx][colIdx] += diff[rowIdx] * diff[colIdx] * weight;
+	}
+
+	// Power iteration for the principal axis, starting from the bounding box's diagonal
+	float axis[4];
+	for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+		axis[channelIdx] = maxVals[channelIdx] - minVals[channelIdx];
+	for (int iterIdx = 0; iterIdx < 8; iterIdx++)
+	{
+		float next[4];
+		float maxComponent = 0;
+		for (int rowIdx = 0; rowIdx < numChannels; rowIdx++)
+		{
+			next[rowIdx] = 0;
+			for (int colIdx = 0; colIdx < numChannels; colIdx++)
+				next[rowIdx] += cov[rowIdx][colIdx] * axis[colIdx];
+			maxComponent = BF_MAX(maxComponent, fabsf(next[rowIdx]));
+		}
+		if (maxComponent < 1e-6f)
+			break;
+		for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+			axis[channelIdx] = next[channelIdx] / maxComponent;
+	}
+
+	float axisLenSq = 0;
+	for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+		axisLenSq += axis[channelIdx] * axis[channelIdx];
+	float minT = 0;
+	float maxT = 0;
+	if (axisLenSq > 1e-12f)
+	{
+		float invLen = 1.0f / sqrtf(axisLenSq);
+		for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+			axis[channelIdx] *= invLen;
+		minT = FLT_MAX;
+		maxT = -FLT_MAX;
+		for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		{
+			if (block.mWeights[pixelIdx] == 0)
+				continue;
+			float t = 0;
+			for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+				t += (block.mChannels[channelIdx][pixelIdx] - mean[channelIdx]) * axis[channelIdx];
+			minT = BF_MIN(minT, t);
+			maxT = BF_MAX(maxT, t);
+		}
+	}
+	for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+	{
+		outEndpoints[0][channelIdx] = mean[channelIdx] + axis[channelIdx] * minT;
+		outEndpoints[1][channelIdx] = mean[channelIdx] + axis[channelIdx] * maxT;
+	}
+}
+
+// Solves for the endpoints that best reproduce the pixels, given that each pixel sits at 'positions[index]' of the
+//  way from the first endpoint to the second
+static bool BCRefineEndpoints(const BCBlock& block, int numChannels, const uint8* indices, const float* positions, float (*endpoints)[4])
+{
+	float sumSS = 0;
+	float sumST = 0;
+	float sumTT = 0;
+	float sumSX[4] = { 0, 0, 0, 0 };
+	float sumTX[4] = { 0, 0, 0, 0 };
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+	{
+		float weight = block.mWeights[pixelIdx];
+		if (weight == 0)
+			continue;
+		float t = positions[indices[pixelIdx]];
+		float s = 1.0f - t;
+		sumSS += s * s * weight;
+		sumST += s * t * weight;
+		sumTT += t * t * weight;
+		for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+		{
+			float val = block.mChannels[channelIdx][pixelIdx] * weight;
+			sumSX[channelIdx] += s * val;
+			sumTX[channelIdx] += t * val;
+		}
+	}
+
+	float det = sumSS * sumTT - sumST * sumST;
+	if (fabsf(det) < 1e-6f)
+		return false;
+	float invDet = 1.0f / det;
+	for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+	{
+		endpoints[0][channelIdx] = BFClamp((sumTT * sumSX[channelIdx] - sumST * sumTX[channelIdx]) * invDet, 0.0f, 255.0f);
+		endpoints[1][channelIdx] = BFClamp((sumSS * sumTX[channelIdx] - sumST * sumSX[channelIdx]) * invDet, 0.0f, 255.0f);
+	}
+	return true;
+}
+
+//
+
+static uint16 BCTo565(const float* color)
+{
+	int r = (int)(BFClamp(color[0], 0.0f, 255.0f) * (31.0f / 255.0f) + 0.5f);
+	int g = (int)(BFClamp(color[1], 0.0f, 255.0f) * (63.0f / 255.0f) + 0.5f);
+	int b = (int)(BFClamp(color[2], 0.0f, 255.0f) * (31.0f / 255.0f) + 0.5f);
+	return (uint16)((r << 11) | (g << 5) | b);
+}
+
+static void BCFrom565(uint16 color, int* outColor)
+{
+	int r = (color >> 11) & 0x1F;
+	int g = (color >> 5) & 0x3F;
+	int b = color & 0x1F;
+	outColor[0] = (r << 3) | (r >> 2);
+	outColor[1] = (g << 2) | (g >> 4);
+	outColor[2] = (b << 3) | (b >> 2);
+	outColor[3] = 255;
+}
+
+// The palette as a decoder builds it. c0 > c1 selects four colors, otherwise it's three colors and transparent black,
+//  except in BC3 where color blocks always have four.
+static int BCBuildColorPalette(uint16 c0, uint16 c1, bool forceFourColor, int (*outPalette)[4])
+{
+	BCFrom565(c0, outPalette[0]);
+	BCFrom565(c1, outPalette[1]);
+	bool fourColor = (c0 > c1) || (forceFourColor);
+	for (int channelIdx = 0; channelIdx < 3; channelIdx++)
+	{
+		int val0 = outPalette[0][channelIdx];
+		int val1 = outPalette[1][channelIdx];
+		if (fourColor)
+		{
+			outPalette[2][channelIdx] = (2 * val0 + val1) / 3;
+			outPalette[3][channelIdx] = (val0 + 2 * val1) / 3;
+		}
+		else
+		{
+			outPalette[2][channelIdx] = (val0 + val1) / 2;
+			outPalette[3][channelIdx] = 0;
+		}
+	}
+	outPalette[2][3] = 255;
+	outPalette[3][3] = fourColor ? 255 : 0;
+	return fourColor ? 4 : 3;
+}
+
+static float BCEvalColorBlock(const BCBlock& block, uint16& c0, uint16& c1, bool transparent, bool forceFourColor, uint8* outIndices)
+{
+	if ((transparent) ? (c0 > c1) : (c0 < c1))
+		std::swap(c0, c1);
+
+	int palette[4][4];
+	int numColors = BCBuildColorPalette(c0, c1, forceFourColor, palette);
+	float paletteVals[4][4];
+	for (int colorIdx = 0; colorIdx < 4; colorIdx++)
+		for (int channelIdx = 0; channelIdx < 4; channelIdx++)
+			paletteVals[colorIdx][channelIdx] = (float)palette[colorIdx][channelIdx];
+
+	float err = BCFindIndices(block, 0, 3, paletteVals, BF_MIN(numColors, 3 + (transparent ? 0 : 1)), outIndices);
+	if (transparent)
+	{
+		for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		{
+			if (block.mWeights[pixelIdx] == 0)
+				outIndices[pixelIdx] = 3;
+		}
+	}
+	return err;
+}
+
+// BC1 blocks, and the color half of BC3 blocks. Pixels with alpha under 128 switch a BC1 block into its three color
+//  mode so they can use the transparent entry.
+static void BCEncodeColorBlock(const BCBlock& srcBlock, bool allowTransparent, bool forceFourColor, uint8* outData)
+{
+	static const float fourColorPositions[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	static const float threeColorPositions[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+
+	BCBlock block = srcBlock;
+	bool transparent = false;
+	if (allowTransparent)
+	{
+		for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		{
+			if (block.mChannels[3][pixelIdx] < 128)
+			{
+				block.mWeights[pixelIdx] = 0;
+				transparent = true;
+			}
+		}
+	}
+
+	float endpoints[2][4];
+	BCFitLine(block, 3, endpoints);
+
+	uint16 bestC0 = 0;
+	uint16 bestC1 = 0;
+	uint8 bestIndices[16];
+	float bestErr = FLT_MAX;
+	for (int iterIdx = 0; iterIdx < 3; iterIdx++)
+	{
+		uint16 c0 = BCTo565(endpoints[0]);
+		uint16 c1 = BCTo565(endpoints[1]);
+		uint8 indices[16];
+		float err = BCEvalColorBlock(block, c0, c1, transparent, forceFourColor, indices);
+		if (err >= bestErr)
+			break;
+		bestErr = err;
+		bestC0 = c0;
+		bestC1 = c1;
+		memcpy(bestIndices, indices, 16);
+		if ((err == 0) || (!BCRefineEndpoints(block, 3, indices, transparent ? threeColorPositions : fourColorPositions, endpoints)))
+			break;
+	}
+
+	uint32 packedIndices = 0;
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		packedIndices |= (uint32)bestIndices[pixelIdx] << (pixelIdx * 2);
+	outData[0] = (uint8)bestC0;
+	outData[1] = (uint8)(bestC0 >> 8);
+	outData[2] = (uint8)bestC1;
+	outData[3] = (uint8)(bestC1 >> 8);
+	for (int byteIdx = 0; byteIdx < 4; byteIdx++)
+		outData[4 + byteIdx] = (uint8)(packedIndices >> (byteIdx * 8));
+}
+
+// a0 > a1 interpolates six values between them, otherwise it's four plus 0 and 255
+static void BCBuildAlphaPalette(int a0, int a1, int* outPalette)
+{
+	outPalette[0] = a0;
+	outPalette[1] = a1;
+	if (a0 > a1)
+	{
+		for (int stepIdx = 1; stepIdx < 7; stepIdx++)
+			outPalette[stepIdx + 1] = ((7 - stepIdx) * a0 + stepIdx * a1) / 7;
+		return;
+	}
+	for (int stepIdx = 1; stepIdx < 5; stepIdx++)
+		outPalette[stepIdx + 1] = ((5 - stepIdx) * a0 + stepIdx * a1) / 5;
+	outPalette[6] = 0;
+	outPalette[7] = 255;
+}
+
+static float BCEvalAlphaBlock(const BCBlock& block, int a0, int a1, uint8* outIndices)
+{
+	int palette[8];
+	BCBuildAlphaPalette(a0, a1, palette);
+	float paletteVals[8][4];
+	for (int alphaIdx = 0; alphaIdx < 8; alphaIdx++)
+		paletteVals[alphaIdx][0] = (float)palette[alphaIdx];
+	return BCFindIndices(block, 3, 1, paletteVals, 8, outIndices);
+}
+
+// The alpha half of BC3 blocks. The full range goes between the six step endpoints, and the four step mode gets tried
+//  on the values in between when a block also has fully transparent or opaque pixels.
+static void BCEncodeAlphaBlock(const BCBlock& block, uint8* outData)
+{
+	int minAlpha = 255;
+	int maxAlpha = 0;
+	int minInnerAlpha = 255;
+	int maxInnerAlpha = 0;
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+	{
+		int alpha = (int)block.mChannels[3][pixelIdx];
+		minAlpha = BF_MIN(minAlpha, alpha);
+		maxAlpha = BF_MAX(maxAlpha, alpha);
+		if ((alpha != 0) && (alpha != 255))
+		{
+			minInnerAlpha = BF_MIN(minInnerAlpha, alpha);
+			maxInnerAlpha = BF_MAX(maxInnerAlpha, alpha);
+		}
+	}
+
+	int a0 = maxAlpha;
+	int a1 = minAlpha;
+	uint8 indices[16];
+	float err = BCEvalAlphaBlock(block, a0, a1, indices);
+	if ((err > 0) && (minInnerAlpha <= maxInnerAlpha) && ((minAlpha == 0) || (maxAlpha == 255)))
+	{
+		uint8 innerIndices[16];
+		float innerErr = BCEvalAlphaBlock(block, minInnerAlpha, maxInnerAlpha, innerIndices);
+		if (innerErr < err)
+		{
+			a0 = minInnerAlpha;
+			a1 = maxInnerAlpha;
+			memcpy(indices, innerIndices, 16);
+		}
+	}
+
+	uint64 packedIndices = 0;
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		packedIndices |= (uint64)indices[pixelIdx] << (pixelIdx * 3);
+	outData[0] = (uint8)a0;
+	outData[1] = (uint8)a1;
+	for (int byteIdx = 0; byteIdx < 6; byteIdx++)
+		outData[2 + byteIdx] = (uint8)(packedIndices >> (byteIdx * 8));
+}
+
+static const int* BCGetBC7Weights(int numIndexBits)
+{
+	return (numIndexBits == 2) ? gBC7Weights2 : (numIndexBits == 3) ? gBC7Weights3 : gBC7Weights;
+}
+
+// Endpoints stored with fewer than 8 bits get their high bits repeated into the low bits
+static int BCUnquantizeBC7(int value, int numBits)
+{
+	if (numBits >= 8)
+		return value;
+	return (value << (8 - numBits)) | (value >> (2 * numBits - 8));
+}
+
+static int BCQuantizeBC7(float value, int numBits)
+{
+	int maxValue = (1 << numBits) - 1;
+	int bestValue = BFClamp((int)(value * maxValue / 255.0f + 0.5f), 0, maxValue);
+	float bestErr = fabsf(BCUnquantizeBC7(bestValue, numBits) - value);
+	for (int checkValue = BF_MAX(bestValue - 1, 0); checkValue <= BF_MIN(bestValue + 1, maxValue); checkValue++)
+	{
+		float err = fabsf(BCUnquantizeBC7(checkValue, numBits) - value);
+		if (err < bestErr)
+		{
+			bestErr = err;
+			bestValue = checkValue;
+		}
+	}
+	return bestValue;
+}
+
+static float BCEvalBC7Endpoints(const BCBlock& block, int numChannels, const int (*endpointValues)[4], int numIndexBits, uint8* outIndices)
+{
+	const int* weights = BCGetBC7Weights(numIndexBits);
+	float paletteVals[16][4];
+	for (int colorIdx = 0; colorIdx < (1 << numIndexBits); colorIdx++)
+	{
+		int weight = weights[colorIdx];
+		for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+			paletteVals[colorIdx][channelIdx] = (float)(((64 - weight) * endpointValues[0][channelIdx] + weight * endpointValues[1][channelIdx] + 32) >> 6);
+	}
+	return BCFindIndices(block, 0, numChannels, paletteVals, 1 << numIndexBits, outIndices);
+}
+
+// The first pixel's index is stored without its high bit, so flip the endpoints if it would need one
+static void BCFixBC7Anchor(int numChannels, int numIndexBits, int (*endpointValues)[4], uint8* indices)
+{
+	int maxIndex = (1 << numIndexBits) - 1;
+	if (indices[0] <= maxIndex / 2)
+		return;
+	for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+		std::swap(endpointValues[0][channelIdx], endpointValues[1][channelIdx]);
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		indices[pixelIdx] = maxIndex - indices[pixelIdx];
+}
+
+// Mode 6 endpoints are 7 bits per channel plus a low bit shared by the endpoint's four channels, picked per endpoint
+static void BCQuantizeBC7Endpoint(const float* color, int* outValues)
+{
+	float bestErr = FLT_MAX;
+	for (int pBit = 0; pBit < 2; pBit++)
+	{
+		int values[4];
+		float err = 0;
+		for (int channelIdx = 0; channelIdx < 4; channelIdx++)
+		{
+			int quantized = BFClamp((int)((color[channelIdx] - pBit) * 0.5f + 0.5f), 0, 127);
+			values[channelIdx] = (quantized << 1) | pBit;
+			float diff = values[channelIdx] - color[channelIdx];
+			err += diff * diff;
+		}
+		if (err < bestErr)
+		{
+			bestErr = err;
+			memcpy(outValues, values, sizeof(values));
+		}
+	}
+}
+
+// Fits, quantizes and refines one pair of endpoints over the first 'numChannels' channels of 'block'. With no p-bits the
+//  endpoints are 'numEndpointBits' per channel, otherwise they're mode 6's 7 bits and a p-bit. 'outValues' holds the
+//  values as decoded.
+static float BCEncodeBC7Endpoints(const BCBlock& block, int numChannels, int numEndpointBits, bool usePBits, int numIndexBits, int (*outValues)[4], uint8* outIndices)
+{
+	const int* weights = BCGetBC7Weights(numIndexBits);
+	float positions[16];
+	for (int colorIdx = 0; colorIdx < (1 << numIndexBits); colorIdx++)
+		positions[colorIdx] = weights[colorIdx] / 64.0f;
+
+	float endpoints[2][4];
+	BCFitLine(block, numChannels, endpoints);
+
+	float bestErr = FLT_MAX;
+	for (int iterIdx = 0; iterIdx < 3; iterIdx++)
+	{
+		int values[2][4];
+		for (int endpointIdx = 0; endpointIdx < 2; endpointIdx++)
+		{
+			if (usePBits)
+			{
+				BCQuantizeBC7Endpoint(endpoints[endpointIdx], values[endpointIdx]);
+				continue;
+			}
+			for (int channelIdx = 0; channelIdx < numChannels; channelIdx++)
+				values[endpointIdx][channelIdx] = BCUnquantizeBC7(BCQuantizeBC7(endpoints[endpointIdx][channelIdx], numEndpointBits), numEndpointBits);
+		}
+		uint8 indices[16];
+		float err = BCEvalBC7Endpoints(block, numChannels, values, numIndexBits, indices);
+		if (err >= bestErr)
+			break;
+		bestErr = err;
+		memcpy(outValues, values, sizeof(values));
+		memcpy(outIndices, indices, 16);
+		if ((err == 0) || (!BCRefineEndpoints(block, numChannels, indices, positions, endpoints)))
+			break;
+	}
+	return bestErr;
+}
+
+static float BCEncodeBC7Mode6(const BCBlock& block, uint8* outData)
+{
+	int values[2][4];
+	uint8 indices[16];
+	float err = BCEncodeBC7Endpoints(block, 4, 7, true, 4, values, indices);
+	BCFixBC7Anchor(4, 4, values, indices);
+
+	memset(outData, 0, 16);
+	BCBitWriter bitWriter = { outData, 0 };
+	bitWriter.Write(1 << 6, 7);
+	for (int channelIdx = 0; channelIdx < 4; channelIdx++)
+	{
+		bitWriter.Write(values[0][channelIdx] >> 1, 7);
+		bitWriter.Write(values[1][channelIdx] >> 1, 7);
+	}
+	bitWriter.Write(values[0][0] & 1, 1);
+	bitWriter.Write(values[1][0] & 1, 1);
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		bitWriter.Write(indices[pixelIdx], (pixelIdx == 0) ? 3 : 4);
+	return err;
+}
+
+// Modes 4 and 5 give alpha its own endpoints and indices. 'rotation' swaps alpha with R, G or B first, so that channel
+//  is the one encoded on its own. Mode 4's 'indexMode' picks whether color (0) or alpha (1) gets the 2-bit indices,
+//  the other getting 3-bit ones.
+static float BCEncodeBC7SeparateAlpha(const BCBlock& block, int mode, int rotation, int indexMode, uint8* outData)
+{
+	BCBlock colorBlock = block;
+	if (rotation != 0)
+		memcpy(colorBlock.mChannels[rotation - 1], block.mChannels[3], sizeof(block.mChannels[3]));
+	BCBlock alphaBlock;
+	memcpy(alphaBlock.mChannels[0], block.mChannels[(rotation == 0) ? 3 : rotation - 1], sizeof(block.mChannels[0]));
+	memcpy(alphaBlock.mWeights, block.mWeights, sizeof(block.mWeights));
+
+	int colorEndpointBits = (mode == 4) ? 5 : 7;
+	int alphaEndpointBits = (mode == 4) ? 6 : 8;
+	int colorIndexBits = ((mode == 4) && (indexMode == 1)) ? 3 : 2;
+	int alphaIndexBits = ((mode == 4) && (indexMode == 0)) ? 3 : 2;
+
+	int colorValues[2][4];
+	uint8 colorIndices[16];
+	float err = BCEncodeBC7Endpoints(colorBlock, 3, colorEndpointBits, false, colorIndexBits, colorValues, colorIndices);
+	int alphaValues[2][4];
+	uint8 alphaIndices[16];
+	err += BCEncodeBC7Endpoints(alphaBlock, 1, alphaEndpointBits, false, alphaIndexBits, alphaValues, alphaIndices);
+	BCFixBC7Anchor(3, colorIndexBits, colorValues, colorIndices);
+	BCFixBC7Anchor(1, alphaIndexBits, alphaValues, alphaIndices);
+
+	memset(outData, 0, 16);
+	BCBitWriter bitWriter = { outData, 0 };
+	bitWriter.Write(1 << mode, mode + 1);
+	bitWriter.Write(rotation, 2);
+	if (mode == 4)
+		bitWriter.Write(indexMode, 1);
+	for (int channelIdx = 0; channelIdx < 3; channelIdx++)
+	{
+		bitWriter.Write(BCQuantizeBC7((float)colorValues[0][channelIdx], colorEndpointBits), colorEndpointBits);
+		bitWriter.Write(BCQuantizeBC7((float)colorValues[1][channelIdx], colorEndpointBits), colorEndpointBits);
+	}
+	bitWriter.Write(BCQuantizeBC7((float)alphaValues[0][0], alphaEndpointBits), alphaEndpointBits);
+	bitWriter.Write(BCQuantizeBC7((float)alphaValues[1][0], alphaEndpointBits), alphaEndpointBits);
+
+	// The 2-bit index set comes first
+	bool colorFirst = colorIndexBits == 2;
+	for (int setIdx = 0; setIdx < 2; setIdx++)
+	{
+		bool isColor = (setIdx == 0) == colorFirst;
+		const uint8* indices = isColor ? colorIndices : alphaIndices;
+		int numIndexBits = isColor ? colorIndexBits : alphaIndexBits;
+		for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+			bitWriter.Write(indices[pixelIdx], (pixelIdx == 0) ? numIndexBits - 1 : numIndexBits);
+	}
+	return err;
+}
+
+// Tries mode 6 and every rotation and index mode of modes 4 and 5, keeping the block with the least error
+static void BCEncodeBC7Block(const BCBlock& block, uint8* outData)
+{
+	float bestErr = BCEncodeBC7Mode6(block, outData);
+	for (int mode = 4; (mode <= 5) && (bestErr > 0); mode++)
+	{
+		for (int rotation = 0; rotation < 4; rotation++)
+		{
+			for (int indexMode = 0; indexMode < ((mode == 4) ? 2 : 1); indexMode++)
+			{
+				uint8 modeData[16];
+				float err = BCEncodeBC7SeparateAlpha(block, mode, rotation, indexMode, modeData);
+				if (err < bestErr)
+				{
+					bestErr = err;
+					memcpy(outData, modeData, 16);
+				}
+			}
+		}
+	}
+}
+
+//
+
+static void BCDecodeColorBlock(const uint8* data, bool forceFourColor, uint32* outBits)
+{
+	int palette[4][4];
+	BCBuildColorPalette((uint16)(data[0] | (data[1] << 8)), (uint16)(data[2] | (data[3] << 8)), forceFourColor, palette);
+	uint32 colors[4];
+	for (int colorIdx = 0; colorIdx < 4; colorIdx++)
+		colors[colorIdx] = (uint32)palette[colorIdx][0] | ((uint32)palette[colorIdx][1] << 8) | ((uint32)palette[colorIdx][2] << 16) | ((uint32)palette[colorIdx][3] << 24);
+	uint32 packedIndices = (uint32)data[4] | ((uint32)data[5] << 8) | ((uint32)data[6] << 16) | ((uint32)data[7] << 24);
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		outBits[pixelIdx] = colors[(packedIndices >> (pixelIdx * 2)) & 3];
+}
+
+static void BCDecodeAlphaBlock(const uint8* data, uint32* outBits)
+{
+	int palette[8];
+	BCBuildAlphaPalette(data[0], data[1], palette);
+	uint64 packedIndices = 0;
+	for (int byteIdx = 0; byteIdx < 6; byteIdx++)
+		packedIndices |= (uint64)data[2 + byteIdx] << (byteIdx * 8);
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		outBits[pixelIdx] = (outBits[pixelIdx] & 0x00FFFFFF) | ((uint32)palette[(packedIndices >> (pixelIdx * 3)) & 7] << 24);
+}
+
+static void BCDecodeBC7Block(const uint8* data, uint32* outBits)
+{
+	int mode = 0;
+	while ((mode < 8) && (((data[0] >> mode) & 1) == 0))
+		mode++;
+	if ((mode < 4) || (mode > 6))
+	{
+		memset(outBits, 0, 16 * sizeof(uint32));
+		return;
+	}
+
+	BCBitReader bitReader = { data, mode + 1 };
+	int values[2][4];
+	int colorWeights[16];
+	int alphaWeights[16];
+	int rotation = 0;
+	if (mode == 6)
+	{
+		for (int channelIdx = 0; channelIdx < 4; channelIdx++)
+		{
+			values[0][channelIdx] = bitReader.Read(7) << 1;
+			values[1][channelIdx] = bitReader.Read(7) << 1;
+		}
+		int pBits[2];
+		pBits[0] = bitReader.Read(1);
+		pBits[1] = bitReader.Read(1);
+		for (int channelIdx = 0; channelIdx < 4; channelIdx++)
+		{
+			values[0][channelIdx] |= pBits[0];
+			values[1][channelIdx] |= pBits[1];
+		}
+		for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+		{
+			colorWeights[pixelIdx] = gBC7Weights[bitReader.Read((pixelIdx == 0) ? 3 : 4)];
+			alphaWeights[pixelIdx] = colorWeights[pixelIdx];
+		}
+	}
+	else
+	{
+		rotation = bitReader.Read(2);
+		int indexMode = (mode == 4) ? bitReader.Read(1) : 0;
+		int colorEndpointBits = (mode == 4) ? 5 : 7;
+		int alphaEndpointBits = (mode == 4) ? 6 : 8;
+		for (int channelIdx = 0; channelIdx < 3; channelIdx++)
+		{
+			values[0][channelIdx] = BCUnquantizeBC7(bitReader.Read(colorEndpointBits), colorEndpointBits);
+			values[1][channelIdx] = BCUnquantizeBC7(bitReader.Read(colorEndpointBits), colorEndpointBits);
+		}
+		values[0][3] = BCUnquantizeBC7(bitReader.Read(alphaEndpointBits), alphaEndpointBits);
+		values[1][3] = BCUnquantizeBC7(bitReader.Read(alphaEndpointBits), alphaEndpointBits);
+
+		// The 2-bit index set comes first, then mode 4's 3-bit set or mode 5's second 2-bit set
+		int secondIndexBits = (mode == 4) ? 3 : 2;
+		int* firstWeights = (indexMode == 0) ? colorWeights : alphaWeights;
+		int* secondWeights = (indexMode == 0) ? alphaWeights : colorWeights;
+		for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+			firstWeights[pixelIdx] = gBC7Weights2[bitReader.Read((pixelIdx == 0) ? 1 : 2)];
+		for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+			secondWeights[pixelIdx] = BCGetBC7Weights(secondIndexBits)[bitReader.Read((pixelIdx == 0) ? secondIndexBits - 1 : secondIndexBits)];
+	}
+
+	for (int pixelIdx = 0; pixelIdx < 16; pixelIdx++)
+	{
+		int channels[4];
+		for (int channelIdx = 0; channelIdx < 4; channelIdx++)
+		{
+			int weight = (channelIdx == 3) ? alphaWeights[pixelIdx] : colorWeights[pixelIdx];
+			channels[channelIdx] = ((64 - weight) * values[0][channelIdx] + weight * values[1][channelIdx] + 32) >> 6;
+		}
+		if (rotation != 0)
+			std::swap(channels[3], channels[rotation - 1]);
+		outBits[pixelIdx] = (uint32)channels[0] | ((uint32)channels[1] << 8) | ((uint32)channels[2] << 16) | ((uint32)channels[3] << 24);
+	}
+}
+
+//
+
+int Beefy::BlockCompressedSize(int hwBitsType, int width, int height)
+{
+	int blockBytes = BCBlockBytes(hwBitsType);
+	if (blockBytes < 0)
+		return -1;
+	return ((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+}
+
+bool Beefy::BlockCompress(int hwBitsType, const uint32* bits, int width, int height, uint8* outData)
+{
+	int blockBytes = BCBlockBytes(hwBitsType);
+	if ((blockBytes < 0) || (width <= 0) || (height <= 0))
+		return false;
+
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	ImageParallelRows(blocksHigh, blocksWide * 16, [&](int startBlockY, int endBlockY)
+	{
+		BCBlock block;
+		for (int blockY = startBlockY; blockY < endBlockY; blockY++)
+		{
+			for (int blockX = 0; blockX < blocksWide; blockX++)
+			{
+				BCLoadBlock(bits, width, height, blockX, blockY, block);
+				uint8* blockData = outData + ((size_t)blockY * blocksWide + blockX) * blockBytes;
+				switch (hwBitsType)
+				{
+				case HWBITS_BC1:
+					BCEncodeColorBlock(block, true, false, blockData);
+					break;
+				case HWBITS_BC3:
+					BCEncodeAlphaBlock(block, blockData);
+					BCEncodeColorBlock(block, false, true, blockData + 8);
+					break;
+				case HWBITS_BC7:
+					BCEncodeBC7Block(block, blockData);
+					break;
+				}
+			}
+		}
+	});
+	return true;
+}
+
+bool Beefy::BlockDecompress(int hwBitsType, const uint8* data, int width, int height, uint32* outBits)
+{
+	int blockBytes = BCBlockBytes(hwBitsType);
+	if ((blockBytes < 0) || (width <= 0) || (height <= 0))
+		return false;
+
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	ImageParallelRows(blocksHigh, blocksWide * 16, [&](int startBlockY, int endBlockY)
+	{
+		uint32 blockBits[16];
+		for (int blockY = startBlockY; blockY < endBlockY; blockY++)
+		{
+			for (int blockX = 0; blockX < blocksWide; blockX++)
+			{
+				const uint8* blockData = data + ((size_t)blockY * blocksWide + blockX) * blockBytes;
+				switch (hwBitsType)
+				{
+				case HWBITS_BC1:
+					BCDecodeColorBlock(blockData, false, blockBits);
+					break;
+				case HWBITS_BC3:
+					BCDecodeColorBlock(blockData + 8, true, blockBits);
+					BCDecodeAlphaBlock(blockData, blockBits);
+					break;
+				case HWBITS_BC7:
+					BCDecodeBC7Block(blockData, blockBits);
+					break;
+				}
+				BCStoreBlock(blockBits, blockX, blockY, width, height, outBits);
+			}
+		}
+	});
+	return true;
+}
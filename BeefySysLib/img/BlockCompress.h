@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Common.h"
+
+NS_BF_BEGIN;
+
+// Bytes taken by a width x height image in HWBITS_BC1, HWBITS_BC3 or HWBITS_BC7, or -1 for any other HWBITS type
+int BlockCompressedSize(int hwBitsType, int width, int height);
+
+// Encodes R, G, B, A pixels into 4x4 blocks. Rows of blocks are spread over the shared worker pool and the palette
+//  searches use SSE2, both following gImageProcessFlags. Blocks along the right and bottom edges of images that aren't
+//  a multiple of four in size repeat their last column and row. BC7 blocks use whichever of modes 4, 5 and 6 has the
+//  least error.
+bool BlockCompress(int hwBitsType, const uint32* bits, int width, int height, uint8* outData);
+// Decodes blocks back into R, G, B, A pixels. BC7 blocks in modes other than 4, 5 and 6 come out as transparent black.
+bool BlockDecompress(int hwBitsType, const uint8* data, int width, int height, uint32* outBits);
+
+NS_BF_END;
@@ -30,19 +30,10 @@ ImageData::~ImageData()
 
 void ImageData::SwapRAndB()
 {
-	int aSize = mWidth*mHeight;
-	uint32* aPtr = mBits;
-	for (int i = 0; i < aSize; i++)
+	ImageParallelRows(mHeight, mWidth, [&](int startY, int endY)
 	{
-		uint32 aColor = *aPtr;
-
-		int a = (aColor & 0xFF000000) >> 24;
-		int r = (aColor & 0x00FF0000) >> 16;
-		int g = (aColor & 0x0000FF00) >> 8;
-		int b = (aColor & 0x000000FF);
-
-		*(aPtr++) = (a << 24) | (b << 16) | (g << 8) | r;
-	}
+		SwapRAndBRow(mBits + startY * mWidth, (endY - startY) * mWidth);
+	});
 }
 
 void ImageData::CreateNew(int x, int y, int width, int height, bool clear)
@@ -114,16 +105,9 @@ void ImageData::PremultiplyAlpha()
 	if (!mAlphaPremultiplied)
 	{
 		mAlphaPremultiplied = true;
-		int size = mWidth*mHeight;
-		for (int i = 0; i < size; i++)
+		ImageParallelRows(mHeight, mWidth, [&](int startY, int endY)
 		{
-			PackedColor* packedColor = (PackedColor*) (mBits + i);
-			packedColor->r = (packedColor->r * packedColor->a) / 255;
-			packedColor->g = (packedColor->g * packedColor->a) / 255;
-			packedColor->b = (packedColor->b * packedColor->a) / 255;
-
-			if (mIsAdditive)
-				packedColor->a = 0;
-		}
+			PremultiplyAlphaRow(mBits + startY * mWidth, (endY - startY) * mWidth, mIsAdditive);
+		});
 	}
 }
\ No newline at end of file
@@ -9,7 +9,10 @@ enum
 	HWBITS_UNKNOWN,
 	HWBITS_PVRTC_2BPPV1,
 	HWBITS_PVRTC_4BPPV1,
-	HWBITS_PVRTC_2X4BPPV1
+	HWBITS_PVRTC_2X4BPPV1,
+	HWBITS_BC1,
+	HWBITS_BC3,
+	HWBITS_BC7
 };
 
 class ImageData
@@ -2,6 +2,20 @@
 #include "ImageData.h"
 #include "Common.h"
 #include "util/PerfTimer.h"
+#include "util/ThreadPool.h"
+
+// The blend kernels work on a pixel per 32-bit lane, using the same integer math as the scalar loops so results are
+//  bit-identical. Define BF_IMG_NO_SIMD to compile them out, or set ImageProcessFlag_NoSimd to disable them at runtime.
+
+#if !defined BF_IMG_NO_SIMD
+#if defined __AVX2__
+#define BF_IMG_AVX2
+#include <immintrin.h>
+#elif (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_IMG_SSE2
+#include <emmintrin.h>
+#endif
+#endif
 
 USING_NS_BF;
 
@@ -29,6 +43,320 @@ static inline int clamp(int val, int min, int max)
 	return (val <= min) ? min : (val >= max) ? max : val;
 }
 
+int Beefy::gImageProcessFlags = ImageProcessFlag_None;
+
+//
+
+void Beefy::ImageParallelRows(int height, int pixelsPerRow, const std::function<void(int startY, int endY)>& func)
+{
+	const int minBandPixels = 16 * 1024;
+
+	if ((gImageProcessFlags & ImageProcessFlag_NoThreads) != 0)
+	{
+		if (height > 0)
+			func(0, height);
+		return;
+	}
+	ThreadPool::ParallelFor(height, BF_MAX(minBandPixels / BF_MAX(pixelsPerRow, 1), 1), func);
+}
+
+//
+
+#if defined BF_IMG_AVX2 || defined BF_IMG_SSE2
+
+#ifdef BF_IMG_AVX2
+#define BF_IMG_SIMD_WIDTH 8
+typedef __m256i ImgVec;
+typedef __m256 ImgVecF;
+static inline ImgVec ImgVec_Load(const uint32* ptr) { return _mm256_loadu_si256((const __m256i*)ptr); }
+static inline void ImgVec_Store(uint32* ptr, ImgVec a) { _mm256_storeu_si256((__m256i*)ptr, a); }
+static inline ImgVec ImgVec_Splat(int val) { return _mm256_set1_epi32(val); }
+static inline ImgVec ImgVec_Add(ImgVec a, ImgVec b) { return _mm256_add_epi32(a, b); }
+static inline ImgVec ImgVec_Sub(ImgVec a, ImgVec b) { return _mm256_sub_epi32(a, b); }
+static inline ImgVec ImgVec_Mul16(ImgVec a, ImgVec b) { return _mm256_mullo_epi16(a, b); }
+static inline ImgVec ImgVec_And(ImgVec a, ImgVec b) { return _mm256_and_si256(a, b); }
+static inline ImgVec ImgVec_AndNot(ImgVec a, ImgVec b) { return _mm256_andnot_si256(a, b); }
+static inline ImgVec ImgVec_Or(ImgVec a, ImgVec b) { return _mm256_or_si256(a, b); }
+static inline ImgVec ImgVec_Eq(ImgVec a, ImgVec b) { return _mm256_cmpeq_epi32(a, b); }
+template <int TShift> static inline ImgVec ImgVec_Srl(ImgVec a) { return _mm256_srli_epi32(a, TShift); }
+template <int TShift> static inline ImgVec ImgVec_Sll(ImgVec a) { return _mm256_slli_epi32(a, TShift); }
+static inline ImgVecF ImgVec_ToFloat(ImgVec a) { return _mm256_cvtepi32_ps(a); }
+static inline ImgVec ImgVec_TruncFloat(ImgVecF a) { return _mm256_cvttps_epi32(a); }
+static inline ImgVecF ImgVec_MulF(ImgVecF a, ImgVecF b) { return _mm256_mul_ps(a, b); }
+static inline ImgVecF ImgVec_DivF(ImgVecF a, ImgVecF b) { return _mm256_div_ps(a, b); }
+static inline ImgVec ImgVec_Lookup(const int* table, ImgVec idx) { return _mm256_i32gather_epi32(table, idx, 4); }
+#else
+#define BF_IMG_SIMD_WIDTH 4
+typedef __m128i ImgVec;
+typedef __m128 ImgVecF;
+static inline ImgVec ImgVec_Load(const uint32* ptr) { return _mm_loadu_si128((const __m128i*)ptr); }
+static inline void ImgVec_Store(uint32* ptr, ImgVec a) { _mm_storeu_si128((__m128i*)ptr, a); }
+static inline ImgVec ImgVec_Splat(int val) { return _mm_set1_epi32(val); }
+static inline ImgVec ImgVec_Add(ImgVec a, ImgVec b) { return _mm_add_epi32(a, b); }
+static inline ImgVec ImgVec_Sub(ImgVec a, ImgVec b) { return _mm_sub_epi32(a, b); }
+static inline ImgVec ImgVec_Mul16(ImgVec a, ImgVec b) { return _mm_mullo_epi16(a, b); }
+static inline ImgVec ImgVec_And(ImgVec a, ImgVec b) { return _mm_and_si128(a, b); }
+static inline ImgVec ImgVec_AndNot(ImgVec a, ImgVec b) { return _mm_andnot_si128(a, b); }
+static inline ImgVec ImgVec_Or(ImgVec a, ImgVec b) { return _mm_or_si128(a, b); }
+static inline ImgVec ImgVec_Eq(ImgVec a, ImgVec b) { return _mm_cmpeq_epi32(a, b); }
+template <int TShift> static inline ImgVec ImgVec_Srl(ImgVec a) { return _mm_srli_epi32(a, TShift); }
+template <int TShift> static inline ImgVec ImgVec_Sll(ImgVec a) { return _mm_slli_epi32(a, TShift); }
+static inline ImgVecF ImgVec_ToFloat(ImgVec a) { return _mm_cvtepi32_ps(a); }
+static inline ImgVec ImgVec_TruncFloat(ImgVecF a) { return _mm_cvttps_epi32(a); }
+static inline ImgVecF ImgVec_MulF(ImgVecF a, ImgVecF b) { return _mm_mul_ps(a, b); }
+static inline ImgVecF ImgVec_DivF(ImgVecF a, ImgVecF b) { return _mm_div_ps(a, b); }
+static inline ImgVec ImgVec_Lookup(const int* table, ImgVec idx)
+{
+	uint32 idxs[4];
+	_mm_storeu_si128((__m128i*)idxs, idx);
+	return _mm_set_epi32(table[idxs[3]], table[idxs[2]], table[idxs[1]], table[idxs[0]]);
+}
+#endif
+
+// Lanes hold values < 65536 with their high halves clear, so a 16-bit multiply gives the full product as long as
+//  it fits in 16 bits - which every 8-bit * 8-bit product does
+
+// Exact 'val / 255' for 0 <= val < 65535
+static inline ImgVec ImgVec_Div255(ImgVec val)
+{
+	val = ImgVec_Add(val, ImgVec_Splat(1));
+	return ImgVec_Srl<8>(ImgVec_Add(val, ImgVec_Srl<8>(val)));
+}
+
+// Exact integer 'num / denom' when num < 2^24 and the quotient's distance from the next integer can't round away in
+//  a float, which holds for all the alpha ratios below (checked exhaustively over their input ranges)
+static inline ImgVec ImgVec_DivTrunc(ImgVecF num, ImgVec denom)
+{
+	return ImgVec_TruncFloat(ImgVec_DivF(num, ImgVec_ToFloat(denom)));
+}
+
+static inline ImgVec ImgVec_Channel(ImgVec color, int shift)
+{
+	ImgVec mask = ImgVec_Splat(0xFF);
+	switch (shift)
+	{
+	case 0: return ImgVec_And(color, mask);
+	case 8: return ImgVec_And(ImgVec_Srl<8>(color), mask);
+	default: return ImgVec_And(ImgVec_Srl<16>(color), mask);
+	}
+}
+
+static inline ImgVec ImgVec_PutChannel(ImgVec val, int shift)
+{
+	switch (shift)
+	{
+	case 0: return val;
+	case 8: return ImgVec_Sll<8>(val);
+	default: return ImgVec_Sll<16>(val);
+	}
+}
+
+// The 'Nrml' path of BlendImage. Returns the number of pixels done, the caller finishes the tail.
+static int BlendRow_Normal_Simd(uint32* dest, const uint32* src, int count, const int* srcAlphaTable)
+{
+	ImgVec v255 = ImgVec_Splat(255);
+	ImgVec zero = ImgVec_Splat(0);
+	ImgVec one = ImgVec_Splat(1);
+
+	int x = 0;
+	for (; x + BF_IMG_SIMD_WIDTH <= count; x += BF_IMG_SIMD_WIDTH)
+	{
+		ImgVec srcColor = ImgVec_Load(src + x);
+		ImgVec destColor = ImgVec_Load(dest + x);
+
+		ImgVec srcAlpha = ImgVec_Lookup(srcAlphaTable, ImgVec_Srl<24>(srcColor));
+		ImgVec destAlpha = ImgVec_Srl<24>(destColor);
+		// An opaque dest adds zero here, so it doesn't need the scalar special case
+		ImgVec newDestAlpha = ImgVec_Add(destAlpha, ImgVec_Div255(ImgVec_Mul16(ImgVec_Sub(v255, destAlpha), srcAlpha)));
+		// newDestAlpha is only zero when srcAlpha is, and then a=0 either way
+		ImgVec safeDestAlpha = ImgVec_Or(newDestAlpha, ImgVec_And(ImgVec_Eq(newDestAlpha, zero), one));
+		ImgVec a = ImgVec_DivTrunc(ImgVec_ToFloat(ImgVec_Mul16(srcAlpha, v255)), safeDestAlpha);
+		ImgVec oma = ImgVec_Sub(v255, a);
+
+		// The blended color reduces to the source color for normal blending
+		ImgVec result = ImgVec_Sll<24>(newDestAlpha);
+		for (int shift = 0; shift <= 16; shift += 8)
+		{
+			ImgVec val = ImgVec_Add(ImgVec_Mul16(ImgVec_Channel(srcColor, shift), a), ImgVec_Mul16(ImgVec_Channel(destColor, shift), oma));
+			result = ImgVec_Or(result, ImgVec_PutChannel(ImgVec_Div255(val), shift));
+		}
+		ImgVec_Store(dest + x, result);
+	}
+	return x;
+}
+
+// Weighs 'top' by alpha (per-pixel from alphaBits, or constAlpha) against 'bot' and writes the result into 'out'. Pixels
+//  whose combined alpha comes out as zero keep their 'out' value. Shared by CrossfadeImage and BlendImagesTogether.
+static int MixRow_Simd(uint32* out, const uint32* top, const uint32* bot, const uint32* alphaBits, int constAlpha, int count)
+{
+	ImgVec v255 = ImgVec_Splat(255);
+	ImgVec zero = ImgVec_Splat(0);
+	ImgVec one = ImgVec_Splat(1);
+	ImgVec a = ImgVec_Splat(constAlpha);
+
+	int x = 0;
+	for (; x + BF_IMG_SIMD_WIDTH <= count; x += BF_IMG_SIMD_WIDTH)
+	{
+		if (alphaBits != NULL)
+			a = ImgVec_Srl<24>(ImgVec_Load(alphaBits + x));
+		ImgVec oma = ImgVec_Sub(v255, a);
+
+		ImgVec topColor = ImgVec_Load(top + x);
+		ImgVec botColor = ImgVec_Load(bot + x);
+		ImgVec outColor = ImgVec_Load(out + x);
+		ImgVec topAlpha = ImgVec_Srl<24>(topColor);
+		ImgVec botAlpha = ImgVec_Srl<24>(botColor);
+
+		ImgVec denom = ImgVec_Add(ImgVec_Mul16(topAlpha, a), ImgVec_Mul16(botAlpha, oma));
+		ImgVec newDestAlpha = ImgVec_Div255(denom);
+		ImgVec keepMask = ImgVec_Eq(newDestAlpha, zero);
+		ImgVec safeDenom = ImgVec_Or(denom, ImgVec_And(ImgVec_Eq(denom, zero), one));
+		// 255*a*topAlpha needs more than 16 bits but is still exact as a float
+		ImgVec ca = ImgVec_DivTrunc(ImgVec_MulF(ImgVec_ToFloat(ImgVec_Mul16(a, v255)), ImgVec_ToFloat(topAlpha)), safeDenom);
+		ImgVec coma = ImgVec_Sub(v255, ca);
+
+		ImgVec result = ImgVec_Sll<24>(newDestAlpha);
+		for (int shift = 0; shift <= 16; shift += 8)
+		{
+			ImgVec val = ImgVec_Add(ImgVec_Mul16(ImgVec_Channel(topColor, shift), ca), ImgVec_Mul16(ImgVec_Channel(botColor, shift), coma));
+			result = ImgVec_Or(result, ImgVec_PutChannel(ImgVec_Div255(val), shift));
+		}
+		ImgVec_Store(out + x, ImgVec_Or(ImgVec_And(keepMask, outColor), ImgVec_AndNot(keepMask, result)));
+	}
+	return x;
+}
+
+// 'alpha = alpha * scale / 255', with the scale per-pixel from alphaBits or constAlpha
+static int MultiplyAlphaRow_Simd(uint32* bits, const uint32* alphaBits, int constAlpha, int count)
+{
+	ImgVec colorMask = ImgVec_Splat(0x00FFFFFF);
+	ImgVec scale = ImgVec_Splat(constAlpha);
+
+	int x = 0;
+	for (; x + BF_IMG_SIMD_WIDTH <= count; x += BF_IMG_SIMD_WIDTH)
+	{
+		if (alphaBits != NULL)
+			scale = ImgVec_Srl<24>(ImgVec_Load(alphaBits + x));
+		ImgVec color = ImgVec_Load(bits + x);
+		ImgVec newAlpha = ImgVec_Div255(ImgVec_Mul16(ImgVec_Srl<24>(color), scale));
+		ImgVec_Store(bits + x, ImgVec_Or(ImgVec_And(color, colorMask), ImgVec_Sll<24>(newAlpha)));
+	}
+	return x;
+}
+
+static int SwapRAndBRow_Simd(uint32* bits, int count)
+{
+	ImgVec keepMask = ImgVec_Splat((int)0xFF00FF00);
+	ImgVec lowMask = ImgVec_Splat(0xFF);
+	int x = 0;
+	for (; x + BF_IMG_SIMD_WIDTH <= count; x += BF_IMG_SIMD_WIDTH)
+	{
+		ImgVec color = ImgVec_Load(bits + x);
+		ImgVec swapped = ImgVec_Or(ImgVec_And(ImgVec_Srl<16>(color), lowMask), ImgVec_Sll<16>(ImgVec_And(color, lowMask)));
+		ImgVec_Store(bits + x, ImgVec_Or(ImgVec_And(color, keepMask), swapped));
+	}
+	return x;
+}
+
+static int PremultiplyAlphaRow_Simd(uint32* bits, int count, bool isAdditive)
+{
+	ImgVec alphaMask = ImgVec_Splat(isAdditive ? 0 : (int)0xFF000000);
+	int x = 0;
+	for (; x + BF_IMG_SIMD_WIDTH <= count; x += BF_IMG_SIMD_WIDTH)
+	{
+		ImgVec color = ImgVec_Load(bits + x);
+		ImgVec alpha = ImgVec_Srl<24>(color);
+		ImgVec result = ImgVec_And(color, alphaMask);
+		for (int shift = 0; shift <= 16; shift += 8)
+			result = ImgVec_Or(result, ImgVec_PutChannel(ImgVec_Div255(ImgVec_Mul16(ImgVec_Channel(color, shift), alpha)), shift));
+		ImgVec_Store(bits + x, result);
+	}
+	return x;
+}
+
+#define BF_IMG_SIMD_ENABLED() ((gImageProcessFlags & ImageProcessFlag_NoSimd) == 0)
+
+#else
+
+static int BlendRow_Normal_Simd(uint32* dest, const uint32* src, int count, const int* srcAlphaTable) { return 0; }
+static int MixRow_Simd(uint32* out, const uint32* top, const uint32* bot, const uint32* alphaBits, int constAlpha, int count) { return 0; }
+static int MultiplyAlphaRow_Simd(uint32* bits, const uint32* alphaBits, int constAlpha, int count) { return 0; }
+static int SwapRAndBRow_Simd(uint32* bits, int count) { return 0; }
+static int PremultiplyAlphaRow_Simd(uint32* bits, int count, bool isAdditive) { return 0; }
+
+#define BF_IMG_SIMD_ENABLED() false
+
+#endif
+
+void Beefy::SwapRAndBRow(uint32* bits, int count)
+{
+	int x = 0;
+	if (BF_IMG_SIMD_ENABLED())
+		x = SwapRAndBRow_Simd(bits, count);
+	for (; x < count; x++)
+	{
+		uint32 color = bits[x];
+		bits[x] = (color & 0xFF00FF00) | ((color >> 16) & 0xFF) | ((color & 0xFF) << 16);
+	}
+}
+
+void Beefy::PremultiplyAlphaRow(uint32* bits, int count, bool isAdditive)
+{
+	int x = 0;
+	if (BF_IMG_SIMD_ENABLED())
+		x = PremultiplyAlphaRow_Simd(bits, count, isAdditive);
+	for (; x < count; x++)
+	{
+		PackedColor* packedColor = (PackedColor*)(bits + x);
+		packedColor->r = (packedColor->r * packedColor->a) / 255;
+		packedColor->g = (packedColor->g * packedColor->a) / 255;
+		packedColor->b = (packedColor->b * packedColor->a) / 255;
+		if (isAdditive)
+			packedColor->a = 0;
+	}
+}
+
+static void MultiplyAlphaRow(uint32* bits, const uint32* alphaBits, int constAlpha, int count)
+{
+	int x = 0;
+	if (BF_IMG_SIMD_ENABLED())
+		x = MultiplyAlphaRow_Simd(bits, alphaBits, constAlpha, count);
+	for (; x < count; x++)
+	{
+		PackedColor* aColor = (PackedColor*)(bits + x);
+		int scale = (alphaBits != NULL) ? (int)(alphaBits[x] >> 24) : constAlpha;
+		aColor->a = aColor->a * scale / 255;
+	}
+}
+
+static void MixRow(uint32* out, const uint32* top, const uint32* bot, const uint32* alphaBits, int constAlpha, int count)
+{
+	int x = 0;
+	if (BF_IMG_SIMD_ENABLED())
+		x = MixRow_Simd(out, top, bot, alphaBits, constAlpha, count);
+	for (; x < count; x++)
+	{
+		PackedColor* topColor = (PackedColor*)(top + x);
+		PackedColor* botColor = (PackedColor*)(bot + x);
+		int a = (alphaBits != NULL) ? (int)(alphaBits[x] >> 24) : constAlpha;
+		int oma = 255 - a;
+
+		int newDestAlpha = ((topColor->a * a) + (botColor->a * oma)) / 255;
+		if (newDestAlpha != 0)
+		{
+			int ca = (255 * topColor->a * a) / ((topColor->a * a) + (botColor->a * oma));
+			int coma = 255 - ca;
+
+			PackedColor mixedColor;
+			mixedColor.a = newDestAlpha;
+			mixedColor.r = ((topColor->r * ca) + (botColor->r * coma)) / 255;
+			mixedColor.g = ((topColor->g * ca) + (botColor->g * coma)) / 255;
+			mixedColor.b = ((topColor->b * ca) + (botColor->b * coma)) / 255;
+			*(PackedColor*)(out + x) = mixedColor;
+		}
+	}
+}
+
 #define Blend_Apply(Blend_Channel) \
 	aBlendedColor.r = Blend_Channel((int) aDestColor->r, (int) aSrcColor->r); \
 	aBlendedColor.g = Blend_Channel((int) aDestColor->g, (int) aSrcColor->g); \
@@ -175,22 +503,17 @@ void Beefy::CrossfadeImage(ImageData* origImage, ImageData* newImage, float opac
 	AutoPerf gPerf("Beefy::CrossfadeImage");
 
 	int a = (int) (opacity * 255 + 0.5f);
-	int oma = 255 - a;
 
 	if (a == 255) // No crossfade needed
 		return;
 
 	if (origImage == NULL)
 	{
-		for (int y = newImage->mY; y < newImage->mY + newImage->mHeight; y++)
-		{
-			for (int x = newImage->mX; x < newImage->mX + newImage->mWidth; x++)
+		ImageParallelRows(newImage->mHeight, newImage->mWidth, [&](int startY, int endY)
 			{
-				PackedColor* aDest = (PackedColor*) &newImage->mBits[(x - newImage->mX) + (y - newImage->mY)*newImage->mWidth];
-				aDest->a = (aDest->a * a) / 255;
-				aDest++;
-			}
-		}
+				for (int y = startY; y < endY; y++)
+					MultiplyAlphaRow(newImage->mBits + y * newImage->mWidth, NULL, a, newImage->mWidth);
+			});
 	}
 	else
 	{		
@@ -233,30 +556,15 @@ void Beefy::CrossfadeImage(ImageData* origImage, ImageData* newImage, float opac
 			}
 		}
 
-		for (int y = origImage->mY; y < origImage->mY + origImage->mHeight; y++)
-		{
-			for (int x = origImage->mX; x < origImage->mX + origImage->mWidth; x++)
-			{			
-				PackedColor* aDest = (PackedColor*) &newImage->mBits[(x - newImage->mX) + (y - newImage->mY)*newImage->mWidth];
-				PackedColor* aSrc = (PackedColor*) &origImage->mBits[(x - origImage->mX) + (y - origImage->mY)*origImage->mWidth];
-
-				int newDestAlpha = ((aDest->a * a) + (aSrc->a * oma)) / 255;
-				
-				if (newDestAlpha != 0)
+		ImageParallelRows(origImage->mHeight, origImage->mWidth, [&](int startY, int endY)
+			{
+				for (int y = origImage->mY + startY; y < origImage->mY + endY; y++)
 				{
-					int ca = (255 * a * aDest->a) / (aDest->a * a + aSrc->a * oma);					
-					int coma = 255 - ca;
-
-					aDest->a = newDestAlpha;
-					aDest->r = ((aDest->r * ca) + (aSrc->r * coma)) / 255;
-					aDest->g = ((aDest->g * ca) + (aSrc->g * coma)) / 255;
-					aDest->b = ((aDest->b * ca) + (aSrc->b * coma)) / 255;
+					uint32* aDest = &newImage->mBits[(origImage->mX - newImage->mX) + (y - newImage->mY)*newImage->mWidth];
+					uint32* aSrc = &origImage->mBits[(y - origImage->mY)*origImage->mWidth];
+					MixRow(aDest, aDest, aSrc, NULL, a, origImage->mWidth);
 				}
-								
-				aSrc++;
-				aDest++;
-			}
-		}
+			});
 	}
 }
 
@@ -352,41 +660,26 @@ static void BlendImage_Fast(ImageData* dest, ImageData* src, int destX, int dest
 	BlendImage_Fast_T<BlendGetColor_Normal, BlendMix_Normal>(dest, src, destX, destY, alpha, mixType, fullAlpha);
 }
 
-void Beefy::BlendImage(ImageData* dest, ImageData* src, int destX, int destY, float alpha, int mixType, bool fullAlpha)
-{	
-	/*BlendImage_Fast(dest, src, destX, destY, alpha, mixType, fullAlpha);
-	return;*/
-
-	AutoPerf gPerf("Beefy::BlendImage");
-
-	BF_ASSERT(destX >= 0);
-	BF_ASSERT(destY >= 0);
-	BF_ASSERT(destX + src->mWidth <= dest->mWidth);
-	BF_ASSERT(destY + src->mHeight <= dest->mHeight);
-
-	if (!gDissolveInitialized)
-	{
-		for (int i = 0; i < DISSOLVE_SIZE; i++)
-			gDissolveTable[i] = rand() % 1023;
-		gDissolveInitialized = true;
-
-		for (int i = 0; i < 256; i++)		
-			gSqrtTable[i] = (int) (sqrt(i / 255.0f) * 255.0f + 0.5f);		
-	}
-
-	int aBlendAlpha = (int) (255 * alpha);	
-
-	for (int y = 0; y < src->mHeight; y++)
+// Rows are independent of each other - the dissolve pattern only depends on the pixel position - so BlendImage splits
+//  them into bands across threads
+static void BlendImageRows(ImageData* dest, ImageData* src, int destX, int destY, float alpha, int mixType, int aBlendAlpha, const int* srcAlphaTable, bool useSimd, int startY, int endY)
+{
+	for (int y = startY; y < endY; y++)
 	{
 		PackedColor* aSrcColor = (PackedColor*) (src->mBits + (y * src->mWidth));
 		PackedColor* aDestColor = (PackedColor*) (dest->mBits + destX + (y + destY) * dest->mWidth);
 
-		for (int x = 0; x < src->mWidth; x++)
-		{	
-			int aSrcAlpha = (int) (aSrcColor->a * alpha + 0.5f);
+		int x = 0;
+		if (useSimd)
+		{
+			x = BlendRow_Normal_Simd((uint32*)aDestColor, (uint32*)aSrcColor, src->mWidth, srcAlphaTable);
+			aSrcColor += x;
+			aDestColor += x;
+		}
 
-			if (fullAlpha)
-				aSrcAlpha = (int) (alpha * 255 + 0.5f);
+		for (; x < src->mWidth; x++)
+		{	
+			int aSrcAlpha = srcAlphaTable[aSrcColor->a];
 
 			PackedColor aBlendedColor = *aSrcColor;
 			aBlendedColor.a = aSrcAlpha;
@@ -1027,36 +1320,60 @@ void Beefy::BlendImage(ImageData* dest, ImageData* src, int destX, int destY, fl
 	}
 }
 
-void Beefy::BlendImagesTogether(ImageData* bottomImage, ImageData* topImage, ImageData* alphaImage)
-{
-	for (int y = alphaImage->mY; y < alphaImage->mY + alphaImage->mHeight; y++)
+void Beefy::BlendImage(ImageData* dest, ImageData* src, int destX, int destY, float alpha, int mixType, bool fullAlpha)
+{	
+	/*BlendImage_Fast(dest, src, destX, destY, alpha, mixType, fullAlpha);
+	return;*/
+
+	AutoPerf gPerf("Beefy::BlendImage");
+
+	BF_ASSERT(destX >= 0);
+	BF_ASSERT(destY >= 0);
+	BF_ASSERT(destX + src->mWidth <= dest->mWidth);
+	BF_ASSERT(destY + src->mHeight <= dest->mHeight);
+
+	if (!gDissolveInitialized)
 	{
-		PackedColor* topColor = (PackedColor*) (topImage->mBits + (alphaImage->mX - topImage->mX) + ((y - topImage->mY) * topImage->mWidth));
-		PackedColor* botColor = (PackedColor*) (bottomImage->mBits + (alphaImage->mX - bottomImage->mX) + ((y - bottomImage->mY) * bottomImage->mWidth));
-		PackedColor* alphaColor = (PackedColor*) (alphaImage->mBits + (alphaImage->mX - alphaImage->mX) + ((y - alphaImage->mY) * alphaImage->mWidth));
+		for (int i = 0; i < DISSOLVE_SIZE; i++)
+			gDissolveTable[i] = rand() % 1023;
+		gDissolveInitialized = true;
 
-		for (int x = 0; x < alphaImage->mWidth; x++)
+		for (int i = 0; i < 256; i++)		
+			gSqrtTable[i] = (int) (sqrt(i / 255.0f) * 255.0f + 0.5f);		
+	}
+
+	int aBlendAlpha = (int) (255 * alpha);	
+
+	// Computed once so the scalar and SIMD paths are guaranteed to agree on every source alpha
+	int srcAlphaTable[256];
+	for (int i = 0; i < 256; i++)
+	{
+		srcAlphaTable[i] = (int) (i * alpha + 0.5f);
+		if (fullAlpha)
+			srcAlphaTable[i] = (int) (alpha * 255 + 0.5f);
+	}
+
+	bool useSimd = ((mixType == 'Nrml') || (mixType == 'norm')) && (BF_IMG_SIMD_ENABLED()) &&
+		(srcAlphaTable[0] >= 0) && (srcAlphaTable[255] <= 255);
+
+	ImageParallelRows(src->mHeight, src->mWidth, [&](int startY, int endY)
 		{
-			int a = alphaColor->a;
-			int oma = 255 - a;
+			BlendImageRows(dest, src, destX, destY, alpha, mixType, aBlendAlpha, srcAlphaTable, useSimd, startY, endY);
+		});
+}
 
-			int newDestAlpha = ((topColor->a * a) + (botColor->a * oma)) / 255;				
-			if (newDestAlpha != 0)
+void Beefy::BlendImagesTogether(ImageData* bottomImage, ImageData* topImage, ImageData* alphaImage)
+{
+	ImageParallelRows(alphaImage->mHeight, alphaImage->mWidth, [&](int startY, int endY)
+		{
+			for (int y = alphaImage->mY + startY; y < alphaImage->mY + endY; y++)
 			{
-				int ca = (255 * topColor->a * a) / ((topColor->a * a) + (botColor->a * oma));
-				int coma = 255 - ca;
-
-				botColor->a = newDestAlpha;
-				botColor->r = ((topColor->r * ca) + (botColor->r * coma)) / 255;
-				botColor->g = ((topColor->g * ca) + (botColor->g * coma)) / 255;
-				botColor->b = ((topColor->b * ca) + (botColor->b * coma)) / 255;
+				uint32* topColor = topImage->mBits + (alphaImage->mX - topImage->mX) + ((y - topImage->mY) * topImage->mWidth);
+				uint32* botColor = bottomImage->mBits + (alphaImage->mX - bottomImage->mX) + ((y - bottomImage->mY) * bottomImage->mWidth);
+				uint32* alphaColor = alphaImage->mBits + ((y - alphaImage->mY) * alphaImage->mWidth);
+				MixRow(botColor, topColor, botColor, alphaColor, 0, alphaImage->mWidth);
 			}
-			
-			topColor++;
-			botColor++;
-			alphaColor++;
-		}
-	}
+		});
 }
 
 void Beefy::SetImageAlpha(ImageData* image, ImageData* alphaImage)
@@ -1080,18 +1397,15 @@ void Beefy::SetImageAlpha(ImageData* image, ImageData* alphaImage)
 
 void Beefy::MultiplyImageAlpha(ImageData* image, ImageData* alphaImage)
 {	
-	for (int y = alphaImage->mY; y < alphaImage->mY + alphaImage->mHeight; y++)
-	{
-		PackedColor* aColor = (PackedColor*) (image->mBits + (alphaImage->mX - image->mX) + ((y - image->mY) * image->mWidth));		
-		PackedColor* alphaColor = (PackedColor*) (alphaImage->mBits + (alphaImage->mX - alphaImage->mX) + ((y - alphaImage->mY) * alphaImage->mWidth));
-
-		for (int x = 0; x < alphaImage->mWidth; x++)
+	ImageParallelRows(alphaImage->mHeight, alphaImage->mWidth, [&](int startY, int endY)
 		{
-			aColor->a = aColor->a * alphaColor->a / 255;
-			aColor++;
-			alphaColor++;
-		}
-	}
+			for (int y = alphaImage->mY + startY; y < alphaImage->mY + endY; y++)
+			{
+				uint32* aColor = image->mBits + (alphaImage->mX - image->mX) + ((y - image->mY) * image->mWidth);
+				uint32* alphaColor = alphaImage->mBits + ((y - alphaImage->mY) * alphaImage->mWidth);
+				MultiplyAlphaRow(aColor, alphaColor, 0, alphaImage->mWidth);
+			}
+		});
 }
 
 void Beefy::SetImageAlpha(ImageData* image, int alpha)
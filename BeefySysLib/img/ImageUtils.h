@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Common.h"
+#include <functional>
 
 NS_BF_BEGIN;
 
@@ -38,6 +39,25 @@ public:
 	int operator()(PackedColor color) { return ((color.r * 300) + (color.g * 586) + (color.b * 113)) / 1000; }
 };
 
+enum ImageProcessFlags
+{
+	ImageProcessFlag_None = 0,
+	ImageProcessFlag_NoSimd = 1, // Use the scalar per-pixel loops
+	ImageProcessFlag_NoThreads = 2, // Run everything on the calling thread
+	ImageProcessFlag_LibPNG = 4, // Encode every PNG through libpng rather than the fast encoder
+	ImageProcessFlag_FastPNGDecode = 8 // Decode PNGs with the fast path, which hasn't measured faster than libpng yet
+};
+
+extern int gImageProcessFlags;
+
+// Splits [0, height) into bands of rows through ThreadPool::ParallelFor. Rows must be independent of each other.
+//  'pixelsPerRow' sizes the bands so small images just run inline.
+void ImageParallelRows(int height, int pixelsPerRow, const std::function<void(int startY, int endY)>& func);
+
+// Per-row kernels behind ImageData::SwapRAndB and ImageData::PremultiplyAlpha, for decoders that fix up rows as they go
+void SwapRAndBRow(uint32* bits, int count);
+void PremultiplyAlphaRow(uint32* bits, int count, bool isAdditive);
+
 ImageData* CreateResizedImageUnion(ImageData* src, int x, int y, int width, int height);
 ImageData* CreateEmptyResizedImageUnion(ImageData* src, int x, int y, int width, int height);
 void CrossfadeImage(ImageData* origImage, ImageData* newImage, float opacity);
@@ -269,91 +269,96 @@ static void BoxBlur(uint32* in, uint32* out, int width, int height, float radius
 	
 	int div = (2*r+1)*256 + a*2;
 
-	int inIndex = 0;
-
+	// Each input row writes its own output column, so bands of rows can run in parallel
 	if (radius > 1)
 	{
-		for ( int y = 0; y < height; y++ ) 
-		{
-			int outIndex = y;
-			uint32 ta = 0;
-
-			for ( int i = -r; i <= r; i++ ) 
+		ImageParallelRows(height, width, [&](int startY, int endY)
 			{
-				int rgb = BOXBLUR_IN(i);
-				ta += rgb * 256;
-			}
-			ta += a * BOXBLUR_IN(-r-1);
-			ta += a * BOXBLUR_IN(r+1);
+				for ( int y = startY; y < endY; y++ ) 
+				{
+					int inIndex = y * width;
+					int outIndex = y;
+					uint32 ta = 0;
 
-			for ( int x = 0; x < width; x++ ) 
-			{
-				out[outIndex] = ta / div;
+					for ( int i = -r; i <= r; i++ ) 
+					{
+						int rgb = BOXBLUR_IN(i);
+						ta += rgb * 256;
+					}
+					ta += a * BOXBLUR_IN(-r-1);
+					ta += a * BOXBLUR_IN(r+1);
 
-				uint32 r1Value = edgeValue;
-				uint32 r2Value = edgeValue;
-				int r1 = x+r+1;
-				int r2 = r1+1;
-				if (r2 < width)
-				{
-					r1Value = in[inIndex + r1];
-					r2Value = in[inIndex + r2];
-				}
-				else if (r1 < width)
-				{
-					r1Value = in[inIndex + r1];
-				}
+					for ( int x = 0; x < width; x++ ) 
+					{
+						out[outIndex] = ta / div;
+
+						uint32 r1Value = edgeValue;
+						uint32 r2Value = edgeValue;
+						int r1 = x+r+1;
+						int r2 = r1+1;
+						if (r2 < width)
+						{
+							r1Value = in[inIndex + r1];
+							r2Value = in[inIndex + r2];
+						}
+						else if (r1 < width)
+						{
+							r1Value = in[inIndex + r1];
+						}
 
-				uint32 l1Value = edgeValue;
-				uint32 l2Value = edgeValue;
-				int l1 = x-r-1;
-				int l2 = l1+1;
+						uint32 l1Value = edgeValue;
+						uint32 l2Value = edgeValue;
+						int l1 = x-r-1;
+						int l2 = l1+1;
 				
-				if (l1 >= 0)
-				{
-					l1Value = in[inIndex + l1];
-					l2Value = in[inIndex + l2];
-				}
-				else if (l2 >= 0)
-				{
-					l2Value = in[inIndex + l2];
-				}
+						if (l1 >= 0)
+						{
+							l1Value = in[inIndex + l1];
+							l2Value = in[inIndex + l2];
+						}
+						else if (l2 >= 0)
+						{
+							l2Value = in[inIndex + l2];
+						}
 
-				int rgbL = (l1Value * a) + (l2Value * oma);
-				int rgbR = (r1Value * oma) + (r2Value * a);
+						int rgbL = (l1Value * a) + (l2Value * oma);
+						int rgbR = (r1Value * oma) + (r2Value * a);
 
-				ta += rgbR;
-				ta -= rgbL;
-				outIndex += height;
-			}
-			inIndex += width;
-		}	
+						ta += rgbR;
+						ta -= rgbL;
+						outIndex += height;
+					}
+				}	
+			});
 	}
 	else
 	{
-		for ( int y = 0; y < height; y++ ) 
-		{
-			int outIndex = y;
+		ImageParallelRows(height, width, [&](int startY, int endY)
+			{
+				for ( int y = startY; y < endY; y++ ) 
+				{
+					int inIndex = y * width;
+					int outIndex = y;
 			
-			for ( int x = 0; x < width; x++ ) 
-			{				
-				int r = x+1;
-				if (r > widthMinus1)
-					r = widthMinus1;
+					for ( int x = 0; x < width; x++ ) 
+					{				
+						int r = x+1;
+						if (r > widthMinus1)
+							r = widthMinus1;
 				
-				int l = x-1;
-				if (l < 0)
-					l = 0;
+						int l = x-1;
+						if (l < 0)
+							l = 0;
 			
-				int rgbL = in[inIndex+l] * a;
-				int rgbR = in[inIndex+r] * a;
-				int rgbM = in[inIndex+x] * 256;
+						int rgbL = in[inIndex+l] * a;
+						int rgbR = in[inIndex+r] * a;
+						int rgbM = in[inIndex+x] * 256;
 
-				out[outIndex] = (rgbL + rgbM + rgbR) / div;
-				outIndex += height;
-			}
-			inIndex += width;
-		}	
+						out[outIndex] = (rgbL + rgbM + rgbR) / div;
+						outIndex += height;
+					}
+				}	
+			});
 	}
 }
 
@@ -2695,43 +2700,49 @@ void ImageStrokeEffect::Apply(PSDLayerInfo* layerInfo, ImageData* imageData, Ima
 	float rad = blurRadius;
 	int inf = (int) (blurRadius + 2) * 256;
 	
-	for (int i = 0; i < aSize; i++)
-	{	
-		float dist = aDest[i] / 256.0f;		
-		dist -= 0.001f;
-
-		if (dist < 0)
-		{			
-			exterior[i] = inf;
-			anInterior[i] = 0;
-		}
-		else if (dist < 1.0f)
+	ImageParallelRows(h, w, [&](int startY, int endY)
 		{
-			exterior[i] = BFClamp((int) ((1.0f - dist) * 256.0f), 0, 0xFF);								
-			anInterior[i] = (int) (dist * 256);
-		}
-		else
-		{
-			exterior[i] = 0;
-			anInterior[i] = (int) (dist * 256);
-		}
-	}	
+			for (int i = startY * w; i < endY * w; i++)
+			{	
+				float dist = aDest[i] / 256.0f;		
+				dist -= 0.001f;
+
+				if (dist < 0)
+				{			
+					exterior[i] = inf;
+					anInterior[i] = 0;
+				}
+				else if (dist < 1.0f)
+				{
+					exterior[i] = BFClamp((int) ((1.0f - dist) * 256.0f), 0, 0xFF);								
+					anInterior[i] = (int) (dist * 256);
+				}
+				else
+				{
+					exterior[i] = 0;
+					anInterior[i] = (int) (dist * 256);
+				}
+			}	
+		});
 	
 	ChamferedDistanceTransform(exterior, w, h);
 
-	for (int i = 0; i < aSize; i++)
-	{
-		float distInterior = (anInterior[i] / 256.0f) - rad;
-		float distExterior = (exterior[i] / 256.0f) - rad;
-		float maxDist = std::max(distInterior, distExterior);		
-
-		if (maxDist < 0)
-			aDest[i] = 0xFF000000;
-		else if (maxDist < 1.0f)
-			aDest[i] = ((int) (255.0f * (1.0f - maxDist))) << 24;
-		else
-			aDest[i] = 0;
-	}
+	ImageParallelRows(h, w, [&](int startY, int endY)
+		{
+			for (int i = startY * w; i < endY * w; i++)
+			{
+				float distInterior = (anInterior[i] / 256.0f) - rad;
+				float distExterior = (exterior[i] / 256.0f) - rad;
+				float maxDist = std::max(distInterior, distExterior);		
+
+				if (maxDist < 0)
+					aDest[i] = 0xFF000000;
+				else if (maxDist < 1.0f)
+					aDest[i] = ((int) (255.0f * (1.0f - maxDist))) << 24;
+				else
+					aDest[i] = 0;
+			}
+		});
 
 	tempImage->mX = destImageData->mX;
 	tempImage->mY = destImageData->mY;
@@ -2743,13 +2754,8 @@ void ImageStrokeEffect::Apply(PSDLayerInfo* layerInfo, ImageData* imageData, Ima
 	else
 		mColorFill.Apply(layerInfo, imageData, destImageData);
 
-	for (int i = 0; i < aSize; i++)
-	{		
-		uint32 srcAlpha = tempImage->mBits[i] >> 24;
-		uint32 destAlpha = destImageData->mBits[i] >> 24;
-
-		destImageData->mBits[i] = ((int) (srcAlpha * destAlpha / 255 + 0.5f) << 24) | (destImageData->mBits[i] & 0x00FFFFFF);
-	}
+	// Same as 'srcAlpha * destAlpha / 255' per pixel
+	MultiplyImageAlpha(destImageData, tempImage);
 
 	delete tempImage;
 }
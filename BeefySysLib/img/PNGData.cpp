@@ -1,5 +1,19 @@
 #include "PNGData.h"
+#include "ImageUtils.h"
 #include "third_party/png/png.h"
+#include <vector>
+
+// The fast decoder parses the chunks itself, inflates with zlib and unfilters 8-bit non-interlaced images, leaving
+//  everything else to libpng. It's opt-in through ImageProcessFlag_FastPNGDecode since it hasn't measured faster yet.
+//  Writing filters rows on the shared worker pool and deflates bands of rows in parallel, each band going out as its
+//  own IDAT chunk. Define BF_IMG_NO_SIMD to compile out the SSE2 filters.
+
+#if !defined BF_IMG_NO_SIMD
+#if (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_PNG_SSE2
+#include <emmintrin.h>
+#endif
+#endif
 
 USING_NS_BF;
 
@@ -30,8 +44,610 @@ PNGData::PNGData()
 	mReadPos = 0;
 }
 
+//
+
+enum PNGFilter
+{
+	PNGFilter_None,
+	PNGFilter_Sub,
+	PNGFilter_Up,
+	PNGFilter_Avg,
+	PNGFilter_Paeth,
+
+	PNGFilter_COUNT
+};
+
+static const uint8 gPNGSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+static uint32 PNGReadBE32(const uint8* ptr)
+{
+	return ((uint32)ptr[0] << 24) | ((uint32)ptr[1] << 16) | ((uint32)ptr[2] << 8) | (uint32)ptr[3];
+}
+
+static void PNGWriteBE32(uint8* ptr, uint32 val)
+{
+	ptr[0] = (uint8)(val >> 24);
+	ptr[1] = (uint8)(val >> 16);
+	ptr[2] = (uint8)(val >> 8);
+	ptr[3] = (uint8)val;
+}
+
+static bool PNGWriteChunk(FILE* fp, const char* chunkType, const uint8* data, int dataLen)
+{
+	uint8 header[8];
+	PNGWriteBE32(header, (uint32)dataLen);
+	memcpy(header + 4, chunkType, 4);
+	uLong chunkCRC = crc32(crc32(0, NULL, 0), header + 4, 4);
+	if (dataLen > 0)
+		chunkCRC = crc32(chunkCRC, data, dataLen);
+	uint8 crc[4];
+	PNGWriteBE32(crc, (uint32)chunkCRC);
+	return (fwrite(header, 1, 8, fp) == 8) && ((dataLen == 0) || (fwrite(data, 1, dataLen, fp) == (size_t)dataLen)) &&
+		(fwrite(crc, 1, 4, fp) == 4);
+}
+
+// The adler32 of two concatenated buffers from their separate checksums, as zlib 1.2's adler32_combine does
+static uint32 PNGCombineAdler32(uint32 adler1, uint32 adler2, uint64 len2)
+{
+	const uint32 base = 65521;
+	uint32 rem = (uint32)(len2 % base);
+	uint32 sum1 = adler1 & 0xFFFF;
+	uint32 sum2 = (rem * sum1) % base;
+	sum1 += (adler2 & 0xFFFF) + base - 1;
+	sum2 += ((adler1 >> 16) & 0xFFFF) + ((adler2 >> 16) & 0xFFFF) + base - rem;
+	if (sum1 >= base)
+		sum1 -= base;
+	if (sum1 >= base)
+		sum1 -= base;
+	if (sum2 >= (base << 1))
+		sum2 -= (base << 1);
+	if (sum2 >= base)
+		sum2 -= base;
+	return sum1 | (sum2 << 16);
+}
+
+static inline int PNGPaeth(int a, int b, int c)
+{
+	int pa = abs(b - c);
+	int pb = abs(a - c);
+	int pc = abs(a + b - 2 * c);
+	if ((pa <= pb) && (pa <= pc))
+		return a;
+	return (pb <= pc) ? b : c;
+}
+
+static inline uint32 PNGFilterCost(uint8 val)
+{
+	return (val < 128) ? val : 256 - val;
+}
+
+// Undoes a row's filter. 'dest' may be 'src', and 'prev' is the previous unfiltered row or zeros for the first row.
+static void PNGUnfilterRow_Scalar(int filter, uint8* dest, const uint8* src, const uint8* prev, int rowBytes, int bpp)
+{
+	switch (filter)
+	{
+	case PNGFilter_None:
+		if (dest != src)
+			memcpy(dest, src, rowBytes);
+		break;
+	case PNGFilter_Sub:
+		for (int i = 0; i < rowBytes; i++)
+			dest[i] = (uint8)(src[i] + ((i >= bpp) ? dest[i - bpp] : 0));
+		break;
+	case PNGFilter_Up:
+		for (int i = 0; i < rowBytes; i++)
+			dest[i] = (uint8)(src[i] + prev[i]);
+		break;
+	case PNGFilter_Avg:
+		for (int i = 0; i < rowBytes; i++)
+			dest[i] = (uint8)(src[i] + ((((i >= bpp) ? dest[i - bpp] : 0) + prev[i]) >> 1));
+		break;
+	case PNGFilter_Paeth:
+		for (int i = 0; i < rowBytes; i++)
+			dest[i] = (uint8)(src[i] + ((i >= bpp) ? PNGPaeth(dest[i - bpp], prev[i], prev[i - bpp]) : prev[i]));
+		break;
+	}
+}
+
+// Filters 'src' into 'dest' and returns the sum of the output bytes taken as signed magnitudes, which is the measure
+//  libpng picks a row's filter by
+static uint32 PNGFilterRow_Scalar(int filter, uint8* dest, const uint8* src, const uint8* prev, int rowBytes, int bpp, int startIdx)
+{
+	uint32 cost = 0;
+	for (int i = startIdx; i < rowBytes; i++)
+	{
+		int left = (i >= bpp) ? src[i - bpp] : 0;
+		int upLeft = (i >= bpp) ? prev[i - bpp] : 0;
+		uint8 val = src[i];
+		switch (filter)
+		{
+		case PNGFilter_Sub: val -= left; break;
+		case PNGFilter_Up: val -= prev[i]; break;
+		case PNGFilter_Avg: val -= (uint8)((left + prev[i]) >> 1); break;
+		case PNGFilter_Paeth: val -= (uint8)PNGPaeth(left, prev[i], upLeft); break;
+		}
+		dest[i] = val;
+		cost += PNGFilterCost(val);
+	}
+	return cost;
+}
+
+#ifdef BF_PNG_SSE2
+
+static inline __m128i PNGLoadPixel(const uint8* ptr, int bpp)
+{
+	int val = 0;
+	memcpy(&val, ptr, bpp);
+	return _mm_cvtsi32_si128(val);
+}
+
+static inline void PNGStorePixel(uint8* ptr, __m128i pixel, int bpp)
+{
+	int val = _mm_cvtsi128_si32(pixel);
+	memcpy(ptr, &val, bpp);
+}
+
+static inline __m128i PNGSelect(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline __m128i PNGAbs16(__m128i val)
+{
+	return _mm_max_epi16(val, _mm_sub_epi16(_mm_setzero_si128(), val));
+}
+
+// Rounds down like the PNG spec where _mm_avg_epu8 rounds up
+static inline __m128i PNGAvg(__m128i a, __m128i b)
+{
+	return _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+}
+
+// Picks a, b or c per 16-bit lane, breaking ties the same way as PNGPaeth
+static inline __m128i PNGPaeth16(__m128i a, __m128i b, __m128i c)
+{
+	__m128i pa = _mm_sub_epi16(b, c);
+	__m128i pb = _mm_sub_epi16(a, c);
+	__m128i pc = PNGAbs16(_mm_add_epi16(pa, pb));
+	pa = PNGAbs16(pa);
+	pb = PNGAbs16(pb);
+	__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+	return PNGSelect(_mm_cmpeq_epi16(smallest, pa), a, PNGSelect(_mm_cmpeq_epi16(smallest, pb), b, c));
+}
+
+// Up works on 16 bytes at a time. The others depend on the pixel to their left, so they do one 3 or 4 byte pixel at a
+//  time with all its channels at once. Returns false when the scalar loop should handle the row.
+static bool PNGUnfilterRow_Simd(int filter, uint8* dest, const uint8* src, const uint8* prev, int rowBytes, int bpp)
+{
+	if (filter == PNGFilter_Up)
+	{
+		int i = 0;
+		for (; i + 16 <= rowBytes; i += 16)
+			_mm_storeu_si128((__m128i*)(dest + i), _mm_add_epi8(_mm_loadu_si128((const __m128i*)(src + i)), _mm_loadu_si128((const __m128i*)(prev + i))));
+		for (; i < rowBytes; i++)
+			dest[i] = (uint8)(src[i] + prev[i]);
+		return true;
+	}
+	if (((bpp != 3) && (bpp != 4)) || (filter == PNGFilter_None))
+		return false;
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i a = zero;
+	__m128i c = zero;
+	switch (filter)
+	{
+	case PNGFilter_Sub:
+		for (int i = 0; i < rowBytes; i += bpp)
+		{
+			a = _mm_add_epi8(a, PNGLoadPixel(src + i, bpp));
+			PNGStorePixel(dest + i, a, bpp);
+		}
+		break;
+	case PNGFilter_Avg:
+		for (int i = 0; i < rowBytes; i += bpp)
+		{
+			a = _mm_add_epi8(PNGAvg(a, PNGLoadPixel(prev + i, bpp)), PNGLoadPixel(src + i, bpp));
+			PNGStorePixel(dest + i, a, bpp);
+		}
+		break;
+	case PNGFilter_Paeth:
+		// a, b and c are widened to 16 bits. Adding with _epi8 wraps the low bytes and leaves the high bytes zero.
+		for (int i = 0; i < rowBytes; i += bpp)
+		{
+			__m128i b = _mm_unpacklo_epi8(PNGLoadPixel(prev + i, bpp), zero);
+			__m128i x = _mm_unpacklo_epi8(PNGLoadPixel(src + i, bpp), zero);
+			a = _mm_add_epi8(PNGPaeth16(a, b, c), x);
+			c = b;
+			PNGStorePixel(dest + i, _mm_packus_epi16(a, a), bpp);
+		}
+		break;
+	}
+	return true;
+}
+
+// Filtering only reads the source rows, so every byte can be done at once
+static uint32 PNGFilterRow_Simd(int filter, uint8* dest, const uint8* src, const uint8* prev, int rowBytes, int bpp)
+{
+	uint32 cost = PNGFilterRow_Scalar(filter, dest, src, prev, BF_MIN(bpp, rowBytes), bpp, 0);
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i costSum = zero;
+	int i = bpp;
+	for (; i + 16 <= rowBytes; i += 16)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i left = _mm_loadu_si128((const __m128i*)(src + i - bpp));
+		__m128i up = _mm_loadu_si128((const __m128i*)(prev + i));
+		__m128i pred;
+		switch (filter)
+		{
+		case PNGFilter_Sub:
+			pred = left;
+			break;
+		case PNGFilter_Up:
+			pred = up;
+			break;
+		case PNGFilter_Avg:
+			pred = PNGAvg(left, up);
+			break;
+		default:
+			{
+				__m128i upLeft = _mm_loadu_si128((const __m128i*)(prev + i - bpp));
+				__m128i predLo = PNGPaeth16(_mm_unpacklo_epi8(left, zero), _mm_unpacklo_epi8(up, zero), _mm_unpacklo_epi8(upLeft, zero));
+				__m128i predHi = PNGPaeth16(_mm_unpackhi_epi8(left, zero), _mm_unpackhi_epi8(up, zero), _mm_unpackhi_epi8(upLeft, zero));
+				pred = _mm_packus_epi16(predLo, predHi);
+			}
+			break;
+		}
+		__m128i val = _mm_sub_epi8(x, pred);
+		_mm_storeu_si128((__m128i*)(dest + i), val);
+		costSum = _mm_add_epi64(costSum, _mm_sad_epu8(_mm_min_epu8(val, _mm_sub_epi8(zero, val)), zero));
+	}
+	cost += (uint32)_mm_cvtsi128_si32(costSum) + (uint32)_mm_cvtsi128_si32(_mm_srli_si128(costSum, 8));
+	return cost + PNGFilterRow_Scalar(filter, dest, src, prev, rowBytes, bpp, i);
+}
+
+#define BF_PNG_SIMD_ENABLED() ((gImageProcessFlags & ImageProcessFlag_NoSimd) == 0)
+
+#else
+
+static bool PNGUnfilterRow_Simd(int filter, uint8* dest, const uint8* src, const uint8* prev, int rowBytes, int bpp) { return false; }
+static uint32 PNGFilterRow_Simd(int filter, uint8* dest, const uint8* src, const uint8* prev, int rowBytes, int bpp) { return 0; }
+
+#define BF_PNG_SIMD_ENABLED() false
+
+#endif
+
+static void PNGUnfilterRow(int filter, uint8* dest, const uint8* src, const uint8* prev, int rowBytes, int bpp)
+{
+	if ((BF_PNG_SIMD_ENABLED()) && (PNGUnfilterRow_Simd(filter, dest, src, prev, rowBytes, bpp)))
+		return;
+	PNGUnfilterRow_Scalar(filter, dest, src, prev, rowBytes, bpp);
+}
+
+static uint32 PNGFilterRow(int filter, uint8* dest, const uint8* src, const uint8* prev, int rowBytes, int bpp)
+{
+	if (filter == PNGFilter_None)
+	{
+		memcpy(dest, src, rowBytes);
+		uint32 cost = 0;
+		for (int i = 0; i < rowBytes; i++)
+			cost += PNGFilterCost(src[i]);
+		return cost;
+	}
+	if (BF_PNG_SIMD_ENABLED())
+		return PNGFilterRow_Simd(filter, dest, src, prev, rowBytes, bpp);
+	return PNGFilterRow_Scalar(filter, dest, src, prev, rowBytes, bpp, 0);
+}
+
+// Turns an unfiltered row into our R, G, B, A byte order, the same as libpng's expansion does
+static void PNGExpandRow(int colorType, uint32* dest, const uint8* src, int width, const uint32* paletteColors)
+{
+	switch (colorType)
+	{
+	case 0: // Gray
+		for (int x = 0; x < width; x++)
+			dest[x] = 0xFF000000 | (src[x] * 0x010101);
+		break;
+	case 2: // RGB
+		for (int x = 0; x < width; x++, src += 3)
+			dest[x] = 0xFF000000 | ((uint32)src[2] << 16) | ((uint32)src[1] << 8) | src[0];
+		break;
+	case 3: // Palette
+		for (int x = 0; x < width; x++)
+			dest[x] = paletteColors[src[x]];
+		break;
+	case 4: // Gray and alpha
+		for (int x = 0; x < width; x++, src += 2)
+			dest[x] = ((uint32)src[1] << 24) | (src[0] * 0x010101);
+		break;
+	}
+}
+
+bool PNGData::ReadDataFast()
+{
+	const uint8* data = mSrcData;
+	int dataLen = mSrcDataLen;
+	if ((data == NULL) || (dataLen < 8) || (memcmp(data, gPNGSignature, 8) != 0))
+		return false;
+
+	int width = 0;
+	int height = 0;
+	int colorType = -1;
+	const uint8* palette = NULL;
+	int paletteLen = 0;
+	const uint8* transparency = NULL;
+	int transparencyLen = 0;
+	std::vector<std::pair<const uint8*, int> > dataChunks;
+
+	int pos = 8;
+	while (pos + 12 <= dataLen)
+	{
+		uint32 chunkLen = PNGReadBE32(data + pos);
+		const uint8* chunkType = data + pos + 4;
+		const uint8* chunkData = data + pos + 8;
+		if (chunkLen > (uint32)(dataLen - pos - 12))
+			return false;
+		// Critical chunks get their CRC checked like libpng does, ancillary ones aren't worth the time
+		if (((chunkType[0] & 0x20) == 0) && (crc32(crc32(0, NULL, 0), chunkType, chunkLen + 4) != PNGReadBE32(chunkData + chunkLen)))
+			return false;
+
+		if (memcmp(chunkType, "IHDR", 4) == 0)
+		{
+			if (chunkLen != 13)
+				return false;
+			width = (int)PNGReadBE32(chunkData);
+			height = (int)PNGReadBE32(chunkData + 4);
+			colorType = chunkData[9];
+			// 16-bit, low bit depth and interlaced images are left to libpng
+			if ((chunkData[8] != 8) || (chunkData[10] != 0) || (chunkData[11] != 0) || (chunkData[12] != 0))
+				return false;
+		}
+		else if (memcmp(chunkType, "PLTE", 4) == 0)
+		{
+			palette = chunkData;
+			paletteLen = (int)chunkLen / 3;
+		}
+		else if (memcmp(chunkType, "tRNS", 4) == 0)
+		{
+			transparency = chunkData;
+			transparencyLen = (int)chunkLen;
+		}
+		else if (memcmp(chunkType, "IDAT", 4) == 0)
+			dataChunks.push_back(std::make_pair(chunkData, (int)chunkLen));
+		else if (memcmp(chunkType, "IEND", 4) == 0)
+			break;
+		pos += (int)chunkLen + 12;
+	}
+
+	int channels;
+	switch (colorType)
+	{
+	case 0: channels = 1; break;
+	case 2: channels = 3; break;
+	case 3: channels = 1; break;
+	case 4: channels = 2; break;
+	case 6: channels = 4; break;
+	default: return false;
+	}
+	// Color-keyed transparency turns into an alpha channel in libpng's expansion
+	if ((transparency != NULL) && (colorType != 3))
+		return false;
+	if (((colorType == 3) && (palette == NULL)) || (dataChunks.empty()))
+		return false;
+	if ((width <= 0) || (height <= 0) || ((int64)width * height > 0x10000000))
+		return false;
+
+	uint32 paletteColors[256];
+	for (int colorIdx = 0; colorIdx < 256; colorIdx++)
+	{
+		if (colorIdx >= paletteLen)
+		{
+			paletteColors[colorIdx] = 0xFF000000;
+			continue;
+		}
+		const uint8* paletteEntry = palette + colorIdx * 3;
+		uint32 alpha = (colorIdx < transparencyLen) ? transparency[colorIdx] : 0xFF;
+		paletteColors[colorIdx] = (alpha << 24) | ((uint32)paletteEntry[2] << 16) | ((uint32)paletteEntry[1] << 8) | paletteEntry[0];
+	}
+
+	z_stream zStream;
+	memset(&zStream, 0, sizeof(zStream));
+	if (inflateInit(&zStream) != Z_OK)
+		return false;
+
+	// Rows are inflated one at a time so they're still in the cache when they get unfiltered. RGBA rows unfilter
+	//  straight into the image since our byte order matches, the rest unfilter in place and then expand.
+	int rowBytes = width * channels;
+	int filteredRowBytes = rowBytes + 1;
+	std::vector<uint8> rowBuffers(filteredRowBytes * 2);
+	std::vector<uint8> zeroRow(rowBytes);
+	uint32* bits = new uint32[width * height];
+	const uint8* prev = &zeroRow[0];
+	int chunkIdx = 0;
+	bool valid = true;
+	for (int y = 0; (y < height) && (valid); y++)
+	{
+		uint8* src = &rowBuffers[(y & 1) * filteredRowBytes];
+		zStream.next_out = src;
+		zStream.avail_out = (uInt)filteredRowBytes;
+		while (zStream.avail_out > 0)
+		{
+			if (zStream.avail_in == 0)
+			{
+				if (chunkIdx == (int)dataChunks.size())
+					break;
+				zStream.next_in = (Bytef*)dataChunks[chunkIdx].first;
+				zStream.avail_in = (uInt)dataChunks[chunkIdx].second;
+				chunkIdx++;
+			}
+			if (inflate(&zStream, Z_NO_FLUSH) != Z_OK)
+				break;
+		}
+
+		int filter = src[0];
+		if ((zStream.avail_out != 0) || (filter >= PNGFilter_COUNT))
+		{
+			valid = false;
+			break;
+		}
+		uint8* dest = (colorType == 6) ? (uint8*)(bits + y * width) : src + 1;
+		PNGUnfilterRow(filter, dest, src + 1, prev, rowBytes, channels);
+		if (colorType != 6)
+			PNGExpandRow(colorType, bits + y * width, dest, width, paletteColors);
+		prev = dest;
+	}
+	inflateEnd(&zStream);
+	if (!valid)
+	{
+		delete [] bits;
+		return false;
+	}
+
+	mWidth = width;
+	mHeight = height;
+	mBits = bits;
+	return true;
+}
+
+bool PNGData::WriteToFileFast(const StringImpl& path)
+{
+	if ((mBits == NULL) || (mWidth <= 0) || (mHeight <= 0))
+		return false;
+
+	// Our R, G, B, A byte order is already what an RGBA row holds
+	int rowBytes = mWidth * 4;
+	size_t filteredRowBytes = (size_t)rowBytes + 1;
+	std::vector<uint8> filtered(filteredRowBytes * mHeight);
+	std::vector<uint8> zeroRow(rowBytes);
+
+	ImageParallelRows(mHeight, mWidth, [&](int startY, int endY)
+	{
+		std::vector<uint8> trialRows(rowBytes * 2);
+		for (int y = startY; y < endY; y++)
+		{
+			const uint8* src = (const uint8*)(mBits + y * mWidth);
+			const uint8* prev = (y > 0) ? (const uint8*)(mBits + (y - 1) * mWidth) : &zeroRow[0];
+			uint8* bestRow = &trialRows[0];
+			uint8* trialRow = &trialRows[rowBytes];
+			int bestFilter = PNGFilter_None;
+			uint32 bestCost = PNGFilterRow(PNGFilter_None, bestRow, src, prev, rowBytes, 4);
+			for (int filter = PNGFilter_Sub; filter < PNGFilter_COUNT; filter++)
+			{
+				uint32 cost = PNGFilterRow(filter, trialRow, src, prev, rowBytes, 4);
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestFilter = filter;
+					std::swap(bestRow, trialRow);
+				}
+			}
+			uint8* dest = &filtered[y * filteredRowBytes];
+			dest[0] = (uint8)bestFilter;
+			memcpy(dest + 1, bestRow, rowBytes);
+		}
+	});
+
+	// Bands are deflated on their own, each primed with the window before it, and end on a byte boundary with a sync
+	//  flush so they join into one zlib stream. Only the last one finishes the stream.
+	const int bandBytes = 256 * 1024;
+	int bandRows = BF_MAX(bandBytes / (int)filteredRowBytes, 1);
+	int numBands = (mHeight + bandRows - 1) / bandRows;
+	std::vector<std::vector<uint8> > bandData(numBands);
+	std::vector<uint32> bandAdlers(numBands);
+	volatile bool failed = false;
+
+	ImageParallelRows(numBands, bandRows * mWidth, [&](int startBand, int endBand)
+	{
+		for (int bandIdx = startBand; bandIdx < endBand; bandIdx++)
+		{
+			size_t startOfs = (size_t)bandIdx * bandRows * filteredRowBytes;
+			size_t endOfs = (size_t)BF_MIN((bandIdx + 1) * bandRows, mHeight) * filteredRowBytes;
+			size_t srcSize = endOfs - startOfs;
+			bool isLast = bandIdx == numBands - 1;
+
+			z_stream zStream;
+			memset(&zStream, 0, sizeof(zStream));
+			if (deflateInit2(&zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_FILTERED) != Z_OK)
+			{
+				failed = true;
+				continue;
+			}
+			if (bandIdx > 0)
+			{
+				size_t dictSize = BF_MIN(startOfs, (size_t)(1 << MAX_WBITS));
+				deflateSetDictionary(&zStream, &filtered[startOfs - dictSize], (uInt)dictSize);
+			}
+
+			auto& outData = bandData[bandIdx];
+			outData.resize(srcSize + srcSize / 8 + 64);
+			zStream.next_in = &filtered[startOfs];
+			zStream.avail_in = (uInt)srcSize;
+			int flush = isLast ? Z_FINISH : Z_SYNC_FLUSH;
+			int result;
+			while (true)
+			{
+				zStream.next_out = &outData[zStream.total_out];
+				zStream.avail_out = (uInt)(outData.size() - zStream.total_out);
+				result = deflate(&zStream, flush);
+				if ((result != Z_OK) || (zStream.avail_out != 0))
+					break;
+				outData.resize(outData.size() * 2);
+			}
+			if (result != (isLast ? Z_STREAM_END : Z_OK))
+				failed = true;
+			outData.resize(zStream.total_out);
+			deflateEnd(&zStream);
+
+			bandAdlers[bandIdx] = (uint32)adler32(adler32(0, NULL, 0), &filtered[startOfs], (uInt)srcSize);
+		}
+	});
+	if (failed)
+		return false;
+
+	uint32 adler = 1;
+	for (int bandIdx = 0; bandIdx < numBands; bandIdx++)
+	{
+		int startRow = bandIdx * bandRows;
+		adler = PNGCombineAdler32(adler, bandAdlers[bandIdx], (uint64)(BF_MIN(startRow + bandRows, mHeight) - startRow) * filteredRowBytes);
+	}
+
+	// The zlib header for a 32K window at the default level goes on the first band, the checksum on the last
+	const uint8 zlibHeader[2] = { 0x78, 0x9C };
+	bandData[0].insert(bandData[0].begin(), zlibHeader, zlibHeader + 2);
+	uint8 adlerBytes[4];
+	PNGWriteBE32(adlerBytes, adler);
+	bandData[numBands - 1].insert(bandData[numBands - 1].end(), adlerBytes, adlerBytes + 4);
+
+	FILE* fp = fopen(path.c_str(), "wb");
+	if (fp == NULL)
+		return false;
+
+	uint8 header[13];
+	PNGWriteBE32(header, (uint32)mWidth);
+	PNGWriteBE32(header + 4, (uint32)mHeight);
+	header[8] = 8; // Bit depth
+	header[9] = 6; // RGBA
+	header[10] = 0;
+	header[11] = 0;
+	header[12] = 0;
+	const uint8 sigBits[4] = { 8, 8, 8, 8 };
+
+	bool success = (fwrite(gPNGSignature, 1, 8, fp) == 8) && (PNGWriteChunk(fp, "IHDR", header, 13)) && (PNGWriteChunk(fp, "sBIT", sigBits, 4));
+	for (auto& data : bandData)
+		success = success && (PNGWriteChunk(fp, "IDAT", &data[0], (int)data.size()));
+	success = success && (PNGWriteChunk(fp, "IEND", NULL, 0));
+	fclose(fp);
+	return success;
+}
+
+//
+
 bool PNGData::ReadData()
 {
+	if (((gImageProcessFlags & ImageProcessFlag_FastPNGDecode) != 0) && (ReadDataFast()))
+		return true;
+
 	mReadPos = 0;
 
 	png_uint_32 width, height;
@@ -75,6 +691,8 @@ bool PNGData::ReadData()
 		
 	/* Add filler (or alpha) byte (before/after each RGB triplet) */
 	png_set_expand(png_ptr);
+	/* The rows below are 8 bits per channel */
+	png_set_strip_16(png_ptr);
 #ifdef BF_PLATFORM_BIG_ENDIAN
 	png_set_filler(png_ptr, 0xff, PNG_FILLER_BEFORE);
 	png_set_swap_alpha(png_ptr);
@@ -187,6 +805,9 @@ bool PNGData::ReadData()
 
 bool PNGData::WriteToFile(const StringImpl& path)
 {
+	if ((gImageProcessFlags & ImageProcessFlag_LibPNG) == 0)
+		return WriteToFileFast(path);
+
 	png_structp png_ptr;
 	png_infop info_ptr;
 
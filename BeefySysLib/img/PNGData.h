@@ -9,6 +9,10 @@ class PNGData : public ImageData
 public:	
 	int						mReadPos;
 
+protected:
+	bool					ReadDataFast();
+	bool					WriteToFileFast(const StringImpl& path);
+
 public:		
 	PNGData();
 
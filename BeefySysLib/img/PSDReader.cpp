@@ -1,5 +1,7 @@
 #include "PSDReader.h"
 #include "FileStream.h"
+#include "MemStream.h"
+#include "util/MappedFile.h"
 #include "BFApp.h"
 #include "img/ImageData.h"
 #include "gfx/Texture.h"
@@ -9,6 +11,7 @@
 #include "ImageAdjustments.h"
 #include "util/PerfTimer.h"
 #include <set>
+#include <algorithm>
 
 /*
 #include "agg_rendering_buffer.h"
@@ -170,6 +173,8 @@ PSDPattern* PSDPattern::GetNextMipLevel()
 PSDReader::PSDReader()
 {
 	mFS = NULL;
+	mMappedFile = NULL;
+	mUseMappedFile = true;
 	mGlobalAltitude = 0;
 	mGlobalAngle = 30;
 }
@@ -178,6 +183,7 @@ PSDReader::~PSDReader()
 {
 	if (mFS != NULL)
 		delete mFS;
+	delete mMappedFile;
 	for (int i = 0; i < (int) mPSDLayerInfoVector.size(); i++)
 		delete mPSDLayerInfoVector[i];
 	PSDPatternMap::iterator itr = mPSDPatternMap.begin();
@@ -963,17 +969,35 @@ bool PSDReader::Init(const StringImpl& fileName)
 	if (mFS == NULL)
 		return false;*/
 
-	mFS = new FileStream();
-	mFS->Open(fileName, "rb");
-
-	if (!mFS->IsOpen())
+	// Only the layer records are parsed here - channel data stays in the file until a layer is asked for
+	if (mUseMappedFile)
 	{
-		delete mFS;
-		mFS = NULL;
-		return false;
+		mMappedFile = new MappedFile();
+		if (mMappedFile->Open(fileName))
+		{
+			mFS = new SafeMemStream(mMappedFile->mData, mMappedFile->mFileSize, false);
+		}
+		else
+		{
+			delete mMappedFile;
+			mMappedFile = NULL;
+		}
 	}
 
-	//mFS->SetCacheSize(4096);
+	if (mFS == NULL)
+	{
+		FileStream* fileStream = new FileStream();
+		fileStream->Open(fileName, "rb");
+
+		if (!fileStream->IsOpen())
+		{
+			delete fileStream;
+			return false;
+		}
+
+		//fileStream->SetCacheSize(4096);
+		mFS = fileStream;
+	}
 
 	mFS->mBigEndian = true;
 	
@@ -1402,6 +1426,35 @@ bool PSDReader::Init(const StringImpl& fileName)
 	return true;
 }
 
+// Decodes all the given layers that haven't been read yet, in parallel. Masks are applied afterward on this thread.
+void PSDReader::ReadLayerData(const std::vector<int>& layerIndices)
+{
+	AutoPerf gPerf("PSDReader::ReadLayerData");
+
+	std::vector<PSDLayerInfo*> layers;
+	for (int layerIdx : layerIndices)
+	{
+		PSDLayerInfo* layerInfo = mPSDLayerInfoVector[layerIdx];
+		if ((layerInfo->mBits == NULL) && (std::find(layers.begin(), layers.end(), layerInfo) == layers.end()))
+			layers.push_back(layerInfo);
+	}
+	if (layers.empty())
+		return;
+
+	// One layer per band - each layer splits its rows further on its own
+	ImageParallelRows((int)layers.size(), 1024 * 1024, [&](int startIdx, int endIdx)
+		{
+			for (int idx = startIdx; idx < endIdx; idx++)
+				layers[idx]->DecodeData();
+		});
+
+	for (auto layerInfo : layers)
+	{
+		if (((layerInfo->mLayerMask != NULL) || (layerInfo->mVectorMask != NULL)) && (!layerInfo->mLayerMaskHidesEffects))
+			layerInfo->ApplyMask(layerInfo);
+	}
+}
+
 Texture* PSDReader::LoadLayerTexture(int layerIdx, int* ofsX, int* ofsY) // -1 = composited image
 {
 	if ((layerIdx < 0) || (layerIdx >= (int) mPSDLayerInfoVector.size()))
@@ -1446,11 +1499,10 @@ ImageData* PSDReader::MergeLayers(PSDLayerInfo* group, const std::vector<int>& l
 	bool doPostGroupBlend = false;
 	bool needsPrevBottom = (group != NULL) && (group->mOpacity != 255);
 
+	ReadLayerData(layerIndices);
 	for (int indexIdx = 0; indexIdx < (int) layerIndices.size(); indexIdx++)
 	{		
 		PSDLayerInfo* layerInfo = mPSDLayerInfoVector[layerIndices[indexIdx]];
-		if (layerInfo->mBits == NULL)
-			layerInfo->ReadData();
 		if (layerInfo->mKnockout == 1) // Shallow
 			needsPrevBottom = true;
 	}
@@ -1636,10 +1688,8 @@ ImageData* PSDReader::MergeLayers(PSDLayerInfo* group, const std::vector<int>& l
 	return combinedImage;
 }
 
-Texture* PSDReader::LoadMergedLayerTexture(const std::vector<int>& layerIndices, int* ofsX, int* ofsY)
+ImageData* PSDReader::CreateMergedImage(const std::vector<int>& layerIndices)
 {
-	AutoPerf gPerf("PSDReader::LoadMergedLayerTexture");
-
 	LayerInfoMap groupMap;
 
 	if (layerIndices.size() == 0)
@@ -1699,7 +1749,16 @@ Texture* PSDReader::LoadMergedLayerTexture(const std::vector<int>& layerIndices,
 		revItr++;
 	}
 	
-	ImageData* combinedImage = MergeLayers(NULL, aLayerIndices, NULL);
+	return MergeLayers(NULL, aLayerIndices, NULL);
+}
+
+Texture* PSDReader::LoadMergedLayerTexture(const std::vector<int>& layerIndices, int* ofsX, int* ofsY)
+{
+	AutoPerf gPerf("PSDReader::LoadMergedLayerTexture");
+
+	ImageData* combinedImage = CreateMergedImage(layerIndices);
+	if (combinedImage == NULL)
+		return NULL;
 
 	Texture* texture = gBFApp->mRenderDevice->LoadTexture(combinedImage, false);
 	*ofsX = combinedImage->mX;
@@ -1752,185 +1811,207 @@ PSDLayerInfo::~PSDLayerInfo()
 	delete mImageEffects;
 }
 
-bool PSDLayerInfo::ReadData()
+static inline int PSDReadUInt16(const uint8* ptr)
 {
-	AutoPerf gPerf("PSDLayerInfo::ReadData");
+	return (ptr[0] << 8) | ptr[1];
+}
 
-	FileStream* fS = mPSDReader->mFS;
+// Decodes one PackBits row, stopping at the end of the row or of the source
+template <typename TPutFunc>
+static void PSDDecodePackBitsRow(const uint8* src, int srcSize, int width, TPutFunc putFunc)
+{
+	int readPos = 0;
+	int x = 0;
+	while ((readPos < srcSize) && (x < width))
+	{
+		int chunkSize = (int8)src[readPos++];
+		if (chunkSize >= 0)
+		{
+			// String of literal data
+			chunkSize = std::min(chunkSize + 1, std::min(width - x, srcSize - readPos));
+			while (chunkSize > 0)
+			{
+				putFunc(x++, src[readPos++]);
+				chunkSize--;
+			}
+		}
+		else if ((chunkSize > -128) && (readPos < srcSize))
+		{
+			// One byte repeated
+			chunkSize = std::min(1 - chunkSize, width - x);
+			uint8 aData = src[readPos++];
+			while (chunkSize > 0)
+			{
+				putFunc(x++, aData);
+				chunkSize--;
+			}
+		}
+	}
+}
 
-	fS->SetPos(mImageDataStart);
+struct PSDChannelRows
+{
+	const uint8* mData; // Past the compression field
+	int mSize;
+	int mWidth;
+	int mHeight;
+	bool mCompressed;
+	std::vector<int> mRowStarts; // For RLE data, the offset of each row and then the end offset
+
+	bool Init(const uint8* data, int size, int width, int height)
+	{
+		if (size < 2)
+			return false;
+		int compression = PSDReadUInt16(data);
+		mData = data + 2;
+		mSize = size - 2;
+		mWidth = width;
+		mHeight = height;
+		mCompressed = compression != 0;
+		if (!mCompressed)
+			return mSize >= width * height;
+		if (compression != 1) // ZIP isn't supported
+			return false;
+		if (mSize < height * 2)
+			return false;
+
+		mRowStarts.resize(height + 1);
+		int rowStart = height * 2;
+		for (int y = 0; y < height; y++)
+		{
+			mRowStarts[y] = std::min(rowStart, mSize);
+			rowStart += PSDReadUInt16(mData + y * 2);
+		}
+		mRowStarts[height] = std::min(rowStart, mSize);
+		return true;
+	}
 
-	mBits = new uint32[mWidth*mHeight];
-	memset(mBits, 0, mWidth*mHeight*sizeof(uint32));
-	int aSize = mWidth*mHeight;
-	if (mChannels.size() < 4)
+	template <typename TPutFunc>
+	void DecodeRow(int y, TPutFunc putFunc)
 	{
-		for (int i = 0; i < aSize; i++)
-			mBits[i] = 0xFF000000;
+		if (!mCompressed)
+		{
+			const uint8* src = mData + y * mWidth;
+			for (int x = 0; x < mWidth; x++)
+				putFunc(x, src[x]);
+			return;
+		}
+		PSDDecodePackBitsRow(mData + mRowStarts[y], mRowStarts[y + 1] - mRowStarts[y], mWidth, putFunc);
 	}
-	else
+};
+
+const uint8* PSDReader::GetFileData(int pos, int size, std::vector<uint8>& buffer)
+{
+	if ((pos < 0) || (size < 0))
+		return NULL;
+
+	if (mMappedFile != NULL)
 	{
-		for (int i = 0; i < aSize; i++)
-			mBits[i] = 0x00000000;
+		if (pos + (int64)size > mMappedFile->mFileSize)
+			return NULL;
+		return (const uint8*)mMappedFile->mData + pos;
 	}
 
-		
-	short* rowLengths = new short[std::max(mLayerMaskHeight, mHeight)];
-		
-	for (int channelIdx = 0; channelIdx < (int) mChannels.size(); channelIdx++)
+	AutoCrit autoCrit(mCritSect);
+	if (pos + (int64)size > mFS->GetSize())
+		return NULL;
+	buffer.resize(std::max(size, 1));
+	mFS->SetPos(pos);
+	mFS->Read(&buffer[0], size);
+	return &buffer[0];
+}
+
+bool PSDLayerInfo::DecodeData()
+{
+	int aSize = mWidth*mHeight;
+	mBits = new uint32[aSize];
+	uint32 initColor = (mChannels.size() < 4) ? 0xFF000000 : 0x00000000;
+	for (int i = 0; i < aSize; i++)
+		mBits[i] = initColor;
+
+	int dataSize = 0;
+	for (auto& channel : mChannels)
+		dataSize += channel.mLength;
+
+	std::vector<uint8> buffer;
+	const uint8* data = mPSDReader->GetFileData(mImageDataStart, dataSize, buffer);
+	if (data == NULL)
+		return false;
+
+	// Find every channel's rows up front so rows - and the channels within them - decode independently
+	std::vector<PSDChannelRows> colorChannels;
+	std::vector<int> colorShifts;
+	PSDChannelRows maskChannel;
+	bool hasMask = false;
+
+	int channelStart = 0;
+	for (auto& channel : mChannels)
 	{
-		PSDChannelInfo* channel = &mChannels[channelIdx];
+		const uint8* channelData = data + channelStart;
+		channelStart += channel.mLength;
 
-		if (channel->mId == -2)
+		if (channel.mId == -2)
 		{
-			mLayerMask = new uint8[mLayerMaskWidth*mLayerMaskHeight];
-
-			int compression = fS->ReadInt16();
-			if (compression == 0)
+			if ((mLayerMaskEnabled) && (maskChannel.Init(channelData, channel.mLength, mLayerMaskWidth, mLayerMaskHeight)))
+				hasMask = true;
+		}
+		else if ((channel.mId >= -1) && (channel.mId <= 2))
+		{
+			PSDChannelRows channelRows;
+			if (channelRows.Init(channelData, channel.mLength, mWidth, mHeight))
 			{
-				for (int pos = 0; pos < aSize; pos++)
-					mLayerMask[pos] = fS->ReadInt8();
+				colorChannels.push_back(channelRows);
+				colorShifts.push_back((2 - channel.mId) * 8);
 			}
-			else
-			{				
-				for (int aY = 0; aY < mLayerMaskHeight; aY++)
-					rowLengths[aY] = fS->ReadInt16();
+		}
+	}
 
-				for (int aY = 0; aY < mLayerMaskHeight; aY++)
+	ImageParallelRows(mHeight, mWidth * std::max((int)colorChannels.size(), 1), [&](int startY, int endY)
+		{
+			for (int y = startY; y < endY; y++)
+			{
+				uint32* rowBits = mBits + y * mWidth;
+				for (int channelIdx = 0; channelIdx < (int)colorChannels.size(); channelIdx++)
 				{
-					int pos = aY * mLayerMaskWidth;
-					int readSize = rowLengths[aY];
-			
-					while (readSize > 0)
-					{
-						int chunkSize = fS->ReadInt8();
-						readSize--;
-						if (chunkSize >= 0)
-						{
-							// String of literal data
-							chunkSize++;
-							readSize -= chunkSize;
-							while (chunkSize > 0)
-							{						
-								mLayerMask[pos++] = fS->ReadInt8();
-								chunkSize--;
-							}						
-						}
-						else if (chunkSize > -128)
-						{
-							// One byte repeated
-							chunkSize = 1 - chunkSize;
-							uint8 aData = fS->ReadInt8();
-							readSize--;
-							while (chunkSize > 0)
-							{
-								mLayerMask[pos++] = aData;							
-								chunkSize--;
-							}						
-						}
-					}
+					int shift = colorShifts[channelIdx];
+					colorChannels[channelIdx].DecodeRow(y, [&](int x, uint8 val) { rowBits[x] |= ((uint32)val) << shift; });
 				}
-			}
 
-			if (!mLayerMaskEnabled)
-			{
-				delete mLayerMask;
-				mLayerMask = NULL;
+				for (int x = 0; x < mWidth; x++)
+				{
+					uint32 aColor = rowBits[x];
+					rowBits[x] = (aColor & 0xFF00FF00) | ((aColor & 0x00FF0000) >> 16) | ((aColor & 0x000000FF) << 16);
+				}
 			}
-		}
-		else
-		{
-			int shift = (2 - channel->mId) * 8;
+		});
 
-			int compression = fS->ReadInt16();
-			if (compression == 0)
+	if (hasMask)
+	{
+		mLayerMask = new uint8[mLayerMaskWidth*mLayerMaskHeight];
+		memset(mLayerMask, mLayerMaskDefault, mLayerMaskWidth*mLayerMaskHeight);
+		ImageParallelRows(mLayerMaskHeight, mLayerMaskWidth, [&](int startY, int endY)
 			{
-				for (int pos = 0; pos < aSize; pos++)
-					mBits[pos] |= ((uint32) (uint8) fS->ReadInt8()) << shift;
-			}
-			else
-			{				
-				int maxSize = 0;
-				for (int aY = 0; aY < mHeight; aY++)
+				for (int y = startY; y < endY; y++)
 				{
-					rowLengths[aY] = fS->ReadInt16();
-					maxSize = std::max(maxSize, (int) rowLengths[aY]);
-				}				
-				uint8* rowData = new uint8[maxSize];
-
-				for (int aY = 0; aY < mHeight; aY++)
-				{					
-					int pos = aY * mWidth;
-					int readSize = rowLengths[aY];
-					int readPos = 0;			
-
-					int fileOfs = fS->GetPos();
-					fS->Read(rowData, readSize);					
-
-					/*auto FixAlpha = [&]()
-					{
-						if (channel->mId == -1)
-						{
-							int fixedAlpha = std::min(255, rowData[readPos] * 0xFF / 0xB8);
-							fS->SetPos(fileOfs + readPos);
-							fS->Write((uint8)fixedAlpha);
-							fS->SetPos(fileOfs + readSize);
-						}
-					};*/
-
-					while (readPos < readSize)
-					{
-						int chunkSize = (int8) rowData[readPos++];						
-						if (chunkSize >= 0)
-						{
-							// String of literal data
-							chunkSize++;							
-							while (chunkSize > 0)
-							{						
-								//FixAlpha();
-								mBits[pos++] |= ((uint32) rowData[readPos++]) << shift;							
-								chunkSize--;
-							}						
-						}
-						else if (chunkSize > -128)
-						{
-							// One byte repeated
-							chunkSize = 1 - chunkSize;
-							//FixAlpha();
-							uint32 aData = ((uint32) rowData[readPos++]) << shift;							
-							while (chunkSize > 0)
-							{
-								mBits[pos++] |= aData;
-								chunkSize--;
-							}						
-						}
-					}
+					uint8* rowMask = mLayerMask + y * mLayerMaskWidth;
+					maskChannel.DecodeRow(y, [&](int x, uint8 val) { rowMask[x] = val; });
 				}
-
-				delete [] rowData;
-			}
-		}				
+			});
 	}
 
-	delete [] rowLengths;
+	return true;
+}
 
-	if (((mLayerMask != NULL) || (mVectorMask != NULL)) && (!mLayerMaskHidesEffects))
-		ApplyMask(this);
+bool PSDLayerInfo::ReadData()
+{
+	AutoPerf gPerf("PSDLayerInfo::ReadData");
 
- 	uint32* ptr = mBits;
-	for (int i = 0; i < aSize; i++)
-	{
-		uint32 aColor = *ptr;
+	bool success = DecodeData();
 
-		int a = (aColor & 0xFF000000) >> 24;
-		int r = (aColor & 0x00FF0000) >> 16;
-		int g = (aColor & 0x0000FF00) >> 8 ;
-		int b = (aColor & 0x000000FF)      ;
-			
-		*(ptr++) = (a << 24) | (b << 16) | (g << 8) | r;
-	}
+	if (((mLayerMask != NULL) || (mVectorMask != NULL)) && (!mLayerMaskHidesEffects))
+		ApplyMask(this);
 	
-	return true;
+	return success;
 }
 
 void PSDLayerInfo::ApplyVectorMask(ImageData* imageData)
@@ -2,12 +2,14 @@
 
 #include "../Common.h"
 #include "ImageData.h"
+#include "../util/CritSect.h"
 #include <vector>
 #include <map>
 
 NS_BF_BEGIN;
 
-class FileStream;
+class DataStream;
+class MappedFile;
 class ImageData;
 class ImageAdjustment;
 
@@ -146,6 +148,7 @@ public:
 	~PSDLayerInfo();
 
 	virtual	bool			ReadData();
+	bool					DecodeData(); // The thread-safe part of ReadData, everything but the masking
 	void					ApplyVectorMask(ImageData* imageData);
 	void					ApplyMask(ImageData* imageData);
 };
@@ -180,7 +183,10 @@ class ImagePatternFill;
 class PSDReader
 {
 public:
-	FileStream*				mFS;
+	DataStream*				mFS;
+	MappedFile*				mMappedFile; // Layer data is decoded straight out of the mapping when the file could be mapped
+	bool					mUseMappedFile;
+	CritSect				mCritSect; // Guards mFS when layer data has to be read through it
 
 	int						mVersion;
 	int						mWidth;
@@ -214,9 +220,12 @@ public:
 	~PSDReader();
 
 	bool					Init(const StringImpl& fileName);
+	const uint8*			GetFileData(int pos, int size, std::vector<uint8>& buffer);
+	void					ReadLayerData(const std::vector<int>& layerIndices);
 
 	Texture*				LoadLayerTexture(int layerIdx, int* ofsX, int* ofsY); // -1 = composited image
 	ImageData*				MergeLayers(PSDLayerInfo* group, const std::vector<int>& layerIndices, ImageData* bottomImage);	
+	ImageData*				CreateMergedImage(const std::vector<int>& layerIndices); // Caller deletes unless it's one of the PSDLayerInfos
 	Texture*				LoadMergedLayerTexture(const std::vector<int>& layerIndices, int* ofsX, int* ofsY);
 
 };
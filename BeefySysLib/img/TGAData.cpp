@@ -1,4 +1,5 @@
 #include "TGAData.h"
+#include "ImageUtils.h"
 
 USING_NS_BF;
 
@@ -49,7 +50,7 @@ bool TGAData::ReadData()
 	bool flipped = (hdr->mImageDescriptor & 0x20) != 0;
 
 	mWidth = hdr->mWidth;
-	mHeight = hdr->mWidth;
+	mHeight = hdr->mHeight;
     mBits = new uint32[mWidth * mHeight];
 
 	if (hdr->mDataTypeCode == 10) // RLE
@@ -175,28 +176,22 @@ readSpanHeader:
 		}
 
 		if (aMode == 4)
-		{			
-			for (int y = 0; y < mHeight; y++)
-			{				
-				for (int x = 0; x < mWidth; x++)
-				{					
-					int b = *(srcPtr++);				
-					int g = *(srcPtr++);
-					int r = *(srcPtr++);
-					int a = *(srcPtr++);
+		{
+			if ((int64)step + dataSize > mSrcDataLen)
+				return false;
 
+			// BGRA rows only need their R and B swapped, so they're copied whole and fixed up in bands of rows
+			ImageParallelRows(mHeight, mWidth, [&](int startY, int endY)
+			{
+				for (int y = startY; y < endY; y++)
+				{
+					uint32* destRow = mBits + mWidth * (flipped ? y : (mHeight - 1 - y));
+					memcpy(destRow, srcPtr + (size_t)y * mWidth * 4, mWidth * 4);
+					SwapRAndBRow(destRow, mWidth);
 					if (mWantsAlphaPremultiplied)
-					{
-						r = (r * a) / 255;
-						g = (g * a) / 255;
-						b = (b * a) / 255;
-					}
-
-					*(destPtr++) = (a << 24) | (b << 16) | (g << 8) | r;
+						PremultiplyAlphaRow(destRow, mWidth, false);
 				}
-
-				destPtr += destAdd;				
-			}
+			});
 		}
 		else if (aMode == 3)
 		{			
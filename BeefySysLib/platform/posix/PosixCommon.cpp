@@ -688,14 +688,14 @@ BFP_EXPORT int BFP_CALLTYPE BfpSystem_GetNumLogicalCPUs(BfpSystemResult* outResu
 
 BFP_EXPORT int64 BFP_CALLTYPE BfpSystem_GetCPUTick()
 {
-	return 10000000;
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec * 10000000LL) + now.tv_nsec / 100;
 }
 
 BFP_EXPORT int64 BFP_CALLTYPE BfpSystem_GetCPUTickFreq()
 {
-	struct timespec now;
-	clock_gettime(CLOCK_MONOTONIC, &now);
-	return (now.tv_sec * 10000000LL) + now.tv_nsec / 100;
+	return 10000000;
 }
 
 BFP_EXPORT void BFP_CALLTYPE BfpSystem_CreateGUID(BfpGUID* outGuid)
@@ -29,6 +29,13 @@ USING_NS_BF;
 #define GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG 0x8C01
 #define GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG 0x8C02
 #define GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG 0x8C03
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
 
 #if defined BF_PLATFORM_OPENGL_ES2
 #define APIENTRYP BF_CALLTYPE *
@@ -817,6 +824,8 @@ void GLRenderDevice::FrameEnd()
 		}
 		++itr;
 	}
+
+	RenderDevice::FrameEnd();
 }
 
 Texture* GLRenderDevice::LoadTexture(ImageData* imageData, bool additive)
@@ -869,9 +878,15 @@ Texture* GLRenderDevice::LoadTexture(ImageData* imageData, bool additive)
     
 		if (imageData->mHWBits != NULL)
 		{
-			int internalFormat = (imageData->mHWBitsType == HWBITS_PVRTC_2BPPV1) ?
-				GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG :
-				GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG;
+			int internalFormat;
+			switch (imageData->mHWBitsType)
+			{
+			case HWBITS_PVRTC_2BPPV1: internalFormat = GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG; break;
+			case HWBITS_BC1: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+			case HWBITS_BC3: internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+			case HWBITS_BC7: internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+			default: internalFormat = GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG; break;
+			}
 
 			int texSize = imageData->mHWBitsLength / texCount;
 
@@ -3,6 +3,7 @@
 #include "WinBFApp.h"
 #include "BFWindow.h"
 #include "img/ImageData.h"
+#include "img/BlockCompress.h"
 #include "util/PerfTimer.h"
 #include "util/BeefPerf.h"
 
@@ -616,12 +617,12 @@ ModelInstance* DXRenderDevice::CreateModelInstance(ModelDef* modelDef)
 
 		dxMesh->mTexture = (DXTexture*)((RenderDevice*)this)->LoadTexture(texPath, TextureFlag_NoPremult);
 
-		dxMesh->mNumIndices = (int)mesh->mIndices.size();
-		dxMesh->mNumVertices = (int)mesh->mVertices.size();
+		dxMesh->mNumIndices = mesh->GetIndexCount();
+		dxMesh->mNumVertices = mesh->GetVertexCount();
 
 		D3D11_BUFFER_DESC bd;
 		bd.Usage = D3D11_USAGE_DYNAMIC;
-		bd.ByteWidth = (int)mesh->mIndices.size() * sizeof(uint16);
+		bd.ByteWidth = dxMesh->mNumIndices * sizeof(uint16);
 		bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
 		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 		bd.MiscFlags = 0;
@@ -632,15 +633,14 @@ ModelInstance* DXRenderDevice::CreateModelInstance(ModelDef* modelDef)
 		D3D11_MAPPED_SUBRESOURCE mappedSubResource;
 
 		DXCHECK(mD3DDeviceContext->Map(dxMesh->mD3DIndexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubResource));
-		uint16* dxIdxData = (uint16*)mappedSubResource.pData;		
-		for (int idxIdx = 0; idxIdx < dxMesh->mNumIndices; idxIdx++)		
-			dxIdxData[idxIdx] = (uint16)mesh->mIndices[idxIdx];		
+		uint16* dxIdxData = (uint16*)mappedSubResource.pData;
+		memcpy(dxIdxData, mesh->GetIndices(), dxMesh->mNumIndices * sizeof(uint16));
 		mD3DDeviceContext->Unmap(dxMesh->mD3DIndexBuffer, 0);
 
 		//
 
 		bd.Usage = D3D11_USAGE_DYNAMIC;
-		bd.ByteWidth = (int)mesh->mVertices.size() * sizeof(DXModelVertex);
+		bd.ByteWidth = dxMesh->mNumVertices * sizeof(DXModelVertex);
 		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 		bd.MiscFlags = 0;
@@ -896,33 +896,8 @@ void Beefy::DXModelInstance::CommandQueued(DrawLayer* drawLayer)
 
 	drawLayer->mCurTextures[0] = NULL;
 
-	ModelAnimation* fbxAnim = &mModelDef->mAnims[0];
-
-	Matrix4 jointsMatrices[BF_MAX_NUM_BONES];
-	for (int jointIdx = 0; jointIdx < (int)mJointTranslations.size(); jointIdx++)
-	{
-		ModelJoint* joint = &mModelDef->mJoints[jointIdx];		
-
-		BF_ASSERT(joint->mParentIdx < jointIdx);
-		
-		ModelJointTranslation* jointPosition = &mJointTranslations[jointIdx];
-
-		Matrix4* mtx = &jointsMatrices[jointIdx];
-
-		*mtx = Matrix4::CreateTransform(jointPosition->mTrans, jointPosition->mScale, jointPosition->mQuat);
-		if (joint->mParentIdx >= 0)
-		{
-			 Matrix4* parentMatrix = &jointsMatrices[joint->mParentIdx];
-			 *mtx = Matrix4::Multiply(*parentMatrix, *mtx);			 
-		}
-	}	
-
-	for (int jointIdx = 0; jointIdx < (int)mModelDef->mJoints.size(); jointIdx++)
-	{
-		ModelJoint* joint = &mModelDef->mJoints[jointIdx];
-		Matrix4* mtx = &jointsMatrices[jointIdx];
-		*mtx = Matrix4::Multiply(*mtx, joint->mPoseInvMatrix);
-	}
+	UpdateJointMatrices();
+	Matrix4* jointsMatrices = mJointMatrices.data();
 
 	for (int meshIdx = 0; meshIdx < (int) mModelDef->mMeshes.size(); meshIdx++)
 	{
@@ -936,9 +911,10 @@ void Beefy::DXModelInstance::CommandQueued(DrawLayer* drawLayer)
 		DXRenderDevice* dxRenderDevice = (DXRenderDevice*)drawLayer->mRenderDevice;
 		DXCHECK(dxRenderDevice->mD3DDeviceContext->Map(dxMesh->mD3DVertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubResource));
 		DXModelVertex* dxVtxData = (DXModelVertex*)mappedSubResource.pData;
-		for (int vtxIdx = 0; vtxIdx < (int) mesh->mVertices.size(); vtxIdx++)
+		const ModelVertex* srcVertices = mesh->GetVertices();
+		for (int vtxIdx = 0; vtxIdx < dxMesh->mNumVertices; vtxIdx++)
 		{
-			ModelVertex* srcVtxData = &mesh->mVertices[vtxIdx];
+			const ModelVertex* srcVtxData = &srcVertices[vtxIdx];
 
 			Vector3 vtx(0, 0, 0);
 
@@ -1466,16 +1442,62 @@ Texture* DXRenderDevice::LoadTexture(ImageData* imageData, int flags)
 	ID3D11ShaderResourceView* d3DShaderResourceView = NULL;
 
 	imageData->mIsAdditive = (flags & TextureFlag_Additive) != 0;
-	if ((flags & TextureFlag_NoPremult) == 0)
+
+	// Block-compressed data goes up as it is when the device can sample the format, otherwise it's decoded first
+	DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	int blockBytes = 0;
+	if (imageData->mHWBits != NULL)
+	{
+		DXGI_FORMAT hwFormat = DXGI_FORMAT_UNKNOWN;
+		switch (imageData->mHWBitsType)
+		{
+		case HWBITS_BC1:
+			hwFormat = DXGI_FORMAT_BC1_UNORM;
+			blockBytes = 8;
+			break;
+		case HWBITS_BC3:
+			hwFormat = DXGI_FORMAT_BC3_UNORM;
+			blockBytes = 16;
+			break;
+		case HWBITS_BC7:
+			hwFormat = DXGI_FORMAT_BC7_UNORM;
+			blockBytes = 16;
+			break;
+		}
+
+		// The top level of a block-compressed texture has to be a whole number of blocks
+		UINT formatSupport = 0;
+		if ((hwFormat != DXGI_FORMAT_UNKNOWN) && ((imageData->mWidth % 4) == 0) && ((imageData->mHeight % 4) == 0) &&
+			(SUCCEEDED(mD3DDevice->CheckFormatSupport(hwFormat, &formatSupport))) && ((formatSupport & D3D11_FORMAT_SUPPORT_TEXTURE2D) != 0))
+		{
+			format = hwFormat;
+		}
+		else if ((imageData->mBits == NULL) && (BlockCompressedSize(imageData->mHWBitsType, imageData->mWidth, imageData->mHeight) >= 0))
+		{
+			imageData->mBits = new uint32[imageData->mWidth * imageData->mHeight];
+			BlockDecompress(imageData->mHWBitsType, (uint8*)imageData->mHWBits, imageData->mWidth, imageData->mHeight, imageData->mBits);
+		}
+	}
+
+	if (((flags & TextureFlag_NoPremult) == 0) && (format == DXGI_FORMAT_R8G8B8A8_UNORM))
 		imageData->PremultiplyAlpha();
 
 	int aWidth = 0;
 	int aHeight = 0;
 	
 	D3D11_SUBRESOURCE_DATA resData;
-	resData.pSysMem = imageData->mBits;
-	resData.SysMemPitch = imageData->mWidth * 4;
-	resData.SysMemSlicePitch = imageData->mWidth * imageData->mHeight * 4;
+	if (format == DXGI_FORMAT_R8G8B8A8_UNORM)
+	{
+		resData.pSysMem = imageData->mBits;
+		resData.SysMemPitch = imageData->mWidth * 4;
+		resData.SysMemSlicePitch = imageData->mWidth * imageData->mHeight * 4;
+	}
+	else
+	{
+		resData.pSysMem = imageData->mHWBits;
+		resData.SysMemPitch = ((imageData->mWidth + 3) / 4) * blockBytes;
+		resData.SysMemSlicePitch = imageData->mHWBitsLength;
+	}
 
 	// Create the target texture
 	D3D11_TEXTURE2D_DESC desc;
@@ -1484,7 +1506,7 @@ Texture* DXRenderDevice::LoadTexture(ImageData* imageData, int flags)
 	desc.Height = imageData->mHeight;
 	desc.MipLevels = 1;
 	desc.ArraySize = 1;
-	desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	desc.Format = format;
 	desc.SampleDesc.Count = 1;	
 	desc.Usage = D3D11_USAGE_DEFAULT;
 	desc.CPUAccessFlags = 0;
@@ -243,12 +243,8 @@ public:
 	~DXVertexDefinition();
 };
 
-class DXSetTextureCmd : public RenderCmd
+class DXSetTextureCmd : public SetTextureCmd
 {
-public:
-	int						mTextureIdx;
-	Texture*				mTexture;
-
 public:
 	virtual void Render(RenderDevice* renderDevice, RenderWindow* renderWindow) override;
 };
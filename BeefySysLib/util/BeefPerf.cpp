@@ -663,6 +663,7 @@ BpManager::BpManager() : mShutdownEvent(true), mTLSDtor(&FlsFreeFunc)
 	mSharedMemoryFile = NULL;
 #endif
 	mSocket = INVALID_SOCKET;
+	mCaptureFile = NULL;
 	mConnectState = BpConnectState_NotConnected;
 	mThread = NULL;
 	mThreadId = 0;
@@ -795,6 +796,19 @@ void BpManager::TrySendData()
 		int trySend = std::min(sizeLeft, 8192);
 		mOutBuffer.MapView(0, trySend, outView);
 
+		if (mCaptureFile != NULL)
+		{
+			BfpFileResult fileResult = BfpFileResult_Ok;
+			int written = (int)BfpFile_Write(mCaptureFile, outView.mPtr, trySend, -1, &fileResult);
+			if ((fileResult != BfpFileResult_Ok) || (written <= 0))
+			{
+				mConnectState = BpConnectState_NotConnected;
+				return;
+			}
+			mOutBuffer.RemoveFront(written);
+			continue;
+		}
+
 		int result = send(mSocket, (const char*)outView.mPtr, trySend, 0);
 		
 		if (result < 0)
@@ -828,6 +842,12 @@ void BpManager::LostConnection()
 	mRootCmdTarget.Disable();
 	for (auto threadInfo : mThreadInfos)
 		threadInfo->Disable();
+	if (mCaptureFile != NULL)
+	{
+		BfpFile_Release(mCaptureFile);
+		mCaptureFile = NULL;
+		return;
+	}
 #ifdef BF_PLATFORM_WINDOWS
 	closesocket(mSocket);
 #else
@@ -893,7 +913,12 @@ void BpManager::ThreadProc()
 {
 	BfpThread_SetName(NULL, "BeefPerf", NULL);
 
-	if (!Connect())
+	bool isCapture = mCaptureFile != NULL;
+	if (isCapture)
+	{
+		mConnectState = BpConnectState_Connected;
+	}
+	else if (!Connect())
 	{				
 		mConnectState = BpConnectState_Failed;
 		LostConnection();		
@@ -917,41 +942,50 @@ void BpManager::ThreadProc()
 	{
 		bool wantsExit = mShutdownEvent.WaitFor(0);
 
-		FD_SET socketReadSet;
-		FD_ZERO(&socketReadSet);
-		FD_SET(mSocket, &socketReadSet);
-
-		FD_SET socketWriteSet;
-		FD_ZERO(&socketWriteSet);
-		if (mOutBuffer.GetSize() > 0)			
-			FD_SET(mSocket, &socketWriteSet);
-
-		FD_SET socketErrorSet;
-		FD_ZERO(&socketErrorSet);
-		FD_SET(mSocket, &socketErrorSet);
-
-		int selResult = select((int)mSocket + 1, &socketReadSet, &socketWriteSet, &socketErrorSet, &timeout);
-		if (FD_ISSET(mSocket, &socketWriteSet))
+		if (isCapture)
 		{
-			TrySendData();
-			//continue;
+			// No socket to wait on - just batch up data for a while, it gets flushed to disk below
+			if (!wantsExit)
+				mShutdownEvent.WaitFor(20);
 		}
-		if (FD_ISSET(mSocket, &socketReadSet))
-		{
-			// Just eat the data
-			uint8 data[4096];
-			int len = recv(mSocket, (char*)data, 4096, 0);
-			int b = 0;
-		}
-		if (FD_ISSET(mSocket, &socketErrorSet))
+		else
 		{
+			FD_SET socketReadSet;
+			FD_ZERO(&socketReadSet);
+			FD_SET(mSocket, &socketReadSet);
+
+			FD_SET socketWriteSet;
+			FD_ZERO(&socketWriteSet);
+			if (mOutBuffer.GetSize() > 0)			
+				FD_SET(mSocket, &socketWriteSet);
+
+			FD_SET socketErrorSet;
+			FD_ZERO(&socketErrorSet);
+			FD_SET(mSocket, &socketErrorSet);
+
+			int selResult = select((int)mSocket + 1, &socketReadSet, &socketWriteSet, &socketErrorSet, &timeout);
+			if (FD_ISSET(mSocket, &socketWriteSet))
+			{
+				TrySendData();
+				//continue;
+			}
+			if (FD_ISSET(mSocket, &socketReadSet))
+			{
+				// Just eat the data
+				uint8 data[4096];
+				int len = recv(mSocket, (char*)data, 4096, 0);
+				int b = 0;
+			}
+			if (FD_ISSET(mSocket, &socketErrorSet))
+			{
 #ifdef BF_PLATFORM_WINDOWS
-			int err = WSAGetLastError();
+				int err = WSAGetLastError();
 #endif
-			mConnectState = BpConnectState_NotConnected;
-			LostConnection();			
-			FinishWorkThread();
-			return;
+				mConnectState = BpConnectState_NotConnected;
+				LostConnection();			
+				FinishWorkThread();
+				return;
+			}
 		}
 
 		// Alloc space for size
@@ -1350,6 +1384,9 @@ void BpManager::ThreadProc()
 		else
 			mOutBuffer.Grow(-4); // No data added, pop chunk size off
 
+		if (isCapture)
+			TrySendData();
+
 		if (mOutBuffer.GetSize() == 0)
 		{			
 			if (wantsExit)
@@ -1358,7 +1395,7 @@ void BpManager::ThreadProc()
 			}
 
 			uint32 tickNow = BFTickCount();
-			if ((tickNow - gLastMsgTick >= 1000) /*&& (!wantsExit)*/)
+			if ((tickNow - gLastMsgTick >= 1000) && (!isCapture))
 			{				
 				mRootCmdTarget.KeepAlive();
 			}
@@ -1371,8 +1408,16 @@ void BpManager::ThreadProc()
 
 	mOutBuffer.Clear();
 	mConnectState = BpConnectState_NotConnected;
-	closesocket(mSocket);
-	mSocket = INVALID_SOCKET;
+	if (isCapture)
+	{
+		BfpFile_Release(mCaptureFile);
+		mCaptureFile = NULL;
+	}
+	else
+	{
+		closesocket(mSocket);
+		mSocket = INVALID_SOCKET;
+	}
 	FinishWorkThread();
 }
 
@@ -1407,17 +1452,8 @@ void BpManager::SetClientName(const StringImpl& clientName)
 	mClientName = clientName;
 }
 
-BpResult BpManager::Init(const char* serverName, const char* sessionName)
-{	
-	if (serverName == NULL)
-	{		
-		FinishWorkThread();
-		return BpResult_Ok;
-	}
-
-	if (mSocket != INVALID_SOCKET)
-		return BpResult_AlreadyInitialized;
-
+BpResult BpManager::StartSession(const char* sessionName)
+{
 	BfpGUID guid;
 	BfpSystem_CreateGUID(&guid);
 	mSessionID = StrFormat("%08X-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X",
@@ -1431,33 +1467,12 @@ BpResult BpManager::Init(const char* serverName, const char* sessionName)
 		BFP_GETSTR_HELPER(mClientName, result, BfpSystem_GetComputerName(__STR, __STRLEN, &result));
 	}
 
-#ifdef BF_PLATFORM_WINDOWS
-	WSADATA wsa;	
-	int result = WSAStartup(MAKEWORD(2, 0), &wsa);
-	if (result != 0)
-	{
-		return BpResult_InternalError;
-	}
-#endif
-
-	mSocket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (mSocket == INVALID_SOCKET)
-		return BpResult_InternalError;
-
-	u_long iMode = 1;
-#ifdef BF_PLATFORM_WINDOWS
-	result = ioctlsocket(mSocket, FIONBIO, &iMode);
-#else
-	int result = ioctl(mSocket, FIONBIO, &iMode);
-#endif
-
 	AutoCrit autoCrit(mCritSect);
 	AutoCrit autoCrit2(mRootCmdTarget.mCritSect);
 	
 	mInitCount++;
 	mThreadRunning = true;
-	mCollectData = true;
-	mServerName = serverName;
+	mCollectData = true;	
 	mSessionName = sessionName;
 	mConnectState = BpConnectState_Connecting;
 	mCurTick = 0;
@@ -1489,6 +1504,80 @@ BpResult BpManager::Init(const char* serverName, const char* sessionName)
 	return BpResult_Ok;
 }
 
+BpResult BpManager::Init(const char* serverName, const char* sessionName)
+{	
+	if (serverName == NULL)
+	{		
+		FinishWorkThread();
+		return BpResult_Ok;
+	}
+
+	// Allows headless machines to capture to disk without any changes to the host app
+	const char* capturePath = getenv("BEEFPERF_FILE");
+	if ((capturePath != NULL) && (capturePath[0] != 0))
+		return InitFile(capturePath, sessionName);
+
+	if ((mSocket != INVALID_SOCKET) || (mCaptureFile != NULL))
+		return BpResult_AlreadyInitialized;
+
+#ifdef BF_PLATFORM_WINDOWS
+	WSADATA wsa;	
+	int result = WSAStartup(MAKEWORD(2, 0), &wsa);
+	if (result != 0)
+	{
+		return BpResult_InternalError;
+	}
+#endif
+
+	mSocket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (mSocket == INVALID_SOCKET)
+		return BpResult_InternalError;
+
+	u_long iMode = 1;
+#ifdef BF_PLATFORM_WINDOWS
+	result = ioctlsocket(mSocket, FIONBIO, &iMode);
+#else
+	int result = ioctl(mSocket, FIONBIO, &iMode);
+#endif
+
+	mServerName = serverName;
+	mCapturePath.Clear();
+	return StartSession(sessionName);
+}
+
+BpResult BpManager::InitFile(const char* filePath, const char* sessionName)
+{
+	if ((mSocket != INVALID_SOCKET) || (mCaptureFile != NULL))
+		return BpResult_AlreadyInitialized;
+
+	// Reconnecting to the same capture appends a new session rather than overwriting the old one
+	bool isNewFile = mCapturePath != filePath;
+
+	BfpFileResult fileResult = BfpFileResult_Ok;
+	if (isNewFile)
+		mCaptureFile = BfpFile_Create(filePath, BfpFileCreateKind_CreateAlways, (BfpFileCreateFlags)(BfpFileCreateFlag_Write | BfpFileCreateFlag_ShareRead | BfpFileCreateFlag_Truncate), BfpFileAttribute_Normal, &fileResult);
+	else
+		mCaptureFile = BfpFile_Create(filePath, BfpFileCreateKind_OpenExisting, (BfpFileCreateFlags)(BfpFileCreateFlag_Write | BfpFileCreateFlag_ShareRead | BfpFileCreateFlag_Append), BfpFileAttribute_Normal, &fileResult);
+	if (mCaptureFile == NULL)
+		return BpResult_FileError;
+
+	if (isNewFile)
+	{
+		int32 header[2] = { BP_CAPTURE_MAGIC, BP_CAPTURE_VERSION };
+		BfpFile_Write(mCaptureFile, header, sizeof(header), -1, &fileResult);
+		if (fileResult != BfpFileResult_Ok)
+		{
+			BfpFile_Release(mCaptureFile);
+			mCaptureFile = NULL;
+			return BpResult_FileError;
+		}
+	}
+
+	mServerName.Clear();
+	mCapturePath = filePath;
+	return StartSession(sessionName);
+}
+
 void BpManager::RetryConnect()
 {
 	{
@@ -1498,7 +1587,10 @@ void BpManager::RetryConnect()
 			return;
 	}
 	Shutdown();
-	Init(mServerName.c_str(), mSessionName.c_str());
+	if (!mCapturePath.IsEmpty())
+		InitFile(mCapturePath.c_str(), mSessionName.c_str());
+	else
+		Init(mServerName.c_str(), mSessionName.c_str());
 }
 
 void BpManager::Pause()
@@ -1661,6 +1753,11 @@ BP_EXPORT void BP_CALLTYPE BpInit(const char* serverName, const char* sessionNam
 	BpManager::Get()->Init(serverName, sessionName);
 }
 
+BP_EXPORT void BP_CALLTYPE BpInitFile(const char* filePath, const char* sessionName)
+{
+	BpManager::Get()->InitFile(filePath, sessionName);
+}
+
 BP_EXPORT BpConnectState BP_CALLTYPE BpGetConnectState()
 {
 	return BpManager::Get()->mConnectState;
@@ -1755,6 +1852,11 @@ BP_EXPORT void BP_CALLTYPE BpInit(const char* serverName, const char* sessionNam
 	
 }
 
+BP_EXPORT void BP_CALLTYPE BpInitFile(const char* filePath, const char* sessionName)
+{
+
+}
+
 BP_EXPORT void BP_CALLTYPE BpSetThreadName(const char* threadName)
 {
 	
@@ -98,7 +98,8 @@ enum BpResult
 {
 	BpResult_Ok = 0,
 	BpResult_InternalError,
-	BpResult_AlreadyInitialized
+	BpResult_AlreadyInitialized,
+	BpResult_FileError
 };
 
 #define BP_CHUNKSIZE 4096
@@ -106,6 +107,10 @@ enum BpResult
 
 #define BP_CLIENT_VERSION 2
 
+// Offline captures hold the same chunked command stream we would send to the server, after this header
+#define BP_CAPTURE_MAGIC 0x46504642 // 'BFPF'
+#define BP_CAPTURE_VERSION 1
+
 enum BpCmd
 {
 	BpCmd_Init,
@@ -194,6 +199,8 @@ public:
 	HANDLE mSharedMemoryFile;
 #endif
 	SOCKET mSocket;
+	BfpFile* mCaptureFile;
+	String mCapturePath;
 	BfpThread* mThread;
 	BfpThreadId mThreadId;
 	String mServerName;
@@ -226,6 +233,7 @@ public:
 
 protected:	
 	bool Connect();	
+	BpResult StartSession(const char* sessionName);
 	void FinishWorkThread();
 	void ThreadProc();	
 	static void BFP_CALLTYPE ThreadProcThunk(void* ptr);
@@ -247,6 +255,7 @@ public:
 
 	void SetClientName(const StringImpl& clientName);
 	BpResult Init(const char* serverName, const char* sessionName);
+	BpResult InitFile(const char* filePath, const char* sessionName);
 	void RetryConnect();
 	void Pause();
 	void Unpause();
@@ -325,6 +334,7 @@ public:
 #endif
 
 BP_EXPORT void BP_CALLTYPE BpInit(const char* serverName, const char* sessionName);
+BP_EXPORT void BP_CALLTYPE BpInitFile(const char* filePath, const char* sessionName);
 BP_EXPORT void BP_CALLTYPE BpShutdown();
 BP_EXPORT BpConnectState BP_CALLTYPE BpGetConnectState();
 BP_EXPORT void BP_CALLTYPE BpRetryConnect();
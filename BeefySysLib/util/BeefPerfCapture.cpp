@@ -0,0 +1,481 @@
+#include "BeefPerfCapture.h"
+#include "BeefPerf.h"
+#include "Dictionary.h"
+#include "../FileStream.h"
+
+#pragma warning(disable:4996)
+
+USING_NS_BF;
+
+#define GET_FROM(ptr, T) *((T*)(ptr += sizeof(T)) - 1)
+
+// Returns false if the value runs past dataEnd
+static bool DecodeSLEB128(uint8*& p, uint8* dataEnd, int64& value)
+{
+	value = 0;
+	int shift = 0;
+	int curByte;
+	do
+	{
+		if (p >= dataEnd)
+			return false;
+		curByte = *(p++);
+		if (shift < 64)
+			value |= ((int64)(curByte & 0x7f) << shift);
+		shift += 7;
+	}
+	while (curByte >= 128);
+	// Sign extend negative numbers
+	if (((curByte & 0x40) != 0) && (shift < 64))
+		value |= (int64)(~0ULL << shift);
+	return true;
+}
+
+// Returns the NUL-terminated string at p, or NULL if the terminator isn't before dataEnd
+static const char* DecodeString(uint8*& p, uint8* dataEnd)
+{
+	const char* str = (const char*)p;
+	uint8* strEnd = (uint8*)memchr(p, 0, dataEnd - p);
+	if (strEnd == NULL)
+		return NULL;
+	p = strEnd + 1;
+	return str;
+}
+
+static void WriteJsonString(DataStream& stream, const StringImpl& str)
+{
+	String escaped;
+	escaped.Reserve(str.length() + 2);
+	escaped.Append('"');
+	for (int i = 0; i < (int)str.length(); i++)
+	{
+		char c = str[i];
+		switch (c)
+		{
+		case '"':
+			escaped.Append("\\\"");
+			break;
+		case '\\':
+			escaped.Append("\\\\");
+			break;
+		case '\n':
+			escaped.Append("\\n");
+			break;
+		case '\r':
+			escaped.Append("\\r");
+			break;
+		case '\t':
+			escaped.Append("\\t");
+			break;
+		default:
+			if ((uint8)c < 0x20)
+				escaped.Append(StrFormat("\\u%04X", (uint8)c));
+			else
+				escaped.Append(c);
+		}
+	}
+	escaped.Append('"');
+	stream.WriteSNZ(escaped);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+BpCaptureReader::BpCaptureReader()
+{
+	mTickFreq = 0;
+	mFirstTick = -1;
+	mCurTick = 0;
+	mCurThreadId = 0;
+}
+
+bool BpCaptureReader::Fail(const StringImpl& error)
+{
+	if (mError.IsEmpty())
+		mError = error;
+	return false;
+}
+
+void BpCaptureReader::FormatZone(const char* name, uint8* params, int paramsSize, String& outStr)
+{
+	uint8* paramsEnd = params + paramsSize;
+	const char* cPtr = name;
+	while (true)
+	{
+		char c = *(cPtr++);
+		if (c == 0)
+			break;
+		if (c != '%')
+		{
+			outStr.Append(c);
+			continue;
+		}
+
+		char nextC = *(cPtr++);
+		if (nextC == 0)
+			break;
+		if (nextC == '%')
+		{
+			outStr.Append(nextC);
+		}
+		// A truncated capture ends the name at the first parameter that isn't all there
+		else if (nextC == 'f')
+		{
+			if (paramsEnd - params < (int)sizeof(float))
+				break;
+			outStr += StrFormat("%f", GET_FROM(params, float));
+		}
+		else if (nextC == 'd')
+		{
+			if (paramsEnd - params < (int)sizeof(int32))
+				break;
+			outStr += StrFormat("%d", GET_FROM(params, int32));
+		}
+		else if (nextC == 's')
+		{
+			if (params >= paramsEnd)
+				break;
+			const char* str = (const char*)params;
+			int len = (int)strnlen(str, paramsEnd - params);
+			outStr.Append(str, len);
+			params += len + 1;
+		}
+	}
+}
+
+bool BpCaptureReader::DecodeChunk(uint8* data, uint8* dataEnd)
+{
+	auto _AddEvent = [&](BpCaptureEventKind kind)
+	{
+		BpCaptureEvent event;
+		event.mKind = kind;
+		event.mThreadId = mCurThreadId;
+		event.mTick = mCurTick;
+		mEvents.Add(event);
+		return &mEvents.back();
+	};
+
+	// Every field is checked against the end of the chunk, so a truncated or corrupt chunk is rejected rather than
+	//  read past
+	bool truncated = false;
+	auto _ReadSLEB128 = [&]()
+	{
+		int64 value = 0;
+		if (!DecodeSLEB128(data, dataEnd, value))
+			truncated = true;
+		return value;
+	};
+	auto _ReadString = [&]()
+	{
+		const char* str = DecodeString(data, dataEnd);
+		if (str == NULL)
+		{
+			truncated = true;
+			return "";
+		}
+		return str;
+	};
+
+	while (data < dataEnd)
+	{
+		BpCmd cmd = (BpCmd)*(data++);
+		switch (cmd)
+		{
+		case BpCmd_Init:
+			{
+				_ReadSLEB128();
+				const char* env = _ReadString();
+				if (truncated)
+					break;
+
+				// A new session restarts the string table and the delta-encoded tick
+				mZoneNames.Clear();
+				mCurTick = 0;
+
+				const char* namePtr = strstr(env, "SessionName\t");
+				if (namePtr != NULL)
+				{
+					namePtr += strlen("SessionName\t");
+					const char* nameEnd = strchr(namePtr, '\n');
+					mSessionName = String(namePtr, (nameEnd != NULL) ? (int)(nameEnd - namePtr) : (int)strlen(namePtr));
+				}
+			}
+			break;
+		case BpCmd_ClockInfo:
+			{
+				_ReadSLEB128();
+				_ReadSLEB128();
+				_ReadSLEB128();
+				int64 freq = _ReadSLEB128();
+				if ((!truncated) && (mTickFreq == 0))
+					mTickFreq = freq;
+			}
+			break;
+		case BpCmd_SetThread:
+			mCurThreadId = (int)_ReadSLEB128();
+			break;
+		case BpCmd_StrEntry:
+			{
+				ZoneName zoneName;
+				zoneName.mName = _ReadString();
+				zoneName.mParamsSize = 0;
+				if (truncated)
+					break;
+
+				for (int i = 0; i < (int)zoneName.mName.length() - 1; i++)
+				{
+					if (zoneName.mName[i] != '%')
+						continue;
+					char nextC = zoneName.mName[++i];
+					if ((nextC == 'f') || (nextC == 'd'))
+						zoneName.mParamsSize += 4;
+					else if (nextC == 's')
+					{
+						zoneName.mParamsSize = -1;
+						break;
+					}
+				}
+				mZoneNames.Add(zoneName);
+			}
+			break;
+		case BpCmd_Enter:
+			{
+				mCurTick += _ReadSLEB128();
+				int64 strIdx = _ReadSLEB128();
+				if (truncated)
+					break;
+
+				String name;
+				int64 paramsSize;
+				if (strIdx < 0)
+				{
+					if (-strIdx > dataEnd - data)
+					{
+						truncated = true;
+						break;
+					}
+					name.Append((const char*)data, (int)-strIdx);
+					data += -strIdx;
+					paramsSize = -1;
+				}
+				else
+				{
+					if (strIdx >= mZoneNames.size())
+						return Fail(StrFormat("Invalid zone name index %lld", (long long)strIdx));
+					name = mZoneNames[(int)strIdx].mName;
+					paramsSize = mZoneNames[(int)strIdx].mParamsSize;
+				}
+
+				if (paramsSize == -1)
+					paramsSize = _ReadSLEB128();
+				if ((truncated) || (paramsSize < 0) || (paramsSize > dataEnd - data))
+				{
+					truncated = true;
+					break;
+				}
+
+				auto event = _AddEvent(BpCaptureEventKind_Enter);
+				FormatZone(name.c_str(), data, (int)paramsSize, event->mName);
+				data += paramsSize;
+			}
+			break;
+		case BpCmd_Leave:
+			mCurTick += _ReadSLEB128();
+			if (!truncated)
+				_AddEvent(BpCaptureEventKind_Leave);
+			break;
+		case BpCmd_Tick:
+			mCurTick += _ReadSLEB128();
+			if (!truncated)
+				_AddEvent(BpCaptureEventKind_Tick);
+			break;
+		case BpCmd_KeepAlive:
+		case BpCmd_ThreadRemove:
+			mCurTick += _ReadSLEB128();
+			break;
+		case BpCmd_ThreadAdd:
+			mCurTick += _ReadSLEB128();
+			_ReadSLEB128();
+			_ReadSLEB128();
+			break;
+		case BpCmd_ThreadName:
+			{
+				const char* threadName = _ReadString();
+				if (!truncated)
+					_AddEvent(BpCaptureEventKind_ThreadName)->mName = threadName;
+			}
+			break;
+		case BpCmd_Event:
+			{
+				mCurTick += _ReadSLEB128();
+				const char* eventName = _ReadString();
+				const char* details = _ReadString();
+				if (truncated)
+					break;
+				auto event = _AddEvent(BpCaptureEventKind_Event);
+				event->mName = eventName;
+				event->mDetails = details;
+			}
+			break;
+		default:
+			return Fail(StrFormat("Unhandled command %d", cmd));
+		}
+
+		if (truncated)
+			return Fail(StrFormat("Truncated command %d", cmd));
+	}
+
+	return true;
+}
+
+bool BpCaptureReader::Load(const StringImpl& capturePath)
+{
+	int fileSize = 0;
+	uint8* fileData = LoadBinaryData(capturePath, &fileSize);
+	if (fileData == NULL)
+		return Fail(StrFormat("Unable to read '%s'", capturePath.c_str()));
+
+	uint8* data = fileData;
+	uint8* dataEnd = fileData + fileSize;
+
+	bool success = true;
+	if ((fileSize < 8) || (GET_FROM(data, int32) != BP_CAPTURE_MAGIC))
+		success = Fail(StrFormat("'%s' is not a BeefPerf capture", capturePath.c_str()));
+	else if (GET_FROM(data, int32) != BP_CAPTURE_VERSION)
+		success = Fail(StrFormat("'%s' has an unsupported capture version", capturePath.c_str()));
+
+	while ((success) && (data + 4 <= dataEnd))
+	{
+		int chunkSize = GET_FROM(data, int32);
+		if ((chunkSize < 0) || (data + chunkSize > dataEnd))
+		{
+			// Truncated capture, such as from a crashed process - keep what we have
+			break;
+		}
+		success = DecodeChunk(data, data + chunkSize);
+		data += chunkSize;
+	}
+
+	delete [] fileData;
+	return success;
+}
+
+double BpCaptureReader::TickToMicroseconds(int64 tick)
+{
+	// Ticks are BfpSystem_GetCPUTick()/100
+	double freq = (mTickFreq > 0) ? (double)mTickFreq : 1000000000.0;
+	return (double)(tick - mFirstTick) * 100.0 * 1000000.0 / freq;
+}
+
+bool BpCaptureReader::WriteChromeTrace(const StringImpl& outPath)
+{
+	FileStream fs;
+	if (!fs.Open(outPath, "wb"))
+		return Fail(StrFormat("Unable to create '%s'", outPath.c_str()));
+
+	// Command targets are flushed one after another, so the earliest tick isn't necessarily the first one decoded
+	mFirstTick = -1;
+	for (auto& event : mEvents)
+	{
+		if (event.mKind == BpCaptureEventKind_ThreadName)
+			continue;
+		if ((mFirstTick == -1) || (event.mTick < mFirstTick))
+			mFirstTick = event.mTick;
+	}
+
+	fs.WriteSNZ("{\"traceEvents\":[\n");
+
+	bool isFirst = true;
+	auto _StartEvent = [&](const char* phase, BpCaptureEvent& event)
+	{
+		if (!isFirst)
+			fs.WriteSNZ(",\n");
+		isFirst = false;
+		fs.WriteSNZ(StrFormat("{\"ph\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", phase, event.mThreadId, TickToMicroseconds(event.mTick)));
+	};
+
+	if (!mSessionName.IsEmpty())
+	{
+		fs.WriteSNZ("{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":");
+		WriteJsonString(fs, mSessionName);
+		fs.WriteSNZ("}}");
+		isFirst = false;
+	}
+
+	// Chrome requires balanced B/E pairs, so close out any zones still open at the end of the capture
+	Dictionary<int, int> threadDepths;
+	int64 lastTick = mFirstTick;
+
+	for (auto& event : mEvents)
+	{
+		lastTick = BF_MAX(lastTick, event.mTick);
+		switch (event.mKind)
+		{
+		case BpCaptureEventKind_Enter:
+			_StartEvent("B", event);
+			fs.WriteSNZ(",\"name\":");
+			WriteJsonString(fs, event.mName);
+			fs.WriteSNZ("}");
+			threadDepths[event.mThreadId]++;
+			break;
+		case BpCaptureEventKind_Leave:
+			{
+				int* depthPtr = NULL;
+				if ((!threadDepths.TryGetValue(event.mThreadId, &depthPtr)) || (*depthPtr == 0))
+					break;
+				(*depthPtr)--;
+				_StartEvent("E", event);
+				fs.WriteSNZ("}");
+			}
+			break;
+		case BpCaptureEventKind_Event:
+			_StartEvent("i", event);
+			fs.WriteSNZ(",\"s\":\"t\",\"name\":");
+			WriteJsonString(fs, event.mName);
+			fs.WriteSNZ(",\"args\":{\"details\":");
+			WriteJsonString(fs, event.mDetails);
+			fs.WriteSNZ("}}");
+			break;
+		case BpCaptureEventKind_Tick:
+			_StartEvent("i", event);
+			fs.WriteSNZ(",\"s\":\"g\",\"name\":\"Tick\"}");
+			break;
+		case BpCaptureEventKind_ThreadName:
+			if (!isFirst)
+				fs.WriteSNZ(",\n");
+			isFirst = false;
+			fs.WriteSNZ(StrFormat("{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":", event.mThreadId));
+			WriteJsonString(fs, event.mName);
+			fs.WriteSNZ("}}");
+			break;
+		}
+	}
+
+	for (auto& kv : threadDepths)
+	{
+		BpCaptureEvent closeEvent;
+		closeEvent.mThreadId = kv.mKey;
+		closeEvent.mTick = lastTick;
+		for (int i = 0; i < kv.mValue; i++)
+		{
+			_StartEvent("E", closeEvent);
+			fs.WriteSNZ("}");
+		}
+	}
+
+	fs.WriteSNZ("\n],\"displayTimeUnit\":\"ms\"}\n");
+	fs.Close();
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+BF_EXPORT bool BF_CALLTYPE BpCapture_ConvertToChromeTrace(const char* capturePath, const char* outPath)
+{
+	BpCaptureReader reader;
+	if ((!reader.Load(capturePath)) || (!reader.WriteChromeTrace(outPath)))
+	{
+		OutputDebugStrF("BeefPerf capture conversion failed: %s\n", reader.mError.c_str());
+		return false;
+	}
+	return true;
+}
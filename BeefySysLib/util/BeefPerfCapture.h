@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../Common.h"
+#include "Array.h"
+
+NS_BF_BEGIN;
+
+enum BpCaptureEventKind
+{
+	BpCaptureEventKind_Enter,
+	BpCaptureEventKind_Leave,
+	BpCaptureEventKind_Event,
+	BpCaptureEventKind_Tick,
+	BpCaptureEventKind_ThreadName
+};
+
+struct BpCaptureEvent
+{
+	BpCaptureEventKind mKind;
+	int mThreadId;
+	int64 mTick;
+	String mName;
+	String mDetails;
+};
+
+// Decodes an offline BeefPerf capture written by BpManager::InitFile and re-emits it in a format that
+//  third-party trace viewers can load
+class BpCaptureReader
+{
+public:
+	struct ZoneName
+	{
+		String mName;
+		int mParamsSize;
+	};
+
+public:
+	Array<BpCaptureEvent> mEvents;
+	Array<ZoneName> mZoneNames;
+	String mSessionName;
+	String mError;
+	int64 mTickFreq;
+	int64 mFirstTick;
+
+	// Decoding state carries across chunks - the tick is delta-encoded and shared between all threads
+	int64 mCurTick;
+	int mCurThreadId;
+
+protected:
+	bool Fail(const StringImpl& error);
+	bool DecodeChunk(uint8* data, uint8* dataEnd);
+	void FormatZone(const char* name, uint8* params, int paramsSize, String& outStr);
+	double TickToMicroseconds(int64 tick);
+
+public:
+	BpCaptureReader();
+
+	bool Load(const StringImpl& capturePath);
+	bool WriteChromeTrace(const StringImpl& outPath);
+};
+
+NS_BF_END;
+
+BF_EXPORT bool BF_CALLTYPE BpCapture_ConvertToChromeTrace(const char* capturePath, const char* outPath);
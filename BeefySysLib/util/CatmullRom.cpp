@@ -1,4 +1,12 @@
 #include "CatmullRom.h"
+#include "Vector.h"
+
+#if !defined BF_MATH_NO_SIMD
+#if (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_MATH_SSE2
+#include <emmintrin.h>
+#endif
+#endif
 
 USING_NS_BF;
 
@@ -22,3 +30,40 @@ Point2D Beefy::CatmullRomEvaluate(Point2D &p0, Point2D &p1, Point2D &p2, Point2D
 	
 	return Point2D(x,y);
 }
+
+void Beefy::CatmullRomEvaluateBatch(const Point2D& p0, const Point2D& p1, const Point2D& p2, const Point2D& p3, float tension, const float* ts, Point2D* out, int count)
+{
+	int idx = 0;
+#ifdef BF_MATH_SSE2
+	if ((gMathFlags & MathFlag_NoSimd) == 0)
+	{
+		__m128 s = _mm_set1_ps((1 - tension) / 2);
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 two = _mm_set1_ps(2.0f);
+		__m128 three = _mm_set1_ps(3.0f);
+		__m128 signMask = _mm_set1_ps(-0.0f);
+		for (; idx + 4 <= count; idx += 4)
+		{
+			// Basis weights for four parameters, in the same order as CatmullRomEvaluate
+			__m128 t = _mm_loadu_ps(ts + idx);
+			__m128 t2 = _mm_mul_ps(t, t);
+			__m128 t3 = _mm_mul_ps(t2, t);
+			__m128 negT3 = _mm_xor_ps(t3, signMask);
+			__m128 b1 = _mm_mul_ps(s, _mm_sub_ps(_mm_add_ps(negT3, _mm_mul_ps(two, t2)), t));
+			__m128 b2 = _mm_add_ps(_mm_mul_ps(s, _mm_add_ps(negT3, t2)), _mm_add_ps(_mm_sub_ps(_mm_mul_ps(two, t3), _mm_mul_ps(three, t2)), one));
+			__m128 b3 = _mm_add_ps(_mm_mul_ps(s, _mm_add_ps(_mm_sub_ps(t3, _mm_mul_ps(two, t2)), t)),
+				_mm_add_ps(_mm_mul_ps(_mm_xor_ps(two, signMask), t3), _mm_mul_ps(three, t2)));
+			__m128 b4 = _mm_mul_ps(s, _mm_sub_ps(t3, t2));
+
+			__m128 x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p0.mX), b1), _mm_mul_ps(_mm_set1_ps(p1.mX), b2)),
+				_mm_mul_ps(_mm_set1_ps(p2.mX), b3)), _mm_mul_ps(_mm_set1_ps(p3.mX), b4));
+			__m128 y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(p0.mY), b1), _mm_mul_ps(_mm_set1_ps(p1.mY), b2)),
+				_mm_mul_ps(_mm_set1_ps(p2.mY), b3)), _mm_mul_ps(_mm_set1_ps(p3.mY), b4));
+			_mm_storeu_ps(&out[idx].mX, _mm_unpacklo_ps(x, y));
+			_mm_storeu_ps(&out[idx + 2].mX, _mm_unpackhi_ps(x, y));
+		}
+	}
+#endif
+	for (; idx < count; idx++)
+		out[idx] = CatmullRomEvaluate((Point2D&)p0, (Point2D&)p1, (Point2D&)p2, (Point2D&)p3, tension, ts[idx]);
+}
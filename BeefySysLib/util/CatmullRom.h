@@ -6,5 +6,7 @@
 NS_BF_BEGIN;
 
 Point2D CatmullRomEvaluate(Point2D &p0, Point2D &p1, Point2D &p2, Point2D &p3, float tension, float t);
+// Evaluates one segment at many parameters, four at a time with SSE2
+void CatmullRomEvaluateBatch(const Point2D& p0, const Point2D& p1, const Point2D& p2, const Point2D& p3, float tension, const float* ts, Point2D* out, int count);
 
 NS_BF_END;
@@ -1,4 +1,12 @@
 #include "CubicSpline.h"
+#include "Vector.h"
+
+#if !defined BF_MATH_NO_SIMD
+#if (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_MATH_SSE2
+#include <emmintrin.h>
+#endif
+#endif
 
 USING_NS_BF;
   
@@ -106,4 +114,51 @@ Point2D CubicSpline2D::Evaluate(float t)
 		return mInputPoints[mInputPoints.size() - 1];
 
 	return Point2D(mXCubicArray[idx].Evaluate(frac), mYCubicArray[idx].Evaluate(frac));
-}
\ No newline at end of file
+}
+
+void CubicSpline2D::EvaluateBatch(const float* ts, Point2D* out, int count)
+{
+	if (mXCubicArray == NULL)
+		Calculate();
+
+	int idx = 0;
+#ifdef BF_MATH_SSE2
+	if ((gMathFlags & MathFlag_NoSimd) == 0)
+	{
+		__m128i maxSegment = _mm_set1_epi32((int)mInputPoints.size() - 2);
+		for (; idx + 4 <= count; idx += 4)
+		{
+			__m128 t = _mm_loadu_ps(ts + idx);
+			__m128i segment = _mm_cvttps_epi32(t);
+			// Parameters before the start or at the end take the scalar path
+			__m128i outside = _mm_or_si128(_mm_cmplt_epi32(segment, _mm_setzero_si128()), _mm_cmpgt_epi32(segment, maxSegment));
+			if (_mm_movemask_epi8(outside) != 0)
+			{
+				for (int laneIdx = 0; laneIdx < 4; laneIdx++)
+					out[idx + laneIdx] = Evaluate(ts[idx + laneIdx]);
+				continue;
+			}
+
+			__m128 frac = _mm_sub_ps(t, _mm_cvtepi32_ps(segment));
+			int segments[4];
+			_mm_storeu_si128((__m128i*)segments, segment);
+			// CubicVal is a, b, c, d in order, so each segment's coefficients transpose into one register per term
+			__m128 values[2];
+			CubicVal* cubicArrays[2] = { mXCubicArray, mYCubicArray };
+			for (int axis = 0; axis < 2; axis++)
+			{
+				__m128 a = _mm_loadu_ps(&cubicArrays[axis][segments[0]].a);
+				__m128 b = _mm_loadu_ps(&cubicArrays[axis][segments[1]].a);
+				__m128 c = _mm_loadu_ps(&cubicArrays[axis][segments[2]].a);
+				__m128 d = _mm_loadu_ps(&cubicArrays[axis][segments[3]].a);
+				_MM_TRANSPOSE4_PS(a, b, c, d);
+				values[axis] = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(d, frac), c), frac), b), frac), a);
+			}
+			_mm_storeu_ps(&out[idx].mX, _mm_unpacklo_ps(values[0], values[1]));
+			_mm_storeu_ps(&out[idx + 2].mX, _mm_unpackhi_ps(values[0], values[1]));
+		}
+	}
+#endif
+	for (; idx < count; idx++)
+		out[idx] = Evaluate(ts[idx]);
+}
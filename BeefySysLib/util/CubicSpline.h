@@ -54,6 +54,8 @@ public:
 
 	void					Calculate();
 	Point2D					Evaluate(float t);
+	// Evaluate over many parameters, four at a time with SSE2
+	void					EvaluateBatch(const float* ts, Point2D* out, int count);
 };
 
 NS_BF_END;
@@ -1,5 +1,12 @@
 #include "MappedFile.h"
 
+#ifndef BF_PLATFORM_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 USING_NS_BF;
 
 #ifdef BF_PLATFORM_WINDOWS
@@ -43,4 +50,42 @@ bool MappedFile::Open(const StringImpl& fileName)
 	return true;
 }
 
-#endif
\ No newline at end of file
+#else
+
+MappedFile::MappedFile()
+{
+	mData = NULL;
+	mFileSize = 0;
+}
+
+MappedFile::~MappedFile()
+{
+	if (mData != NULL)
+		munmap(mData, mFileSize);
+}
+
+bool MappedFile::Open(const StringImpl& fileName)
+{
+	mFileName = fileName;
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+
+	struct stat fileStat;
+	if ((fstat(fd, &fileStat) != 0) || (fileStat.st_size <= 0) || (fileStat.st_size > 0x7FFFFFFF))
+	{
+		close(fd);
+		return false;
+	}
+
+	mFileSize = (int)fileStat.st_size;
+	void* data = mmap(NULL, mFileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping holds its own reference to the file
+	close(fd);
+	if (data == MAP_FAILED)
+		return false;
+	mData = data;
+	return true;
+}
+
+#endif
@@ -4,16 +4,19 @@
 
 NS_BF_BEGIN
 
-#ifdef BF_PLATFORM_WINDOWS
-
+// A read-only view of a whole file
 class MappedFile
 {
 	BF_DISALLOW_COPY(MappedFile);
 public:
 	String mFileName;
+#ifdef BF_PLATFORM_WINDOWS
 	HANDLE mMappedFile;
 	void* mData;
 	HANDLE mMappedFileMapping;
+#else
+	void* mData;
+#endif
 	int mFileSize;
 
 public:
@@ -23,6 +26,4 @@ public:
 	~MappedFile();
 };
 
-#endif //BF_PLATFORM_WINDOWS
-
 NS_BF_END
\ No newline at end of file
@@ -1,6 +1,17 @@
 #include "Matrix4.h"
 #include "Quaternion.h"
 
+#if !defined BF_MATH_NO_SIMD
+#if defined __AVX__
+#define BF_MATH_AVX
+#include <immintrin.h>
+#endif
+#if (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_MATH_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
 USING_NS_BF;
 
 Matrix4 Matrix4::sIdentity(
@@ -23,3 +34,70 @@ Matrix4 Matrix4::CreateTransform(const Vector3& position, const Vector3& scale,
 		scale.mX * rot.m20, scale.mY * rot.m21, scale.mZ * rot.m22, position.mZ,	
 		0, 0, 0, 1);
 }
+
+#ifdef BF_MATH_SSE2
+// Each result row is the sum of m2's rows scaled by the row of m1, added in the same order as Multiply
+static inline void MultiplyMatrixSimd(const Matrix4& m1, const Matrix4& m2, Matrix4* out)
+{
+#ifdef BF_MATH_AVX
+	__m256 row0 = _mm256_broadcast_ps((const __m128*)m2.mMat[0]);
+	__m256 row1 = _mm256_broadcast_ps((const __m128*)m2.mMat[1]);
+	__m256 row2 = _mm256_broadcast_ps((const __m128*)m2.mMat[2]);
+	__m256 row3 = _mm256_broadcast_ps((const __m128*)m2.mMat[3]);
+	for (int rowIdx = 0; rowIdx < 4; rowIdx += 2)
+	{
+		// Two rows of m1 at once
+		const float* m1Row = m1.mMatFlat + rowIdx * 4;
+		__m256 result = _mm256_mul_ps(_mm256_setr_ps(m1Row[0], m1Row[0], m1Row[0], m1Row[0], m1Row[4], m1Row[4], m1Row[4], m1Row[4]), row0);
+		result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_setr_ps(m1Row[1], m1Row[1], m1Row[1], m1Row[1], m1Row[5], m1Row[5], m1Row[5], m1Row[5]), row1));
+		result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_setr_ps(m1Row[2], m1Row[2], m1Row[2], m1Row[2], m1Row[6], m1Row[6], m1Row[6], m1Row[6]), row2));
+		result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_setr_ps(m1Row[3], m1Row[3], m1Row[3], m1Row[3], m1Row[7], m1Row[7], m1Row[7], m1Row[7]), row3));
+		_mm256_storeu_ps(out->mMatFlat + rowIdx * 4, result);
+	}
+#else
+	__m128 row0 = _mm_loadu_ps(m2.mMat[0]);
+	__m128 row1 = _mm_loadu_ps(m2.mMat[1]);
+	__m128 row2 = _mm_loadu_ps(m2.mMat[2]);
+	__m128 row3 = _mm_loadu_ps(m2.mMat[3]);
+	for (int rowIdx = 0; rowIdx < 4; rowIdx++)
+	{
+		const float* m1Row = m1.mMat[rowIdx];
+		__m128 result = _mm_mul_ps(_mm_set1_ps(m1Row[0]), row0);
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(m1Row[1]), row1));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(m1Row[2]), row2));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(m1Row[3]), row3));
+		_mm_storeu_ps(out->mMat[rowIdx], result);
+	}
+#endif
+}
+#endif
+
+void Matrix4::MultiplyBatch(const Matrix4* m1, const Matrix4* m2, Matrix4* out, int count)
+{
+#ifdef BF_MATH_SSE2
+	if ((gMathFlags & MathFlag_NoSimd) == 0)
+	{
+		for (int idx = 0; idx < count; idx++)
+			MultiplyMatrixSimd(m1[idx], m2[idx], &out[idx]);
+		return;
+	}
+#endif
+	for (int idx = 0; idx < count; idx++)
+		out[idx] = Multiply(m1[idx], m2[idx]);
+}
+
+void Matrix4::MultiplyBatch(const Matrix4& m1, const Matrix4* m2, Matrix4* out, int count)
+{
+	// Copied in case 'out' overlaps it
+	Matrix4 left = m1;
+#ifdef BF_MATH_SSE2
+	if ((gMathFlags & MathFlag_NoSimd) == 0)
+	{
+		for (int idx = 0; idx < count; idx++)
+			MultiplyMatrixSimd(left, m2[idx], &out[idx]);
+		return;
+	}
+#endif
+	for (int idx = 0; idx < count; idx++)
+		out[idx] = Multiply(left, m2[idx]);
+}
@@ -90,6 +90,10 @@ public:
 		return r;
 	}
 
+	// Multiply over arrays of matrices, a row (or two rows with AVX) per instruction. 'out' may alias either input.
+	static void MultiplyBatch(const Matrix4* m1, const Matrix4* m2, Matrix4* out, int count);
+	static void MultiplyBatch(const Matrix4& m1, const Matrix4* m2, Matrix4* out, int count);
+
 	static Matrix4 Transpose(const Matrix4 &m)
 	{
 		return Matrix4(
@@ -1,5 +1,12 @@
 #include "Quaternion.h"
 
+#if !defined BF_MATH_NO_SIMD
+#if (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_MATH_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
 USING_NS_BF;
 
 Quaternion Beefy::operator* (float fScalar, const Quaternion& rkQ)
@@ -51,3 +58,112 @@ Beefy::Quaternion Beefy::Quaternion::Slerp(float fT, const Quaternion& rkP, cons
 		//return (fT < 0.5f) ? rkP : rkQ;
 	}
 }
+
+void Quaternion::ToMatrixBatch(const Quaternion* quats, Matrix4* out, int count)
+{
+	int idx = 0;
+#ifdef BF_MATH_SSE2
+	if ((gMathFlags & MathFlag_NoSimd) == 0)
+	{
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 zero = _mm_setzero_ps();
+		for (; idx + 4 <= count; idx += 4)
+		{
+			// One quaternion per lane, then the same steps as ToMatrix
+			__m128 x = _mm_loadu_ps(&quats[idx].mX);
+			__m128 y = _mm_loadu_ps(&quats[idx + 1].mX);
+			__m128 z = _mm_loadu_ps(&quats[idx + 2].mX);
+			__m128 w = _mm_loadu_ps(&quats[idx + 3].mX);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			__m128 tx = _mm_add_ps(x, x);
+			__m128 ty = _mm_add_ps(y, y);
+			__m128 tz = _mm_add_ps(z, z);
+			__m128 twx = _mm_mul_ps(tx, w);
+			__m128 twy = _mm_mul_ps(ty, w);
+			__m128 twz = _mm_mul_ps(tz, w);
+			__m128 txx = _mm_mul_ps(tx, x);
+			__m128 txy = _mm_mul_ps(ty, x);
+			__m128 txz = _mm_mul_ps(tz, x);
+			__m128 tyy = _mm_mul_ps(ty, y);
+			__m128 tyz = _mm_mul_ps(tz, y);
+			__m128 tzz = _mm_mul_ps(tz, z);
+
+			__m128 row0[4] = { _mm_sub_ps(one, _mm_add_ps(tyy, tzz)), _mm_sub_ps(txy, twz), _mm_add_ps(txz, twy), zero };
+			__m128 row1[4] = { _mm_add_ps(txy, twz), _mm_sub_ps(one, _mm_add_ps(txx, tzz)), _mm_sub_ps(tyz, twx), zero };
+			__m128 row2[4] = { _mm_sub_ps(txz, twy), _mm_add_ps(tyz, twx), _mm_sub_ps(one, _mm_add_ps(txx, tyy)), zero };
+			_MM_TRANSPOSE4_PS(row0[0], row0[1], row0[2], row0[3]);
+			_MM_TRANSPOSE4_PS(row1[0], row1[1], row1[2], row1[3]);
+			_MM_TRANSPOSE4_PS(row2[0], row2[1], row2[2], row2[3]);
+			for (int laneIdx = 0; laneIdx < 4; laneIdx++)
+			{
+				Matrix4* mat = &out[idx + laneIdx];
+				_mm_storeu_ps(mat->mMat[0], row0[laneIdx]);
+				_mm_storeu_ps(mat->mMat[1], row1[laneIdx]);
+				_mm_storeu_ps(mat->mMat[2], row2[laneIdx]);
+				_mm_storeu_ps(mat->mMat[3], _mm_setr_ps(0, 0, 0, 1.0f));
+			}
+		}
+	}
+#endif
+	for (; idx < count; idx++)
+		out[idx] = quats[idx].ToMatrix();
+}
+
+void Quaternion::SlerpBatch(const float* fTs, const Quaternion* rkPs, const Quaternion* rkQs, Quaternion* out, int count, bool shortestPath)
+{
+	int idx = 0;
+#ifdef BF_MATH_SSE2
+	if ((gMathFlags & MathFlag_NoSimd) == 0)
+	{
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 signMask = _mm_set1_ps(-0.0f);
+		for (; idx + 4 <= count; idx += 4)
+		{
+			__m128 pX = _mm_loadu_ps(&rkPs[idx].mX);
+			__m128 pY = _mm_loadu_ps(&rkPs[idx + 1].mX);
+			__m128 pZ = _mm_loadu_ps(&rkPs[idx + 2].mX);
+			__m128 pW = _mm_loadu_ps(&rkPs[idx + 3].mX);
+			_MM_TRANSPOSE4_PS(pX, pY, pZ, pW);
+			__m128 qX = _mm_loadu_ps(&rkQs[idx].mX);
+			__m128 qY = _mm_loadu_ps(&rkQs[idx + 1].mX);
+			__m128 qZ = _mm_loadu_ps(&rkQs[idx + 2].mX);
+			__m128 qW = _mm_loadu_ps(&rkQs[idx + 3].mX);
+			_MM_TRANSPOSE4_PS(qX, qY, qZ, qW);
+
+			if (shortestPath)
+			{
+				// Flip the lanes where the rotations are more than half a turn apart
+				__m128 cosine = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(pX, qX), _mm_mul_ps(pY, qY)), _mm_mul_ps(pZ, qZ)), _mm_mul_ps(pW, qW));
+				__m128 flip = _mm_and_ps(_mm_cmplt_ps(cosine, _mm_setzero_ps()), signMask);
+				qX = _mm_xor_ps(qX, flip);
+				qY = _mm_xor_ps(qY, flip);
+				qZ = _mm_xor_ps(qZ, flip);
+				qW = _mm_xor_ps(qW, flip);
+			}
+
+			// Normalized linear interpolation, as Slerp
+			__m128 t = _mm_loadu_ps(fTs + idx);
+			__m128 invT = _mm_sub_ps(one, t);
+			__m128 x = _mm_add_ps(_mm_mul_ps(invT, pX), _mm_mul_ps(t, qX));
+			__m128 y = _mm_add_ps(_mm_mul_ps(invT, pY), _mm_mul_ps(t, qY));
+			__m128 z = _mm_add_ps(_mm_mul_ps(invT, pZ), _mm_mul_ps(t, qZ));
+			__m128 w = _mm_add_ps(_mm_mul_ps(invT, pW), _mm_mul_ps(t, qW));
+			__m128 norm = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)), _mm_mul_ps(w, w));
+			__m128 factor = _mm_div_ps(one, _mm_sqrt_ps(norm));
+			x = _mm_mul_ps(factor, x);
+			y = _mm_mul_ps(factor, y);
+			z = _mm_mul_ps(factor, z);
+			w = _mm_mul_ps(factor, w);
+
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			_mm_storeu_ps(&out[idx].mX, x);
+			_mm_storeu_ps(&out[idx + 1].mX, y);
+			_mm_storeu_ps(&out[idx + 2].mX, z);
+			_mm_storeu_ps(&out[idx + 3].mX, w);
+		}
+	}
+#endif
+	for (; idx < count; idx++)
+		out[idx] = Slerp(fTs[idx], rkPs[idx], rkQs[idx], shortestPath);
+}
@@ -105,6 +105,9 @@ public:
 	}
 
 	static Quaternion Slerp(float fT, const Quaternion& rkP, const Quaternion& rkQ, bool shortestPath);
+	// ToMatrix and Slerp over arrays, four quaternions at a time with SSE2. 'out' may alias an input.
+	static void ToMatrixBatch(const Quaternion* quats, Matrix4* out, int count);
+	static void SlerpBatch(const float* fTs, const Quaternion* rkPs, const Quaternion* rkQs, Quaternion* out, int count, bool shortestPath);
 
 	float Norm() const
 	{
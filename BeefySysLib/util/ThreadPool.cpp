@@ -189,4 +189,112 @@ void ThreadPool::CancelAll()
 	for (auto thread : mThreads)
 		if (thread->mActiveJob != NULL)
 			thread->mActiveJob->Cancel();
+}
+
+//
+
+struct ParallelForState
+{
+	const std::function<void(int startIdx, int endIdx)>* mFunc;
+	int mCount;
+	int mBatchSize;
+	uint32 mNumBatches;
+	uint32 mNextBatch;
+	uint32 mDoneBatches;
+	uint32 mRefCount;
+
+	void RunBatches()
+	{
+		while (true)
+		{
+			uint32 batchIdx = BfpSystem_InterlockedExchangeAdd32(&mNextBatch, 1);
+			if (batchIdx >= mNumBatches)
+				break;
+			int startIdx = (int)batchIdx * mBatchSize;
+			(*mFunc)(startIdx, BF_MIN(startIdx + mBatchSize, mCount));
+			BfpSystem_InterlockedExchangeAdd32(&mDoneBatches, 1);
+		}
+	}
+
+	void Release()
+	{
+		if (BfpSystem_InterlockedExchangeAdd32(&mRefCount, (uint32)-1) == 1)
+			delete this;
+	}
+};
+
+// Workers can start after the caller has already finished all the batches, so the state is refcounted rather than
+//  living on the caller's stack
+class ParallelForJob : public ThreadPool::Job
+{
+public:
+	ParallelForState* mState;
+
+	~ParallelForJob()
+	{
+		mState->Release();
+	}
+
+	void Perform() override
+	{
+		mState->RunBatches();
+	}
+};
+
+static CritSect gParallelForCritSect;
+static ThreadPool* gParallelForPool = NULL;
+static int gParallelForWorkerCount = 0;
+
+static ThreadPool* GetParallelForPool()
+{
+	AutoCrit autoCrit(gParallelForCritSect);
+	if (gParallelForPool == NULL)
+	{
+		gParallelForWorkerCount = BF_MIN(BfpSystem_GetNumLogicalCPUs(NULL) - 1, 15);
+		if (gParallelForWorkerCount <= 0)
+			return NULL;
+		gParallelForPool = new ThreadPool(gParallelForWorkerCount);
+	}
+	return gParallelForPool;
+}
+
+void ThreadPool::ParallelFor(int count, int minBatchSize, const std::function<void(int startIdx, int endIdx)>& func)
+{
+	minBatchSize = BF_MAX(minBatchSize, 1);
+	ThreadPool* threadPool = NULL;
+	if (count >= minBatchSize * 2)
+		threadPool = GetParallelForPool();
+	if (threadPool == NULL)
+	{
+		if (count > 0)
+			func(0, count);
+		return;
+	}
+
+	// A few batches per thread so uneven items still balance out
+	int numThreads = gParallelForWorkerCount + 1;
+	int batchSize = BF_MAX((count + numThreads * 4 - 1) / (numThreads * 4), minBatchSize);
+
+	ParallelForState* state = new ParallelForState();
+	state->mFunc = &func;
+	state->mCount = count;
+	state->mBatchSize = batchSize;
+	state->mNumBatches = (uint32)((count + batchSize - 1) / batchSize);
+	state->mNextBatch = 0;
+	state->mDoneBatches = 0;
+
+	int numJobs = BF_MIN((int)state->mNumBatches - 1, gParallelForWorkerCount);
+	state->mRefCount = numJobs + 1;
+	for (int jobIdx = 0; jobIdx < numJobs; jobIdx++)
+	{
+		ParallelForJob* job = new ParallelForJob();
+		job->mState = state;
+		threadPool->AddJob(job);
+	}
+
+	state->RunBatches();
+	// Only batches that a worker has already claimed are left, so this never waits on a queued job
+	while (*(volatile uint32*)&state->mDoneBatches != state->mNumBatches)
+		BfpThread_Yield();
+	state->Release();
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../Common.h"
 #include "CritSect.h"
 #include "Deque.h"
+#include <functional>
 
 NS_BF_BEGIN
 
@@ -89,6 +90,11 @@ public:
 	void AddJob(BfpThreadStartProc proc, void* param, int maxWorkersPerProviderThread = 0x7FFFFFFF);
 	bool IsInJob();
 	void CancelAll();
+
+	// Splits [0, count) into batches of at least 'minBatchSize' items and runs them on a shared worker pool. Items must be
+	//  independent of each other. The calling thread takes batches as well, so nested calls from inside a batch can't
+	//  deadlock, and counts under two batches just run inline.
+	static void ParallelFor(int count, int minBatchSize, const std::function<void(int startIdx, int endIdx)>& func);
 };
 
 NS_BF_END
\ No newline at end of file
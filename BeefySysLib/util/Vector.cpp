@@ -1,9 +1,155 @@
 #include "Vector.h"
 #include "Matrix4.h"
 #include "Quaternion.h"
+#include "CatmullRom.h"
+#include "CubicSpline.h"
+
+// The batch functions work on points in structure-of-arrays form, one point per lane, in the same operation order
+//  as the scalar functions. Define BF_MATH_NO_SIMD to compile them out, or set MathFlag_NoSimd to disable them at runtime.
+
+#if !defined BF_MATH_NO_SIMD
+#if defined __AVX__
+#define BF_MATH_AVX
+#include <immintrin.h>
+#endif
+#if (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_MATH_SSE2
+#include <emmintrin.h>
+#endif
+#endif
 
 USING_NS_BF;
 
+int Beefy::gMathFlags = MathFlag_None;
+
+#ifdef BF_MATH_SSE2
+// Four packed Vector3s to and from one register per component
+static inline void LoadVector3x4(const Vector3* vecs, __m128& x, __m128& y, __m128& z)
+{
+	const float* src = &vecs[0].mX;
+	__m128 a = _mm_loadu_ps(src); // x0 y0 z0 x1
+	__m128 b = _mm_loadu_ps(src + 4); // y1 z1 x2 y2
+	__m128 c = _mm_loadu_ps(src + 8); // z2 x3 y3 z3
+	__m128 xHigh = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 3, 2));
+	x = _mm_shuffle_ps(a, xHigh, _MM_SHUFFLE(3, 0, 3, 0));
+	y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline void StoreVector3x4(Vector3* vecs, __m128 x, __m128 y, __m128 z)
+{
+	float* dest = &vecs[0].mX;
+	__m128 zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+	_mm_storeu_ps(dest, _mm_shuffle_ps(_mm_unpacklo_ps(x, y), zx, _MM_SHUFFLE(2, 0, 1, 0)));
+	__m128 yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+	_mm_storeu_ps(dest + 4, _mm_shuffle_ps(yz, _mm_unpackhi_ps(x, y), _MM_SHUFFLE(1, 0, 2, 0)));
+	__m128 zx2 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+	__m128 yz3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+	_mm_storeu_ps(dest + 8, _mm_shuffle_ps(zx2, yz3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+// The transforms are written once over a lane type so the SSE2 and AVX loops share them
+struct MathLanes4
+{
+	typedef __m128 Type;
+	static const int COUNT = 4;
+	static Type Set1(float val) { return _mm_set1_ps(val); }
+	static Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+	static Type Sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+	static Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+	static Type Div(Type a, Type b) { return _mm_div_ps(a, b); }
+	static void Load(const Vector3* vecs, Type& x, Type& y, Type& z) { LoadVector3x4(vecs, x, y, z); }
+	static void Store(Vector3* vecs, Type x, Type y, Type z) { StoreVector3x4(vecs, x, y, z); }
+};
+
+#ifdef BF_MATH_AVX
+struct MathLanes8
+{
+	typedef __m256 Type;
+	static const int COUNT = 8;
+	static Type Set1(float val) { return _mm256_set1_ps(val); }
+	static Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+	static Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+	static Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+	static Type Div(Type a, Type b) { return _mm256_div_ps(a, b); }
+
+	static void Load(const Vector3* vecs, Type& x, Type& y, Type& z)
+	{
+		__m128 x0, y0, z0, x1, y1, z1;
+		LoadVector3x4(vecs, x0, y0, z0);
+		LoadVector3x4(vecs + 4, x1, y1, z1);
+		x = _mm256_insertf128_ps(_mm256_castps128_ps256(x0), x1, 1);
+		y = _mm256_insertf128_ps(_mm256_castps128_ps256(y0), y1, 1);
+		z = _mm256_insertf128_ps(_mm256_castps128_ps256(z0), z1, 1);
+	}
+
+	static void Store(Vector3* vecs, Type x, Type y, Type z)
+	{
+		StoreVector3x4(vecs, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z));
+		StoreVector3x4(vecs + 4, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+	}
+};
+typedef MathLanes8 MathLanes;
+#else
+typedef MathLanes4 MathLanes;
+#endif
+
+// Returns how many points were transformed, leaving the remainder to the scalar loop
+template <typename TLanes>
+static int TransformPoints(const Vector3* vecs, Vector3* out, int count, const Matrix4& matrix)
+{
+	typedef typename TLanes::Type V;
+	V m[4][4];
+	for (int row = 0; row < 4; row++)
+		for (int col = 0; col < 4; col++)
+			m[row][col] = TLanes::Set1(matrix.mMat[row][col]);
+	V one = TLanes::Set1(1.0f);
+
+	int idx = 0;
+	for (; idx + TLanes::COUNT <= count; idx += TLanes::COUNT)
+	{
+		V x, y, z;
+		TLanes::Load(vecs + idx, x, y, z);
+		V invW = TLanes::Div(one, TLanes::Add(TLanes::Add(TLanes::Add(TLanes::Mul(m[3][0], x), TLanes::Mul(m[3][1], y)), TLanes::Mul(m[3][2], z)), m[3][3]));
+		V outX = TLanes::Mul(TLanes::Add(TLanes::Add(TLanes::Add(TLanes::Mul(m[0][0], x), TLanes::Mul(m[0][1], y)), TLanes::Mul(m[0][2], z)), m[0][3]), invW);
+		V outY = TLanes::Mul(TLanes::Add(TLanes::Add(TLanes::Add(TLanes::Mul(m[1][0], x), TLanes::Mul(m[1][1], y)), TLanes::Mul(m[1][2], z)), m[1][3]), invW);
+		V outZ = TLanes::Mul(TLanes::Add(TLanes::Add(TLanes::Add(TLanes::Mul(m[2][0], x), TLanes::Mul(m[2][1], y)), TLanes::Mul(m[2][2], z)), m[2][3]), invW);
+		TLanes::Store(out + idx, outX, outY, outZ);
+	}
+	return idx;
+}
+
+template <typename TLanes>
+static int TransformPoints(const Vector3* vecs, Vector3* out, int count, const Quaternion& quat)
+{
+	typedef typename TLanes::Type V;
+	V qX = TLanes::Set1(quat.mX);
+	V qY = TLanes::Set1(quat.mY);
+	V qZ = TLanes::Set1(quat.mZ);
+	V wScale = TLanes::Set1(2.0f * quat.mW);
+	V two = TLanes::Set1(2.0f);
+
+	int idx = 0;
+	for (; idx + TLanes::COUNT <= count; idx += TLanes::COUNT)
+	{
+		V x, y, z;
+		TLanes::Load(vecs + idx, x, y, z);
+		// uv = qvec x vec, uuv = qvec x uv
+		V uvX = TLanes::Sub(TLanes::Mul(qY, z), TLanes::Mul(qZ, y));
+		V uvY = TLanes::Sub(TLanes::Mul(qZ, x), TLanes::Mul(qX, z));
+		V uvZ = TLanes::Sub(TLanes::Mul(qX, y), TLanes::Mul(qY, x));
+		V uuvX = TLanes::Sub(TLanes::Mul(qY, uvZ), TLanes::Mul(qZ, uvY));
+		V uuvY = TLanes::Sub(TLanes::Mul(qZ, uvX), TLanes::Mul(qX, uvZ));
+		V uuvZ = TLanes::Sub(TLanes::Mul(qX, uvY), TLanes::Mul(qY, uvX));
+		V outX = TLanes::Add(TLanes::Add(x, TLanes::Mul(uvX, wScale)), TLanes::Mul(uuvX, two));
+		V outY = TLanes::Add(TLanes::Add(y, TLanes::Mul(uvY, wScale)), TLanes::Mul(uuvY, two));
+		V outZ = TLanes::Add(TLanes::Add(z, TLanes::Mul(uvZ, wScale)), TLanes::Mul(uuvZ, two));
+		TLanes::Store(out + idx, outX, outY, outZ);
+	}
+	return idx;
+}
+#endif
+
 Vector3::Vector3(float x, float y, float z)
 {
 	mX = x;
@@ -56,8 +202,8 @@ Vector3 Vector3::Transform(const Vector3& vec, const Quaternion& quat)
 	Vector3 qvec(quat.mX, quat.mY, quat.mZ);
 	uv = Vector3::CrossProduct(qvec, vec);
 	uuv = Vector3::CrossProduct(qvec, uv);
-	uv *= (2.0f * quat.mW);
-	uuv *= 2.0f;
+	uv = Vector3::Scale(uv, 2.0f * quat.mW);
+	uuv = Vector3::Scale(uuv, 2.0f);
 
 	return vec + uv + uuv;
 }
@@ -75,4 +221,174 @@ Vector3 Vector3::Transform2(const Vector3& vec, const Quaternion& quat)
 	result.mZ = vec.mZ + z * quat.mW + (quat.mX * y - quat.mY * x);
 
 	return result;
-}
\ No newline at end of file
+}
+
+void Vector3::TransformBatch(const Vector3* vecs, Vector3* out, int count, const Matrix4& matrix)
+{
+	int idx = 0;
+#ifdef BF_MATH_SSE2
+	if ((gMathFlags & MathFlag_NoSimd) == 0)
+		idx = TransformPoints<MathLanes>(vecs, out, count, matrix);
+#endif
+	for (; idx < count; idx++)
+		out[idx] = Transform(vecs[idx], matrix);
+}
+
+void Vector3::TransformBatch(const Vector3* vecs, Vector3* out, int count, const Quaternion& quat)
+{
+	int idx = 0;
+#ifdef BF_MATH_SSE2
+	if ((gMathFlags & MathFlag_NoSimd) == 0)
+		idx = TransformPoints<MathLanes>(vecs, out, count, quat);
+#endif
+	for (; idx < count; idx++)
+		out[idx] = Transform(vecs[idx], quat);
+}
+
+//
+
+// Runs each batch function over 'count' elements with SIMD off and on, reporting throughput and the largest difference
+//  between the two. Returns the SIMD microseconds per pass over all the functions.
+BF_EXPORT int BF_CALLTYPE Math_RunBenchmark(int count, int passCount)
+{
+	if (count <= 0)
+		return -1;
+
+	srand(0);
+	auto _Rand = []() { return (rand() % 2001) / 1000.0f - 1.0f; };
+	std::vector<Matrix4> matrices[2];
+	std::vector<Vector3> points(count);
+	std::vector<Quaternion> quats[2];
+	std::vector<float> params(count);
+	for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+	{
+		matrices[modeIdx].resize(count);
+		quats[modeIdx].resize(count);
+		for (int idx = 0; idx < count; idx++)
+		{
+			quats[modeIdx][idx] = Quaternion::Normalise(Quaternion(_Rand(), _Rand(), _Rand(), _Rand() + 2.0f));
+			matrices[modeIdx][idx] = Matrix4::CreateTransform(Vector3(_Rand(), _Rand(), _Rand()), Vector3(1, 1, 1), quats[modeIdx][idx]);
+		}
+	}
+	for (int idx = 0; idx < count; idx++)
+	{
+		points[idx] = Vector3(_Rand() * 100, _Rand() * 100, _Rand() * 100);
+		params[idx] = (_Rand() + 1.0f) * 0.5f;
+	}
+	Matrix4 projection = Matrix4::CreateTranslation(0.5f, -0.25f, 2.0f);
+	projection.m30 = 0.001f;
+	CubicSpline2D spline;
+	for (int pointIdx = 0; pointIdx < 16; pointIdx++)
+		spline.AddPt(pointIdx * 10.0f + _Rand(), _Rand() * 50);
+	std::vector<float> splineParams(count);
+	for (int idx = 0; idx < count; idx++)
+		splineParams[idx] = params[idx] * 14.99f;
+
+	std::vector<Matrix4> matrixOut[2];
+	std::vector<Vector3> pointOut[2];
+	std::vector<Quaternion> quatOut[2];
+	std::vector<Point2D> curveOut[2];
+	for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+	{
+		matrixOut[modeIdx].resize(count);
+		pointOut[modeIdx].resize(count);
+		quatOut[modeIdx].resize(count);
+		curveOut[modeIdx].resize(count);
+	}
+
+	enum { Op_MatrixMultiply, Op_TransformPoints, Op_RotatePoints, Op_QuatToMatrix, Op_Slerp, Op_CatmullRom, Op_CubicSpline, Op_COUNT };
+	const char* opNames[Op_COUNT] = { "MatrixMultiply", "TransformPoints", "RotatePoints", "QuatToMatrix", "Slerp", "CatmullRom", "CubicSpline" };
+	int64 elapsedMicros[Op_COUNT][2] = {};
+	float maxError[Op_COUNT] = {};
+	Point2D curvePoints[4] = { Point2D(0, 0), Point2D(10, 30), Point2D(40, 35), Point2D(60, 0) };
+
+	auto _RunOp = [&](int op, int modeIdx)
+	{
+		switch (op)
+		{
+		case Op_MatrixMultiply:
+			Matrix4::MultiplyBatch(&matrices[0][0], &matrices[1][0], &matrixOut[modeIdx][0], count);
+			break;
+		case Op_TransformPoints:
+			Vector3::TransformBatch(&points[0], &pointOut[modeIdx][0], count, projection);
+			break;
+		case Op_RotatePoints:
+			Vector3::TransformBatch(&points[0], &pointOut[modeIdx][0], count, quats[0][0]);
+			break;
+		case Op_QuatToMatrix:
+			Quaternion::ToMatrixBatch(&quats[0][0], &matrixOut[modeIdx][0], count);
+			break;
+		case Op_Slerp:
+			Quaternion::SlerpBatch(&params[0], &quats[0][0], &quats[1][0], &quatOut[modeIdx][0], count, true);
+			break;
+		case Op_CatmullRom:
+			CatmullRomEvaluateBatch(curvePoints[0], curvePoints[1], curvePoints[2], curvePoints[3], 0.5f, &params[0], &curveOut[modeIdx][0], count);
+			break;
+		case Op_CubicSpline:
+			spline.EvaluateBatch(&splineParams[0], &curveOut[modeIdx][0], count);
+			break;
+		}
+	};
+
+	auto _GetError = [&](int op)
+	{
+		const float* results[2];
+		int numFloats = 0;
+		for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+		{
+			if ((op == Op_MatrixMultiply) || (op == Op_QuatToMatrix))
+			{
+				results[modeIdx] = matrixOut[modeIdx][0].mMatFlat;
+				numFloats = count * 16;
+			}
+			else if ((op == Op_TransformPoints) || (op == Op_RotatePoints))
+			{
+				results[modeIdx] = &pointOut[modeIdx][0].mX;
+				numFloats = count * 3;
+			}
+			else if (op == Op_Slerp)
+			{
+				results[modeIdx] = &quatOut[modeIdx][0].mX;
+				numFloats = count * 4;
+			}
+			else
+			{
+				results[modeIdx] = &curveOut[modeIdx][0].mX;
+				numFloats = count * 2;
+			}
+		}
+		float error = 0;
+		for (int i = 0; i < numFloats; i++)
+			error = BF_MAX(error, fabsf(results[0][i] - results[1][i]));
+		return error;
+	};
+
+	int prevFlags = gMathFlags;
+	for (int passIdx = 0; passIdx < BF_MAX(passCount, 1); passIdx++)
+	{
+		for (int op = 0; op < Op_COUNT; op++)
+		{
+			for (int modeIdx = 0; modeIdx < 2; modeIdx++)
+			{
+				gMathFlags = (modeIdx == 0) ? MathFlag_NoSimd : MathFlag_None;
+				uint64 startTick = BFGetTickCountMicro();
+				_RunOp(op, modeIdx);
+				elapsedMicros[op][modeIdx] += (int64)(BFGetTickCountMicro() - startTick);
+			}
+			maxError[op] = BF_MAX(maxError[op], _GetError(op));
+		}
+	}
+	gMathFlags = prevFlags;
+
+	String result = StrFormat("Math batch %d elements\n", count);
+	int64 totalSimdMicros = 0;
+	for (int op = 0; op < Op_COUNT; op++)
+	{
+		int64 scalarPerSec = (int64)count * BF_MAX(passCount, 1) * 1000000 / BF_MAX(elapsedMicros[op][0], (int64)1);
+		int64 simdPerSec = (int64)count * BF_MAX(passCount, 1) * 1000000 / BF_MAX(elapsedMicros[op][1], (int64)1);
+		result += StrFormat("  %s: Scalar: %lldK/s Simd: %lldK/s  Max error: %g\n", opNames[op], (long long)(scalarPerSec / 1000), (long long)(simdPerSec / 1000), maxError[op]);
+		totalSimdMicros += elapsedMicros[op][1];
+	}
+	OutputDebugStrF("%s", result.c_str());
+	return (int)(totalSimdMicros / BF_MAX(passCount, 1));
+}
@@ -7,6 +7,15 @@ NS_BF_BEGIN;
 class Matrix4;
 class Quaternion;
 
+enum MathFlags
+{
+	MathFlag_None = 0,
+	MathFlag_NoSimd = 1 // Run the batch functions through the scalar versions
+};
+
+// Applies to the batch functions of Vector3, Matrix4, Quaternion and the splines
+extern int gMathFlags;
+
 class TexCoords
 {
 public:
@@ -56,6 +65,9 @@ public:
 	static Vector3 Transform(const Vector3& vec, const Matrix4& matrix);
 	static Vector3 Transform(const Vector3& vec, const Quaternion& quat);
 	static Vector3 Transform2(const Vector3& vec, const Quaternion& quat);
+	// Transform over arrays of points, four at a time with SSE2 or eight with AVX. 'out' may alias 'vecs'.
+	static void TransformBatch(const Vector3* vecs, Vector3* out, int count, const Matrix4& matrix);
+	static void TransformBatch(const Vector3* vecs, Vector3* out, int count, const Quaternion& quat);
 
 	static Vector3 Scale(const Vector3& vec, float scale)
 	{
@@ -578,6 +578,7 @@ namespace System.Reflection
         FieldData* mFieldDataPtr;
         void* mConstructorDataPtr;
         void** mCustomAttrDataPtr;
+        uint8* mReflectNamesPtr;
 
 
         public override int32 InstanceSize
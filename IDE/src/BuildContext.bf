@@ -291,6 +291,9 @@ namespace IDE
 				if (mPlatformType == .Linux)
 					linkLine.Append("-no-pie ");
 
+				if (workspaceOptions.mPGOKind == .Instrument)
+					linkLine.Append("-fprofile-instr-generate ");
+
 			    linkLine.Append(objectsArg);
 
 				//var destDir = scope String();
@@ -389,6 +392,9 @@ namespace IDE
 #else
 		        String gccExePath = "/usr/bin/c++";
 		        String clangExePath = scope String("/usr/bin/c++");
+				// The profile runtime for instrumented builds comes with clang's driver
+				if (workspaceOptions.mPGOKind == .Instrument)
+					gccExePath = clangExePath = "/usr/bin/clang++";
 #endif
 
 			    if (project.mNeedsTargetRebuild)
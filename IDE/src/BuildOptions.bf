@@ -9,6 +9,14 @@ namespace IDE
 		{
 			None,
 			Thin,
+			ThinInProcess,
+		}
+
+		public enum PGOKind
+		{
+			None,
+			Instrument,
+			Use,
 		}
 
 		public enum EmitDebugInfo
@@ -36,6 +36,8 @@ namespace IDE.Compiler
 			DebugAlloc = 0x8000,
 			OmitDebugHelpers = 0x10000,
 			NoFramePointerElim = 0x20000,
+			MethodGranularDeps = 0x40000,
+			ShortSymbols = 0x80000,
 		}
 
         [StdCall, CLink]
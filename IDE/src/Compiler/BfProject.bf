@@ -18,6 +18,7 @@ namespace IDE.Compiler
 			SingleModule   	= 0x10,
 			AsmOutput		= 0x20,
 			AsmOutput_ATT	= 0x40,
+			CompactReflection	= 0x100,
 		}
 
         [StdCall, CLink]
@@ -34,7 +35,7 @@ namespace IDE.Compiler
 
         [StdCall, CLink]
         extern static void BfProject_SetOptions(void* nativeBfProject, int32 targetType, char8* startupObject, char8* preprocessorMacros,
-            int32 optLevel, int32 ltoType, int32 relocType, int32 picLevel, Flags flags);
+            int32 optLevel, int32 ltoType, int32 relocType, int32 picLevel, Flags flags, int32 pgoKind, char8* pgoProfilePath);
 
         public void* mNativeBfProject;
         public bool mDisabled;
@@ -62,7 +63,8 @@ namespace IDE.Compiler
 
         public void SetOptions(Project.TargetType targetType, String startupObject, List<String> preprocessorMacros,
             BuildOptions.BfOptimizationLevel optLevel, BuildOptions.LTOType ltoType, BuildOptions.RelocType relocType, BuildOptions.PICLevel picLevel,
-			bool mergeFunctions, bool combineLoads, bool vectorizeLoops, bool vectorizeSLP)
+			bool mergeFunctions, bool combineLoads, bool vectorizeLoops, bool vectorizeSLP, bool compactReflection,
+			BuildOptions.PGOKind pgoKind, String pgoProfilePath)
         {
 			Flags flags = default;
 			void SetFlags(bool val, Flags flag)
@@ -74,11 +76,12 @@ namespace IDE.Compiler
 			SetFlags(combineLoads, .CombineLoads);
 			SetFlags(vectorizeLoops, .VectorizeLoops);
 			SetFlags(vectorizeSLP, .VectorizeSLP);
+			SetFlags(compactReflection, .CompactReflection);
 
             String macrosStr = scope String();
             macrosStr.Join("\n", preprocessorMacros.GetEnumerator());
             BfProject_SetOptions(mNativeBfProject, (int32)targetType, startupObject, macrosStr, 
-                (int32)optLevel, (int32)ltoType, (int32)relocType, (int32)picLevel, flags);
+                (int32)optLevel, (int32)ltoType, (int32)relocType, (int32)picLevel, flags, (int32)pgoKind, pgoProfilePath);
         }
 
     }
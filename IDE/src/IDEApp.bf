@@ -8077,6 +8077,13 @@ namespace IDE
 			if (options.mBeefOptions.mLTOType != null)
 				ltoType = options.mBeefOptions.mLTOType.Value;
 			
+			var pgoKind = workspaceOptions.mPGOKind;
+			String pgoProfilePath = scope String();
+			if (!workspaceOptions.mPGOProfilePath.IsEmpty)
+				Path.GetAbsolutePath(workspaceOptions.mPGOProfilePath, mWorkspace.mDir, pgoProfilePath);
+			if ((optimizationLevel == .OgPlus) || (bfSystem == mBfResolveSystem))
+				pgoKind = .None; // Og+ doesn't go through LLVM, and the resolver doesn't generate code
+
 			var targetType = project.mGeneralOptions.mTargetType;
 
 			if (bfSystem != mBfResolveSystem)
@@ -8112,7 +8119,8 @@ namespace IDE
                 preprocessorMacros.mDefines,
                 optimizationLevel, ltoType, options.mBeefOptions.mRelocType, options.mBeefOptions.mPICLevel,
 				options.mBeefOptions.mMergeFunctions, options.mBeefOptions.mCombineLoads,
-                options.mBeefOptions.mVectorizeLoops, options.mBeefOptions.mVectorizeSLP);
+                options.mBeefOptions.mVectorizeLoops, options.mBeefOptions.mVectorizeSLP, options.mBeefOptions.mCompactReflection,
+				pgoKind, pgoProfilePath);
 
             List<Project> depProjectList = scope List<Project>();
             if (!GetDependentProjectList(project, depProjectList))
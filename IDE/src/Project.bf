@@ -1073,6 +1073,8 @@ namespace IDE
             public bool mVectorizeLoops;
 			[Reflect]
             public bool mVectorizeSLP;
+			[Reflect]
+			public bool mCompactReflection;
 			[Reflect]
 			public List<DistinctBuildOptions> mDistinctBuildOptions = new List<DistinctBuildOptions>() ~ DeleteContainerAndItems!(_);
         }
@@ -1167,6 +1169,7 @@ namespace IDE
 				Set!(newOptions.mBeefOptions.mCombineLoads, mBeefOptions.mCombineLoads);
 				Set!(newOptions.mBeefOptions.mVectorizeLoops, mBeefOptions.mVectorizeLoops);
 				Set!(newOptions.mBeefOptions.mVectorizeSLP, mBeefOptions.mVectorizeSLP);
+				Set!(newOptions.mBeefOptions.mCompactReflection, mBeefOptions.mCompactReflection);
 				for (var prev in mBeefOptions.mDistinctBuildOptions)
 					newOptions.mBeefOptions.mDistinctBuildOptions.Add(prev.Duplicate());
 
@@ -1598,6 +1601,7 @@ namespace IDE
 							    data.ConditionalAdd("CombineLoads", options.mBeefOptions.mCombineLoads);
 							    data.ConditionalAdd("VectorizeLoops", options.mBeefOptions.mVectorizeLoops);
 							    data.ConditionalAdd("VectorizeSLP", options.mBeefOptions.mVectorizeSLP);
+								data.ConditionalAdd("CompactReflection", options.mBeefOptions.mCompactReflection);
 								WriteDistinctOptions(options.mBeefOptions.mDistinctBuildOptions);
 
 #if IDE_C_SUPPORT
@@ -1907,6 +1911,7 @@ namespace IDE
 			        options.mBeefOptions.mCombineLoads = data.GetBool("CombineLoads");
 			        options.mBeefOptions.mVectorizeLoops = data.GetBool("VectorizeLoops");
 			        options.mBeefOptions.mVectorizeSLP = data.GetBool("VectorizeSLP");
+					options.mBeefOptions.mCompactReflection = data.GetBool("CompactReflection");
 					for (data.Enumerate("DistinctOptions"))
 					{
 						var typeOptions = new DistinctBuildOptions();
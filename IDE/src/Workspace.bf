@@ -203,6 +203,10 @@ namespace IDE
 			[Reflect]
 			public BuildOptions.LTOType mLTOType;
 			[Reflect]
+			public BuildOptions.PGOKind mPGOKind;
+			[Reflect]
+			public String mPGOProfilePath = new String() ~ delete _;
+			[Reflect]
 			public bool mNoOmitFramePointers;
 			[Reflect]
 			public bool mLargeStrings;
@@ -269,6 +273,8 @@ namespace IDE
 				mCSIMDSetting = prev.mCSIMDSetting;
 				mCOptimizationLevel = prev.mCOptimizationLevel;
 				mLTOType = prev.mLTOType;
+				mPGOKind = prev.mPGOKind;
+				mPGOProfilePath.Set(prev.mPGOProfilePath);
 				mNoOmitFramePointers = prev.mNoOmitFramePointers;
 				mLargeStrings = prev.mLargeStrings;
 				mLargeCollections = prev.mLargeCollections;
@@ -604,6 +610,8 @@ namespace IDE
 								else
 									data.ConditionalAdd("BfOptimizationLevel", options.mBfOptimizationLevel, isRelease ? .O2 : .O0);
 								data.ConditionalAdd("LTOType", options.mLTOType, .None);
+								data.ConditionalAdd("PGOKind", options.mPGOKind, .None);
+								data.ConditionalAdd("PGOProfilePath", options.mPGOProfilePath, "");
 								data.ConditionalAdd("AllocType", options.mAllocType, isRelease ? .CRT : .Debug);
 								data.ConditionalAdd("AllocMalloc", options.mAllocMalloc, "");
 								data.ConditionalAdd("AllocFree", options.mAllocFree, "");
@@ -836,6 +844,8 @@ namespace IDE
 						options.mBfOptimizationLevel = data.GetEnum<BuildOptions.BfOptimizationLevel>("BfOptimizationLevel", isRelease ? .O2 : .O0);
 
 					options.mLTOType = data.GetEnum<BuildOptions.LTOType>("LTOType", .None);
+					options.mPGOKind = data.GetEnum<BuildOptions.PGOKind>("PGOKind", .None);
+					data.GetString("PGOProfilePath", options.mPGOProfilePath);
 					options.mAllocType = data.GetEnum<AllocType>("AllocType", isRelease ? .CRT : .Debug);
 					data.GetString("AllocMalloc", options.mAllocMalloc);
 					data.GetString("AllocFree", options.mAllocFree);
@@ -832,6 +832,7 @@ namespace IDE.ui
 			AddPropertiesItem(category, "LTO", "mBeefOptions.mLTOType");
             AddPropertiesItem(category, "Vectorize Loops", "mBeefOptions.mVectorizeLoops");
             AddPropertiesItem(category, "Vectorize SLP", "mBeefOptions.mVectorizeSLP");
+			AddPropertiesItem(category, "Compact Reflection", "mBeefOptions.mCompactReflection");
             category.Open(true, true);
 
 			DistinctOptionBuilder dictinctOptionBuilder = scope .(this);
@@ -803,6 +803,8 @@ namespace IDE.ui
             AddPropertiesItem(category, "Optimization Level", "mBfOptimizationLevel",
                 scope String[] { "O0", "O1", "O2", "O3", "Og", "Og+"});
 			AddPropertiesItem(category, "LTO Type", "mLTOType");
+			AddPropertiesItem(category, "Profile Guided Optimization", "mPGOKind");
+			AddPropertiesItem(category, "PGO Profile Path", "mPGOProfilePath");
             AddPropertiesItem(category, "No Omit Frame Pointers", "mNoOmitFramePointers");
 			AddPropertiesItem(category, "Large Strings", "mLargeStrings");
 			AddPropertiesItem(category, "Large Collections", "mLargeCollections");
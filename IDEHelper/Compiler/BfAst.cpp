@@ -13,7 +13,6 @@ BfStructuralVisitor::BfStructuralVisitor()
 	std::hash<std::string>();
 
 	mCapturingChildRef = false;
-	mCurChildRef = NULL;
 }
 
 void BfStructuralVisitor::VisitMembers(BfBlock* node)
@@ -26,18 +25,18 @@ void BfStructuralVisitor::VisitMembers(BfBlock* node)
 
 void BfStructuralVisitor::VisitChildNoRef(BfAstNode* node)
 {
-	mCurChildRef = NULL;
+	mCurChildRef = BfAstChildRef();
 	node->Accept(this);
-	mCurChildRef = NULL;
+	mCurChildRef = BfAstChildRef();
 }
 
 void BfStructuralVisitor::DoVisitChild(BfAstNode*& node)
 {
 	if (node == NULL)
 		return;
-	mCurChildRef = &node;
+	mCurChildRef = BfAstChildRef(&node);
 	node->Accept(this);
-	mCurChildRef = NULL;
+	mCurChildRef = BfAstChildRef();
 }
 
 void BfStructuralVisitor::AssertValidChildAddr(BfAstNode** nodeRef)
@@ -833,9 +832,25 @@ void BfAstNode::Add(BfAstNode* bfAstNode)
 }
 
 #ifdef BF_AST_COMPACT
+static CritSect gTempAstInfoCritSect;
+static BumpAllocator gTempAstInfoAlloc;
+
 BfAstInfo* BfAstNode::AllocAstInfo()
 {
-	return GetSource()->mAlloc.Alloc<BfAstInfo>();
+#ifdef BF_USE_NEAR_NODE_REF
+	if ((BfAstArena::Contains(this)) || (BfAstArena::IsOverflowRun(this)))
+#endif
+	{
+		BfAstPageHeader* pageHeader = (BfAstPageHeader*)((intptr)this & ~(BfAstAllocManager::PAGE_SIZE - 1));
+		auto alloc = pageHeader->mAlloc;
+		alloc->mNumAstInfos++;
+		return (BfAstInfo*)alloc->AllocBytes(sizeof(BfAstInfo), alignof(BfAstInfo), "BfAstInfo");
+	}
+
+	// Temporary nodes built outside of a parser (ie: on the stack) can still outgrow the packed encoding.
+	//  These are rare enough that we just let them accumulate.
+	AutoCrit autoCrit(gTempAstInfoCritSect);
+	return gTempAstInfoAlloc.Alloc<BfAstInfo>();
 }
 #endif
 
@@ -980,18 +995,18 @@ void BfAstNode::ToString(StringImpl& str)
 
 bool BfAstNode::Equals(const StringImpl& str)
 {
-	int len = mSrcEnd - mSrcStart;
+	int len = GetSrcEnd() - GetSrcStart();
 	if (len != str.mLength)
 		return false;
 	auto source = GetSourceData();
-	return strncmp(str.GetPtr(), source->mSrc + mSrcStart, len) == 0;
+	return strncmp(str.GetPtr(), source->mSrc + GetSrcStart(), len) == 0;
 }
 
 bool BfAstNode::Equals(const char* str)
 {	
 	auto source = GetSourceData();
-	const char* ptrLhs = source->mSrc + mSrcStart;
-	const char* ptrLhsEnd = source->mSrc + mSrcEnd;
+	const char* ptrLhs = source->mSrc + GetSrcStart();
+	const char* ptrLhsEnd = source->mSrc + GetSrcEnd();
 	const char* ptrRhs = str;
 
 	while (true)
@@ -1012,37 +1027,8 @@ bool BfAstNode::Equals(const char* str)
 
 void BfBlock::Init(const SizedArrayImpl<BfAstNode*>& vec, BfAstAllocator* alloc)
 {
-#ifdef BF_USE_NEAR_NODE_REF
-	int curIdx = 0;
-	int elemsLeft = (int)vec.size();
-	BfBlockExtension* curExt = NULL;
-
-	while (elemsLeft > 0)
-	{
-		int bytesLeft = alloc->GetCurPageBytesLeft();
-		int useElems = std::min(bytesLeft / (int)sizeof(ASTREF(BfAstNode*)), elemsLeft);
-		BfBlockExtension* nextExt = NULL;		
-		BfSizedArray<ASTREF(BfAstNode*)>& childArrRef = (curExt != NULL) ? curExt->mChildArr : mChildArr;
-		childArrRef.mVals = (ASTREF(BfAstNode*)*)alloc->AllocBytes(useElems * sizeof(ASTREF(BfAstNode*)), sizeof(ASTREF(BfAstNode*)));
-		childArrRef.mSize = useElems;
-		if (useElems < elemsLeft)		
-		{
-			nextExt = alloc->Alloc<BfBlockExtension>();
-			useElems--;
-		}
-
-		for (int i = 0; i < useElems; i++)
-			childArrRef[i] = vec[curIdx++];			
-		if (nextExt != NULL)
-		{
-			childArrRef[useElems] = nextExt;
-			curExt = nextExt;
-		}
-		elemsLeft -= useElems;
-	}
-#else	
+	// Large child arrays come from the AST arena too, so near refs never need the block split into extensions
 	BfSizedArrayInitIndirect(mChildArr, vec, alloc);
-#endif
 }
 
 BfAstNode* BfBlock::GetFirst()
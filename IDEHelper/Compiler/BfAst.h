@@ -7,7 +7,13 @@
 #include "BfIRBuilder.h"
 
 //#define BF_AST_HAS_PARENT_MEMBER
-//#define BF_AST_COMPACT
+
+// Packs mTriviaStart/mSrcStart/mSrcEnd/mToken/mTypeId into 8 bytes, spilling to a BfAstInfo when they don't fit.
+//  The spill pointer shares the slot with the packed fields, so this relies on user-space pointers having bit 63 clear.
+//  Enabled along with near node refs, see BF_AST_NO_COMPACT_REFS.
+#if (defined BF64) && (!defined BF_AST_NO_COMPACT_REFS)
+#define BF_AST_COMPACT
+#endif
 //#define BF_AST_VTABLE
 
 #ifdef _DEBUG
@@ -366,11 +372,108 @@ class BfInlineAsmStatement;
 class BfInlineAsmInstruction;
 class BfFieldDtorDeclaration;
 
+#ifdef BF_USE_NEAR_NODE_REF
+// A node pointer stored in 32 bits, see BfAstArena. It converts to and from the pointer type it wraps.
+template <typename T>
+class BfNearNodeRef
+{
+public:
+	uint32 mRef;
+
+public:
+	BfNearNodeRef()
+	{
+		mRef = 0;
+	}
+
+	BfNearNodeRef(T ptr)
+	{
+		mRef = BfAstArena::Encode(ptr);
+	}
+
+	BfNearNodeRef& operator=(T ptr)
+	{
+		mRef = BfAstArena::Encode(ptr);
+		return *this;
+	}
+
+	operator T() const
+	{
+		return (T)BfAstArena::Decode(mRef);
+	}
+
+	T operator->() const
+	{
+		return (T)BfAstArena::Decode(mRef);
+	}
+};
+
+#define ASTREF(T) BfNearNodeRef<T>
+#else
+#define ASTREF(T) T
+#endif
+
+// Where a child node is stored in its parent, so a visitor can replace it
+class BfAstChildRef
+{
+public:
+	BfAstNode** mPtr;
+#ifdef BF_USE_NEAR_NODE_REF
+	BfNearNodeRef<BfAstNode*>* mNearPtr;
+#endif
+
+public:
+	BfAstChildRef()
+	{
+		mPtr = NULL;
+#ifdef BF_USE_NEAR_NODE_REF
+		mNearPtr = NULL;
+#endif
+	}
+
+	template <typename T>
+	BfAstChildRef(T** ptr)
+	{
+		mPtr = (BfAstNode**)ptr;
+#ifdef BF_USE_NEAR_NODE_REF
+		mNearPtr = NULL;
+#endif
+	}
+
+#ifdef BF_USE_NEAR_NODE_REF
+	template <typename T>
+	BfAstChildRef(BfNearNodeRef<T>* ptr)
+	{
+		mPtr = NULL;
+		mNearPtr = (BfNearNodeRef<BfAstNode*>*)ptr;
+	}
+#endif
+
+	bool IsNull() const
+	{
+#ifdef BF_USE_NEAR_NODE_REF
+		return (mPtr == NULL) && (mNearPtr == NULL);
+#else
+		return mPtr == NULL;
+#endif
+	}
+
+	void Set(BfAstNode* node)
+	{
+		if (mPtr != NULL)
+			*mPtr = node;
+#ifdef BF_USE_NEAR_NODE_REF
+		else if (mNearPtr != NULL)
+			*mNearPtr = node;
+#endif
+	}
+};
+
 class BfStructuralVisitor
 {
 public:
 	bool mCapturingChildRef;
-	BfAstNode** mCurChildRef;
+	BfAstChildRef mCurChildRef;
 
 public:	
 	void VisitMembers(BfBlock* node);
@@ -388,11 +491,11 @@ public:
 			return;
 		if (mCapturingChildRef)
 		{
-			mCurChildRef = ((BfAstNode**) &nodeRef);
+			mCurChildRef = BfAstChildRef(&nodeRef);
 			//AssertValidChildAddr(mCurChildRef);
 		}
 		nodeRef->Accept(this);
-		mCurChildRef = NULL;
+		mCurChildRef = BfAstChildRef();
 	}	
 
 public:
@@ -894,12 +997,6 @@ public:
 	}
 };
 
-#ifdef BF_USE_NEAR_NODE_REF
-#define ASTREF(T) BfNearNodeRef<T>
-#else
-#define ASTREF(T) T
-#endif
-
 template <typename T, typename T2>
 static void BfSizedArrayInitIndirect(BfSizedArray<T>& sizedArray, const SizedArrayImpl<T2>& vec, BfAstAllocator* alloc)
 {	
@@ -1000,8 +1097,9 @@ public:
 	BfAstNode()
 	{
 #ifdef BF_AST_COMPACT
-		// Nothing
-		mIsCompact = true;
+		mCompact_TypeId = 0;
+		mCompact_Token = BfToken_None;
+		InitEmpty();
 #else
 		//mParent = NULL;
 		mTriviaStart = -1;
@@ -1014,6 +1112,23 @@ public:
 #ifdef BF_AST_VTABLE
 	virtual ~BfAstNode()
 	{
+#ifdef BF_USE_NEAR_NODE_REF
+		ReleaseFarRef();
+#endif
+	}
+#elif defined BF_USE_NEAR_NODE_REF
+	~BfAstNode()
+	{
+		ReleaseFarRef();
+	}
+#endif
+
+#ifdef BF_USE_NEAR_NODE_REF
+	// Temporaries (and nodes on overflow runs) may have been given far table entries
+	void ReleaseFarRef()
+	{
+		if (!BfAstArena::Contains(this))
+			BfAstArena::ReleaseFar(this);
 	}
 #endif
 	
@@ -1067,7 +1182,10 @@ public:
 
 	void InitWithTypeId(int typeId)
 	{
-		mCompact_TypeId = typeId;
+		if (mIsCompact)
+			mCompact_TypeId = typeId;
+		else
+			mAstInfo->mTypeId = typeId;
 	}
 
 	bool IsInitialized()
@@ -1190,6 +1308,7 @@ public:
 			{
 				auto astInfo = AllocAstInfo();
 				astInfo->mTypeId = mCompact_TypeId;
+				astInfo->mToken = mCompact_Token;
 				astInfo->mSrcStart = srcStart;
 				astInfo->mTriviaStart = srcStart - triviaLen;
 				astInfo->mSrcEnd = srcStart + srcLen;
@@ -1220,6 +1339,7 @@ public:
 
 			auto astInfo = AllocAstInfo();
 			astInfo->mTypeId = mCompact_TypeId;
+			astInfo->mToken = mCompact_Token;
 			astInfo->mSrcStart = mCompact_SrcStart;
 			astInfo->mTriviaStart = mCompact_SrcStart - mCompact_TriviaLen;
 			mAstInfo = astInfo;
@@ -1248,6 +1368,12 @@ public:
 			return (srcPos >= mCompact_SrcStart) && (srcPos < mCompact_SrcStart + mCompact_SrcLen);
 		return (srcPos >= mAstInfo->mSrcStart) && (srcPos < mAstInfo->mSrcEnd);
 	}
+
+	bool Contains(int srcPos, int lenAdd, int startAdd)
+	{
+		int srcStart = GetSrcStart();
+		return (srcPos >= srcStart + startAdd) && (srcPos < GetSrcEnd() + lenAdd);
+	}
 #else
 	void InitEmpty()
 	{
@@ -1379,6 +1505,7 @@ public:
 		T* val = new T();
 #ifdef BF_AST_COMPACT
 		memset((uint8*)val + offsetof(T, mAstInfo), 0, sizeof(T) - offsetof(T, mAstInfo));
+		val->InitEmpty();
 #else
 		memset((uint8*)val + offsetof(T, mTriviaStart), 0, sizeof(T) - offsetof(T, mTriviaStart));
 #endif
@@ -1441,7 +1568,7 @@ class BfErrorNode : public BfAstNode
 public:
 	BF_AST_TYPE(BfErrorNode, BfAstNode);
 
-	BfAstNode* mRefNode;
+	ASTREF(BfAstNode*) mRefNode;
 };	BF_AST_DECL(BfErrorNode, BfAstNode);
 	
 
@@ -1450,7 +1577,7 @@ class BfStatement : public BfAstNode
 public:
 	BF_AST_TYPE(BfStatement, BfAstNode);
 
-	BfTokenNode* mTrailingSemicolon;
+	ASTREF(BfTokenNode*) mTrailingSemicolon;
 
 //	bool IsMissingSemicolon();
 // 	{
@@ -1475,7 +1602,7 @@ class BfExpressionStatement : public BfStatement
 {
 public:
 	BF_AST_TYPE(BfExpressionStatement, BfStatement);
-	BfExpression* mExpression;
+	ASTREF(BfExpression*) mExpression;
 };  BF_AST_DECL(BfExpressionStatement, BfStatement);
 
 class BfBlockExtension : public BfAstNode
@@ -1582,28 +1709,7 @@ public:
 
 	ASTREF(BfAstNode*)& operator[](int idx)
 	{
-#ifdef BF_USE_NEAR_NODE_REF
-		BfSizedArray<ASTREF(BfAstNode*)>* childArr = &mChildArr;
-
-		while (true)
-		{
-			if (idx < childArr->mSize - 1)
-				return childArr->mVals[idx];
-			if (idx == childArr->mSize - 1)
-			{
-				auto& checkNode = childArr->mVals[childArr->mSize - 1];
-				if (!checkNode->IsA<BfBlockExtension>())
-					return checkNode;
-			}
-
-			idx -= childArr->mSize - 1;
-			BfBlockExtension* blockExt = (BfBlockExtension*)(BfAstNode*)childArr->mVals[childArr->mSize - 1];
-			BF_ASSERT(blockExt->GetTypeId() == BfBlockExtension::TypeId);
-			childArr = &blockExt->mChildArr;
-		}		
-#else
 		return mChildArr.mVals[idx];
-#endif
 	}
 
 	Iterator begin()
@@ -1623,7 +1729,7 @@ public:
 	BF_AST_TYPE(BfTypedValueExpression, BfExpression);
 
 	BfTypedValue mTypedValue;
-	BfAstNode* mRefNode;
+	ASTREF(BfAstNode*) mRefNode;
 
 public:
 	void Init(const BfTypedValue& typedValue)
@@ -1648,8 +1754,8 @@ class BfLabelNode : public BfAstNode
 public:
 	BF_AST_TYPE(BfLabelNode, BfAstNode);
 
-	BfIdentifierNode* mLabel;
-	BfTokenNode* mColonToken;
+	ASTREF(BfIdentifierNode*) mLabel;
+	ASTREF(BfTokenNode*) mColonToken;
 };	BF_AST_DECL(BfLabelNode, BfAstNode);
 
 class BfLabelableStatement : public BfCompoundStatement
@@ -1657,7 +1763,7 @@ class BfLabelableStatement : public BfCompoundStatement
 public:
 	BF_AST_TYPE(BfLabelableStatement, BfCompoundStatement);
 
-	BfLabelNode* mLabelNode;
+	ASTREF(BfLabelNode*) mLabelNode;
 };	BF_AST_DECL(BfLabelableStatement, BfCompoundStatement);
 
 class BfLabeledBlock : public BfLabelableStatement
@@ -1665,7 +1771,7 @@ class BfLabeledBlock : public BfLabelableStatement
 public:
 	BF_AST_TYPE(BfLabeledBlock, BfLabelableStatement);
 
-	BfBlock* mBlock;
+	ASTREF(BfBlock*) mBlock;
 };	BF_AST_DECL(BfLabeledBlock, BfLabelableStatement);
 
 enum BfBinaryOp
@@ -1741,10 +1847,10 @@ class BfScopeNode : public BfAstNode
 public:
 	BF_AST_TYPE(BfScopeNode, BfAstNode);
 
-	BfTokenNode* mScopeToken;
-	BfTokenNode* mColonToken;
-	BfAstNode* mTargetNode; // . : or identifier
-	BfAttributeDirective* mAttributes;
+	ASTREF(BfTokenNode*) mScopeToken;
+	ASTREF(BfTokenNode*) mColonToken;
+	ASTREF(BfAstNode*) mTargetNode; // . : or identifier
+	ASTREF(BfAttributeDirective*) mAttributes;
 };	BF_AST_DECL(BfScopeNode, BfAstNode);
 
 class BfNewNode : public BfAstNode
@@ -1752,10 +1858,10 @@ class BfNewNode : public BfAstNode
 public:
 	BF_AST_TYPE(BfNewNode, BfAstNode);
 
-	BfTokenNode* mNewToken;
-	BfTokenNode* mColonToken;	
-	BfAstNode* mAllocNode; // Expression or BfScopedInvocationTarget
-	BfAttributeDirective* mAttributes;
+	ASTREF(BfTokenNode*) mNewToken;
+	ASTREF(BfTokenNode*) mColonToken;	
+	ASTREF(BfAstNode*) mAllocNode; // Expression or BfScopedInvocationTarget
+	ASTREF(BfAttributeDirective*) mAttributes;
 };	BF_AST_DECL(BfNewNode, BfAstNode);
 
 enum BfCommentKind
@@ -1783,8 +1889,8 @@ class BfPreprocessorNode : public BfAstNode
 public:
 	BF_AST_TYPE(BfPreprocessorNode, BfAstNode);
 
-	BfIdentifierNode* mCommand;
-	BfBlock* mArgument;	
+	ASTREF(BfIdentifierNode*) mCommand;
+	ASTREF(BfBlock*) mArgument;	
 };	BF_AST_DECL(BfPreprocessorNode, BfAstNode);
 
 class BfPreprocessorDefinedExpression : public BfExpression
@@ -1813,8 +1919,8 @@ class BfAttributedIdentifierNode : public BfExpression
 public:
 	BF_AST_TYPE(BfAttributedIdentifierNode, BfExpression);
 
-	BfIdentifierNode* mIdentifier;
-	BfAttributeDirective* mAttributes;	
+	ASTREF(BfIdentifierNode*) mIdentifier;
+	ASTREF(BfAttributeDirective*) mAttributes;	
 };	BF_AST_DECL(BfAttributedIdentifierNode, BfExpression);
 
 class BfQualifiedNameNode : public BfIdentifierNode
@@ -1832,8 +1938,8 @@ class BfUsingDirective : public BfStatement
 public:
 	BF_AST_TYPE(BfUsingDirective, BfStatement);
 
-	BfTokenNode* mUsingToken;	
-	BfIdentifierNode* mNamespace;	
+	ASTREF(BfTokenNode*) mUsingToken;	
+	ASTREF(BfIdentifierNode*) mNamespace;	
 };	BF_AST_DECL(BfUsingDirective, BfStatement);
 
 class BfUsingStaticDirective : public BfStatement
@@ -1841,9 +1947,9 @@ class BfUsingStaticDirective : public BfStatement
 public:
 	BF_AST_TYPE(BfUsingStaticDirective, BfStatement);
 
-	BfTokenNode* mUsingToken;
-	BfTokenNode* mStaticToken;
-	BfTypeReference* mTypeRef;
+	ASTREF(BfTokenNode*) mUsingToken;
+	ASTREF(BfTokenNode*) mStaticToken;
+	ASTREF(BfTypeReference*) mTypeRef;
 };	BF_AST_DECL(BfUsingStaticDirective, BfStatement);
 
 class BfAttributeTargetSpecifier : public BfAstNode
@@ -1881,9 +1987,9 @@ class BfNamespaceDeclaration : public BfAstNode
 public:
 	BF_AST_TYPE(BfNamespaceDeclaration, BfAstNode);
 
-	BfTokenNode* mNamespaceNode;
-	BfIdentifierNode* mNameNode;
-	BfBlock* mBlock;
+	ASTREF(BfTokenNode*) mNamespaceNode;
+	ASTREF(BfIdentifierNode*) mNameNode;
+	ASTREF(BfBlock*) mBlock;
 };	BF_AST_DECL(BfNamespaceDeclaration, BfAstNode);
 
 class BfBinaryOperatorExpression : public BfExpression
@@ -1902,11 +2008,11 @@ class BfConditionalExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfConditionalExpression, BfExpression);
 
-	BfExpression* mConditionExpression;
-	BfTokenNode* mQuestionToken;
-	BfExpression* mTrueExpression;
-	BfTokenNode* mColonToken;
-	BfExpression* mFalseExpression;
+	ASTREF(BfExpression*) mConditionExpression;
+	ASTREF(BfTokenNode*) mQuestionToken;
+	ASTREF(BfExpression*) mTrueExpression;
+	ASTREF(BfTokenNode*) mColonToken;
+	ASTREF(BfExpression*) mFalseExpression;
 };	BF_AST_DECL(BfConditionalExpression, BfExpression);
 
 class BfAssignmentExpression : public BfExpression
@@ -1931,9 +2037,9 @@ class BfIndexerExpression : public BfMethodBoundExpression
 public:
 	BF_AST_TYPE(BfIndexerExpression, BfMethodBoundExpression);
 
-	BfExpression* mTarget;
-	BfTokenNode* mOpenBracket;
-	BfTokenNode* mCloseBracket;
+	ASTREF(BfExpression*) mTarget;
+	ASTREF(BfTokenNode*) mOpenBracket;
+	ASTREF(BfTokenNode*) mCloseBracket;
 	BfSizedArray<ASTREF(BfExpression*)> mArguments;
 	BfSizedArray<ASTREF(BfTokenNode*)> mCommas;
 };	BF_AST_DECL(BfIndexerExpression, BfMethodBoundExpression);
@@ -1989,10 +2095,10 @@ class BfCollectionInitializerExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfCollectionInitializerExpression, BfExpression);
 
-	BfTokenNode* mOpenBrace;
+	ASTREF(BfTokenNode*) mOpenBrace;
 	BfSizedArray<ASTREF(BfExpression*)> mValues;
 	BfSizedArray<ASTREF(BfTokenNode*)> mCommas;
-	BfTokenNode* mCloseBrace;	
+	ASTREF(BfTokenNode*) mCloseBrace;	
 };	BF_AST_DECL(BfCollectionInitializerExpression, BfExpression);
 
 class BfSizedArrayCreateExpression : public BfExpression
@@ -2000,8 +2106,8 @@ class BfSizedArrayCreateExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfSizedArrayCreateExpression, BfExpression);
 
-	BfArrayTypeRef* mTypeRef;
-	BfCollectionInitializerExpression* mInitializer;
+	ASTREF(BfArrayTypeRef*) mTypeRef;
+	ASTREF(BfCollectionInitializerExpression*) mInitializer;
 };	BF_AST_DECL(BfSizedArrayCreateExpression, BfExpression);
 
 class BfParenthesizedExpression : public BfExpression
@@ -2009,9 +2115,9 @@ class BfParenthesizedExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfParenthesizedExpression, BfExpression);
 
-	BfTokenNode* mOpenParen;
-	BfExpression* mExpression;
-	BfTokenNode* mCloseParen;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfExpression*) mExpression;
+	ASTREF(BfTokenNode*) mCloseParen;
 };	BF_AST_DECL(BfParenthesizedExpression, BfExpression);
 
 class BfTupleNameNode : public BfAstNode
@@ -2019,8 +2125,8 @@ class BfTupleNameNode : public BfAstNode
 public:
 	BF_AST_TYPE(BfTupleNameNode, BfAstNode);
 
-	BfIdentifierNode* mNameNode;
-	BfTokenNode* mColonToken;
+	ASTREF(BfIdentifierNode*) mNameNode;
+	ASTREF(BfTokenNode*) mColonToken;
 };	BF_AST_DECL(BfTupleNameNode, BfAstNode);
 
 class BfTupleExpression : public BfExpression
@@ -2028,7 +2134,7 @@ class BfTupleExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfTupleExpression, BfExpression);
 
-	BfTokenNode* mOpenParen;
+	ASTREF(BfTokenNode*) mOpenParen;
 	BfSizedArray<ASTREF(BfTupleNameNode*)> mNames;	
 	BfSizedArray<ASTREF(BfExpression*)> mValues;
 	BfSizedArray<ASTREF(BfTokenNode*)> mCommas;
@@ -2040,8 +2146,8 @@ class BfWhenExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfWhenExpression, BfExpression);
 
-	BfTokenNode* mWhenToken;
-	BfExpression* mExpression;
+	ASTREF(BfTokenNode*) mWhenToken;
+	ASTREF(BfExpression*) mExpression;
 };	BF_AST_DECL(BfWhenExpression, BfExpression);
 
 class BfEnumCaseBindExpression : public BfExpression
@@ -2049,9 +2155,9 @@ class BfEnumCaseBindExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfEnumCaseBindExpression, BfExpression);
 
-	BfTokenNode* mBindToken; // Either 'var' or 'let'
-	BfAstNode* mEnumMemberExpr; // Either a BfMemberReferenceExpression or a BfIdentifierNode
-	BfTupleExpression* mBindNames;
+	ASTREF(BfTokenNode*) mBindToken; // Either 'var' or 'let'
+	ASTREF(BfAstNode*) mEnumMemberExpr; // Either a BfMemberReferenceExpression or a BfIdentifierNode
+	ASTREF(BfTupleExpression*) mBindNames;
 };	BF_AST_DECL(BfEnumCaseBindExpression, BfExpression);
 
 class BfCaseExpression : public BfExpression
@@ -2059,10 +2165,10 @@ class BfCaseExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfCaseExpression, BfExpression);
 
-	BfTokenNode* mCaseToken;
-	BfExpression* mCaseExpression;
-	BfTokenNode* mEqualsNode;
-	BfExpression* mValueExpression;
+	ASTREF(BfTokenNode*) mCaseToken;
+	ASTREF(BfExpression*) mCaseExpression;
+	ASTREF(BfTokenNode*) mEqualsNode;
+	ASTREF(BfExpression*) mValueExpression;
 };	BF_AST_DECL(BfCaseExpression, BfExpression);
 
 class BfSwitchCase : public BfAstNode
@@ -2070,13 +2176,13 @@ class BfSwitchCase : public BfAstNode
 public:
 	BF_AST_TYPE(BfSwitchCase, BfAstNode);
 
-	BfTokenNode* mCaseToken;
+	ASTREF(BfTokenNode*) mCaseToken;
 	BfSizedArray<ASTREF(BfExpression*)> mCaseExpressions;
 	BfSizedArray<ASTREF(BfTokenNode*)> mCaseCommas;
-	BfTokenNode* mColonToken;	
-	BfBlock* mCodeBlock; // May or may not have braces set
-	BfTokenNode* mEndingToken; // Null, Fallthrough, or Break
-	BfTokenNode* mEndingSemicolonToken;
+	ASTREF(BfTokenNode*) mColonToken;	
+	ASTREF(BfBlock*) mCodeBlock; // May or may not have braces set
+	ASTREF(BfTokenNode*) mEndingToken; // Null, Fallthrough, or Break
+	ASTREF(BfTokenNode*) mEndingSemicolonToken;
 };	BF_AST_DECL(BfSwitchCase, BfAstNode);
 
 class BfSwitchStatement : public BfLabelableStatement
@@ -2084,15 +2190,15 @@ class BfSwitchStatement : public BfLabelableStatement
 public:
 	BF_AST_TYPE(BfSwitchStatement, BfLabelableStatement);
 
-	BfTokenNode* mSwitchToken;
-	BfTokenNode* mOpenParen;
-	BfExpression* mSwitchValue;
-	BfTokenNode* mCloseParen;
+	ASTREF(BfTokenNode*) mSwitchToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfExpression*) mSwitchValue;
+	ASTREF(BfTokenNode*) mCloseParen;
 
-	BfTokenNode* mOpenBrace;
+	ASTREF(BfTokenNode*) mOpenBrace;
 	BfSizedArray<ASTREF(BfSwitchCase*)> mSwitchCases;
-	BfSwitchCase* mDefaultCase;
-	BfTokenNode* mCloseBrace;
+	ASTREF(BfSwitchCase*) mDefaultCase;
+	ASTREF(BfTokenNode*) mCloseBrace;
 };	BF_AST_DECL(BfSwitchStatement, BfLabelableStatement);
 
 class BfIfStatement : public BfLabelableStatement
@@ -2100,13 +2206,13 @@ class BfIfStatement : public BfLabelableStatement
 public:
 	BF_AST_TYPE(BfIfStatement, BfLabelableStatement);
 
-	BfTokenNode* mIfToken;
-	BfTokenNode* mOpenParen;
-	BfExpression* mCondition;
-	BfTokenNode* mCloseParen;
-	BfAstNode* mTrueStatement;
-	BfTokenNode* mElseToken;
-	BfAstNode* mFalseStatement;
+	ASTREF(BfTokenNode*) mIfToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfExpression*) mCondition;
+	ASTREF(BfTokenNode*) mCloseParen;
+	ASTREF(BfAstNode*) mTrueStatement;
+	ASTREF(BfTokenNode*) mElseToken;
+	ASTREF(BfAstNode*) mFalseStatement;
 };	BF_AST_DECL(BfIfStatement, BfLabelableStatement);
 
 class BfEmptyStatement : public BfStatement
@@ -2128,21 +2234,21 @@ class BfTypeDeclaration : public BfAstNode
 public:
 	BF_AST_TYPE(BfTypeDeclaration, BfAstNode);
 
-	BfCommentNode* mDocumentation;
-	BfAttributeDirective* mAttributes;
-	BfTokenNode* mAbstractSpecifier;	
-	BfTokenNode* mSealedSpecifier;	
-	BfTokenNode* mProtectionSpecifier;
-	BfTokenNode* mStaticSpecifier;
-	BfTokenNode* mPartialSpecifier;
-	BfTokenNode* mTypeNode;
-	BfIdentifierNode* mNameNode;	
-	BfAstNode* mDefineNode;		
-	BfGenericParamsDeclaration* mGenericParams;
-	BfGenericConstraintsDeclaration* mGenericConstraintsDeclaration;
+	ASTREF(BfCommentNode*) mDocumentation;
+	ASTREF(BfAttributeDirective*) mAttributes;
+	ASTREF(BfTokenNode*) mAbstractSpecifier;	
+	ASTREF(BfTokenNode*) mSealedSpecifier;	
+	ASTREF(BfTokenNode*) mProtectionSpecifier;
+	ASTREF(BfTokenNode*) mStaticSpecifier;
+	ASTREF(BfTokenNode*) mPartialSpecifier;
+	ASTREF(BfTokenNode*) mTypeNode;
+	ASTREF(BfIdentifierNode*) mNameNode;	
+	ASTREF(BfAstNode*) mDefineNode;		
+	ASTREF(BfGenericParamsDeclaration*) mGenericParams;
+	ASTREF(BfGenericConstraintsDeclaration*) mGenericConstraintsDeclaration;
 	bool mIgnoreDeclaration;
 
-	BfTokenNode* mColonToken;
+	ASTREF(BfTokenNode*) mColonToken;
 	BfSizedArray<ASTREF(BfTypeReference*)> mBaseClasses;
 	BfSizedArray<ASTREF(BfAstNode*)> mBaseClassCommas;
 	
@@ -2153,9 +2259,9 @@ class BfTypeAliasDeclaration : public BfTypeDeclaration
 public:
 	BF_AST_TYPE(BfTypeAliasDeclaration, BfTypeDeclaration);
 
-	BfTokenNode* mEqualsToken;
-	BfTypeReference* mAliasToType;
-	BfTokenNode* mEndSemicolon;
+	ASTREF(BfTokenNode*) mEqualsToken;
+	ASTREF(BfTypeReference*) mAliasToType;
+	ASTREF(BfTokenNode*) mEndSemicolon;
 
 };	BF_AST_DECL(BfTypeAliasDeclaration, BfTypeDeclaration);
 
@@ -2230,7 +2336,7 @@ class BfDotTypeReference : public BfTypeReference
 public:
 	BF_AST_TYPE(BfDotTypeReference, BfTypeReference);
 
-	BfTokenNode* mDotToken;
+	ASTREF(BfTokenNode*) mDotToken;
 };	BF_AST_DECL(BfDotTypeReference, BfTypeReference);
 
 class BfVarTypeReference : public BfTypeReference
@@ -2238,7 +2344,7 @@ class BfVarTypeReference : public BfTypeReference
 public:
 	BF_AST_TYPE(BfVarTypeReference, BfTypeReference);
 
-	BfTokenNode* mVarToken;
+	ASTREF(BfTokenNode*) mVarToken;
 };	BF_AST_DECL(BfVarTypeReference, BfTypeReference);
 
 class BfVarRefTypeReference : public BfTypeReference
@@ -2246,8 +2352,8 @@ class BfVarRefTypeReference : public BfTypeReference
 public:
 	BF_AST_TYPE(BfVarRefTypeReference, BfTypeReference);
 
-	BfTokenNode* mVarToken;
-	BfTokenNode* mRefToken;
+	ASTREF(BfTokenNode*) mVarToken;
+	ASTREF(BfTokenNode*) mRefToken;
 };	BF_AST_DECL(BfVarRefTypeReference, BfTypeReference);
 
 class BfLetTypeReference : public BfTypeReference
@@ -2255,7 +2361,7 @@ class BfLetTypeReference : public BfTypeReference
 public:
 	BF_AST_TYPE(BfLetTypeReference, BfTypeReference);
 
-	BfTokenNode* mLetToken;
+	ASTREF(BfTokenNode*) mLetToken;
 };	BF_AST_DECL(BfLetTypeReference, BfTypeReference);
 
 class BfWildcardTypeReference : public BfTypeReference
@@ -2263,7 +2369,7 @@ class BfWildcardTypeReference : public BfTypeReference
 public:
 	BF_AST_TYPE(BfWildcardTypeReference, BfTypeReference);
 
-	BfTokenNode* mWildcardToken;
+	ASTREF(BfTokenNode*) mWildcardToken;
 };	BF_AST_DECL(BfWildcardTypeReference, BfTypeReference);
 
 class BfQualifiedTypeReference : public BfTypeReference
@@ -2306,9 +2412,9 @@ class BfRetTypeTypeRef : public BfElementedTypeRef
 public:
 	BF_AST_TYPE(BfRetTypeTypeRef, BfElementedTypeRef);
 
-	BfTokenNode* mRetTypeToken;
-	BfTokenNode* mOpenParen;
-	BfTokenNode* mCloseParen;
+	ASTREF(BfTokenNode*) mRetTypeToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfTokenNode*) mCloseParen;
 };	BF_AST_DECL(BfRetTypeTypeRef, BfElementedTypeRef);
 
 class BfArrayTypeRef : public BfElementedTypeRef
@@ -2317,9 +2423,9 @@ public:
 	BF_AST_TYPE(BfArrayTypeRef, BfElementedTypeRef);
 
 	int mDimensions;
-	BfTokenNode* mOpenBracket;
+	ASTREF(BfTokenNode*) mOpenBracket;
 	BfSizedArray<ASTREF(BfAstNode*)> mParams; // Either commas or constant size expression
-	BfTokenNode* mCloseBracket;
+	ASTREF(BfTokenNode*) mCloseBracket;
 };	BF_AST_DECL(BfArrayTypeRef, BfElementedTypeRef);
 
 class BfNullableTypeRef : public BfElementedTypeRef
@@ -2327,7 +2433,7 @@ class BfNullableTypeRef : public BfElementedTypeRef
 public:
 	BF_AST_TYPE(BfNullableTypeRef, BfElementedTypeRef);
 
-	BfTokenNode* mQuestionToken;
+	ASTREF(BfTokenNode*) mQuestionToken;
 };	BF_AST_DECL(BfNullableTypeRef, BfElementedTypeRef);
 
 class BfGenericInstanceTypeRef : public BfElementedTypeRef
@@ -2335,10 +2441,10 @@ class BfGenericInstanceTypeRef : public BfElementedTypeRef
 public:
 	BF_AST_TYPE(BfGenericInstanceTypeRef, BfElementedTypeRef);
 
-	BfTokenNode* mOpenChevron;
-	BfSizedArray<BfTypeReference*> mGenericArguments;	
+	ASTREF(BfTokenNode*) mOpenChevron;
+	BfSizedArray<ASTREF(BfTypeReference*)> mGenericArguments;	
 	BfSizedArray<ASTREF(BfAstNode*)> mCommas;
-	BfTokenNode* mCloseChevron;
+	ASTREF(BfTokenNode*) mCloseChevron;
 	int GetGenericArgCount()
 	{
 		if (!mCommas.empty())
@@ -2370,14 +2476,14 @@ class BfDelegateTypeRef : public BfTypeReference
 public:
 	BF_AST_TYPE(BfDelegateTypeRef, BfTypeReference);
 
-	BfTokenNode* mTypeToken; // Delegate or Function
+	ASTREF(BfTokenNode*) mTypeToken; // Delegate or Function
 
-	BfAttributeDirective* mAttributes;
-	BfTypeReference* mReturnType;
-	BfAstNode* mOpenParen;
-	BfSizedArray<BfParameterDeclaration*> mParams;
-	BfSizedArray<BfTokenNode*> mCommas;
-	BfAstNode* mCloseParen;
+	ASTREF(BfAttributeDirective*) mAttributes;
+	ASTREF(BfTypeReference*) mReturnType;
+	ASTREF(BfAstNode*) mOpenParen;
+	BfSizedArray<ASTREF(BfParameterDeclaration*)> mParams;
+	BfSizedArray<ASTREF(BfTokenNode*)> mCommas;
+	ASTREF(BfAstNode*) mCloseParen;
 };	BF_AST_DECL(BfDelegateTypeRef, BfTypeReference);
 
 class BfDeclTypeRef : public BfTypeReference
@@ -2385,10 +2491,10 @@ class BfDeclTypeRef : public BfTypeReference
 public:
 	BF_AST_TYPE(BfDeclTypeRef, BfTypeReference);
 
-	BfTokenNode* mToken;
-	BfTokenNode* mOpenParen;
-	BfExpression* mTarget;
-	BfTokenNode* mCloseParen;
+	ASTREF(BfTokenNode*) mToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfExpression*) mTarget;
+	ASTREF(BfTokenNode*) mCloseParen;
 };	BF_AST_DECL(BfDeclTypeRef, BfTypeReference);
 
 enum BfGenericParamKind
@@ -2411,36 +2517,36 @@ class BfPointerTypeRef : public BfElementedTypeRef
 public:
 	BF_AST_TYPE(BfPointerTypeRef, BfElementedTypeRef);
 	
-	BfTokenNode* mStarNode;
+	ASTREF(BfTokenNode*) mStarNode;
 };	BF_AST_DECL(BfPointerTypeRef, BfElementedTypeRef);
 
 class BfConstTypeRef : public BfElementedTypeRef
 {
 public:
 	BF_AST_TYPE(BfConstTypeRef, BfElementedTypeRef);
-	BfTokenNode* mConstToken;
+	ASTREF(BfTokenNode*) mConstToken;
 };	BF_AST_DECL(BfConstTypeRef, BfElementedTypeRef);
 
 class BfConstExprTypeRef : public BfTypeReference
 {
 public:
 	BF_AST_TYPE(BfConstExprTypeRef, BfTypeReference);
-	BfTokenNode* mConstToken;
-	BfExpression* mConstExpr;
+	ASTREF(BfTokenNode*) mConstToken;
+	ASTREF(BfExpression*) mConstExpr;
 };	BF_AST_DECL(BfConstExprTypeRef, BfTypeReference);
 
 class BfUnsignedTypeRef : public BfElementedTypeRef
 {
 public:
 	BF_AST_TYPE(BfUnsignedTypeRef, BfElementedTypeRef);
-	BfTokenNode* mUnsignedToken;
+	ASTREF(BfTokenNode*) mUnsignedToken;
 };	BF_AST_DECL(BfUnsignedTypeRef, BfElementedTypeRef);
 
 class BfRefTypeRef : public BfElementedTypeRef
 {
 public:
 	BF_AST_TYPE(BfRefTypeRef, BfElementedTypeRef);
-	BfTokenNode* mRefToken;
+	ASTREF(BfTokenNode*) mRefToken;
 };	BF_AST_DECL(BfRefTypeRef, BfElementedTypeRef);
 
 class BfParamsExpression : public BfExpression
@@ -2448,7 +2554,7 @@ class BfParamsExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfParamsExpression, BfExpression);
 
-	BfTokenNode* mParamsToken;	
+	ASTREF(BfTokenNode*) mParamsToken;	
 };	BF_AST_DECL(BfParamsExpression, BfExpression);
 
 class BfTypeAttrExpression : public BfExpression
@@ -2456,10 +2562,10 @@ class BfTypeAttrExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfTypeAttrExpression, BfExpression);
 
-	BfTokenNode* mToken;
-	BfTokenNode* mOpenParen;
-	BfTypeReference* mTypeRef;
-	BfTokenNode* mCloseParen;
+	ASTREF(BfTokenNode*) mToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfTypeReference*) mTypeRef;
+	ASTREF(BfTokenNode*) mCloseParen;
 };	BF_AST_DECL(BfTypeAttrExpression, BfExpression);
 
 class BfTypeOfExpression : public BfTypeAttrExpression
@@ -2491,10 +2597,10 @@ class BfDefaultExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfDefaultExpression, BfExpression);
 
-	BfTokenNode* mDefaultToken;
-	BfTokenNode* mOpenParen;
-	BfTypeReference* mTypeRef;
-	BfTokenNode* mCloseParen;
+	ASTREF(BfTokenNode*) mDefaultToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfTypeReference*) mTypeRef;
+	ASTREF(BfTokenNode*) mCloseParen;
 };	BF_AST_DECL(BfDefaultExpression, BfExpression);
 
 class BfUninitializedExpression : public BfExpression
@@ -2502,7 +2608,7 @@ class BfUninitializedExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfUninitializedExpression, BfExpression);
 
-	BfTokenNode* mQuestionToken;
+	ASTREF(BfTokenNode*) mQuestionToken;
 };	BF_AST_DECL(BfUninitializedExpression, BfExpression);
 
 class BfCheckTypeExpression : public BfExpression
@@ -2510,9 +2616,9 @@ class BfCheckTypeExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfCheckTypeExpression, BfExpression);
 
-	BfExpression* mTarget;
-	BfTokenNode* mIsToken;
-	BfTypeReference* mTypeRef;
+	ASTREF(BfExpression*) mTarget;
+	ASTREF(BfTokenNode*) mIsToken;
+	ASTREF(BfTypeReference*) mTypeRef;
 };	BF_AST_DECL(BfCheckTypeExpression, BfExpression);
 
 class BfDynamicCastExpression : public BfExpression
@@ -2520,9 +2626,9 @@ class BfDynamicCastExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfDynamicCastExpression, BfExpression);
 
-	BfExpression* mTarget;
-	BfTokenNode* mAsToken;
-	BfTypeReference* mTypeRef;	
+	ASTREF(BfExpression*) mTarget;
+	ASTREF(BfTokenNode*) mAsToken;
+	ASTREF(BfTypeReference*) mTypeRef;	
 };	BF_AST_DECL(BfDynamicCastExpression, BfExpression);
 
 class BfCastExpression : public BfUnaryOperatorExpression
@@ -2530,9 +2636,9 @@ class BfCastExpression : public BfUnaryOperatorExpression
 public:
 	BF_AST_TYPE(BfCastExpression, BfUnaryOperatorExpression);
 	
-	BfTokenNode* mOpenParen;
-	BfTypeReference* mTypeRef;
-	BfTokenNode* mCloseParen;	
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfTypeReference*) mTypeRef;
+	ASTREF(BfTokenNode*) mCloseParen;	
 };	BF_AST_DECL(BfCastExpression, BfUnaryOperatorExpression);
 
 class BfDelegateBindExpression : public BfMethodBoundExpression
@@ -2540,10 +2646,10 @@ class BfDelegateBindExpression : public BfMethodBoundExpression
 public:
 	BF_AST_TYPE(BfDelegateBindExpression, BfMethodBoundExpression);
 
-	BfAstNode* mNewToken;
-	BfTokenNode* mFatArrowToken;
-	BfExpression* mTarget;
-	BfGenericArgumentsNode* mGenericArgs;
+	ASTREF(BfAstNode*) mNewToken;
+	ASTREF(BfTokenNode*) mFatArrowToken;
+	ASTREF(BfExpression*) mTarget;
+	ASTREF(BfGenericArgumentsNode*) mGenericArgs;
 };	BF_AST_DECL(BfDelegateBindExpression, BfMethodBoundExpression);
 
 class BfLambdaBindExpression : public BfExpression
@@ -2551,14 +2657,14 @@ class BfLambdaBindExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfLambdaBindExpression, BfExpression);
 
-	BfAstNode* mNewToken;	
-	BfTokenNode* mOpenParen;
-	BfTokenNode* mCloseParen;		
+	ASTREF(BfAstNode*) mNewToken;	
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfTokenNode*) mCloseParen;		
 	BfSizedArray<ASTREF(BfIdentifierNode*)> mParams;
 	BfSizedArray<ASTREF(BfTokenNode*)> mCommas;
-	BfTokenNode* mFatArrowToken;
-	BfAstNode* mBody; // Either expression or block
-	BfFieldDtorDeclaration* mDtor;
+	ASTREF(BfTokenNode*) mFatArrowToken;
+	ASTREF(BfAstNode*) mBody; // Either expression or block
+	ASTREF(BfFieldDtorDeclaration*) mDtor;
 };	BF_AST_DECL(BfLambdaBindExpression, BfExpression);
 
 class BfAttributedExpression : public BfExpression
@@ -2566,8 +2672,8 @@ class BfAttributedExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfAttributedExpression, BfExpression);
 
-	BfAttributeDirective* mAttributes;
-	BfExpression* mExpression;
+	ASTREF(BfAttributeDirective*) mAttributes;
+	ASTREF(BfExpression*) mExpression;
 };	BF_AST_DECL(BfAttributedExpression, BfExpression);
 
 class BfObjectCreateExpression : public BfMethodBoundExpression
@@ -2575,13 +2681,13 @@ class BfObjectCreateExpression : public BfMethodBoundExpression
 public:
 	BF_AST_TYPE(BfObjectCreateExpression, BfMethodBoundExpression);
 
-	BfAstNode* mNewNode;
-	BfTokenNode* mStarToken;
-	BfTypeReference* mTypeRef;	
-	BfTokenNode* mOpenToken;
-	BfTokenNode* mCloseToken;	
-	BfSizedArray<BfExpression*> mArguments;
-	BfSizedArray<BfTokenNode*> mCommas;
+	ASTREF(BfAstNode*) mNewNode;
+	ASTREF(BfTokenNode*) mStarToken;
+	ASTREF(BfTypeReference*) mTypeRef;	
+	ASTREF(BfTokenNode*) mOpenToken;
+	ASTREF(BfTokenNode*) mCloseToken;	
+	BfSizedArray<ASTREF(BfExpression*)> mArguments;
+	BfSizedArray<ASTREF(BfTokenNode*)> mCommas;
 };	BF_AST_DECL(BfObjectCreateExpression, BfMethodBoundExpression);
 
 class BfBoxExpression : public BfExpression
@@ -2589,9 +2695,9 @@ class BfBoxExpression : public BfExpression
 public:
 	BF_AST_TYPE(BfBoxExpression, BfExpression);
 
-	BfAstNode* mAllocNode;
-	BfTokenNode* mBoxToken;
-	BfExpression* mExpression;
+	ASTREF(BfAstNode*) mAllocNode;
+	ASTREF(BfTokenNode*) mBoxToken;
+	ASTREF(BfExpression*) mExpression;
 };	BF_AST_DECL(BfBoxExpression, BfExpression);
 
 class BfDeleteStatement : public BfStatement
@@ -2599,11 +2705,11 @@ class BfDeleteStatement : public BfStatement
 public:
 	BF_AST_TYPE(BfDeleteStatement, BfStatement);
 
-	BfTokenNode* mDeleteToken;	
-	BfTokenNode* mTargetTypeToken; // colon token
-	BfAstNode* mAllocExpr;
-	BfAttributeDirective* mAttributes;
-	BfExpression* mExpression;
+	ASTREF(BfTokenNode*) mDeleteToken;	
+	ASTREF(BfTokenNode*) mTargetTypeToken; // colon token
+	ASTREF(BfAstNode*) mAllocExpr;
+	ASTREF(BfAttributeDirective*) mAttributes;
+	ASTREF(BfExpression*) mExpression;
 };	BF_AST_DECL(BfDeleteStatement, BfStatement);
 
 class BfDeferBindNode : public BfAstNode
@@ -2611,8 +2717,8 @@ class BfDeferBindNode : public BfAstNode
 public:
 	BF_AST_TYPE(BfDeferBindNode, BfAstNode);
 	
-	BfTokenNode* mOpenBracket;
-	BfTokenNode* mCloseBracket;
+	ASTREF(BfTokenNode*) mOpenBracket;
+	ASTREF(BfTokenNode*) mCloseBracket;
 	BfSizedArray<ASTREF(BfIdentifierNode*)> mParams;
 	BfSizedArray<ASTREF(BfTokenNode*)> mCommas;	
 };	BF_AST_DECL(BfDeferBindNode, BfAstNode);
@@ -2622,18 +2728,18 @@ class BfDeferStatement : public BfStatement
 public:
 	BF_AST_TYPE(BfDeferStatement, BfStatement);
 
-	BfTokenNode* mDeferToken;
-	BfTokenNode* mColonToken;
-	BfAstNode* mScopeName; // :, mixin, or identifier
+	ASTREF(BfTokenNode*) mDeferToken;
+	ASTREF(BfTokenNode*) mColonToken;
+	ASTREF(BfAstNode*) mScopeName; // :, mixin, or identifier
 
-	BfDeferBindNode* mBind;
+	ASTREF(BfDeferBindNode*) mBind;
 
 	//Legacy compat, remove
-	BfTokenNode* mOpenParen;
-	BfTokenNode* mScopeToken;
-	BfTokenNode* mCloseParen;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfTokenNode*) mScopeToken;
+	ASTREF(BfTokenNode*) mCloseParen;
 
-	BfAstNode* mTargetNode;
+	ASTREF(BfAstNode*) mTargetNode;
 
 // 	virtual bool IsMissingSemicolon() override
 // 	{
@@ -2646,8 +2752,8 @@ class BfThrowStatement : public BfStatement
 public:
 	BF_AST_TYPE(BfThrowStatement, BfStatement);
 
-	BfTokenNode* mThrowToken;
-	BfExpression* mExpression;
+	ASTREF(BfTokenNode*) mThrowToken;
+	ASTREF(BfExpression*) mExpression;
 };	BF_AST_DECL(BfThrowStatement, BfStatement);
 
 class BfScopedInvocationTarget : public BfAstNode
@@ -2655,9 +2761,9 @@ class BfScopedInvocationTarget : public BfAstNode
 public:
 	BF_AST_TYPE(BfScopedInvocationTarget, BfAstNode);
 
-	BfAstNode* mTarget;
-	BfTokenNode* mColonToken;
-	BfAstNode* mScopeName; // :, mixin, or identifier
+	ASTREF(BfAstNode*) mTarget;
+	ASTREF(BfTokenNode*) mColonToken;
+	ASTREF(BfAstNode*) mScopeName; // :, mixin, or identifier
 };	BF_AST_DECL(BfScopedInvocationTarget, BfAstNode);
 
 class BfInvocationExpression : public BfMethodBoundExpression
@@ -2688,10 +2794,10 @@ class BfMemberDeclaration : public BfAstNode
 public:
 	BF_AST_TYPE(BfMemberDeclaration, BfAstNode);
 
-	BfAttributeDirective* mAttributes;	
-	BfTokenNode* mProtectionSpecifier;
-	BfTokenNode* mStaticSpecifier;	
-	BfTokenNode* mReadOnlySpecifier; // Also stores 'inline'
+	ASTREF(BfAttributeDirective*) mAttributes;	
+	ASTREF(BfTokenNode*) mProtectionSpecifier;
+	ASTREF(BfTokenNode*) mStaticSpecifier;	
+	ASTREF(BfTokenNode*) mReadOnlySpecifier; // Also stores 'inline'
 };	BF_AST_DECL(BfMemberDeclaration, BfAstNode);
 
 class BfVariableDeclaration : public BfExpression
@@ -2703,7 +2809,7 @@ public:
 	ASTREF(BfTokenNode*) mModSpecifier;
 	ASTREF(BfTypeReference*) mTypeRef;
 	ASTREF(BfTokenNode*) mPrecedingComma;
-	BfAstNode* mNameNode; // Either BfIdentifierNode or BfTupleExpression
+	ASTREF(BfAstNode*) mNameNode; // Either BfIdentifierNode or BfTupleExpression
 	ASTREF(BfTokenNode*) mEqualsNode;
 	ASTREF(BfExpression*) mInitializer;	
 };	BF_AST_DECL(BfVariableDeclaration, BfExpression);
@@ -2713,14 +2819,14 @@ class BfLocalMethodDeclaration : public BfCompoundStatement
 public:
 	BF_AST_TYPE(BfLocalMethodDeclaration, BfCompoundStatement);
 
-	BfMethodDeclaration* mMethodDeclaration;
+	ASTREF(BfMethodDeclaration*) mMethodDeclaration;
 };	BF_AST_DECL(BfLocalMethodDeclaration, BfCompoundStatement);
 
 class BfParameterDeclaration : public BfVariableDeclaration
 {
 public:
 	BF_AST_TYPE(BfParameterDeclaration, BfVariableDeclaration);
-	BfTokenNode* mModToken; // 'Params'
+	ASTREF(BfTokenNode*) mModToken; // 'Params'
 };	BF_AST_DECL(BfParameterDeclaration, BfVariableDeclaration);
 
 class BfGenericParamsDeclaration : public BfAstNode
@@ -2750,8 +2856,8 @@ class BfTokenPairNode : public BfAstNode
 public:
 	BF_AST_TYPE(BfTokenPairNode, BfAstNode);
 
-	BfTokenNode* mLeft;
-	BfTokenNode* mRight;
+	ASTREF(BfTokenNode*) mLeft;
+	ASTREF(BfTokenNode*) mRight;
 };	BF_AST_DECL(BfTokenPairNode, BfAstNode);
 
 class BfGenericOperatorConstraint : public BfAstNode
@@ -2759,10 +2865,10 @@ class BfGenericOperatorConstraint : public BfAstNode
 public:
 	BF_AST_TYPE(BfGenericOperatorConstraint, BfAstNode);
 		
-	BfTokenNode* mOperatorToken;
-	BfTypeReference* mLeftType;
-	BfTokenNode* mOpToken;
-	BfTypeReference* mRightType;
+	ASTREF(BfTokenNode*) mOperatorToken;
+	ASTREF(BfTypeReference*) mLeftType;
+	ASTREF(BfTokenNode*) mOpToken;
+	ASTREF(BfTypeReference*) mRightType;
 };  BF_AST_DECL(BfGenericOperatorConstraint, BfAstNode);
 
 class BfGenericConstraint : public BfAstNode
@@ -2770,10 +2876,10 @@ class BfGenericConstraint : public BfAstNode
 public:
 	BF_AST_TYPE(BfGenericConstraint, BfAstNode);
 
-	BfTokenNode* mWhereToken;
-	BfTypeReference* mTypeRef;
-	BfTokenNode* mColonToken;
-	BfSizedArray<BfAstNode*> mConstraintTypes;
+	ASTREF(BfTokenNode*) mWhereToken;
+	ASTREF(BfTypeReference*) mTypeRef;
+	ASTREF(BfTokenNode*) mColonToken;
+	BfSizedArray<ASTREF(BfAstNode*)> mConstraintTypes;
 	BfSizedArray<ASTREF(BfTokenNode*)> mCommas;	
 };	BF_AST_DECL(BfGenericConstraint, BfAstNode);
 
@@ -2781,7 +2887,7 @@ class BfGenericConstraintsDeclaration : public BfAstNode
 {
 public:
 	BF_AST_TYPE(BfGenericConstraintsDeclaration, BfAstNode);
-	BfSizedArray<BfGenericConstraint*> mGenericConstraints;
+	BfSizedArray<ASTREF(BfGenericConstraint*)> mGenericConstraints;
 };	BF_AST_DECL(BfGenericConstraintsDeclaration, BfAstNode);
 
 class BfMethodDeclaration : public BfMemberDeclaration
@@ -2789,7 +2895,7 @@ class BfMethodDeclaration : public BfMemberDeclaration
 public:
 	BF_AST_TYPE(BfMethodDeclaration, BfMemberDeclaration);
 	
-	BfCommentNode* mDocumentation;
+	ASTREF(BfCommentNode*) mDocumentation;
 	ASTREF(BfAttributeDirective*) mReturnAttributes;
 	ASTREF(BfTokenNode*) mExternSpecifier;
 	ASTREF(BfTokenNode*) mVirtualSpecifier; // either 'virtual', 'override', or 'abstract'
@@ -2821,9 +2927,9 @@ class BfOperatorDeclaration : public BfMethodDeclaration
 public:
 	BF_AST_TYPE(BfOperatorDeclaration, BfMethodDeclaration);
 	
-	BfTokenNode* mExplicitToken; // Explicit or Implicit
-	BfTokenNode* mOperatorToken;
-	BfTokenNode* mOpTypeToken;
+	ASTREF(BfTokenNode*) mExplicitToken; // Explicit or Implicit
+	ASTREF(BfTokenNode*) mOperatorToken;
+	ASTREF(BfTokenNode*) mOpTypeToken;
 	bool mIsConvOperator;
 	BfUnaryOp mUnaryOp;
 	BfBinaryOp mBinOp;	
@@ -2835,10 +2941,10 @@ class BfConstructorDeclaration : public BfMethodDeclaration
 public:
 	BF_AST_TYPE(BfConstructorDeclaration, BfMethodDeclaration);
 
-	BfTokenNode* mThisToken;
+	ASTREF(BfTokenNode*) mThisToken;
 	
-	BfTokenNode* mInitializerColonToken;
-	BfInvocationExpression* mInitializer;
+	ASTREF(BfTokenNode*) mInitializerColonToken;
+	ASTREF(BfInvocationExpression*) mInitializer;
 	
 };	BF_AST_DECL(BfConstructorDeclaration, BfMethodDeclaration);
 
@@ -2847,8 +2953,8 @@ class BfDestructorDeclaration : public BfMethodDeclaration
 public:	
 	BF_AST_TYPE(BfDestructorDeclaration, BfMethodDeclaration);
 
-	BfTokenNode* mTildeToken;
-	BfTokenNode* mThisToken;
+	ASTREF(BfTokenNode*) mTildeToken;
+	ASTREF(BfTokenNode*) mThisToken;
 };	BF_AST_DECL(BfDestructorDeclaration, BfMethodDeclaration);
 
 class BfFieldDtorDeclaration : public BfAstNode
@@ -2856,10 +2962,10 @@ class BfFieldDtorDeclaration : public BfAstNode
 public:
 	BF_AST_TYPE(BfFieldDtorDeclaration, BfAstNode);
 
-	BfTokenNode* mTildeToken;
+	ASTREF(BfTokenNode*) mTildeToken;
 
-	BfAstNode* mBody;
-	BfFieldDtorDeclaration* mNextFieldDtor;
+	ASTREF(BfAstNode*) mBody;
+	ASTREF(BfFieldDtorDeclaration*) mNextFieldDtor;
 };	BF_AST_DECL(BfFieldDtorDeclaration, BfAstNode);
 
 class BfFieldDeclaration : public BfMemberDeclaration
@@ -2867,17 +2973,17 @@ class BfFieldDeclaration : public BfMemberDeclaration
 public:
 	BF_AST_TYPE(BfFieldDeclaration, BfMemberDeclaration);
 	
-	BfCommentNode* mDocumentation;
-	BfTokenNode* mPrecedingComma;
-	BfTokenNode* mConstSpecifier;	
-	BfTokenNode* mVolatileSpecifier;
-	BfTokenNode* mNewSpecifier;
-	BfTokenNode* mExternSpecifier;
-	BfTypeReference* mTypeRef;
-	BfIdentifierNode* mNameNode;
-	BfTokenNode* mEqualsNode;
-	BfExpression* mInitializer;
-	BfFieldDtorDeclaration* mFieldDtor;
+	ASTREF(BfCommentNode*) mDocumentation;
+	ASTREF(BfTokenNode*) mPrecedingComma;
+	ASTREF(BfTokenNode*) mConstSpecifier;	
+	ASTREF(BfTokenNode*) mVolatileSpecifier;
+	ASTREF(BfTokenNode*) mNewSpecifier;
+	ASTREF(BfTokenNode*) mExternSpecifier;
+	ASTREF(BfTypeReference*) mTypeRef;
+	ASTREF(BfIdentifierNode*) mNameNode;
+	ASTREF(BfTokenNode*) mEqualsNode;
+	ASTREF(BfExpression*) mInitializer;
+	ASTREF(BfFieldDtorDeclaration*) mFieldDtor;
 	
 	BfFieldDef* mFieldDef;
 };	BF_AST_DECL(BfFieldDeclaration, BfMemberDeclaration);
@@ -2893,19 +2999,19 @@ class BfPropertyMethodDeclaration : public BfAstNode
 {
 public:
 	BF_AST_TYPE(BfPropertyMethodDeclaration, BfAstNode);
-	BfPropertyDeclaration* mPropertyDeclaration;
-	BfAttributeDirective* mAttributes;
-	BfTokenNode* mProtectionSpecifier;
-	BfTokenNode* mMutSpecifier;	
-	BfIdentifierNode* mNameNode;
-	BfAstNode* mBody;		
+	ASTREF(BfPropertyDeclaration*) mPropertyDeclaration;
+	ASTREF(BfAttributeDirective*) mAttributes;
+	ASTREF(BfTokenNode*) mProtectionSpecifier;
+	ASTREF(BfTokenNode*) mMutSpecifier;	
+	ASTREF(BfIdentifierNode*) mNameNode;
+	ASTREF(BfAstNode*) mBody;		
 };	BF_AST_DECL(BfPropertyMethodDeclaration, BfAstNode);
 
 class BfPropertyBodyExpression : public BfAstNode
 {
 public:
 	BF_AST_TYPE(BfPropertyBodyExpression, BfAstNode);
-	BfTokenNode* mFatTokenArrow;		
+	ASTREF(BfTokenNode*) mFatTokenArrow;		
 };  BF_AST_DECL(BfPropertyBodyExpression, BfAstNode);
 
 class BfPropertyDeclaration : public BfFieldDeclaration
@@ -2913,12 +3019,12 @@ class BfPropertyDeclaration : public BfFieldDeclaration
 public:
 	BF_AST_TYPE(BfPropertyDeclaration, BfFieldDeclaration);
 
-	BfTokenNode* mVirtualSpecifier; // either 'virtual', 'override', or 'abstract'
-	BfTypeReference* mExplicitInterface;
-	BfTokenNode* mExplicitInterfaceDotToken;	
-	BfAstNode* mDefinitionBlock;
+	ASTREF(BfTokenNode*) mVirtualSpecifier; // either 'virtual', 'override', or 'abstract'
+	ASTREF(BfTypeReference*) mExplicitInterface;
+	ASTREF(BfTokenNode*) mExplicitInterfaceDotToken;	
+	ASTREF(BfAstNode*) mDefinitionBlock;
 
-	BfSizedArray<BfPropertyMethodDeclaration*> mMethods;		
+	BfSizedArray<ASTREF(BfPropertyMethodDeclaration*)> mMethods;		
 
 	BfPropertyMethodDeclaration* GetMethod(const StringImpl& name);
 };	BF_AST_DECL(BfPropertyDeclaration, BfFieldDeclaration);
@@ -2928,11 +3034,11 @@ class BfIndexerDeclaration : public BfPropertyDeclaration
 public:
 	BF_AST_TYPE(BfIndexerDeclaration, BfPropertyDeclaration);
 
-	BfTokenNode* mThisToken;
-	BfTokenNode* mOpenBracket;
+	ASTREF(BfTokenNode*) mThisToken;
+	ASTREF(BfTokenNode*) mOpenBracket;
 	BfSizedArray<ASTREF(BfParameterDeclaration*)> mParams;
 	BfSizedArray<ASTREF(BfTokenNode*)> mCommas;
-	BfTokenNode* mCloseBracket;
+	ASTREF(BfTokenNode*) mCloseBracket;
 };	BF_AST_DECL(BfIndexerDeclaration, BfPropertyDeclaration);
 
 class BfBreakStatement : public BfStatement
@@ -2940,8 +3046,8 @@ class BfBreakStatement : public BfStatement
 public:
 	BF_AST_TYPE(BfBreakStatement, BfStatement);
 
-	BfTokenNode* mBreakNode;
-	BfAstNode* mLabel;
+	ASTREF(BfTokenNode*) mBreakNode;
+	ASTREF(BfAstNode*) mLabel;
 };	BF_AST_DECL(BfBreakStatement, BfStatement);
 
 class BfTryStatement : public BfCompoundStatement
@@ -2949,8 +3055,8 @@ class BfTryStatement : public BfCompoundStatement
 public:
 	BF_AST_TYPE(BfTryStatement, BfCompoundStatement);
 
-	BfTokenNode* mTryToken;
-	BfAstNode* mStatement;
+	ASTREF(BfTokenNode*) mTryToken;
+	ASTREF(BfAstNode*) mStatement;
 };	BF_AST_DECL(BfTryStatement, BfCompoundStatement);
 
 class BfCatchStatement : public BfCompoundStatement
@@ -2958,8 +3064,8 @@ class BfCatchStatement : public BfCompoundStatement
 public:
 	BF_AST_TYPE(BfCatchStatement, BfCompoundStatement);
 
-	BfTokenNode* mCatchToken;
-	BfAstNode* mStatement;
+	ASTREF(BfTokenNode*) mCatchToken;
+	ASTREF(BfAstNode*) mStatement;
 };	BF_AST_DECL(BfCatchStatement, BfCompoundStatement);
 
 class BfFinallyStatement : public BfCompoundStatement
@@ -2967,8 +3073,8 @@ class BfFinallyStatement : public BfCompoundStatement
 public:
 	BF_AST_TYPE(BfFinallyStatement, BfCompoundStatement);
 
-	BfTokenNode* mFinallyToken;
-	BfAstNode* mStatement;
+	ASTREF(BfTokenNode*) mFinallyToken;
+	ASTREF(BfAstNode*) mStatement;
 };	BF_AST_DECL(BfFinallyStatement, BfCompoundStatement);
 
 class BfCheckedStatement : public BfCompoundStatement
@@ -2976,8 +3082,8 @@ class BfCheckedStatement : public BfCompoundStatement
 public:
 	BF_AST_TYPE(BfCheckedStatement, BfCompoundStatement);
 
-	BfTokenNode* mCheckedToken;
-	BfAstNode* mStatement;
+	ASTREF(BfTokenNode*) mCheckedToken;
+	ASTREF(BfAstNode*) mStatement;
 };	BF_AST_DECL(BfCheckedStatement, BfCompoundStatement);
 
 class BfUncheckedStatement : public BfCompoundStatement
@@ -2985,8 +3091,8 @@ class BfUncheckedStatement : public BfCompoundStatement
 public:
 	BF_AST_TYPE(BfUncheckedStatement, BfCompoundStatement);
 
-	BfTokenNode* mUncheckedToken;
-	BfAstNode* mStatement;
+	ASTREF(BfTokenNode*) mUncheckedToken;
+	ASTREF(BfAstNode*) mStatement;
 };	BF_AST_DECL(BfUncheckedStatement, BfCompoundStatement);
 
 class BfContinueStatement : public BfStatement
@@ -2994,8 +3100,8 @@ class BfContinueStatement : public BfStatement
 public:
 	BF_AST_TYPE(BfContinueStatement, BfStatement);
 
-	BfTokenNode* mContinueNode;
-	BfAstNode* mLabel;
+	ASTREF(BfTokenNode*) mContinueNode;
+	ASTREF(BfAstNode*) mLabel;
 };	BF_AST_DECL(BfContinueStatement, BfStatement);
 
 class BfFallthroughStatement : public BfStatement
@@ -3003,7 +3109,7 @@ class BfFallthroughStatement : public BfStatement
 public:
 	BF_AST_TYPE(BfFallthroughStatement, BfStatement);
 
-	BfTokenNode* mFallthroughToken;
+	ASTREF(BfTokenNode*) mFallthroughToken;
 };	BF_AST_DECL(BfFallthroughStatement, BfStatement);
 
 class BfForEachStatement : public BfLabelableStatement
@@ -3011,15 +3117,15 @@ class BfForEachStatement : public BfLabelableStatement
 public:
 	BF_AST_TYPE(BfForEachStatement, BfLabelableStatement);
 
-	BfTokenNode* mForToken;
-	BfTokenNode* mOpenParen;
-	BfTokenNode* mReadOnlyToken;
-	BfTypeReference* mVariableTypeRef;
-	BfAstNode* mVariableName; // Either BfIdentifierNode or BfTupleExpression
-	BfTokenNode* mInToken;
-	BfExpression* mCollectionExpression;
-	BfTokenNode* mCloseParen;
-	BfAstNode* mEmbeddedStatement;
+	ASTREF(BfTokenNode*) mForToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfTokenNode*) mReadOnlyToken;
+	ASTREF(BfTypeReference*) mVariableTypeRef;
+	ASTREF(BfAstNode*) mVariableName; // Either BfIdentifierNode or BfTupleExpression
+	ASTREF(BfTokenNode*) mInToken;
+	ASTREF(BfExpression*) mCollectionExpression;
+	ASTREF(BfTokenNode*) mCloseParen;
+	ASTREF(BfAstNode*) mEmbeddedStatement;
 };	BF_AST_DECL(BfForEachStatement, BfLabelableStatement);
 
 class BfForStatement : public BfLabelableStatement
@@ -3027,17 +3133,17 @@ class BfForStatement : public BfLabelableStatement
 public:
 	BF_AST_TYPE(BfForStatement, BfLabelableStatement);
 
-	BfTokenNode* mForToken;
-	BfTokenNode* mOpenParen;
+	ASTREF(BfTokenNode*) mForToken;
+	ASTREF(BfTokenNode*) mOpenParen;
 	BfSizedArray<ASTREF(BfAstNode*)> mInitializers;
 	BfSizedArray<ASTREF(BfTokenNode*)> mInitializerCommas;
-	BfTokenNode* mInitializerSemicolon;
-	BfExpression* mCondition;
-	BfTokenNode* mConditionSemicolon;
+	ASTREF(BfTokenNode*) mInitializerSemicolon;
+	ASTREF(BfExpression*) mCondition;
+	ASTREF(BfTokenNode*) mConditionSemicolon;
 	BfSizedArray<ASTREF(BfAstNode*)> mIterators;
 	BfSizedArray<ASTREF(BfTokenNode*)> mIteratorCommas;
-	BfTokenNode* mCloseParen;
-	BfAstNode* mEmbeddedStatement;
+	ASTREF(BfTokenNode*) mCloseParen;
+	ASTREF(BfAstNode*) mEmbeddedStatement;
 };	BF_AST_DECL(BfForStatement, BfLabelableStatement);
 
 class BfUsingStatement : public BfCompoundStatement
@@ -3045,11 +3151,11 @@ class BfUsingStatement : public BfCompoundStatement
 public:
 	BF_AST_TYPE(BfUsingStatement, BfCompoundStatement);
 
-	BfTokenNode* mUsingToken;
-	BfTokenNode* mOpenParen;
-	BfVariableDeclaration* mVariableDeclaration;	
-	BfTokenNode* mCloseParen;
-	BfAstNode* mEmbeddedStatement;
+	ASTREF(BfTokenNode*) mUsingToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfVariableDeclaration*) mVariableDeclaration;	
+	ASTREF(BfTokenNode*) mCloseParen;
+	ASTREF(BfAstNode*) mEmbeddedStatement;
 };	BF_AST_DECL(BfUsingStatement, BfCompoundStatement);
 
 class BfDoStatement : public BfLabelableStatement
@@ -3057,8 +3163,8 @@ class BfDoStatement : public BfLabelableStatement
 public:
 	BF_AST_TYPE(BfDoStatement, BfLabelableStatement);
 
-	BfTokenNode* mDoToken;
-	BfAstNode* mEmbeddedStatement;
+	ASTREF(BfTokenNode*) mDoToken;
+	ASTREF(BfAstNode*) mEmbeddedStatement;
 };	BF_AST_DECL(BfDoStatement, BfLabelableStatement);
 
 class BfRepeatStatement : public BfLabelableStatement
@@ -3066,12 +3172,12 @@ class BfRepeatStatement : public BfLabelableStatement
 public:
 	BF_AST_TYPE(BfRepeatStatement, BfLabelableStatement);
 
-	BfTokenNode* mRepeatToken;
-	BfAstNode* mEmbeddedStatement;
-	BfTokenNode* mWhileToken;
-	BfTokenNode* mOpenParen;
-	BfExpression* mCondition;
-	BfTokenNode* mCloseParen;	
+	ASTREF(BfTokenNode*) mRepeatToken;
+	ASTREF(BfAstNode*) mEmbeddedStatement;
+	ASTREF(BfTokenNode*) mWhileToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfExpression*) mCondition;
+	ASTREF(BfTokenNode*) mCloseParen;	
 };	BF_AST_DECL(BfRepeatStatement, BfLabelableStatement);
 
 class BfWhileStatement : public BfLabelableStatement
@@ -3079,11 +3185,11 @@ class BfWhileStatement : public BfLabelableStatement
 public:
 	BF_AST_TYPE(BfWhileStatement, BfLabelableStatement);
 
-	BfTokenNode* mWhileToken;
-	BfTokenNode* mOpenParen;
-	BfExpression* mCondition;
-	BfTokenNode* mCloseParen;
-	BfAstNode* mEmbeddedStatement;
+	ASTREF(BfTokenNode*) mWhileToken;
+	ASTREF(BfTokenNode*) mOpenParen;
+	ASTREF(BfExpression*) mCondition;
+	ASTREF(BfTokenNode*) mCloseParen;
+	ASTREF(BfAstNode*) mEmbeddedStatement;
 };	BF_AST_DECL(BfWhileStatement, BfLabelableStatement);
 
 class BfReturnStatement : public BfStatement
@@ -3091,8 +3197,8 @@ class BfReturnStatement : public BfStatement
 public:
 	BF_AST_TYPE(BfReturnStatement, BfStatement);
 
-	BfTokenNode* mReturnToken;
-	BfExpression* mExpression;
+	ASTREF(BfTokenNode*) mReturnToken;
+	ASTREF(BfExpression*) mExpression;
 };	BF_AST_DECL(BfReturnStatement, BfStatement);
 
 class BfYieldStatement : public BfStatement
@@ -3100,8 +3206,8 @@ class BfYieldStatement : public BfStatement
 public:
 	BF_AST_TYPE(BfYieldStatement, BfStatement);
 
-	BfTokenNode* mReturnOrBreakToken;
-	BfExpression* mExpression;
+	ASTREF(BfTokenNode*) mReturnOrBreakToken;
+	ASTREF(BfExpression*) mExpression;
 };	BF_AST_DECL(BfYieldStatement, BfStatement);
 
 class BfInlineAsmStatement : public BfCompoundStatement
@@ -3109,8 +3215,8 @@ class BfInlineAsmStatement : public BfCompoundStatement
 public:
 	BF_AST_TYPE(BfInlineAsmStatement, BfCompoundStatement);
 
-	BfTokenNode* mOpenBrace;
-	BfTokenNode* mCloseBrace;
+	ASTREF(BfTokenNode*) mOpenBrace;
+	ASTREF(BfTokenNode*) mCloseBrace;
 
 	Array<BfInlineAsmInstruction*> mInstructions;
 	//TODO: Make a block here
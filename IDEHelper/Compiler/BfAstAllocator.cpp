@@ -2,6 +2,10 @@
 #include "BfSource.h"
 #include "BfSystem.h"
 
+#if (defined BF_USE_NEAR_NODE_REF) && (!defined BF_PLATFORM_WINDOWS)
+#include <sys/mman.h>
+#endif
+
 //Craps();
 
 USING_NS_BF;
@@ -50,12 +54,24 @@ BfAstAllocator::BfAstAllocator()
 	mLargeAllocSizes = 0;
 	mNumPagesUsed = 0;	
 	mUsedSize = 0;
+	mNumNodes = 0;
+	mNumAstInfos = 0;
 }
 
 BfAstAllocator::~BfAstAllocator()
 {	
 	for (auto addr : mLargeAllocs)
 		delete [] (uint8*)addr;
+#ifdef BF_USE_NEAR_NODE_REF
+	for (auto& largeRun : mLargeRuns)
+		mSourceData->mAstAllocManager->FreeLargeRun(largeRun.mPtr, largeRun.mSize);
+	// Pages from overflow runs are only reachable through far refs, which mustn't outlive the nodes on them
+	for (auto page : mPages)
+	{
+		if (!BfAstArena::Contains(page))
+			BfAstArena::ReleaseFarRange(page, page + BfAstAllocManager::PAGE_SIZE);
+	}
+#endif
 	if (mPages.size() != 0)
 		mSourceData->mAstAllocManager->FreePages(mPages);
 }
@@ -69,11 +85,263 @@ void BfAstAllocator::InitChunkHead(int wantSize)
 #ifdef BF_AST_ALLOCATOR_USE_PAGES	
 	BfAstPageHeader* pageHeader = (BfAstPageHeader*)mCurPtr;
 	pageHeader->mSourceData = mSourceData;
+	pageHeader->mAlloc = this;
 	BF_ASSERT(sizeof(BfAstPageHeader) <= 16);
 	mCurPtr += 16;		
 #endif
 }
 
+uint8* BfAstAllocator::AllocLarge(int wantSize)
+{
+	mLargeAllocSizes += wantSize;
+#ifdef BF_USE_NEAR_NODE_REF
+	LargeRun largeRun;
+	largeRun.mSize = BF_ALIGN(wantSize, BfAstAllocManager::PAGE_SIZE);
+	largeRun.mPtr = mSourceData->mAstAllocManager->AllocLargeRun(largeRun.mSize);
+	mLargeRuns.push_back(largeRun);
+	memset(largeRun.mPtr, 0, wantSize);
+	return largeRun.mPtr;
+#else
+	uint8* addr = new uint8[wantSize];
+	memset(addr, 0, wantSize);
+	mLargeAllocs.push_back(addr);
+	return addr;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef BF_USE_NEAR_NODE_REF
+uint8* BfAstArena::sBase = NULL;
+int64 BfAstArena::sCommittedSize = 0;
+CritSect BfAstArena::sCritSect;
+Dictionary<int64, int64> BfAstArena::sFreeRunsByStart;
+Dictionary<int64, int64> BfAstArena::sFreeRunsByEnd;
+Dictionary<uint8*, int> BfAstArena::sOverflowRuns;
+void** BfAstArena::sFarBlocks[BfAstArena::MAX_FAR_BLOCKS];
+Dictionary<void*, uint32> BfAstArena::sFarMap;
+Array<uint32> BfAstArena::sFarFreeIndices;
+int BfAstArena::sFarCount = 0;
+
+void BfAstArena::Init()
+{
+	AutoCrit autoCrit(sCritSect);
+	if (sBase != NULL)
+		return;
+
+	// Only address space is reserved here, runs get committed as they're handed out
+#ifdef BF_PLATFORM_WINDOWS
+	sBase = (uint8*)::VirtualAlloc(NULL, (SIZE_T)RESERVE_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+#else
+	void* addr = mmap(NULL, (size_t)RESERVE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	sBase = (addr != MAP_FAILED) ? (uint8*)addr : NULL;
+#endif
+	if (sBase == NULL)
+		BF_FATAL("Failed to reserve AST arena");
+}
+
+uint8* BfAstArena::AllocRun(int size)
+{
+	BF_ASSERT((size & (BfAstAllocManager::PAGE_SIZE - 1)) == 0);
+
+	AutoCrit autoCrit(sCritSect);
+
+	// Best fit from the free runs, splitting off whatever is left over
+	int64 bestStart = -1;
+	int64 bestSize = 0;
+	for (auto& pair : sFreeRunsByStart)
+	{
+		if ((pair.mValue >= size) && ((bestStart == -1) || (pair.mValue < bestSize)))
+		{
+			bestStart = pair.mKey;
+			bestSize = pair.mValue;
+			if (bestSize == size)
+				break;
+		}
+	}
+
+	uint8* run = NULL;
+	if (bestStart != -1)
+	{
+		sFreeRunsByStart.Remove(bestStart);
+		sFreeRunsByEnd.Remove(bestStart + bestSize);
+		if (bestSize > size)
+		{
+			sFreeRunsByStart[bestStart + size] = bestSize - size;
+			sFreeRunsByEnd[bestStart + bestSize] = bestStart + size;
+		}
+		run = sBase + bestStart;
+	}
+	else if (sCommittedSize + size <= RESERVE_SIZE)
+	{
+		run = sBase + sCommittedSize;
+		sCommittedSize += size;
+	}
+	else
+	{
+		// The range is full, so this run lives outside of it and every reference into it goes through the far table
+#ifdef BF_PLATFORM_WINDOWS
+		run = (uint8*)::VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+		void* addr = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		run = (addr != MAP_FAILED) ? (uint8*)addr : NULL;
+#endif
+		if (run == NULL)
+			BF_FATAL("Failed to allocate AST memory");
+		sOverflowRuns[run] = size;
+		return run;
+	}
+
+#ifdef BF_PLATFORM_WINDOWS
+	if (::VirtualAlloc(run, size, MEM_COMMIT, PAGE_READWRITE) == NULL)
+		BF_FATAL("Failed to commit AST arena memory");
+#else
+	if (mprotect(run, size, PROT_READ | PROT_WRITE) != 0)
+		BF_FATAL("Failed to commit AST arena memory");
+#endif
+	return run;
+}
+
+void BfAstArena::FreeRun(uint8* ptr, int size)
+{
+	if (!Contains(ptr))
+	{
+		ReleaseFarRange(ptr, ptr + size);
+
+		AutoCrit autoCrit(sCritSect);
+		sOverflowRuns.Remove(ptr);
+#ifdef BF_PLATFORM_WINDOWS
+		::VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+		munmap(ptr, size);
+#endif
+		return;
+	}
+
+	AutoCrit autoCrit(sCritSect);
+
+#ifdef BF_PLATFORM_WINDOWS
+	::VirtualFree(ptr, size, MEM_DECOMMIT);
+#else
+	madvise(ptr, size, MADV_DONTNEED);
+	mprotect(ptr, size, PROT_NONE);
+#endif
+
+	int64 start = ptr - sBase;
+	int64 end = start + size;
+
+	int64* prevStart = NULL;
+	if (sFreeRunsByEnd.TryGetValue(start, &prevStart))
+	{
+		int64 newStart = *prevStart;
+		sFreeRunsByEnd.Remove(start);
+		sFreeRunsByStart.Remove(newStart);
+		start = newStart;
+	}
+
+	int64* nextSize = NULL;
+	if (sFreeRunsByStart.TryGetValue(end, &nextSize))
+	{
+		int64 newEnd = end + *nextSize;
+		sFreeRunsByStart.Remove(end);
+		sFreeRunsByEnd.Remove(newEnd);
+		end = newEnd;
+	}
+
+	// A run at the top of the committed range just gives the space back
+	if (end == sCommittedSize)
+	{
+		sCommittedSize = start;
+		return;
+	}
+
+	sFreeRunsByStart[start] = end - start;
+	sFreeRunsByEnd[end] = start;
+}
+
+bool BfAstArena::IsOverflowRun(void* ptr)
+{
+	AutoCrit autoCrit(sCritSect);
+	for (auto& pair : sOverflowRuns)
+	{
+		if (((uint8*)ptr >= pair.mKey) && ((uint8*)ptr < pair.mKey + pair.mValue))
+			return true;
+	}
+	return false;
+}
+
+uint32 BfAstArena::EncodeFar(void* ptr)
+{
+	AutoCrit autoCrit(sCritSect);
+
+	uint32* refPtr = NULL;
+	if (!sFarMap.TryAdd(ptr, NULL, &refPtr))
+		return *refPtr;
+
+	int farIdx;
+	if (!sFarFreeIndices.IsEmpty())
+	{
+		farIdx = (int)sFarFreeIndices.back();
+		sFarFreeIndices.pop_back();
+	}
+	else
+	{
+		// Only reachable with two billion live far references, at which point we'd be out of memory anyway
+		if (sFarCount >= (int)FAR_FLAG - 1)
+			BF_FATAL("AST far reference table exhausted");
+		farIdx = sFarCount++;
+	}
+
+	void**& farBlock = sFarBlocks[farIdx / FAR_BLOCK_SIZE];
+	if (farBlock == NULL)
+		farBlock = new void*[FAR_BLOCK_SIZE];
+	farBlock[farIdx % FAR_BLOCK_SIZE] = ptr;
+
+	*refPtr = (uint32)farIdx | FAR_FLAG;
+	return *refPtr;
+}
+
+void BfAstArena::ReleaseFar(void* ptr)
+{
+	AutoCrit autoCrit(sCritSect);
+
+	if (sFarMap.IsEmpty())
+		return;
+	uint32 ref = 0;
+	if (!sFarMap.Remove(ptr, &ref))
+		return;
+	ref &= ~FAR_FLAG;
+	sFarBlocks[ref / FAR_BLOCK_SIZE][ref % FAR_BLOCK_SIZE] = NULL;
+	sFarFreeIndices.Add(ref);
+}
+
+void BfAstArena::ReleaseFarRange(uint8* start, uint8* end)
+{
+	AutoCrit autoCrit(sCritSect);
+
+	Array<void*> releasePtrs;
+	for (auto& pair : sFarMap)
+	{
+		if (((uint8*)pair.mKey >= start) && ((uint8*)pair.mKey < end))
+			releasePtrs.Add(pair.mKey);
+	}
+	for (auto ptr : releasePtrs)
+	{
+		uint32 ref = 0;
+		sFarMap.Remove(ptr, &ref);
+		ref &= ~FAR_FLAG;
+		sFarBlocks[ref / FAR_BLOCK_SIZE][ref % FAR_BLOCK_SIZE] = NULL;
+		sFarFreeIndices.Add(ref);
+	}
+}
+
+int BfAstArena::GetFarRefCount()
+{
+	AutoCrit autoCrit(sCritSect);
+	return (int)sFarMap.size();
+}
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 
 BfAstAllocManager::BfAstAllocManager()
@@ -81,6 +349,9 @@ BfAstAllocManager::BfAstAllocManager()
 #ifdef BF_AST_ALLOCATOR_USE_PAGES
 	mFreePageCount = 0;
 #endif
+#ifdef BF_USE_NEAR_NODE_REF
+	BfAstArena::Init();
+#endif
 }
 
 BfAstAllocManager::~BfAstAllocManager()
@@ -89,7 +360,11 @@ BfAstAllocManager::~BfAstAllocManager()
 	for (int chunkIdx = (int)mAllocChunks.size() - 1; chunkIdx >= 0; chunkIdx--)
 	{
 		auto chunk = mAllocChunks[chunkIdx];
+#ifdef BF_USE_NEAR_NODE_REF
+		BfAstArena::FreeRun(chunk, CHUNK_SIZE);
+#else
 		::VirtualFree(chunk, 0, MEM_RELEASE);
+#endif
 		//BfLog("BfAstAllocManager free %p\n", chunk);
 	}
 #endif
@@ -113,7 +388,11 @@ uint8* BfAstAllocManager::AllocPage()
 	//auto newChunk = (uint8*)::VirtualAlloc((void*)(0x4200000000 + gAstChunkAllocCount*CHUNK_SIZE), CHUNK_SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
 	//gAstChunkAllocCount++;
 
+#ifdef BF_USE_NEAR_NODE_REF
+	auto newChunk = BfAstArena::AllocRun(CHUNK_SIZE);
+#else
 	auto newChunk = (uint8*)::VirtualAlloc(NULL, CHUNK_SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#endif
 	BF_ASSERT(newChunk != NULL);
 	BF_ASSERT(((intptr)newChunk & (PAGE_SIZE - 1)) == 0);	
 	mAllocChunks.push_back(newChunk);	
@@ -164,6 +443,18 @@ void BfAstAllocManager::FreePages(Array<uint8*> pages)
 #endif
 }
 
+#ifdef BF_USE_NEAR_NODE_REF
+uint8* BfAstAllocManager::AllocLargeRun(int size)
+{
+	return BfAstArena::AllocRun(size);
+}
+
+void BfAstAllocManager::FreeLargeRun(uint8* ptr, int size)
+{
+	BfAstArena::FreeRun(ptr, size);
+}
+#endif
+
 void BfAstAllocManager::GetStats(int& allocPages, int& usedPages)
 {
 #ifdef BF_AST_ALLOCATOR_USE_PAGES
@@ -1,13 +1,19 @@
 #pragma once
 
-//#define BF_USE_NEAR_NODE_REF
-
 #include "BeefySysLib/Common.h"
 #include "BeefySysLib/util/CritSect.h"
 #include "BeefySysLib/util/SLIList.h"
+#include "BeefySysLib/util/Dictionary.h"
 #include "../Beef/BfCommon.h"
 
-#ifdef BF_PLATFORM_WINDOWS
+// Node references are stored as 32-bit offsets into the AST arena rather than as full pointers. Together with packed
+//  source positions this roughly halves AST memory, at some cost in reduce throughput. Define BF_AST_NO_COMPACT_REFS
+//  (or turn off the AST_COMPACT cmake option) to go back to full pointers.
+#if (defined BF64) && (!defined BF_AST_NO_COMPACT_REFS)
+#define BF_USE_NEAR_NODE_REF
+#endif
+
+#if (defined BF_PLATFORM_WINDOWS) || (defined BF_USE_NEAR_NODE_REF)
 #define BF_AST_ALLOCATOR_USE_PAGES
 #endif
 
@@ -46,16 +52,78 @@ public:
 };
 
 #ifdef BF_AST_ALLOCATOR_USE_PAGES
+class BfAstAllocator;
+
 class BfAstPageHeader
 {
 public:
 	BfSourceData* mSourceData;	
+	BfAstAllocator* mAlloc; // Allocator that owns the page, used for BfAstInfo spills
 };
 #endif
 
 class BfAstAllocChunk;
 class BfAstAllocManager;
 
+#ifdef BF_USE_NEAR_NODE_REF
+// Every AST page in the process comes out of one reserved address range, so a reference to a node can be encoded
+//  as its offset from the base of that range in 4-byte units. Pointers from outside of the range (stack or heap
+//  temporaries, or overflow runs once the range is full) get the high bit set and index into a table of far pointers
+//  instead. Far entries are released when the node they point to is destroyed or its run is freed.
+class BfAstArena
+{
+public:
+	static const int64 RESERVE_SIZE = 0x100000000LL;
+	static const uint32 FAR_FLAG = 0x80000000;
+	static const int FAR_BLOCK_SIZE = 0x10000;
+	static const int MAX_FAR_BLOCKS = (int)(FAR_FLAG / FAR_BLOCK_SIZE);
+
+	static uint8* sBase;
+	static int64 sCommittedSize;
+	static CritSect sCritSect;
+	static Dictionary<int64, int64> sFreeRunsByStart; // Offset -> size, adjacent runs are coalesced
+	static Dictionary<int64, int64> sFreeRunsByEnd; // End offset -> offset
+	static Dictionary<uint8*, int> sOverflowRuns; // Runs allocated outside the range after it filled up
+	static void** sFarBlocks[MAX_FAR_BLOCKS];
+	static Dictionary<void*, uint32> sFarMap;
+	static Array<uint32> sFarFreeIndices;
+	static int sFarCount;
+
+public:
+	static void Init();
+	static uint8* AllocRun(int size);
+	static void FreeRun(uint8* ptr, int size);
+	static bool IsOverflowRun(void* ptr);
+	static uint32 EncodeFar(void* ptr);
+	static void ReleaseFar(void* ptr);
+	static void ReleaseFarRange(uint8* start, uint8* end);
+	static int GetFarRefCount();
+
+	static bool Contains(void* ptr)
+	{
+		return (uintptr)((uint8*)ptr - sBase) < (uintptr)RESERVE_SIZE;
+	}
+
+	static uint32 Encode(void* ptr)
+	{
+		if (ptr == NULL)
+			return 0;
+		uintptr ofs = (uintptr)((uint8*)ptr - sBase);
+		if ((ofs < (uintptr)RESERVE_SIZE) && ((ofs & 3) == 0))
+			return (uint32)(ofs >> 2);
+		return EncodeFar(ptr);
+	}
+
+	static void* Decode(uint32 ref)
+	{
+		if ((ref & FAR_FLAG) == 0)
+			return (ref == 0) ? NULL : sBase + ((uintptr)ref << 2);
+		ref &= ~FAR_FLAG;
+		return sFarBlocks[ref / FAR_BLOCK_SIZE][ref % FAR_BLOCK_SIZE];
+	}
+};
+#endif
+
 
 struct BfAstFreePage
 {
@@ -82,6 +150,10 @@ public:
 	uint8* AllocPage();
 	void FreePage(uint8* page);
 	void FreePages(Array<uint8*> pages);
+#ifdef BF_USE_NEAR_NODE_REF
+	uint8* AllocLargeRun(int size);
+	void FreeLargeRun(uint8* ptr, int size);
+#endif
 	void GetStats(int& allocPages, int& usedPages);
 };
 
@@ -101,16 +173,26 @@ public:
 
 class BfAstAllocator
 {
+public:
+	struct LargeRun
+	{
+		uint8* mPtr;
+		int mSize;
+	};
+
 public:
 	static const int LARGE_ALLOC_SIZE = 2048;
 	BfSourceData* mSourceData;		
 	uint8* mCurPtr;	
 	uint8* mCurPageEnd;	
 	Array<void*> mLargeAllocs;
+	Array<LargeRun> mLargeRuns; // Large allocs taken from the AST arena so near refs can point into them
 	Array<uint8*> mPages;
 	int mLargeAllocSizes;
 	int mNumPagesUsed;
 	int mUsedSize;
+	int mNumNodes;
+	int mNumAstInfos; // Nodes whose source positions didn't fit in the packed encoding
 #ifdef BUMPALLOC_TRACKALLOCS
 	Dictionary<String, BumpAllocTrackedEntry> mTrackedAllocs;
 #endif
@@ -120,6 +202,7 @@ public:
 	~BfAstAllocator();	
 	
 	void InitChunkHead(int wantSize);
+	uint8* AllocLarge(int wantSize);
 
 	int GetAllocSize() const
 	{
@@ -156,6 +239,7 @@ public:
 		memset(mCurPtr, 0, wantSize);
 		T* retVal = new (mCurPtr) T();		
 		mCurPtr += wantSize;		
+		mNumNodes++;
 
 #ifndef BF_AST_ALLOCATOR_USE_PAGES
 		retVal->mSourceData = this->mSourceData;
@@ -173,15 +257,8 @@ public:
 		allocSizePtr->mSize += wantSize;
 #endif
 
-#ifndef BF_USE_NEAR_NODE_REF
 		if (wantSize >= LARGE_ALLOC_SIZE)
-		{
-			mLargeAllocSizes += wantSize;
-			uint8* addr = new uint8[wantSize];
-			mLargeAllocs.push_back(addr);
-			return addr;
-		}
-#endif
+			return AllocLarge(wantSize);
 
 		mCurPtr = (uint8*)(((intptr)mCurPtr + alignSize - 1) & ~(alignSize - 1));
 		if (mCurPtr + wantSize >= mCurPageEnd)
@@ -202,11 +279,7 @@ public:
 #endif
 
 		if (wantSize >= LARGE_ALLOC_SIZE)
-		{
-			uint8* addr = new uint8[wantSize];
-			mLargeAllocs.push_back(addr);
-			return addr;
-		}
+			return AllocLarge(wantSize);
 
 		if (mCurPtr + wantSize >= mCurPageEnd)
 			InitChunkHead(wantSize);
@@ -2514,8 +2514,8 @@ int BfAutoComplete::FixitGetMemberInsertPos(BfTypeDef* typeDef)
 	BfParserData* parser = typeDef->mTypeDeclaration->GetSourceData()->ToParserData();
 	if ((parser != NULL) && (closeNode != NULL))
 	{
-		int startPos = openNode->mSrcStart + 1;
-		insertPos = closeNode->mSrcStart;
+		int startPos = openNode->GetSrcStart() + 1;
+		insertPos = closeNode->GetSrcStart();
 		while (insertPos > startPos)
 		{
 			char prevC = parser->mSrc[insertPos - 1];
@@ -2790,7 +2790,7 @@ void BfAutoComplete::FixitAddCase(BfTypeInstance* typeInst, const StringImpl& ca
 				auto lastNode = block->mChildArr.back();				
 				if (auto tokenNode = BfNodeDynCast<BfTokenNode>(lastNode))
 				{
-					if (tokenNode->mToken == BfToken_Comma)
+					if (tokenNode->GetToken() == BfToken_Comma)
 					{
 						isSimpleCase = true;
 						endsInComma = true;
@@ -915,6 +915,13 @@ void BfCodeGen::WriteBuildCache(const StringImpl& buildDir)
 	dirCache->Write();
 }
 
+bool BfCodeGen::ThinLink(const Array<String>& inputFileNames, const StringImpl& outputDir, const StringImpl& cacheDir, const BfCodeGenOptions& options, bool isDynLib,
+	Array<String>& outputFileNames, StringImpl& error)
+{
+	// The codegen threads are shut down by Finish, so the ThinLTO backends get the same thread budget
+	return BfIRCodeGen::ThinLink(inputFileNames, outputDir, cacheDir, options, isDynLib, mMaxThreadCount, outputFileNames, error);
+}
+
 void BfCodeGen::RequestComplete(BfCodeGenRequest* request)
 {
 	mCompletionCount++;
@@ -217,6 +217,8 @@ public:
 	String GetBuildValue(const StringImpl& buildDir, const StringImpl& key);
 	void SetBuildValue(const StringImpl& buildDir, const StringImpl& key, const StringImpl& value);
 	void WriteBuildCache(const StringImpl& buildDir);
+	bool ThinLink(const Array<String>& inputFileNames, const StringImpl& outputDir, const StringImpl& cacheDir, const BfCodeGenOptions& options, bool isDynLib,
+		Array<String>& outputFileNames, StringImpl& error);
 	void Cancel();
 	bool Finish();
 };
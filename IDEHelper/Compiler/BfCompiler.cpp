@@ -27,6 +27,7 @@
 #include "BfAutoComplete.h"
 #include "BfResolvePass.h"
 #include "BeefySysLib/util/BeefPerf.h"
+#include "BeefySysLib/util/ThreadPool.h"
 #include "../LLVMUtils.h"
 
 #pragma warning(pop)
@@ -356,6 +357,7 @@ BfCompiler::BfCompiler(BfSystem* bfSystem, bool isResolveOnly)
 	//mMaxInterfaceSlots = 16;
 	mMaxInterfaceSlots = -1;
 	mInterfaceSlotCountChanged = false;
+	memset(&mSlotNumStats, 0, sizeof(mSlotNumStats));
 
 	mHSPreserveIdx = 0;
 	mCompileLogFP = NULL;
@@ -596,17 +598,29 @@ void BfCompiler::HashModuleVData(BfModule* module, HashContext& vdataHash)
 {
 	BP_ZONE("BfCompiler::HashModuleVData");
 
-	if (module->mStringPoolRefs.size() > 0)
+	// The ref arrays only get appended to until the next rebuild or ClearConstData, so unchanged counts mean unchanged contents
+	if ((module->mVDataHashRebuildIdx != module->mRebuildIdx) || (module->mVDataHashStringRefCount != (int)module->mStringPoolRefs.size()) ||
+		(module->mVDataHashImportCount != (int)module->mImportFileNames.size()))
 	{
-		module->mStringPoolRefs.Sort([](int lhs, int rhs) { return lhs < rhs; });
-		vdataHash.Mixin(&module->mStringPoolRefs[0], (int)module->mStringPoolRefs.size() * (int)sizeof(int));
-	}
-	
-	if (module->mImportFileNames.size() > 0)
-	{
-		module->mImportFileNames.Sort([](int lhs, int rhs) { return lhs < rhs; });
-		vdataHash.Mixin(&module->mImportFileNames[0], (int)module->mImportFileNames.size() * (int)sizeof(int));
+		HashContext moduleHashCtx;
+		if (module->mStringPoolRefs.size() > 0)
+		{
+			module->mStringPoolRefs.Sort([](int lhs, int rhs) { return lhs < rhs; });
+			moduleHashCtx.Mixin(&module->mStringPoolRefs[0], (int)module->mStringPoolRefs.size() * (int)sizeof(int));
+		}
+
+		if (module->mImportFileNames.size() > 0)
+		{
+			module->mImportFileNames.Sort([](int lhs, int rhs) { return lhs < rhs; });
+			moduleHashCtx.Mixin(&module->mImportFileNames[0], (int)module->mImportFileNames.size() * (int)sizeof(int));
+		}
+
+		module->mVDataHash = moduleHashCtx.Finish128();
+		module->mVDataHashRebuildIdx = module->mRebuildIdx;
+		module->mVDataHashStringRefCount = (int)module->mStringPoolRefs.size();
+		module->mVDataHashImportCount = (int)module->mImportFileNames.size();
 	}
+	vdataHash.Mixin(module->mVDataHash);
 	
 	auto altModule = module->mNextAltModule;
 	while (altModule != NULL)
@@ -621,6 +635,54 @@ void BfCompiler::HashModuleVData(BfModule* module, HashContext& vdataHash)
 	}
 }
 
+// Everything about a single type that ends up in vdata. Only reads from the type, so these can be computed in parallel.
+Val128 BfCompiler::HashTypeVData(BfType* type)
+{
+	HashContext vdataHashCtx;
+	vdataHashCtx.Mixin(type->mTypeId);
+
+	auto typeInst = type->ToTypeInstance();
+	if (typeInst == NULL)
+		return vdataHashCtx.Finish128();
+	auto module = typeInst->mModule;
+	if (module == NULL)
+		return vdataHashCtx.Finish128();
+
+	if (type->IsInterface())
+		vdataHashCtx.Mixin(typeInst->mSlotNum);
+
+	vdataHashCtx.MixinStr(module->mModuleName);
+	vdataHashCtx.Mixin(typeInst->mTypeDef->mSignatureHash);
+	vdataHashCtx.Mixin(module->mHasForceLinkMarker);
+
+	for (auto iface : typeInst->mInterfaces)
+	{
+		vdataHashCtx.Mixin(iface.mInterfaceType->mTypeId);
+		vdataHashCtx.Mixin(iface.mDeclaringType->mTypeCode);
+		vdataHashCtx.Mixin(iface.mDeclaringType->mProject);
+	}
+
+	if (!typeInst->IsUnspecializedType())
+	{
+		for (auto& methodInstGroup : typeInst->mMethodInstanceGroups)
+		{
+			bool isImplementedAndReified = (methodInstGroup.IsImplemented()) && (methodInstGroup.mDefault != NULL) &&
+				(methodInstGroup.mDefault->mIsReified) && (!methodInstGroup.mDefault->mIsUnspecialized);
+			vdataHashCtx.Mixin(isImplementedAndReified);
+		}
+	}
+
+	// Could be necessary if a base type in another project adds new virtual methods (for example)
+	auto baseType = typeInst->mBaseType;
+	while (baseType != NULL)
+	{
+		vdataHashCtx.Mixin(baseType->mTypeDef->mSignatureHash);
+		baseType = baseType->mBaseType;
+	}
+
+	return vdataHashCtx.Finish128();
+}
+
 BfIRFunction BfCompiler::CreateLoadSharedLibraries(BfVDataModule* bfModule, Array<BfMethodInstance*>& dllMethods)
 {
 	BfIRType nullPtrType = bfModule->mBfIRBuilder->MapType(bfModule->GetPrimitiveType(BfTypeCode_NullPtr));
@@ -1091,6 +1153,8 @@ void BfCompiler::CreateVData(BfVDataModule* bfModule)
 	std::multimap<String, BfTypeInstance*> sortedStaticMarkMap;
 	std::multimap<String, BfTypeInstance*> sortedStaticTLSMap;
 	HashSet<BfModule*> usedModuleSet;
+	Array<BfModule*> hashModuleList; // In first-use order
+	Array<int> typeHashModuleIdx; // Per vdataTypeList entry, the hashModuleList entry it introduced or -1
 
 	vdataHashCtx.MixinStr(project->mStartupObject);
 	vdataHashCtx.Mixin(project->mTargetType);
@@ -1114,8 +1178,7 @@ void BfCompiler::CreateVData(BfVDataModule* bfModule)
 			continue;
 
 		vdataTypeList.push_back(type);
-
-		vdataHashCtx.Mixin(type->mTypeId);		
+		typeHashModuleIdx.push_back(-1);
 
 		BF_ASSERT((type != NULL) || (mPassInstance->HasFailed()));
 		if ((type != NULL) && (typeInst != NULL))
@@ -1123,9 +1186,6 @@ void BfCompiler::CreateVData(BfVDataModule* bfModule)
 			auto module = typeInst->mModule;
 			if (module == NULL)
 				continue;			
-			
-			if (type->IsInterface())
-				vdataHashCtx.Mixin(typeInst->mSlotNum);
 
 			if (!module->mIsScratchModule)
 			{
@@ -1134,39 +1194,10 @@ void BfCompiler::CreateVData(BfVDataModule* bfModule)
 				{
 					CompileLog("UsedModule %p %s\n", module, module->mModuleName.c_str());
 					
-					HashModuleVData(module, vdataHashCtx);
+					typeHashModuleIdx.back() = (int)hashModuleList.size();
+					hashModuleList.Add(module);
 				}
 			}
-			
-			vdataHashCtx.MixinStr(module->mModuleName);
-			vdataHashCtx.Mixin(typeInst->mTypeDef->mSignatureHash);
-			vdataHashCtx.Mixin(module->mHasForceLinkMarker);
-			
-			for (auto iface : typeInst->mInterfaces)
-			{
-				vdataHashCtx.Mixin(iface.mInterfaceType->mTypeId);
-				vdataHashCtx.Mixin(iface.mDeclaringType->mTypeCode);
-				vdataHashCtx.Mixin(iface.mDeclaringType->mProject);
-			}
-						
-			if (!typeInst->IsUnspecializedType())
-			{
-				for (auto& methodInstGroup : typeInst->mMethodInstanceGroups)
-				{
-					bool isImplementedAndReified = (methodInstGroup.IsImplemented()) && (methodInstGroup.mDefault != NULL) &&
-						(methodInstGroup.mDefault->mIsReified) && (!methodInstGroup.mDefault->mIsUnspecialized);
-					vdataHashCtx.Mixin(isImplementedAndReified);
-				}
-			}
-
-			// Could be necessary if a base type in another project adds new virtual methods (for example)
-
-			auto baseType = typeInst->mBaseType;
-			while (baseType != NULL)
-			{
-				vdataHashCtx.Mixin(baseType->mTypeDef->mSignatureHash);				
-				baseType = baseType->mBaseType;
-			}
 
 			if (module->mProject != bfModule->mProject)
 			{
@@ -1186,6 +1217,50 @@ void BfCompiler::CreateVData(BfVDataModule* bfModule)
 		}
 	}
 
+	// The per-type and per-module fragments only read type data (modules just sort and cache their own ref lists), so
+	//  we hash them in parallel and then combine them in type order. Type fragments don't depend on the project, so ones
+	//  already hashed for another vdata module during this pass are reused.
+	Array<BfType*> hashTypeList;
+	for (auto type : vdataTypeList)
+	{
+		if (!mTypeVDataHashes.ContainsKey(type))
+			hashTypeList.Add(type);
+	}
+	Array<Val128> typeVDataHashes;
+	typeVDataHashes.Resize(hashTypeList.size());
+	Array<Val128> moduleVDataHashes;
+	moduleVDataHashes.Resize(hashModuleList.size());
+	{
+		BP_ZONE("BfCompiler::CreateVData hash fragments");
+
+		int typeCount = (int)hashTypeList.size();
+		ThreadPool::ParallelFor(typeCount + (int)hashModuleList.size(), 2048, [&](int startIdx, int endIdx)
+			{
+				for (int idx = startIdx; idx < endIdx; idx++)
+				{
+					if (idx < typeCount)
+					{
+						typeVDataHashes[idx] = HashTypeVData(hashTypeList[idx]);
+						continue;
+					}
+					HashContext moduleHashCtx;
+					HashModuleVData(hashModuleList[idx - typeCount], moduleHashCtx);
+					moduleVDataHashes[idx - typeCount] = moduleHashCtx.Finish128();
+				}
+			});
+
+		for (int typeIdx = 0; typeIdx < typeCount; typeIdx++)
+			mTypeVDataHashes[hashTypeList[typeIdx]] = typeVDataHashes[typeIdx];
+	}
+
+	for (int typeIdx = 0; typeIdx < (int)vdataTypeList.size(); typeIdx++)
+	{
+		int moduleIdx = typeHashModuleIdx[typeIdx];
+		if (moduleIdx != -1)
+			vdataHashCtx.Mixin(moduleVDataHashes[moduleIdx]);
+		vdataHashCtx.Mixin(mTypeVDataHashes[vdataTypeList[typeIdx]]);
+	}
+
 	int lastModuleRevision = bfModule->mRevision;
 	Val128 vdataHash = vdataHashCtx.Finish128();
 	bool wantsRebuild = vdataHash != bfModule->mDataHash;	
@@ -1241,6 +1316,9 @@ void BfCompiler::CreateVData(BfVDataModule* bfModule)
 		CompileLog("VData unchanged, skipping\n");
 		return;
 	}
+
+	// Emitting type data can create method instances, so vdata modules after this one need fresh type fragments
+	mTypeVDataHashes.Clear();
 	
 	BfTypeInstance* stringType = bfModule->ResolveTypeDef(mStringTypeDef, BfPopulateType_Data)->ToTypeInstance();
 	BfTypeInstance* reflectSpecializedTypeInstance = bfModule->ResolveTypeDef(mReflectSpecializedGenericType)->ToTypeInstance();
@@ -2357,35 +2435,6 @@ bool BfCompiler::VerifySlotNums()
 	return true;
 }
 
-bool BfCompiler::QuickGenerateSlotNums()
-{	
-	/*SmallVector<bool, 16> isSlotUsed;	
-	for (auto globalTypeEntry : mResolvedTypes)
-	{
-		BfType* type = globalTypeEntry->mType;
-
-		auto typeInst = type->ToTypeInstance();
-		if (typeInst == NULL)
-			continue;
-
-		if (typeInst->IsInterface())
-		{
-			if ((typeInst->mVirtualMethodTableSize > 0) && (typeInst->mSlotNum == -1))
-			{
-				// Slot not assigned yet
-				return false;
-			}
-
-			continue;
-		}		
-	}
-
-	return VerifySlotNums();*/
-
-	// Implement later
-	return false;
-}
-
 class BfSlotEntry
 {
 public:
@@ -2428,23 +2477,14 @@ struct InterfacePairHash
 	}
 };
 
-bool BfCompiler::SlowGenerateSlotNums()
+// Collects every needed interface that has a vtable, how many types use it, and which other interfaces it's
+//  implemented alongside. Interfaces implemented by the same type can't share a slot.
+static void BuildSlotEntries(BfContext* context, SlotEntryMap& ifaceUseMap, bool resetSlots, bool isHotCompile)
 {
-	BP_ZONE("BfCompiler::SlowGenerateSlotNums");	
-	
-	SlotEntryMap ifaceUseMap;
-	
 	std::unordered_set<InterfacePair, InterfacePairHash> concurrentInterfaceSet;
 	HashSet<BfTypeInstance*> foundIFaces;
-	
-	if (mMaxInterfaceSlots < 0)
-	{
-		mMaxInterfaceSlots = 0;
-	}
-
-	bool isHotCompile = IsHotCompile();
 
-	for (auto type : mContext->mResolvedTypes)
+	for (auto type : context->mResolvedTypes)
 	{		
 		if (!type->IsReified())
 			continue;
@@ -2460,7 +2500,7 @@ bool BfCompiler::SlowGenerateSlotNums()
 		{
 			if (typeInst->mSlotNum == -2) // Not needed
 				continue;
-			if (!isHotCompile) // Hot compiles cannot remap slot numbers
+			if (resetSlots)
 				typeInst->mSlotNum = -1;
 			if (typeInst->mVirtualMethodTableSize > 0)
 			{
@@ -2512,7 +2552,126 @@ bool BfCompiler::SlowGenerateSlotNums()
 				}					
 			}
 		}							
-	}	
+	}
+}
+
+static void SortSlotEntries(Array<BfSlotEntry*>& slotEntries)
+{
+	std::sort(slotEntries.begin(), slotEntries.end(), [] (BfSlotEntry* lhs, BfSlotEntry* rhs) 
+	{ 
+		if (lhs->mRefCount != rhs->mRefCount)
+			return lhs->mRefCount > rhs->mRefCount; 
+		return lhs->mTypeInstance->mTypeId < rhs->mTypeInstance->mTypeId;
+	});
+}
+
+// Keeps every existing slot assignment that is still valid and only colors the interfaces that are unslotted or
+//  collide with a neighbor, so most vtables (and the objects built from them) stay the same between compiles.
+bool BfCompiler::QuickGenerateSlotNums()
+{
+	BP_ZONE("BfCompiler::QuickGenerateSlotNums");
+
+	// Hot compiles never remap slots, so SlowGenerateSlotNums already only assigns the new ones
+	if ((mMaxInterfaceSlots < 0) || (IsHotCompile()))
+		return false;
+
+	SlotEntryMap ifaceUseMap;
+	BuildSlotEntries(mContext, ifaceUseMap, false, false);
+
+	Array<BfSlotEntry*> sortedIfaceUseMap;
+	for (auto& entry : ifaceUseMap)
+		sortedIfaceUseMap.push_back(entry.mValue);
+	SortSlotEntries(sortedIfaceUseMap);
+
+	// Walk in priority order, keeping a slot unless a higher priority neighbor already kept the same one
+	HashSet<BfTypeInstance*> keptIFaces;
+	Array<BfSlotEntry*> reslotEntries;
+	for (auto slotEntry : sortedIfaceUseMap)
+	{
+		BfTypeInstance* iface = slotEntry->mTypeInstance;
+		bool keep = (iface->mSlotNum >= 0) && (iface->mSlotNum < mMaxInterfaceSlots);
+		if (keep)
+		{
+			for (auto iface2 : slotEntry->mConcurrentRefs)
+			{
+				if ((iface2->mSlotNum == iface->mSlotNum) && (keptIFaces.Contains(iface2)))
+				{
+					keep = false;
+					break;
+				}
+			}
+		}
+
+		if (keep)
+			keptIFaces.Add(iface);
+		else
+			reslotEntries.push_back(slotEntry);
+	}
+
+	for (auto slotEntry : reslotEntries)
+		slotEntry->mTypeInstance->mSlotNum = -1;
+
+	SmallVector<bool, 16> isSlotUsed;
+	for (auto slotEntry : reslotEntries)
+	{
+		BfTypeInstance* iface = slotEntry->mTypeInstance;
+
+		isSlotUsed.clear();
+		if (mMaxInterfaceSlots > 0)
+			isSlotUsed.resize(mMaxInterfaceSlots);
+
+		for (auto iface2 : slotEntry->mConcurrentRefs)
+		{
+			int slotNum2 = iface2->mSlotNum;
+			if (slotNum2 >= 0)
+				isSlotUsed[slotNum2] = true;
+		}
+
+		for (int checkSlot = 0; checkSlot < mMaxInterfaceSlots; checkSlot++)
+		{
+			if (!isSlotUsed[checkSlot])
+			{
+				iface->mSlotNum = checkSlot;
+				break;
+			}
+		}
+
+		if (iface->mSlotNum == -1)
+		{
+			iface->mSlotNum = mMaxInterfaceSlots;
+			if (mOptions.mIncrementalBuild)
+			{
+				// Allocate more than enough interface slots
+				mMaxInterfaceSlots += 3;
+			}
+			else
+				mMaxInterfaceSlots++;
+		}
+	}
+
+	mStats.mSlotNumsReassigned = (int)reslotEntries.size();
+	
+	for (auto& entry : ifaceUseMap)
+		delete entry.mValue;
+
+	return VerifySlotNums();
+}
+
+bool BfCompiler::SlowGenerateSlotNums()
+{
+	BP_ZONE("BfCompiler::SlowGenerateSlotNums");	
+	
+	SlotEntryMap ifaceUseMap;
+	
+	if (mMaxInterfaceSlots < 0)
+	{
+		mMaxInterfaceSlots = 0;
+	}
+
+	bool isHotCompile = IsHotCompile();
+
+	// Hot compiles cannot remap slot numbers
+	BuildSlotEntries(mContext, ifaceUseMap, !isHotCompile, isHotCompile);
 	
 	Array<BfSlotEntry*> sortedIfaceUseMap;	
 	for (auto& entry : ifaceUseMap)
@@ -2522,12 +2681,7 @@ bool BfCompiler::SlowGenerateSlotNums()
 		sortedIfaceUseMap.push_back(entry.mValue);
 	}	
 			
-	std::sort(sortedIfaceUseMap.begin(), sortedIfaceUseMap.end(), [] (BfSlotEntry* lhs, BfSlotEntry* rhs) 
-	{ 
-		if (lhs->mRefCount != rhs->mRefCount)
-			return lhs->mRefCount > rhs->mRefCount; 
-		return lhs->mTypeInstance->mTypeId < rhs->mTypeInstance->mTypeId;
-	});
+	SortSlotEntries(sortedIfaceUseMap);
 
 	bool failed = false;
 
@@ -2650,12 +2804,24 @@ void BfCompiler::GenerateSlotNums()
 	}
 
 	if (VerifySlotNums())	
+	{
+		mSlotNumStats.mVerifyOnlyCount++;
 		return;	
+	}
 	
-	if (!QuickGenerateSlotNums())
-		SlowGenerateSlotNums();		
+	if (QuickGenerateSlotNums())
+	{
+		mSlotNumStats.mQuickCount++;
+	}
+	else
+	{
+		SlowGenerateSlotNums();
+		mSlotNumStats.mSlowCount++;
+		mStats.mSlotNumsReassigned = -1;
+	}
 
-	BfLogSysM("GenerateSlotNums mMaxInterfaceSlots: %d\n", mMaxInterfaceSlots);
+	BfLogSysM("GenerateSlotNums mMaxInterfaceSlots: %d Reassigned: %d VerifyOnly: %d Quick: %d Slow: %d\n", mMaxInterfaceSlots, mStats.mSlotNumsReassigned,
+		mSlotNumStats.mVerifyOnlyCount, mSlotNumStats.mQuickCount, mSlotNumStats.mSlowCount);
 }
 
 void BfCompiler::GenerateDynCastData()
@@ -3005,6 +3171,7 @@ void BfCompiler::UpdateRevisedTypes()
 						}
 
 						mSystem->mTypeDefs.AddAfter(compositeTypeDef, rootTypeDefEntry);
+						mSystem->mTypeDefSearchIndex.MarkDirty(compositeTypeDef);
 						partialsHadChanges = true;
 						hadSignatureChange = true;
 						compositeIsNew = true;
@@ -4682,6 +4849,128 @@ int BfCompiler::GetVTableMethodOffset()
 	return 0;
 }
 
+void BfCompiler::GetUsedOutputFileNames(BfProject* bfProject, bool includeImports, Array<String>& outFileNames)
+{
+	Array<BfModule*> moduleList;
+	moduleList.Reserve(bfProject->mUsedModules.size());
+
+	if (mOptions.mCompileOnDemandKind == BfCompileOnDemandKind_AlwaysInclude)
+	{
+		for (auto mainModule : mContext->mModules)
+		{			
+			if ((!mainModule->mIsReified) || (mainModule->mIsScratchModule))
+				continue;
+			if (mOptions.mHotProject != NULL)
+				continue; // Only add new objs from mCodeGen.mCodeGenFiles during hot reload
+			if (!IsModuleAccessible(mainModule, bfProject))
+				continue;
+			
+			moduleList.push_back(mainModule);
+		}
+	}
+	else
+	{
+		for (auto mainModule : bfProject->mUsedModules)
+		{		
+			if ((!mainModule->mIsReified) || (mainModule->mIsScratchModule))
+				continue;
+			if (mOptions.mHotProject != NULL)
+				continue; // Only add new objs from mCodeGen.mCodeGenFiles during hot reload			
+
+			moduleList.push_back(mainModule);
+		}
+	}
+
+	std::sort(moduleList.begin(), moduleList.end(), [&](BfModule* moduleA, BfModule* moduleB) { return moduleA->mModuleName < moduleB->mModuleName; } );
+
+	HashSet<String> usedFileNames;
+	usedFileNames.Reserve(moduleList.size());
+
+	for (auto mainModule : moduleList)
+	{	
+		if (includeImports)
+		{
+			for (auto fileNameIdx : mainModule->mImportFileNames)
+			{
+				auto fileName = mContext->mStringObjectIdMap[fileNameIdx].mString;
+				if (!usedFileNames.TryAdd(fileName, NULL))
+					continue;
+				outFileNames.Add(fileName);
+			}
+		}
+
+		for (auto&& moduleFileName : mainModule->mOutFileNames)
+		{
+			if (!moduleFileName.mModuleWritten)
+				continue;
+
+			bool canReference = true;
+			for (auto project : moduleFileName.mProjects)
+			{
+				if (!bfProject->ContainsReference(project))
+					canReference = false;
+ 				if (bfProject != project)
+ 				{
+ 					if (project->mTargetType == BfTargetType_BeefDynLib)
+ 						canReference = false;
+ 				}
+			}
+			if (!canReference)
+				continue;
+			
+			String fileName = moduleFileName.mFileName;
+
+#ifdef BF_PLATFORM_WINDOWS
+			if (moduleFileName.mWroteToLib)
+				fileName = BeLibManager::GetLibFilePath(fileName);
+#endif			
+			if (!usedFileNames.TryAdd(fileName, NULL))
+				continue;
+			outFileNames.Add(fileName);
+
+			if (mainModule->mWroteToLib)
+				break;
+		}
+	}
+}
+
+void BfCompiler::DoThinLink(BfProject* project)
+{
+	BP_ZONE("BfCompiler::DoThinLink");
+
+	// Libs get linked into whatever references them, so their modules are part of that project's thin link
+	if ((project->mTargetType != BfTargetType_BeefConsoleApplication) && (project->mTargetType != BfTargetType_BeefWindowsApplication) &&
+		(project->mTargetType != BfTargetType_BeefDynLib) && (project->mTargetType != BfTargetType_BeefTest) &&
+		(project->mTargetType != BfTargetType_BeefApplication_StaticLib))
+		return;
+
+	Array<String> inputFileNames;
+	GetUsedOutputFileNames(project, false, inputFileNames);
+	if (inputFileNames.IsEmpty())
+		return;
+
+	String projectOutputDir = mOutputDirectory + "/" + project->mName;
+	String ltoOutputDir = projectOutputDir + "/thinlto";
+	String ltoCacheDir = projectOutputDir + "/thinlto_cache";
+
+	Array<String> outputFileNames;
+	String error;
+	BfLogSysM("ThinLink %s Inputs:%d\n", project->mName.c_str(), (int)inputFileNames.size());
+	if (!mCodeGen.ThinLink(inputFileNames, ltoOutputDir, ltoCacheDir, project->mCodeGenOptions, project->mTargetType == BfTargetType_BeefDynLib, outputFileNames, error))
+	{
+		mPassInstance->Fail(StrFormat("ThinLTO failed for project '%s': %s", project->mName.c_str(), error.c_str()));
+		return;
+	}
+
+	for (int fileIdx = 0; fileIdx < (int)outputFileNames.size(); fileIdx++)
+	{
+		if (fileIdx >= (int)inputFileNames.size())
+			project->mThinLTOExtraFileNames.Add(outputFileNames[fileIdx]);
+		else if (outputFileNames[fileIdx] != inputFileNames[fileIdx])
+			project->mThinLTOFileMap[inputFileNames[fileIdx]] = outputFileNames[fileIdx];
+	}
+}
+
 bool BfCompiler::DoWorkLoop(bool onlyReifiedTypes, bool onlyReifiedMethods)
 {
 	bool hadAnyWork = false;
@@ -5719,10 +6008,23 @@ bool BfCompiler::DoCompile(const StringImpl& outputDirectory)
 	{
 		String hotSwapErrors;
 		String toolsetErrors;
+		String pgoHotSwapErrors;
 		for (auto project : mSystem->mProjects)
 		{
 			if (project->mDisabled)
 				continue;
+			if (project->mCodeGenOptions.mPGOKind != BfPGOKind_None)
+			{
+				if (mOptions.mAllowHotSwapping)
+				{
+					if (!pgoHotSwapErrors.IsEmpty())
+						pgoHotSwapErrors += ", ";
+					pgoHotSwapErrors += project->mName;
+				}
+				if ((project->mCodeGenOptions.mPGOKind == BfPGOKind_Use) && (project->mCodeGenOptions.mPGOProfileHash.IsZero()))
+					mPassInstance->Fail(StrFormat("Unable to load profile '%s' for project '%s'. Run the instrumented build and merge its .profraw files with 'llvm-profdata merge' first.",
+						project->mCodeGenOptions.mPGOProfilePath.c_str(), project->mName.c_str()));
+			}
 			if (project->mCodeGenOptions.mLTOType != BfLTOType_None)
 			{
 				if (mOptions.mAllowHotSwapping)
@@ -5731,7 +6033,7 @@ bool BfCompiler::DoCompile(const StringImpl& outputDirectory)
 						hotSwapErrors += ", ";
 					hotSwapErrors += project->mName;					
 				}
-				if (mOptions.mToolsetType != BfToolsetType_LLVM)
+				if ((project->mCodeGenOptions.mLTOType == BfLTOType_Thin) && (mOptions.mToolsetType != BfToolsetType_LLVM))
 				{
 					if (!toolsetErrors.IsEmpty())
 						toolsetErrors += ", ";
@@ -5744,6 +6046,8 @@ bool BfCompiler::DoCompile(const StringImpl& outputDirectory)
 			mPassInstance->Fail(StrFormat("Hot compilation cannot be used when LTO is enabled in '%s'. Consider setting 'Workspace/Beef/Debug/Enable Hot Compilation' to 'No'.", hotSwapErrors.c_str()));
 		if (!toolsetErrors.IsEmpty())
 			mPassInstance->Fail(StrFormat("The Workspace Toolset must be set to 'LLVM' in order to use LTO in '%s'. Consider changing 'Workspace/General/Toolset' to 'LLVM'.", toolsetErrors.c_str()));
+		if (!pgoHotSwapErrors.IsEmpty())
+			mPassInstance->Fail(StrFormat("Hot compilation cannot be used with profile-guided optimization in '%s'. Consider setting 'Workspace/Beef/Debug/Enable Hot Compilation' to 'No'.", pgoHotSwapErrors.c_str()));
 	}
 
 	//
@@ -5825,6 +6129,8 @@ bool BfCompiler::DoCompile(const StringImpl& outputDirectory)
 	int prevUnfinishedModules = mStats.mModulesStarted - mStats.mModulesFinished;	
 	mCompletionPct = 0;
 	memset(&mStats, 0, sizeof(mStats));
+	mContext->mMangledNameCache.mHits = 0;
+	mContext->mMangledNameCache.mMisses = 0;
 	mCodeGen.ClearResults();
 	mCodeGen.ResetStats();
 	mStats.mModulesStarted = prevUnfinishedModules;
@@ -6354,8 +6660,10 @@ bool BfCompiler::DoCompile(const StringImpl& outputDirectory)
 
 			mCompileState = BfCompiler::CompileState_VData;
 
+			mTypeVDataHashes.Clear();
 			for (auto vdataModule : mVDataModules)
 				CreateVData(vdataModule);
+			mTypeVDataHashes.Clear();
 			for (auto vdataModule : mVDataModules)
 				FixVDataHash(vdataModule);
 
@@ -6490,6 +6798,20 @@ bool BfCompiler::DoCompile(const StringImpl& outputDirectory)
 	}
 	mCodeGen.ProcessErrors(mPassInstance, mCanceling);
 
+	for (auto project : mSystem->mProjects)
+	{
+		project->mThinLTOFileMap.Clear();
+		project->mThinLTOExtraFileNames.Clear();
+	}
+	if ((hasRequiredTypes) && (!mIsResolveOnly) && (!mCanceling) && (!IsHotCompile()) && (!mPassInstance->HasFailed()))
+	{
+		for (auto project : mSystem->mProjects)
+		{
+			if ((!project->mDisabled) && (project->mCodeGenOptions.mLTOType == BfLTOType_ThinInProcess))
+				DoThinLink(project);
+		}
+	}
+
 	// This has to happen after codegen because we may delete modules that are referenced in codegen	
 	mContext->Cleanup();	
 	if ((!IsHotCompile()) && (!mIsResolveOnly) && (!mCanceling))
@@ -6580,7 +6902,11 @@ bool BfCompiler::DoCompile(const StringImpl& outputDirectory)
 		compileInfo += StrFormat("ResolveOnly ResolveType:%d Parser:%d\n", mResolvePassData->mResolveType, mResolvePassData->mParser != NULL);
 	compileInfo += StrFormat("TotalTypes:%d\nTypesPopulated:%d\nMethodsDeclared:%d\nMethodsProcessed:%d\nCanceled? %d\n", mStats.mTotalTypes, mStats.mTypesPopulated, mStats.mMethodDeclarations, mStats.mMethodsProcessed, mCanceling);
 	compileInfo += StrFormat("TypesPopulated:%d\n", mStats.mTypesPopulated);
-	compileInfo += StrFormat("MethodDecls:%d\nMethodsProcessed:%d\nModulesStarted:%d\nModulesFinished:%d\n", mStats.mMethodDeclarations, mStats.mMethodsProcessed, mStats.mModulesFinished);
+	compileInfo += StrFormat("MethodDecls:%d\nMethodsProcessed:%d\nModulesStarted:%d\nModulesFinished:%d\n", mStats.mMethodDeclarations, mStats.mMethodsProcessed, mStats.mModulesStarted, mStats.mModulesFinished);
+	compileInfo += StrFormat("TypesRebuilt:%d\nInlineDepRebuilds:%d\nInlineDepRebuildsSkipped:%d\n", mStats.mTypesRebuilt, mStats.mInlineDepRebuilds, mStats.mInlineDepRebuildsSkipped);
+	compileInfo += StrFormat("MangleCacheHits:%d\nMangleCacheMisses:%d\n", mContext->mMangledNameCache.mHits, mContext->mMangledNameCache.mMisses);
+	compileInfo += StrFormat("SlotNumsVerifyOnly:%d\nSlotNumsQuick:%d\nSlotNumsSlow:%d\nSlotNumsReassigned:%d\n", mSlotNumStats.mVerifyOnlyCount, mSlotNumStats.mQuickCount, mSlotNumStats.mSlowCount,
+		mStats.mSlotNumsReassigned);
 	BpEvent("CompileDone", compileInfo.c_str());
 
 	if (mHotState != NULL)
@@ -6619,17 +6945,21 @@ bool BfCompiler::DoCompile(const StringImpl& outputDirectory)
 bool BfCompiler::Compile(const StringImpl& outputDirectory)
 {
 	bool success = DoCompile(outputDirectory);
-	if (!success)
-		return false;
-	if (mPassInstance->HasFailed())
-		return true;
-	if (!mInterfaceSlotCountChanged)
-		return true;
-	BfLogSysM("Interface slot count increased. Rebuilding relevant modules.\n");
-	mPassInstance->OutputLine("Interface slot count increased. Rebuilding relevant modules.");
-	// Recompile with the increased slot count
-	success = DoCompile(outputDirectory);	
-	BF_ASSERT(!mInterfaceSlotCountChanged);
+	if ((success) && (!mPassInstance->HasFailed()) && (mInterfaceSlotCountChanged))
+	{
+		BfLogSysM("Interface slot count increased. Rebuilding relevant modules.\n");
+		mPassInstance->OutputLine("Interface slot count increased. Rebuilding relevant modules.");
+		// Recompile with the increased slot count
+		success = DoCompile(outputDirectory);	
+		BF_ASSERT(!mInterfaceSlotCountChanged);
+	}
+
+	if ((success) && (mOptions.mShortSymbols) && (!mIsResolveOnly))
+	{
+		String mapPath = outputDirectory + "/ShortSymbols.map";
+		if (!mContext->mMangledNameCache.WriteShortSymbolMap(mapPath))
+			mPassInstance->Fail(StrFormat("Failed to write short symbol map '%s'", mapPath.c_str()));
+	}
 	return success;
 }
 
@@ -7441,7 +7771,16 @@ String BfCompiler::GetTypeDefMatches(const StringImpl& searchStr)
 	String foundName;
 	int partialIdx = 0;
 
-	for (auto typeDef : mSystem->mTypeDefs)
+	// The index only narrows the set of typeDefs we check - matching below is still authoritative
+	Array<BfTypeDef*> checkTypeDefs;
+	if (!mSystem->mTypeDefSearchIndex.GetCandidates(matchHelper.mSearch, checkTypeDefs))
+	{
+		checkTypeDefs.Reserve(mSystem->mTypeDefs.mCount);
+		for (auto typeDef : mSystem->mTypeDefs)
+			checkTypeDefs.Add(typeDef);
+	}
+
+	for (auto typeDef : checkTypeDefs)
 	{		
 		if (typeDef->mIsPartial)
 			continue;
@@ -7842,18 +8181,18 @@ BF_EXPORT bool BF_CALLTYPE BfCompiler_VerifyTypeName(BfCompiler* bfCompiler, cha
 	bool attribWasClosed = false;
 	bool isAttributeRef = false;
 	auto firstNode = parser.mRootNode->mChildArr[0];
-	auto endIdx = parser.mRootNode->mSrcEnd;
+	auto endIdx = parser.mRootNode->GetSrcEnd();
 	reducer.mVisitorPos = BfReducer::BfVisitorPos(parser.mRootNode);
 	if (auto tokenNode = BfNodeDynCast<BfTokenNode>(firstNode))
 	{
-		if (tokenNode->mToken == BfToken_LBracket)
+		if (tokenNode->GetToken() == BfToken_LBracket)
 		{
 			if (auto lastToken = BfNodeDynCast<BfTokenNode>(parser.mRootNode->mChildArr.back()))
 			{
-				if (lastToken->mToken == BfToken_RBracket)
+				if (lastToken->GetToken() == BfToken_RBracket)
 				{
 					attribWasClosed = true;
-					endIdx = lastToken->mSrcStart;
+					endIdx = lastToken->GetSrcStart();
 				}
 			}
 
@@ -7897,7 +8236,7 @@ BF_EXPORT bool BF_CALLTYPE BfCompiler_VerifyTypeName(BfCompiler* bfCompiler, cha
 	if (passInstance.HasFailed())
 		return false;
 
-	if (typeRef->mSrcEnd != endIdx)
+	if (typeRef->GetSrcEnd() != endIdx)
 		return false;
 
 	if (!bfCompiler->mContext->mScratchModule->ValidateTypeWildcard(typeRef, isAttributeRef))
@@ -8050,87 +8389,23 @@ BF_EXPORT const char* BF_CALLTYPE BfCompiler_GetUsedOutputFileNames(BfCompiler*
 	String& outString = *gTLStrReturn.Get();
 	outString.clear();
 	
-	Array<BfModule*> moduleList;
-	moduleList.Reserve(bfProject->mUsedModules.size());
-
-	if (bfCompiler->mOptions.mCompileOnDemandKind == BfCompileOnDemandKind_AlwaysInclude)
+	Array<String> fileNames;
+	bfCompiler->GetUsedOutputFileNames(bfProject, true, fileNames);
+	for (auto& fileName : fileNames)
 	{
-		for (auto mainModule : bfCompiler->mContext->mModules)
-		{			
-			if ((!mainModule->mIsReified) || (mainModule->mIsScratchModule))
-				continue;
-			if (bfCompiler->mOptions.mHotProject != NULL)
-				continue; // Only add new objs from mCodeGen.mCodeGenFiles during hot reload
-			if (!bfCompiler->IsModuleAccessible(mainModule, bfProject))
-				continue;
-			
-			moduleList.push_back(mainModule);
-		}
+		if (!outString.empty())
+			outString += "\n";
+		String* thinLTOFileName = NULL;
+		if (bfProject->mThinLTOFileMap.TryGetValue(fileName, &thinLTOFileName))
+			outString += *thinLTOFileName;
+		else
+			outString += fileName;
 	}
-	else
+	for (auto& fileName : bfProject->mThinLTOExtraFileNames)
 	{
-		for (auto mainModule : bfProject->mUsedModules)
-		{		
-			if ((!mainModule->mIsReified) || (mainModule->mIsScratchModule))
-				continue;
-			if (bfCompiler->mOptions.mHotProject != NULL)
-				continue; // Only add new objs from mCodeGen.mCodeGenFiles during hot reload			
-
-			moduleList.push_back(mainModule);
-		}
-	}
-
-	std::sort(moduleList.begin(), moduleList.end(), [&](BfModule* moduleA, BfModule* moduleB) { return moduleA->mModuleName < moduleB->mModuleName; } );
-
-	HashSet<String> usedFileNames;
-	usedFileNames.Reserve(moduleList.size());
-
-	for (auto mainModule : moduleList)
-	{	
-		for (auto fileNameIdx : mainModule->mImportFileNames)
-		{
-			auto fileName = bfCompiler->mContext->mStringObjectIdMap[fileNameIdx].mString;
-			if (!usedFileNames.TryAdd(fileName, NULL))
-				continue;
-			if (!outString.empty())
-				outString += "\n";
-			outString += fileName;
-		}
-
-		for (auto&& moduleFileName : mainModule->mOutFileNames)
-		{
-			if (!moduleFileName.mModuleWritten)
-				continue;
-
-			bool canReference = true;
-			for (auto project : moduleFileName.mProjects)
-			{
-				if (!bfProject->ContainsReference(project))
-					canReference = false;
- 				if (bfProject != project)
- 				{
- 					if (project->mTargetType == BfTargetType_BeefDynLib)
- 						canReference = false;
- 				}
-			}
-			if (!canReference)
-				continue;
-			
-			String fileName = moduleFileName.mFileName;
-
-#ifdef BF_PLATFORM_WINDOWS
-			if (moduleFileName.mWroteToLib)
-				fileName = BeLibManager::GetLibFilePath(fileName);
-#endif			
-			if (!usedFileNames.TryAdd(fileName, NULL))
-				continue;
-			if (!outString.empty())
-				outString += "\n";
-			outString += fileName;
-
-			if (mainModule->mWroteToLib)
-				break;
-		}
+		if (!outString.empty())
+			outString += "\n";
+		outString += fileName;
 	}
 
 	if (bfCompiler->mHotState != NULL)
@@ -8344,6 +8619,8 @@ BF_EXPORT void BF_CALLTYPE BfCompiler_SetOptions(BfCompiler* bfCompiler, BfProje
 		options->mEnableRealtimeLeakCheck = ((optionFlags & BfCompilerOptionFlag_EnableRealtimeLeakCheck) != 0) && options->mObjectHasDebugFlags;
 		options->mDebugAlloc = ((optionFlags & BfCompilerOptionFlag_DebugAlloc) != 0) || options->mEnableRealtimeLeakCheck;
 		options->mOmitDebugHelpers = (optionFlags & BfCompilerOptionFlag_OmitDebugHelpers) != 0;
+		options->mMethodGranularDeps = (optionFlags & BfCompilerOptionFlag_MethodGranularDeps) != 0;
+		options->mShortSymbols = (optionFlags & BfCompilerOptionFlag_ShortSymbols) != 0;
 
 #ifdef _WINDOWS
 // 		if (options->mToolsetType == BfToolsetType_GNU)
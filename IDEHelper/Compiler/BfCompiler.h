@@ -72,6 +72,10 @@ public:
 		int mQueuedTypesProcessed;
 		int mTypesQueued;
 		int mTypesDeleted;
+		int mTypesRebuilt;
+		int mInlineDepRebuilds;
+		int mInlineDepRebuildsSkipped; // Dependents spared by method-granular inline dependencies
+		int mSlotNumsReassigned; // Interfaces given a new slot by QuickGenerateSlotNums, -1 after a full renumbering
 		int mMethodsQueued;		
 
 		int mModulesStarted;
@@ -121,6 +125,8 @@ public:
 		bool mHasVDataExtender; 
 		bool mDebugAlloc;
 		bool mOmitDebugHelpers;
+		bool mMethodGranularDeps;
+		bool mShortSymbols; // Hashed symbol names, see BfMangledNameCache
 
 		bool mUseDebugBackingParams;		
 
@@ -150,6 +156,8 @@ public:
 			mHotProject = NULL;
 			mDebugAlloc = false;
 			mOmitDebugHelpers = false;
+			mMethodGranularDeps = false;
+			mShortSymbols = false;
 			mIncrementalBuild = true;
 			mEmitDebugInfo = false;
 			mEmitLineInfo = false;
@@ -328,6 +336,7 @@ public:
 	CompileState mCompileState;
 
 	Array<BfVDataModule*> mVDataModules;	
+	Dictionary<BfType*, Val128> mTypeVDataHashes; // Per-type vdata fragments, shared by every vdata module during the vdata pass
 	BfTypeDef* mArray1TypeDef;
 	BfTypeDef* mArray2TypeDef;
 	BfTypeDef* mArray3TypeDef;
@@ -407,6 +416,12 @@ public:
 
 	int mMaxInterfaceSlots;
 	bool mInterfaceSlotCountChanged;
+	struct
+	{
+		int mVerifyOnlyCount; // Existing slots were all still valid
+		int mQuickCount; // Only unslotted or colliding interfaces were reassigned
+		int mSlowCount; // Every interface was renumbered
+	} mSlotNumStats;
 
 public:		
 	bool IsTypeAccessible(BfType* checkType, BfProject* curProject);
@@ -415,6 +430,7 @@ public:
 	void FixVDataHash(BfModule* bfModule);
 	void CheckModuleStringRefs(BfModule* module, BfVDataModule* vdataModule, int lastModuleRevision, HashSet<int>& foundStringIds, HashSet<int>& dllNameSet, Array<BfMethodInstance*>& dllMethods, Array<BfCompiler::StringValueEntry>& stringValueEntries);
 	void HashModuleVData(BfModule* module, HashContext& hash);
+	Val128 HashTypeVData(BfType* type);
 	BfIRFunction CreateLoadSharedLibraries(BfVDataModule* bfModule, Array<BfMethodInstance*>& dllMethods);
 	void GetTestMethods(BfVDataModule* bfModule, Array<TestMethod>& testMethods, HashContext& vdataHashCtx);
 	void EmitTestMethod(BfVDataModule* bfModule, Array<TestMethod>& testMethods, BfIRValue& retValue);
@@ -430,6 +446,7 @@ public:
 	void VisitAutocompleteExteriorIdentifiers();		
 	void VisitSourceExteriorNodes();
 	void UpdateCompletion();
+	void DoThinLink(BfProject* project);
 	bool DoWorkLoop(bool onlyReifiedTypes = false, bool onlyReifiedMethods = false);
 	BfMangler::MangleKind GetMangleKind();
 	
@@ -468,6 +485,7 @@ public:
 
 	bool Compile(const StringImpl& outputPath);	
 	bool DoCompile(const StringImpl& outputPath);
+	void GetUsedOutputFileNames(BfProject* bfProject, bool includeImports, Array<String>& outFileNames);
 	void ClearResults();
 	void ProcessAutocompleteTempType();	
 	void GetSymbolReferences();	
@@ -104,6 +104,9 @@ BfContext::~BfContext()
 void BfContext::ReportMemory(MemReporter* memReporter)
 {	
 	memReporter->Add(sizeof(BfContext));
+	memReporter->BeginSection("MangledNameCache");
+	mMangledNameCache.ReportMemory(memReporter);
+	memReporter->EndSection();
 }
 
 void BfContext::ProcessMethod(BfMethodInstance* methodInstance)
@@ -809,6 +812,7 @@ void BfContext::RebuildType(BfType* type, bool deleteOnDemandTypes, bool rebuild
 	}
 
 	type->mDirty = true;
+	mMangledNameCache.RemoveType(type);
 		
 	if (typeInst == NULL)
 	{	
@@ -878,6 +882,7 @@ void BfContext::RebuildType(BfType* type, bool deleteOnDemandTypes, bool rebuild
 	if (addToWorkList)
 	{
 		AddTypeToWorkList(typeInst);		
+		mCompiler->mStats.mTypesRebuilt++;
 	}
 
 	// Why did we need to do this?  This caused all struct types to be rebuilt when we needed to rebuild ValueType due to
@@ -1182,6 +1187,10 @@ void BfContext::TypeInlineMethodInternalsChanged(BfTypeInstance* typeInst)
 		return;
 	typeInst->mRebuildFlags = (BfTypeRebuildFlags)(typeInst->mRebuildFlags | BfTypeRebuildFlag_MethodInlineInternalsChange);
 
+	// The def builder tells us which inline methods changed, so we can skip dependents that only inlined other methods
+	auto typeDef = typeInst->mTypeDef;
+	bool useMethodDeps = (mCompiler->mOptions.mMethodGranularDeps) && (typeDef->mChangedInlineMethodsKnown);
+
 	// These don't happen in TypeDataChanged because we don't need to cascade
 	for (auto& depItr : typeInst->mDependencyMap)
 	{
@@ -1191,6 +1200,14 @@ void BfContext::TypeInlineMethodInternalsChanged(BfTypeInstance* typeInst)
 		// We don't need to cascade rebuilding for method-based usage - just rebuild the type directly (unlike TypeDataChanged, which cascades)
 		if (dependencyFlags & BfDependencyMap::DependencyFlag_InlinedCall)
 		{
+			if ((useMethodDeps) && (!typeInst->mDependencyMap.InlinesAnyOf(dependentType, typeDef->mChangedInlineMethods)))
+			{
+				BfLogSysM("TypeInlineMethodInternalsChanged %p skipping dependent %p\n", typeInst, dependentType);
+				mCompiler->mStats.mInlineDepRebuildsSkipped++;
+				continue;
+			}
+
+			mCompiler->mStats.mInlineDepRebuilds++;
 			RebuildType(dependentType);
 		}
 	}
@@ -1411,6 +1428,7 @@ void BfContext::DeleteType(BfType* type, bool deferDepRebuilds)
 		return;	
 	
 	mCompiler->mStats.mTypesDeleted++;
+	mMangledNameCache.RemoveType(type);
 
 	BfDependedType* dType = type->ToDependedType();
 	BfTypeInstance* typeInst = type->ToTypeInstance();
@@ -1916,6 +1934,7 @@ void BfContext::UpdateRevisedTypes()
 				
 				buildConfigHashCtx.Mixin(project->mAlwaysIncludeAll);
 				buildConfigHashCtx.Mixin(project->mSingleModule);
+				buildConfigHashCtx.Mixin(project->mCompactReflection);
 
 				bool isTestConfig = project->mTargetType == BfTargetType_BeefTest;
 				buildConfigHashCtx.Mixin(isTestConfig);
@@ -1941,6 +1960,9 @@ void BfContext::UpdateRevisedTypes()
 				buildConfigHashCtx.Mixin(codeGenOptions.mEnableMLSM);
 				buildConfigHashCtx.Mixin(codeGenOptions.mRunSLPAfterLoopVectorization);
 				buildConfigHashCtx.Mixin(codeGenOptions.mUseGVNAfterVectorization);
+				buildConfigHashCtx.Mixin(codeGenOptions.mPGOKind);
+				buildConfigHashCtx.MixinStr(codeGenOptions.mPGOProfilePath);
+				buildConfigHashCtx.Mixin(codeGenOptions.mPGOProfileHash);
 			}
 			buildConfigHashCtx.Mixin(project->mDisabled);
 			buildConfigHashCtx.Mixin(project->mTargetType);
@@ -2700,6 +2722,7 @@ void BfContext::Cleanup()
 	for (auto type : mTypeGraveyard)
 	{		
 		BF_ASSERT(type->mRebuildFlags & BfTypeRebuildFlag_Deleted);
+		mMangledNameCache.RemoveType(type);
 		delete type;
 	}
 	mTypeGraveyard.Clear();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BfModule.h"
+#include "BfMangler.h"
 #include "BeefySysLib/util/Deque.h"
 
 NS_BF_BEGIN
@@ -327,6 +328,7 @@ public:
 	Array<BfAstNode*> mTempNodes;
 	BfResolvedTypeSet mResolvedTypes;	
 	Array<BfType*> mTypes; // Can contain NULLs for deleted types
+	BfMangledNameCache mMangledNameCache;
 	Array<BfFieldInstance*> mFieldResolveReentrys; // For detecting 'var' field circular refs	
 	Dictionary<String, BfSavedTypeData*> mSavedTypeDataMap;
 	Array<BfSavedTypeData*> mSavedTypeData;
@@ -289,7 +289,7 @@ void BfDefBuilder::ParseGenericParams(BfGenericParamsDeclaration* genericParamsD
 				name = tokenPairNode->mLeft->ToString() + tokenPairNode->mRight->ToString();
 			}
 
-			bool hasEquals = (genericConstraint->mColonToken != NULL) && (genericConstraint->mColonToken->mToken == BfToken_AssignEquals);			
+			bool hasEquals = (genericConstraint->mColonToken != NULL) && (genericConstraint->mColonToken->GetToken() == BfToken_AssignEquals);			
 
 			if (!name.empty())
 			{
@@ -394,6 +394,32 @@ void BfDefBuilder::Visit(BfConstructorDeclaration* ctorDeclaration)
 	Visit((BfMethodDeclaration*)ctorDeclaration);
 }
 
+static bool IsInlineHashed(BfMethodDef* methodDef)
+{
+	// Must match the methods mixed into BfTypeDef::mInlineHash in FinishTypeDef
+	return (methodDef->mAlwaysInline) || (methodDef->mHasAppend) || (methodDef->mMethodType == BfMethodType_Mixin);
+}
+
+// Records which of the previous revision's inline methods no longer exist with the same hash. Dependents that only
+//  inlined unchanged methods don't need to be rebuilt
+void BfDefBuilder::FindChangedInlineMethods(BfTypeDef* prevTypeDef, BfTypeDef* nextTypeDef)
+{
+	Array<Val128> nextInlineHashes;
+	for (auto methodDef : nextTypeDef->mMethods)
+	{
+		if (IsInlineHashed(methodDef))
+			nextInlineHashes.Add(methodDef->mFullHash);
+	}
+
+	prevTypeDef->mChangedInlineMethods.Clear();
+	for (auto methodDef : prevTypeDef->mMethods)
+	{
+		if ((IsInlineHashed(methodDef)) && (!nextInlineHashes.Contains(methodDef->mFullHash)))
+			prevTypeDef->mChangedInlineMethods.Add(methodDef->mFullHash);
+	}
+	prevTypeDef->mChangedInlineMethodsKnown = true;
+}
+
 BfMethodDef* BfDefBuilder::CreateMethodDef(BfMethodDeclaration* methodDeclaration, BfMethodDef* outerMethodDef)
 {
 	BfMethodDef* methodDef;
@@ -610,7 +636,7 @@ BfMethodDef* BfDefBuilder::CreateMethodDef(BfMethodDeclaration* methodDeclaratio
 
 		if (auto dotTypeRef = BfNodeDynCast<BfDotTypeReference>(paramDef->mTypeRef))
 		{
-			if (dotTypeRef->mDotToken->mToken == BfToken_DotDotDot)
+			if (dotTypeRef->mDotToken->GetToken() == BfToken_DotDotDot)
 			{
 				if (paramIdx == (int)methodDeclaration->mParams.size() - 1)
 					paramDef->mParamKind = BfParamKind_VarArgs;
@@ -1212,24 +1238,7 @@ void BfDefBuilder::Visit(BfTypeDeclaration* typeDeclaration)
 	auto bfParser = mCurSource->ToParser();
 	if (bfParser != NULL)
 	{
-		int srcStart = typeDeclaration->GetSrcStart();
-		auto* jumpEntry = bfParser->mJumpTable + (srcStart / PARSER_JUMPTABLE_DIVIDE);
-		if (jumpEntry->mCharIdx > srcStart)
-			jumpEntry--;
-		curLine = jumpEntry->mLineNum;
-		int curSrcPos = jumpEntry->mCharIdx;
-		curColumn = 0;
-		while (curSrcPos < srcStart)
-		{
-			if (bfParser->mSrc[curSrcPos] == '\n')
-			{
-				curLine++;
-				curColumn = 0;
-			}
-			else
-				curColumn++;
-			curSrcPos++;
-		}
+		bfParser->GetLineCharAtIdx(typeDeclaration->GetSrcStart(), curLine, curColumn);
 	}
 
 	auto outerTypeDef = mCurTypeDef;
@@ -1537,6 +1546,7 @@ void BfDefBuilder::Visit(BfTypeDeclaration* typeDeclaration)
 		if (doInsertNew)
 		{
 			mSystem->mTypeDefs.Add(mCurTypeDef);
+			mSystem->mTypeDefSearchIndex.MarkDirty(mCurTypeDef);
 			mSystem->mTypeMapVersion++;
 		}
 	}
@@ -1650,6 +1660,7 @@ void BfDefBuilder::Visit(BfTypeDeclaration* typeDeclaration)
 	// Map methods into the correct index from previous revision
 	if (prevRevisionTypeDef != NULL)
 	{
+		prevRevisionTypeDef->mChangedInlineMethodsKnown = false;
 		if ((mCurTypeDef->mFullHash == prevRevisionTypeDef->mFullHash) && (!mFullRefresh))
 		{
 			BfLogSys(bfParser->mSystem, "DefBuilder deleting typeDef with no changes %p\n", prevRevisionTypeDef);
@@ -1662,7 +1673,10 @@ void BfDefBuilder::Visit(BfTypeDeclaration* typeDeclaration)
 		else if (mCurTypeDef->mSignatureHash != prevRevisionTypeDef->mSignatureHash)
 			prevRevisionTypeDef->mDefState = BfTypeDef::DefState_Signature_Changed;
 		else if (mCurTypeDef->mInlineHash != prevRevisionTypeDef->mInlineHash)
+		{
 			prevRevisionTypeDef->mDefState = BfTypeDef::DefState_InlinedInternals_Changed;
+			FindChangedInlineMethods(prevRevisionTypeDef, mCurTypeDef);
+		}
 		else
 			prevRevisionTypeDef->mDefState = BfTypeDef::DefState_Internals_Changed;
 	}
@@ -2073,9 +2087,7 @@ void BfDefBuilder::FinishTypeDef(bool wantsToString)
 		if (mSignatureHashCtx != NULL)
 			mSignatureHashCtx->MixinStr(methodDef->mName);
 		
-		if ((methodDef->mAlwaysInline) || 
-			(methodDef->mHasAppend) ||
-			(methodDef->mMethodType == BfMethodType_Mixin))
+		if (IsInlineHashed(methodDef))
 			inlineHashCtx.Mixin(methodDef->mFullHash);
 
 		if (mFullRefresh)
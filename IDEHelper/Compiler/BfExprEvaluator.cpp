@@ -2504,7 +2504,7 @@ void BfExprEvaluator::Visit(BfCaseExpression* caseExpr)
 				}
 				else if (auto unaryOpExpr = BfNodeDynCast<BfUnaryOperatorExpression>(arg))
 				{
-					if (unaryOpExpr->mOpToken->mToken == BfToken_Out)
+					if (unaryOpExpr->mOpToken->GetToken() == BfToken_Out)
 					{
 						hasOut = true;
 					}
@@ -8677,7 +8677,7 @@ bool BfExprEvaluator::CanBindDelegate(BfDelegateBindExpression* delegateBindExpr
 	SizedArray<BfTypedValueExpression, 4> typedValueExprs;
 	typedValueExprs.resize(methodInstance->GetParamCount());
 
-	SizedArray<BfExpression*, 4> args;
+	SizedArray<ASTREF(BfExpression*), 4> args;
 	args.resize(methodInstance->GetParamCount());
 
 	for (int i = 0; i < (int) methodInstance->GetParamCount(); i++)
@@ -9007,7 +9007,7 @@ void BfExprEvaluator::Visit(BfDelegateBindExpression* delegateBindExpr)
 	BfAllocTarget allocTarget = ResolveAllocTarget(delegateBindExpr->mNewToken, newToken);
 
 	SizedArray<BfTypedValueExpression, 4> typedValueExprs;
-	SizedArray<BfExpression*, 4> args;
+	SizedArray<ASTREF(BfExpression*), 4> args;
 
 	BfTypeInstance* delegateTypeInstance = NULL;
 	BfMethodInstance* methodInstance = NULL;
@@ -10766,7 +10766,7 @@ void BfExprEvaluator::Visit(BfLambdaBindExpression* lambdaBindExpr)
 	}	
 }
 
-void BfExprEvaluator::ProcessArrayInitializer(BfTokenNode* openToken, const BfSizedArray<BfExpression*>& valueExprs, const BfSizedArray<BfTokenNode*>& commas, BfTokenNode* closeToken, int dimensions, SizedArrayImpl<int64>& dimLengths, int dim, bool& hasFailed)
+void BfExprEvaluator::ProcessArrayInitializer(BfTokenNode* openToken, const BfSizedArray<ASTREF(BfExpression*)>& valueExprs, const BfSizedArray<ASTREF(BfTokenNode*)>& commas, BfTokenNode* closeToken, int dimensions, SizedArrayImpl<int64>& dimLengths, int dim, bool& hasFailed)
 {
 	bool setSize = false;
 
@@ -10825,9 +10825,9 @@ void BfExprEvaluator::ProcessArrayInitializer(BfTokenNode* openToken, const BfSi
 				}
 				else if (auto parenExpr = BfNodeDynCast<BfParenthesizedExpression>(expr))
 				{					
-					SizedArray<BfExpression*, 1> values;
+					SizedArray<ASTREF(BfExpression*), 1> values;
 					values.Add(parenExpr->mExpression);
-					SizedArray<BfTokenNode*, 1> commas;					
+					SizedArray<ASTREF(BfTokenNode*), 1> commas;					
 					ProcessArrayInitializer(parenExpr->mOpenParen, values, commas, parenExpr->mCloseParen, dimensions, dimLengths, dim + 1, hasFailed);
 				}
 				else
@@ -11249,7 +11249,7 @@ void BfExprEvaluator::Visit(BfObjectCreateExpression* objCreateExpr)
 		
 		int writeIdx = 0;
 
-		std::function<void(BfIRValue addr, int curDim, const BfSizedArray<BfExpression*>& valueExprs)> _HandleInitExprs = [&](BfIRValue addr, int curDim, const BfSizedArray<BfExpression*>& valueExprs)
+		std::function<void(BfIRValue addr, int curDim, const BfSizedArray<ASTREF(BfExpression*)>& valueExprs)> _HandleInitExprs = [&](BfIRValue addr, int curDim, const BfSizedArray<ASTREF(BfExpression*)>& valueExprs)
 		{
 			int exprIdx = 0;			
 			int dimWriteIdx = 0;
@@ -11285,7 +11285,7 @@ void BfExprEvaluator::Visit(BfObjectCreateExpression* objCreateExpr)
 					}
 					else if (auto parenExpr = BfNodeDynCast<BfParenthesizedExpression>(initExpr))
 					{
-						SizedArray<BfExpression*, 1> values;
+						SizedArray<ASTREF(BfExpression*), 1> values;
 						values.Add(parenExpr->mExpression);						
 						_HandleInitExprs(addr, curDim + 1, values);
 					}
@@ -11836,7 +11836,7 @@ void BfExprEvaluator::Visit(BfBoxExpression* boxExpr)
 	BfTokenNode* newToken = NULL;
 	BfAllocTarget allocTarget = ResolveAllocTarget(boxExpr->mAllocNode, newToken);
 
-	if ((boxExpr->mAllocNode != NULL) && (boxExpr->mAllocNode->mToken == BfToken_Scope))
+	if ((boxExpr->mAllocNode != NULL) && (boxExpr->mAllocNode->GetToken() == BfToken_Scope))
 	{
 		if ((mBfEvalExprFlags & BfEvalExprFlags_FieldInitializer) != 0)
 		{
@@ -12378,7 +12378,7 @@ void BfExprEvaluator::CheckLocalMethods(BfAstNode* targetSrc, BfTypeInstance* ty
 	}	
 }
 
-void BfExprEvaluator::InjectMixin(BfAstNode* targetSrc, BfTypedValue target, bool allowImplicitThis, const StringImpl& name, const BfSizedArray<BfExpression*>& arguments, BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArgs)
+void BfExprEvaluator::InjectMixin(BfAstNode* targetSrc, BfTypedValue target, bool allowImplicitThis, const StringImpl& name, const BfSizedArray<ASTREF(BfExpression*)>& arguments, BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArgs)
 {
 	BfAstNode* origTargetSrc = targetSrc;
 	BfScopedInvocationTarget* scopedInvocationTarget = NULL;
@@ -12670,7 +12670,7 @@ void BfExprEvaluator::InjectMixin(BfAstNode* targetSrc, BfTypedValue target, boo
 		argExprEvaluatorItr++;
 	}
 
-	mModule->AddDependency(methodInstance->GetOwner(), mModule->mCurTypeInstance, BfDependencyMap::DependencyFlag_InlinedCall);
+	mModule->AddInlinedCallDependency(methodInstance->GetOwner(), methodInstance, mModule->mCurTypeInstance);
 	
 	auto startBlock = mModule->mBfIRBuilder->CreateBlock("mixinStart");
 	mModule->mBfIRBuilder->CreateBr(startBlock);
@@ -13136,7 +13136,7 @@ void BfExprEvaluator::SetMethodElementType(BfAstNode* target)
 		mModule->SetElementType(target, BfSourceElementType_Method);
 }
 
-void BfExprEvaluator::DoInvocation(BfAstNode* target, BfMethodBoundExpression* methodBoundExpr, const BfSizedArray<BfExpression*>& args, BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArguments, BfTypedValue* outCascadeValue)
+void BfExprEvaluator::DoInvocation(BfAstNode* target, BfMethodBoundExpression* methodBoundExpr, const BfSizedArray<ASTREF(BfExpression*)>& args, BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArguments, BfTypedValue* outCascadeValue)
 {
 	// Just a check
 	mModule->mBfIRBuilder->GetInsertBlock();
@@ -13354,7 +13354,7 @@ void BfExprEvaluator::DoInvocation(BfAstNode* target, BfMethodBoundExpression* m
 		else if (auto expr = BfNodeDynCast<BfExpression>(memberRefExpression->mTarget))
 		{
 			BfType* expectingTargetType = NULL;
-			if (memberRefExpression->mDotToken->mToken == BfToken_DotDot)
+			if (memberRefExpression->mDotToken->GetToken() == BfToken_DotDot)
 				expectingTargetType = mExpectingType;
 
 			bool handled = false;
@@ -13694,10 +13694,10 @@ void BfExprEvaluator::DoInvocation(BfAstNode* target, BfMethodBoundExpression* m
 		}
 	}
 	
-	SizedArray<BfExpression*, 8> copiedArgs;
+	SizedArray<ASTREF(BfExpression*), 8> copiedArgs;
 	for (BfExpression* arg : args)
 		copiedArgs.push_back(arg);
-	BfSizedArray<BfExpression*> sizedCopiedArgs(copiedArgs);
+	BfSizedArray<ASTREF(BfExpression*)> sizedCopiedArgs(copiedArgs);
 	BfResolvedArgs argValues(&sizedCopiedArgs);	
 
 	if (mModule->mParentNodeEntry != NULL)
@@ -13821,7 +13821,7 @@ void BfExprEvaluator::Visit(BfInvocationExpression* invocationExpr)
 	BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArguments = NULL;
 	if (invocationExpr->mGenericArgs != NULL)
 		methodGenericArguments = &invocationExpr->mGenericArgs->mGenericArgs;
-	SizedArray<BfExpression*, 8> copiedArgs;
+	SizedArray<ASTREF(BfExpression*), 8> copiedArgs;
 	for (BfExpression* arg : invocationExpr->mArguments)
 		copiedArgs.push_back(arg);			
 
@@ -15236,7 +15236,7 @@ void BfExprEvaluator::Visit(BfParenthesizedExpression* parenExpr)
 	MakeResultAsValue();
 }
 
-void BfExprEvaluator::InitializedSizedArray(BfSizedArrayType* arrayType, BfTokenNode* openToken, const BfSizedArray<BfExpression*>& valueExprs, const BfSizedArray<BfTokenNode*>& commas, BfTokenNode* closeToken, BfTypedValue* receivingValue)
+void BfExprEvaluator::InitializedSizedArray(BfSizedArrayType* arrayType, BfTokenNode* openToken, const BfSizedArray<ASTREF(BfExpression*)>& valueExprs, const BfSizedArray<ASTREF(BfTokenNode*)>& commas, BfTokenNode* closeToken, BfTypedValue* receivingValue)
 {
 	struct InitValue
 	{
@@ -15264,8 +15264,8 @@ void BfExprEvaluator::InitializedSizedArray(BfSizedArrayType* arrayType, BfToken
 
 		int depth = 0;
 
-		std::function<void(BfSizedArrayType*, BfTokenNode* openToken, const BfSizedArray<BfExpression*>&, const BfSizedArray<BfTokenNode*>&, BfTokenNode*, bool)>
-			_GetValues = [&](BfSizedArrayType* checkArrayType, BfTokenNode* openToken, const BfSizedArray<BfExpression*>& valueExprs, const BfSizedArray<BfTokenNode*>& commas, BfTokenNode* closeToken, bool ignore)
+		std::function<void(BfSizedArrayType*, BfTokenNode* openToken, const BfSizedArray<ASTREF(BfExpression*)>&, const BfSizedArray<ASTREF(BfTokenNode*)>&, BfTokenNode*, bool)>
+			_GetValues = [&](BfSizedArrayType* checkArrayType, BfTokenNode* openToken, const BfSizedArray<ASTREF(BfExpression*)>& valueExprs, const BfSizedArray<ASTREF(BfTokenNode*)>& commas, BfTokenNode* closeToken, bool ignore)
 		{
 			int64 initCountDiff = (int)valueExprs.size() - checkArrayType->mElementCount;
 			if ((initCountDiff != 0) && (!failedAt.Contains(depth)))
@@ -15332,9 +15332,9 @@ void BfExprEvaluator::InitializedSizedArray(BfSizedArrayType* arrayType, BfToken
 						else if (auto parenExpr = BfNodeDynCast<BfParenthesizedExpression>(expr))
 						{
 							depth++;
-							SizedArray<BfExpression*, 1> values;
+							SizedArray<ASTREF(BfExpression*), 1> values;
 							values.Add(parenExpr->mExpression);
-							SizedArray<BfTokenNode*, 1> commas;
+							SizedArray<ASTREF(BfTokenNode*), 1> commas;
 							_GetValues((BfSizedArrayType*)checkArrayType->mElementType, parenExpr->mOpenParen, values, commas, parenExpr->mCloseParen, ignore);
 							depth--;
 							continue;
@@ -15378,8 +15378,8 @@ void BfExprEvaluator::InitializedSizedArray(BfSizedArrayType* arrayType, BfToken
 
 		int valueIdx = 0;
 
-		std::function<void(BfTypedValue, BfTokenNode* openToken, const BfSizedArray<BfExpression*>&, const BfSizedArray<BfTokenNode*>&, BfTokenNode*)>
-			_CreateMemArray = [&](BfTypedValue arrayValue, BfTokenNode* openToken, const BfSizedArray<BfExpression*>& valueExprs, const BfSizedArray<BfTokenNode*>& commas, BfTokenNode* closeToken)
+		std::function<void(BfTypedValue, BfTokenNode* openToken, const BfSizedArray<ASTREF(BfExpression*)>&, const BfSizedArray<ASTREF(BfTokenNode*)>&, BfTokenNode*)>
+			_CreateMemArray = [&](BfTypedValue arrayValue, BfTokenNode* openToken, const BfSizedArray<ASTREF(BfExpression*)>& valueExprs, const BfSizedArray<ASTREF(BfTokenNode*)>& commas, BfTokenNode* closeToken)
 		{
 			BF_ASSERT(arrayValue.mType->IsSizedArray());
 			auto checkArrayType = (BfSizedArrayType*)arrayValue.mType;
@@ -15420,9 +15420,9 @@ void BfExprEvaluator::InitializedSizedArray(BfSizedArrayType* arrayType, BfToken
 					else if (auto parenExpr = BfNodeDynCast<BfParenthesizedExpression>(expr))
 					{
 						depth++;
-						SizedArray<BfExpression*, 1> values;
+						SizedArray<ASTREF(BfExpression*), 1> values;
 						values.Add(parenExpr->mExpression);
-						SizedArray<BfTokenNode*, 1> commas;
+						SizedArray<ASTREF(BfTokenNode*), 1> commas;
 						_CreateMemArray(BfTypedValue(elemPtrValue, checkArrayType->mElementType, true), parenExpr->mOpenParen, values, commas, parenExpr->mCloseParen);
 						depth--;
 						continue;
@@ -15489,8 +15489,8 @@ void BfExprEvaluator::InitializedSizedArray(BfSizedArrayType* arrayType, BfToken
 			}
 		};
 
-		std::function<BfIRValue(BfTypedValue, BfTokenNode*, const BfSizedArray<BfExpression*>&, const BfSizedArray<BfTokenNode*>&, BfTokenNode*)>
-			_CreateConstArray = [&](BfTypedValue arrayValue, BfTokenNode* openToken, const BfSizedArray<BfExpression*>& valueExprs, const BfSizedArray<BfTokenNode*>& commas, BfTokenNode* closeToken)
+		std::function<BfIRValue(BfTypedValue, BfTokenNode*, const BfSizedArray<ASTREF(BfExpression*)>&, const BfSizedArray<ASTREF(BfTokenNode*)>&, BfTokenNode*)>
+			_CreateConstArray = [&](BfTypedValue arrayValue, BfTokenNode* openToken, const BfSizedArray<ASTREF(BfExpression*)>& valueExprs, const BfSizedArray<ASTREF(BfTokenNode*)>& commas, BfTokenNode* closeToken)
 		{
 			SizedArray<BfIRValue, 8> members;
 
@@ -15525,9 +15525,9 @@ void BfExprEvaluator::InitializedSizedArray(BfSizedArrayType* arrayType, BfToken
 					else if (auto parenExpr = BfNodeDynCast<BfParenthesizedExpression>(expr))
 					{
 						depth++;
-						SizedArray<BfExpression*, 1> values;
+						SizedArray<ASTREF(BfExpression*), 1> values;
 						values.Add(parenExpr->mExpression);
-						SizedArray<BfTokenNode*, 1> commas;
+						SizedArray<ASTREF(BfTokenNode*), 1> commas;
 						members.push_back(_CreateConstArray(checkArrayType->mElementType, parenExpr->mOpenParen, values, commas, parenExpr->mCloseParen));
 						depth--;
 						continue;
@@ -15850,7 +15850,7 @@ BfTypedValue BfExprEvaluator::SetupNullConditional(BfTypedValue thisValue, BfTok
 
 void BfExprEvaluator::CheckDotToken(BfTokenNode* tokenNode)
 {
-	if ((tokenNode != NULL) && (tokenNode->mToken == BfToken_DotDot))
+	if ((tokenNode != NULL) && (tokenNode->GetToken() == BfToken_DotDot))
 		mModule->Fail("Unexpected cascade operation. Chaining can only be used for method invocations", tokenNode);
 }
 
@@ -17015,13 +17015,13 @@ void BfExprEvaluator::PerformUnaryOperation_OnResult(BfExpression* unaryOpExpr,
 		{
 			mModule->Fail(
 				StrFormat("Operator '%s' cannot be used on interface '%s'. Consider rewriting using generics and use this interface as a generic constraint.",
-					BfTokenToString(opToken->mToken), mModule->TypeToString(mResult.mType).c_str()), opToken);
+					BfTokenToString(opToken->GetToken()), mModule->TypeToString(mResult.mType).c_str()), opToken);
 		}
 		else
 		{
 			mModule->Fail(
 				StrFormat("Operator '%s' cannot be used because type '%s' is neither a numeric type nor does it define an applicable operator overload",
-					BfTokenToString(opToken->mToken), mModule->TypeToString(mResult.mType).c_str()), opToken);
+					BfTokenToString(opToken->GetToken()), mModule->TypeToString(mResult.mType).c_str()), opToken);
 		}
 		mResult = BfTypedValue();
 	}
@@ -61,8 +61,8 @@ struct BfResolvedArgs
 {
 	SizedArray<BfResolvedArg, 4> mResolvedArgs;	
 	BfTokenNode* mOpenToken;
-	const BfSizedArray<BfExpression*>* mArguments;
-	const BfSizedArray<BfTokenNode*>* mCommas;	
+	const BfSizedArray<ASTREF(BfExpression*)>* mArguments;
+	const BfSizedArray<ASTREF(BfTokenNode*)>* mCommas;	
 	BfTokenNode* mCloseToken;
 
 public:
@@ -74,7 +74,7 @@ public:
 		mCloseToken = NULL;
 	}
 
-	BfResolvedArgs(BfSizedArray<BfExpression*>* args)
+	BfResolvedArgs(BfSizedArray<ASTREF(BfExpression*)>* args)
 	{
 		mOpenToken = NULL;
 		mArguments = args;
@@ -82,7 +82,7 @@ public:
 		mCloseToken = NULL;
 	}
 
-	BfResolvedArgs(BfTokenNode* openToken, BfSizedArray<BfExpression*>* args, BfSizedArray<BfTokenNode*>* commas, BfTokenNode* closeToken)
+	BfResolvedArgs(BfTokenNode* openToken, BfSizedArray<ASTREF(BfExpression*)>* args, BfSizedArray<ASTREF(BfTokenNode*)>* commas, BfTokenNode* closeToken)
 	{
 		mOpenToken = openToken;
 		mArguments = args;
@@ -90,7 +90,7 @@ public:
 		mCloseToken = closeToken;
 	}
 
-	void Init(const BfSizedArray<BfExpression*>* args)
+	void Init(const BfSizedArray<ASTREF(BfExpression*)>* args)
 	{
 		mOpenToken = NULL;
 		mArguments = args;
@@ -372,10 +372,10 @@ public:
 	BfModuleMethodInstance GetSelectedMethod(BfAstNode* targetSrc, BfTypeInstance* curTypeInst, BfMethodDef* methodDef, BfMethodMatcher& methodMatcher);
 	bool CheckVariableDeclaration(BfAstNode* checkNode, bool requireSimpleIfExpr, bool exprMustBeTrue, bool silentFail);
 	bool HasVariableDeclaration(BfAstNode* checkNode);
-	void DoInvocation(BfAstNode* target, BfMethodBoundExpression* methodBoundExpr, const BfSizedArray<BfExpression*>& args, BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArgs, BfTypedValue* outCascadeValue = NULL);	
+	void DoInvocation(BfAstNode* target, BfMethodBoundExpression* methodBoundExpr, const BfSizedArray<ASTREF(BfExpression*)>& args, BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArgs, BfTypedValue* outCascadeValue = NULL);	
 	int GetMixinVariable();	
 	void CheckLocalMethods(BfAstNode* targetSrc, BfTypeInstance* typeInstance, const StringImpl& methodName, BfMethodMatcher& methodMatcher, BfMethodType methodType);
-	void InjectMixin(BfAstNode* targetSrc, BfTypedValue target, bool allowImplicitThis, const StringImpl& name, const BfSizedArray<BfExpression*>& arguments, BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArgs);
+	void InjectMixin(BfAstNode* targetSrc, BfTypedValue target, bool allowImplicitThis, const StringImpl& name, const BfSizedArray<ASTREF(BfExpression*)>& arguments, BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArgs);
 	void SetMethodElementType(BfAstNode* target);
 	BfTypedValue DoImplicitArgCapture(BfAstNode* refNode, BfIdentifierNode* identifierNode);
 	BfTypedValue DoImplicitArgCapture(BfAstNode* refNode, BfMethodInstance* methodInstance, int paramIdx, bool& failed, BfImplicitParamKind paramKind = BfImplicitParamKind_General, const BfTypedValue& methodRefTarget = BfTypedValue());
@@ -383,7 +383,7 @@ public:
 	bool IsExactMethodMatch(BfMethodInstance* methodA, BfMethodInstance* methodB, bool ignoreImplicitParams = false);		
 	BfTypeInstance* VerifyBaseDelegateType(BfTypeInstance* delegateType);	
 	void ConstResolve(BfExpression* expr);
-	void ProcessArrayInitializer(BfTokenNode* openToken, const BfSizedArray<BfExpression*>& values, const BfSizedArray<BfTokenNode*>& commas, BfTokenNode* closeToken, int dimensions, SizedArrayImpl<int64>& dimLengths, int dim, bool& hasFailed);
+	void ProcessArrayInitializer(BfTokenNode* openToken, const BfSizedArray<ASTREF(BfExpression*)>& values, const BfSizedArray<ASTREF(BfTokenNode*)>& commas, BfTokenNode* closeToken, int dimensions, SizedArrayImpl<int64>& dimLengths, int dim, bool& hasFailed);
 	BfLambdaInstance* GetLambdaInstance(BfLambdaBindExpression* lambdaBindExpr, BfAllocTarget& allocTarget);
 	void VisitLambdaBodies(BfAstNode* body, BfFieldDtorDeclaration* fieldDtor);	
 	void FixitAddMember(BfTypeInstance* typeInst, BfType* fieldType, const StringImpl& fieldName, bool isStatic);	
@@ -397,7 +397,7 @@ public:
 	bool LookupTypeProp(BfTypeOfExpression* typeOfExpr, BfIdentifierNode* propName);
 	void DoTypeIntAttr(BfTypeReference* typeRef, BfToken token);
 	//void InitializedSizedArray(BfTupleExpression* createExpr, BfSizedArrayType* arrayType);
-	void InitializedSizedArray(BfSizedArrayType* sizedArrayType, BfTokenNode* openToken, const BfSizedArray<BfExpression*>& values, const BfSizedArray<BfTokenNode*>& commas, BfTokenNode* closeToken, BfTypedValue* receivingValue = NULL);
+	void InitializedSizedArray(BfSizedArrayType* sizedArrayType, BfTokenNode* openToken, const BfSizedArray<ASTREF(BfExpression*)>& values, const BfSizedArray<ASTREF(BfTokenNode*)>& commas, BfTokenNode* closeToken, BfTypedValue* receivingValue = NULL);
 	void CheckDotToken(BfTokenNode* tokenNode);
 	void DoMemberReference(BfMemberReferenceExpression* memberRefExpr, BfTypedValue* outCascadeValue);
 
@@ -100,7 +100,14 @@
 #include "llvm/MC/MCCodeEmitter.h"
 #include "llvm/Support/TargetRegistry.h"
 
+#include "llvm/LTO/LTO.h"
+#include "llvm/LTO/Caching.h"
 #include "llvm/LTO/LTOBackend.h"
+#include "llvm/BinaryFormat/Magic.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Path.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
@@ -3564,6 +3571,31 @@ static void AddFunctionSimplificationPasses(llvm::legacy::PassManagerBase &MPM,
 // 		MPM.add(createControlHeightReductionLegacyPass());
 }
 
+// Mirrors PassManagerBuilder::addPGOInstrPasses, minus the pre-inliner
+static void AddPGOInstrPasses(llvm::legacy::PassManagerBase &MPM, const BfCodeGenOptions& options)
+{
+	if (options.mPGOKind == BfPGOKind_None)
+		return;
+
+	if (options.mPGOKind == BfPGOKind_Instrument)
+	{
+		MPM.add(llvm::createPGOInstrumentationGenLegacyPass());
+		// Add the profile lowering pass.
+		llvm::InstrProfOptions instrProfOptions;
+		if (!options.mPGOProfilePath.IsEmpty())
+			instrProfOptions.InstrProfileOutput = options.mPGOProfilePath.c_str();
+		instrProfOptions.DoCounterPromotion = true;
+		MPM.add(llvm::createLoopRotatePass());
+		MPM.add(llvm::createInstrProfilingLegacyPass(instrProfOptions));
+	}
+	else if (options.mPGOKind == BfPGOKind_Use)
+		MPM.add(llvm::createPGOInstrumentationUseLegacyPass(options.mPGOProfilePath.c_str()));
+
+	// Indirect call promotion that promotes intra-module targets only.
+	if (GetOptLevel(options.mOptLevel) > 0)
+		MPM.add(llvm::createPGOIndirectCallPromotionLegacyPass(false, false));
+}
+
 static void PopulateModulePassManager(llvm::legacy::PassManagerBase &MPM, const BfCodeGenOptions& options)
 {
 // 	if (!PGOSampleUse.empty()) {
@@ -3572,8 +3604,8 @@ static void PopulateModulePassManager(llvm::legacy::PassManagerBase &MPM, const
 // 	}
 	llvm::Pass* Inliner = NULL;
 	bool prepareForLTO = false;
-	bool prepareForThinLTO = options.mLTOType == BfLTOType_Thin;
-	bool performThinLTO = false;
+	bool prepareForThinLTO = options.mLTOType != BfLTOType_None;
+	bool performThinLTO = false; // The backend half of ThinLTO runs inside llvm::lto::LTO, see BfIRCodeGen::ThinLink
 	bool enableNonLTOGlobalsModRef = false;
 
 	// Allow forcing function attributes as a debugging and tuning aid.
@@ -3582,7 +3614,7 @@ static void PopulateModulePassManager(llvm::legacy::PassManagerBase &MPM, const
 	// If all optimizations are disabled, just run the always-inline pass and,
 	// if enabled, the function merging pass.
 	if (GetOptLevel(options.mOptLevel) == 0) {
-		//addPGOInstrPasses(MPM);
+		AddPGOInstrPasses(MPM, options);
 		if (Inliner) {
 			MPM.add(Inliner);
 			Inliner = nullptr;
@@ -3673,8 +3705,8 @@ static void PopulateModulePassManager(llvm::legacy::PassManagerBase &MPM, const
 	// profile annotation in backend more difficult.
 	// PGO instrumentation is added during the compile phase for ThinLTO, do
 	// not run it a second time
-// 	if (!performThinLTO && !prepareForThinLTOUsingPGOSampleProfile)
-// 		llvm::addPGOInstrPasses(MPM);
+	if (!performThinLTO && !prepareForThinLTOUsingPGOSampleProfile)
+		AddPGOInstrPasses(MPM, options);
 
 	// We add a module alias analysis pass here. In part due to bugs in the
 	// analysis infrastructure this "works" in that the analysis stays alive
@@ -3962,6 +3994,44 @@ llvm::Expected<llvm::BitcodeModule> FindThinLTOModule(llvm::MemoryBufferRef MBRe
 		llvm::inconvertibleErrorCode());
 }
 
+static llvm::CodeGenOpt::Level GetCodeGenOptLevel(const BfCodeGenOptions& codeGenOptions)
+{
+	if (codeGenOptions.mOptLevel == BfOptLevel_O2)
+		return llvm::CodeGenOpt::Default;
+	if (codeGenOptions.mOptLevel == BfOptLevel_O3)
+		return llvm::CodeGenOpt::Aggressive;
+	return llvm::CodeGenOpt::None;
+}
+
+static String GetTargetFeatures(const BfCodeGenOptions& codeGenOptions)
+{
+	switch (codeGenOptions.mSIMDSetting)
+	{
+	case BfSIMDSetting_SSE: return "+sse";
+	case BfSIMDSetting_SSE2: return "+sse2";
+	case BfSIMDSetting_SSE3: return "+sse3";
+	case BfSIMDSetting_SSE4: return "+sse4";
+	case BfSIMDSetting_SSE41: return "+sse4.1";
+	case BfSIMDSetting_AVX: return "+avx";
+	case BfSIMDSetting_AVX2: return "+avx2";
+	default: return "";
+	}
+}
+
+static llvm::Optional<llvm::Reloc::Model> GetRelocModel(const BfCodeGenOptions& codeGenOptions)
+{
+	switch (codeGenOptions.mRelocType)
+	{
+	case BfRelocType_Static: return llvm::Reloc::Model::DynamicNoPIC;
+	case BfRelocType_PIC: return llvm::Reloc::Model::PIC_;
+	case BfRelocType_DynamicNoPIC: return llvm::Reloc::Model::DynamicNoPIC;
+	case BfRelocType_ROPI: return llvm::Reloc::Model::ROPI;
+	case BfRelocType_RWPI: return llvm::Reloc::Model::RWPI;
+	case BfRelocType_ROPI_RWPI: return llvm::Reloc::Model::ROPI_RWPI;
+	default: return llvm::None;
+	}
+}
+
 bool BfIRCodeGen::WriteObjectFile(const StringImpl& outFileName, const BfCodeGenOptions& codeGenOptions)
 {
 	// 	{
@@ -3983,7 +4053,7 @@ bool BfIRCodeGen::WriteObjectFile(const StringImpl& outFileName, const BfCodeGen
 		}
 	}
 
-	llvm::CodeGenOpt::Level optLvl = llvm::CodeGenOpt::None;
+	llvm::CodeGenOpt::Level optLvl = GetCodeGenOptLevel(codeGenOptions);
 
 	llvm::SMDiagnostic Err;
 	llvm::Triple theTriple;
@@ -4004,58 +4074,11 @@ bool BfIRCodeGen::WriteObjectFile(const StringImpl& outFileName, const BfCodeGen
 
 	llvm::TargetOptions Options = llvm::TargetOptions(); // InitTargetOptionsFromCodeGenFlags();
 
-	String featuresStr;
+	String featuresStr = GetTargetFeatures(codeGenOptions);
 
-	if (codeGenOptions.mOptLevel == BfOptLevel_O1)
-	{
-		//optLvl = CodeGenOpt::Less;
-	}
-	else if (codeGenOptions.mOptLevel == BfOptLevel_O2)
-		optLvl = llvm::CodeGenOpt::Default;
-	else if (codeGenOptions.mOptLevel == BfOptLevel_O3)
-		optLvl = llvm::CodeGenOpt::Aggressive;
-
-	if (codeGenOptions.mSIMDSetting == BfSIMDSetting_SSE)
-		featuresStr = "+sse";
-	else if (codeGenOptions.mSIMDSetting == BfSIMDSetting_SSE2)
-		featuresStr = "+sse2";
-	else if (codeGenOptions.mSIMDSetting == BfSIMDSetting_SSE3)
-		featuresStr = "+sse3";
-	else if (codeGenOptions.mSIMDSetting == BfSIMDSetting_SSE4)
-		featuresStr = "+sse4";
-	else if (codeGenOptions.mSIMDSetting == BfSIMDSetting_SSE41)
-		featuresStr = "+sse4.1";
-	else if (codeGenOptions.mSIMDSetting == BfSIMDSetting_AVX)
-		featuresStr = "+avx";
-	else if (codeGenOptions.mSIMDSetting == BfSIMDSetting_AVX2)
-		featuresStr = "+avx2";
-
-	llvm::Optional<llvm::Reloc::Model> relocModel;
+	llvm::Optional<llvm::Reloc::Model> relocModel = GetRelocModel(codeGenOptions);
 	llvm::CodeModel::Model cmModel = llvm::CodeModel::Small;
 
-	switch (codeGenOptions.mRelocType)
-	{
-	case BfRelocType_Static:
-		relocModel = llvm::Reloc::Model::DynamicNoPIC;
-		break;
-	case BfRelocType_PIC:
-		relocModel = llvm::Reloc::Model::PIC_;
-		break;
-	case BfRelocType_DynamicNoPIC:
-		relocModel = llvm::Reloc::Model::DynamicNoPIC;
-		break;
-	case BfRelocType_ROPI:
-		relocModel = llvm::Reloc::Model::ROPI;
-		break;
-	case BfRelocType_RWPI:
-		relocModel = llvm::Reloc::Model::RWPI;
-		break;
-	case BfRelocType_ROPI_RWPI:
-		relocModel = llvm::Reloc::Model::ROPI_RWPI;
-		break;
-	default: break;
-	}
-
 	switch (codeGenOptions.mPICLevel)
 	{
 	case BfPICLevel_Not:
@@ -4180,6 +4203,187 @@ bool BfIRCodeGen::WriteIR(const StringImpl& outFileName, StringImpl& error)
 	return true;
 }
 
+bool BfIRCodeGen::ThinLink(const Array<String>& inputFileNames, const StringImpl& outputDir, const StringImpl& cacheDir, const BfCodeGenOptions& codeGenOptions,
+	bool isDynLib, int threadCount, Array<String>& outputFileNames, StringImpl& error)
+{
+	BP_ZONE("BfIRCodeGen::ThinLink");
+
+	CritSect errorCritSect;
+	String backendErrors;
+	auto _AddBackendError = [&](const StringImpl& errorStr)
+	{
+		AutoCrit autoCrit(errorCritSect);
+		if (!backendErrors.IsEmpty())
+			backendErrors += "\n";
+		backendErrors += errorStr;
+	};
+
+	llvm::lto::Config conf;
+	String featuresStr = GetTargetFeatures(codeGenOptions);
+	if (!featuresStr.IsEmpty())
+		conf.MAttrs.push_back(featuresStr.c_str());
+	conf.RelocModel = GetRelocModel(codeGenOptions);
+	conf.CodeModel = llvm::CodeModel::Small;
+	conf.CGOptLevel = GetCodeGenOptLevel(codeGenOptions);
+	conf.OptLevel = GetOptLevel(codeGenOptions.mOptLevel);
+	conf.DiagHandler = [&](const llvm::DiagnosticInfo& diagInfo)
+	{
+		if (diagInfo.getSeverity() != llvm::DS_Error)
+			return;
+		std::string msg;
+		llvm::raw_string_ostream msgStream(msg);
+		llvm::DiagnosticPrinterRawOStream diagPrinter(msgStream);
+		diagInfo.print(diagPrinter);
+		msgStream.flush();
+		_AddBackendError(msg.c_str());
+	};
+
+	llvm::lto::LTO lto(std::move(conf), llvm::lto::createInProcessThinBackend(BF_MAX(threadCount, 1)));
+
+	outputFileNames.Clear();
+	std::vector<std::unique_ptr<llvm::MemoryBuffer>> inputBuffers;
+	Array<int> thinInputIndices; // ThinLTO task N is the input at thinInputIndices[N - 1], task 0 is the regular LTO partition
+	HashSet<String> definedSymbols;
+
+	for (int inputIdx = 0; inputIdx < (int)inputFileNames.size(); inputIdx++)
+	{
+		auto& inputFileName = inputFileNames[inputIdx];
+		outputFileNames.Add(inputFileName);
+
+		auto bufferOrErr = llvm::MemoryBuffer::getFile(inputFileName.c_str());
+		if (!bufferOrErr)
+		{
+			error = StrFormat("Failed to read '%s': %s", inputFileName.c_str(), bufferOrErr.getError().message().c_str());
+			return false;
+		}
+
+		// Objects that were written without LTO (ie: vdata) go to the linker as-is
+		if (llvm::identify_magic((*bufferOrErr)->getBuffer()) != llvm::file_magic::bitcode)
+			continue;
+
+		auto inputOrErr = llvm::lto::InputFile::create((*bufferOrErr)->getMemBufferRef());
+		if (!inputOrErr)
+		{
+			error = StrFormat("Failed to load bitcode '%s': %s", inputFileName.c_str(), llvm::toString(inputOrErr.takeError()).c_str());
+			return false;
+		}
+
+		std::vector<llvm::lto::SymbolResolution> resolutions;
+		for (auto& sym : (*inputOrErr)->symbols())
+		{
+			llvm::lto::SymbolResolution resolution;
+			// The first definition wins, like the linker would pick for our linkonce_odr symbols
+			if (!sym.isUndefined())
+				resolution.Prevailing = definedSymbols.Add(String(sym.getName().data(), (int)sym.getName().size()));
+			// We don't know what the native objects and runtime libraries reference, so nothing gets internalized
+			resolution.VisibleToRegularObj = true;
+			resolution.FinalDefinitionInLinkageUnit = resolution.Prevailing && !isDynLib;
+			resolutions.push_back(resolution);
+		}
+
+		if (auto err = lto.add(std::move(*inputOrErr), resolutions))
+		{
+			error = StrFormat("Failed to add '%s' to the thin link: %s", inputFileName.c_str(), llvm::toString(std::move(err)).c_str());
+			return false;
+		}
+
+		inputBuffers.push_back(std::move(*bufferOrErr));
+		thinInputIndices.Add(inputIdx);
+	}
+
+	if (thinInputIndices.IsEmpty())
+		return true;
+
+	if (auto ec = llvm::sys::fs::create_directories(outputDir.c_str()))
+	{
+		error = StrFormat("Failed to create directory '%s': %s", outputDir.c_str(), ec.message().c_str());
+		return false;
+	}
+
+	auto _GetTaskFileName = [&](unsigned task)
+	{
+		if (task == 0)
+			return String(outputDir) + "/lto_regular" BF_OBJ_EXT;
+		// Inputs can come from several projects' output dirs, so the full path is folded into the name to keep
+		//  same-named modules from overwriting each other
+		auto& inputFileName = inputFileNames[thinInputIndices[task - 1]];
+		String fileName = GetFileName(inputFileName);
+		int dotPos = (int)fileName.LastIndexOf('.');
+		if (dotPos != -1)
+			fileName.RemoveToEnd(dotPos);
+		return String(outputDir) + "/" + fileName + StrFormat("_%016llX", (unsigned long long)Hash64(inputFileName.c_str(), (int)inputFileName.length())) + BF_OBJ_EXT;
+	};
+
+	// Each task only touches its own entry so the backend threads don't need to lock this
+	Array<uint8> taskWritten;
+	taskWritten.Resize(lto.getMaxTasks());
+
+	auto _AddStream = [&](unsigned task) -> std::unique_ptr<llvm::lto::NativeObjectStream>
+	{
+		String fileName = _GetTaskFileName(task);
+		std::error_code ec;
+		auto outStream = llvm::make_unique<llvm::raw_fd_ostream>(fileName.c_str(), ec, llvm::sys::fs::F_None);
+		if (ec)
+		{
+			// AddStreamFn has no way to return an error here, so the task's output is discarded and the error fails the
+			//  link once lto.run returns
+			_AddBackendError(StrFormat("Failed to write '%s': %s", fileName.c_str(), ec.message().c_str()));
+			return llvm::make_unique<llvm::lto::NativeObjectStream>(llvm::make_unique<llvm::raw_null_ostream>());
+		}
+		taskWritten[task] = 1;
+		return llvm::make_unique<llvm::lto::NativeObjectStream>(std::move(outStream));
+	};
+
+	// Called for cache hits, and for cache misses once the backend's output has been committed to the cache
+	auto _AddBuffer = [&](unsigned task, std::unique_ptr<llvm::MemoryBuffer> buffer)
+	{
+		String fileName = _GetTaskFileName(task);
+		std::error_code ec;
+		llvm::raw_fd_ostream outStream(fileName.c_str(), ec, llvm::sys::fs::F_None);
+		if (ec)
+		{
+			_AddBackendError(StrFormat("Failed to write '%s': %s", fileName.c_str(), ec.message().c_str()));
+			return;
+		}
+		outStream << buffer->getBuffer();
+		taskWritten[task] = 1;
+	};
+
+	llvm::lto::NativeObjectCache cache;
+	if (!cacheDir.IsEmpty())
+	{
+		auto cacheOrErr = llvm::lto::localCache(cacheDir.c_str(), _AddBuffer);
+		if (!cacheOrErr)
+		{
+			error = StrFormat("Failed to open ThinLTO cache '%s': %s", cacheDir.c_str(), llvm::toString(cacheOrErr.takeError()).c_str());
+			return false;
+		}
+		cache = std::move(*cacheOrErr);
+	}
+
+	if (auto err = lto.run(_AddStream, cache))
+		_AddBackendError(llvm::toString(std::move(err)).c_str());
+
+	if (!backendErrors.IsEmpty())
+	{
+		error = backendErrors;
+		return false;
+	}
+
+	if (!cacheDir.IsEmpty())
+		llvm::pruneCache(cacheDir.c_str(), llvm::CachePruningPolicy());
+
+	for (int task = 1; task < (int)taskWritten.size(); task++)
+	{
+		if ((taskWritten[task] != 0) && (task - 1 < (int)thinInputIndices.size()))
+			outputFileNames[thinInputIndices[task - 1]] = _GetTaskFileName(task);
+	}
+	if (taskWritten[0] != 0)
+		outputFileNames.Add(_GetTaskFileName(0));
+
+	return true;
+}
+
 int BfIRCodeGen::GetIntrinsicId(const StringImpl& name)
 {
 // 	llvm::Intrinsic::ID intrin = llvm::Intrinsic::getIntrinsicForGCCBuiltin("x86", name.c_str());
@@ -149,6 +149,11 @@ public:
 	bool WriteObjectFile(const StringImpl& outFileName, const BfCodeGenOptions& codeGenOptions);
 	bool WriteIR(const StringImpl& outFileName, StringImpl& error);
 
+	// Runs the thin link and the ThinLTO backends over a link's objects. outputFileNames gets the native object to link for
+	//  each input, plus the regular LTO partition when one was emitted.
+	static bool ThinLink(const Array<String>& inputFileNames, const StringImpl& outputDir, const StringImpl& cacheDir, const BfCodeGenOptions& codeGenOptions,
+		bool isDynLib, int threadCount, Array<String>& outputFileNames, StringImpl& error);
+
 	static int GetIntrinsicId(const StringImpl& name);	
 	static const char* GetIntrinsicName(int intrinId);
 	static void SetAsmKind(BfAsmKind asmKind);
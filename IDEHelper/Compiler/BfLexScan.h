@@ -0,0 +1,184 @@
+#pragma once
+
+#include "BeefySysLib/Common.h"
+
+// Vectorized character-class scans for the lexer's hot loops. Every scan stops on a '\0', so the
+//  source must be null-terminated. Blocks are loaded from aligned addresses, which can read up to a
+//  block past the terminator but never crosses into another page.
+//  Define BF_LEXSCAN_NO_SIMD to force the scalar versions (ie: for benchmark comparisons).
+
+#if !defined BF_LEXSCAN_NO_SIMD
+#if defined __AVX2__
+#define BF_LEXSCAN_AVX2
+#include <immintrin.h>
+#elif (defined __SSE2__) || (defined _M_X64) || ((defined _M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BF_LEXSCAN_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+NS_BF_BEGIN
+
+#if defined BF_LEXSCAN_AVX2 || defined BF_LEXSCAN_SSE2
+
+#ifdef BF_LEXSCAN_AVX2
+#define BF_LEXSCAN_BLOCK_SIZE 32
+typedef __m256i BfLexScanVec;
+static inline BfLexScanVec BfLexScan_Load(const char* ptr) { return _mm256_load_si256((const __m256i*)ptr); }
+static inline BfLexScanVec BfLexScan_Splat(char c) { return _mm256_set1_epi8(c); }
+static inline BfLexScanVec BfLexScan_Eq(BfLexScanVec a, BfLexScanVec b) { return _mm256_cmpeq_epi8(a, b); }
+static inline BfLexScanVec BfLexScan_Gt(BfLexScanVec a, BfLexScanVec b) { return _mm256_cmpgt_epi8(a, b); }
+static inline BfLexScanVec BfLexScan_Or(BfLexScanVec a, BfLexScanVec b) { return _mm256_or_si256(a, b); }
+static inline BfLexScanVec BfLexScan_And(BfLexScanVec a, BfLexScanVec b) { return _mm256_and_si256(a, b); }
+static inline uint32 BfLexScan_Mask(BfLexScanVec a) { return (uint32)_mm256_movemask_epi8(a); }
+#else
+#define BF_LEXSCAN_BLOCK_SIZE 16
+typedef __m128i BfLexScanVec;
+static inline BfLexScanVec BfLexScan_Load(const char* ptr) { return _mm_load_si128((const __m128i*)ptr); }
+static inline BfLexScanVec BfLexScan_Splat(char c) { return _mm_set1_epi8(c); }
+static inline BfLexScanVec BfLexScan_Eq(BfLexScanVec a, BfLexScanVec b) { return _mm_cmpeq_epi8(a, b); }
+static inline BfLexScanVec BfLexScan_Gt(BfLexScanVec a, BfLexScanVec b) { return _mm_cmpgt_epi8(a, b); }
+static inline BfLexScanVec BfLexScan_Or(BfLexScanVec a, BfLexScanVec b) { return _mm_or_si128(a, b); }
+static inline BfLexScanVec BfLexScan_And(BfLexScanVec a, BfLexScanVec b) { return _mm_and_si128(a, b); }
+static inline uint32 BfLexScan_Mask(BfLexScanVec a) { return (uint32)_mm_movemask_epi8(a); }
+#endif
+
+static inline int BfLexScan_LowestBit(uint32 mask)
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanForward(&idx, mask);
+	return (int)idx;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// 'lo' <= c <= 'hi' for ASCII bounds. Bytes >= 0x80 are negative as signed chars so they never match.
+static inline BfLexScanVec BfLexScan_InRange(BfLexScanVec v, char lo, char hi)
+{
+	return BfLexScan_And(BfLexScan_Gt(v, BfLexScan_Splat(lo - 1)), BfLexScan_Gt(BfLexScan_Splat(hi + 1), v));
+}
+
+// Returns a pointer to the first char at or after 'ptr' whose lane is set in stopFunc's mask
+template <typename TStopFunc>
+static inline const char* BfLexScan_Find(const char* ptr, TStopFunc stopFunc)
+{
+	const uint32 blockMask = (BF_LEXSCAN_BLOCK_SIZE == 32) ? 0xFFFFFFFF : 0xFFFF;
+	int misalign = (int)((uintptr)ptr & (BF_LEXSCAN_BLOCK_SIZE - 1));
+	const char* blockPtr = ptr - misalign;
+	uint32 stopMask = BfLexScan_Mask(stopFunc(BfLexScan_Load(blockPtr))) & ((blockMask << misalign) & blockMask);
+	while (stopMask == 0)
+	{
+		blockPtr += BF_LEXSCAN_BLOCK_SIZE;
+		stopMask = BfLexScan_Mask(stopFunc(BfLexScan_Load(blockPtr))) & blockMask;
+	}
+	return blockPtr + BfLexScan_LowestBit(stopMask);
+}
+
+// Skips ' ', '\t' and '\r'. Newlines are left for the lexer since it needs to track line starts.
+static inline const char* BfLexScan_SkipBlanks(const char* ptr)
+{
+	return BfLexScan_Find(ptr, [](BfLexScanVec v)
+		{
+			BfLexScanVec isBlank = BfLexScan_Or(BfLexScan_Or(BfLexScan_Eq(v, BfLexScan_Splat(' ')), BfLexScan_Eq(v, BfLexScan_Splat('\t'))), BfLexScan_Eq(v, BfLexScan_Splat('\r')));
+			return BfLexScan_Eq(isBlank, BfLexScan_Splat(0)); // Inverted
+		});
+}
+
+// Skips [A-Za-z0-9_]. Other identifier chars (UTF8, compat-mode chars) are left for the lexer to classify.
+static inline const char* BfLexScan_SkipIdentChars(const char* ptr)
+{
+	return BfLexScan_Find(ptr, [](BfLexScanVec v)
+		{
+			BfLexScanVec lower = BfLexScan_Or(v, BfLexScan_Splat(0x20)); // Fold 'A'-'Z' into 'a'-'z'
+			BfLexScanVec isIdent = BfLexScan_Or(BfLexScan_Or(BfLexScan_InRange(lower, 'a', 'z'), BfLexScan_InRange(v, '0', '9')), BfLexScan_Eq(v, BfLexScan_Splat('_')));
+			return BfLexScan_Eq(isIdent, BfLexScan_Splat(0)); // Inverted
+		});
+}
+
+// Finds '\n' or '\0', the end of a line comment
+static inline const char* BfLexScan_FindLineEnd(const char* ptr)
+{
+	return BfLexScan_Find(ptr, [](BfLexScanVec v)
+		{
+			return BfLexScan_Or(BfLexScan_Eq(v, BfLexScan_Splat('\n')), BfLexScan_Eq(v, BfLexScan_Splat(0)));
+		});
+}
+
+// Finds the next char inside a block comment that could end it, nest it, or start a new line
+static inline const char* BfLexScan_FindBlockCommentChar(const char* ptr)
+{
+	return BfLexScan_Find(ptr, [](BfLexScanVec v)
+		{
+			return BfLexScan_Or(BfLexScan_Or(BfLexScan_Eq(v, BfLexScan_Splat('\n')), BfLexScan_Eq(v, BfLexScan_Splat(0))),
+				BfLexScan_Or(BfLexScan_Eq(v, BfLexScan_Splat('*')), BfLexScan_Eq(v, BfLexScan_Splat('/'))));
+		});
+}
+
+// Finds the next char inside a string or char literal that isn't copied through verbatim
+static inline const char* BfLexScan_FindStringChar(const char* ptr)
+{
+	return BfLexScan_Find(ptr, [](BfLexScanVec v)
+		{
+			return BfLexScan_Or(BfLexScan_Or(BfLexScan_Eq(v, BfLexScan_Splat('\n')), BfLexScan_Eq(v, BfLexScan_Splat(0))),
+				BfLexScan_Or(BfLexScan_Or(BfLexScan_Eq(v, BfLexScan_Splat('"')), BfLexScan_Eq(v, BfLexScan_Splat('\''))), BfLexScan_Eq(v, BfLexScan_Splat('\\'))));
+		});
+}
+
+#else
+
+static inline const char* BfLexScan_SkipBlanks(const char* ptr)
+{
+	while ((*ptr == ' ') || (*ptr == '\t') || (*ptr == '\r'))
+		ptr++;
+	return ptr;
+}
+
+static inline const char* BfLexScan_SkipIdentChars(const char* ptr)
+{
+	while (true)
+	{
+		char c = *ptr;
+		if (!(((c >= 'A') && (c <= 'Z')) || ((c >= 'a') && (c <= 'z')) || ((c >= '0') && (c <= '9')) || (c == '_')))
+			return ptr;
+		ptr++;
+	}
+}
+
+static inline const char* BfLexScan_FindLineEnd(const char* ptr)
+{
+	while ((*ptr != '\n') && (*ptr != 0))
+		ptr++;
+	return ptr;
+}
+
+static inline const char* BfLexScan_FindBlockCommentChar(const char* ptr)
+{
+	while (true)
+	{
+		char c = *ptr;
+		if ((c == '\n') || (c == 0) || (c == '*') || (c == '/'))
+			return ptr;
+		ptr++;
+	}
+}
+
+static inline const char* BfLexScan_FindStringChar(const char* ptr)
+{
+	while (true)
+	{
+		char c = *ptr;
+		if ((c == '\n') || (c == 0) || (c == '"') || (c == '\'') || (c == '\\'))
+			return ptr;
+		ptr++;
+	}
+}
+
+#endif
+
+NS_BF_END
@@ -1,6 +1,7 @@
 #include "BfMangler.h"
 #include "BfDemangler.h"
 #include "BfCompiler.h"
+#include "BeefySysLib/FileStream.h"
 #pragma warning(disable:4996)
 
 USING_NS_BF;
@@ -2158,28 +2159,105 @@ String BfSafeMangler::Mangle(BfType* type, BfModule* module)
 
 //////////////////////////////////////////////////////////////////////////
 
+// Symbols that are looked up by name from outside of Beef (C code, imports, exports, the runtime) must keep their full names
+static bool WantsShortSymbol(BfContext* context, const StringImpl& mangledName)
+{
+	auto& options = context->mCompiler->mOptions;
+	if ((!options.mShortSymbols) || (options.mAllowHotSwapping))
+		return false;
+	if (mangledName.length() <= 24)
+		return false;
+	return (mangledName.StartsWith("_Z")) || (mangledName.StartsWith("?"));
+}
+
 void BfMangler::Mangle(StringImpl& outStr, MangleKind mangleKind, BfType* type, BfModule* module)
 {
+	auto& cache = type->mContext->mMangledNameCache;
+	cache.CheckMangleKind(mangleKind);
+
+	String* namePtr = NULL;
+	if (cache.mTypeNames.TryGetValue(type, &namePtr))
+	{
+		cache.mHits++;
+		outStr += *namePtr;
+		return;
+	}
+	cache.mMisses++;
+
+	String name;
 	if (mangleKind == BfMangler::MangleKind_GNU)
-		outStr += BfGNUMangler::Mangle(type, module);
+		name = BfGNUMangler::Mangle(type, module);
 	else
-		BfMSMangler::Mangle(outStr, mangleKind == BfMangler::MangleKind_Microsoft_64, type, module);
+		BfMSMangler::Mangle(name, mangleKind == BfMangler::MangleKind_Microsoft_64, type, module);
+	// Mangling can recurse back into the cache, so don't hold an entry pointer across it
+	cache.mTypeNames[type] = name;
+	outStr += name;
 }
 
 void BfMangler::Mangle(StringImpl& outStr, MangleKind mangleKind, BfMethodInstance* methodInst)
 {
+	auto context = methodInst->GetOwner()->mContext;
+	auto& cache = context->mMangledNameCache;
+	cache.CheckMangleKind(mangleKind);
+
+	String* namePtr = NULL;
+	if (cache.mMethodNames.TryGetValue(methodInst, &namePtr))
+	{
+		cache.mHits++;
+		outStr += *namePtr;
+		return;
+	}
+	cache.mMisses++;
+
+	String name;
 	if (mangleKind == BfMangler::MangleKind_GNU)
-		outStr += BfGNUMangler::Mangle(methodInst);
+		name = BfGNUMangler::Mangle(methodInst);
 	else
-		BfMSMangler::Mangle(outStr, mangleKind == BfMangler::MangleKind_Microsoft_64, methodInst);
+		BfMSMangler::Mangle(name, mangleKind == BfMangler::MangleKind_Microsoft_64, methodInst);
+
+	auto methodDef = methodInst->mMethodDef;
+	if ((!methodDef->mIsExtern) && (!methodDef->mCLink) && (methodDef->mImportKind == BfImportKind_None) && (WantsShortSymbol(context, name)))
+		name = cache.GetShortSymbol(name);
+
+	cache.mMethodNames[methodInst] = name;
+	methodInst->mHasCachedMangledName = true;
+	outStr += name;
 }
 
 void BfMangler::Mangle(StringImpl& outStr, MangleKind mangleKind, BfFieldInstance* fieldInstance)
 {
+	auto owner = fieldInstance->mOwner;
+	auto context = owner->mContext;
+	auto& cache = context->mMangledNameCache;
+	cache.CheckMangleKind(mangleKind);
+
+	int fieldIdx = fieldInstance->mFieldIdx;
+	Array<String>* namesPtr = NULL;
+	if ((cache.mStaticFieldNames.TryGetValue(owner, &namesPtr)) && (fieldIdx < (int)namesPtr->size()) && (!(*namesPtr)[fieldIdx].IsEmpty()))
+	{
+		cache.mHits++;
+		outStr += (*namesPtr)[fieldIdx];
+		return;
+	}
+	cache.mMisses++;
+
+	String name;
 	if (mangleKind == BfMangler::MangleKind_GNU)
-		outStr += BfGNUMangler::MangleStaticFieldName(fieldInstance->mOwner, fieldInstance->GetFieldDef()->mName);
+		name = BfGNUMangler::MangleStaticFieldName(owner, fieldInstance->GetFieldDef()->mName);
 	else
-		BfMSMangler::Mangle(outStr, mangleKind == BfMangler::MangleKind_Microsoft_64, fieldInstance);
+		BfMSMangler::Mangle(name, mangleKind == BfMangler::MangleKind_Microsoft_64, fieldInstance);
+
+	if ((!fieldInstance->GetFieldDef()->mIsExtern) && (WantsShortSymbol(context, name)))
+		name = cache.GetShortSymbol(name);
+
+	if (fieldIdx >= 0)
+	{
+		auto& names = cache.mStaticFieldNames[owner];
+		if (fieldIdx >= (int)names.size())
+			names.Resize(fieldIdx + 1);
+		names[fieldIdx] = name;
+	}
+	outStr += name;
 }
 
 void BfMangler::MangleMethodName(StringImpl& outStr, MangleKind mangleKind, BfTypeInstance* type, const StringImpl& methodName)
@@ -2198,3 +2276,111 @@ void BfMangler::MangleStaticFieldName(StringImpl& outStr, MangleKind mangleKind,
 		BfMSMangler::MangleStaticFieldName(outStr, mangleKind == BfMangler::MangleKind_Microsoft_64, type, fieldName, fieldType);
 }
 
+//////////////////////////////////////////////////////////////////////////
+
+BfMangledNameCache::BfMangledNameCache()
+{
+	mMangleKind = BfMangler::MangleKind_GNU;
+	mShortSymbolMapLoaded = false;
+	mShortSymbolMapDirty = false;
+	mHits = 0;
+	mMisses = 0;
+}
+
+void BfMangledNameCache::CheckMangleKind(BfMangler::MangleKind mangleKind)
+{
+	if (mangleKind == mMangleKind)
+		return;
+	Clear();
+	mMangleKind = mangleKind;
+}
+
+void BfMangledNameCache::RemoveType(BfType* type)
+{
+	mTypeNames.Remove(type);
+	mStaticFieldNames.Remove(type);
+}
+
+void BfMangledNameCache::RemoveMethod(BfMethodInstance* methodInstance)
+{
+	mMethodNames.Remove(methodInstance);
+}
+
+void BfMangledNameCache::Clear()
+{
+	for (auto& kv : mMethodNames)
+		kv.mKey->mHasCachedMangledName = false;
+	mTypeNames.Clear();
+	mMethodNames.Clear();
+	mStaticFieldNames.Clear();
+}
+
+String BfMangledNameCache::GetShortSymbol(const StringImpl& mangledName)
+{
+	String shortName = "bf_";
+	shortName += HashEncode128(Hash128(mangledName.c_str(), (int)mangledName.length()));
+
+	String* fullNamePtr = NULL;
+	if (mShortSymbolMap.TryAdd(shortName, NULL, &fullNamePtr))
+	{
+		*fullNamePtr = mangledName;
+		mShortSymbolMapDirty = true;
+	}
+	else if (*fullNamePtr != mangledName)
+	{
+		// A 128-bit hash collision - keep the full name rather than produce a duplicate symbol
+		return mangledName;
+	}
+	return shortName;
+}
+
+// Writes the short symbol -> mangled name map used to demangle symbols in short symbol builds. Entries from
+//  previous runs are merged in since modules loaded from the build cache don't re-mangle their symbols.
+bool BfMangledNameCache::WriteShortSymbolMap(const StringImpl& path)
+{
+	if (!mShortSymbolMapLoaded)
+	{
+		mShortSymbolMapLoaded = true;
+		int length = 0;
+		char* data = LoadTextData(path, &length);
+		if (data != NULL)
+		{
+			for (auto line : StringView(data, length).Split('\n'))
+			{
+				int tabPos = (int)line.IndexOf('\t');
+				if (tabPos == -1)
+					continue;
+				String* fullNamePtr = NULL;
+				if (mShortSymbolMap.TryAdd(String(line.mPtr, tabPos), NULL, &fullNamePtr))
+					*fullNamePtr = String(line.mPtr + tabPos + 1, line.mLength - tabPos - 1);
+			}
+			delete [] data;
+			mShortSymbolMapDirty = true;
+		}
+	}
+
+	if (!mShortSymbolMapDirty)
+		return true;
+
+	FileStream fileStream;
+	if (!fileStream.Open(path, "wb"))
+		return false;
+	for (auto& kv : mShortSymbolMap)
+	{
+		fileStream.WriteSNZ(kv.mKey);
+		fileStream.Write((uint8)'\t');
+		fileStream.WriteSNZ(kv.mValue);
+		fileStream.Write((uint8)'\n');
+	}
+	fileStream.Close();
+	mShortSymbolMapDirty = false;
+	return true;
+}
+
+void BfMangledNameCache::ReportMemory(MemReporter* memReporter)
+{
+	memReporter->AddMap("TypeNames", mTypeNames, false);
+	memReporter->AddMap("MethodNames", mMethodNames, false);
+	memReporter->AddMap("StaticFieldNames", mStaticFieldNames, false);
+	memReporter->AddMap("ShortSymbolMap", mShortSymbolMap, false);
+}
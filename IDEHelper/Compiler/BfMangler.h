@@ -85,6 +85,34 @@ public:
 	static void MangleStaticFieldName(StringImpl& outStr, MangleKind mangleKind, BfTypeInstance* owner, const StringImpl& fieldName, BfType* fieldType = NULL);
 };
 
+// Mangled names are rebuilt from scratch on each Mangle call and can run to many kilobytes for nested generics, so
+//  each context keeps them for as long as the instances they were generated from are alive. Type entries and the static
+//  field names under them are dropped when the type is rebuilt or deleted, method entries when the method instance is deleted.
+class BfMangledNameCache
+{
+public:
+	BfMangler::MangleKind mMangleKind;
+	Dictionary<BfType*, String> mTypeNames;
+	Dictionary<BfMethodInstance*, String> mMethodNames;
+	Dictionary<BfType*, Array<String> > mStaticFieldNames; // Indexed by field idx, empty if not mangled yet
+	Dictionary<String, String> mShortSymbolMap; // Short symbol -> full mangled name
+	bool mShortSymbolMapLoaded;
+	bool mShortSymbolMapDirty;
+	int mHits;
+	int mMisses;
+
+public:
+	BfMangledNameCache();
+
+	void CheckMangleKind(BfMangler::MangleKind mangleKind);
+	void RemoveType(BfType* type);
+	void RemoveMethod(BfMethodInstance* methodInstance);
+	void Clear();
+	String GetShortSymbol(const StringImpl& mangledName);
+	bool WriteShortSymbolMap(const StringImpl& path);
+	void ReportMemory(MemReporter* memReporter);
+};
+
 class BfGNUMangler : public BfMangler
 {
 public:				
@@ -629,10 +629,10 @@ public:
 					BfFunctionBindResult bindResult;
 					bindResult.mWantsArgs = true;
 					exprEvaluator.mFunctionBindResult = &bindResult;
-					SizedArray<BfExpression*, 8> copiedArgs;
+					SizedArray<ASTREF(BfExpression*), 8> copiedArgs;
 					for (BfExpression* arg : objCreateExpr->mArguments)
 						copiedArgs.push_back(arg);
-					BfSizedArray<BfExpression*> sizedArgExprs(copiedArgs);
+					BfSizedArray<ASTREF(BfExpression*)> sizedArgExprs(copiedArgs);
 					BfResolvedArgs argValues(&sizedArgExprs);
 					if (typeInst != NULL)
 					{
@@ -823,6 +823,9 @@ BfModule::BfModule(BfContext* context, const StringImpl& moduleName)
 
 	mRevision = -1;
 	mRebuildIdx = 0;
+	mVDataHashRebuildIdx = -1;
+	mVDataHashStringRefCount = 0;
+	mVDataHashImportCount = 0;
 	mLastModuleWrittenRevision = 0;
 	mIsModuleMutable = false;
 	mExtensionCount = 0;
@@ -2213,27 +2216,8 @@ void BfModule::UpdateSrcPos(BfAstNode* astNode, BfSrcPosFlags flags, int debugLo
 
 	BF_ASSERT(srcPos < bfParser->mSrcLength);
 
-	auto* jumpEntry = bfParser->mJumpTable + (srcPos / PARSER_JUMPTABLE_DIVIDE);
-	if (jumpEntry->mCharIdx > srcPos)
-		jumpEntry--;
-	mCurFilePosition.mCurLine = jumpEntry->mLineNum;
-	mCurFilePosition.mCurSrcPos = jumpEntry->mCharIdx;	
-	mCurFilePosition.mCurColumn = 0;
-
-	while (mCurFilePosition.mCurSrcPos < srcPos)
-	{		
-		if (bfParser->mSrc[mCurFilePosition.mCurSrcPos] == '\n')
-		{
-			mCurFilePosition.mCurLine++;
-			mCurFilePosition.mCurColumn = 0;
-		}
-		else
-		{
-			mCurFilePosition.mCurColumn++;
-		}
-
-		mCurFilePosition.mCurSrcPos++;
-	}
+	bfParser->GetLineCharAtIdx(srcPos, mCurFilePosition.mCurLine, mCurFilePosition.mCurColumn);
+	mCurFilePosition.mCurSrcPos = srcPos;
 
 	//TODO: if we bail on the "mCurMethodState == NULL" case then we don't get it set during type declarations
 	if (((flags & BfSrcPosFlag_NoSetDebugLoc) == 0) && (mBfIRBuilder->DbgHasInfo()) && (mCurMethodState != NULL))
@@ -2915,6 +2899,21 @@ void BfModule::AddDependency(BfType* usedType, BfType* usingType, BfDependencyMa
 	}	
 }
 
+// Adds a DependencyFlag_InlinedCall dependency on usedType, also noting which method was inlined when method-granular
+//  dependencies are enabled. A NULL methodInstance means we depend on all of usedType's inline internals
+void BfModule::AddInlinedCallDependency(BfTypeInstance* usedType, BfMethodInstance* methodInstance, BfType* usingType)
+{
+	AddDependency(usedType, usingType, BfDependencyMap::DependencyFlag_InlinedCall);
+
+	if (!mCompiler->mOptions.mMethodGranularDeps)
+		return;
+	if ((usedType == usingType) || (usedType->IsSpecializedByAutoCompleteMethod()))
+		return;
+	if ((mCurMethodInstance != NULL) && (mCurMethodInstance->mIsAutocompleteMethod))
+		return;
+	usedType->mDependencyMap.AddInlinedBy(usingType, (methodInstance != NULL) ? &methodInstance->mMethodDef->mFullHash : NULL);
+}
+
 void BfModule::AddCallDependency(BfMethodInstance* methodInstance, bool devirtualized)
 {
 	if ((mCurMethodState != NULL) && (mCurMethodState->mHotDataReferenceBuilder != NULL))
@@ -5395,6 +5394,23 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 		}		
 	}
 		
+	// With compact reflection the field, method and param names aren't emitted as String objects. They are packed
+	//  into one blob per type instead, behind a 'materialized' byte, and the runtime interns them on first use.
+	bool compactReflection = (typeDef->mProject != NULL) && (typeDef->mProject->mCompactReflection);
+	BfIRValue nullStringConst;
+	if (compactReflection)
+		nullStringConst = GetDefaultValue(ResolveTypeDef(mCompiler->mStringTypeDef));
+	String reflectNames;
+	reflectNames.Append('\0');
+	auto _GetReflectName = [&](const StringImpl& name) -> BfIRValue
+	{
+		if (!compactReflection)
+			return GetStringObjectValue(name, true);
+		reflectNames += name;
+		reflectNames.Append('\0');
+		return nullStringConst;
+	};
+
 	SizedArray<BfIRValue, 16> fieldTypes;
 
 	enum FieldFlags
@@ -5413,7 +5429,7 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 		BfType* payloadType = typeInstance->GetUnionInnerType();		
 		if (!payloadType->IsValuelessType())
 		{
-			BfIRValue payloadNameConst = GetStringObjectValue("$payload", true);
+			BfIRValue payloadNameConst = _GetReflectName("$payload");
 			SizedArray<BfIRValue, 8> payloadFieldVals =
 			{
 				emptyValueType,
@@ -5429,7 +5445,7 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 		}
 
 		BfType* dscrType = typeInstance->GetDiscriminatorType();
-		BfIRValue dscrNameConst = GetStringObjectValue("$discriminator", true);
+		BfIRValue dscrNameConst = _GetReflectName("$discriminator");
 		SizedArray<BfIRValue, 8> dscrFieldVals =
 		{
 			emptyValueType,
@@ -5452,7 +5468,7 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 		BfFieldInstance* fieldInstance = &typeInstance->mFieldInstances[fieldIdx];
 		BfFieldDef* fieldDef = fieldInstance->GetFieldDef();
 
-		BfIRValue fieldNameConst = GetStringObjectValue(fieldDef->mName, true);
+		BfIRValue fieldNameConst = _GetReflectName(fieldDef->mName);
 
 		int typeId = 0;
 		auto fieldType = fieldInstance->GetResolvedType();
@@ -5598,7 +5614,7 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 	{
 		BfIRType fieldDataConstType = mBfIRBuilder->GetSizedArrayType(reflectFieldDataIRType, (int)fieldTypes.size());
 		BfIRValue fieldDataConst = mBfIRBuilder->CreateConstArray(fieldDataConstType, fieldTypes);
-		BfIRValue fieldDataArray = mBfIRBuilder->CreateGlobalVariable(fieldDataConstType, true, BfIRLinkageType_Internal,
+		BfIRValue fieldDataArray = mBfIRBuilder->CreateGlobalVariable(fieldDataConstType, !compactReflection, BfIRLinkageType_Internal,
 			fieldDataConst, "fields." + typeDataName);
 		fieldDataPtr = mBfIRBuilder->CreateBitCast(fieldDataArray, fieldDataPtrType);
 	}
@@ -5694,7 +5710,7 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 				funcVal = mBfIRBuilder->CreateBitCast(moduleMethodInstance.mFunc, voidPtrIRType);
 		}
 				
-		BfIRValue methodNameConst = GetStringObjectValue(methodDef->mName, true);
+		BfIRValue methodNameConst = _GetReflectName(methodDef->mName);
 				
 		enum MethodFlags
 		{
@@ -5748,7 +5764,7 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 			if (defaultMethod->GetParamIsSplat(paramIdx))
 				paramFlags = (ParamFlags)(paramFlags | ParamFlag_Splat);
 
-			BfIRValue paramNameConst = GetStringObjectValue(paramName, true);
+			BfIRValue paramNameConst = _GetReflectName(paramName);
 
 			SizedArray<BfIRValue, 8> paramDataVals =
 				{
@@ -5768,7 +5784,7 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 			BfIRType paramDataArrayType = mBfIRBuilder->GetSizedArrayType(mBfIRBuilder->MapType(reflectParamDataType, BfIRPopulateType_Full), (int)paramVals.size());
 			BfIRValue paramDataConst = mBfIRBuilder->CreateConstArray(paramDataArrayType, paramVals);
 
-			BfIRValue paramDataArray = mBfIRBuilder->CreateGlobalVariable(paramDataArrayType, true, BfIRLinkageType_Internal,
+			BfIRValue paramDataArray = mBfIRBuilder->CreateGlobalVariable(paramDataArrayType, !compactReflection, BfIRLinkageType_Internal,
 				paramDataConst, typeDataName + StrFormat(".params%d", methodIdx));
 			paramsVal = mBfIRBuilder->CreateBitCast(paramDataArray, mBfIRBuilder->MapType(reflectParamDataPtrType));
 		}
@@ -5829,7 +5845,7 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 	{
 		BfIRType methodDataArrayType = mBfIRBuilder->GetSizedArrayType(mBfIRBuilder->MapType(reflectMethodDataType, BfIRPopulateType_Full), (int)methodTypes.size());
 		BfIRValue methodDataConst = mBfIRBuilder->CreateConstArray(methodDataArrayType, methodTypes);
-		BfIRValue methodDataArray = mBfIRBuilder->CreateGlobalVariable(methodDataArrayType, true, BfIRLinkageType_Internal,
+		BfIRValue methodDataArray = mBfIRBuilder->CreateGlobalVariable(methodDataArrayType, !compactReflection, BfIRLinkageType_Internal,
 			methodDataConst, "methods." + typeDataName);
 		methodDataPtr = mBfIRBuilder->CreateBitCast(methodDataArray, methodDataPtrType);
 	}
@@ -5861,6 +5877,19 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 		customAttrDataPtr = mBfIRBuilder->CreateConstNull(voidPtrPtrIRType);
 	}
 
+	BfIRType bytePtrIRType = mBfIRBuilder->GetPointerTo(mBfIRBuilder->MapType(byteType));
+	BfIRValue reflectNamesPtr;
+	if (reflectNames.length() > 1)
+	{
+		// Not constant - the first byte is set once the names have been materialized
+		BfIRType reflectNamesArrayType = mBfIRBuilder->GetSizedArrayType(mBfIRBuilder->MapType(byteType), (int)reflectNames.length() + 1);
+		BfIRValue reflectNamesArray = mBfIRBuilder->CreateGlobalVariable(reflectNamesArrayType, false, BfIRLinkageType_Internal,
+			mBfIRBuilder->CreateConstString(reflectNames), "names." + typeDataName);
+		reflectNamesPtr = mBfIRBuilder->CreateBitCast(reflectNamesArray, bytePtrIRType);
+	}
+	else
+		reflectNamesPtr = mBfIRBuilder->CreateConstNull(bytePtrIRType);
+
 	SizedArray<BfIRValue, 32> typeDataVals =
 		{
 			typeData,
@@ -5890,6 +5919,7 @@ BfIRValue BfModule::CreateTypeData(BfType* type, Dictionary<int, int>& usedStrin
 			voidPtrNull, // mConstructorDataPtr
 
 			customAttrDataPtr, // mCustomAttrDataPtr
+			reflectNamesPtr, // mReflectNamesPtr
 		};
 
 	BfIRType typeInstanceDataType = mBfIRBuilder->MapTypeInst(typeInstanceType->ToTypeInstance(), BfIRPopulateType_Full);
@@ -6280,20 +6310,20 @@ void BfModule::ResolveGenericParamConstraints(BfGenericParamInstance* genericPar
 					continue;
 				}
 
-				opConstraintInstance.mBinaryOp = BfTokenToBinaryOp(opConstraint->mOpToken->mToken);
+				opConstraintInstance.mBinaryOp = BfTokenToBinaryOp(opConstraint->mOpToken->GetToken());
 				if (opConstraintInstance.mBinaryOp == BfBinaryOp_None)
 				{
 					Fail("Invalid binary operator", opConstraint->mOpToken);
 					continue;
 				}
 			}
-			else if ((opConstraint->mOpToken->mToken == BfToken_Implicit) || (opConstraint->mOpToken->mToken == BfToken_Explicit))
+			else if ((opConstraint->mOpToken->GetToken() == BfToken_Implicit) || (opConstraint->mOpToken->GetToken() == BfToken_Explicit))
 			{
-				opConstraintInstance.mCastToken = opConstraint->mOpToken->mToken;
+				opConstraintInstance.mCastToken = opConstraint->mOpToken->GetToken();
 			}
 			else
 			{
-				opConstraintInstance.mUnaryOp = BfTokenToUnaryOp(opConstraint->mOpToken->mToken);
+				opConstraintInstance.mUnaryOp = BfTokenToUnaryOp(opConstraint->mOpToken->GetToken());
 				if (opConstraintInstance.mUnaryOp == BfUnaryOp_None)
 				{
 					Fail("Invalid unary operator", opConstraint->mOpToken);
@@ -7214,7 +7244,7 @@ BfIRValue BfModule::AllocBytes(BfAstNode* refNode, const BfAllocTarget& allocTar
 	if ((allocTarget.mScopedInvocationTarget != NULL) || (allocTarget.mCustomAllocator))
 	{
 		auto intType = GetPrimitiveType(BfTypeCode_IntPtr);
-		SizedArray<BfExpression*, 2> argExprs;
+		SizedArray<ASTREF(BfExpression*), 2> argExprs;
 
 		BfTypedValueExpression typedValueExpr;
 		typedValueExpr.Init(BfTypedValue(sizeValue, intType));
@@ -7255,7 +7285,7 @@ BfIRValue BfModule::AllocBytes(BfAstNode* refNode, const BfAllocTarget& allocTar
 
 				if (HasMixin(customTypeInst, allocMethodName, 2))
 				{
-					BfSizedArray<BfExpression*> argExprArr;
+					BfSizedArray<ASTREF(BfExpression*)> argExprArr;
 					argExprArr.mSize = (int)argExprs.size();
 					argExprArr.mVals = &argExprs[0];
 
@@ -7264,7 +7294,7 @@ BfIRValue BfModule::AllocBytes(BfAstNode* refNode, const BfAllocTarget& allocTar
 				}
 				else
 				{
-					BfSizedArray<BfExpression*> sizedArgExprs(argExprs);
+					BfSizedArray<ASTREF(BfExpression*)> sizedArgExprs(argExprs);
 					BfResolvedArgs argValues(&sizedArgExprs);
 					exprEvaluator.ResolveArgValues(argValues);
 					SetAndRestoreValue<bool> prevNoBind(mCurMethodState->mNoBind, true);
@@ -7920,7 +7950,7 @@ BfIRValue BfModule::AllocFromType(BfType* type, const BfAllocTarget& allocTarget
 				typedValueExpr.mRefNode = allocTarget.mRefNode;
 	
 				BfExprEvaluator exprEvaluator(this);
-				SizedArray<BfExpression*, 2> argExprs;
+				SizedArray<ASTREF(BfExpression*), 2> argExprs;
 				argExprs.push_back(&typedValueExpr);
 
 				BfTypedValueExpression sizeValueExpr;
@@ -7928,7 +7958,7 @@ BfIRValue BfModule::AllocFromType(BfType* type, const BfAllocTarget& allocTarget
  				sizeValueExpr.mRefNode = allocTarget.mRefNode;
  				argExprs.push_back(&sizeValueExpr);
 
-				BfSizedArray<BfExpression*> sizedArgExprs(argExprs);
+				BfSizedArray<ASTREF(BfExpression*)> sizedArgExprs(argExprs);
 				BfResolvedArgs argValues(&sizedArgExprs);
 				exprEvaluator.ResolveArgValues(argValues);
 				exprEvaluator.mNoBind = true;
@@ -9377,6 +9407,7 @@ void BfModule::ClearConstData()
 	mStringObjectPool.Clear();
 	mStringCharPtrPool.Clear();
 	mStringPoolRefs.Clear();
+	mVDataHashRebuildIdx = -1;
 }
 
 BfTypedValue BfModule::GetTypedValueFromConstant(BfConstant* constant, BfIRConstHolder* constHolder, BfType* wantType)
@@ -9538,7 +9569,7 @@ void BfModule::GetCustomAttributes(BfCustomAttributes* customAttributes, BfAttri
 			}
 
 			BfCaptureInfo::Entry captureEntry;
-			captureEntry.mCaptureType = (tokenNode->mToken == BfToken_Ampersand) ? BfCaptureType_Reference : BfCaptureType_Copy;
+			captureEntry.mCaptureType = (tokenNode->GetToken() == BfToken_Ampersand) ? BfCaptureType_Reference : BfCaptureType_Copy;
 			if (!attributesDirective->mArguments.IsEmpty())
 			{
 				captureEntry.mNameNode = BfNodeDynCast<BfIdentifierNode>(attributesDirective->mArguments[0]);
@@ -10984,7 +11015,7 @@ BfModuleMethodInstance BfModule::ReferenceExternalMethodInstance(BfMethodInstanc
 		// Be smarter about this if we ever insert a lot of type instances into a single module - track in a field
 		BF_ASSERT(mOwnedTypeInstances.size() <= 1);
 		for (auto ownedTypeInst : mOwnedTypeInstances)
-			AddDependency(methodInstance->GetOwner(), ownedTypeInst, BfDependencyMap::DependencyFlag_InlinedCall);
+			AddInlinedCallDependency(methodInstance->GetOwner(), methodInstance, ownedTypeInst);
 
 		if ((!mCompiler->mIsResolveOnly) && (mIsReified) && (!methodInstance->mIsUnspecialized))
 		{
@@ -13242,7 +13273,7 @@ BfTypedValue BfModule::TryConstCalcAppend(BfMethodInstance* methodInst, SizedArr
 		auto checkTypeInst = methodInst->GetOwner();
 		while (checkTypeInst->mTypeDef->mHasAppendCtor)
 		{
-			AddDependency(checkTypeInst, mCurTypeInstance, BfDependencyMap::DependencyFlag_InlinedCall);
+			AddInlinedCallDependency(checkTypeInst, NULL, mCurTypeInstance);
 			checkTypeInst = GetBaseType(checkTypeInst);
 		}
 	}
@@ -18736,6 +18767,7 @@ void BfModule::SetupIRFunction(BfMethodInstance* methodInstance, StringImpl& man
 				//  their constraints, but they should only collide in their unspecialized form
 				//  since only one will be chosen for a given concrete type		
 				mCurMethodInstance->mMangleWithIdx = true;
+				mContext->mMangledNameCache.RemoveMethod(mCurMethodInstance);
 				mangledName.Clear();
 				BfMangler::Mangle(mangledName, mCompiler->GetMangleKind(), mCurMethodInstance);
 				prevFunc = mBfIRBuilder->GetFunction(mangledName);
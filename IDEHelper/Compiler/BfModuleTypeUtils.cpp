@@ -6633,7 +6633,7 @@ BfType* BfModule::ResolveTypeRef(BfTypeReference* typeRef, BfPopulateType popula
 	{
 		if (auto refTypeRef = BfNodeDynCast<BfRefTypeRef>(typeRef))
 		{
-			const char* refTypeStr = BfTokenToString(refTypeRef->mRefToken->mToken);
+			const char* refTypeStr = BfTokenToString(refTypeRef->mRefToken->GetToken());
 			Fail(StrFormat("Invalid use of '%s'. Only method parameters, return types, and local variables can be declared as %s types", refTypeStr, refTypeStr), refTypeRef->mRefToken);
 			return ResolveTypeRef(refTypeRef->mElementType);
 		}
@@ -6646,7 +6646,7 @@ BfType* BfModule::ResolveTypeRef(BfTypeReference* typeRef, BfPopulateType popula
 
 	if (auto dotType = BfNodeDynCastExact<BfDotTypeReference>(typeRef))
 	{		
-		Fail(StrFormat("Invalid use of '%s'", BfTokenToString(dotType->mDotToken->mToken)), typeRef);
+		Fail(StrFormat("Invalid use of '%s'", BfTokenToString(dotType->mDotToken->GetToken())), typeRef);
 		return NULL;
 	}
 
@@ -7883,7 +7883,7 @@ BfType* BfModule::ResolveInnerType(BfType* outerType, BfIdentifierNode* identifi
 	return type;
 }
 
-BfType* BfModule::ResolveTypeRef(BfAstNode* astNode, const BfSizedArray<BfTypeReference*>* genericArgs, BfPopulateType populateType, BfResolveTypeRefFlags resolveFlags)
+BfType* BfModule::ResolveTypeRef(BfAstNode* astNode, const BfSizedArray<ASTREF(BfTypeReference*)>* genericArgs, BfPopulateType populateType, BfResolveTypeRefFlags resolveFlags)
 {
 	if ((genericArgs == NULL) || (genericArgs->size() == 0))
 	{
@@ -7891,8 +7891,8 @@ BfType* BfModule::ResolveTypeRef(BfAstNode* astNode, const BfSizedArray<BfTypeRe
 		{			
 			BfNamedTypeReference typeRef;
 			typeRef.mNameNode = identifier;
-			typeRef.mSrcEnd = 0;
-			typeRef.mToken = BfToken_None;
+			typeRef.SetSrcEnd(0);
+			typeRef.SetToken(BfToken_None);
 			auto type = ResolveTypeRef(&typeRef, populateType, resolveFlags);
 			return type;
 		}
@@ -2,6 +2,7 @@
 
 
 #include "BfParser.h"
+#include "BfLexScan.h"
 #include "BfReducer.h"
 #include "BfPrinter.h"
 #include "BfDefBuilder.h"
@@ -145,6 +146,10 @@ void BfParserCache::ReportMemory(MemReporter* memReporter)
 	int srcLen = 0;
 	int allocBytesUsed = 0;
 	int largeAllocs = 0;
+	int numNodes = 0;
+	int numAstInfos = 0;
+	int64 parseMicros = 0;
+	int64 reduceMicros = 0;
 
 	for (auto& entry : mEntries)
 	{
@@ -153,6 +158,10 @@ void BfParserCache::ReportMemory(MemReporter* memReporter)
 		srcLen += parserData->mSrcLength;
 		allocBytesUsed += (int)(parserData->mAlloc.mPages.size() * BfAstAllocManager::PAGE_SIZE);
 		largeAllocs += parserData->mAlloc.mLargeAllocSizes;
+		numNodes += parserData->mAlloc.mNumNodes;
+		numAstInfos += parserData->mAlloc.mNumAstInfos;
+		parseMicros += parserData->mParseMicros;
+		reduceMicros += parserData->mReduceMicros;
 	}
 
 	int allocPages = 0;
@@ -162,14 +171,33 @@ void BfParserCache::ReportMemory(MemReporter* memReporter)
 	OutputDebugStrF("Parsers: %d  Chars: %d  UsedAlloc: %dk  BytesPerChar: %d  SysAllocPages: %d  SysUsedPages: %d (%dk)  LargeAllocs: %dk\n", (int)mEntries.size(), srcLen, allocBytesUsed / 1024,
 		allocBytesUsed / BF_MAX(1, srcLen), allocPages, usedPages, (usedPages * BfAstAllocManager::PAGE_SIZE) / 1024, largeAllocs / 1024);
 
+	// Build with and without BF_AST_NO_COMPACT_REFS to compare footprints and throughput
+	int farRefs = 0;
+#ifdef BF_USE_NEAR_NODE_REF
+	farRefs = BfAstArena::GetFarRefCount();
+#endif
+	OutputDebugStrF("AstNodes: %d  BytesPerNode: %.1f  RefSize: %d  PackedPositions: %d  AstInfoSpills: %d (%.2f%%)  FarRefs: %d  ParseMBPerSec: %.1f  ReduceMBPerSec: %.1f\n",
+		numNodes, (double)allocBytesUsed / BF_MAX(1, numNodes), (int)sizeof(ASTREF(BfAstNode*)),
+#ifdef BF_AST_COMPACT
+		1,
+#else
+		0,
+#endif
+		numAstInfos, (numAstInfos * 100.0) / BF_MAX(1, numNodes), farRefs,
+		(double)srcLen / BF_MAX(1, parseMicros), (double)srcLen / BF_MAX(1, reduceMicros));
+
 	//memReporter->AddBumpAlloc("BumpAlloc", mAstAllocManager);
 }
 
 void BfParserData::ReportMemory(MemReporter* memReporter)
 {
-	memReporter->Add("JumpTable", mJumpTableSize * sizeof(BfLineStartEntry));
+	memReporter->AddVec("LineStarts", mLineStarts, false);
 	memReporter->Add("Source", mSrcLength);
+	memReporter->AddVec("LexRecords", mLexRecords, false);
 	memReporter->AddBumpAlloc("AstAlloc", mAlloc);
+#ifdef BF_AST_COMPACT
+	memReporter->Add("AstInfos", mAlloc.mNumAstInfos * (int)sizeof(BfAstInfo));
+#endif
 }
 
 static int DecodeInt(uint8* buf, int& idx)
@@ -197,17 +225,16 @@ BfParserData::BfParserData()
 
 	mHash = 0;
 	mRefCount = -1;
-	mJumpTable = NULL;
-	mJumpTableSize = 0;
 	mFailed = false;	
 	mCharIdData = NULL;
 	mUniqueParser = NULL;
 	mDidReduce = false;
+	mParseMicros = 0;
+	mReduceMicros = 0;
 }
 
 BfParserData::~BfParserData()
 {
-	delete[] mJumpTable;
 	delete[] mCharIdData;
 }
 
@@ -238,30 +265,33 @@ int BfParserData::GetCharIdAtIndex(int findIndex)
 	}
 }
 
-void BfParserData::GetLineCharAtIdx(int idx, int& line, int& lineChar)
+int BfParserData::GetLineAtIdx(int idx)
 {
-	auto* jumpEntry = mJumpTable + (idx / PARSER_JUMPTABLE_DIVIDE);
-	if (jumpEntry->mCharIdx > idx)
-		jumpEntry--;
-
-	line = jumpEntry->mLineNum;
-	lineChar = 0;
-	int curSrcPos = jumpEntry->mCharIdx;
-
-	while (curSrcPos < idx)
+	// Binary search for the last line that starts at or before idx
+	int lo = 0;
+	int hi = (int)mLineStarts.size() - 1;
+	while (lo < hi)
 	{
-		if (mSrc[curSrcPos] == '\n')
-		{
-			line++;
-			lineChar = 0;
-		}
+		int mid = (lo + hi + 1) / 2;
+		if (mLineStarts[mid] <= idx)
+			lo = mid;
 		else
-		{
-			lineChar++;
-		}
+			hi = mid - 1;
+	}
+	return lo;
+}
 
-		curSrcPos++;
+void BfParserData::GetLineCharAtIdx(int idx, int& line, int& lineChar)
+{
+	if (mLineStarts.IsEmpty())
+	{
+		line = 0;
+		lineChar = idx;
+		return;
 	}
+
+	line = GetLineAtIdx(idx);
+	lineChar = idx - mLineStarts[line];
 }
 
 bool BfParserData::IsUnwarnedAt(BfAstNode* node)
@@ -341,7 +371,6 @@ BfParser::BfParser(BfSystem* bfSystem, BfProject* bfProject) : BfSource(bfSystem
 	mAwaitingDelete = false;
 	mScanOnly = false;
 	mCompleteParse = false;
-	mJumpTable = NULL;
 	mProject = bfProject;
 	mPassInstance = NULL;
 	mPassInstance = NULL;
@@ -372,6 +401,15 @@ BfParser::BfParser(BfSystem* bfSystem, BfProject* bfProject) : BfSource(bfSystem
 	mPreprocessorIgnoredSectionNode = NULL;
 	mPreprocessorIgnoreDepth = 0;
 
+	mRecordLex = false;
+	mLexDepth = 0;
+	mLexReplayIdx = 0;
+	mLexPrefixLen = 0;
+	mLexSuffixStart = 0;
+	mLexSuffixDelta = 0;
+	mLexReplayCount = 0;
+	mLexTrace = NULL;
+
 	if (bfProject != NULL)
 	{
 		for (auto macro : bfProject->mPreprocessorMacros)
@@ -475,12 +513,7 @@ void BfParser::Init(uint64 cacheHash)
 		mParserData->mUniqueParser = this;
 	}
 
-	mJumpTableSize = ((mSrcLength + 1) + PARSER_JUMPTABLE_DIVIDE - 1) / PARSER_JUMPTABLE_DIVIDE;
-	mJumpTable = new BfLineStartEntry[mJumpTableSize];
-	memset(mJumpTable, 0, mJumpTableSize * sizeof(BfLineStartEntry));
-
-	mParserData->mJumpTable = mJumpTable;
-	mParserData->mJumpTableSize = mJumpTableSize;
+	BuildLineStarts();
 	
 	mAlloc = &mParserData->mAlloc;
 	mAlloc->mSourceData = mSourceData;	
@@ -490,14 +523,26 @@ void BfParser::NewLine()
 {
 	mLineStart = mSrcIdx;
 	mLineNum++;
+}
 
-	int idx = (mSrcIdx / PARSER_JUMPTABLE_DIVIDE);
-	if (idx == 0)
-		return;
-	BF_ASSERT(idx < mJumpTableSize);
-	BfLineStartEntry* jumpTableEntry = mJumpTable + idx;
-	jumpTableEntry->mCharIdx = mSrcIdx;
-	jumpTableEntry->mLineNum = mLineNum;
+// Indexed straight from the source rather than from NewLine, since the lexer doesn't visit every line start
+//  at the start of the line (ie: multi-line string literals) and may not lex the whole file at all
+void BfParser::BuildLineStarts()
+{
+	auto& lineStarts = mParserData->mLineStarts;
+	lineStarts.Clear();
+	lineStarts.Add(0);
+
+	const char* srcEnd = mSrc + mSrcLength;
+	const char* checkPtr = mSrc;
+	while (checkPtr < srcEnd)
+	{
+		const char* newlinePtr = (const char*)memchr(checkPtr, '\n', srcEnd - checkPtr);
+		if (newlinePtr == NULL)
+			break;
+		checkPtr = newlinePtr + 1;
+		lineStarts.Add((int)(checkPtr - mSrc));
+	}
 }
 
 void BfParser::SetSource(const char* data, int length)
@@ -560,8 +605,6 @@ void BfParser::SetSource(const char* data, int length)
 			mOrigSrcLength = mParserData->mSrcLength;
 			mSrcAllocSize = -1;
 			mSrcIdx = 0;
-			mJumpTable = mParserData->mJumpTable;
-			mJumpTableSize = mParserData->mJumpTableSize;
 			mAlloc = &mParserData->mAlloc;
 			return;
 		}
@@ -1319,7 +1362,228 @@ double BfParser::ParseLiteralDouble()
 	return strtod(buf, NULL);
 }
 
+// Chars past either end of a token that the lexer may have examined while producing it
+#define LEX_REPLAY_LOOKBEHIND 2
+#define LEX_REPLAY_LOOKAHEAD 8
+
+// Token replay only. No AST nodes or typeDefs are carried over from the previous revision
+void BfParser::InitLexReplay()
+{
+	// Only classifier parsers get re-created for every edit, so they're the only ones worth the record memory
+	mRecordLex = ((mParserFlags & ParserFlag_Classifying) != 0) && (mParserData->mRefCount == -1) && (!mCompatMode);
+	if (!mRecordLex)
+		return;
+
+	// mDataLock keeps RemoveOldParsers from deleting the previous revision out from under us
+	AutoCrit autoCrit(mSystem->mDataLock);
+	if (mPrevRevision == NULL)
+		return;
+	auto prevParserData = mPrevRevision->mParserData;
+	if ((prevParserData == NULL) || (prevParserData->mLexRecords.IsEmpty()) || (prevParserData->mSrc == NULL))
+		return;
+
+	const char* prevSrc = prevParserData->mSrc;
+	int prevSrcLength = prevParserData->mSrcLength;
+	int maxCommon = BF_MIN(prevSrcLength, mSrcLength);
+
+	int prefixLen = 0;
+	while ((prefixLen < maxCommon) && (prevSrc[prefixLen] == mSrc[prefixLen]))
+		prefixLen++;
+	int suffixLen = 0;
+	while ((suffixLen < maxCommon - prefixLen) && (prevSrc[prevSrcLength - suffixLen - 1] == mSrc[mSrcLength - suffixLen - 1]))
+		suffixLen++;
+
+	mLexReplayRecords = std::move(prevParserData->mLexRecords);
+	mLexReplayIdx = 0;
+	mLexPrefixLen = prefixLen;
+	mLexSuffixStart = prevSrcLength - suffixLen;
+	mLexSuffixDelta = mSrcLength - prevSrcLength;
+}
+
+bool BfParser::TryReplayToken()
+{
+	int prevIdx;
+	int delta;
+	if (mSrcIdx < mLexPrefixLen)
+	{
+		prevIdx = mSrcIdx;
+		delta = 0;
+	}
+	else if (mSrcIdx - mLexSuffixDelta >= mLexSuffixStart)
+	{
+		prevIdx = mSrcIdx - mLexSuffixDelta;
+		delta = mLexSuffixDelta;
+	}
+	else
+		return false;
+
+	while ((mLexReplayIdx < mLexReplayRecords.mSize) && (mLexReplayRecords[mLexReplayIdx].mScanStart < prevIdx))
+		mLexReplayIdx++;
+	if (mLexReplayIdx >= mLexReplayRecords.mSize)
+		return false;
+	auto& record = mLexReplayRecords[mLexReplayIdx];
+	if (record.mScanStart != prevIdx)
+		return false;
+
+	// Everything the lexer looked at must lie within the same unchanged region
+	if (delta == 0)
+	{
+		if (record.mSrcEnd + LEX_REPLAY_LOOKAHEAD > mLexPrefixLen)
+			return false;
+	}
+	else if (record.mScanStart - LEX_REPLAY_LOOKBEHIND < mLexSuffixStart)
+		return false;
+
+	mTriviaStart = mSrcIdx;
+	mTokenStart = record.mTokenStart + delta;
+	mTokenEnd = record.mTokenEnd + delta;
+	mToken = record.mToken;
+	mSyntaxToken = record.mSyntaxToken;
+	if (mSyntaxToken == BfSyntaxToken_Literal)
+		mLiteral = record.mLiteral;
+
+	// Recorded tokens only have whitespace trivia, so newlines can only occur before mTokenStart
+	const char* checkPtr = mSrc + mSrcIdx;
+	const char* triviaEnd = mSrc + mTokenStart;
+	while (checkPtr < triviaEnd)
+	{
+		const char* newlinePtr = (const char*)memchr(checkPtr, '\n', triviaEnd - checkPtr);
+		if (newlinePtr == NULL)
+			break;
+		mSrcIdx = (int)(newlinePtr - mSrc) + 1;
+		NewLine();
+		checkPtr = newlinePtr + 1;
+	}
+
+	mSrcIdx = record.mSrcEnd + delta;
+	mLexReplayIdx++;
+	mLexReplayCount++;
+	return true;
+}
+
+void BfParser::RecordToken(int scanStart)
+{
+	BfLexRecord record;
+	record.mScanStart = scanStart;
+	record.mTokenStart = mTokenStart;
+	record.mTokenEnd = mTokenEnd;
+	record.mSrcEnd = mSrcIdx;
+	record.mLiteral = mLiteral;
+	record.mToken = mToken;
+	record.mSyntaxToken = mSyntaxToken;
+	mParserData->mLexRecords.Add(record);
+}
+
 void BfParser::NextToken(int endIdx)
+{
+	ReplayOrLexToken(endIdx);
+
+	if ((mLexTrace != NULL) && (mLexDepth == 0))
+	{
+		BfLexTraceEntry entry;
+		entry.mRecord.mScanStart = -1;
+		entry.mRecord.mTokenStart = mTokenStart;
+		entry.mRecord.mTokenEnd = mTokenEnd;
+		entry.mRecord.mSrcEnd = mSrcIdx;
+		entry.mRecord.mLiteral = mLiteral;
+		entry.mRecord.mToken = mToken;
+		entry.mRecord.mSyntaxToken = mSyntaxToken;
+		entry.mLineNum = mLineNum;
+		entry.mLineStart = mLineStart;
+		if ((mSyntaxToken == BfSyntaxToken_Literal) && (mLiteral.mTypeCode == BfTypeCode_CharPtr))
+			entry.mStringLiteral = *mLiteral.mString;
+		mLexTrace->Add(entry);
+	}
+}
+
+void BfParser::ReplayOrLexToken(int endIdx)
+{
+	bool isNeutral = (mLexDepth == 0) && (endIdx == -1) && (mPassInstance != NULL) &&
+		(mPreprocessorIgnoreDepth == 0) && (mPreprocessorIgnoredSectionNode == NULL) && (!mInAsmBlock) && (mSyntaxToken != BfSyntaxToken_EOF);
+	if ((!isNeutral) || ((!mRecordLex) && (mLexReplayRecords.IsEmpty())))
+	{
+		mLexDepth++;
+		LexToken(endIdx);
+		mLexDepth--;
+		return;
+	}
+
+	int scanStart = mSrcIdx;
+#ifdef BF_PARSER_VERIFY_LEX_REPLAY
+	int prevLineNum = mLineNum;
+	int prevLineStart = mLineStart;
+#endif
+	if ((!mLexReplayRecords.IsEmpty()) && (TryReplayToken()))
+	{
+#ifdef BF_PARSER_VERIFY_LEX_REPLAY
+		BfLexRecord replayed;
+		replayed.mTokenStart = mTokenStart;
+		replayed.mTokenEnd = mTokenEnd;
+		replayed.mSrcEnd = mSrcIdx;
+		replayed.mLiteral = mLiteral;
+		replayed.mToken = mToken;
+		replayed.mSyntaxToken = mSyntaxToken;
+		int replayedLineNum = mLineNum;
+
+		mSrcIdx = scanStart;
+		mLineNum = prevLineNum;
+		mLineStart = prevLineStart;
+		mLexDepth++;
+		LexToken(-1);
+		mLexDepth--;
+
+		BF_ASSERT(mTokenStart == replayed.mTokenStart);
+		BF_ASSERT(mTokenEnd == replayed.mTokenEnd);
+		BF_ASSERT(mSrcIdx == replayed.mSrcEnd);
+		BF_ASSERT(mToken == replayed.mToken);
+		BF_ASSERT(mSyntaxToken == replayed.mSyntaxToken);
+		BF_ASSERT(mLineNum == replayedLineNum);
+		if (mSyntaxToken == BfSyntaxToken_Literal)
+		{
+			BF_ASSERT(mLiteral.mTypeCode == replayed.mLiteral.mTypeCode);
+			if (mLiteral.mTypeCode == BfTypeCode_Single)
+				BF_ASSERT(mLiteral.mSingle == replayed.mLiteral.mSingle);
+			else
+				BF_ASSERT(mLiteral.mUInt64 == replayed.mLiteral.mUInt64);
+		}
+#endif
+		if (mRecordLex)
+			RecordToken(scanStart);
+		return;
+	}
+
+	int prevMessageCount = (int)mPassInstance->mErrors.size() + mPassInstance->mFailedIdx + mPassInstance->mWarningCount;
+	int prevStringLiteralCount = (int)mParserData->mStringLiterals.size();
+	int prevSideNodeCount = (int)mPendingSideNodes.size();
+	int prevErrorNodeCount = (int)mPendingErrorNodes.size();
+
+	mLexDepth++;
+	LexToken(endIdx);
+	mLexDepth--;
+
+	if (!mRecordLex)
+		return;
+
+	// Only record tokens that can be reproduced purely from the token fields and line tracking
+	if ((mSyntaxToken != BfSyntaxToken_Token) && (mSyntaxToken != BfSyntaxToken_Identifier) && (mSyntaxToken != BfSyntaxToken_Literal))
+		return;
+	if ((mPreprocessorIgnoreDepth != 0) || (mPreprocessorIgnoredSectionNode != NULL) || (mInAsmBlock))
+		return;
+	if (((int)mPassInstance->mErrors.size() + mPassInstance->mFailedIdx + mPassInstance->mWarningCount != prevMessageCount) ||
+		((int)mParserData->mStringLiterals.size() != prevStringLiteralCount) ||
+		((int)mPendingSideNodes.size() != prevSideNodeCount) ||
+		((int)mPendingErrorNodes.size() != prevErrorNodeCount))
+		return;
+	for (int checkIdx = scanStart; checkIdx < mTokenStart; checkIdx++)
+	{
+		// Comments and preprocessor directives have side effects we don't track
+		if (!IsWhitespace(mSrc[checkIdx]))
+			return;
+	}
+	RecordToken(scanStart);
+}
+
+void BfParser::LexToken(int endIdx)
 {
 	mToken = BfToken_None;
 	if (mSyntaxToken == BfSyntaxToken_EOF)
@@ -1642,6 +1906,14 @@ void BfParser::NextToken(int endIdx)
 
 			while (true)
 			{
+				// Copy through the run of chars that need no special handling
+				const char* runEnd = BfLexScan_FindStringChar(mSrc + mSrcIdx);
+				if (runEnd != mSrc + mSrcIdx)
+				{
+					strLiteral.Append(mSrc + mSrcIdx, (int)(runEnd - (mSrc + mSrcIdx)));
+					mSrcIdx = (int)(runEnd - mSrc);
+				}
+
 				char c = mSrc[mSrcIdx++];
 				if (c == '\0')
 				{
@@ -1881,6 +2153,7 @@ void BfParser::NextToken(int endIdx)
 			if (startChar == '\'')
 			{
 				mLiteral.mTypeCode = BfTypeCode_Char8;
+				mLiteral.mInt64 = 0;
 				if (strLiteral.length() == 0)
 				{
 					if (mPreprocessorIgnoredSectionNode == NULL)
@@ -1937,15 +2210,7 @@ void BfParser::NextToken(int endIdx)
 			if (mSrc[mSrcIdx] == '/')
 			{
 				// Comment line
-				while (true)
-				{
-					char c = mSrc[mSrcIdx++];
-					if ((c == '\n') || (c == '\0'))
-					{
-						mSrcIdx--;
-						break;
-					}
-				}
+				mSrcIdx = (int)(BfLexScan_FindLineEnd(mSrc + mSrcIdx) - mSrc);
 				mTokenEnd = mSrcIdx;
 
 				if (mPreprocessorIgnoredSectionNode == NULL)
@@ -1958,7 +2223,7 @@ void BfParser::NextToken(int endIdx)
 							// This is required for folding '///' style multi-line documentation into a single node
 							if (prevComment->GetTriviaStart() == mTriviaStart)
 							{
-								if (GetCommentKind(prevComment->mSrcStart) == GetCommentKind(mTokenStart))
+								if (GetCommentKind(prevComment->GetSrcStart()) == GetCommentKind(mTokenStart))
 								{
 									prevComment->SetSrcEnd(mSrcIdx);
 									handled = true;
@@ -1992,6 +2257,7 @@ void BfParser::NextToken(int endIdx)
 				mSrcIdx++;
 				while (true)
 				{
+					mSrcIdx = (int)(BfLexScan_FindBlockCommentChar(mSrc + mSrcIdx) - mSrc);
 					char c = mSrc[mSrcIdx++];
 					if (c == '\n')
 					{
@@ -2025,7 +2291,7 @@ void BfParser::NextToken(int endIdx)
 										// This is required for folding documentation into a single node
 										if (prevComment->GetTriviaStart() == mTriviaStart)
 										{
-											if (GetCommentKind(prevComment->mSrcStart) == GetCommentKind(mTokenStart))
+											if (GetCommentKind(prevComment->GetSrcStart()) == GetCommentKind(mTokenStart))
 											{
 												prevComment->SetSrcEnd(mSrcIdx);
 												handled = true;
@@ -2157,6 +2423,8 @@ void BfParser::NextToken(int endIdx)
 		case '\v':
 		case '\f':
 		case '\r':
+			if (endIdx == -1)
+				mSrcIdx = (int)(BfLexScan_SkipBlanks(mSrc + mSrcIdx) - mSrc);
 			continue; // Whitespace
 		case '\0':
 			mSrcIdx--; // Stay on EOF marker
@@ -2965,6 +3233,7 @@ void BfParser::NextToken(int endIdx)
 
 					while (true)
 					{
+						mSrcIdx = (int)(BfLexScan_SkipIdentChars(mSrc + mSrcIdx) - mSrc);
 						int curSrcIdx = mSrcIdx;
 						char c = mSrc[mSrcIdx++];
 						bool isValidChar =
@@ -3204,17 +3473,23 @@ void BfParser::Parse(BfPassInstance* passInstance)
 	mErrorRootNode->Init(this);
 	mParserData->mErrorRootNode = mErrorRootNode;
 
+	InitLexReplay();
+
+	uint64 startTick = BFGetTickCountMicro();
 	ParseBlock(mRootNode, 0);
+	mParserData->mParseMicros += (int64)(BFGetTickCountMicro() - startTick);
+
+	if (!mLexReplayRecords.IsEmpty())
+	{
+		BfLogSysM("Parser %p replayed %d tokens from previous revision %s\n", this, mLexReplayCount, mFileName.c_str());
+		mLexReplayRecords.Dispose();
+	}
 
 	if (mPreprocessorNodeStack.size() > 0)
 	{
 		mPassInstance->Warn(0, "No matching #endif found", mPreprocessorNodeStack.back().first);
 	}
 
-	for (int i = 1; i < mJumpTableSize; i++)
-		if (mJumpTable[i].mCharIdx == 0)
-			mJumpTable[i] = mJumpTable[i - 1];
-
 	if (mPassInstance->HasFailed())
 		mParsingFailed = true;
 
@@ -3274,8 +3549,6 @@ void BfParser::ReportMemory(MemReporter* memReporter)
 
 // 	if (!mUsingCache)
 // 		memReporter->AddBumpAlloc("AstAlloc", *mAlloc);
-// 
-// 	memReporter->Add("JumpTable", mJumpTableSize * sizeof(BfLineStartEntry));
 
 	memReporter->Add(sizeof(BfParser));
 	if (mParserData->mRefCount <= 0)
@@ -3446,11 +3719,13 @@ BF_EXPORT bool BF_CALLTYPE BfParser_Reduce(BfParser* bfParser, BfPassInstance* b
 	bfParser->FinishSideNodes();
 	int startFailIdx = bfPassInstance->mFailedIdx;
 	int startWarningCount = bfPassInstance->mWarningCount;
+	uint64 startTick = BFGetTickCountMicro();
 	BfReducer bfReducer;
 	bfReducer.mSource = bfParser;
 	bfReducer.mCompatMode = bfParser->mCompatMode;
 	bfReducer.mPassInstance = bfPassInstance;
 	bfReducer.HandleRoot(bfParser->mRootNode);
+	bfParser->mParserData->mReduceMicros += (int64)(BFGetTickCountMicro() - startTick);
 	if ((startFailIdx != bfPassInstance->mFailedIdx) ||
 		(startWarningCount != bfPassInstance->mWarningCount))
 		bfParser->mParserData->mFailed = true;
@@ -3607,3 +3882,132 @@ BF_EXPORT void BF_CALLTYPE BfParser_SetCompleteParse(BfParser* bfParser)
 {
 	bfParser->mCompleteParse = true;
 }
+
+BF_EXPORT void BF_CALLTYPE BfParser_SetScanOnly(BfParser* bfParser)
+{
+	bfParser->mScanOnly = true;
+}
+
+// Edits 'src' throughout and checks that each edited revision, parsed with tokens replayed from the unedited one,
+//  produces exactly the token stream and messages of a full lex. Edits land every 'editStride' chars and include
+//  ones that open or close strings, comments, preprocessor lines and interpolated strings. Returns the number of
+//  edits whose results differed, each of which is also logged.
+BF_EXPORT int BF_CALLTYPE BfParser_TestLexReplay(BfSystem* bfSystem, const char* src, int length, int editStride, int* outReplayCount)
+{
+	struct _Edit
+	{
+		const char* mInsert;
+		int mDeleteCount;
+	};
+	static const _Edit edits[] =
+	{
+		{ "", 1 }, { "", 3 }, { "x", 0 }, { "y", 1 }, { " ", 0 }, { "\n", 0 }, { "\"", 0 }, { "'", 0 }, { "\\", 0 },
+		{ "/*", 0 }, { "*/", 0 }, { "//", 0 }, { "#", 0 }, { "\n#if A\n", 0 }, { "{", 0 }, { "}", 0 }, { "$\"", 0 },
+		{ "@\"", 0 }, { "0x1F", 0 }, { ".5f", 0 }
+	};
+
+	struct _LexResult
+	{
+		Array<BfLexTraceEntry> mTrace;
+		int mErrorCount;
+		int mWarningCount;
+		int mReplayCount;
+	};
+
+	auto _Lex = [&](const StringImpl& prevSrc, const StringImpl& curSrc, _LexResult& result)
+	{
+		BfPassInstance passInstance(bfSystem);
+		BfParser* prevParser = NULL;
+		if (!prevSrc.IsEmpty())
+		{
+			prevParser = bfSystem->CreateParser(NULL);
+			BfParser_SetIsClassifying(prevParser);
+			BfParser_SetSource(prevParser, prevSrc.c_str(), prevSrc.mLength, "LexReplayTest.bf");
+			BfParser_Parse(prevParser, &passInstance, false);
+		}
+
+		BfPassInstance curPassInstance(bfSystem);
+		BfParser* parser = bfSystem->CreateParser(NULL);
+		BfParser_SetIsClassifying(parser);
+		BfParser_SetSource(parser, curSrc.c_str(), curSrc.mLength, "LexReplayTest.bf");
+		if (prevParser != NULL)
+			BfParser_SetNextRevision(prevParser, parser);
+		parser->mLexTrace = &result.mTrace;
+		BfParser_Parse(parser, &curPassInstance, false);
+		parser->mLexTrace = NULL;
+		result.mErrorCount = (int)curPassInstance.mErrors.size();
+		result.mWarningCount = curPassInstance.mWarningCount;
+		result.mReplayCount = parser->mLexReplayCount;
+
+		if (prevParser != NULL)
+			BfParser_Delete(prevParser);
+		BfParser_Delete(parser);
+	};
+
+	auto _TraceEquals = [](const BfLexTraceEntry& lhs, const BfLexTraceEntry& rhs)
+	{
+		if ((lhs.mRecord.mTokenStart != rhs.mRecord.mTokenStart) || (lhs.mRecord.mTokenEnd != rhs.mRecord.mTokenEnd) ||
+			(lhs.mRecord.mSrcEnd != rhs.mRecord.mSrcEnd) || (lhs.mRecord.mToken != rhs.mRecord.mToken) ||
+			(lhs.mRecord.mSyntaxToken != rhs.mRecord.mSyntaxToken) || (lhs.mLineNum != rhs.mLineNum) || (lhs.mLineStart != rhs.mLineStart))
+			return false;
+		if (lhs.mRecord.mSyntaxToken == BfSyntaxToken_Literal)
+		{
+			if (lhs.mRecord.mLiteral.mTypeCode != rhs.mRecord.mLiteral.mTypeCode)
+				return false;
+			if (lhs.mRecord.mLiteral.mTypeCode == BfTypeCode_Single)
+				return lhs.mRecord.mLiteral.mSingle == rhs.mRecord.mLiteral.mSingle;
+			if (lhs.mRecord.mLiteral.mTypeCode == BfTypeCode_CharPtr)
+				return lhs.mStringLiteral == rhs.mStringLiteral;
+			return lhs.mRecord.mLiteral.mUInt64 == rhs.mRecord.mLiteral.mUInt64;
+		}
+		return true;
+	};
+
+	String prevSrc(src, length);
+	int failCount = 0;
+	int replayCount = 0;
+	for (int editIdx = 0; editIdx <= length; editIdx += BF_MAX(editStride, 1))
+	{
+		for (auto& edit : edits)
+		{
+			if (editIdx + edit.mDeleteCount > length)
+				continue;
+			String curSrc;
+			curSrc.Append(src, editIdx);
+			curSrc.Append(edit.mInsert);
+			curSrc.Append(src + editIdx + edit.mDeleteCount, length - editIdx - edit.mDeleteCount);
+			if (curSrc.IsEmpty())
+				continue;
+
+			_LexResult replayResult;
+			_Lex(prevSrc, curSrc, replayResult);
+			_LexResult fullResult;
+			_Lex(String(), curSrc, fullResult);
+			replayCount += replayResult.mReplayCount;
+
+			int mismatchIdx = -1;
+			int traceCount = (int)BF_MAX(replayResult.mTrace.size(), fullResult.mTrace.size());
+			for (int traceIdx = 0; traceIdx < traceCount; traceIdx++)
+			{
+				if ((traceIdx >= replayResult.mTrace.size()) || (traceIdx >= fullResult.mTrace.size()) ||
+					(!_TraceEquals(replayResult.mTrace[traceIdx], fullResult.mTrace[traceIdx])))
+				{
+					mismatchIdx = traceIdx;
+					break;
+				}
+			}
+			if ((mismatchIdx == -1) && (replayResult.mErrorCount == fullResult.mErrorCount) && (replayResult.mWarningCount == fullResult.mWarningCount))
+				continue;
+
+			failCount++;
+			String insertStr = edit.mInsert;
+			insertStr.Replace("\n", "\\n");
+			OutputDebugStrF("Lex replay mismatch: insert \"%s\" deleting %d at %d, token %d of %d/%d, errors %d/%d\n", insertStr.c_str(), edit.mDeleteCount,
+				editIdx, mismatchIdx, (int)replayResult.mTrace.size(), (int)fullResult.mTrace.size(), replayResult.mErrorCount, fullResult.mErrorCount);
+		}
+	}
+
+	if (outReplayCount != NULL)
+		*outReplayCount = replayCount;
+	return failCount;
+}
@@ -30,13 +30,32 @@ enum BfSyntaxToken
 	BfSyntaxToken_EOF
 };
 
-struct BfLineStartEntry
+// Re-lexes every token replayed from a previous revision and asserts the results match
+//#define BF_PARSER_VERIFY_LEX_REPLAY
+
+// A token whose lexing had no side effects other than line tracking. The next revision of the
+//  same file can replay these for text that didn't change rather than rescanning it. Only lexing is
+//  incremental: every revision still builds its own full AST, and Reduce and BuildDefs run over the whole file.
+struct BfLexRecord
 {
-	int mCharIdx;
-	int mLineNum;
+	int mScanStart; // mSrcIdx when NextToken was entered, start of leading trivia
+	int mTokenStart;
+	int mTokenEnd;
+	int mSrcEnd;
+	BfVariant mLiteral;
+	BfToken mToken;
+	BfSyntaxToken mSyntaxToken;
 };
 
-#define PARSER_JUMPTABLE_DIVIDE 64
+// A token as NextToken produced it, replayed or not. Lets BfParser_TestLexReplay compare a replaying parse against a
+//  full lex of the same source.
+struct BfLexTraceEntry
+{
+	BfLexRecord mRecord;
+	int mLineNum;
+	int mLineStart;
+	String mStringLiteral;
+};
 
 enum BfParserFlag
 {
@@ -72,13 +91,15 @@ public:
 	HashSet<String> mDefines_Def;
 	HashSet<String> mDefines_NoDef;
 
-	BfLineStartEntry* mJumpTable;
-	int mJumpTableSize;
+	Array<int> mLineStarts; // Source index of the start of each line, for binary searching in GetLineCharAtIdx
 	OwnedVector<String> mStringLiterals;
 	Dictionary<int, BfParserWarningEnabledChange> mWarningEnabledChanges;
 	std::set<int> mUnwarns;
+	Array<BfLexRecord> mLexRecords; // Only recorded for classifier parsers, handed off to the next revision
 	bool mFailed; // Don't cache if there's a warning or an error
 	bool mDidReduce;		
+	int64 mParseMicros;
+	int64 mReduceMicros;
 
 public:
 	BfParserData();
@@ -92,6 +113,7 @@ public:
 
 	virtual BfParser* ToParser() override;
 	int GetCharIdAtIndex(int findIndex);	
+	int GetLineAtIdx(int idx);
 	void GetLineCharAtIdx(int idx, int& line, int& lineChar);
 	bool IsUnwarnedAt(BfAstNode* node);
 	bool IsWarningEnabledAtSrcIndex(int warningNumber, int srcIdx);
@@ -154,8 +176,6 @@ public:
 	bool mQuickCompatMode;	
 	bool mScanOnly;
 	bool mCompleteParse;
-	BfLineStartEntry* mJumpTable;
-	int mJumpTableSize;
 	int mOrigSrcLength;	
 	int mDataId;
 
@@ -182,6 +202,16 @@ public:
 	
 	std::set<int> mPreprocessorIgnoredSectionStarts;			
 
+	bool mRecordLex;
+	int mLexDepth;
+	Array<BfLexRecord> mLexReplayRecords; // Taken from mPrevRevision
+	int mLexReplayIdx;
+	int mLexPrefixLen; // Number of leading chars unchanged from the previous revision
+	int mLexSuffixStart; // Index in the previous revision where the unchanged tail begins
+	int mLexSuffixDelta; // Offset from previous revision indices to ours within the unchanged tail
+	int mLexReplayCount;
+	Array<BfLexTraceEntry>* mLexTrace;
+
 public:
 	virtual void HandleInclude(BfAstNode* paramNode);
 	virtual void HandleIncludeNext(BfAstNode* paramNode);
@@ -194,6 +224,7 @@ public:
 public:		
 	void Init(uint64 cacheHash = 0);
 	void NewLine();	
+	void BuildLineStarts();
 	BfExpression* CreateInlineExpressionFromNode(BfBlock* block);
 	bool EvaluatePreprocessor(BfExpression* expr);
 	BfBlock* ParseInlineBlock(int spaceIdx, int endIdx);
@@ -202,6 +233,11 @@ public:
 	bool SrcPtrHasToken(const char* name);
 	uint32 GetTokenHash();
 	void ParseBlock(BfBlock* astNode, int depth);
+	void InitLexReplay();
+	bool TryReplayToken();
+	void RecordToken(int scanStart);
+	void ReplayOrLexToken(int endIdx);
+	void LexToken(int endIdx);
 	double ParseLiteralDouble();	
 	void AddErrorNode(int startIdx, int endIdx);
 	BfCommentKind GetCommentKind(int startIdx);	
@@ -716,7 +716,7 @@ void BfPrinter::Visit(BfAttributeDirective* attributeDirective)
 	
 	if (attributeDirective->mAttrOpenToken != NULL)
 	{
-		if (attributeDirective->mAttrOpenToken->mToken == BfToken_Comma)
+		if (attributeDirective->mAttrOpenToken->GetToken() == BfToken_Comma)
 		{
 			VisitChild(attributeDirective->mAttrOpenToken);
 			ExpectSpace();
@@ -847,7 +847,7 @@ void BfPrinter::Visit(BfTokenNode* tokenNode)
 
 	if (mDocPrep)
 	{
-		if (tokenNode->mToken == BfToken_Mut)
+		if (tokenNode->GetToken() == BfToken_Mut)
 			return;
 	}
 
@@ -2051,7 +2051,7 @@ void BfPrinter::QueueMethodDeclaration(BfMethodDeclaration* methodDeclaration)
 	
 	if (auto operatorDecl = BfNodeDynCast<BfOperatorDeclaration>(methodDeclaration))
 	{
-		if ((operatorDecl->mOpTypeToken != NULL) && (operatorDecl->mOpTypeToken->mToken == BfToken_LChevron))
+		if ((operatorDecl->mOpTypeToken != NULL) && (operatorDecl->mOpTypeToken->GetToken() == BfToken_LChevron))
 			ExpectSpace();
 	}
 	QueueVisitChild(methodDeclaration->mGenericParams);
@@ -2351,7 +2351,7 @@ void BfPrinter::Visit(BfTypeDeclaration* typeDeclaration)
 	ExpectSpace();
 
 	bool isEnumDoc = false;
-	if ((mDocPrep) && (typeDeclaration->mTypeNode != NULL) && (typeDeclaration->mTypeNode->mToken == BfToken_Enum))
+	if ((mDocPrep) && (typeDeclaration->mTypeNode != NULL) && (typeDeclaration->mTypeNode->GetToken() == BfToken_Enum))
 	{
 		if (auto defineBlock = BfNodeDynCast<BfBlock>(typeDeclaration->mDefineNode))
 		{			
@@ -2375,7 +2375,7 @@ void BfPrinter::Visit(BfTypeDeclaration* typeDeclaration)
 		QueueVisitChild(typeDeclaration->mTypeNode);
 
 	bool queueChildren = (typeDeclaration->mTypeNode != NULL) &&
-		((typeDeclaration->mTypeNode->mToken == BfToken_Delegate) || (typeDeclaration->mTypeNode->mToken == BfToken_Function));
+		((typeDeclaration->mTypeNode->GetToken() == BfToken_Delegate) || (typeDeclaration->mTypeNode->GetToken() == BfToken_Function));
 
 	ExpectSpace();
 	QueueVisitChild(typeDeclaration->mNameNode);
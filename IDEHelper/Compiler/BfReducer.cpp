@@ -767,7 +767,7 @@ bool BfReducer::IsTypeReference(BfAstNode* checkNode, BfToken successToken, int*
 					auto nextNode = mVisitorPos.Get(checkIdx + 1);
 					if (auto tokenNode = BfNodeDynCast<BfTokenNode>(nextNode))
 					{
-						if (tokenNode->mToken != BfToken_LParen)
+						if (tokenNode->GetToken() != BfToken_LParen)
 						{
 							isDone = true;
 						}
@@ -1611,7 +1611,7 @@ BfExpression* BfReducer::CreateExpression(BfAstNode* node, CreateExprFlags creat
 			{
 				if (auto tokenNode = BfNodeDynCast<BfTokenNode>(mVisitorPos.Get(endNodeIdx - 1)))
 				{
-					if ((tokenNode->mToken == BfToken_Star) || (tokenNode->mToken == BfToken_Question)) // Is it something that can ONLY be a sized type reference?
+					if ((tokenNode->GetToken() == BfToken_Star) || (tokenNode->GetToken() == BfToken_Question)) // Is it something that can ONLY be a sized type reference?
 					{
 						BfSizedArrayCreateExpression* arrayCreateExpr = mAlloc->Alloc<BfSizedArrayCreateExpression>();
 						auto typeRef = CreateTypeRef(exprLeft);
@@ -2524,7 +2524,7 @@ BfExpression* BfReducer::CreateExpression(BfAstNode* node, CreateExprFlags creat
 				auto nextNode = mVisitorPos.GetNext();
 				if (auto nextToken = BfNodeDynCast<BfTokenNode>(nextNode))
 				{
-					if ((nextToken->mToken == BfToken_Star) || (nextToken->mToken == BfToken_LBracket))
+					if ((nextToken->GetToken() == BfToken_Star) || (nextToken->GetToken() == BfToken_LBracket))
 					{
 						//if (IsTypeReference(tokenNode, BfToken_LBracket))
 						{
@@ -2703,7 +2703,7 @@ BfForEachStatement* BfReducer::CreateForEachStatement(BfAstNode* node, bool hasT
 	{
 		if (auto tokenNode = BfNodeDynCast<BfTokenNode>(mVisitorPos.GetNext()))
 		{
-			if (tokenNode->mToken == BfToken_ReadOnly)
+			if (tokenNode->GetToken() == BfToken_ReadOnly)
 			{
 				MEMBER_SET_CHECKED(forEachStatement, mReadOnlyToken, tokenNode);
 				mVisitorPos.MoveNext();
@@ -2718,7 +2718,7 @@ BfForEachStatement* BfReducer::CreateForEachStatement(BfAstNode* node, bool hasT
 	
 	if (auto nextNode = BfNodeDynCast<BfTokenNode>(mVisitorPos.GetNext()))
 	{
-		if ((nextNode->mToken == BfToken_LParen) || (nextNode->mToken == BfToken_LessEquals))
+		if ((nextNode->GetToken() == BfToken_LParen) || (nextNode->GetToken() == BfToken_LessEquals))
 		{			
 			mVisitorPos.MoveNext();
 			auto tupleNode = CreateTupleExpression(nextNode);
@@ -2759,11 +2759,11 @@ BfStatement* BfReducer::CreateForStatement(BfAstNode* node)
 	if (auto tokenNode = BfNodeDynCast<BfTokenNode>(nextNode))
 	{
 		// Handle 'for (let (key, value) in dict)'
-		if ((tokenNode->mToken == BfToken_Let) || (tokenNode->mToken == BfToken_Var))
+		if ((tokenNode->GetToken() == BfToken_Let) || (tokenNode->GetToken() == BfToken_Var))
 		{
 			if (auto afterLet = BfNodeDynCast<BfTokenNode>(mVisitorPos.Get(mVisitorPos.mReadPos + 2)))
 			{
-				if (afterLet->mToken == BfToken_LParen)
+				if (afterLet->GetToken() == BfToken_LParen)
 				{
 					bool isTupleIn = true;
 					int parenDepth = 1;
@@ -2772,7 +2772,7 @@ BfStatement* BfReducer::CreateForStatement(BfAstNode* node)
 						auto checkNode = mVisitorPos.Get(readPos);
 						if (auto tokenNode = BfNodeDynCast<BfTokenNode>(checkNode))
 						{
-							if (tokenNode->mToken == BfToken_RParen)
+							if (tokenNode->GetToken() == BfToken_RParen)
 							{
 								if (parenDepth != 1)
 								{
@@ -2781,13 +2781,13 @@ BfStatement* BfReducer::CreateForStatement(BfAstNode* node)
 								}
 								parenDepth--;
 							}
-							else if (tokenNode->mToken == BfToken_In)
+							else if (tokenNode->GetToken() == BfToken_In)
 							{
 								if (parenDepth != 0)
 									isTupleIn = false;
 								break;
 							}
-							else if (tokenNode->mToken == BfToken_Comma)
+							else if (tokenNode->GetToken() == BfToken_Comma)
 							{
 								//
 							}
@@ -2821,7 +2821,7 @@ BfStatement* BfReducer::CreateForStatement(BfAstNode* node)
 	bool isTypeRef = false;
 	if (auto nextToken = BfNodeDynCast<BfTokenNode>(nextNode))
 	{
-		if (nextNode->mToken == BfToken_ReadOnly)
+		if (nextNode->GetToken() == BfToken_ReadOnly)
 		{			
 			mVisitorPos.mReadPos += 2;
 			isTypeRef = IsTypeReference(mVisitorPos.Get(mVisitorPos.mReadPos), BfToken_None, &outNodeIdx);
@@ -3550,7 +3550,7 @@ BfAstNode* BfReducer::DoCreateStatement(BfAstNode* node, CreateStmtFlags createS
 
 					if (auto tokenNode = BfNodeDynCast<BfTokenNode>(mVisitorPos.GetNext()))
 					{
-						if (tokenNode->mToken == BfToken_Append)
+						if (tokenNode->GetToken() == BfToken_Append)
 						{
 							MEMBER_SET(deleteStmt, mAllocExpr, tokenNode);
 							mVisitorPos.MoveNext();
@@ -3571,7 +3571,7 @@ BfAstNode* BfReducer::DoCreateStatement(BfAstNode* node, CreateStmtFlags createS
 			nextNode = mVisitorPos.GetNext();
 			if ((tokenNode = BfNodeDynCast<BfTokenNode>(nextNode)))
 			{
-				if (tokenNode->mToken == BfToken_LBracket)
+				if (tokenNode->GetToken() == BfToken_LBracket)
 				{
 					mVisitorPos.MoveNext();
 					auto attrib = CreateAttributeDirective(tokenNode);
@@ -3773,7 +3773,7 @@ BfAstNode* BfReducer::DoCreateStatement(BfAstNode* node, CreateStmtFlags createS
 						Fail(StrFormat("'%s' already specified", BfTokenToString(variableDecl->mModSpecifier->GetToken())), variableDecl->mModSpecifier);
 					}
 					MEMBER_SET(variableDecl, mModSpecifier, tokenNode);
-					exprStmt->SetSrcStart(variableDecl->mSrcStart);
+					exprStmt->SetSrcStart(variableDecl->GetSrcStart());
 					return stmt;
 				}
 			}
@@ -3995,7 +3995,7 @@ BfAstNode* BfReducer::DoCreateStatement(BfAstNode* node, CreateStmtFlags createS
 		if (variableNameNode == NULL)
 		{
 			auto checkToken = BfNodeDynCast<BfTokenNode>(mVisitorPos.Get(mVisitorPos.mReadPos + 2));
-			if ((checkToken != NULL) && (checkToken->mToken == BfToken_Dot))
+			if ((checkToken != NULL) && (checkToken->GetToken() == BfToken_Dot))
 			{
 				FailAfter("Expected variable name", variableDeclaration);
 			}
@@ -4728,7 +4728,7 @@ BfTypeReference* BfReducer::DoCreateTypeRef(BfAstNode* firstNode, CreateTypeRefF
 						auto nextNode = mVisitorPos.GetNext();
 						if (auto nextTokenNode = BfNodeDynCast<BfTokenNode>(nextNode))
 						{
-							if (nextTokenNode->mToken == BfToken_Star)
+							if (nextTokenNode->GetToken() == BfToken_Star)
 							{
 								auto wildcardTypeRef = mAlloc->Alloc<BfWildcardTypeReference>();								
 								ReplaceNode(nextTokenNode, wildcardTypeRef);
@@ -4883,7 +4883,7 @@ BfTypeReference* BfReducer::DoCreateTypeRef(BfAstNode* firstNode, CreateTypeRefF
 			else if (token == BfToken_LChevron)
 			{
 				auto genericInstance = mAlloc->Alloc<BfGenericInstanceTypeRef>();
-				BfDeferredSizedArray<BfTypeReference*> genericArguments(genericInstance->mGenericArguments, mAlloc);
+				BfDeferredAstSizedArray<BfTypeReference*> genericArguments(genericInstance->mGenericArguments, mAlloc);
 				BfDeferredAstSizedArray<BfAstNode*> commas(genericInstance->mCommas, mAlloc);
 				ReplaceNode(typeRef, genericInstance);
 				genericInstance->mOpenChevron = tokenNode;
@@ -5003,11 +5003,11 @@ BfTypeReference* BfReducer::CreateTypeRef(BfAstNode* firstNode, CreateTypeRefFla
 				auto checkNode = mVisitorPos.Get(checkIdx);
 				if (auto checkToken = BfNodeDynCast<BfTokenNode>(checkNode))
 				{
-					if (checkToken->mToken == BfToken_LChevron)
+					if (checkToken->GetToken() == BfToken_LChevron)
 					{
-						checkToken->mToken = BfToken_Bar;
+						checkToken->SetToken(BfToken_Bar);
 						auto typeRef = CreateTypeRef(firstNode, createTypeRefFlags);
-						checkToken->mToken = BfToken_LChevron;
+						checkToken->SetToken(BfToken_LChevron);
 						return typeRef;
 					}
 				}
@@ -5180,7 +5180,7 @@ BfAttributeDirective* BfReducer::CreateAttributeDirective(BfTokenNode* startToke
 				MEMBER_SET(attributeTargetSpecifier, mColonToken, tokenNode);
 			attributeDirective->SetSrcEnd(attributeDirective->mAttributeTargetSpecifier->GetSrcEnd());
 		}
-		else if ((tokenNode->mToken == BfToken_Ampersand) || (tokenNode->mToken == BfToken_AssignEquals))
+		else if ((tokenNode->GetToken() == BfToken_Ampersand) || (tokenNode->GetToken() == BfToken_AssignEquals))
 		{
 			MEMBER_SET(attributeDirective, mAttributeTargetSpecifier, tokenNode);
 			mVisitorPos.MoveNext();
@@ -6545,7 +6545,7 @@ BfAstNode* BfReducer::ReadTypeMember(BfAstNode* node, int depth)
 		auto block = BfNodeDynCast<BfBlock>(nextNode);
 		auto tokenNode = BfNodeDynCast<BfTokenNode>(nextNode);
 
-		bool isExprBodyProp = (tokenNode != NULL) && (tokenNode->mToken == BfToken_FatArrow);
+		bool isExprBodyProp = (tokenNode != NULL) && (tokenNode->GetToken() == BfToken_FatArrow);
 		// Property.
 		//  If we don't have a token afterwards then still treat it as a property for autocomplete purposes
 		if ((typeRef != NULL) &&			
@@ -7004,7 +7004,7 @@ BfCollectionInitializerExpression * BfReducer::CreateCollectionInitializerExpres
 		{
 			if (auto tokenNode = BfNodeDynCast<BfTokenNode>(head))
 			{
-				if (tokenNode->mToken == BfToken_RParen)
+				if (tokenNode->GetToken() == BfToken_RParen)
 				{
 					MEMBER_SET(arrayInitializerExpression, mCloseBrace, tokenNode);
 					return arrayInitializerExpression;
@@ -7041,7 +7041,7 @@ BfCollectionInitializerExpression * BfReducer::CreateCollectionInitializerExpres
 	return arrayInitializerExpression;
 }
 
-BfScopedInvocationTarget* BfReducer::CreateScopedInvocationTarget(BfAstNode*& targetRef, BfTokenNode* colonToken)
+BfScopedInvocationTarget* BfReducer::CreateScopedInvocationTarget(ASTREF(BfAstNode*)& targetRef, BfTokenNode* colonToken)
 {
 	auto scopedInvocationTarget = mAlloc->Alloc<BfScopedInvocationTarget>();
 	ReplaceNode(targetRef, scopedInvocationTarget);
@@ -7083,14 +7083,14 @@ BfAstNode* BfReducer::CreateAllocNode(BfTokenNode* allocToken)
 		auto nextToken = BfNodeDynCast<BfTokenNode>(mVisitorPos.GetNext());
 		if (nextToken == NULL)
 			return allocToken;
-		if ((nextToken->mToken != BfToken_Colon) && (nextToken->mToken != BfToken_LBracket))
+		if ((nextToken->GetToken() != BfToken_Colon) && (nextToken->GetToken() != BfToken_LBracket))
 			return allocToken;
 		
 		auto scopeNode = mAlloc->Alloc<BfScopeNode>();
 		ReplaceNode(allocToken, scopeNode);
 		scopeNode->mScopeToken = allocToken;
 
-		if (nextToken->mToken == BfToken_Colon)
+		if (nextToken->GetToken() == BfToken_Colon)
 		{			
 			MEMBER_SET(scopeNode, mColonToken, nextToken);
 			mVisitorPos.MoveNext();
@@ -7118,7 +7118,7 @@ BfAstNode* BfReducer::CreateAllocNode(BfTokenNode* allocToken)
 		nextToken = BfNodeDynCast<BfTokenNode>(mVisitorPos.GetNext());
 		if (nextToken == NULL)
 			return scopeNode;
-		if (nextToken->mToken != BfToken_LBracket)
+		if (nextToken->GetToken() != BfToken_LBracket)
 			return scopeNode;
 
 		mVisitorPos.MoveNext();
@@ -7134,14 +7134,14 @@ BfAstNode* BfReducer::CreateAllocNode(BfTokenNode* allocToken)
 
 		if (nextToken == NULL)
 			return allocToken;
-		if ((nextToken->mToken != BfToken_Colon) && (nextToken->mToken != BfToken_LBracket))
+		if ((nextToken->GetToken() != BfToken_Colon) && (nextToken->GetToken() != BfToken_LBracket))
 			return allocToken;
 
 		auto newNode = mAlloc->Alloc<BfNewNode>();
 		ReplaceNode(allocToken, newNode);
 		newNode->mNewToken = allocToken;
 
-		if (nextToken->mToken == BfToken_Colon)
+		if (nextToken->GetToken() == BfToken_Colon)
 		{			
 			MEMBER_SET(newNode, mColonToken, nextToken);
 			mVisitorPos.MoveNext();
@@ -7233,7 +7233,7 @@ BfAstNode* BfReducer::CreateAllocNode(BfTokenNode* allocToken)
 		nextToken = BfNodeDynCast<BfTokenNode>(mVisitorPos.GetNext());
 		if (nextToken == NULL)
 			return newNode;
-		if (nextToken->mToken != BfToken_LBracket)
+		if (nextToken->GetToken() != BfToken_LBracket)
 			return newNode;
 
 		mVisitorPos.MoveNext();
@@ -7333,7 +7333,7 @@ BfExpression* BfReducer::CreateIndexerExpression(BfExpression* target)
 	BfAttributeDirective* attributeDirective = NULL;
 	if (auto tokenNode = BfNodeDynCast<BfTokenNode>(mVisitorPos.GetNext()))
 	{
-		if (tokenNode->mToken == BfToken_LBracket)
+		if (tokenNode->GetToken() == BfToken_LBracket)
 		{
 			mVisitorPos.MoveNext();			
 			attributeDirective = CreateAttributeDirective(tokenNode);
@@ -7587,7 +7587,7 @@ BfAstNode* BfReducer::CreateTopLevelObject(BfTokenNode* tokenNode, BfAttributeDi
 	{
 		if (auto nextTokenNode = BfNodeDynCast<BfTokenNode>(mVisitorPos.GetNext()))
 		{
-			if (nextTokenNode->mToken == BfToken_Static)
+			if (nextTokenNode->GetToken() == BfToken_Static)
 			{
 				auto usingDirective = mAlloc->Alloc<BfUsingStaticDirective>();
 				ReplaceNode(tokenNode, usingDirective);
@@ -8512,7 +8512,7 @@ BfTokenNode* BfReducer::ParseMethodParams(BfAstNode* node, SizedArrayImpl<BfPara
 			MEMBER_SET(paramDecl, mModToken, modTokenNode);
 		}
 
-		if ((tokenNode != NULL) && (tokenNode->mToken == BfToken_DotDotDot))
+		if ((tokenNode != NULL) && (tokenNode->GetToken() == BfToken_DotDotDot))
 			continue;
 
 		bool allowNameFail = false;
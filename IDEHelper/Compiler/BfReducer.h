@@ -195,7 +195,7 @@ public:
 	BfCollectionInitializerExpression* CreateCollectionInitializerExpression(BfBlock* block);	
 	BfCollectionInitializerExpression* CreateCollectionInitializerExpression(BfTokenNode* openToken);
 	BfObjectCreateExpression* CreateObjectCreateExpression(BfAstNode* allocNode);
-	BfScopedInvocationTarget* CreateScopedInvocationTarget(BfAstNode*& targetRef, BfTokenNode* colonToken);
+	BfScopedInvocationTarget* CreateScopedInvocationTarget(ASTREF(BfAstNode*)& targetRef, BfTokenNode* colonToken);
 	BfInvocationExpression* CreateInvocationExpression(BfAstNode* target, CreateExprFlags createExprFlags = CreateExprFlags_None);
 	BfExpression* CreateIndexerExpression(BfExpression* target);
 	BfMemberReferenceExpression* CreateMemberReferenceExpression(BfAstNode* target);
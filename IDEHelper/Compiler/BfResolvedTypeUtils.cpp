@@ -86,6 +86,42 @@ void BfDependencyMap::AddUsedBy(BfType* dependentType, BfDependencyMap::Dependen
 	}
 }
 
+// A NULL methodHash means the dependent relies on all of our inline internals
+void BfDependencyMap::AddInlinedBy(BfType* dependentType, const Val128* methodHash)
+{
+	BF_ASSERT(dependentType != NULL);
+	BF_ASSERT(dependentType->mRevision != -1);
+
+	InlineEntry* inlineEntry = NULL;
+	if ((mInlineMap.TryAdd(dependentType, NULL, &inlineEntry)) || (inlineEntry->mRevision != dependentType->mRevision))
+	{
+		inlineEntry->mRevision = dependentType->mRevision;
+		inlineEntry->mInlinesAll = false;
+		inlineEntry->mMethodHashes.Clear();
+	}
+
+	if (methodHash == NULL)
+		inlineEntry->mInlinesAll = true;
+	else if (!inlineEntry->mMethodHashes.Contains(*methodHash))
+		inlineEntry->mMethodHashes.Add(*methodHash);
+}
+
+// Conservatively returns true when we don't have an up-to-date record of what the dependent inlined
+bool BfDependencyMap::InlinesAnyOf(BfType* dependentType, Array<Val128>& methodHashes)
+{
+	InlineEntry* inlineEntry = NULL;
+	if (!mInlineMap.TryGetValue(dependentType, &inlineEntry))
+		return true;
+	if ((inlineEntry->mRevision != dependentType->mRevision) || (inlineEntry->mInlinesAll))
+		return true;
+	for (auto& methodHash : inlineEntry->mMethodHashes)
+	{
+		if (methodHashes.Contains(methodHash))
+			return true;
+	}
+	return false;
+}
+
 bool BfDependencyMap::IsEmpty()
 {
 	return mTypeSet.size() == 0;
@@ -103,6 +139,7 @@ BfDependencyMap::TypeMap::iterator BfDependencyMap::end()
 
 BfDependencyMap::TypeMap::iterator BfDependencyMap::erase(BfDependencyMap::TypeMap::iterator& itr)
 {
+	mInlineMap.Remove(itr->mKey);
 	return mTypeSet.Remove(itr);
 }
 
@@ -494,6 +531,13 @@ BfMethodInstance::~BfMethodInstance()
 		mHotMethod->Deref();
 	}
 
+	if (mHasCachedMangledName)
+	{
+		auto context = GetOwner()->mContext;
+		if (!context->mDeleting)
+			context->mMangledNameCache.RemoveMethod(this);
+	}
+
 	delete mMethodInfoEx;
 }
 
@@ -531,6 +575,13 @@ void BfMethodInstance::UndoDeclaration(bool keepIRFunction)
 		mMethodInfoEx->mGenericTypeBindings.Clear();
 	}
 
+	// The redeclaration may resolve to different types
+	if (mHasCachedMangledName)
+	{
+		GetOwner()->mContext->mMangledNameCache.RemoveMethod(this);
+		mHasCachedMangledName = false;
+	}
+
 	mReturnType = NULL;
 	if (!keepIRFunction)
 		mIRFunction = BfIRValue();
@@ -1445,6 +1496,7 @@ void BfTypeInstance::ReportMemory(MemReporter* memReporter)
 	int depSize = 0;	
 	depSize += sizeof((int)mDependencyMap.mTypeSet.mAllocSize * sizeof(BfDependencyMap::TypeMap::EntryPair));
 	memReporter->Add("DepMap", depSize);
+	memReporter->AddMap("InlineDepMap", mDependencyMap.mInlineMap, false);
 	memReporter->AddVec(mInterfaces, false);
 	memReporter->AddVec(mInterfaceMethodTable, false);
 
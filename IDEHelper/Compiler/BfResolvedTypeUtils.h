@@ -95,12 +95,24 @@ public:
 		}
 	};
 
+	// Which of our inlined methods (by BfMethodDef::mFullHash) a DependencyFlag_InlinedCall dependent actually inlined,
+	//  so an inline internals change only has to rebuild the dependents that inlined one of the changed methods
+	struct InlineEntry
+	{
+		int mRevision;
+		bool mInlinesAll; // Depends on inline internals that can't be attributed to a single method
+		Array<Val128> mMethodHashes;
+	};
+
 public:
 	typedef Dictionary<BfType*, DependencyEntry> TypeMap;
 	TypeMap mTypeSet;
+	Dictionary<BfType*, InlineEntry> mInlineMap;
 
 public:
 	void AddUsedBy(BfType* dependentType, DependencyDependencyFlag flags);	
+	void AddInlinedBy(BfType* dependentType, const Val128* methodHash);
+	bool InlinesAnyOf(BfType* dependentType, Array<Val128>& methodHashes);
 	bool IsEmpty();
 	TypeMap::iterator begin();
 	TypeMap::iterator end();
@@ -744,6 +756,7 @@ public:
 	bool mHasMethodRefType:1;
 	bool mDisallowCalling:1;	
 	bool mIsGenericMethodInstance:1;	
+	bool mHasCachedMangledName:1;
 	BfMethodChainType mChainType;
 	BfMethodInstanceGroup* mMethodInstanceGroup;
 	BfMethodDef* mMethodDef;
@@ -778,6 +791,7 @@ public:
 		mHasMethodRefType = false;
 		mDisallowCalling = false;				
 		mIsGenericMethodInstance = false;		
+		mHasCachedMangledName = false;
 		mChainType = BfMethodChainType_None;
 		mMethodInstanceGroup = NULL;
 		mMethodDef = NULL;									
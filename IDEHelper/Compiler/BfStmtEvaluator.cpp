@@ -2019,7 +2019,7 @@ void BfModule::HandleTupleVariableDeclaration(BfVariableDeclaration* varDecl)
 		AssertErrorState();
 }
 
-void BfModule::HandleCaseEnumMatch_Tuple(BfTypedValue tupleVal, const BfSizedArray<BfExpression*>& arguments, BfAstNode* tooFewRef, BfIRValue phiVal, BfIRBlock& matchedBlock, BfIRBlock falseBlock, bool& hadConditional, bool clearOutOnMismatch)
+void BfModule::HandleCaseEnumMatch_Tuple(BfTypedValue tupleVal, const BfSizedArray<ASTREF(BfExpression*)>& arguments, BfAstNode* tooFewRef, BfIRValue phiVal, BfIRBlock& matchedBlock, BfIRBlock falseBlock, bool& hadConditional, bool clearOutOnMismatch)
 {
 	SetAndRestoreValue<bool> prevInCondBlock(mCurMethodState->mInConditionalBlock);
 
@@ -3621,7 +3621,7 @@ void BfModule::Visit(BfDeleteStatement* deleteStmt)
 			customAllocator = CreateValueFromExpression(expr);
 		else if (auto tokenNode = BfNodeDynCast<BfTokenNode>(deleteStmt->mAllocExpr))
 		{
-			if (tokenNode->mToken == BfToken_Append)
+			if (tokenNode->GetToken() == BfToken_Append)
 				isAppendDelete = true;
 		}
 	}
@@ -3786,9 +3786,9 @@ void BfModule::Visit(BfDeleteStatement* deleteStmt)
 							typedValueExpr.Init(val);
 							typedValueExpr.mRefNode = deleteStmt->mAllocExpr;
 							BfExprEvaluator exprEvaluator(this);
-							SizedArray<BfExpression*, 2> argExprs;
+							SizedArray<ASTREF(BfExpression*), 2> argExprs;
 							argExprs.push_back(&typedValueExpr);
-							BfSizedArray<BfExpression*> sizedArgExprs(argExprs);
+							BfSizedArray<ASTREF(BfExpression*)> sizedArgExprs(argExprs);
 							BfResolvedArgs argValues(&sizedArgExprs);
 							exprEvaluator.ResolveArgValues(argValues);
 							exprEvaluator.mNoBind = true;
@@ -3839,9 +3839,9 @@ void BfModule::Visit(BfDeleteStatement* deleteStmt)
 		BfTypedValueExpression typedValueExpr;
 		typedValueExpr.Init(ptrValue);		
 		BfExprEvaluator exprEvaluator(this);
-		SizedArray<BfExpression*, 2> argExprs;
+		SizedArray<ASTREF(BfExpression*), 2> argExprs;
 		argExprs.push_back(&typedValueExpr);
-		BfSizedArray<BfExpression*> sizedArgExprs(argExprs);
+		BfSizedArray<ASTREF(BfExpression*)> sizedArgExprs(argExprs);
 		BfResolvedArgs argValues(&sizedArgExprs);
 		exprEvaluator.ResolveArgValues(argValues);
 		exprEvaluator.mNoBind = true;
@@ -5143,7 +5143,7 @@ void BfModule::Visit(BfRepeatStatement* repeatStmt)
 // 	else
 		UpdateSrcPos(repeatStmt);
 
-	if (repeatStmt->mRepeatToken->mToken == BfToken_Do)
+	if (repeatStmt->mRepeatToken->GetToken() == BfToken_Do)
 	{
 		Fail("Repeat block requires 'repeat' token", repeatStmt->mRepeatToken);
 	}
@@ -5515,7 +5515,7 @@ void BfModule::DoForLess(BfForEachStatement* forEachStmt)
 		// Soldier on
 		target = GetDefaultTypedValue(varType);
 	}
-	if (forEachStmt->mInToken->mToken == BfToken_LessEquals)
+	if (forEachStmt->mInToken->GetToken() == BfToken_LessEquals)
 		conditionValue = mBfIRBuilder->CreateCmpLTE(localVal, target.mValue, varType->IsSigned());
 	else
 		conditionValue = mBfIRBuilder->CreateCmpLT(localVal, target.mValue, varType->IsSigned());
@@ -6184,9 +6184,9 @@ void BfModule::Visit(BfForEachStatement* forEachStmt)
 		BfTypedValueExpression typedValueExpr;
 		typedValueExpr.Init(BfTypedValue(itrVal, itrType));
 		BfExprEvaluator exprEvaluator(this);
-		SizedArray<BfExpression*, 1> indices;
+		SizedArray<ASTREF(BfExpression*), 1> indices;
 		indices.push_back(&typedValueExpr);
-		BfSizedArray<BfExpression*> sizedArgExprs(indices);
+		BfSizedArray<ASTREF(BfExpression*)> sizedArgExprs(indices);
 		BfResolvedArgs argValues(&sizedArgExprs);		
 		exprEvaluator.ResolveArgValues(argValues);
 		bool boundsCheck = mCompiler->mOptions.mRuntimeChecks;
@@ -6387,7 +6387,7 @@ void BfModule::Visit(BfDeferStatement* deferStmt)
 				customAllocator = CreateValueFromExpression(expr);
 			else if (auto tokenNode = BfNodeDynCast<BfTokenNode>(deleteStmt->mAllocExpr))
 			{
-				if (tokenNode->mToken == BfToken_Append)
+				if (tokenNode->GetToken() == BfToken_Append)
 					isAppendDelete = true;
 			}
 		}
@@ -6418,9 +6418,9 @@ void BfModule::Visit(BfDeferStatement* deferStmt)
 				typedValueExpr.Init(val);
 				typedValueExpr.mRefNode = deleteStmt->mAllocExpr;
 				BfExprEvaluator exprEvaluator(this);
-				SizedArray<BfExpression*, 2> argExprs;
+				SizedArray<ASTREF(BfExpression*), 2> argExprs;
 				argExprs.push_back(&typedValueExpr);
-				BfSizedArray<BfExpression*> sizedArgExprs(argExprs);
+				BfSizedArray<ASTREF(BfExpression*)> sizedArgExprs(argExprs);
 				BfResolvedArgs argValues(&sizedArgExprs);
 				exprEvaluator.ResolveArgValues(argValues);
 				exprEvaluator.mNoBind = true;
@@ -6434,9 +6434,9 @@ void BfModule::Visit(BfDeferStatement* deferStmt)
 				BfTypedValueExpression typedValueExpr;
 				typedValueExpr.Init(ptrValue);				
 				BfExprEvaluator exprEvaluator(this);
-				SizedArray<BfExpression*, 2> argExprs;
+				SizedArray<ASTREF(BfExpression*), 2> argExprs;
 				argExprs.push_back(&typedValueExpr);
-				BfSizedArray<BfExpression*> sizedArgExprs(argExprs);
+				BfSizedArray<ASTREF(BfExpression*)> sizedArgExprs(argExprs);
 				BfResolvedArgs argValues(&sizedArgExprs);
 				exprEvaluator.ResolveArgValues(argValues);
 				exprEvaluator.mNoBind = true;
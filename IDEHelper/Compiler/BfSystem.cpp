@@ -873,6 +873,7 @@ BfProject::BfProject()
 	mBuildConfigChanged = false;	
 	mSingleModule = false;
 	mAlwaysIncludeAll = false;
+	mCompactReflection = false;
 	mSystem = NULL;
 	mIdx = -1;
 }
@@ -2480,6 +2481,7 @@ void BfSystem::RemoveTypeDef(BfTypeDef* typeDef)
 	BF_ASSERT(typeDef->mDefState == BfTypeDef::DefState_Deleted);	
 	// mTypeDef is already locked by the system lock
 	mTypeDefs.Remove(typeDef);	
+	mTypeDefSearchIndex.Remove(typeDef);
 	AutoCrit autoCrit(mDataLock);
 	mTypeDefDeleteQueue.push_back(typeDef);	
 	mTypeMapVersion++;
@@ -2492,6 +2494,7 @@ void BfSystem::InjectNewRevision(BfTypeDef* typeDef)
 	bool setDeclaringType = !typeDef->mIsCombinedPartial;
 
 	auto nextTypeDef = typeDef->mNextRevision;
+	mTypeDefSearchIndex.MarkDirty(typeDef);
 	
 	for (auto prevProperty : typeDef->mProperties)
 		delete prevProperty;
@@ -2586,6 +2589,8 @@ void BfSystem::InjectNewRevision(BfTypeDef* typeDef)
 	typeDef->mSignatureHash = nextTypeDef->mSignatureHash;
 	typeDef->mFullHash = nextTypeDef->mFullHash;
 	typeDef->mInlineHash = nextTypeDef->mInlineHash;
+	typeDef->mChangedInlineMethods.Clear();
+	typeDef->mChangedInlineMethodsKnown = false;
 	typeDef->mNestDepth = nextTypeDef->mNestDepth;
 	typeDef->mOuterType = nextTypeDef->mOuterType;
 	//typeDef->mOuterType = nextTypeDef->mOuterType;
@@ -2854,6 +2859,7 @@ void BfSystem::AddToCompositePartial(BfPassInstance* passInstance, BfTypeDef* co
 void BfSystem::FinishCompositePartial(BfTypeDef* compositeTypeDef)
 {
 	VerifyTypeDef(compositeTypeDef);
+	mTypeDefSearchIndex.MarkDirty(compositeTypeDef);
 
 	auto nextRevision = compositeTypeDef->mNextRevision;
 
@@ -3514,6 +3520,11 @@ BF_EXPORT void BF_CALLTYPE BfSystem_ReportMemory(BfSystem* bfSystem)
 		parser->ReportMemory(&memReporter);
 	}	
 
+	{
+		AutoMemReporter autoMemReporter(&memReporter, "TypeDefSearchIndex");
+		bfSystem->mTypeDefSearchIndex.ReportMemory(&memReporter);
+	}
+
 	memReporter.Report();
 }
 
@@ -3672,8 +3683,12 @@ BF_EXPORT void BF_CALLTYPE BfProject_SetDisabled(BfProject* bfProject, bool disa
 }
 
 BF_EXPORT void BF_CALLTYPE BfProject_SetOptions(BfProject* bfProject, int targetType, const char* startupObject, const char* preprocessorMacros,
-	int optLevel, int ltoType, int relocType, int picLevel, BfProjectFlags flags)
+	int optLevel, int ltoType, int relocType, int picLevel, BfProjectFlags flags, int pgoKind, const char* pgoProfilePath)
 {
+	// A profile from a previous call must not outlive a change to the PGO kind or path
+	bfProject->mCodeGenOptions.mPGOProfilePath.Clear();
+	bfProject->mCodeGenOptions.mPGOProfileHash = Val128();
+
 	bfProject->mTargetType = (BfTargetType)targetType;
 	bfProject->mStartupObject = startupObject;	
 	
@@ -3682,6 +3697,21 @@ BF_EXPORT void BF_CALLTYPE BfProject_SetOptions(BfProject* bfProject, int target
 	codeGenOptions.mLTOType = (BfLTOType)ltoType;
 	codeGenOptions.mRelocType = (BfRelocType)relocType;
 	codeGenOptions.mPICLevel = (BfPICLevel)picLevel;
+	codeGenOptions.mPGOKind = (BfPGOKind)pgoKind;
+	if ((codeGenOptions.mPGOKind != BfPGOKind_None) && (pgoProfilePath != NULL))
+		codeGenOptions.mPGOProfilePath = pgoProfilePath;
+	if (codeGenOptions.mPGOKind == BfPGOKind_Use)
+	{
+		// A new profile has to invalidate the built modules even when nothing else changed. A missing profile
+		//  leaves the hash zeroed, which BfCompiler reports as an error.
+		int profileSize = 0;
+		uint8* profileData = LoadBinaryData(codeGenOptions.mPGOProfilePath, &profileSize);
+		if (profileData != NULL)
+		{
+			codeGenOptions.mPGOProfileHash = Hash128(profileData, profileSize);
+			delete [] profileData;
+		}
+	}
 	codeGenOptions.mMergeFunctions = (flags & BfProjectFlags_MergeFunctions) != 0;
 	codeGenOptions.mLoadCombine = (flags & BfProjectFlags_CombineLoads) != 0;
 	codeGenOptions.mLoopVectorize = (flags & BfProjectFlags_VectorizeLoops) != 0;
@@ -3703,6 +3733,7 @@ BF_EXPORT void BF_CALLTYPE BfProject_SetOptions(BfProject* bfProject, int target
 	bfProject->mCodeGenOptions = codeGenOptions;
 	bfProject->mSingleModule = (flags & BfProjectFlags_SingleModule) != 0;
 	bfProject->mAlwaysIncludeAll = (flags & BfProjectFlags_AlwaysIncludeAll) != 0;
+	bfProject->mCompactReflection = (flags & BfProjectFlags_CompactReflection) != 0;
 
 	bfProject->mPreprocessorMacros.Clear();
 	
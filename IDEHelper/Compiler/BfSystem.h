@@ -14,6 +14,7 @@
 #include <unordered_set>
 #include <set>
 #include "MemReporter.h"
+#include "BfTypeDefSearchIndex.h"
 
 namespace llvm
 {
@@ -157,6 +158,8 @@ enum BfCompilerOptionFlags
 	BfCompilerOptionFlag_DebugAlloc         = 0x8000,
 	BfCompilerOptionFlag_OmitDebugHelpers   = 0x10000,
 	BfCompilerOptionFlag_NoFramePointerElim = 0x20000,
+	BfCompilerOptionFlag_MethodGranularDeps = 0x40000,
+	BfCompilerOptionFlag_ShortSymbols       = 0x80000,
 };
 
 enum BfTypeFlags
@@ -266,7 +269,15 @@ enum BfOptLevel
 enum BfLTOType
 {
 	BfLTOType_None = 0,
-	BfLTOType_Thin = 1
+	BfLTOType_Thin = 1, // Bitcode objects, the thin link is done by lld
+	BfLTOType_ThinInProcess = 2 // Bitcode objects, the thin link and backend run in the compiler and emit native objects
+};
+
+enum BfPGOKind
+{
+	BfPGOKind_None = 0,
+	BfPGOKind_Instrument = 1, // Counters are written to mPGOProfilePath (or 'default.profraw') on exit
+	BfPGOKind_Use = 2 // Optimizes with the merged .profdata at mPGOProfilePath
 };
 
 enum BfCFLAAType
@@ -314,6 +325,9 @@ struct BfCodeGenOptions
 	BfSIMDSetting mSIMDSetting;	
 	BfOptLevel mOptLevel;
 	BfLTOType mLTOType;
+	BfPGOKind mPGOKind;
+	String mPGOProfilePath;
+	Val128 mPGOProfileHash;
 	int mSizeLevel;
 	BfCFLAAType mUseCFLAA;
 	bool mUseNewSROA;
@@ -368,6 +382,7 @@ struct BfCodeGenOptions
 		mSIMDSetting = BfSIMDSetting_None;
 		mOptLevel = BfOptLevel_O0;
 		mLTOType = BfLTOType_None;
+		mPGOKind = BfPGOKind_None;
 		mSizeLevel = 0;
 		mUseCFLAA = BfCFLAAType_None;
 		mUseNewSROA = false;
@@ -420,6 +435,9 @@ struct BfCodeGenOptions
 		hashCtx.Mixin(mSIMDSetting);
 		hashCtx.Mixin(mOptLevel);
 		hashCtx.Mixin(mLTOType);
+		hashCtx.Mixin(mPGOKind);
+		hashCtx.MixinStr(mPGOProfilePath);
+		hashCtx.Mixin(mPGOProfileHash);
 		hashCtx.Mixin(mSizeLevel);
 		hashCtx.Mixin(mUseCFLAA);
 		hashCtx.Mixin(mUseNewSROA);
@@ -856,6 +874,8 @@ public:
 	Val128 mSignatureHash; // Data, methods, etc
 	Val128 mFullHash;	
 	Val128 mInlineHash;
+	Array<Val128> mChangedInlineMethods; // Full hashes of the previous revision's inline methods that changed or were removed
+	bool mChangedInlineMethodsKnown; // mChangedInlineMethods is valid for DefState_InlinedInternals_Changed
 	
 	BfTypeDef* mOuterType;
 	BfAtomComposite mNamespace;
@@ -938,6 +958,7 @@ public:
 		mIsOpaque = false;
 		mPartialUsed = false;
 		mIsNextRevision = false;
+		mChangedInlineMethodsKnown = false;
 		mDupDetectedRevision = -1;
 		mNestDepth = 0;
 		mOuterType = NULL;
@@ -1030,6 +1051,7 @@ enum BfProjectFlags
 	BfProjectFlags_AsmOutput      = 0x20,
 	BfProjectFlags_AsmOutput_ATT  = 0x40,
 	BfProjectFlags_AlwaysIncludeAll = 0x80,
+	BfProjectFlags_CompactReflection = 0x100,
 };
 
 class BfProject
@@ -1043,6 +1065,7 @@ public:
 	bool mDisabled;
 	bool mSingleModule;
 	bool mAlwaysIncludeAll;
+	bool mCompactReflection;
 	int mIdx;
 
 	String mStartupObject;
@@ -1055,6 +1078,9 @@ public:
 	Val128 mBuildConfigHash;
 	Val128 mVDataConfigHash;
 
+	Dictionary<String, String> mThinLTOFileMap; // Bitcode object -> native object from the last in-process thin link
+	Array<String> mThinLTOExtraFileNames;
+
 	bool mBuildConfigChanged;
 
 public:
@@ -1325,6 +1351,7 @@ public:
 	// The following are protected by mSystemLock - can only be accessed by the compiling thread
 	Dictionary<String, BfTypeDef*> mSystemTypeDefs;	
 	BfTypeDefMap mTypeDefs;	
+	BfTypeDefSearchIndex mTypeDefSearchIndex;
 	bool mNeedsTypesHandledByCompiler;
 	BumpAllocator mAlloc;	
 	int mAtomCreateIdx;	
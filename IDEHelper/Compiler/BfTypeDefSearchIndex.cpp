@@ -0,0 +1,260 @@
+#include "BfTypeDefSearchIndex.h"
+#include "BfSystem.h"
+
+USING_NS_BF;
+
+static inline uint8 FoldChar(char c)
+{
+	// Matches the ASCII-only case folding of StringImpl::IndexOf(str, true)
+	if ((c >= 'a') && (c <= 'z'))
+		return (uint8)(c - 'a' + 'A');
+	return (uint8)c;
+}
+
+static bool FoldedEquals(const char* a, const char* b, int length)
+{
+	for (int i = 0; i < length; i++)
+		if (FoldChar(a[i]) != FoldChar(b[i]))
+			return false;
+	return true;
+}
+
+BfTypeDefSearchIndex::BfTypeDefSearchIndex()
+{
+	mDeadSlotCount = 0;
+	mCurSeq = 0;
+	mStatQueries = 0;
+	mStatFallbackQueries = 0;
+	mStatReindexedTypes = 0;
+}
+
+void BfTypeDefSearchIndex::AddTrigrams(const StringView& str, HashSet<uint32>& trigrams)
+{
+	if (str.mLength < 3)
+		return;
+	uint32 key = ((uint32)FoldChar(str.mPtr[0]) << 8) | FoldChar(str.mPtr[1]);
+	for (int i = 2; i < str.mLength; i++)
+	{
+		key = ((key << 8) | FoldChar(str.mPtr[i])) & 0xFFFFFF;
+		trigrams.Add(key);
+	}
+}
+
+void BfTypeDefSearchIndex::IndexTypeDef(BfTypeDef* typeDef)
+{
+	HashSet<uint32> trigrams;
+
+	String typeName;
+	typeDef->mFullName.ToString(typeName);
+	AddTrigrams(typeName, trigrams);
+
+	// Dot searches match against "TypeName.memberName", so we also need the trigrams that straddle the dot
+	String junctionStr;
+	auto _AddMember = [&](const StringImpl& memberName)
+	{
+		AddTrigrams(memberName, trigrams);
+		junctionStr.Clear();
+		if (typeName.mLength >= 2)
+			junctionStr.Append(typeName.c_str() + typeName.mLength - 2, 2);
+		else
+			junctionStr += typeName;
+		junctionStr += ".";
+		junctionStr.Append(memberName.c_str(), BF_MIN(memberName.mLength, 2));
+		AddTrigrams(junctionStr, trigrams);
+	};
+
+	for (auto fieldDef : typeDef->mFields)
+		_AddMember(fieldDef->mName);
+	for (auto propDef : typeDef->mProperties)
+		_AddMember(propDef->mName);
+	for (auto methodDef : typeDef->mMethods)
+		_AddMember(methodDef->mName);
+
+	int slotIdx = (int)mSlots.size();
+	Slot slot;
+	slot.mTypeDef = typeDef;
+	slot.mSeq = mCurSeq++;
+	mSlots.Add(slot);
+	mSlotMap[typeDef] = slotIdx;
+
+	for (auto trigram : trigrams)
+	{
+		Array<int>* postingsPtr = NULL;
+		mPostings.TryAdd(trigram, NULL, &postingsPtr);
+		postingsPtr->Add(slotIdx);
+	}
+
+	mStatReindexedTypes++;
+}
+
+void BfTypeDefSearchIndex::RemoveSlot(BfTypeDef* typeDef)
+{
+	int slotIdx = -1;
+	if (!mSlotMap.Remove(typeDef, &slotIdx))
+		return;
+	// Postings for dead slots are left in place and filtered out at query time until the next Compact
+	mSlots[slotIdx].mTypeDef = NULL;
+	mDeadSlotCount++;
+}
+
+void BfTypeDefSearchIndex::Compact()
+{
+	Array<Slot> liveSlots;
+	for (auto& slot : mSlots)
+	{
+		if (slot.mTypeDef != NULL)
+			liveSlots.Add(slot);
+	}
+
+	mSlots.Clear();
+	mSlotMap.Clear();
+	mPostings.Clear();
+	mDeadSlotCount = 0;
+
+	for (auto& slot : liveSlots)
+	{
+		IndexTypeDef(slot.mTypeDef);
+		// Keep the original sequence so ranking ties stay stable across compactions
+		mSlots.back().mSeq = slot.mSeq;
+	}
+}
+
+int BfTypeDefSearchIndex::GetRank(BfTypeDef* typeDef, const Array<String>& searchTerms)
+{
+	if (typeDef->mName == NULL)
+		return 3;
+
+	StringView name = typeDef->mName->mString;
+	int bestRank = 3;
+	for (auto& searchTerm : searchTerms)
+	{
+		if (name.mLength < searchTerm.mLength)
+			continue;
+		if ((name.mLength == searchTerm.mLength) && (FoldedEquals(name.mPtr, searchTerm.c_str(), (int)name.mLength)))
+			return 0;
+		if (FoldedEquals(name.mPtr, searchTerm.c_str(), (int)searchTerm.mLength))
+			bestRank = BF_MIN(bestRank, 1);
+		else if (name.IndexOf(searchTerm, true) != -1)
+			bestRank = BF_MIN(bestRank, 2);
+	}
+	return bestRank;
+}
+
+void BfTypeDefSearchIndex::MarkDirty(BfTypeDef* typeDef)
+{
+	mDirtySet.Add(typeDef);
+}
+
+void BfTypeDefSearchIndex::Remove(BfTypeDef* typeDef)
+{
+	mDirtySet.Remove(typeDef);
+	RemoveSlot(typeDef);
+}
+
+void BfTypeDefSearchIndex::Update()
+{
+	if (!mDirtySet.IsEmpty())
+	{
+		for (auto typeDef : mDirtySet)
+		{
+			int prevSeq = -1;
+			int* slotIdxPtr = NULL;
+			if (mSlotMap.TryGetValue(typeDef, &slotIdxPtr))
+				prevSeq = mSlots[*slotIdxPtr].mSeq;
+			RemoveSlot(typeDef);
+			// Partials are searched through their composite typeDef
+			if (typeDef->mIsPartial)
+				continue;
+			IndexTypeDef(typeDef);
+			// A reindexed typeDef keeps its place among equally-ranked results
+			if (prevSeq != -1)
+				mSlots.back().mSeq = prevSeq;
+		}
+		mDirtySet.Clear();
+	}
+
+	if ((mDeadSlotCount > 1024) && (mDeadSlotCount > (int)mSlotMap.size()))
+		Compact();
+}
+
+// Returns false if the search terms are too short to be narrowed, in which case the caller must scan every typeDef.
+//  Candidates are a superset of the typeDefs that would match, ordered by how closely their names match the terms.
+bool BfTypeDefSearchIndex::GetCandidates(const Array<String>& searchTerms, Array<BfTypeDef*>& outTypeDefs)
+{
+	Update();
+	mStatQueries++;
+
+	HashSet<uint32> queryTrigrams;
+	for (auto& searchTerm : searchTerms)
+		AddTrigrams(searchTerm, queryTrigrams);
+	if (queryTrigrams.IsEmpty())
+	{
+		mStatFallbackQueries++;
+		return false;
+	}
+
+	Array<Array<int>*> postingLists;
+	for (auto trigram : queryTrigrams)
+	{
+		Array<int>* postingsPtr = NULL;
+		if (!mPostings.TryGetValue(trigram, &postingsPtr))
+			return true; // No typeDef contains this trigram so nothing can match
+		postingLists.Add(postingsPtr);
+	}
+
+	// Intersect starting with the shortest list. A slot survives round N only if it was present in all previous lists.
+	postingLists.Sort([](Array<int>* lhs, Array<int>* rhs) { return lhs->size() < rhs->size(); });
+
+	Array<int> hitCounts;
+	hitCounts.Resize(mSlots.size());
+	for (int listIdx = 0; listIdx < (int)postingLists.size(); listIdx++)
+	{
+		for (auto slotIdx : *postingLists[listIdx])
+		{
+			if (hitCounts[slotIdx] == listIdx)
+				hitCounts[slotIdx] = listIdx + 1;
+		}
+	}
+
+	struct _Candidate
+	{
+		BfTypeDef* mTypeDef;
+		int mRank;
+		int mSeq;
+	};
+
+	Array<_Candidate> candidates;
+	for (auto slotIdx : *postingLists[0])
+	{
+		auto& slot = mSlots[slotIdx];
+		if ((slot.mTypeDef == NULL) || (hitCounts[slotIdx] != (int)postingLists.size()))
+			continue;
+		_Candidate candidate;
+		candidate.mTypeDef = slot.mTypeDef;
+		candidate.mRank = GetRank(slot.mTypeDef, searchTerms);
+		candidate.mSeq = slot.mSeq;
+		candidates.Add(candidate);
+	}
+
+	candidates.Sort([](const _Candidate& lhs, const _Candidate& rhs)
+		{
+			if (lhs.mRank != rhs.mRank)
+				return lhs.mRank < rhs.mRank;
+			return lhs.mSeq < rhs.mSeq;
+		});
+
+	outTypeDefs.Reserve(candidates.size());
+	for (auto& candidate : candidates)
+		outTypeDefs.Add(candidate.mTypeDef);
+	return true;
+}
+
+void BfTypeDefSearchIndex::ReportMemory(MemReporter* memReporter)
+{
+	memReporter->AddVec("Slots", mSlots, false);
+	memReporter->AddMap("SlotMap", mSlotMap, false);
+	memReporter->AddMap("Postings", mPostings, false);
+	for (auto& kv : mPostings)
+		memReporter->AddVec("PostingLists", kv.mValue, false);
+	memReporter->AddHashSet("DirtySet", mDirtySet, false);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "BeefySysLib/Common.h"
+#include "BeefySysLib/util/Array.h"
+#include "BeefySysLib/util/Dictionary.h"
+#include "BeefySysLib/util/HashSet.h"
+#include "MemReporter.h"
+
+NS_BF_BEGIN
+
+class BfTypeDef;
+
+// Trigram index over type and member names, used to narrow the typeDefs that GetTypeDefMatches must
+//  string-match. TypeDefs are marked dirty as the def builder changes them and get reindexed on the next query.
+class BfTypeDefSearchIndex
+{
+public:
+	struct Slot
+	{
+		BfTypeDef* mTypeDef; // NULL once the slot is dead
+		int mSeq;
+	};
+
+public:
+	Array<Slot> mSlots;
+	Dictionary<BfTypeDef*, int> mSlotMap;
+	Dictionary<uint32, Array<int>> mPostings; // Trigram -> slot indices, may contain dead slots
+	HashSet<BfTypeDef*> mDirtySet;
+	int mDeadSlotCount;
+	int mCurSeq;
+
+	int mStatQueries;
+	int mStatFallbackQueries;
+	int mStatReindexedTypes;
+
+protected:
+	void AddTrigrams(const StringView& str, HashSet<uint32>& trigrams);
+	void IndexTypeDef(BfTypeDef* typeDef);
+	void RemoveSlot(BfTypeDef* typeDef);
+	void Compact();
+	int GetRank(BfTypeDef* typeDef, const Array<String>& searchTerms);
+
+public:
+	BfTypeDefSearchIndex();
+
+	void MarkDirty(BfTypeDef* typeDef);
+	void Remove(BfTypeDef* typeDef);
+	void Update();
+	bool GetCandidates(const Array<String>& searchTerms, Array<BfTypeDef*>& outTypeDefs);
+	void ReportMemory(MemReporter* memReporter);
+};
+
+NS_BF_END
@@ -999,7 +999,7 @@ DbgType* DbgExprEvaluator::ResolveTypeRef(BfTypeReference* typeRef)
 	return NULL;
 }
 
-DbgType* DbgExprEvaluator::ResolveTypeRef(BfAstNode* typeRef, BfAstNode** parentChildRef)
+DbgType* DbgExprEvaluator::ResolveTypeRef(BfAstNode* typeRef, BfAstChildRef parentChildRef)
 {	
 	StringT<128> name = typeRef->ToString();	
 	if ((name.StartsWith("_T_")) && ((int)name.IndexOf('.') == -1))
@@ -1018,7 +1018,7 @@ DbgType* DbgExprEvaluator::ResolveTypeRef(BfAstNode* typeRef, BfAstNode** parent
 		int idx = atoi(name.c_str() + 3);
 		if ((idx >= 0) && (idx < (int)mDbgModule->mTypes.size()))
 		{
-			if ((mExplicitThisExpr != NULL) && (parentChildRef != NULL))
+			if ((mExplicitThisExpr != NULL) && (!parentChildRef.IsNull()))
 				mDeferredInsertExplicitThisVector.push_back(NodeReplaceRecord(typeRef, parentChildRef, true));
 			DbgType* dbgType = mDbgModule->mTypes[idx];
 			for (int i = endIdx; i < (int)name.length(); i++)
@@ -1269,6 +1269,7 @@ void DbgExprEvaluator::BeefTypeToString(const DbgTypedValue& val, String& outStr
 		_FieldData* mFieldDataPtr;
 		void* mConstructorDataPtr;
 		void** mCustomAttrDataPtr;
+		uint8* mReflectNamesPtr;
 	};
 	
 	int typeIdSize = sizeof(_TypeId);
@@ -3174,7 +3175,7 @@ DbgTypedValue DbgExprEvaluator::ReadTypedValue(BfAstNode* targetSrc, DbgType* db
 	return result;
 }
 
-bool DbgExprEvaluator::CheckTupleCreation(addr_target receiveAddr, BfAstNode* targetSrc, DbgType* tupleType, const BfSizedArray<BfExpression*>& argValues, BfSizedArray<BfTupleNameNode*>* names)
+bool DbgExprEvaluator::CheckTupleCreation(addr_target receiveAddr, BfAstNode* targetSrc, DbgType* tupleType, const BfSizedArray<ASTREF(BfExpression*)>& argValues, BfSizedArray<ASTREF(BfTupleNameNode*)>* names)
 {
 	int memberIdx = 0;
 
@@ -3223,7 +3224,7 @@ bool DbgExprEvaluator::CheckTupleCreation(addr_target receiveAddr, BfAstNode* ta
 	return false;
 }
 
-DbgTypedValue DbgExprEvaluator::CheckEnumCreation(BfAstNode* targetSrc, DbgType* enumType, const StringImpl& caseName, const BfSizedArray<BfExpression*>& argValues)
+DbgTypedValue DbgExprEvaluator::CheckEnumCreation(BfAstNode* targetSrc, DbgType* enumType, const StringImpl& caseName, const BfSizedArray<ASTREF(BfExpression*)>& argValues)
 {
 	BF_ASSERT(enumType->IsBfPayloadEnum());
 
@@ -4479,7 +4480,7 @@ void DbgExprEvaluator::Visit(BfMemberReferenceExpression* memberRefExpr)
 		if (memberRefExpr->mTarget == NULL)
 			thisValue.mType = mExpectingType;
 		else
-			thisValue.mType = ResolveTypeRef(memberRefExpr->mTarget, (BfAstNode**)&(memberRefExpr->mTarget));
+			thisValue.mType = ResolveTypeRef(memberRefExpr->mTarget, &memberRefExpr->mTarget);
 		if (thisValue.mType != NULL)		
 			thisValue.mHasNoValue = true;		
 	}
@@ -5440,7 +5441,7 @@ void DbgExprEvaluator::Visit(BfCastExpression* castExpr)
 		return;
 
 	if (mExplicitThisExpr != NULL)
-		mDeferredInsertExplicitThisVector.push_back(NodeReplaceRecord(castExpr->mTypeRef, (BfAstNode**)&castExpr->mTypeRef));
+		mDeferredInsertExplicitThisVector.push_back(NodeReplaceRecord(castExpr->mTypeRef, &castExpr->mTypeRef));
 
 	mResult = CreateValueFromExpression(castExpr->mExpression);
 	if (!mResult)
@@ -8046,8 +8047,7 @@ BfAstNode* DbgExprEvaluator::FinalizeExplicitThisReferences(BfAstNode* headNode)
 
 		if (newNode != NULL)
 		{
-			if (replaceNodeRecord.mNodeRef != NULL)
-				*replaceNodeRecord.mNodeRef = newNode;
+			replaceNodeRecord.mNodeRef.Set(newNode);
 			if (replaceNode == headNode)
 				headNode = newNode;
 		}
@@ -225,11 +225,11 @@ class DbgExprEvaluator : public BfStructuralVisitor
 public:
 	struct NodeReplaceRecord
 	{
-		BfAstNode** mNodeRef;
+		BfAstChildRef mNodeRef;
 		BfAstNode* mNode;
 		bool mForceTypeRef;
 
-		NodeReplaceRecord(BfAstNode* node, BfAstNode** nodeRef, bool forceTypeRef = false)
+		NodeReplaceRecord(BfAstNode* node, BfAstChildRef nodeRef, bool forceTypeRef = false)
 		{
 			mNode = node;
 			mNodeRef = nodeRef;
@@ -302,8 +302,8 @@ public:
 
 public:
 	DbgTypedValue ReadTypedValue(BfAstNode* targetSrc, DbgType* type, uint64 valAddr, DbgAddrType addrType);
-	bool CheckTupleCreation(addr_target receiveAddr, BfAstNode* targetSrc, DbgType* tupleType, const BfSizedArray<BfExpression*>& argValues, BfSizedArray<BfTupleNameNode*>* names);
-	DbgTypedValue CheckEnumCreation(BfAstNode* targetSrc, DbgType* enumType, const StringImpl& caseName, const BfSizedArray<BfExpression*>& argValues);
+	bool CheckTupleCreation(addr_target receiveAddr, BfAstNode* targetSrc, DbgType* tupleType, const BfSizedArray<ASTREF(BfExpression*)>& argValues, BfSizedArray<ASTREF(BfTupleNameNode*)>* names);
+	DbgTypedValue CheckEnumCreation(BfAstNode* targetSrc, DbgType* enumType, const StringImpl& caseName, const BfSizedArray<ASTREF(BfExpression*)>& argValues);
 	void DoInvocation(BfAstNode* target, BfSizedArray<ASTREF(BfExpression*)>& args, BfSizedArray<ASTREF(BfTypeReference*)>* methodGenericArguments);
 	bool ResolveArgValues(const BfSizedArray<ASTREF(BfExpression*)>& arguments, SizedArrayImpl<DbgTypedValue>& outArgValues);	
 	DbgTypedValue CreateCall(DbgSubprogram* method, DbgTypedValue thisVal, bool bypassVirtual, CPURegisters* registers);
@@ -336,7 +336,7 @@ public:
 	DbgType* FixType(DbgType* dbgType);
 	DbgTypedValue FixThis(const DbgTypedValue& thisVal);
 	DbgType* ResolveTypeRef(BfTypeReference* typeRef);
-	DbgType* ResolveTypeRef(BfAstNode* typeRef, BfAstNode** parentChildRef = NULL);
+	DbgType* ResolveTypeRef(BfAstNode* typeRef, BfAstChildRef parentChildRef = BfAstChildRef());
 	DbgType* ResolveTypeRef(const StringImpl& typeRef);
 	static bool TypeIsSubTypeOf(DbgType* srcType, DbgType* wantType, int* thisOffset = NULL, addr_target* thisAddr = NULL);	
 	DbgTypedValue GetBeefTypeById(int typeId);